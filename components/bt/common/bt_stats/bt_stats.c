@@ -0,0 +1,218 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include "bt_common.h"
+#include "bt_stats/bt_stats.h"
+#include "freertos/FreeRTOS.h"
+
+#if (BT_STATS_INCLUDED == TRUE)
+
+typedef struct {
+    uint8_t *buf;
+    size_t size;
+    size_t len;
+} bt_stats_writer_t;
+
+/* Only serializes registrations, readers walk the list without it */
+static portMUX_TYPE s_bt_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static bt_stats_hdr_t *s_bt_stats_head;
+static bt_stats_hdr_t *s_bt_stats_tail;
+static uint16_t s_bt_stats_next_id = 1;
+
+void bt_stats_register(bt_stats_hdr_t *hdr)
+{
+    portENTER_CRITICAL(&s_bt_stats_lock);
+    if (hdr->id == 0) {
+        hdr->next = NULL;
+        hdr->id = s_bt_stats_next_id++;
+        /* Entries are only ever appended, the header is complete before
+         * it becomes reachable */
+        if (s_bt_stats_tail) {
+            s_bt_stats_tail->next = hdr;
+        } else {
+            s_bt_stats_head = hdr;
+        }
+        s_bt_stats_tail = hdr;
+    }
+    portEXIT_CRITICAL(&s_bt_stats_lock);
+}
+
+void bt_stats_register_group(bt_stats_hdr_t *const hdrs[], size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        bt_stats_register(hdrs[i]);
+    }
+}
+
+/* 64-bit values are written in two halves by the other core, read until
+ * two reads agree so that a half-written value is never returned */
+static uint64_t bt_stats_read_u64(const volatile uint64_t *p)
+{
+    uint64_t a, b;
+
+    do {
+        a = *p;
+        b = *p;
+    } while (a != b);
+    return a;
+}
+
+uint64_t bt_stats_counter_read(const bt_stats_counter_t *counter)
+{
+    uint64_t total = 0;
+
+    for (int i = 0; i < BT_STATS_SHARDS; i++) {
+        total += bt_stats_read_u64(&counter->shard[i]);
+    }
+    return total;
+}
+
+int64_t bt_stats_gauge_read(const bt_stats_gauge_t *gauge)
+{
+    uint64_t total = 0;
+
+    for (int i = 0; i < BT_STATS_SHARDS; i++) {
+        total += bt_stats_read_u64((const volatile uint64_t *)&gauge->shard[i]);
+    }
+    return (int64_t)total;
+}
+
+void bt_stats_hist_read(const bt_stats_hist_t *hist, uint32_t buckets[BT_STATS_HIST_BUCKETS], uint64_t *sum)
+{
+    uint64_t total = 0;
+
+    memset(buckets, 0, BT_STATS_HIST_BUCKETS * sizeof(buckets[0]));
+    for (int i = 0; i < BT_STATS_SHARDS; i++) {
+        const volatile bt_stats_hist_shard_t *shard = &hist->shard[i];
+        for (int j = 0; j < BT_STATS_HIST_BUCKETS; j++) {
+            buckets[j] += shard->bucket[j];
+        }
+        total += bt_stats_read_u64(&shard->sum);
+    }
+    if (sum) {
+        *sum = total;
+    }
+}
+
+static void bt_stats_put_u8(bt_stats_writer_t *w, uint8_t value)
+{
+    if (w->len < w->size) {
+        w->buf[w->len] = value;
+    }
+    w->len++;
+}
+
+static void bt_stats_put_varint(bt_stats_writer_t *w, uint64_t value)
+{
+    while (value >= 0x80) {
+        bt_stats_put_u8(w, (uint8_t)value | 0x80);
+        value >>= 7;
+    }
+    bt_stats_put_u8(w, (uint8_t)value);
+}
+
+static void bt_stats_put_entry(bt_stats_writer_t *w, const bt_stats_hdr_t *hdr, uint8_t flags)
+{
+    bt_stats_put_varint(w, hdr->id);
+    bt_stats_put_u8(w, hdr->type);
+    if (flags & BT_STATS_EXPORT_NAMES) {
+        size_t name_len = strnlen(hdr->name, UINT8_MAX);
+        bt_stats_put_u8(w, (uint8_t)name_len);
+        for (size_t i = 0; i < name_len; i++) {
+            bt_stats_put_u8(w, (uint8_t)hdr->name[i]);
+        }
+    }
+
+    switch (hdr->type) {
+    case BT_STATS_TYPE_COUNTER:
+        bt_stats_put_varint(w, bt_stats_counter_read((const bt_stats_counter_t *)hdr));
+        break;
+    case BT_STATS_TYPE_GAUGE: {
+        int64_t value = bt_stats_gauge_read((const bt_stats_gauge_t *)hdr);
+        bt_stats_put_varint(w, ((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+        break;
+    }
+    case BT_STATS_TYPE_HIST: {
+        uint32_t buckets[BT_STATS_HIST_BUCKETS];
+        uint64_t sum;
+
+        bt_stats_hist_read((const bt_stats_hist_t *)hdr, buckets, &sum);
+        bt_stats_put_u8(w, hdr->shift);
+        for (int i = 0; i < BT_STATS_HIST_BUCKETS; i++) {
+            bt_stats_put_varint(w, buckets[i]);
+        }
+        bt_stats_put_varint(w, sum);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+size_t bt_stats_export(uint8_t *buf, size_t size, uint8_t flags)
+{
+    bt_stats_writer_t w = {
+        .buf = buf,
+        .size = buf ? size : 0,
+        .len = 0,
+    };
+    const bt_stats_hdr_t *hdr;
+    uint32_t count = 0;
+
+    /* Registrations made while exporting are left for the next snapshot */
+    const bt_stats_hdr_t *tail = s_bt_stats_tail;
+    for (hdr = s_bt_stats_head; hdr; hdr = (hdr == tail) ? NULL : hdr->next) {
+        count++;
+    }
+
+    bt_stats_put_u8(&w, BT_STATS_EXPORT_VERSION);
+    bt_stats_put_u8(&w, flags);
+    bt_stats_put_varint(&w, (uint64_t)BT_STATS_TIME_US());
+    bt_stats_put_varint(&w, count);
+    for (hdr = s_bt_stats_head; hdr && count; hdr = hdr->next, count--) {
+        bt_stats_put_entry(&w, hdr, flags);
+    }
+
+    return w.len;
+}
+
+void bt_stats_show(void)
+{
+    uint32_t buckets[BT_STATS_HIST_BUCKETS];
+    uint64_t sum;
+
+    for (const bt_stats_hdr_t *hdr = s_bt_stats_head; hdr; hdr = hdr->next) {
+        switch (hdr->type) {
+        case BT_STATS_TYPE_COUNTER:
+            printf("%-24s %" PRIu64 "\n", hdr->name, bt_stats_counter_read((const bt_stats_counter_t *)hdr));
+            break;
+        case BT_STATS_TYPE_GAUGE:
+            printf("%-24s %" PRId64 "\n", hdr->name, bt_stats_gauge_read((const bt_stats_gauge_t *)hdr));
+            break;
+        case BT_STATS_TYPE_HIST: {
+            uint32_t count = 0;
+
+            bt_stats_hist_read((const bt_stats_hist_t *)hdr, buckets, &sum);
+            printf("%-24s", hdr->name);
+            for (int i = 0; i < BT_STATS_HIST_BUCKETS - 1; i++) {
+                printf(" <%" PRIu32 ":%" PRIu32, (uint32_t)1 << (hdr->shift + i), buckets[i]);
+                count += buckets[i];
+            }
+            printf(" >=%" PRIu32 ":%" PRIu32, (uint32_t)1 << (hdr->shift + BT_STATS_HIST_BUCKETS - 2),
+                   buckets[BT_STATS_HIST_BUCKETS - 1]);
+            count += buckets[BT_STATS_HIST_BUCKETS - 1];
+            printf(" avg:%" PRIu64 "\n", count ? sum / count : 0);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+}
+
+#endif // (BT_STATS_INCLUDED == TRUE)
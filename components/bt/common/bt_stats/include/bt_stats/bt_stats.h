@@ -0,0 +1,248 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __BT_STATS_H__
+#define __BT_STATS_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if CONFIG_BT_STATS_EN
+
+/*
+ * Statistics are kept in one slot per CPU core. An update only touches the
+ * slot of the core it runs on, with local interrupts masked, so updates never
+ * contend and need no lock. Readers add up the slots of all cores.
+ *
+ * The shard hooks can be overridden before including this header, e.g. to
+ * build the module on a host with one shard per thread.
+ */
+#ifndef BT_STATS_SHARDS
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+#define BT_STATS_SHARDS                 portNUM_PROCESSORS
+#define BT_STATS_SHARD()                xPortGetCoreID()
+#define BT_STATS_LOCAL_LOCK()           portSET_INTERRUPT_MASK_FROM_ISR()
+#define BT_STATS_LOCAL_UNLOCK(state)    portCLEAR_INTERRUPT_MASK_FROM_ISR(state)
+#define BT_STATS_TIME_US()              esp_timer_get_time()
+#endif
+
+/* Number of histogram buckets */
+#define BT_STATS_HIST_BUCKETS           (8)
+
+/* Version of the record written by bt_stats_export() */
+#define BT_STATS_EXPORT_VERSION         (1)
+
+/* Include the names of the statistics in the exported record */
+#define BT_STATS_EXPORT_NAMES           (1 << 0)
+
+typedef enum {
+    BT_STATS_TYPE_COUNTER = 1,
+    BT_STATS_TYPE_GAUGE,
+    BT_STATS_TYPE_HIST,
+} bt_stats_type_t;
+
+typedef struct bt_stats_hdr {
+    struct bt_stats_hdr *next;
+    const char *name;
+    uint8_t type;
+    uint8_t shift;                      /* Histograms: log2 of the first bucket's upper bound */
+    uint16_t id;                        /* Non-zero once registered */
+} bt_stats_hdr_t;
+
+/* Monotonic event count */
+typedef struct {
+    bt_stats_hdr_t hdr;
+    uint64_t shard[BT_STATS_SHARDS];
+} bt_stats_counter_t;
+
+/* Level which goes up and down, e.g. a queue depth */
+typedef struct {
+    bt_stats_hdr_t hdr;
+    int64_t shard[BT_STATS_SHARDS];
+} bt_stats_gauge_t;
+
+typedef struct {
+    uint32_t bucket[BT_STATS_HIST_BUCKETS];
+    uint64_t sum;
+} bt_stats_hist_shard_t;
+
+/*
+ * Distribution of values, usually latencies in microseconds. Bucket 0 holds
+ * values below (1 << shift), each following bucket covers twice the range of
+ * the one before, and the last bucket holds everything above.
+ */
+typedef struct {
+    bt_stats_hdr_t hdr;
+    bt_stats_hist_shard_t shard[BT_STATS_SHARDS];
+} bt_stats_hist_t;
+
+#define BT_STATS_COUNTER_DEFINE(_var, _name) \
+    bt_stats_counter_t _var = { .hdr = { .name = (_name), .type = BT_STATS_TYPE_COUNTER } }
+
+#define BT_STATS_GAUGE_DEFINE(_var, _name) \
+    bt_stats_gauge_t _var = { .hdr = { .name = (_name), .type = BT_STATS_TYPE_GAUGE } }
+
+#define BT_STATS_HIST_DEFINE(_var, _name, _shift) \
+    bt_stats_hist_t _var = { .hdr = { .name = (_name), .type = BT_STATS_TYPE_HIST, .shift = (_shift) } }
+
+static inline void bt_stats_counter_add(bt_stats_counter_t *counter, uint32_t n)
+{
+    uint32_t state = BT_STATS_LOCAL_LOCK();
+    counter->shard[BT_STATS_SHARD()] += n;
+    BT_STATS_LOCAL_UNLOCK(state);
+}
+
+static inline void bt_stats_gauge_add(bt_stats_gauge_t *gauge, int32_t n)
+{
+    uint32_t state = BT_STATS_LOCAL_LOCK();
+    gauge->shard[BT_STATS_SHARD()] += n;
+    BT_STATS_LOCAL_UNLOCK(state);
+}
+
+static inline void bt_stats_hist_record(bt_stats_hist_t *hist, uint32_t value)
+{
+    uint32_t scaled = value >> hist->hdr.shift;
+    uint32_t bucket = scaled ? 32 - __builtin_clz(scaled) : 0;
+    uint32_t state;
+
+    if (bucket >= BT_STATS_HIST_BUCKETS) {
+        bucket = BT_STATS_HIST_BUCKETS - 1;
+    }
+
+    state = BT_STATS_LOCAL_LOCK();
+    bt_stats_hist_shard_t *shard = &hist->shard[BT_STATS_SHARD()];
+    shard->bucket[bucket]++;
+    shard->sum += value;
+    BT_STATS_LOCAL_UNLOCK(state);
+}
+
+/*
+ * Instrumentation helpers. They compile to nothing unless CONFIG_BT_STATS_EN
+ * is set, and the statistics themselves are defined and registered under
+ * (BT_STATS_INCLUDED == TRUE).
+ */
+#define BT_STATS_INC(_counter)              bt_stats_counter_add(&(_counter), 1)
+#define BT_STATS_ADD(_counter, _n)          bt_stats_counter_add(&(_counter), (_n))
+#define BT_STATS_GAUGE_ADD(_gauge, _n)      bt_stats_gauge_add(&(_gauge), (_n))
+#define BT_STATS_HIST_RECORD(_hist, _v)     bt_stats_hist_record(&(_hist), (_v))
+/* Microsecond timestamp for latency measurements, wraps after about 71 minutes */
+#define BT_STATS_TIMESTAMP()                ((uint32_t)BT_STATS_TIME_US())
+#define BT_STATS_HIST_SINCE(_hist, _start)  bt_stats_hist_record(&(_hist), BT_STATS_TIMESTAMP() - (_start))
+
+/**
+ *
+ * @brief           This function is called to register a statistic, so that it is
+ *                  shown and exported. Registering it again has no effect, and
+ *                  statistics stay registered until reboot.
+ *
+ * @param hdr :     header of a statistic with static storage duration
+ *
+ * @return          None
+ *
+ */
+void bt_stats_register(bt_stats_hdr_t *hdr);
+
+/**
+ *
+ * @brief           This function is called to register several statistics
+ *
+ * @param hdrs :    headers of the statistics
+ * @param count :   number of headers
+ *
+ * @return          None
+ *
+ */
+void bt_stats_register_group(bt_stats_hdr_t *const hdrs[], size_t count);
+
+/**
+ *
+ * @brief           This function is called to read the total of a counter over all cores
+ *
+ * @param counter : counter
+ *
+ * @return          counter value
+ *
+ */
+uint64_t bt_stats_counter_read(const bt_stats_counter_t *counter);
+
+/**
+ *
+ * @brief           This function is called to read the total of a gauge over all cores
+ *
+ * @param gauge :   gauge
+ *
+ * @return          gauge value
+ *
+ */
+int64_t bt_stats_gauge_read(const bt_stats_gauge_t *gauge);
+
+/**
+ *
+ * @brief           This function is called to read a histogram summed over all cores
+ *
+ * @param hist :    histogram
+ * @param buckets : output, number of values in each bucket
+ * @param sum :     output, sum of all values, may be NULL
+ *
+ * @return          None
+ *
+ */
+void bt_stats_hist_read(const bt_stats_hist_t *hist, uint32_t buckets[BT_STATS_HIST_BUCKETS], uint64_t *sum);
+
+/**
+ *
+ * @brief           This function is called to take a snapshot of all registered
+ *                  statistics as a compact binary record:
+ *
+ *                  u8 version, u8 flags, varint timestamp (us), varint count,
+ *                  then for each statistic:
+ *                  varint id, u8 type, [u8 name length, name if BT_STATS_EXPORT_NAMES],
+ *                  counter: varint value; gauge: zigzag varint value;
+ *                  histogram: u8 shift, BT_STATS_HIST_BUCKETS varints, varint sum.
+ *
+ *                  Ids are stable until reboot, so names only need to be fetched once.
+ *
+ * @param buf :     output buffer, may be NULL if size is 0
+ * @param size :    size of buf
+ * @param flags :   BT_STATS_EXPORT_* flags
+ *
+ * @return          length of the record; if larger than size, the record was
+ *                  truncated and the call should be repeated with a larger
+ *                  buffer, leaving some room as values keep growing
+ *
+ */
+size_t bt_stats_export(uint8_t *buf, size_t size, uint8_t flags);
+
+/**
+ *
+ * @brief           This function is called to print all registered statistics
+ *
+ * @return          None
+ *
+ */
+void bt_stats_show(void);
+
+#else /* CONFIG_BT_STATS_EN */
+
+#define BT_STATS_INC(_counter)
+#define BT_STATS_ADD(_counter, _n)
+#define BT_STATS_GAUGE_ADD(_gauge, _n)
+#define BT_STATS_HIST_RECORD(_hist, _v)
+#define BT_STATS_HIST_SINCE(_hist, _start)
+
+#endif /* CONFIG_BT_STATS_EN */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BT_STATS_H__ */
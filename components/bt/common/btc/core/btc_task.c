@@ -12,6 +12,7 @@
 #include "bt_common.h"
 #include "osi/allocator.h"
 #include "btc/btc_alarm.h"
+#include "bt_stats/bt_stats.h"
 
 #include "btc/btc_manage.h"
 #include "btc_blufi_prf.h"
@@ -260,6 +261,18 @@ static const btc_func_t profile_tab[BTC_PID_NUM] = {
 #endif /* #if CONFIG_BLE_MESH */
 };
 
+#if (BT_STATS_INCLUDED == TRUE)
+static BT_STATS_COUNTER_DEFINE(btc_stats_post, "btc.msg_post");
+static BT_STATS_COUNTER_DEFINE(btc_stats_post_fail, "btc.msg_post_fail");
+static BT_STATS_GAUGE_DEFINE(btc_stats_queue_depth, "btc.queue_depth");
+/* Time messages wait in the queue of the BTC task, 64 us to 4 ms */
+static BT_STATS_HIST_DEFINE(btc_stats_queue_latency, "btc.queue_latency_us", 6);
+
+static bt_stats_hdr_t *const btc_stats[] = {
+    &btc_stats_post.hdr, &btc_stats_post_fail.hdr, &btc_stats_queue_depth.hdr, &btc_stats_queue_latency.hdr,
+};
+#endif /* (BT_STATS_INCLUDED == TRUE) */
+
 /*****************************************************************************
 **
 ** Function         btc_task
@@ -270,6 +283,9 @@ static void btc_thread_handler(void *arg)
 {
     btc_msg_t *msg = (btc_msg_t *)arg;
 
+    BT_STATS_GAUGE_ADD(btc_stats_queue_depth, -1);
+    BT_STATS_HIST_SINCE(btc_stats_queue_latency, msg->post_time);
+
     BTC_TRACE_DEBUG("%s msg %u %u %u %p\n", __func__, msg->sig, msg->pid, msg->act, msg->arg);
     switch (msg->sig) {
     case BTC_SIG_API_CALL:
@@ -287,10 +303,18 @@ static void btc_thread_handler(void *arg)
 
 static bt_status_t btc_task_post(btc_msg_t *msg, uint32_t timeout)
 {
+#if (BT_STATS_INCLUDED == TRUE)
+    msg->post_time = BT_STATS_TIMESTAMP();
+#endif
+    /* Counted first, the handler may run before osi_thread_post() returns */
+    BT_STATS_GAUGE_ADD(btc_stats_queue_depth, 1);
     if (osi_thread_post(btc_thread, btc_thread_handler, msg, 0, timeout) == false) {
+        BT_STATS_GAUGE_ADD(btc_stats_queue_depth, -1);
+        BT_STATS_INC(btc_stats_post_fail);
         return BT_STATUS_BUSY;
     }
 
+    BT_STATS_INC(btc_stats_post);
     return BT_STATUS_SUCCESS;
 }
 
@@ -395,10 +419,6 @@ static void btc_deinit_mem(void) {
 #endif // BLE_42_FEATURE_SUPPORT
 
 #if GATTS_INCLUDED == TRUE && GATT_DYNAMIC_MEMORY == TRUE
-    if (btc_creat_tab_env_ptr) {
-        osi_free(btc_creat_tab_env_ptr);
-        btc_creat_tab_env_ptr = NULL;
-    }
 #if (BLUFI_INCLUDED == TRUE)
     if (blufi_env_ptr) {
         osi_free(blufi_env_ptr);
@@ -459,10 +479,6 @@ static bt_status_t btc_init_mem(void) {
 #endif // BTC_DYNAMIC_MEMORY == TRUE
 
 #if GATTS_INCLUDED == TRUE && GATT_DYNAMIC_MEMORY == TRUE
-    if ((btc_creat_tab_env_ptr = (esp_btc_creat_tab_t *)osi_malloc(sizeof(esp_btc_creat_tab_t))) == NULL) {
-        goto error_exit;
-    }
-    memset((void *)btc_creat_tab_env_ptr, 0, sizeof(esp_btc_creat_tab_t));
 #if (BLUFI_INCLUDED == TRUE)
     if ((blufi_env_ptr = (tBLUFI_ENV *)osi_malloc(sizeof(tBLUFI_ENV))) == NULL) {
         goto error_exit;
@@ -527,6 +543,10 @@ bt_status_t btc_init(void)
 #if SCAN_QUEUE_CONGEST_CHECK
     btc_adv_list_init();
 #endif
+#if (BT_STATS_INCLUDED == TRUE)
+    bt_stats_register_group(btc_stats, sizeof(btc_stats) / sizeof(btc_stats[0]));
+#endif
+
     /* TODO: initial the profile_tab */
     return BT_STATUS_SUCCESS;
 }
@@ -20,6 +20,9 @@ typedef struct btc_msg {
     uint8_t aid;    //application id
     uint8_t pid;    //profile id
     uint8_t act;    //profile action, defined in seprerate header files
+#if (BT_STATS_INCLUDED == TRUE)
+    uint32_t post_time; //time the message was queued, for statistics
+#endif
     UINT8   arg[0]; //param for btc function or function param
 } btc_msg_t;
 
@@ -77,6 +77,13 @@
 #define HEAP_ALLOCATION_FAILS_ABORT FALSE
 #endif
 
+#if UC_BT_OSI_SLAB_ENABLED
+#define OSI_SLAB_INCLUDED   TRUE
+#else
+#define OSI_SLAB_INCLUDED   FALSE
+#endif
+#define OSI_SLAB_ARENA_SIZE UC_BT_OSI_SLAB_ARENA_SIZE
+
 // HCI LOG
 #if UC_BT_HCI_LOG_DEBUG_EN
 #define BT_HCI_LOG_INCLUDED  UC_BT_HCI_LOG_DEBUG_EN
@@ -96,6 +103,13 @@
 #define HCI_LOG_ADV_BUFFER_SIZE  (5)
 #endif
 
+// STATS
+#if UC_BT_STATS_EN
+#define BT_STATS_INCLUDED  UC_BT_STATS_EN
+#else
+#define BT_STATS_INCLUDED  FALSE
+#endif
+
 /* OS Configuration from User config (eg: sdkconfig) */
 #define TASK_PINNED_TO_CORE         UC_TASK_PINNED_TO_CORE
 #define BT_TASK_MAX_PRIORITIES      configMAX_PRIORITIES
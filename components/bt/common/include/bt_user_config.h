@@ -119,6 +119,18 @@
 #define UC_BT_ABORT_WHEN_ALLOCATION_FAILS       FALSE
 #endif
 
+#ifdef CONFIG_BT_OSI_SLAB_ENABLED
+#define UC_BT_OSI_SLAB_ENABLED                  TRUE
+#else
+#define UC_BT_OSI_SLAB_ENABLED                  FALSE
+#endif
+
+#ifdef CONFIG_BT_OSI_SLAB_ARENA_SIZE
+#define UC_BT_OSI_SLAB_ARENA_SIZE               CONFIG_BT_OSI_SLAB_ARENA_SIZE
+#else
+#define UC_BT_OSI_SLAB_ARENA_SIZE               16
+#endif
+
 //HCI LOG
 #ifdef CONFIG_BT_HCI_LOG_DEBUG_EN
 #define UC_BT_HCI_LOG_DEBUG_EN  TRUE
@@ -138,4 +150,11 @@
 #define UC_BT_HCI_LOG_ADV_BUFFER_SIZE  (5)
 #endif
 
+//STATS
+#ifdef CONFIG_BT_STATS_EN
+#define UC_BT_STATS_EN  TRUE
+#else
+#define UC_BT_STATS_EN  FALSE
+#endif
+
 #endif /* __BT_USER_CONFIG_H__ */
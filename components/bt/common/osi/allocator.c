@@ -244,5 +244,5 @@ void osi_free_func(void *ptr)
 #if HEAP_MEMORY_DEBUG
     osi_mem_dbg_clean(ptr, __func__, __LINE__);
 #endif
-    free(ptr);
+    osi_free_base(ptr);
 }
@@ -21,7 +21,10 @@
 
 #include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 #include "esp_heap_caps.h"
+#include "sdkconfig.h"
+#include "osi/slab.h"
 
 char *osi_strdup(const char *str);
 
@@ -33,9 +36,35 @@ void osi_free_func(void *ptr);
 #if HEAP_ALLOCATION_FROM_SPIRAM_FIRST
 #define osi_malloc_base(size)             heap_caps_malloc_prefer(size, 2, MALLOC_CAP_DEFAULT|MALLOC_CAP_SPIRAM, MALLOC_CAP_DEFAULT|MALLOC_CAP_INTERNAL)
 #define osi_calloc_base(size)             heap_caps_calloc_prefer(1, size, 2, MALLOC_CAP_DEFAULT|MALLOC_CAP_SPIRAM, MALLOC_CAP_DEFAULT|MALLOC_CAP_INTERNAL)
+#define osi_free_base(ptr)                free((ptr))
+#elif CONFIG_BT_OSI_SLAB_ENABLED
+// Small allocations are served from the slab, the rest from the heap
+static inline void *osi_slab_malloc_base(size_t size)
+{
+    void *p = osi_slab_alloc(size);
+    return p ? p : malloc(size);
+}
+
+static inline void *osi_slab_calloc_base(size_t size)
+{
+    void *p = osi_slab_alloc(size);
+    return p ? memset(p, 0, size) : calloc(1, size);
+}
+
+static inline void osi_slab_free_base(void *ptr)
+{
+    if (!osi_slab_free(ptr)) {
+        free(ptr);
+    }
+}
+
+#define osi_malloc_base(size)             osi_slab_malloc_base((size))
+#define osi_calloc_base(size)             osi_slab_calloc_base((size))
+#define osi_free_base(ptr)                osi_slab_free_base((ptr))
 #else
 #define osi_malloc_base(size)             malloc((size))
 #define osi_calloc_base(size)             calloc(1, (size))
+#define osi_free_base(ptr)                free((ptr))
 #endif /* #if HEAP_ALLOCATION_FROM_SPIRAM_FIRST */
 
 #if HEAP_MEMORY_DEBUG
@@ -100,7 +129,7 @@ do {                                                    \
 do {                                                    \
     void *tmp_point = (void *)(ptr);                    \
     osi_mem_dbg_clean(tmp_point, __func__, __LINE__);   \
-    free(tmp_point);                                    \
+    osi_free_base(tmp_point);                           \
 } while (0)
 
 #else
@@ -108,7 +137,7 @@ do {                                                    \
 // Memory alloc function with print and assertion when fails
 #define osi_malloc(size)                  osi_malloc_func((size))
 #define osi_calloc(size)                  osi_calloc_func((size))
-#define osi_free(p)                       free((p))
+#define osi_free(p)                       osi_free_base((p))
 
 #endif /* HEAP_MEMORY_DEBUG */
 
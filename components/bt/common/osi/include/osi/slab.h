@@ -0,0 +1,68 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _OSI_SLAB_H_
+#define _OSI_SLAB_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Small objects are served from 512 byte pages carved out of one arena,
+// each page holding objects of a single size class. This keeps the churn of
+// messages, list nodes and short buffers out of the heap, so it does not
+// fragment over time. Larger requests, and requests made while the arena is
+// full, are left to the heap.
+#define OSI_SLAB_PAGE_SIZE          512
+#define OSI_SLAB_CLASS_NUM          8
+#define OSI_SLAB_MAX_SIZE           256
+
+typedef struct {
+    uint16_t size;                  // Object size of the class
+    uint16_t pages;                 // Pages owned by the class
+    uint32_t in_use;                // Objects handed out
+    uint32_t allocs;                // Allocations served
+    uint32_t fallbacks;             // Allocations left to the heap because the arena was full
+} osi_slab_class_stats_t;
+
+typedef struct {
+    uint16_t arena_pages;           // Pages in the arena, 0 if it is not allocated
+    uint16_t free_pages;            // Pages not owned by any class
+    uint16_t peak_pages;            // Highest number of pages owned by classes
+    uint32_t slack_bytes;           // Bytes of owned pages not handed out
+    osi_slab_class_stats_t classes[OSI_SLAB_CLASS_NUM];
+} osi_slab_stats_t;
+
+// Allocates |size| bytes from the slab. Returns NULL if |size| is 0 or above
+// OSI_SLAB_MAX_SIZE, or if the arena is exhausted, in which case the caller
+// falls back to its usual heap allocation. Memory is 16 byte aligned.
+void *osi_slab_alloc(size_t size);
+
+// Returns |ptr| to the slab. Returns false, doing nothing, if |ptr| was not
+// allocated by osi_slab_alloc(), so that the caller can free it to the heap.
+// A pointer inside a page of the arena that holds no objects is reported and
+// dropped.
+bool osi_slab_free(void *ptr);
+
+// Fills |stats| with the current state of the slab.
+void osi_slab_get_stats(osi_slab_stats_t *stats);
+
+// Prints the slab statistics and the fragmentation of the internal heap.
+void osi_slab_show(void);
+
+// Releases the arena if no object is in use. It is allocated again on the
+// next call to osi_slab_alloc().
+void osi_slab_deinit(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _OSI_SLAB_H_ */
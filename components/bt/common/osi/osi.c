@@ -5,8 +5,10 @@
  */
 
 
+#include "bt_common.h"
 #include "osi/osi.h"
 #include "osi/mutex.h"
+#include "osi/slab.h"
 
 int osi_init(void)
 {
@@ -22,4 +24,7 @@ int osi_init(void)
 void osi_deinit(void)
 {
     osi_mutex_global_deinit();
+#if (OSI_SLAB_INCLUDED == TRUE)
+    osi_slab_deinit();
+#endif
 }
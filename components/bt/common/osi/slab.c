@@ -0,0 +1,380 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "bt_common.h"
+#include "osi/slab.h"
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+
+#if (OSI_SLAB_INCLUDED == TRUE)
+
+#define OSI_SLAB_ARENA_PAGES    ((OSI_SLAB_ARENA_SIZE * 1024) / OSI_SLAB_PAGE_SIZE)
+#define OSI_SLAB_ARENA_CAPS     (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT | MALLOC_CAP_DMA)
+#define OSI_SLAB_ALIGN          16
+#define OSI_SLAB_NO_PAGE        0xFFFF
+#define OSI_SLAB_NO_CLASS       0xFF
+
+// Free objects kept by each core, half of them are moved at a time
+#define OSI_SLAB_CACHE_SIZE     8
+
+typedef struct {
+    void *free;                 // Free objects of the page, not counting cached ones
+    uint16_t prev;              // Links of the class partial list, or of the free page list
+    uint16_t next;
+    uint8_t cls;
+    uint8_t used;               // Objects handed out or cached
+} osi_slab_page_t;
+
+typedef struct {
+    uint16_t partial;           // Pages with free objects
+    uint16_t pages;
+} osi_slab_class_t;
+
+typedef struct {
+    portMUX_TYPE lock;
+    uint8_t count[OSI_SLAB_CLASS_NUM];
+    void *obj[OSI_SLAB_CLASS_NUM][OSI_SLAB_CACHE_SIZE];
+    // Kept per core, so only the sum over cores is meaningful
+    int32_t in_use[OSI_SLAB_CLASS_NUM];
+    uint32_t allocs[OSI_SLAB_CLASS_NUM];
+    uint32_t fallbacks[OSI_SLAB_CLASS_NUM];
+} osi_slab_cache_t;
+
+typedef struct {
+    portMUX_TYPE lock;
+    uint8_t *base;
+    uint16_t free_pages;        // Head of the free page list
+    uint16_t free_count;
+    uint16_t peak_pages;
+    osi_slab_class_t classes[OSI_SLAB_CLASS_NUM];
+    osi_slab_page_t pages[OSI_SLAB_ARENA_PAGES];
+} osi_slab_arena_t;
+
+// Sizes of the classes, picked for the objects churned per packet: list and
+// queue nodes, BTC messages with their arguments, alarms and futures, and
+// BT_HDR buffers of short HCI events. All are multiples of OSI_SLAB_ALIGN.
+static const DRAM_ATTR uint16_t osi_slab_class_size[OSI_SLAB_CLASS_NUM] = {
+    16, 32, 48, 64, 96, 128, 160, 256
+};
+
+// Class of each size, indexed by the size in units of 16 bytes, rounded up
+static const DRAM_ATTR uint8_t osi_slab_size_class[OSI_SLAB_MAX_SIZE / 16 + 1] = {
+    0, 0, 1, 2, 3, 4, 4, 5, 5, 6, 6, 7, 7, 7, 7, 7, 7
+};
+
+static osi_slab_arena_t osi_slab = {
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+static osi_slab_cache_t osi_slab_caches[portNUM_PROCESSORS] = {
+    [0 ... portNUM_PROCESSORS - 1] = { .lock = portMUX_INITIALIZER_UNLOCKED },
+};
+
+static IRAM_ATTR void osi_slab_partial_push(osi_slab_class_t *cls, uint16_t index)
+{
+    osi_slab_page_t *page = &osi_slab.pages[index];
+
+    page->prev = OSI_SLAB_NO_PAGE;
+    page->next = cls->partial;
+    if (cls->partial != OSI_SLAB_NO_PAGE) {
+        osi_slab.pages[cls->partial].prev = index;
+    }
+    cls->partial = index;
+}
+
+static IRAM_ATTR void osi_slab_partial_remove(osi_slab_class_t *cls, uint16_t index)
+{
+    osi_slab_page_t *page = &osi_slab.pages[index];
+
+    if (page->prev != OSI_SLAB_NO_PAGE) {
+        osi_slab.pages[page->prev].next = page->next;
+    } else {
+        cls->partial = page->next;
+    }
+    if (page->next != OSI_SLAB_NO_PAGE) {
+        osi_slab.pages[page->next].prev = page->prev;
+    }
+}
+
+// Takes a page from the free page list and carves it into objects of class |c|
+static IRAM_ATTR bool osi_slab_page_new(uint8_t c)
+{
+    uint16_t index = osi_slab.free_pages;
+    uint16_t size = osi_slab_class_size[c];
+    osi_slab_page_t *page;
+    uint8_t *obj;
+
+    if (index == OSI_SLAB_NO_PAGE) {
+        return false;
+    }
+    page = &osi_slab.pages[index];
+    osi_slab.free_pages = page->next;
+    osi_slab.free_count--;
+    if (OSI_SLAB_ARENA_PAGES - osi_slab.free_count > osi_slab.peak_pages) {
+        osi_slab.peak_pages = OSI_SLAB_ARENA_PAGES - osi_slab.free_count;
+    }
+
+    page->cls = c;
+    page->used = 0;
+    page->free = NULL;
+    obj = osi_slab.base + index * OSI_SLAB_PAGE_SIZE;
+    for (int i = OSI_SLAB_PAGE_SIZE / size - 1; i >= 0; i--) {
+        *(void **)(obj + i * size) = page->free;
+        page->free = obj + i * size;
+    }
+
+    osi_slab.classes[c].pages++;
+    osi_slab_partial_push(&osi_slab.classes[c], index);
+    return true;
+}
+
+// Moves up to |count| free objects of class |c| into |cache|. Called with
+// the cache locked.
+static IRAM_ATTR void osi_slab_refill(osi_slab_cache_t *cache, uint8_t c, int count)
+{
+    osi_slab_class_t *cls = &osi_slab.classes[c];
+
+    portENTER_CRITICAL(&osi_slab.lock);
+    while (count > 0 && osi_slab.base) {
+        if (cls->partial == OSI_SLAB_NO_PAGE && !osi_slab_page_new(c)) {
+            break;
+        }
+        osi_slab_page_t *page = &osi_slab.pages[cls->partial];
+        while (count > 0 && page->free) {
+            void *obj = page->free;
+            page->free = *(void **)obj;
+            page->used++;
+            cache->obj[c][cache->count[c]++] = obj;
+            count--;
+        }
+        if (!page->free) {
+            osi_slab_partial_remove(cls, cls->partial);
+        }
+    }
+    portEXIT_CRITICAL(&osi_slab.lock);
+}
+
+// Returns |count| objects of class |c| from |cache| to their pages. Called
+// with the cache locked.
+static IRAM_ATTR void osi_slab_flush(osi_slab_cache_t *cache, uint8_t c, int count)
+{
+    osi_slab_class_t *cls = &osi_slab.classes[c];
+
+    portENTER_CRITICAL(&osi_slab.lock);
+    while (count-- > 0) {
+        uint8_t *obj = cache->obj[c][--cache->count[c]];
+        uint16_t index = (obj - osi_slab.base) / OSI_SLAB_PAGE_SIZE;
+        osi_slab_page_t *page = &osi_slab.pages[index];
+
+        if (!page->free) {
+            osi_slab_partial_push(cls, index);
+        }
+        *(void **)obj = page->free;
+        page->free = obj;
+        page->used--;
+
+        // Keep one page per class to avoid bouncing pages on every allocation
+        if (page->used == 0 && cls->pages > 1) {
+            osi_slab_partial_remove(cls, index);
+            cls->pages--;
+            page->cls = OSI_SLAB_NO_CLASS;
+            page->next = osi_slab.free_pages;
+            osi_slab.free_pages = index;
+            osi_slab.free_count++;
+        }
+    }
+    portEXIT_CRITICAL(&osi_slab.lock);
+}
+
+static void osi_slab_arena_create(void)
+{
+    uint8_t *base = heap_caps_aligned_alloc(OSI_SLAB_ALIGN, OSI_SLAB_ARENA_PAGES * OSI_SLAB_PAGE_SIZE,
+                                            OSI_SLAB_ARENA_CAPS);
+
+    if (base == NULL) {
+        return;
+    }
+
+    portENTER_CRITICAL(&osi_slab.lock);
+    if (osi_slab.base == NULL) {
+        for (int i = 0; i < OSI_SLAB_ARENA_PAGES; i++) {
+            osi_slab.pages[i].cls = OSI_SLAB_NO_CLASS;
+            osi_slab.pages[i].next = (i + 1 < OSI_SLAB_ARENA_PAGES) ? i + 1 : OSI_SLAB_NO_PAGE;
+        }
+        for (int i = 0; i < OSI_SLAB_CLASS_NUM; i++) {
+            osi_slab.classes[i].partial = OSI_SLAB_NO_PAGE;
+            osi_slab.classes[i].pages = 0;
+        }
+        osi_slab.free_pages = 0;
+        osi_slab.free_count = OSI_SLAB_ARENA_PAGES;
+        osi_slab.base = base;
+        base = NULL;
+    }
+    portEXIT_CRITICAL(&osi_slab.lock);
+
+    // Lost a race with another core
+    if (base) {
+        heap_caps_free(base);
+    }
+}
+
+IRAM_ATTR void *osi_slab_alloc(size_t size)
+{
+    osi_slab_cache_t *cache;
+    void *obj = NULL;
+    uint8_t c;
+
+    if (size == 0 || size > OSI_SLAB_MAX_SIZE) {
+        return NULL;
+    }
+    if (osi_slab.base == NULL) {
+        osi_slab_arena_create();
+    }
+
+    c = osi_slab_size_class[(size + 15) / 16];
+    // Migrating to the other core after this is harmless, the cache is locked
+    cache = &osi_slab_caches[xPortGetCoreID()];
+    portENTER_CRITICAL(&cache->lock);
+    if (cache->count[c] == 0) {
+        osi_slab_refill(cache, c, OSI_SLAB_CACHE_SIZE / 2);
+    }
+    if (cache->count[c] > 0) {
+        obj = cache->obj[c][--cache->count[c]];
+        cache->in_use[c]++;
+        cache->allocs[c]++;
+    } else {
+        cache->fallbacks[c]++;
+    }
+    portEXIT_CRITICAL(&cache->lock);
+
+    return obj;
+}
+
+IRAM_ATTR bool osi_slab_free(void *ptr)
+{
+    uint8_t *base = osi_slab.base;
+    osi_slab_cache_t *cache;
+    uint8_t c;
+
+    if (base == NULL || (uint8_t *)ptr < base ||
+        (uint8_t *)ptr >= base + OSI_SLAB_ARENA_PAGES * OSI_SLAB_PAGE_SIZE) {
+        return false;
+    }
+
+    c = osi_slab.pages[((uint8_t *)ptr - base) / OSI_SLAB_PAGE_SIZE].cls;
+    // Double free, or a pointer that was never handed out. It is inside the
+    // arena, so the heap must not see it either.
+    if (c == OSI_SLAB_NO_CLASS) {
+        OSI_TRACE_ERROR("%s %p is not in use\n", __func__, ptr);
+        return true;
+    }
+    cache = &osi_slab_caches[xPortGetCoreID()];
+    portENTER_CRITICAL(&cache->lock);
+    if (cache->count[c] == OSI_SLAB_CACHE_SIZE) {
+        osi_slab_flush(cache, c, OSI_SLAB_CACHE_SIZE / 2);
+    }
+    cache->obj[c][cache->count[c]++] = ptr;
+    cache->in_use[c]--;
+    portEXIT_CRITICAL(&cache->lock);
+
+    return true;
+}
+
+void osi_slab_get_stats(osi_slab_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+
+    for (int c = 0; c < OSI_SLAB_CLASS_NUM; c++) {
+        osi_slab_class_stats_t *cls = &stats->classes[c];
+        int32_t in_use = 0;
+
+        for (int i = 0; i < portNUM_PROCESSORS; i++) {
+            in_use += osi_slab_caches[i].in_use[c];
+            cls->allocs += osi_slab_caches[i].allocs[c];
+            cls->fallbacks += osi_slab_caches[i].fallbacks[c];
+        }
+        cls->size = osi_slab_class_size[c];
+        cls->in_use = in_use > 0 ? in_use : 0;
+    }
+
+    portENTER_CRITICAL(&osi_slab.lock);
+    if (osi_slab.base) {
+        stats->arena_pages = OSI_SLAB_ARENA_PAGES;
+        stats->free_pages = osi_slab.free_count;
+        for (int c = 0; c < OSI_SLAB_CLASS_NUM; c++) {
+            stats->classes[c].pages = osi_slab.classes[c].pages;
+        }
+    }
+    stats->peak_pages = osi_slab.peak_pages;
+    portEXIT_CRITICAL(&osi_slab.lock);
+
+    for (int c = 0; c < OSI_SLAB_CLASS_NUM; c++) {
+        const osi_slab_class_stats_t *cls = &stats->classes[c];
+        uint32_t capacity = cls->pages * (OSI_SLAB_PAGE_SIZE / cls->size) * cls->size;
+        uint32_t used = cls->in_use * cls->size;
+        stats->slack_bytes += capacity > used ? capacity - used : 0;
+    }
+}
+
+void osi_slab_show(void)
+{
+    osi_slab_stats_t stats;
+
+    osi_slab_get_stats(&stats);
+    printf("slab: pages %u/%u peak %u slack %uB\n", stats.arena_pages - stats.free_pages,
+           stats.arena_pages, stats.peak_pages, (unsigned)stats.slack_bytes);
+    for (int c = 0; c < OSI_SLAB_CLASS_NUM; c++) {
+        const osi_slab_class_stats_t *cls = &stats.classes[c];
+        printf("  %3u: pages %u in use %u allocs %u fallbacks %u\n", cls->size, cls->pages,
+               (unsigned)cls->in_use, (unsigned)cls->allocs, (unsigned)cls->fallbacks);
+    }
+    printf("internal heap: free %u largest block %u\n",
+           (unsigned)heap_caps_get_free_size(MALLOC_CAP_INTERNAL),
+           (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL));
+}
+
+void osi_slab_deinit(void)
+{
+    uint8_t *base = NULL;
+    bool in_use = false;
+
+    // Cached objects keep their pages in use, return them first
+    for (int i = 0; i < portNUM_PROCESSORS; i++) {
+        osi_slab_cache_t *cache = &osi_slab_caches[i];
+        portENTER_CRITICAL(&cache->lock);
+        for (int c = 0; c < OSI_SLAB_CLASS_NUM; c++) {
+            if (cache->count[c]) {
+                osi_slab_flush(cache, c, cache->count[c]);
+            }
+        }
+        portEXIT_CRITICAL(&cache->lock);
+    }
+
+    portENTER_CRITICAL(&osi_slab.lock);
+    for (int i = 0; osi_slab.base && i < OSI_SLAB_ARENA_PAGES; i++) {
+        if (osi_slab.pages[i].cls != OSI_SLAB_NO_CLASS && osi_slab.pages[i].used) {
+            in_use = true;
+            break;
+        }
+    }
+    if (!in_use) {
+        base = osi_slab.base;
+        osi_slab.base = NULL;
+    }
+    portEXIT_CRITICAL(&osi_slab.lock);
+
+    if (base) {
+        heap_caps_free(base);
+    } else if (in_use) {
+        // Objects of the controller or of another host may outlive Bluedroid
+        OSI_TRACE_DEBUG("%s objects still in use, keeping the arena\n", __func__);
+    }
+}
+
+#endif /* (OSI_SLAB_INCLUDED == TRUE) */
@@ -569,7 +569,8 @@ void bta_gattc_init_bk_conn(tBTA_GATTC_API_OPEN *p_data, tBTA_GATTC_RCB *p_clreg
                                           p_data->transport)) {
                 if ((p_clcb = bta_gattc_find_alloc_clcb(p_data->client_if, p_data->remote_bda,
                                                         BTA_GATT_TRANSPORT_LE)) != NULL) {
-                    gattc_data.hdr.layer_specific = p_clcb->bta_conn_id = conn_id;
+                    bta_gattc_clcb_set_conn(p_clcb, conn_id, p_clcb->bda, p_clcb->transport);
+                    gattc_data.hdr.layer_specific = conn_id;
 
                     /* open connection */
                     bta_gattc_sm_execute(p_clcb, BTA_GATTC_INT_CONN_EVT, &gattc_data);
@@ -670,14 +671,17 @@ void bta_gattc_cancel_open(tBTA_GATTC_CLCB *p_clcb, tBTA_GATTC_DATA *p_data)
 void bta_gattc_conn(tBTA_GATTC_CLCB *p_clcb, tBTA_GATTC_DATA *p_data)
 {
     tBTA_GATTC_IF   gatt_if;
+    BD_ADDR         bda;
+    tBTA_TRANSPORT  transport;
     APPL_TRACE_DEBUG("bta_gattc_conn server cache state=%d", p_clcb->p_srcb->state);
 
     if (p_data != NULL) {
         APPL_TRACE_DEBUG("bta_gattc_conn conn_id=%d", p_data->hdr.layer_specific);
-        p_clcb->bta_conn_id  = p_data->int_conn.hdr.layer_specific;
+        bdcpy(bda, p_clcb->bda);
+        transport = p_clcb->transport;
+        GATT_GetConnectionInfor(p_data->hdr.layer_specific, &gatt_if, bda, &transport);
 
-        GATT_GetConnectionInfor(p_data->hdr.layer_specific,
-                                &gatt_if, p_clcb->bda, &p_clcb->transport);
+        bta_gattc_clcb_set_conn(p_clcb, p_data->int_conn.hdr.layer_specific, bda, transport);
     }
 
     p_clcb->p_srcb->connected = TRUE;
@@ -2043,7 +2047,7 @@ void bta_gattc_proc_other_indication(tBTA_GATTC_CLCB *p_clcb, UINT8 op,
     p_notify->is_notify = (op == GATTC_OPTYPE_INDICATION) ? FALSE : TRUE;
     p_notify->len = p_data->att_value.len;
     bdcpy(p_notify->bda, p_clcb->bda);
-    memcpy(p_notify->value, p_data->att_value.value, p_data->att_value.len);
+    p_notify->value = p_data->att_value.value;
     p_notify->conn_id = p_clcb->bta_conn_id;
 
     if (p_clcb->p_rcb->p_cback) {
@@ -2111,8 +2115,7 @@ void bta_gattc_process_indicate(UINT16 conn_id, tGATTC_OPTYPE op, tGATT_CL_COMPL
                     return;
                 }
 
-                p_clcb->bta_conn_id = conn_id;
-                p_clcb->transport   = transport;
+                bta_gattc_clcb_set_conn(p_clcb, conn_id, remote_bda, transport);
 
                 bta_gattc_sm_execute(p_clcb, BTA_GATTC_INT_CONN_EVT, NULL);
             }
@@ -2257,7 +2260,8 @@ void bta_gattc_init_clcb_conn(UINT8 cif, BD_ADDR remote_bda)
 
     /* initiate a new connection here */
     if ((p_clcb = bta_gattc_clcb_alloc(cif, remote_bda, BTA_GATT_TRANSPORT_LE)) != NULL) {
-        gattc_data.hdr.layer_specific = p_clcb->bta_conn_id = conn_id;
+        bta_gattc_clcb_set_conn(p_clcb, conn_id, remote_bda, BTA_GATT_TRANSPORT_LE);
+        gattc_data.hdr.layer_specific = conn_id;
 
         gattc_data.api_conn.client_if = cif;
         memcpy(gattc_data.api_conn.remote_bda, remote_bda, BD_ADDR_LEN);
@@ -899,7 +899,6 @@ tBTA_GATT_STATUS BTA_GATTC_RegisterForNotifications (tBTA_GATTC_IF client_if,
 {
     tBTA_GATTC_RCB      *p_clreg;
     tBTA_GATT_STATUS    status = BTA_GATT_ILLEGAL_PARAMETER;
-    UINT8               i;
 
     if (!handle)
     {
@@ -908,32 +907,14 @@ tBTA_GATT_STATUS BTA_GATTC_RegisterForNotifications (tBTA_GATTC_IF client_if,
     }
 
     if ((p_clreg = bta_gattc_cl_get_regcb(client_if)) != NULL) {
-        for (i = 0; i < BTA_GATTC_NOTIF_REG_MAX; i ++) {
-            if ( p_clreg->notif_reg[i].in_use &&
-                    !memcmp(p_clreg->notif_reg[i].remote_bda, bda, BD_ADDR_LEN) &&
-                  p_clreg->notif_reg[i].handle == handle) {
-                APPL_TRACE_DEBUG("notification already registered");
-                status = BTA_GATT_OK;
-                break;
-            }
-        }
-        if (status != BTA_GATT_OK) {
-            for (i = 0; i < BTA_GATTC_NOTIF_REG_MAX; i ++) {
-                if (!p_clreg->notif_reg[i].in_use) {
-                    memset((void *)&p_clreg->notif_reg[i], 0, sizeof(tBTA_GATTC_NOTIF_REG));
-
-                    p_clreg->notif_reg[i].in_use = TRUE;
-                    memcpy(p_clreg->notif_reg[i].remote_bda, bda, BD_ADDR_LEN);
-
-                    p_clreg->notif_reg[i].handle = handle;
-                    status = BTA_GATT_OK;
-                    break;
-                }
-            }
-            if (i == BTA_GATTC_NOTIF_REG_MAX) {
-                status = BTA_GATT_NO_RESOURCES;
-                APPL_TRACE_ERROR("Max Notification Reached, registration failed,see CONFIG_BT_GATTC_NOTIF_REG_MAX in menuconfig");
-            }
+        if (bta_gattc_find_notif_reg(p_clreg, bda, handle) != NULL) {
+            APPL_TRACE_DEBUG("notification already registered");
+            status = BTA_GATT_OK;
+        } else if (bta_gattc_add_notif_reg(p_clreg, bda, handle) != NULL) {
+            status = BTA_GATT_OK;
+        } else {
+            status = BTA_GATT_NO_RESOURCES;
+            APPL_TRACE_ERROR("Max Notification Reached, registration failed,see CONFIG_BT_GATTC_NOTIF_REG_MAX in menuconfig");
         }
     } else {
         APPL_TRACE_ERROR("Client_if: %d Not Registered", client_if);
@@ -970,15 +951,12 @@ tBTA_GATT_STATUS BTA_GATTC_DeregisterForNotifications (tBTA_GATTC_IF client_if,
         return BTA_GATT_ILLEGAL_PARAMETER;
     }
 
-    for (int i = 0; i < BTA_GATTC_NOTIF_REG_MAX; i ++) {
-        if (p_clreg->notif_reg[i].in_use &&
-            !memcmp(p_clreg->notif_reg[i].remote_bda, bda, BD_ADDR_LEN) &&
-            p_clreg->notif_reg[i].handle == handle) {
-            APPL_TRACE_DEBUG("%s deregistered bd_addr:%02x:%02x:%02x:%02x:%02x:%02x",
-                __func__, bda[0], bda[1], bda[2], bda[3], bda[4], bda[5]);
-            memset(&p_clreg->notif_reg[i], 0, sizeof(tBTA_GATTC_NOTIF_REG));
-            return BTA_GATT_OK;
-        }
+    tBTA_GATTC_NOTIF_REG *p_reg = bta_gattc_find_notif_reg(p_clreg, bda, handle);
+    if (p_reg != NULL) {
+        APPL_TRACE_DEBUG("%s deregistered bd_addr:%02x:%02x:%02x:%02x:%02x:%02x",
+            __func__, bda[0], bda[1], bda[2], bda[3], bda[4], bda[5]);
+        bta_gattc_remove_notif_reg(p_clreg, p_reg);
+        return BTA_GATT_OK;
     }
 
     APPL_TRACE_ERROR("%s registration not found bd_addr:%02x:%02x:%02x:%02x:%02x:%02x",
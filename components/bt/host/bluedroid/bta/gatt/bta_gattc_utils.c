@@ -33,6 +33,7 @@
 #include "bta/utl.h"
 #include "bta/bta_sys.h"
 #include "bta_gattc_int.h"
+#include "gatt_int.h"
 #include "stack/l2c_api.h"
 #include "osi/allocator.h"
 
@@ -156,6 +157,80 @@ UINT8 bta_gattc_num_reg_app(void)
     }
     return j;
 }
+/*******************************************************************************
+**
+** Function         bta_gattc_addr_hash
+**
+** Description      bucket of the CLCB, server cache and connection address
+**                  indexes for a remote address.
+**
+** Returns          bucket index.
+**
+*******************************************************************************/
+static UINT8 bta_gattc_addr_hash(BD_ADDR bda)
+{
+    return (bda[3] ^ bda[4] ^ bda[5]) & (BTA_GATTC_ADDR_HASH_SIZE - 1);
+}
+
+/*******************************************************************************
+**
+** Function         bta_gattc_addr_link
+**
+** Description      add entry idx of a table to its address index.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void bta_gattc_addr_link(UINT8 *p_hash, UINT8 *p_next, BD_ADDR bda, UINT8 idx)
+{
+    UINT8 *p_head = &p_hash[bta_gattc_addr_hash(bda)];
+
+    p_next[idx] = *p_head;
+    *p_head = idx + 1;
+}
+
+/*******************************************************************************
+**
+** Function         bta_gattc_addr_unlink
+**
+** Description      remove entry idx of a table from its address index.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void bta_gattc_addr_unlink(UINT8 *p_hash, UINT8 *p_next, BD_ADDR bda, UINT8 idx)
+{
+    UINT8 *p_idx = &p_hash[bta_gattc_addr_hash(bda)];
+
+    while (*p_idx && *p_idx != idx + 1) {
+        p_idx = &p_next[*p_idx - 1];
+    }
+    if (*p_idx) {
+        *p_idx = p_next[idx];
+    }
+    p_next[idx] = 0;
+}
+
+/*******************************************************************************
+**
+** Function         bta_gattc_conn_slot
+**
+** Description      slot of the CLCB connection index for a connection ID.
+**
+** Returns          pointer to the slot, NULL if conn_id is out of range.
+**
+*******************************************************************************/
+static UINT8 *bta_gattc_conn_slot(UINT16 conn_id)
+{
+    UINT8       tcb_idx = GATT_GET_TCB_IDX(conn_id);
+    tGATT_IF    gatt_if = GATT_GET_GATT_IF(conn_id);
+
+    if (tcb_idx >= GATT_MAX_PHY_CHANNEL || gatt_if == 0 || gatt_if > GATT_MAX_APPS) {
+        return NULL;
+    }
+    return &bta_gattc_cb.clcb_by_conn[tcb_idx][gatt_if - 1];
+}
+
 /*******************************************************************************
 **
 ** Function         bta_gattc_find_clcb_by_cif
@@ -168,16 +243,18 @@ UINT8 bta_gattc_num_reg_app(void)
 tBTA_GATTC_CLCB *bta_gattc_find_clcb_by_cif (UINT8 client_if, BD_ADDR remote_bda,
         tBTA_TRANSPORT transport)
 {
-    tBTA_GATTC_CLCB *p_clcb = &bta_gattc_cb.clcb[0];
-    UINT8   i;
+    tBTA_GATTC_CLCB *p_clcb;
+    UINT8   i = bta_gattc_cb.clcb_hash[bta_gattc_addr_hash(remote_bda)];
 
-    for (i = 0; i < BTA_GATTC_CLCB_MAX; i ++, p_clcb ++) {
+    while (i) {
+        p_clcb = &bta_gattc_cb.clcb[i - 1];
         if (p_clcb->in_use &&
                 p_clcb->p_rcb->client_if == client_if &&
                 p_clcb->transport == transport &&
                 bdcmp(p_clcb->bda, remote_bda) == 0) {
             return p_clcb;
         }
+        i = bta_gattc_cb.clcb_next[i - 1];
     }
     return NULL;
 }
@@ -192,16 +269,76 @@ tBTA_GATTC_CLCB *bta_gattc_find_clcb_by_cif (UINT8 client_if, BD_ADDR remote_bda
 *******************************************************************************/
 tBTA_GATTC_CLCB *bta_gattc_find_clcb_by_conn_id (UINT16 conn_id)
 {
-    tBTA_GATTC_CLCB *p_clcb = &bta_gattc_cb.clcb[0];
+    tBTA_GATTC_CLCB *p_clcb;
+    UINT8 *p_slot = bta_gattc_conn_slot(conn_id);
+
+    if (p_slot == NULL || *p_slot == 0) {
+        return NULL;
+    }
+    p_clcb = &bta_gattc_cb.clcb[*p_slot - 1];
+    if (p_clcb->in_use &&
+            p_clcb->bta_conn_id == conn_id) {
+        return p_clcb;
+    }
+    return NULL;
+}
+
+/*******************************************************************************
+**
+** Function         bta_gattc_clcb_release_conn
+**
+** Description      drop a clcb from the connection index, handing its slot to
+**                  another clcb on the same connection if there is one.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void bta_gattc_clcb_release_conn(tBTA_GATTC_CLCB *p_clcb)
+{
+    UINT8 *p_slot = bta_gattc_conn_slot(p_clcb->bta_conn_id);
     UINT8 i;
 
-    for (i = 0; i < BTA_GATTC_CLCB_MAX; i ++, p_clcb ++) {
-        if (p_clcb->in_use &&
-                p_clcb->bta_conn_id == conn_id) {
-            return p_clcb;
+    if (p_slot == NULL || *p_slot != (UINT8)(p_clcb - bta_gattc_cb.clcb) + 1) {
+        return;
+    }
+    *p_slot = 0;
+    for (i = 0; i < BTA_GATTC_CLCB_MAX; i ++) {
+        if (&bta_gattc_cb.clcb[i] != p_clcb && bta_gattc_cb.clcb[i].in_use &&
+                bta_gattc_cb.clcb[i].bta_conn_id == p_clcb->bta_conn_id) {
+            *p_slot = i + 1;
+            break;
         }
     }
-    return NULL;
+}
+
+/*******************************************************************************
+**
+** Function         bta_gattc_clcb_set_conn
+**
+** Description      bind a clcb to a connection, keeping the connection and
+**                  address indexes in step.
+**
+** Returns          void
+**
+*******************************************************************************/
+void bta_gattc_clcb_set_conn(tBTA_GATTC_CLCB *p_clcb, UINT16 conn_id, BD_ADDR bda,
+                             tBTA_TRANSPORT transport)
+{
+    UINT8 idx = (UINT8)(p_clcb - bta_gattc_cb.clcb);
+    UINT8 *p_slot;
+
+    bta_gattc_clcb_release_conn(p_clcb);
+    if (bdcmp(p_clcb->bda, bda) != 0) {
+        bta_gattc_addr_unlink(bta_gattc_cb.clcb_hash, bta_gattc_cb.clcb_next, p_clcb->bda, idx);
+        bdcpy(p_clcb->bda, bda);
+        bta_gattc_addr_link(bta_gattc_cb.clcb_hash, bta_gattc_cb.clcb_next, p_clcb->bda, idx);
+    }
+    p_clcb->transport   = transport;
+    p_clcb->bta_conn_id = conn_id;
+
+    if ((p_slot = bta_gattc_conn_slot(conn_id)) != NULL) {
+        *p_slot = idx + 1;
+    }
 }
 
 /*******************************************************************************
@@ -241,6 +378,7 @@ tBTA_GATTC_CLCB *bta_gattc_clcb_alloc(tBTA_GATTC_IF client_if, BD_ADDR remote_bd
             if (p_clcb->p_rcb != NULL && p_clcb->p_srcb != NULL) {
                 p_clcb->p_srcb->num_clcb ++;
                 p_clcb->p_rcb->num_clcb ++;
+                bta_gattc_addr_link(bta_gattc_cb.clcb_hash, bta_gattc_cb.clcb_next, p_clcb->bda, i_clcb);
             } else {
                 /* release this clcb if clcb or srcb allocation failed */
                 p_clcb->in_use = FALSE;
@@ -316,6 +454,9 @@ void bta_gattc_clcb_dealloc(tBTA_GATTC_CLCB *p_clcb)
         osi_free((void *)p_clcb->p_cmd_list);
         p_clcb->p_cmd_list = NULL;
         //osi_free_and_reset((void **)&p_clcb->p_q_cmd);
+        bta_gattc_clcb_release_conn(p_clcb);
+        bta_gattc_addr_unlink(bta_gattc_cb.clcb_hash, bta_gattc_cb.clcb_next, p_clcb->bda,
+                              (UINT8)(p_clcb - bta_gattc_cb.clcb));
         memset(p_clcb, 0, sizeof(tBTA_GATTC_CLCB));
     } else {
         APPL_TRACE_ERROR("bta_gattc_clcb_dealloc p_clcb=NULL");
@@ -348,13 +489,15 @@ void bta_gattc_clcb_dealloc_by_conn_id(UINT16 conn_id)
 *******************************************************************************/
 tBTA_GATTC_SERV *bta_gattc_find_srcb(BD_ADDR bda)
 {
-    tBTA_GATTC_SERV *p_srcb = &bta_gattc_cb.known_server[0];
-    UINT8   i;
+    tBTA_GATTC_SERV *p_srcb;
+    UINT8   i = bta_gattc_cb.srcb_hash[bta_gattc_addr_hash(bda)];
 
-    for (i = 0; i < BTA_GATTC_KNOWN_SR_MAX; i ++, p_srcb ++) {
+    while (i) {
+        p_srcb = &bta_gattc_cb.known_server[i - 1];
         if (p_srcb->in_use && bdcmp(p_srcb->server_bda, bda) == 0) {
             return p_srcb;
         }
+        i = bta_gattc_cb.srcb_next[i - 1];
     }
     return NULL;
 }
@@ -434,6 +577,10 @@ tBTA_GATTC_SERV *bta_gattc_srcb_alloc(BD_ADDR bda)
 
     if (p_tcb != NULL)
     {
+        i = (UINT8)(p_tcb - bta_gattc_cb.known_server);
+        if (p_tcb->in_use) {
+            bta_gattc_addr_unlink(bta_gattc_cb.srcb_hash, bta_gattc_cb.srcb_next, p_tcb->server_bda, i);
+        }
         if (p_tcb->p_srvc_cache != NULL) {
             list_free(p_tcb->p_srvc_cache);
             p_tcb->p_srvc_cache = NULL;
@@ -445,6 +592,7 @@ tBTA_GATTC_SERV *bta_gattc_srcb_alloc(BD_ADDR bda)
 
         p_tcb->in_use = TRUE;
         bdcpy(p_tcb->server_bda, bda);
+        bta_gattc_addr_link(bta_gattc_cb.srcb_hash, bta_gattc_cb.srcb_next, p_tcb->server_bda, i);
     }
     return p_tcb;
 }
@@ -544,6 +692,108 @@ BOOLEAN bta_gattc_enqueue(tBTA_GATTC_CLCB *p_clcb, tBTA_GATTC_DATA *p_data)
     return FALSE;
 }
 
+/*******************************************************************************
+**
+** Function         bta_gattc_notif_hash
+**
+** Description      hash a notification registration into one of the buckets
+**                  of the registry.
+**
+** Returns          bucket index.
+**
+*******************************************************************************/
+static UINT8 bta_gattc_notif_hash(BD_ADDR remote_bda, UINT16 handle)
+{
+    /* the low address bytes are enough to tell servers apart */
+    UINT32 hash = ((UINT32)remote_bda[3] << 24 | (UINT32)remote_bda[4] << 16 | remote_bda[5]) ^ handle;
+
+    hash *= 0x9E3779B1;
+    return (UINT8)((hash >> 24) & (BTA_GATTC_NOTIF_HASH_SIZE - 1));
+}
+
+/*******************************************************************************
+**
+** Function         bta_gattc_find_notif_reg
+**
+** Description      find the notification registration of an application for
+**                  a characteristic of a server.
+**
+** Returns          pointer to the registration, NULL if not registered.
+**
+*******************************************************************************/
+tBTA_GATTC_NOTIF_REG *bta_gattc_find_notif_reg(tBTA_GATTC_RCB *p_clreg, BD_ADDR remote_bda, UINT16 handle)
+{
+    UINT8 idx = p_clreg->notif_hash[bta_gattc_notif_hash(remote_bda, handle)];
+
+    while (idx != 0 && idx <= BTA_GATTC_NOTIF_REG_MAX) {
+        tBTA_GATTC_NOTIF_REG *p_reg = &p_clreg->notif_reg[idx - 1];
+        if (p_reg->in_use && p_reg->handle == handle &&
+            bdcmp(p_reg->remote_bda, remote_bda) == 0) {
+            return p_reg;
+        }
+        idx = p_reg->next;
+    }
+
+    return NULL;
+}
+
+/*******************************************************************************
+**
+** Function         bta_gattc_add_notif_reg
+**
+** Description      allocate a notification registration and link it into the
+**                  registry. The caller checks that it is not registered yet.
+**
+** Returns          pointer to the registration, NULL if the registry is full.
+**
+*******************************************************************************/
+tBTA_GATTC_NOTIF_REG *bta_gattc_add_notif_reg(tBTA_GATTC_RCB *p_clreg, BD_ADDR remote_bda, UINT16 handle)
+{
+    UINT8 bucket = bta_gattc_notif_hash(remote_bda, handle);
+
+    for (UINT8 i = 0; i < BTA_GATTC_NOTIF_REG_MAX; i ++) {
+        tBTA_GATTC_NOTIF_REG *p_reg = &p_clreg->notif_reg[i];
+        if (!p_reg->in_use) {
+            memset(p_reg, 0, sizeof(tBTA_GATTC_NOTIF_REG));
+            bdcpy(p_reg->remote_bda, remote_bda);
+            p_reg->handle = handle;
+            /* complete the entry before it becomes reachable from the bucket */
+            p_reg->next = p_clreg->notif_hash[bucket];
+            p_reg->in_use = TRUE;
+            p_clreg->notif_hash[bucket] = i + 1;
+            return p_reg;
+        }
+    }
+
+    return NULL;
+}
+
+/*******************************************************************************
+**
+** Function         bta_gattc_remove_notif_reg
+**
+** Description      unlink a notification registration from the registry and
+**                  free it.
+**
+** Returns          None.
+**
+*******************************************************************************/
+void bta_gattc_remove_notif_reg(tBTA_GATTC_RCB *p_clreg, tBTA_GATTC_NOTIF_REG *p_reg)
+{
+    UINT8 target = (UINT8)(p_reg - p_clreg->notif_reg) + 1;
+    UINT8 *p_link = &p_clreg->notif_hash[bta_gattc_notif_hash(p_reg->remote_bda, p_reg->handle)];
+
+    while (*p_link != 0 && *p_link <= BTA_GATTC_NOTIF_REG_MAX) {
+        if (*p_link == target) {
+            *p_link = p_reg->next;
+            break;
+        }
+        p_link = &p_clreg->notif_reg[*p_link - 1].next;
+    }
+
+    memset(p_reg, 0, sizeof(tBTA_GATTC_NOTIF_REG));
+}
+
 /*******************************************************************************
 **
 ** Function         bta_gattc_check_notif_registry
@@ -556,17 +806,9 @@ BOOLEAN bta_gattc_enqueue(tBTA_GATTC_CLCB *p_clcb, tBTA_GATTC_DATA *p_data)
 BOOLEAN bta_gattc_check_notif_registry(tBTA_GATTC_RCB  *p_clreg, tBTA_GATTC_SERV *p_srcb,
                                        tBTA_GATTC_NOTIFY  *p_notify)
 {
-    UINT8           i;
-
-    for (i = 0 ; i < BTA_GATTC_NOTIF_REG_MAX; i ++)
-    {
-        if (p_clreg->notif_reg[i].in_use &&
-            bdcmp(p_clreg->notif_reg[i].remote_bda, p_srcb->server_bda) == 0 &&
-            p_clreg->notif_reg[i].handle == p_notify->handle)
-        {
-            APPL_TRACE_DEBUG("Notification registered!");
-            return TRUE;
-        }
+    if (bta_gattc_find_notif_reg(p_clreg, p_srcb->server_bda, p_notify->handle) != NULL) {
+        APPL_TRACE_DEBUG("Notification registered!");
+        return TRUE;
     }
     return FALSE;
 
@@ -604,7 +846,7 @@ void bta_gattc_clear_notif_registration(tBTA_GATTC_SERV *p_srcb, UINT16 conn_id,
                      */
                     handle = p_clrcb->notif_reg[i].handle;
                     if (handle >= start_handle && handle <= end_handle) {
-                        memset(&p_clrcb->notif_reg[i], 0, sizeof(tBTA_GATTC_NOTIF_REG));
+                        bta_gattc_remove_notif_reg(p_clrcb, &p_clrcb->notif_reg[i]);
                     }
                 }
             }
@@ -634,7 +876,7 @@ void bta_gattc_clear_notif_registration_by_bda(tBTA_GATTC_RCB *p_clrcb, BD_ADDR
         if (p_clrcb->notif_reg[i].in_use &&
             !bdcmp(p_clrcb->notif_reg[i].remote_bda, remote_bda))
         {
-            memset(&p_clrcb->notif_reg[i], 0, sizeof(tBTA_GATTC_NOTIF_REG));
+            bta_gattc_remove_notif_reg(p_clrcb, &p_clrcb->notif_reg[i]);
         }
     }
 }
@@ -849,6 +1091,7 @@ tBTA_GATTC_CONN *bta_gattc_conn_alloc(BD_ADDR remote_bda)
 #endif
             p_conn->in_use          = TRUE;
             bdcpy(p_conn->remote_bda, remote_bda);
+            bta_gattc_addr_link(bta_gattc_cb.conn_hash, bta_gattc_cb.conn_next, p_conn->remote_bda, i_conn);
             return p_conn;
         }
     }
@@ -866,16 +1109,18 @@ tBTA_GATTC_CONN *bta_gattc_conn_alloc(BD_ADDR remote_bda)
 *******************************************************************************/
 tBTA_GATTC_CONN *bta_gattc_conn_find(BD_ADDR remote_bda)
 {
-    UINT8               i_conn = 0;
-    tBTA_GATTC_CONN     *p_conn = &bta_gattc_cb.conn_track[0];
+    UINT8               i_conn = bta_gattc_cb.conn_hash[bta_gattc_addr_hash(remote_bda)];
+    tBTA_GATTC_CONN     *p_conn;
 
-    for (i_conn = 0; i_conn < BTA_GATTC_CONN_MAX; i_conn++, p_conn ++) {
+    while (i_conn) {
+        p_conn = &bta_gattc_cb.conn_track[i_conn - 1];
         if (p_conn->in_use && bdcmp(remote_bda, p_conn->remote_bda) == 0) {
 #if BTA_GATT_DEBUG == TRUE
-            APPL_TRACE_DEBUG("bta_gattc_conn_find: found conn_track[%d] matched", i_conn);
+            APPL_TRACE_DEBUG("bta_gattc_conn_find: found conn_track[%d] matched", i_conn - 1);
 #endif
             return p_conn;
         }
+        i_conn = bta_gattc_cb.conn_next[i_conn - 1];
     }
     return NULL;
 }
@@ -914,6 +1159,8 @@ BOOLEAN bta_gattc_conn_dealloc(BD_ADDR remote_bda)
     tBTA_GATTC_CONN     *p_conn = bta_gattc_conn_find (remote_bda);
 
     if (p_conn != NULL) {
+        bta_gattc_addr_unlink(bta_gattc_cb.conn_hash, bta_gattc_cb.conn_next, p_conn->remote_bda,
+                              (UINT8)(p_conn - bta_gattc_cb.conn_track));
         p_conn->in_use = FALSE;
         memset(p_conn->remote_bda, 0, BD_ADDR_LEN);
         return TRUE;
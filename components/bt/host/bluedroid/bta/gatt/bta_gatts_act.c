@@ -297,6 +297,36 @@ void bta_gatts_deregister(tBTA_GATTS_CB *p_cb, tBTA_GATTS_DATA *p_msg)
         APPL_TRACE_ERROR("application not registered.");
     }
 }
+/*******************************************************************************
+**
+** Function         bta_gatts_create_srvc_db
+**
+** Description      create a service in the GATT database and record it in the
+**                  allocated service control block, released on failure.
+**
+** Returns          service ID, 0 if failed.
+**
+*******************************************************************************/
+static UINT16 bta_gatts_create_srvc_db(tBTA_GATTS_CB *p_cb, UINT8 rcb_idx, UINT8 srvc_idx,
+                                       tBT_UUID *p_uuid, UINT8 inst, UINT16 num_handle, BOOLEAN is_pri)
+{
+    UINT16 service_id;
+
+    service_id = GATTS_CreateService (p_cb->rcb[rcb_idx].gatt_if, p_uuid, inst, num_handle, is_pri);
+
+    if (service_id != 0) {
+        memcpy(&p_cb->srvc_cb[srvc_idx].service_uuid, p_uuid, sizeof(tBT_UUID));
+        p_cb->srvc_cb[srvc_idx].service_id   = service_id;
+        p_cb->srvc_cb[srvc_idx].inst_num     = inst;
+        p_cb->srvc_cb[srvc_idx].idx          = srvc_idx;
+    } else {
+        memset(&p_cb->srvc_cb[srvc_idx], 0, sizeof(tBTA_GATTS_SRVC_CB));
+        APPL_TRACE_ERROR("service creation failed.");
+    }
+
+    return service_id;
+}
+
 /*******************************************************************************
 **
 ** Function         bta_gatts_create_srvc
@@ -322,19 +352,13 @@ void bta_gatts_create_srvc(tBTA_GATTS_CB *p_cb, tBTA_GATTS_DATA *p_msg)
     if (rcb_idx != BTA_GATTS_INVALID_APP) {
         if ((srvc_idx = bta_gatts_alloc_srvc_cb(p_cb, rcb_idx)) != BTA_GATTS_INVALID_APP) {
             /* create the service now */
-            service_id = GATTS_CreateService (p_cb->rcb[rcb_idx].gatt_if,
-                                              &p_msg->api_create_svc.service_uuid,
-                                              p_msg->api_create_svc.inst,
-                                              p_msg->api_create_svc.num_handle,
-                                              p_msg->api_create_svc.is_pri);
+            service_id = bta_gatts_create_srvc_db(p_cb, rcb_idx, srvc_idx,
+                                                  &p_msg->api_create_svc.service_uuid,
+                                                  p_msg->api_create_svc.inst,
+                                                  p_msg->api_create_svc.num_handle,
+                                                  p_msg->api_create_svc.is_pri);
 
             if (service_id != 0) {
-                memcpy(&p_cb->srvc_cb[srvc_idx].service_uuid,
-                       &p_msg->api_create_svc.service_uuid, sizeof(tBT_UUID));
-                p_cb->srvc_cb[srvc_idx].service_id   = service_id;
-                p_cb->srvc_cb[srvc_idx].inst_num     = p_msg->api_create_svc.inst;
-                p_cb->srvc_cb[srvc_idx].idx          = srvc_idx;
-
                 cb_data.create.status      = BTA_GATT_OK;
                 cb_data.create.service_id  = service_id;
 
@@ -343,8 +367,6 @@ void bta_gatts_create_srvc(tBTA_GATTS_CB *p_cb, tBTA_GATTS_DATA *p_msg)
                 cb_data.create.server_if   = p_cb->rcb[rcb_idx].gatt_if;
             } else {
                 cb_data.status  = BTA_GATT_ERROR;
-                memset(&p_cb->srvc_cb[srvc_idx], 0, sizeof(tBTA_GATTS_SRVC_CB));
-                APPL_TRACE_ERROR("service creation failed.");
             }
 
             memcpy(&cb_data.create.uuid, &p_msg->api_create_svc.service_uuid, sizeof(tBT_UUID));
@@ -360,6 +382,103 @@ void bta_gatts_create_srvc(tBTA_GATTS_CB *p_cb, tBTA_GATTS_DATA *p_msg)
 }
 /*******************************************************************************
 **
+** Function         bta_gatts_create_attr_tab
+**
+** Description      action function to create a service and its attributes
+**                  from an attribute table.
+**
+** Returns          none.
+**
+*******************************************************************************/
+void bta_gatts_create_attr_tab(tBTA_GATTS_CB *p_cb, tBTA_GATTS_DATA *p_msg)
+{
+    tBTA_GATTS_API_CREATE_ATTR_TAB *p_api = &p_msg->api_create_attr_tab;
+    UINT16              *p_handles = p_api->p_handles;
+    tBTA_GATTS          cb_data;
+    UINT8               rcb_idx;
+    UINT8               srvc_idx;
+    UINT16              service_id = 0;
+
+    rcb_idx = bta_gatts_find_app_rcb_idx_by_app_if(p_cb, p_api->server_if);
+    if (rcb_idx == BTA_GATTS_INVALID_APP) {
+        APPL_TRACE_ERROR("Application not registered");
+        return;
+    }
+
+    memset(&cb_data, 0, sizeof(tBTA_GATTS));
+    cb_data.create_attr_tab.server_if = p_cb->rcb[rcb_idx].gatt_if;
+    cb_data.create_attr_tab.svc_instance = p_api->inst;
+    cb_data.create_attr_tab.num_handle = p_api->num_entry;
+    cb_data.create_attr_tab.handles = p_handles;
+
+    for (UINT16 i = 0; i < p_api->num_entry; i++) {
+        tBTA_GATTS_ATTR_TAB_ENTRY *p_entry = &p_api->p_tab[i];
+        tGATT_ATTR_VAL *p_attr_val = NULL;
+        tGATTS_ATTR_CONTROL *p_control = NULL;
+        UINT16 attr_id;
+
+        if (p_entry->attr_val.attr_max_len != 0) {
+            p_attr_val = &p_entry->attr_val;
+        }
+        if (p_entry->control.auto_rsp != 0) {
+            p_control = &p_entry->control;
+        }
+
+        switch (p_entry->type) {
+        case BTA_GATTS_ATTR_TAB_PRI_SRVC:
+        case BTA_GATTS_ATTR_TAB_SEC_SRVC:
+            if (service_id != 0) {
+                APPL_TRACE_ERROR("%s only one service per table", __func__);
+                break;
+            }
+            memcpy(&cb_data.create_attr_tab.uuid, &p_entry->uuid, sizeof(tBT_UUID));
+            if ((srvc_idx = bta_gatts_alloc_srvc_cb(p_cb, rcb_idx)) != BTA_GATTS_INVALID_APP) {
+                service_id = bta_gatts_create_srvc_db(p_cb, rcb_idx, srvc_idx, &p_entry->uuid,
+                                                      p_api->inst, p_api->num_entry,
+                                                      p_entry->type == BTA_GATTS_ATTR_TAB_PRI_SRVC);
+            }
+            p_handles[i] = service_id;
+            break;
+        case BTA_GATTS_ATTR_TAB_INCL_SRVC:
+            if (service_id != 0) {
+                p_handles[i] = GATTS_AddIncludeService(service_id, p_entry->incl_srvc_id);
+            }
+            break;
+        case BTA_GATTS_ATTR_TAB_CHAR:
+            /* the declaration and the value take two entries */
+            if (service_id != 0 && i + 1 < p_api->num_entry) {
+                attr_id = GATTS_AddCharacteristic(service_id, &p_entry->uuid, p_entry->perm,
+                                                  p_entry->property, p_attr_val, p_control);
+                if (attr_id != 0) {
+                    p_handles[i] = attr_id - 1;
+                    p_handles[i + 1] = attr_id;
+                }
+            }
+            break;
+        case BTA_GATTS_ATTR_TAB_DESCR:
+            if (service_id != 0) {
+                p_handles[i] = GATTS_AddCharDescriptor(service_id, p_entry->perm, &p_entry->uuid,
+                                                       p_attr_val, p_control);
+            }
+            break;
+        default:
+            break;
+        }
+
+        if (p_entry->type != BTA_GATTS_ATTR_TAB_SKIP && service_id != 0 && p_handles[i] == 0) {
+            APPL_TRACE_ERROR("%s failed to add attribute %d", __func__, i);
+        }
+    }
+
+    cb_data.create_attr_tab.service_id = service_id;
+    cb_data.create_attr_tab.status = (service_id != 0) ? BTA_GATT_OK : BTA_GATT_ERROR;
+
+    if (p_cb->rcb[rcb_idx].p_cback) {
+        (*p_cb->rcb[rcb_idx].p_cback)(BTA_GATTS_CREATE_ATTR_TAB_EVT, &cb_data);
+    }
+}
+/*******************************************************************************
+**
 ** Function         bta_gatts_add_include_srvc
 **
 ** Description      action function to add an included service.
@@ -314,6 +314,69 @@ void BTA_GATTS_AddCharDescriptor (UINT16 service_id,
 
 }
 
+/*******************************************************************************
+**
+** Function         BTA_GATTS_CreateAttrTab
+**
+** Description      Create a service and all its attributes from a table in one
+**                  request. Attributes are added in table order after the
+**                  service declaration entry. When it's done, a callback event
+**                  BTA_GATTS_CREATE_ATTR_TAB_EVT reports the status and the
+**                  handle of each entry.
+**
+** Parameters       server_if: server interface.
+**                  inst: instance ID number of this service.
+**                  p_tab: attribute table, values are copied.
+**                  num_entry: number of entries, also the number of handles
+**                             requested for the service.
+**
+** Returns          BTA_GATT_OK if the request was sent, BTA_GATT_NO_RESOURCES
+**                  if it could not be allocated, in which case no event
+**                  follows.
+**
+*******************************************************************************/
+tBTA_GATT_STATUS BTA_GATTS_CreateAttrTab(tBTA_GATTS_IF server_if, UINT8 inst,
+                                         const tBTA_GATTS_ATTR_TAB_ENTRY *p_tab, UINT16 num_entry)
+{
+    tBTA_GATTS_API_CREATE_ATTR_TAB *p_buf;
+    size_t tab_len = num_entry * sizeof(tBTA_GATTS_ATTR_TAB_ENTRY);
+    size_t handles_len = num_entry * sizeof(UINT16);
+    size_t len = sizeof(tBTA_GATTS_API_CREATE_ATTR_TAB) + tab_len + handles_len;
+    UINT8 *p_value;
+
+    for (UINT16 i = 0; i < num_entry; i++) {
+        if (p_tab[i].attr_val.attr_val != NULL) {
+            len += p_tab[i].attr_val.attr_len;
+        }
+    }
+
+    if ((p_buf = (tBTA_GATTS_API_CREATE_ATTR_TAB *) osi_malloc(len)) != NULL) {
+        p_buf->hdr.event = BTA_GATTS_API_CREATE_ATTR_TAB_EVT;
+        p_buf->server_if = server_if;
+        p_buf->inst = inst;
+        p_buf->num_entry = num_entry;
+        p_buf->p_tab = (tBTA_GATTS_ATTR_TAB_ENTRY *)(p_buf + 1);
+        p_buf->p_handles = (UINT16 *)((UINT8 *)p_buf->p_tab + tab_len);
+        memcpy(p_buf->p_tab, p_tab, tab_len);
+        memset(p_buf->p_handles, 0, handles_len);
+
+        /* Values are copied after the handles, so the caller's table can go away */
+        p_value = (UINT8 *)p_buf->p_handles + handles_len;
+        for (UINT16 i = 0; i < num_entry; i++) {
+            tBTA_GATT_ATTR_VAL *p_attr_val = &p_buf->p_tab[i].attr_val;
+            if (p_attr_val->attr_val != NULL) {
+                memcpy(p_value, p_attr_val->attr_val, p_attr_val->attr_len);
+                p_attr_val->attr_val = p_value;
+                p_value += p_attr_val->attr_len;
+            }
+        }
+
+        bta_sys_sendmsg(p_buf);
+        return BTA_GATT_OK;
+    }
+    return BTA_GATT_NO_RESOURCES;
+}
+
 /*******************************************************************************
  **
  ** Function         BTA_GATTS_DeleteService
@@ -87,6 +87,10 @@ BOOLEAN bta_gatts_hdl_event(BT_HDR *p_msg)
         bta_gatts_create_srvc(p_cb, (tBTA_GATTS_DATA *) p_msg);
         break;
 
+    case BTA_GATTS_API_CREATE_ATTR_TAB_EVT:
+        bta_gatts_create_attr_tab(p_cb, (tBTA_GATTS_DATA *) p_msg);
+        break;
+
     case BTA_GATTS_API_INDICATION_EVT:
         bta_gatts_indicate_handle(p_cb, (tBTA_GATTS_DATA *) p_msg);
         break;
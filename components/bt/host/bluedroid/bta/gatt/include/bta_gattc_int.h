@@ -107,6 +107,9 @@ typedef enum {
 #define BTA_GATTC_CLCB_MAX      GATT_CL_MAX_LCB
 #endif
 
+/* Number of buckets of the CLCB, server cache and connection address indexes, a power of 2 */
+#define BTA_GATTC_ADDR_HASH_SIZE    16
+
 #define BTA_GATTC_WRITE_PREPARE          GATT_WRITE_PREPARE
 #define BTA_GATTC_INVALID_HANDLE         0
 
@@ -319,10 +322,20 @@ typedef struct {
     bool                update_incl_srvc;
 } tBTA_GATTC_SERV;
 
+/* Number of buckets indexing the notification registry, a power of 2 */
+#if (BTA_GATTC_NOTIF_REG_MAX <= 8)
+#define BTA_GATTC_NOTIF_HASH_SIZE   8
+#elif (BTA_GATTC_NOTIF_REG_MAX <= 32)
+#define BTA_GATTC_NOTIF_HASH_SIZE   32
+#else
+#define BTA_GATTC_NOTIF_HASH_SIZE   64
+#endif
+
 typedef struct {
     BOOLEAN             in_use;
     BD_ADDR             remote_bda;
     UINT16              handle;
+    UINT8               next;           /* index + 1 of the next entry in the same bucket, 0 if none */
 }tBTA_GATTC_NOTIF_REG;
 
 typedef struct {
@@ -333,6 +346,7 @@ typedef struct {
     BOOLEAN                 dereg_pending;
     tBT_UUID                app_uuid;
     tBTA_GATTC_NOTIF_REG    notif_reg[BTA_GATTC_NOTIF_REG_MAX];
+    UINT8                   notif_hash[BTA_GATTC_NOTIF_HASH_SIZE]; /* index + 1 of the first entry of each bucket */
 } tBTA_GATTC_RCB;
 
 /* client channel is a mapping between a BTA client(cl_id) and a remote BD address */
@@ -398,6 +412,15 @@ typedef struct {
 
     tBTA_GATTC_CLCB     clcb[BTA_GATTC_CLCB_MAX];
     tBTA_GATTC_SERV     known_server[BTA_GATTC_KNOWN_SR_MAX];
+
+    /* indexes of the tables above, entries hold index + 1 and 0 if none */
+    UINT8               clcb_by_conn[GATT_MAX_PHY_CHANNEL][GATT_MAX_APPS]; /* by tcb index and gatt_if of conn_id */
+    UINT8               clcb_hash[BTA_GATTC_ADDR_HASH_SIZE];
+    UINT8               clcb_next[BTA_GATTC_CLCB_MAX];
+    UINT8               srcb_hash[BTA_GATTC_ADDR_HASH_SIZE];
+    UINT8               srcb_next[BTA_GATTC_KNOWN_SR_MAX];
+    UINT8               conn_hash[BTA_GATTC_ADDR_HASH_SIZE];
+    UINT8               conn_next[BTA_GATTC_CONN_MAX];
 }tBTA_GATTC_CB;
 
 typedef enum {
@@ -491,6 +514,8 @@ extern void bta_gattc_broadcast(tBTA_GATTC_CB *p_cb, tBTA_GATTC_DATA *p_msg);
 /* utility functions */
 extern tBTA_GATTC_CLCB *bta_gattc_find_clcb_by_cif (UINT8 client_if, BD_ADDR remote_bda, tBTA_TRANSPORT transport);
 extern tBTA_GATTC_CLCB *bta_gattc_find_clcb_by_conn_id (UINT16 conn_id);
+extern void bta_gattc_clcb_set_conn(tBTA_GATTC_CLCB *p_clcb, UINT16 conn_id, BD_ADDR bda,
+                                    tBTA_TRANSPORT transport);
 extern tBTA_GATTC_CLCB *bta_gattc_clcb_alloc(tBTA_GATTC_IF client_if, BD_ADDR remote_bda, tBTA_TRANSPORT transport);
 extern void bta_gattc_clcb_dealloc(tBTA_GATTC_CLCB *p_clcb);
 extern tBTA_GATTC_CLCB *bta_gattc_find_alloc_clcb(tBTA_GATTC_IF client_if, BD_ADDR remote_bda, tBTA_TRANSPORT transport);
@@ -510,6 +535,9 @@ extern BOOLEAN bta_gattc_check_bg_conn (tBTA_GATTC_IF client_if,  BD_ADDR remote
 extern UINT8 bta_gattc_num_reg_app(void);
 extern void bta_gattc_clear_notif_registration(tBTA_GATTC_SERV *p_srcb, UINT16 conn_id, UINT16 start_handle, UINT16 end_handle);
 extern void bta_gattc_clear_notif_registration_by_bda(tBTA_GATTC_RCB *p_clrcb, BD_ADDR remote_bda);
+extern tBTA_GATTC_NOTIF_REG *bta_gattc_find_notif_reg(tBTA_GATTC_RCB *p_clreg, BD_ADDR remote_bda, UINT16 handle);
+extern tBTA_GATTC_NOTIF_REG *bta_gattc_add_notif_reg(tBTA_GATTC_RCB *p_clreg, BD_ADDR remote_bda, UINT16 handle);
+extern void bta_gattc_remove_notif_reg(tBTA_GATTC_RCB *p_clreg, tBTA_GATTC_NOTIF_REG *p_reg);
 extern tBTA_GATTC_SERV * bta_gattc_find_srvr_cache(BD_ADDR bda);
 
 /* discovery functions */
@@ -54,7 +54,8 @@ enum {
     BTA_GATTS_API_LISTEN_EVT,
     BTA_GATTS_API_DISABLE_EVT,
     BTA_GATTS_API_SEND_SERVICE_CHANGE_EVT,
-    BTA_GATTS_API_SHOW_LOCAL_DATABASE_EVT
+    BTA_GATTS_API_SHOW_LOCAL_DATABASE_EVT,
+    BTA_GATTS_API_CREATE_ATTR_TAB_EVT
 };
 typedef UINT16 tBTA_GATTS_INT_EVT;
 
@@ -102,6 +103,16 @@ typedef struct {
     UINT16                  included_service_id;
 } tBTA_GATTS_API_ADD_INCL_SRVC;
 
+/* The table, the handles and the attribute values follow in the same buffer */
+typedef struct {
+    BT_HDR                      hdr;
+    tBTA_GATTS_IF               server_if;
+    UINT8                       inst;
+    UINT16                      num_entry;
+    tBTA_GATTS_ATTR_TAB_ENTRY   *p_tab;
+    UINT16                      *p_handles;
+} tBTA_GATTS_API_CREATE_ATTR_TAB;
+
 typedef struct {
     BT_HDR                  hdr;
     tBT_UUID                descr_uuid;
@@ -166,6 +177,7 @@ typedef union {
     tBTA_GATTS_API_REG              api_reg;
     tBTA_GATTS_API_DEREG            api_dereg;
     tBTA_GATTS_API_CREATE_SRVC      api_create_svc;
+    tBTA_GATTS_API_CREATE_ATTR_TAB  api_create_attr_tab;
     tBTA_GATTS_API_ADD_INCL_SRVC    api_add_incl_srvc;
     tBTA_GATTS_API_ADD_CHAR         api_add_char;
     tBTA_GATTS_API_ADD_DESCR        api_add_char_descr;
@@ -234,6 +246,7 @@ extern void bta_gatts_register(tBTA_GATTS_CB *p_cb, tBTA_GATTS_DATA *p_msg);
 extern void bta_gatts_start_if(tBTA_GATTS_CB *p_cb, tBTA_GATTS_DATA *p_msg);
 extern void bta_gatts_deregister(tBTA_GATTS_CB *p_cb, tBTA_GATTS_DATA *p_msg);
 extern void bta_gatts_create_srvc(tBTA_GATTS_CB *p_cb, tBTA_GATTS_DATA *p_msg);
+extern void bta_gatts_create_attr_tab(tBTA_GATTS_CB *p_cb, tBTA_GATTS_DATA *p_msg);
 extern void bta_gatts_add_include_srvc(tBTA_GATTS_SRVC_CB *p_srvc_cb, tBTA_GATTS_DATA *p_msg);
 extern void bta_gatts_add_char(tBTA_GATTS_SRVC_CB *p_srvc_cb, tBTA_GATTS_DATA *p_msg);
 extern void bta_gatts_add_char_descr(tBTA_GATTS_SRVC_CB *p_srvc_cb, tBTA_GATTS_DATA *p_msg);
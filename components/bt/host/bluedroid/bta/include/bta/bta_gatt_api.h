@@ -366,7 +366,7 @@ typedef struct {
     BD_ADDR             bda;
     UINT16              handle;
     UINT16              len;
-    UINT8               value[BTA_GATT_MAX_ATTR_LEN];
+    UINT8               *value;         /* received value, only valid during the callback */
     BOOLEAN             is_notify;
 } tBTA_GATTC_NOTIFY;
 
@@ -481,6 +481,7 @@ typedef void (tBTA_GATTC_CBACK)(tBTA_GATTC_EVT event, tBTA_GATTC *p_data);
 #define BTA_GATTS_CONGEST_EVT                           20
 #define BTA_GATTS_SET_ATTR_VAL_EVT                      23
 #define BTA_GATTS_SEND_SERVICE_CHANGE_EVT               24
+#define BTA_GATTS_CREATE_ATTR_TAB_EVT                   25
 
 typedef UINT8  tBTA_GATTS_EVT;
 typedef tGATT_IF tBTA_GATTS_IF;
@@ -516,6 +517,25 @@ typedef tGATTS_ATTR_CONTROL tBTA_GATTS_ATTR_CONTROL;
 #define BTA_GATT_CHAR_PROP_BIT_EXT_PROP         GATT_CHAR_PROP_BIT_EXT_PROP     /* 0x80 */
 typedef UINT8 tBTA_GATT_CHAR_PROP;
 
+/* Entry types of a service attribute table, see BTA_GATTS_CreateAttrTab */
+#define BTA_GATTS_ATTR_TAB_SKIP         0   /* no attribute, e.g. a characteristic value */
+#define BTA_GATTS_ATTR_TAB_PRI_SRVC     1
+#define BTA_GATTS_ATTR_TAB_SEC_SRVC     2
+#define BTA_GATTS_ATTR_TAB_INCL_SRVC    3
+#define BTA_GATTS_ATTR_TAB_CHAR         4   /* declaration, followed by the value entry */
+#define BTA_GATTS_ATTR_TAB_DESCR        5
+typedef UINT8 tBTA_GATTS_ATTR_TAB_TYPE;
+
+typedef struct {
+    tBTA_GATTS_ATTR_TAB_TYPE    type;
+    tBTA_GATT_CHAR_PROP         property;       /* characteristic properties */
+    tBTA_GATT_PERM              perm;           /* characteristic value or descriptor permission */
+    UINT16                      incl_srvc_id;   /* included service handle */
+    tBT_UUID                    uuid;           /* service, characteristic value or descriptor UUID */
+    tBTA_GATTS_ATTR_CONTROL     control;
+    tBTA_GATT_ATTR_VAL          attr_val;       /* characteristic value or descriptor value */
+} tBTA_GATTS_ATTR_TAB_ENTRY;
+
 #ifndef BTA_GATTC_CHAR_DESCR_MAX
 #define BTA_GATTC_CHAR_DESCR_MAX        7
 #endif
@@ -609,6 +629,16 @@ typedef struct{
     tBTA_GATT_STATUS    status;
 }tBAT_GATTS_ATTR_VAL_RESULT;
 
+typedef struct {
+    tBTA_GATTS_IF       server_if;
+    UINT16              service_id;
+    UINT8               svc_instance;
+    tBTA_GATT_STATUS    status;
+    tBT_UUID            uuid;
+    UINT16              num_handle;
+    UINT16              *handles;       /* handle of each table entry, 0 if none was created */
+} tBTA_GATTS_CREATE_ATTR_TAB;
+
 typedef struct {
     tBTA_GATTS_IF       server_if;
     UINT16              service_id;
@@ -667,6 +697,7 @@ typedef union {
                                                 add char : BTA_GATTS_ADD_CHAR_EVT
                                                 add char descriptor: BTA_GATTS_ADD_CHAR_DESCR_EVT */
     tBAT_GATTS_ATTR_VAL_RESULT  attr_val;
+    tBTA_GATTS_CREATE_ATTR_TAB  create_attr_tab; /* BTA_GATTS_CREATE_ATTR_TAB_EVT */
     tBTA_GATTS_REQ              req_data;
     tBTA_GATTS_CONN             conn;           /* BTA_GATTS_CONN_EVT */
     tBTA_GATTS_CONGEST          congest;        /* BTA_GATTS_CONGEST_EVT callback data */
@@ -1369,6 +1400,31 @@ extern void BTA_GATTS_AddCharDescriptor (UINT16 service_id,
                                   const tBT_UUID  * p_descr_uuid, tBTA_GATT_ATTR_VAL *attr_val,
                                   tBTA_GATTS_ATTR_CONTROL *control);
 
+/*******************************************************************************
+**
+** Function         BTA_GATTS_CreateAttrTab
+**
+** Description      Create a service and all its attributes from a table in one
+**                  request. Attributes are added in table order after the
+**                  service declaration entry. When it's done, a callback event
+**                  BTA_GATTS_CREATE_ATTR_TAB_EVT reports the status and the
+**                  handle of each entry.
+**
+** Parameters       server_if: server interface.
+**                  inst: instance ID number of this service.
+**                  p_tab: attribute table, values are copied.
+**                  num_entry: number of entries, also the number of handles
+**                             requested for the service.
+**
+** Returns          BTA_GATT_OK if the request was sent, BTA_GATT_NO_RESOURCES
+**                  if it could not be allocated, in which case no event
+**                  follows.
+**
+*******************************************************************************/
+extern tBTA_GATT_STATUS BTA_GATTS_CreateAttrTab(tBTA_GATTS_IF server_if, UINT8 inst,
+                                                const tBTA_GATTS_ATTR_TAB_ENTRY *p_tab,
+                                                UINT16 num_entry);
+
 /*******************************************************************************
 **
 ** Function         BTA_GATTS_DeleteService
@@ -14,11 +14,36 @@
 #include "bta/bta_gatt_api.h"
 #include "common/bt_trace.h"
 #include "osi/allocator.h"
+#include "osi/mutex.h"
 #include "esp_gattc_api.h"
 #include "btc/btc_storage.h"
 #include "common/bt_defs.h"
 
 #if (GATTC_INCLUDED == TRUE)
+
+/* Maximum number of notifications delivered by one BTC message */
+#define BTC_GATTC_NOTIF_BATCH_MAX       (16)
+
+/* A received notification or indication, the value follows */
+typedef struct btc_gattc_notif {
+    struct btc_gattc_notif  *next;
+    tBTA_GATTC_NOTIFY       notify;
+} btc_gattc_notif_t;
+
+/* Notifications delivered to the application by a single BTC message */
+typedef struct {
+    btc_gattc_notif_t       *head;
+    btc_gattc_notif_t       *tail;
+    uint16_t                count;
+} btc_gattc_notif_batch_t;
+
+/*
+ * Batch already posted to the BTC task which later notifications are appended
+ * to, protected by the global OSI mutex. It is cleared by every other GATTC
+ * event, so that notifications never overtake an event reported before them.
+ */
+static btc_gattc_notif_batch_t *btc_gattc_open_batch;
+
 static inline void btc_gattc_cb_to_app(esp_gattc_cb_event_t event, esp_gatt_if_t gattc_if, esp_ble_gattc_cb_param_t *param)
 {
     esp_gattc_cb_t btc_gattc_cb = (esp_gattc_cb_t )btc_profile_cb_get(BTC_PID_GATTC);
@@ -180,11 +205,91 @@ static void btc_gattc_free_req_data(btc_msg_t *msg)
     return;
 }
 
+static void btc_gattc_free_notif_batch(btc_gattc_notif_batch_t *batch)
+{
+    btc_gattc_notif_t *p_notif;
+
+    while ((p_notif = batch->head) != NULL) {
+        batch->head = p_notif->next;
+        osi_free(p_notif);
+    }
+    osi_free(batch);
+}
+
+static void btc_gattc_notif_cback(tBTA_GATTC_NOTIFY *p_notify)
+{
+    btc_gattc_notif_batch_t *batch;
+    btc_gattc_notif_t *p_notif;
+    bt_status_t ret;
+    btc_msg_t msg = {0};
+
+    // The value is only valid during the callback, copy it once next to the header
+    p_notif = (btc_gattc_notif_t *)osi_malloc(sizeof(btc_gattc_notif_t) + p_notify->len);
+    if (p_notif == NULL) {
+        BTC_TRACE_ERROR("%s no mem\n", __func__);
+        return;
+    }
+    p_notif->next = NULL;
+    memcpy(&p_notif->notify, p_notify, sizeof(tBTA_GATTC_NOTIFY));
+    p_notif->notify.value = (UINT8 *)(p_notif + 1);
+    memcpy(p_notif->notify.value, p_notify->value, p_notify->len);
+
+    osi_mutex_global_lock();
+    batch = btc_gattc_open_batch;
+    if (batch != NULL) {
+        batch->tail->next = p_notif;
+        batch->tail = p_notif;
+        if (++batch->count >= BTC_GATTC_NOTIF_BATCH_MAX) {
+            btc_gattc_open_batch = NULL;
+        }
+        osi_mutex_global_unlock();
+        return;
+    }
+
+    batch = (btc_gattc_notif_batch_t *)osi_malloc(sizeof(btc_gattc_notif_batch_t));
+    if (batch == NULL) {
+        osi_mutex_global_unlock();
+        osi_free(p_notif);
+        BTC_TRACE_ERROR("%s no mem\n", __func__);
+        return;
+    }
+    batch->head = p_notif;
+    batch->tail = p_notif;
+    batch->count = 1;
+    btc_gattc_open_batch = batch;
+    osi_mutex_global_unlock();
+
+    msg.sig = BTC_SIG_API_CB;
+    msg.pid = BTC_PID_GATTC;
+    msg.act = BTA_GATTC_NOTIF_EVT;
+    ret = btc_transfer_context(&msg, &batch, sizeof(btc_gattc_notif_batch_t *), NULL, NULL);
+
+    if (ret) {
+        osi_mutex_global_lock();
+        if (btc_gattc_open_batch == batch) {
+            btc_gattc_open_batch = NULL;
+        }
+        osi_mutex_global_unlock();
+        btc_gattc_free_notif_batch(batch);
+        BTC_TRACE_ERROR("%s transfer failed\n", __func__);
+    }
+}
+
 static void btc_gattc_cback(tBTA_GATTC_EVT event, tBTA_GATTC *p_data)
 {
     bt_status_t ret;
     btc_msg_t msg = {0};
 
+    if (event == BTA_GATTC_NOTIF_EVT) {
+        btc_gattc_notif_cback(&p_data->notify);
+        return;
+    }
+
+    // Notifications received from now on go into a new batch, after this event
+    osi_mutex_global_lock();
+    btc_gattc_open_batch = NULL;
+    osi_mutex_global_unlock();
+
     msg.sig = BTC_SIG_API_CB;
     msg.pid = BTC_PID_GATTC;
     msg.act = (uint8_t) event;
@@ -895,22 +1000,35 @@ void btc_gattc_cb_handler(btc_msg_t *msg)
         break;
     }
     case BTA_GATTC_NOTIF_EVT: {
-        tBTA_GATTC_NOTIFY *notify = &arg->notify;
-
-        gattc_if = BTC_GATT_GET_GATT_IF(notify->conn_id);
-        param.notify.conn_id = BTC_GATT_GET_CONN_ID(notify->conn_id);
-        memcpy(param.notify.remote_bda, notify->bda, sizeof(esp_bd_addr_t));
-        param.notify.handle = notify->handle;
-        param.notify.is_notify = (notify->is_notify == TRUE) ? true : false;
-        param.notify.value_len = (notify->len > ESP_GATT_MAX_ATTR_LEN) ? \
-                                 ESP_GATT_MAX_ATTR_LEN : notify->len;
-        param.notify.value = notify->value;
-
-        if (notify->is_notify == FALSE) {
-            BTA_GATTC_SendIndConfirm(notify->conn_id, notify->handle);
+        btc_gattc_notif_batch_t *batch = *(btc_gattc_notif_batch_t **)msg->arg;
+        btc_gattc_notif_t *p_notif;
+
+        // Stop appending to the batch before delivering it
+        osi_mutex_global_lock();
+        if (btc_gattc_open_batch == batch) {
+            btc_gattc_open_batch = NULL;
         }
+        osi_mutex_global_unlock();
+
+        for (p_notif = batch->head; p_notif != NULL; p_notif = p_notif->next) {
+            tBTA_GATTC_NOTIFY *notify = &p_notif->notify;
+
+            gattc_if = BTC_GATT_GET_GATT_IF(notify->conn_id);
+            param.notify.conn_id = BTC_GATT_GET_CONN_ID(notify->conn_id);
+            memcpy(param.notify.remote_bda, notify->bda, sizeof(esp_bd_addr_t));
+            param.notify.handle = notify->handle;
+            param.notify.is_notify = (notify->is_notify == TRUE) ? true : false;
+            param.notify.value_len = (notify->len > ESP_GATT_MAX_ATTR_LEN) ? \
+                                     ESP_GATT_MAX_ATTR_LEN : notify->len;
+            param.notify.value = notify->value;
+
+            if (notify->is_notify == FALSE) {
+                BTA_GATTC_SendIndConfirm(notify->conn_id, notify->handle);
+            }
 
-        btc_gattc_cb_to_app(ESP_GATTC_NOTIFY_EVT, gattc_if, &param);
+            btc_gattc_cb_to_app(ESP_GATTC_NOTIFY_EVT, gattc_if, &param);
+        }
+        btc_gattc_free_notif_batch(batch);
         break;
     }
     case BTA_GATTC_OPEN_EVT: {
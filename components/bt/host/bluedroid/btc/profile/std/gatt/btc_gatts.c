@@ -12,7 +12,6 @@
 #include "btc/btc_manage.h"
 #include "btc_gatts.h"
 #include "btc_gatt_util.h"
-#include "osi/future.h"
 #include "osi/allocator.h"
 #include "btc/btc_main.h"
 #include "esp_gatts_api.h"
@@ -24,14 +23,8 @@
 #define A2C_GATTS_EVT(_bta_event) (_bta_event) //BTA TO BTC EVT
 #define C2A_GATTS_EVT(_btc_event) (_btc_event) //BTC TO BTA EVT
 
-#if GATT_DYNAMIC_MEMORY == FALSE
-static esp_btc_creat_tab_t btc_creat_tab_env;
-#else
-esp_btc_creat_tab_t *btc_creat_tab_env_ptr;
-#endif
-
 static esp_gatt_status_t btc_gatts_check_valid_attr_tab(esp_gatts_attr_db_t *gatts_attr_db,
-                                                                          uint8_t max_nb_attr);
+                                                                          uint16_t max_nb_attr);
 
 static inline void btc_gatts_cb_to_app(esp_gatts_cb_event_t event, esp_gatt_if_t gatts_if, esp_ble_gatts_cb_param_t *param)
 {
@@ -223,212 +216,110 @@ static void btc_gatts_act_create_attr_tab(esp_gatts_attr_db_t *gatts_attr_db,
                                                         uint8_t srvc_inst_id)
 {
     uint16_t uuid = 0;
-    future_t *future_p;
+    tBTA_GATTS_ATTR_TAB_ENTRY *p_tab;
+    esp_bt_uuid_t uuid_temp;
     esp_ble_gatts_cb_param_t param;
-    param.add_attr_tab.status = ESP_GATT_OK;
+
+    memset(&param, 0, sizeof(esp_ble_gatts_cb_param_t));
     param.add_attr_tab.num_handle = max_nb_attr;
+    param.add_attr_tab.svc_inst_id = srvc_inst_id;
 
-    if (param.add_attr_tab.status != ESP_GATT_OK) {
+    // Check the attribute table is valid or not
+    if ((param.add_attr_tab.status = btc_gatts_check_valid_attr_tab(gatts_attr_db, max_nb_attr)) != ESP_GATT_OK) {
+        //sent the callback event to the application
         btc_gatts_cb_to_app(ESP_GATTS_CREAT_ATTR_TAB_EVT, gatts_if, &param);
-        //reset the env after sent the data to app
-        memset(&btc_creat_tab_env, 0, sizeof(esp_btc_creat_tab_t));
         return;
     }
 
-    // Check the attribute table is valid or not
-    if ((param.add_attr_tab.status = btc_gatts_check_valid_attr_tab(gatts_attr_db, max_nb_attr)) != ESP_GATT_OK) {
-        //sent the callback event to the application
+    p_tab = (tBTA_GATTS_ATTR_TAB_ENTRY *)osi_calloc(max_nb_attr * sizeof(tBTA_GATTS_ATTR_TAB_ENTRY));
+    if (p_tab == NULL) {
+        BTC_TRACE_ERROR("%s failed:no mem\n", __func__);
+        param.add_attr_tab.status = ESP_GATT_NO_RESOURCES;
         btc_gatts_cb_to_app(ESP_GATTS_CREAT_ATTR_TAB_EVT, gatts_if, &param);
         return;
     }
 
+    // Convert the table and let BTA create the whole service in a single request,
+    // the entries left zeroed are skipped
+    for (int i = 0; i < max_nb_attr; i++) {
+        esp_attr_desc_t *att_desc = &gatts_attr_db[i].att_desc;
+        tBTA_GATTS_ATTR_TAB_ENTRY *p_entry = &p_tab[i];
 
-    //set the attribute table create service flag to true
-    btc_creat_tab_env.is_tab_creat_svc = true;
-    btc_creat_tab_env.num_handle = max_nb_attr;
-    for(int i = 0; i < max_nb_attr; i++){
-        if(gatts_attr_db[i].att_desc.uuid_length == ESP_UUID_LEN_16){
-            uuid = (gatts_attr_db[i].att_desc.uuid_p[1] << 8) + (gatts_attr_db[i].att_desc.uuid_p[0]);
-        }
-        else{
+        if (att_desc->uuid_length != ESP_UUID_LEN_16) {
             continue;
         }
-        future_p = future_new();
-        if (future_p == NULL) {
-                BTC_TRACE_ERROR("%s failed:no mem\n", __func__);
-                return ;
-            }
-        btc_creat_tab_env.complete_future = future_p;
-        btc_creat_tab_env.handle_idx = i;
-        switch(uuid)
-        {
-            case ESP_GATT_UUID_PRI_SERVICE:{
-                tBTA_GATT_SRVC_ID srvc_id;
-                esp_gatt_srvc_id_t        esp_srvc_id;
-
-                esp_srvc_id.id.inst_id = srvc_inst_id;
-                btc_gatts_uuid_format_convert(&esp_srvc_id.id.uuid,gatts_attr_db[i].att_desc.length,
-                                              gatts_attr_db[i].att_desc.value);
-
-                btc_to_bta_srvc_id(&srvc_id, &esp_srvc_id);
-                if (btc_creat_tab_env.is_use_svc != true) {
-                    BTA_GATTS_CreateService(gatts_if, &srvc_id.id.uuid,
-                                            srvc_inst_id, max_nb_attr, true);
-                    btc_creat_tab_env.is_use_svc = true;
-                } else {
-                    BTC_TRACE_ERROR("Each service table can only created one primary service.");
-                    param.add_attr_tab.status = ESP_GATT_ERROR;
-                    btc_gatts_cb_to_app(ESP_GATTS_CREAT_ATTR_TAB_EVT, gatts_if, &param);
-                    //reset the env after sent the data to app
-                    memset(&btc_creat_tab_env, 0, sizeof(esp_btc_creat_tab_t));
-                    return;
-                }
 
-                 if (future_await(future_p) == FUTURE_FAIL) {
-                        BTC_TRACE_ERROR("%s failed\n", __func__);
-                        return;
-                        }
-                    break;
-            }
-            case ESP_GATT_UUID_SEC_SERVICE:{
-                tBTA_GATT_SRVC_ID srvc_id = {0};
-                esp_gatt_srvc_id_t        esp_srvc_id;
-
-                esp_srvc_id.id.inst_id = srvc_inst_id;
-                btc_gatts_uuid_format_convert(&esp_srvc_id.id.uuid,gatts_attr_db[i].att_desc.length,
-                                              gatts_attr_db[i].att_desc.value);
-                btc_to_bta_srvc_id(&srvc_id, &esp_srvc_id);
-                if (btc_creat_tab_env.is_use_svc != true) {
-                    BTA_GATTS_CreateService(gatts_if, &srvc_id.id.uuid,
-                                            srvc_inst_id, max_nb_attr, false);
-                    btc_creat_tab_env.is_use_svc = true;
-                } else {
-                    BTC_TRACE_ERROR("Each service table can only created one secondary service.");
-                    param.add_attr_tab.status = ESP_GATT_ERROR;
-                    btc_gatts_cb_to_app(ESP_GATTS_CREAT_ATTR_TAB_EVT, gatts_if, &param);
-                    //reset the env after sent the data to app
-                    memset(&btc_creat_tab_env, 0, sizeof(esp_btc_creat_tab_t));
-                    return;
-                }
-                if (future_await(future_p) == FUTURE_FAIL) {
-                        BTC_TRACE_ERROR("%s failed\n", __func__);
-                        return;
-                        }
-                break;
-            }
-            case ESP_GATT_UUID_INCLUDE_SERVICE:{
-                esp_gatts_incl_svc_desc_t *incl_svc_desc = (esp_gatts_incl_svc_desc_t *)gatts_attr_db[i].att_desc.value;
-
-                if(incl_svc_desc!= NULL){
-                    if(btc_creat_tab_env.svc_start_hdl != 0){
-                        BTA_GATTS_AddIncludeService(btc_creat_tab_env.svc_start_hdl,
-                            incl_svc_desc->start_hdl);
-
-                        if (future_await(future_p) == FUTURE_FAIL) {
-                                BTC_TRACE_ERROR("%s failed\n", __func__);
-                                return;
-                            }
-                    }
-                }
-                break;
-            }
-            case ESP_GATT_UUID_CHAR_DECLARE:{
-                uint16_t svc_hal = 0;
-                tBT_UUID bta_char_uuid;
-                tGATT_ATTR_VAL attr_val;
-                esp_bt_uuid_t uuid_temp;
-                tBTA_GATT_PERM perm;
-                tBTA_GATTS_ATTR_CONTROL control;
-                uint8_t char_property;
-
-                if(btc_creat_tab_env.svc_start_hdl != 0){
-                    svc_hal = btc_creat_tab_env.svc_start_hdl;
-                    if((gatts_attr_db[i].att_desc.value) == NULL){
-                        BTC_TRACE_ERROR("%s Characteristic declaration should not be NULL\n", __func__);
-                    }
-                    else{
-                        char_property = (uint8_t)(*(uint8_t*)(gatts_attr_db[i].att_desc.value));
-                        perm = gatts_attr_db[i+1].att_desc.perm;
-                        attr_val.attr_len = gatts_attr_db[i+1].att_desc.length;
-                        attr_val.attr_max_len = gatts_attr_db[i+1].att_desc.max_length;
-                        btc_gatts_uuid_format_convert(&uuid_temp, gatts_attr_db[i+1].att_desc.uuid_length,gatts_attr_db[i+1].att_desc.uuid_p);
-                        btc_to_bta_uuid(&bta_char_uuid, &uuid_temp);
-                        attr_val.attr_val = gatts_attr_db[i+1].att_desc.value;
-                        control.auto_rsp = gatts_attr_db[i+1].attr_control.auto_rsp;
-                        BTA_GATTS_AddCharacteristic (svc_hal, &bta_char_uuid,
-                                         perm, char_property, &attr_val, &control);
-
-                        if (future_await(future_p) == FUTURE_FAIL) {
-                                BTC_TRACE_ERROR("%s failed\n", __func__);
-                                return;
-                                }
-                    }
-                }
+        uuid = (att_desc->uuid_p[1] << 8) + (att_desc->uuid_p[0]);
+        switch (uuid) {
+        case ESP_GATT_UUID_PRI_SERVICE:
+        case ESP_GATT_UUID_SEC_SERVICE:
+            p_entry->type = (uuid == ESP_GATT_UUID_PRI_SERVICE) ? BTA_GATTS_ATTR_TAB_PRI_SRVC :
+                                                                 BTA_GATTS_ATTR_TAB_SEC_SRVC;
+            btc_gatts_uuid_format_convert(&uuid_temp, att_desc->length, att_desc->value);
+            btc_to_bta_uuid(&p_entry->uuid, &uuid_temp);
+            break;
+        case ESP_GATT_UUID_INCLUDE_SERVICE: {
+            esp_gatts_incl_svc_desc_t *incl_svc_desc = (esp_gatts_incl_svc_desc_t *)att_desc->value;
 
-                break;
-            }
-            case ESP_GATT_UUID_CHAR_EXT_PROP:
-            case ESP_GATT_UUID_CHAR_DESCRIPTION:
-            case ESP_GATT_UUID_CHAR_CLIENT_CONFIG:
-            case ESP_GATT_UUID_CHAR_SRVR_CONFIG:
-            case ESP_GATT_UUID_CHAR_PRESENT_FORMAT:
-            case ESP_GATT_UUID_CHAR_AGG_FORMAT:
-            case ESP_GATT_UUID_CHAR_VALID_RANGE:
-            case ESP_GATT_UUID_EXT_RPT_REF_DESCR:
-            case ESP_GATT_UUID_RPT_REF_DESCR:
-            case ESP_GATT_UUID_NUM_DIGITALS_DESCR:
-            case ESP_GATT_UUID_VALUE_TRIGGER_DESCR:
-            case ESP_GATT_UUID_ENV_SENSING_CONFIG_DESCR:
-            case ESP_GATT_UUID_ENV_SENSING_MEASUREMENT_DESCR:
-            case ESP_GATT_UUID_ENV_SENSING_TRIGGER_DESCR:
-            case ESP_GATT_UUID_TIME_TRIGGER_DESCR: {
-                uint16_t svc_hal = btc_creat_tab_env.svc_start_hdl;
-                tBT_UUID bta_char_uuid;
-                esp_bt_uuid_t uuid_temp;
-                tGATT_ATTR_VAL attr_val;
-                tBTA_GATT_PERM perm = gatts_attr_db[i].att_desc.perm;
-                tBTA_GATTS_ATTR_CONTROL control;
-
-                if(svc_hal != 0){
-                    attr_val.attr_len = gatts_attr_db[i].att_desc.length;
-                    attr_val.attr_max_len = gatts_attr_db[i].att_desc.max_length;
-                    attr_val.attr_val = gatts_attr_db[i].att_desc.value;
-                    btc_gatts_uuid_format_convert(&uuid_temp, gatts_attr_db[i].att_desc.uuid_length,
-                                                  gatts_attr_db[i].att_desc.uuid_p);
-                    btc_to_bta_uuid(&bta_char_uuid, &uuid_temp);
-                    control.auto_rsp = gatts_attr_db[i].attr_control.auto_rsp;
-                    BTA_GATTS_AddCharDescriptor(svc_hal, perm, &bta_char_uuid, &attr_val, &control);
-
-                    if (future_await(future_p) == FUTURE_FAIL) {
-                        BTC_TRACE_ERROR("%s failed\n", __func__);
-                        return;
-                        }
-                }
-                break;
-            }
-            default:
-                future_free(future_p);
-                break;
+            p_entry->type = BTA_GATTS_ATTR_TAB_INCL_SRVC;
+            p_entry->incl_srvc_id = incl_svc_desc->start_hdl;
+            break;
+        }
+        case ESP_GATT_UUID_CHAR_DECLARE: {
+            // The characteristic value is described by the next entry
+            esp_attr_desc_t *val_desc = &gatts_attr_db[i + 1].att_desc;
+
+            p_entry->type = BTA_GATTS_ATTR_TAB_CHAR;
+            p_entry->property = *(uint8_t *)att_desc->value;
+            p_entry->perm = val_desc->perm;
+            btc_gatts_uuid_format_convert(&uuid_temp, val_desc->uuid_length, val_desc->uuid_p);
+            btc_to_bta_uuid(&p_entry->uuid, &uuid_temp);
+            p_entry->attr_val.attr_len = val_desc->length;
+            p_entry->attr_val.attr_max_len = val_desc->max_length;
+            p_entry->attr_val.attr_val = val_desc->value;
+            p_entry->control.auto_rsp = gatts_attr_db[i + 1].attr_control.auto_rsp;
+            break;
+        }
+        case ESP_GATT_UUID_CHAR_EXT_PROP:
+        case ESP_GATT_UUID_CHAR_DESCRIPTION:
+        case ESP_GATT_UUID_CHAR_CLIENT_CONFIG:
+        case ESP_GATT_UUID_CHAR_SRVR_CONFIG:
+        case ESP_GATT_UUID_CHAR_PRESENT_FORMAT:
+        case ESP_GATT_UUID_CHAR_AGG_FORMAT:
+        case ESP_GATT_UUID_CHAR_VALID_RANGE:
+        case ESP_GATT_UUID_EXT_RPT_REF_DESCR:
+        case ESP_GATT_UUID_RPT_REF_DESCR:
+        case ESP_GATT_UUID_NUM_DIGITALS_DESCR:
+        case ESP_GATT_UUID_VALUE_TRIGGER_DESCR:
+        case ESP_GATT_UUID_ENV_SENSING_CONFIG_DESCR:
+        case ESP_GATT_UUID_ENV_SENSING_MEASUREMENT_DESCR:
+        case ESP_GATT_UUID_ENV_SENSING_TRIGGER_DESCR:
+        case ESP_GATT_UUID_TIME_TRIGGER_DESCR:
+            p_entry->type = BTA_GATTS_ATTR_TAB_DESCR;
+            p_entry->perm = att_desc->perm;
+            btc_gatts_uuid_format_convert(&uuid_temp, att_desc->uuid_length, att_desc->uuid_p);
+            btc_to_bta_uuid(&p_entry->uuid, &uuid_temp);
+            p_entry->attr_val.attr_len = att_desc->length;
+            p_entry->attr_val.attr_max_len = att_desc->max_length;
+            p_entry->attr_val.attr_val = att_desc->value;
+            p_entry->control.auto_rsp = gatts_attr_db[i].attr_control.auto_rsp;
+            break;
+        default:
+            break;
         }
-
-
     }
 
-    param.add_attr_tab.handles = btc_creat_tab_env.handles;
-    memcpy(&param.add_attr_tab.svc_uuid, &btc_creat_tab_env.svc_uuid, sizeof(esp_bt_uuid_t));
-
-    param.add_attr_tab.svc_inst_id = srvc_inst_id;
-
-    btc_gatts_cb_to_app(ESP_GATTS_CREAT_ATTR_TAB_EVT, gatts_if, &param);
-    //reset the env after sent the data to app
-    memset(&btc_creat_tab_env, 0, sizeof(esp_btc_creat_tab_t));
-
-    //set the flag value to false after the service is created.
-    btc_creat_tab_env.is_tab_creat_svc = false;
+    // The values are copied, the result comes back as BTA_GATTS_CREATE_ATTR_TAB_EVT
+    if (BTA_GATTS_CreateAttrTab(gatts_if, srvc_inst_id, p_tab, max_nb_attr) != BTA_GATT_OK) {
+        BTC_TRACE_ERROR("%s failed:no mem\n", __func__);
+        param.add_attr_tab.status = ESP_GATT_NO_RESOURCES;
+        btc_gatts_cb_to_app(ESP_GATTS_CREAT_ATTR_TAB_EVT, gatts_if, &param);
+    }
+    osi_free(p_tab);
 }
 
 static esp_gatt_status_t btc_gatts_check_valid_attr_tab(esp_gatts_attr_db_t *gatts_attr_db,
-                                                                          uint8_t max_nb_attr)
+                                                                          uint16_t max_nb_attr)
 {
     uint8_t svc_num = 0;
     uint16_t uuid = 0;
@@ -466,6 +357,11 @@ static esp_gatt_status_t btc_gatts_check_valid_attr_tab(esp_gatts_attr_db_t *gat
                     return ESP_GATT_INVALID_PDU;
                 }
 
+                if (i + 1 >= max_nb_attr) {
+                    BTC_TRACE_ERROR("%s, Characteristic declaration should be followed by its value.", __func__);
+                    return ESP_GATT_INVALID_PDU;
+                }
+
                 if(gatts_attr_db[i+1].att_desc.uuid_length != ESP_UUID_LEN_16 &&
                    gatts_attr_db[i+1].att_desc.uuid_length != ESP_UUID_LEN_32 &&
                    gatts_attr_db[i+1].att_desc.uuid_length != ESP_UUID_LEN_128) {
@@ -534,6 +430,19 @@ static void btc_gatts_cb_param_copy_req(btc_msg_t *msg, void *p_dest, void *p_sr
             BTC_TRACE_ERROR("%s %d no mem\n", __func__, msg->act);
         }
         break;
+    case BTA_GATTS_CREATE_ATTR_TAB_EVT:
+        // The handles are owned by the BTA message
+        p_dest_data->create_attr_tab.handles = NULL;
+        if (p_src_data->create_attr_tab.handles && p_src_data->create_attr_tab.num_handle) {
+            size_t len = p_src_data->create_attr_tab.num_handle * sizeof(UINT16);
+            p_dest_data->create_attr_tab.handles = osi_malloc(len);
+            if (p_dest_data->create_attr_tab.handles != NULL) {
+                memcpy(p_dest_data->create_attr_tab.handles, p_src_data->create_attr_tab.handles, len);
+            } else {
+                BTC_TRACE_ERROR("%s %d no mem\n", __func__, msg->act);
+            }
+        }
+        break;
 
     default:
         break;
@@ -554,6 +463,11 @@ static void btc_gatts_cb_param_copy_free(btc_msg_t *msg)
             osi_free(p_data->req_data.p_data);
         }
         break;
+    case BTA_GATTS_CREATE_ATTR_TAB_EVT:
+        if (p_data && p_data->create_attr_tab.handles) {
+            osi_free(p_data->create_attr_tab.handles);
+        }
+        break;
     case BTA_GATTS_CONF_EVT:
         break;
     default:
@@ -570,40 +484,6 @@ static void btc_gatts_inter_cb(tBTA_GATTS_EVT event, tBTA_GATTS *p_data)
     msg.sig = BTC_SIG_API_CB;
     msg.pid = BTC_PID_GATTS;
     msg.act = event;
-    if(btc_creat_tab_env.is_tab_creat_svc && btc_creat_tab_env.complete_future) {
-        switch(event) {
-            case BTA_GATTS_CREATE_EVT: {
-                //save the service handle to the btc module after used
-                //the attribute table method to creat a service
-                bta_to_btc_uuid(&btc_creat_tab_env.svc_uuid, &p_data->create.uuid);
-                uint16_t index = btc_creat_tab_env.handle_idx;
-                btc_creat_tab_env.svc_start_hdl = p_data->create.service_id;
-                btc_creat_tab_env.handles[index] = p_data->create.service_id;
-                break;
-            }
-            case BTA_GATTS_ADD_INCL_SRVC_EVT: {
-                uint16_t index = btc_creat_tab_env.handle_idx;
-                btc_creat_tab_env.handles[index] = p_data->add_result.attr_id;
-                break;
-            }
-            case BTA_GATTS_ADD_CHAR_EVT: {
-                uint16_t index = btc_creat_tab_env.handle_idx;
-                btc_creat_tab_env.handles[index] = p_data->add_result.attr_id - 1;
-                btc_creat_tab_env.handles[index+1] = p_data->add_result.attr_id;
-                break;
-            }
-            case BTA_GATTS_ADD_CHAR_DESCR_EVT: {
-                uint16_t index = btc_creat_tab_env.handle_idx;
-                btc_creat_tab_env.handles[index] = p_data->add_result.attr_id;
-                break;
-            }
-            default:
-                break;
-        }
-
-        future_ready(btc_creat_tab_env.complete_future, FUTURE_SUCCESS);
-        return;
-    }
     status = btc_transfer_context(&msg, p_data, sizeof(tBTA_GATTS),
                                     btc_gatts_cb_param_copy_req, btc_gatts_cb_param_copy_free);
 
@@ -854,6 +734,19 @@ void btc_gatts_cb_handler(btc_msg_t *msg)
 
         btc_gatts_cb_to_app(ESP_GATTS_CREATE_EVT, gatts_if, &param);
         break;
+    case BTA_GATTS_CREATE_ATTR_TAB_EVT:
+        gatts_if = p_data->create_attr_tab.server_if;
+        param.add_attr_tab.status = p_data->create_attr_tab.status;
+        if (p_data->create_attr_tab.handles == NULL) {
+            param.add_attr_tab.status = ESP_GATT_NO_RESOURCES;
+        }
+        bta_to_btc_uuid(&param.add_attr_tab.svc_uuid, &p_data->create_attr_tab.uuid);
+        param.add_attr_tab.svc_inst_id = p_data->create_attr_tab.svc_instance;
+        param.add_attr_tab.num_handle = p_data->create_attr_tab.num_handle;
+        param.add_attr_tab.handles = p_data->create_attr_tab.handles;
+
+        btc_gatts_cb_to_app(ESP_GATTS_CREAT_ATTR_TAB_EVT, gatts_if, &param);
+        break;
     case BTA_GATTS_ADD_INCL_SRVC_EVT:
         gatts_if = p_data->add_result.server_if;
         param.add_incl_srvc.status = p_data->add_result.status;
@@ -40,6 +40,7 @@
 #include "osi/mutex.h"
 #include "osi/fixed_queue.h"
 #include "osi/fixed_pkt_queue.h"
+#include "bt_stats/bt_stats.h"
 
 #define HCI_HOST_TASK_PINNED_TO_CORE    (TASK_PINNED_TO_CORE)
 #define HCI_HOST_TASK_STACK_SIZE        (2048 + BT_TASK_EXTRA_STACK_SIZE)
@@ -88,6 +89,22 @@ static const hci_hal_callbacks_t hal_callbacks;
 static const packet_fragmenter_t *packet_fragmenter;
 static const packet_fragmenter_callbacks_t packet_fragmenter_callbacks;
 
+#if (BT_STATS_INCLUDED == TRUE)
+static BT_STATS_COUNTER_DEFINE(hci_stats_cmd_tx, "hci.cmd_tx");
+static BT_STATS_COUNTER_DEFINE(hci_stats_acl_tx, "hci.acl_tx");
+static BT_STATS_COUNTER_DEFINE(hci_stats_evt_rx, "hci.evt_rx");
+static BT_STATS_COUNTER_DEFINE(hci_stats_acl_rx, "hci.acl_rx");
+static BT_STATS_COUNTER_DEFINE(hci_stats_adv_rx, "hci.adv_rx");
+static BT_STATS_COUNTER_DEFINE(hci_stats_cmd_timeout, "hci.cmd_timeout");
+// Time from sending a command to its command complete or status event, 128 us to 8 ms
+static BT_STATS_HIST_DEFINE(hci_stats_cmd_latency, "hci.cmd_latency_us", 7);
+
+static bt_stats_hdr_t *const hci_stats[] = {
+    &hci_stats_cmd_tx.hdr, &hci_stats_acl_tx.hdr, &hci_stats_evt_rx.hdr, &hci_stats_acl_rx.hdr,
+    &hci_stats_adv_rx.hdr, &hci_stats_cmd_timeout.hdr, &hci_stats_cmd_latency.hdr,
+};
+#endif // (BT_STATS_INCLUDED == TRUE)
+
 static int hci_layer_init_env(void);
 static void hci_layer_deinit_env(void);
 static void hci_downstream_data_handler(void *arg);
@@ -121,6 +138,10 @@ int hci_start_up(void)
     packet_fragmenter->init(&packet_fragmenter_callbacks);
     hal->open(&hal_callbacks, hci_host_thread);
 
+#if (BT_STATS_INCLUDED == TRUE)
+    bt_stats_register_group(hci_stats, sizeof(hci_stats) / sizeof(hci_stats[0]));
+#endif
+
     hci_host_startup_flag = true;
     return 0;
 error:
@@ -319,6 +340,10 @@ static void event_command_ready(fixed_pkt_queue_t *queue)
     hci_cmd_metadata_t *metadata = (hci_cmd_metadata_t *)(wait_entry->data);
     metadata->flags_vnd |= HCI_CMD_MSG_F_VND_SENT;
     metadata->flags_vnd &= ~HCI_CMD_MSG_F_VND_QUEUED;
+    BT_STATS_INC(hci_stats_cmd_tx);
+#if (BT_STATS_INCLUDED == TRUE)
+    metadata->sent_time = BT_STATS_TIMESTAMP();
+#endif
 
     if (metadata->flags_src & HCI_CMD_MSG_F_SRC_NOACK) {
         packet_fragmenter->fragment_and_dispatch(&metadata->command);
@@ -353,6 +378,9 @@ static void transmit_fragment(BT_HDR *packet, bool send_transmit_finished)
     serial_data_type_t type = event_to_data_type(event);
 
     hal->transmit_data(type, packet->data + packet->offset, packet->len);
+    if (type == DATA_TYPE_ACL) {
+        BT_STATS_INC(hci_stats_acl_tx);
+    }
 
     if (event != MSG_STACK_TO_HC_HCI_CMD && send_transmit_finished) {
         osi_free(packet);
@@ -413,6 +441,7 @@ static void command_timed_out(void *context)
     {
         hci_cmd_metadata_t *metadata = (hci_cmd_metadata_t *)(wait_entry->data);
         HCI_TRACE_ERROR("%s hci layer timeout waiting for response to a command. opcode: 0x%x", __func__, metadata->opcode);
+        BT_STATS_INC(hci_stats_cmd_timeout);
         UNUSED(metadata);
     }
 }
@@ -421,14 +450,21 @@ static void command_timed_out(void *context)
 static void hal_says_packet_ready(BT_HDR *packet)
 {
     if (packet->event != MSG_HC_TO_STACK_HCI_EVT) {
+        if (packet->event == MSG_HC_TO_STACK_HCI_ACL) {
+            BT_STATS_INC(hci_stats_acl_rx);
+        }
         packet_fragmenter->reassemble_and_dispatch(packet);
-    } else if (!filter_incoming_event(packet)) {
-        dispatch_reassembled(packet);
+    } else {
+        BT_STATS_INC(hci_stats_evt_rx);
+        if (!filter_incoming_event(packet)) {
+            dispatch_reassembled(packet);
+        }
     }
 }
 
 static void hal_says_adv_rpt_ready(pkt_linked_item_t *linked_pkt)
 {
+    BT_STATS_INC(hci_stats_adv_rx);
     dispatch_adv_report(linked_pkt);
 }
 
@@ -503,6 +539,8 @@ intercepted:
     }
 
     if (wait_entry) {
+        BT_STATS_HIST_SINCE(hci_stats_cmd_latency, metadata->sent_time);
+
         // If it has a callback, it's responsible for freeing the packet
         if (event_code == HCI_COMMAND_STATUS_EVT ||
                 (!metadata->command_complete_cb && !metadata->complete_future)) {
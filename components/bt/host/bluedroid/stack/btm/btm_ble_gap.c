@@ -3461,7 +3461,7 @@ void btm_clear_all_pending_le_entry(void)
         if ((p_ent->in_use) &&
                 (p_ent->inq_info.results.device_type == BT_DEVICE_TYPE_BLE) &&
                 !p_ent->scan_rsp) {
-            p_ent->in_use = FALSE;
+            btm_inq_db_free(p_ent);
         }
     }
 }
@@ -4312,6 +4312,12 @@ void btm_ble_timeout(TIMER_LIST_ENT *p_tle)
         btm_ble_start_slow_adv();
         break;
 
+#if (BLE_PRIVACY_SPT == TRUE)
+    case BTU_TTYPE_BLE_RL_SYNC:
+        btm_ble_resolving_list_sync();
+        break;
+#endif
+
     default:
         break;
 
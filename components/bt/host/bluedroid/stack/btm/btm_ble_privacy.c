@@ -50,6 +50,10 @@
 #define BTM_BLE_META_READ_IRK_LEN       2
 #define BTM_BLE_META_ADD_WL_ATTR_LEN    9
 
+/* seconds the resolving list sync waits for further changes, or to retry
+ * when the list can not be edited yet */
+#define BTM_BLE_RL_SYNC_DELAY           1
+
 /*******************************************************************************
 **         Functions implemented controller based privacy using Resolving List
 *******************************************************************************/
@@ -72,35 +76,7 @@ void btm_ble_enq_resolving_list_pending(BD_ADDR pseudo_bda, UINT8 op_code)
     memcpy(p_q->resolve_q_random_pseudo[p_q->q_next], pseudo_bda, BD_ADDR_LEN);
     p_q->resolve_q_action[p_q->q_next] = op_code;
     p_q->q_next ++;
-    p_q->q_next %= controller_get_interface()->get_ble_resolving_list_max_size();
-}
-
-/*******************************************************************************
-**
-** Function         btm_ble_brcm_find_resolving_pending_entry
-**
-** Description      check to see if the action is in pending list
-**
-** Parameters       TRUE: action pending;
-**                  FALSE: new action
-**
-** Returns          void
-**
-*******************************************************************************/
-BOOLEAN btm_ble_brcm_find_resolving_pending_entry(BD_ADDR pseudo_addr, UINT8 action)
-{
-    tBTM_BLE_RESOLVE_Q *p_q = &btm_cb.ble_ctr_cb.resolving_list_pend_q;
-
-    for (UINT8 i = p_q->q_pending; i != p_q->q_next;) {
-        if (memcmp(p_q->resolve_q_random_pseudo[i], pseudo_addr, BD_ADDR_LEN) == 0 &&
-                action == p_q->resolve_q_action[i]) {
-            return TRUE;
-        }
-
-        i ++;
-        i %= controller_get_interface()->get_ble_resolving_list_max_size();
-    }
-    return FALSE;
+    p_q->q_next %= p_q->q_size;
 }
 
 /*******************************************************************************
@@ -122,7 +98,7 @@ BOOLEAN btm_ble_deq_resolving_pending(BD_ADDR pseudo_addr)
         memcpy(pseudo_addr, p_q->resolve_q_random_pseudo[p_q->q_pending], BD_ADDR_LEN);
         memset(p_q->resolve_q_random_pseudo[p_q->q_pending], 0, BD_ADDR_LEN);
         p_q->q_pending ++;
-        p_q->q_pending %= controller_get_interface()->get_ble_resolving_list_max_size();
+        p_q->q_pending %= p_q->q_size;
         return TRUE;
     }
 
@@ -258,6 +234,45 @@ void btm_ble_clear_resolving_list_complete(UINT8 *p, UINT16 evt_len)
 	    p_dev_rec = list_node(p_node);
             p_dev_rec->ble.in_controller_list &= ~BTM_RESOLVING_LIST_BIT;
 	}
+        btm_cb.ble_ctr_cb.rl_entry_num = 0;
+    }
+}
+
+/*******************************************************************************
+**
+** Function         btm_ble_resolving_list_drop_entry
+**
+** Description      take a device the controller failed to add back out of the
+**                  host copy of the resolving list, so that the next sync
+**                  retries it
+**
+** Parameters       pseudo_bda: pseudo address of the device
+**
+** Returns          void
+**
+*******************************************************************************/
+static void btm_ble_resolving_list_drop_entry(BD_ADDR pseudo_bda)
+{
+    tBTM_BLE_CB         *p_cb = &btm_cb.ble_ctr_cb;
+    tBTM_SEC_DEV_REC    *p_dev_rec = btm_find_dev(pseudo_bda);
+
+    for (UINT8 i = 0; p_cb->rl_entries != NULL && i < p_cb->rl_entry_num; i++) {
+        tBTM_BLE_RL_ENTRY *p_entry = &p_cb->rl_entries[i];
+
+        if (memcmp(p_entry->pseudo_addr, pseudo_bda, BD_ADDR_LEN) == 0) {
+            if (!controller_get_interface()->supports_ble_privacy()) {
+                btm_ble_clear_irk_index(p_entry->resolving_list_index);
+            }
+            *p_entry = p_cb->rl_entries[--p_cb->rl_entry_num];
+            break;
+        }
+    }
+
+    if (p_dev_rec != NULL) {
+        p_dev_rec->ble.in_controller_list &= ~BTM_RESOLVING_LIST_BIT;
+        if (!controller_get_interface()->supports_ble_privacy()) {
+            p_dev_rec->ble.resolving_list_index = 0;
+        }
     }
 }
 
@@ -301,13 +316,16 @@ void btm_ble_add_resolving_list_entry_complete(UINT8 *p, UINT16 evt_len)
         } else {
             btm_cb.ble_ctr_cb.resolving_list_avail_size --;
         }
-    } else if (status == HCI_ERR_MEMORY_FULL) { /* BT_ERROR_CODE_MEMORY_CAPACITY_EXCEEDED  */
-        btm_cb.ble_ctr_cb.resolving_list_avail_size = 0;
-        BTM_TRACE_ERROR("%s Resolving list Full ", __func__);
     } else {
-        BTM_TRACE_ERROR("%s Add resolving list error %d ", __func__, status);
+        if (status == HCI_ERR_MEMORY_FULL) { /* BT_ERROR_CODE_MEMORY_CAPACITY_EXCEEDED  */
+            btm_cb.ble_ctr_cb.resolving_list_avail_size = 0;
+            BTM_TRACE_ERROR("%s Resolving list Full ", __func__);
+        } else {
+            BTM_TRACE_ERROR("%s Add resolving list error %d ", __func__, status);
+        }
+        /* the sync counted the device in when the command was sent */
+        btm_ble_resolving_list_drop_entry(pseudo_bda);
     }
-
 }
 
 /*******************************************************************************
@@ -524,13 +542,12 @@ void btm_ble_resolving_list_vsc_op_cmpl (tBTM_VSC_CMPL *p_params)
 **
 ** Description      This function to remove an IRK entry from the list
 **
-** Parameters       ble_addr_type: address type
-**                  ble_addr: LE address
+** Parameters       p_entry: entry of the resolving list mirror
 **
 ** Returns          status
 **
 *******************************************************************************/
-tBTM_STATUS btm_ble_remove_resolving_list_entry(tBTM_SEC_DEV_REC *p_dev_rec)
+static tBTM_STATUS btm_ble_remove_resolving_list_entry(tBTM_BLE_RL_ENTRY *p_entry)
 {
     /* if controller does not support RPA offloading or privacy 1.2, skip */
     if (controller_get_interface()->get_ble_resolving_list_max_size() == 0) {
@@ -540,8 +557,8 @@ tBTM_STATUS btm_ble_remove_resolving_list_entry(tBTM_SEC_DEV_REC *p_dev_rec)
     tBTM_STATUS st = BTM_NO_RESOURCES;
     if (controller_get_interface()->supports_ble_privacy()) {
         #if CONTROLLER_RPA_LIST_ENABLE
-        if (btsnd_hcic_ble_rm_device_resolving_list(p_dev_rec->ble.static_addr_type,
-                p_dev_rec->ble.static_addr)) {
+        if (btsnd_hcic_ble_rm_device_resolving_list(p_entry->static_addr_type,
+                p_entry->static_addr)) {
             st =  BTM_CMD_STARTED;
         }
         #else
@@ -556,8 +573,8 @@ tBTM_STATUS btm_ble_remove_resolving_list_entry(tBTM_SEC_DEV_REC *p_dev_rec)
         UINT8 *p = param;
 
         UINT8_TO_STREAM(p, BTM_BLE_META_REMOVE_IRK_ENTRY);
-        UINT8_TO_STREAM(p, p_dev_rec->ble.static_addr_type);
-        BDADDR_TO_STREAM(p, p_dev_rec->ble.static_addr);
+        UINT8_TO_STREAM(p, p_entry->static_addr_type);
+        BDADDR_TO_STREAM(p, p_entry->static_addr);
 
         st = BTM_VendorSpecificCommand(HCI_VENDOR_BLE_RPA_VSC,
                                        BTM_BLE_META_REMOVE_IRK_LEN,
@@ -566,7 +583,7 @@ tBTM_STATUS btm_ble_remove_resolving_list_entry(tBTM_SEC_DEV_REC *p_dev_rec)
     }
 
     if (st == BTM_CMD_STARTED) {
-        btm_ble_enq_resolving_list_pending( p_dev_rec->bd_addr, BTM_BLE_META_REMOVE_IRK_ENTRY);
+        btm_ble_enq_resolving_list_pending(p_entry->pseudo_addr, BTM_BLE_META_REMOVE_IRK_ENTRY);
     }
 
     return st;
@@ -841,22 +858,261 @@ BOOLEAN btm_ble_disable_resolving_list(UINT8 rl_mask, BOOLEAN to_resume )
     return TRUE;
 }
 
+#if (SMP_INCLUDED == TRUE)
+/*******************************************************************************
+**
+** Function         btm_ble_resolving_list_wanted
+**
+** Description      check whether a device belongs in the resolving list, i.e.
+**                  it is in use and its identity key is known
+**
+** Returns          TRUE if the device should be in the resolving list
+**
+*******************************************************************************/
+static BOOLEAN btm_ble_resolving_list_wanted(tBTM_SEC_DEV_REC *p_dev_rec)
+{
+    return (p_dev_rec->sec_flags & BTM_SEC_IN_USE) != 0 &&
+           ((p_dev_rec->ble.key_type & BTM_LE_KEY_PID) != 0 ||
+            (p_dev_rec->ble.key_type & BTM_LE_KEY_LID) != 0);
+}
+
+/*******************************************************************************
+**
+** Function         btm_ble_add_resolving_list_entry
+**
+** Description      This function writes the IRK of a device into the controller
+**                  resolving list
+**
+** Parameters       pointer to device security record
+**
+** Returns          TRUE if the command was sent, or if the host resolves the
+**                  addresses of the device itself
+**
+*******************************************************************************/
+static BOOLEAN btm_ble_add_resolving_list_entry(tBTM_SEC_DEV_REC *p_dev_rec)
+{
+    BOOLEAN rt = FALSE;
+
+    if (controller_get_interface()->supports_ble_privacy()) {
+        BD_ADDR dummy_bda = {0};
+        if (memcmp(p_dev_rec->ble.static_addr, dummy_bda, BD_ADDR_LEN) == 0) {
+            memcpy(p_dev_rec->ble.static_addr, p_dev_rec->bd_addr, BD_ADDR_LEN);
+            p_dev_rec->ble.static_addr_type = p_dev_rec->ble.ble_addr_type;
+        }
+
+#if CONTROLLER_RPA_LIST_ENABLE
+        BTM_TRACE_DEBUG("%s:adding device to controller resolving list\n", __func__);
+        UINT8 *peer_irk = p_dev_rec->ble.keys.irk;
+        UINT8 *local_irk = btm_cb.devcb.id_keys.irk;
+        //use identical IRK for now
+        rt = btsnd_hcic_ble_add_device_resolving_list(p_dev_rec->ble.static_addr_type,
+               p_dev_rec->ble.static_addr, peer_irk, local_irk);
+#else
+        // do nothing
+        /* It will cause that scanner doesn't send scan request to advertiser
+         * which has sent IRK to us and we have stored the IRK in controller.
+         * It is a hardware limitation. The preliminary solution is not to
+         * send key to the controller, but to resolve the random address in host. */
+        return TRUE;
+#endif
+
+    } else {
+        UINT8 param[40] = {0};
+        UINT8 *p = param;
+
+        UINT8_TO_STREAM(p, BTM_BLE_META_ADD_IRK_ENTRY);
+        ARRAY_TO_STREAM(p, p_dev_rec->ble.keys.irk, BT_OCTET16_LEN);
+        UINT8_TO_STREAM(p, p_dev_rec->ble.static_addr_type);
+        BDADDR_TO_STREAM(p, p_dev_rec->ble.static_addr);
+
+        if (BTM_VendorSpecificCommand (HCI_VENDOR_BLE_RPA_VSC,
+                                       BTM_BLE_META_ADD_IRK_LEN,
+                                       param,
+                                       btm_ble_resolving_list_vsc_op_cmpl)
+                == BTM_CMD_STARTED) {
+            rt = TRUE;
+        }
+    }
+
+    if (rt) {
+        btm_ble_enq_resolving_list_pending(p_dev_rec->bd_addr,
+                                           BTM_BLE_META_ADD_IRK_ENTRY);
+    }
+
+    return rt;
+}
+
+/*******************************************************************************
+**
+** Function         btm_ble_resolving_list_room
+**
+** Description      This function counts the entries the next sync removes from
+**                  the controller resolving list, and the devices it can add
+**                  after that
+**
+** Parameters       p_num_remove: number of entries to remove
+**                  p_room: number of devices that can be added
+**
+** Returns          FALSE if the resolving list is not set up
+**
+*******************************************************************************/
+static BOOLEAN btm_ble_resolving_list_room(UINT8 *p_num_remove, UINT8 *p_room)
+{
+    tBTM_BLE_CB         *p_cb = &btm_cb.ble_ctr_cb;
+    UINT8               max_size = controller_get_interface()->get_ble_resolving_list_max_size();
+    UINT8               num_remove = 0;
+    UINT8               room;
+    tBTM_SEC_DEV_REC    *p_dev_rec;
+
+    if (max_size == 0 || p_cb->rl_entries == NULL) {
+        return FALSE;
+    }
+
+    /* entries whose device is gone, lost its keys or was dropped from the list */
+    for (UINT8 i = 0; i < p_cb->rl_entry_num; i++) {
+        p_dev_rec = btm_find_dev(p_cb->rl_entries[i].pseudo_addr);
+        if (p_dev_rec == NULL || !btm_ble_resolving_list_wanted(p_dev_rec) ||
+                !(p_dev_rec->ble.in_controller_list & BTM_RESOLVING_LIST_BIT)) {
+            num_remove++;
+        }
+    }
+
+    room = max_size - (p_cb->rl_entry_num - num_remove);
+    if (room > p_cb->resolving_list_avail_size + num_remove) {
+        room = p_cb->resolving_list_avail_size + num_remove;
+    }
+
+    *p_num_remove = num_remove;
+    *p_room = room;
+    return TRUE;
+}
+#endif  ///SMP_INCLUDED == TRUE
+
+/*******************************************************************************
+**
+** Function         btm_ble_resolving_list_sync
+**
+** Description      This function brings the controller resolving list in line
+**                  with the bonded devices. The entries to remove and to add
+**                  are worked out against the host copy of the list, then all
+**                  commands are sent within one suspension of scanning,
+**                  initiating and advertising.
+**
+** Returns          void
+**
+*******************************************************************************/
+void btm_ble_resolving_list_sync(void)
+{
+#if (SMP_INCLUDED == TRUE)
+    tBTM_BLE_CB         *p_cb = &btm_cb.ble_ctr_cb;
+    UINT8               rl_mask = p_cb->rl_state;
+    UINT8               num_remove;
+    UINT8               num_add = 0;
+    UINT8               room;
+    UINT8               i;
+    tBTM_SEC_DEV_REC    *p_dev_rec;
+    list_node_t         *p_node;
+
+    btu_stop_timer_oneshot(&p_cb->rl_sync_timer_ent);
+    if (!btm_ble_resolving_list_room(&num_remove, &room)) {
+        return;
+    }
+    for (p_node = list_begin(btm_cb.p_sec_dev_rec_list); p_node; p_node = list_next(p_node)) {
+        p_dev_rec = list_node(p_node);
+        if (btm_ble_resolving_list_wanted(p_dev_rec) &&
+                !(p_dev_rec->ble.in_controller_list & BTM_RESOLVING_LIST_BIT)) {
+            num_add++;
+        }
+    }
+    if (num_add > room) {
+        BTM_TRACE_WARNING("%s Resolving list full, %d devices left out", __func__, num_add - room);
+        num_add = room;
+    }
+
+    if (num_remove == 0 && num_add == 0) {
+        return;
+    }
+
+    BTM_TRACE_DEBUG("%s remove %d add %d", __func__, num_remove, num_add);
+
+    /* the list can not be edited while address resolution is in use */
+    if (rl_mask && !btm_ble_disable_resolving_list(rl_mask, FALSE)) {
+        btu_start_timer_oneshot(&p_cb->rl_sync_timer_ent, BTU_TTYPE_BLE_RL_SYNC, BTM_BLE_RL_SYNC_DELAY);
+        return;
+    }
+
+    for (i = 0; num_remove && i < p_cb->rl_entry_num;) {
+        tBTM_BLE_RL_ENTRY *p_entry = &p_cb->rl_entries[i];
+
+        p_dev_rec = btm_find_dev(p_entry->pseudo_addr);
+        if (p_dev_rec != NULL && btm_ble_resolving_list_wanted(p_dev_rec) &&
+                (p_dev_rec->ble.in_controller_list & BTM_RESOLVING_LIST_BIT)) {
+            i++;
+            continue;
+        }
+
+        btm_ble_remove_resolving_list_entry(p_entry);
+        if (p_dev_rec != NULL) {
+            p_dev_rec->ble.in_controller_list &= ~BTM_RESOLVING_LIST_BIT;
+        }
+        if (!controller_get_interface()->supports_ble_privacy()) {
+            btm_ble_clear_irk_index(p_entry->resolving_list_index);
+            if (p_dev_rec != NULL) {
+                p_dev_rec->ble.resolving_list_index = 0;
+            }
+        }
+        *p_entry = p_cb->rl_entries[--p_cb->rl_entry_num];
+        num_remove--;
+    }
+
+    for (p_node = list_begin(btm_cb.p_sec_dev_rec_list); num_add && p_node; p_node = list_next(p_node)) {
+        p_dev_rec = list_node(p_node);
+        if (!btm_ble_resolving_list_wanted(p_dev_rec) ||
+                (p_dev_rec->ble.in_controller_list & BTM_RESOLVING_LIST_BIT)) {
+            continue;
+        }
+
+        /* the VSC needs the IRK index assigned first; give it back on failure */
+        btm_ble_update_resolving_list(p_dev_rec->bd_addr, TRUE);
+        if (!btm_ble_add_resolving_list_entry(p_dev_rec)) {
+            BTM_TRACE_WARNING("%s failed to add device to resolving list", __func__);
+            btm_ble_update_resolving_list(p_dev_rec->bd_addr, FALSE);
+            continue;
+        }
+
+        tBTM_BLE_RL_ENTRY *p_entry = &p_cb->rl_entries[p_cb->rl_entry_num++];
+        memcpy(p_entry->pseudo_addr, p_dev_rec->bd_addr, BD_ADDR_LEN);
+        memcpy(p_entry->static_addr, p_dev_rec->ble.static_addr, BD_ADDR_LEN);
+        p_entry->static_addr_type = p_dev_rec->ble.static_addr_type;
+        p_entry->resolving_list_index = p_dev_rec->ble.resolving_list_index;
+        num_add--;
+    }
+
+    if (rl_mask) {
+        btm_ble_enable_resolving_list(rl_mask);
+    }
+#endif  ///SMP_INCLUDED == TRUE
+}
+
 /*******************************************************************************
 **
 ** Function         btm_ble_resolving_list_load_dev
 **
 ** Description      This function add a device which is using RPA into white list
 **
-** Parameters       pointer to device security record
+** Parameters       p_dev_rec: pointer to device security record
+**                  batch: TRUE if more devices are loaded right after this one,
+**                         e.g. while bonds are restored
 **
-** Returns          TRUE if device added, otherwise falase.
+** Returns          TRUE if device is or will be in the resolving list, otherwise falase.
 **
 *******************************************************************************/
-BOOLEAN btm_ble_resolving_list_load_dev(tBTM_SEC_DEV_REC *p_dev_rec)
+BOOLEAN btm_ble_resolving_list_load_dev(tBTM_SEC_DEV_REC *p_dev_rec, BOOLEAN batch)
 {
     BOOLEAN rt = FALSE;
 #if (SMP_INCLUDED == TRUE)
-    UINT8 rl_mask = btm_cb.ble_ctr_cb.rl_state;
+    UINT8 num_remove;
+    UINT8 room;
 
     BTM_TRACE_DEBUG("%s btm_cb.ble_ctr_cb.privacy_mode = %d\n", __func__,
                     btm_cb.ble_ctr_cb.privacy_mode);
@@ -866,83 +1122,41 @@ BOOLEAN btm_ble_resolving_list_load_dev(tBTM_SEC_DEV_REC *p_dev_rec)
         return FALSE;
     }
 
-    BTM_TRACE_DEBUG("%s btm_cb.ble_ctr_cb.privacy_mode = %d\n",
-                    __func__, btm_cb.ble_ctr_cb.privacy_mode);
-
     /* only add RPA enabled device into resolving list */
     if (p_dev_rec != NULL && /* RPA is being used and PID is known */
-            (p_dev_rec->sec_flags & BTM_SEC_IN_USE) != 0 &&
-            ((p_dev_rec->ble.key_type & BTM_LE_KEY_PID) != 0 ||
-             (p_dev_rec->ble.key_type & BTM_LE_KEY_LID) != 0)) {
-        if (!(p_dev_rec->ble.in_controller_list & BTM_RESOLVING_LIST_BIT) &&
-                btm_ble_brcm_find_resolving_pending_entry(p_dev_rec->bd_addr,
-                        BTM_BLE_META_ADD_IRK_ENTRY) == FALSE) {
-            if (btm_cb.ble_ctr_cb.resolving_list_avail_size > 0) {
-                if (rl_mask) {
-                    if (!btm_ble_disable_resolving_list (rl_mask, FALSE)) {
-                        return FALSE;
-                    }
-                }
-
-                btm_ble_update_resolving_list(p_dev_rec->bd_addr, TRUE);
-                if (controller_get_interface()->supports_ble_privacy()) {
-                    BD_ADDR dummy_bda = {0};
-                    if (memcmp(p_dev_rec->ble.static_addr, dummy_bda, BD_ADDR_LEN) == 0) {
-                        memcpy(p_dev_rec->ble.static_addr, p_dev_rec->bd_addr, BD_ADDR_LEN);
-                        p_dev_rec->ble.static_addr_type = p_dev_rec->ble.ble_addr_type;
-                    }
-
-#if CONTROLLER_RPA_LIST_ENABLE
-                    BTM_TRACE_DEBUG("%s:adding device to controller resolving list\n", __func__);
-                    UINT8 *peer_irk = p_dev_rec->ble.keys.irk;
-                    UINT8 *local_irk = btm_cb.devcb.id_keys.irk;
-                    //use identical IRK for now
-                    rt = btsnd_hcic_ble_add_device_resolving_list(p_dev_rec->ble.static_addr_type,
-                           p_dev_rec->ble.static_addr, peer_irk, local_irk);
-#else
-                    // do nothing
-                    /* It will cause that scanner doesn't send scan request to advertiser
-                     * which has sent IRK to us and we have stored the IRK in controller.
-                     * It is a hardware limitation. The preliminary solution is not to
-                     * send key to the controller, but to resolve the random address in host. */
-
-#endif
+            btm_ble_resolving_list_wanted(p_dev_rec)) {
+        if (p_dev_rec->ble.in_controller_list & BTM_RESOLVING_LIST_BIT) {
+            BTM_TRACE_DEBUG("Device already in Resolving list\n");
+            return TRUE;
+        }
 
-                } else {
-                    UINT8 param[40] = {0};
-                    UINT8 *p = param;
-
-                    UINT8_TO_STREAM(p, BTM_BLE_META_ADD_IRK_ENTRY);
-                    ARRAY_TO_STREAM(p, p_dev_rec->ble.keys.irk, BT_OCTET16_LEN);
-                    UINT8_TO_STREAM(p, p_dev_rec->ble.static_addr_type);
-                    BDADDR_TO_STREAM(p, p_dev_rec->ble.static_addr);
-
-                    if (BTM_VendorSpecificCommand (HCI_VENDOR_BLE_RPA_VSC,
-                                                   BTM_BLE_META_ADD_IRK_LEN,
-                                                   param,
-                                                   btm_ble_resolving_list_vsc_op_cmpl)
-                            == BTM_CMD_STARTED) {
-                        rt = TRUE;
-                    }
-                }
-
-                if (rt) {
-                    btm_ble_enq_resolving_list_pending(p_dev_rec->bd_addr,
-                                                       BTM_BLE_META_ADD_IRK_ENTRY);
-                }
-
-                /* if resolving list has been turned on, re-enable it */
-                // if (rl_mask) {
-                //     btm_ble_enable_resolving_list(rl_mask);
-                // } else {
-                //     btm_ble_enable_resolving_list(BTM_BLE_RL_INIT);
-                // }
-            } else {
-                BTM_TRACE_WARNING("%s Resolving list full ", __func__);
+        /* the sync adds devices in list order, count those ahead of this one */
+        if (!btm_ble_resolving_list_room(&num_remove, &room)) {
+            return FALSE;
+        }
+        for (list_node_t *p_node = list_begin(btm_cb.p_sec_dev_rec_list);
+                p_node && room > 0; p_node = list_next(p_node)) {
+            tBTM_SEC_DEV_REC *p_rec = list_node(p_node);
+            if (p_rec == p_dev_rec) {
+                rt = TRUE;
+                break;
+            }
+            if (btm_ble_resolving_list_wanted(p_rec) &&
+                    !(p_rec->ble.in_controller_list & BTM_RESOLVING_LIST_BIT)) {
+                room--;
             }
+        }
+        if (!rt) {
+            BTM_TRACE_WARNING("%s Resolving list full", __func__);
+            return FALSE;
+        }
+
+        if (batch) {
+            /* devices loaded back to back are written in one go */
+            btu_start_timer_oneshot(&btm_cb.ble_ctr_cb.rl_sync_timer_ent, BTU_TTYPE_BLE_RL_SYNC,
+                                    BTM_BLE_RL_SYNC_DELAY);
         } else {
-            BTM_TRACE_DEBUG("Device already in Resolving list\n");
-            rt = TRUE;
+            btm_ble_resolving_list_sync();
         }
     } else {
         BTM_TRACE_DEBUG("Device not a RPA enabled device\n");
@@ -964,28 +1178,16 @@ BOOLEAN btm_ble_resolving_list_load_dev(tBTM_SEC_DEV_REC *p_dev_rec)
 *******************************************************************************/
 void btm_ble_resolving_list_remove_dev(tBTM_SEC_DEV_REC *p_dev_rec)
 {
-    UINT8 rl_mask = btm_cb.ble_ctr_cb.rl_state;
-
     BTM_TRACE_EVENT ("%s\n", __func__);
-    if (rl_mask) {
-        if (!btm_ble_disable_resolving_list (rl_mask, FALSE)) {
-            return;
-        }
-    }
 
-    if ((p_dev_rec->ble.in_controller_list & BTM_RESOLVING_LIST_BIT) &&
-            btm_ble_brcm_find_resolving_pending_entry(p_dev_rec->bd_addr,
-                    BTM_BLE_META_REMOVE_IRK_ENTRY) == FALSE) {
-        btm_ble_update_resolving_list( p_dev_rec->bd_addr, FALSE);
-        btm_ble_remove_resolving_list_entry(p_dev_rec);
+    if (p_dev_rec->ble.in_controller_list & BTM_RESOLVING_LIST_BIT) {
+        /* the entry stays in the host copy of the list until the controller drops it */
+        p_dev_rec->ble.in_controller_list &= ~BTM_RESOLVING_LIST_BIT;
+        btu_start_timer_oneshot(&btm_cb.ble_ctr_cb.rl_sync_timer_ent, BTU_TTYPE_BLE_RL_SYNC,
+                                BTM_BLE_RL_SYNC_DELAY);
     } else {
         BTM_TRACE_DEBUG("Device not in resolving list\n");
     }
-
-    /* if resolving list has been turned on, re-enable it */
-    // if (rl_mask) {
-    //     btm_ble_enable_resolving_list(rl_mask);
-    // }
 }
 
 /*******************************************************************************
@@ -1086,8 +1288,17 @@ void btm_ble_resolving_list_init(UINT8 max_irk_list_sz)
                            (max_irk_list_sz / 8 + 1) : (max_irk_list_sz / 8);
 
     if (max_irk_list_sz > 0) {
-        p_q->resolve_q_random_pseudo = (BD_ADDR *)osi_malloc(sizeof(BD_ADDR) * max_irk_list_sz);
-        p_q->resolve_q_action = (UINT8 *)osi_malloc(max_irk_list_sz);
+        /* a sync may have a removal and an addition in flight for every entry */
+        p_q->q_size = (max_irk_list_sz > UINT8_MAX / 2) ? UINT8_MAX : max_irk_list_sz * 2;
+        p_q->q_next = p_q->q_pending = 0;
+        osi_free(p_q->resolve_q_random_pseudo);
+        osi_free(p_q->resolve_q_action);
+        p_q->resolve_q_random_pseudo = (BD_ADDR *)osi_malloc(sizeof(BD_ADDR) * p_q->q_size);
+        p_q->resolve_q_action = (UINT8 *)osi_malloc(p_q->q_size);
+
+        osi_free(btm_cb.ble_ctr_cb.rl_entries);
+        btm_cb.ble_ctr_cb.rl_entries = (tBTM_BLE_RL_ENTRY *)osi_malloc(sizeof(tBTM_BLE_RL_ENTRY) * max_irk_list_sz);
+        btm_cb.ble_ctr_cb.rl_entry_num = 0;
 
         /* RPA offloading feature */
         if (btm_cb.ble_ctr_cb.irk_list_mask == NULL) {
@@ -1127,6 +1338,13 @@ void btm_ble_resolving_list_cleanup(void)
         p_q->resolve_q_action = NULL;
     }
 
+    btu_stop_timer_oneshot(&btm_cb.ble_ctr_cb.rl_sync_timer_ent);
+    if (btm_cb.ble_ctr_cb.rl_entries) {
+        osi_free(btm_cb.ble_ctr_cb.rl_entries);
+        btm_cb.ble_ctr_cb.rl_entries = NULL;
+    }
+    btm_cb.ble_ctr_cb.rl_entry_num = 0;
+
     controller_get_interface()->set_ble_resolving_list_max_size(0);
     if (btm_cb.ble_ctr_cb.irk_list_mask) {
         osi_free(btm_cb.ble_ctr_cb.irk_list_mask);
@@ -47,6 +47,10 @@
 #ifndef BTM_INQ_DEBUG
 #define BTM_INQ_DEBUG   FALSE
 #endif
+
+/* EIR data types located by btm_eir_index(), flags up to TX power level */
+#define BTM_EIR_INDEX_SIZE      (BTM_EIR_TX_POWER_LEVEL_TYPE + 1)
+
 /********************************************************************************/
 /*                 L O C A L    D A T A    D E F I N I T I O N S                */
 /********************************************************************************/
@@ -138,7 +142,8 @@ static void         btm_clr_inq_result_flt (void);
 
 static UINT8        btm_convert_uuid_to_eir_service( UINT16 uuid16 );
 static void         btm_set_eir_uuid( UINT8 *p_eir, tBTM_INQ_RESULTS *p_results );
-static UINT8       *btm_eir_get_uuid_list( UINT8 *p_eir, UINT8 uuid_size,
+static void         btm_eir_index( UINT8 *p_eir, UINT8 *p_index );
+static UINT8       *btm_eir_get_uuid_list( UINT8 *p_eir, const UINT8 *p_index, UINT8 uuid_size,
         UINT8 *p_num_uuid, UINT8 *p_uuid_list_type );
 static UINT16       btm_convert_uuid_to_uuid16( UINT8 *p_uuid, UINT8 uuid_size );
 
@@ -1396,6 +1401,129 @@ void btm_inq_clear_ssp(void)
     btm_cb.btm_inq_vars.inq_active &= ~BTM_SSP_INQUIRY_ACTIVE;
 }
 
+/*******************************************************************************
+**
+** Function         btm_inq_hash
+**
+** Description      Bucket seed of the inquiry address indexes. The low address
+**                  bytes differ the most between devices.
+**
+** Returns          hash of the address, to be masked by the bucket count
+**
+*******************************************************************************/
+static UINT16 btm_inq_hash (BD_ADDR bda)
+{
+    return (UINT16)(bda[3] ^ bda[4] ^ bda[5]);
+}
+
+/*******************************************************************************
+**
+** Function         btm_inq_db_lru_unlink
+**
+** Description      Remove an inquiry database entry from the reuse order.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void btm_inq_db_lru_unlink (tINQ_DB_ENT *p_ent)
+{
+    tBTM_INQUIRY_VAR_ST *p_inq = &btm_cb.btm_inq_vars;
+
+    if (p_ent->lru_prev) {
+        p_inq->inq_db[p_ent->lru_prev - 1].lru_next = p_ent->lru_next;
+    } else {
+        p_inq->inq_db_lru_head = p_ent->lru_next;
+    }
+    if (p_ent->lru_next) {
+        p_inq->inq_db[p_ent->lru_next - 1].lru_prev = p_ent->lru_prev;
+    } else {
+        p_inq->inq_db_lru_tail = p_ent->lru_prev;
+    }
+    p_ent->lru_prev = p_ent->lru_next = 0;
+}
+
+/*******************************************************************************
+**
+** Function         btm_inq_db_touch
+**
+** Description      Record a response from the device of an inquiry database
+**                  entry, making it the last one to be reused.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void btm_inq_db_touch (tINQ_DB_ENT *p_ent)
+{
+    tBTM_INQUIRY_VAR_ST *p_inq = &btm_cb.btm_inq_vars;
+    UINT16              xx = (UINT16)(p_ent - p_inq->inq_db) + 1;
+
+    p_ent->time_of_resp = osi_time_get_os_boottime_ms();
+
+    btm_inq_db_lru_unlink(p_ent);
+    p_ent->lru_prev = p_inq->inq_db_lru_tail;
+    if (p_inq->inq_db_lru_tail) {
+        p_inq->inq_db[p_inq->inq_db_lru_tail - 1].lru_next = xx;
+    } else {
+        p_inq->inq_db_lru_head = xx;
+    }
+    p_inq->inq_db_lru_tail = xx;
+}
+
+/*******************************************************************************
+**
+** Function         btm_inq_db_reindex
+**
+** Description      Rebuild the address index and the reuse order after the
+**                  entries of the inquiry database have been moved around.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void btm_inq_db_reindex (void)
+{
+    tBTM_INQUIRY_VAR_ST *p_inq = &btm_cb.btm_inq_vars;
+    tINQ_DB_ENT         *p_ent = p_inq->inq_db;
+    UINT16              *p_bucket;
+    UINT16              xx, yy;
+
+    memset(p_inq->inq_db_hash, 0, sizeof(p_inq->inq_db_hash));
+    p_inq->inq_db_lru_head = 0;
+    p_inq->inq_db_lru_tail = 0;
+    p_inq->inq_db_free = 0;
+    p_inq->inq_db_used = BTM_INQ_DB_SIZE;
+
+    for (xx = 0; xx < BTM_INQ_DB_SIZE; xx++, p_ent++) {
+        p_ent->lru_prev = p_ent->lru_next = 0;
+        if (!p_ent->in_use) {
+            p_ent->hash_next = p_inq->inq_db_free;
+            p_inq->inq_db_free = xx + 1;
+            continue;
+        }
+
+        p_bucket = &p_inq->inq_db_hash[btm_inq_hash(p_ent->inq_info.results.remote_bd_addr) & (BTM_INQ_DB_HASH_SIZE - 1)];
+        p_ent->hash_next = *p_bucket;
+        *p_bucket = xx + 1;
+
+        /* Insert by time of response, oldest first */
+        yy = p_inq->inq_db_lru_tail;
+        while (yy && p_inq->inq_db[yy - 1].time_of_resp > p_ent->time_of_resp) {
+            yy = p_inq->inq_db[yy - 1].lru_prev;
+        }
+        p_ent->lru_prev = yy;
+        p_ent->lru_next = yy ? p_inq->inq_db[yy - 1].lru_next : p_inq->inq_db_lru_head;
+        if (yy) {
+            p_inq->inq_db[yy - 1].lru_next = xx + 1;
+        } else {
+            p_inq->inq_db_lru_head = xx + 1;
+        }
+        if (p_ent->lru_next) {
+            p_inq->inq_db[p_ent->lru_next - 1].lru_prev = xx + 1;
+        } else {
+            p_inq->inq_db_lru_tail = xx + 1;
+        }
+    }
+}
+
 /*********************************************************************************
 **
 ** Function         btm_clr_inq_db
@@ -1419,14 +1547,19 @@ void btm_clr_inq_db (BD_ADDR p_bda)
     BTM_TRACE_DEBUG ("btm_clr_inq_db: inq_active:0x%x state:%d\n",
                      btm_cb.btm_inq_vars.inq_active, btm_cb.btm_inq_vars.state);
 #endif
-    for (xx = 0; xx < BTM_INQ_DB_SIZE; xx++, p_ent++) {
-        if (p_ent->in_use) {
-            /* If this is the specified BD_ADDR or clearing all devices */
-            if (p_bda == NULL ||
-                    (!memcmp (p_ent->inq_info.results.remote_bd_addr, p_bda, BD_ADDR_LEN))) {
-                p_ent->in_use = FALSE;
-            }
+    if (p_bda != NULL) {
+        if ((p_ent = btm_inq_db_find(p_bda)) != NULL) {
+            btm_inq_db_free(p_ent);
+        }
+    } else {
+        for (xx = 0; xx < BTM_INQ_DB_SIZE; xx++, p_ent++) {
+            p_ent->in_use = FALSE;
         }
+        memset(p_inq->inq_db_hash, 0, sizeof(p_inq->inq_db_hash));
+        p_inq->inq_db_lru_head = 0;
+        p_inq->inq_db_lru_tail = 0;
+        p_inq->inq_db_free = 0;
+        p_inq->inq_db_used = 0;
     }
 #if (BTM_INQ_DEBUG == TRUE)
     BTM_TRACE_DEBUG ("inq_active:0x%x state:%d\n",
@@ -1452,6 +1585,7 @@ static void btm_clr_inq_result_flt (void)
     if (p_inq->p_bd_db) {
         osi_free(p_inq->p_bd_db);
         p_inq->p_bd_db = NULL;
+        p_inq->p_bd_hash = NULL;
     }
     p_inq->num_bd_entries = 0;
     p_inq->max_bd_entries = 0;
@@ -1470,25 +1604,30 @@ static void btm_clr_inq_result_flt (void)
 BOOLEAN btm_inq_find_bdaddr (BD_ADDR p_bda)
 {
     tBTM_INQUIRY_VAR_ST *p_inq = &btm_cb.btm_inq_vars;
-    tINQ_BDADDR         *p_db = &p_inq->p_bd_db[0];
-    UINT16       xx;
+    tINQ_BDADDR         *p_db = p_inq->p_bd_db;
+    UINT16              *p_bucket;
+    UINT16               xx;
 
     /* Don't bother searching, database doesn't exist or periodic mode */
     if ((p_inq->inq_active & BTM_PERIODIC_INQUIRY_ACTIVE) || !p_db) {
         return (FALSE);
     }
 
-    for (xx = 0; xx < p_inq->num_bd_entries; xx++, p_db++) {
-        if (!memcmp(p_db->bd_addr, p_bda, BD_ADDR_LEN)
-                && p_db->inq_count == p_inq->inq_counter) {
+    p_bucket = &p_inq->p_bd_hash[btm_inq_hash(p_bda) & (BTM_INQ_BD_HASH_SIZE - 1)];
+    /* The filter is allocated afresh for every inquiry, so all its entries
+     * belong to the current one */
+    for (xx = *p_bucket; xx; xx = p_db[xx - 1].hash_next) {
+        if (!memcmp(p_db[xx - 1].bd_addr, p_bda, BD_ADDR_LEN)) {
             return (TRUE);
         }
     }
 
-    if (xx < p_inq->max_bd_entries) {
+    if (p_inq->num_bd_entries < p_inq->max_bd_entries) {
+        p_db += p_inq->num_bd_entries;
         p_db->inq_count = p_inq->inq_counter;
         memcpy(p_db->bd_addr, p_bda, BD_ADDR_LEN);
-        p_inq->num_bd_entries++;
+        p_db->hash_next = *p_bucket;
+        *p_bucket = ++p_inq->num_bd_entries;
     }
 
     /* If here, New Entry */
@@ -1507,13 +1646,15 @@ BOOLEAN btm_inq_find_bdaddr (BD_ADDR p_bda)
 *******************************************************************************/
 tINQ_DB_ENT *btm_inq_db_find (BD_ADDR p_bda)
 {
-    UINT16       xx;
-    tINQ_DB_ENT  *p_ent = btm_cb.btm_inq_vars.inq_db;
+    tINQ_DB_ENT  *p_ent;
+    UINT16       xx = btm_cb.btm_inq_vars.inq_db_hash[btm_inq_hash(p_bda) & (BTM_INQ_DB_HASH_SIZE - 1)];
 
-    for (xx = 0; xx < BTM_INQ_DB_SIZE; xx++, p_ent++) {
-        if ((p_ent->in_use) && (!memcmp (p_ent->inq_info.results.remote_bd_addr, p_bda, BD_ADDR_LEN))) {
+    while (xx) {
+        p_ent = &btm_cb.btm_inq_vars.inq_db[xx - 1];
+        if (!memcmp (p_ent->inq_info.results.remote_bd_addr, p_bda, BD_ADDR_LEN)) {
             return (p_ent);
         }
+        xx = p_ent->hash_next;
     }
 
     /* If here, not found */
@@ -1533,35 +1674,76 @@ tINQ_DB_ENT *btm_inq_db_find (BD_ADDR p_bda)
 *******************************************************************************/
 tINQ_DB_ENT *btm_inq_db_new (BD_ADDR p_bda)
 {
-    UINT16       xx;
-    tINQ_DB_ENT  *p_ent = btm_cb.btm_inq_vars.inq_db;
-    tINQ_DB_ENT  *p_old = btm_cb.btm_inq_vars.inq_db;
-    UINT32       ot = 0xFFFFFFFF;
-
-    for (xx = 0; xx < BTM_INQ_DB_SIZE; xx++, p_ent++) {
-        if (!p_ent->in_use) {
-            memset (p_ent, 0, sizeof (tINQ_DB_ENT));
-            memcpy (p_ent->inq_info.results.remote_bd_addr, p_bda, BD_ADDR_LEN);
-            p_ent->in_use = TRUE;
+    tBTM_INQUIRY_VAR_ST *p_inq = &btm_cb.btm_inq_vars;
+    tINQ_DB_ENT         *p_ent;
+    UINT16              *p_bucket = &p_inq->inq_db_hash[btm_inq_hash(p_bda) & (BTM_INQ_DB_HASH_SIZE - 1)];
+    UINT16              xx;
 
-            return (p_ent);
-        }
+    if (!p_inq->inq_db_free && p_inq->inq_db_used == BTM_INQ_DB_SIZE) {
+        /* If here, no free entry found. Reuse the oldest. */
+        btm_inq_db_free(&p_inq->inq_db[p_inq->inq_db_lru_head - 1]);
+    }
 
-        if (p_ent->time_of_resp < ot) {
-            p_old = p_ent;
-            ot    = p_ent->time_of_resp;
-        }
+    if (p_inq->inq_db_free) {
+        xx = p_inq->inq_db_free - 1;
+        p_inq->inq_db_free = p_inq->inq_db[xx].hash_next;
+    } else {
+        xx = p_inq->inq_db_used++;
     }
 
-    /* If here, no free entry found. Return the oldest. */
+    p_ent = &p_inq->inq_db[xx];
+    memset (p_ent, 0, sizeof (tINQ_DB_ENT));
+    memcpy (p_ent->inq_info.results.remote_bd_addr, p_bda, BD_ADDR_LEN);
+    p_ent->in_use = TRUE;
+
+    p_ent->hash_next = *p_bucket;
+    *p_bucket = xx + 1;
 
-    memset (p_old, 0, sizeof (tINQ_DB_ENT));
-    memcpy (p_old->inq_info.results.remote_bd_addr, p_bda, BD_ADDR_LEN);
-    p_old->in_use = TRUE;
+    /* Not heard from yet, so the first to be reused */
+    p_ent->lru_next = p_inq->inq_db_lru_head;
+    if (p_inq->inq_db_lru_head) {
+        p_inq->inq_db[p_inq->inq_db_lru_head - 1].lru_prev = xx + 1;
+    } else {
+        p_inq->inq_db_lru_tail = xx + 1;
+    }
+    p_inq->inq_db_lru_head = xx + 1;
 
-    return (p_old);
+    return (p_ent);
 }
 
+/*******************************************************************************
+**
+** Function         btm_inq_db_free
+**
+** Description      This function releases an entry of the inquiry database.
+**
+** Returns          void
+**
+*******************************************************************************/
+void btm_inq_db_free (tINQ_DB_ENT *p_ent)
+{
+    tBTM_INQUIRY_VAR_ST *p_inq = &btm_cb.btm_inq_vars;
+    UINT16              xx = (UINT16)(p_ent - p_inq->inq_db) + 1;
+    UINT16              *p_idx;
+
+    if (!p_ent->in_use) {
+        return;
+    }
+
+    p_idx = &p_inq->inq_db_hash[btm_inq_hash(p_ent->inq_info.results.remote_bd_addr) & (BTM_INQ_DB_HASH_SIZE - 1)];
+    while (*p_idx && *p_idx != xx) {
+        p_idx = &p_inq->inq_db[*p_idx - 1].hash_next;
+    }
+    if (*p_idx) {
+        *p_idx = p_ent->hash_next;
+    }
+
+    btm_inq_db_lru_unlink(p_ent);
+
+    p_ent->in_use = FALSE;
+    p_ent->hash_next = p_inq->inq_db_free;
+    p_inq->inq_db_free = xx;
+}
 
 /*******************************************************************************
 **
@@ -1774,7 +1956,9 @@ static void btm_initiate_inquiry (tBTM_INQUIRY_VAR_ST *p_inq)
 
         /* Allocate memory to hold bd_addrs responding */
         if ((p_inq->p_bd_db = (tINQ_BDADDR *)osi_calloc(BT_DEFAULT_BUFFER_SIZE)) != NULL) {
-            p_inq->max_bd_entries = (UINT16)(BT_DEFAULT_BUFFER_SIZE / sizeof(tINQ_BDADDR));
+            p_inq->max_bd_entries = (UINT16)((BT_DEFAULT_BUFFER_SIZE - BTM_INQ_BD_HASH_SIZE * sizeof(UINT16)) /
+                                             sizeof(tINQ_BDADDR));
+            p_inq->p_bd_hash = (UINT16 *)(p_inq->p_bd_db + p_inq->max_bd_entries);
             /*            BTM_TRACE_DEBUG("btm_initiate_inquiry: memory allocated for %d bdaddrs",
                                           p_inq->max_bd_entries); */
         }
@@ -1937,7 +2121,7 @@ void btm_process_inq_results (UINT8 *p, UINT8 inq_res_mode)
             p_cur->dev_class[2]       = dc[2];
             p_cur->clock_offset       = clock_offset  | BTM_CLOCK_OFFSET_VALID;
 
-            p_i->time_of_resp = osi_time_get_os_boottime_ms();
+            btm_inq_db_touch(p_i);
 
             if (p_i->inq_count != p_inq->inq_counter) {
                 p_inq->inq_cmpl_info.num_resp++;    /* A new response was found */
@@ -2032,6 +2216,7 @@ void btm_sort_inq_result(void)
         }
 
         osi_free(p_tmp);
+        btm_inq_db_reindex();
     }
 }
 
@@ -2440,6 +2625,67 @@ UINT8 *BTM_CheckEirData( UINT8 *p_eir, UINT8 type, UINT8 *p_length )
     return NULL;
 }
 
+/*******************************************************************************
+**
+** Function         btm_eir_index
+**
+** Description      This function walks the EIR once and records where the data
+**                  of each type below BTM_EIR_INDEX_SIZE starts, so that the
+**                  lookups of one call need a single walk. The index points
+**                  into the EIR of the event being processed and is not kept.
+**
+** Parameters       p_eir - pointer of EIR significant part
+**                  p_index - offsets of the data from p_eir, 0 if not present
+**
+** Returns          None
+**
+*******************************************************************************/
+static void btm_eir_index( UINT8 *p_eir, UINT8 *p_index )
+{
+    UINT8 *p = p_eir;
+    UINT8 length;
+    UINT8 eir_type;
+
+    memset(p_index, 0, BTM_EIR_INDEX_SIZE);
+
+    STREAM_TO_UINT8(length, p);
+    while ( length && (p - p_eir <= HCI_EXT_INQ_RESPONSE_LEN)) {
+        STREAM_TO_UINT8(eir_type, p);
+        /* the first field of a type wins, as in BTM_CheckEirData */
+        if ( eir_type < BTM_EIR_INDEX_SIZE && p_index[eir_type] == 0 ) {
+            p_index[eir_type] = (UINT8)(p - p_eir);
+        }
+        p += length - 1; /* skip the length of data */
+        STREAM_TO_UINT8(length, p);
+    }
+}
+
+/*******************************************************************************
+**
+** Function         btm_eir_index_data
+**
+** Description      This function returns EIR data located by btm_eir_index.
+**
+** Parameters       p_eir - pointer of EIR significant part
+**                  p_index - offsets built by btm_eir_index
+**                  type   - finding EIR data type
+**                  p_length - return the length of EIR data not including type
+**
+** Returns          pointer of EIR data
+**
+*******************************************************************************/
+static UINT8 *btm_eir_index_data( UINT8 *p_eir, const UINT8 *p_index, UINT8 type, UINT8 *p_length )
+{
+    if ( p_index[type] == 0 ) {
+        *p_length = 0;
+        return NULL;
+    }
+
+    /* the length byte precedes the type byte */
+    *p_length = p_eir[p_index[type] - 2] - 1;
+    return p_eir + p_index[type];
+}
+
 /*******************************************************************************
 **
 ** Function         btm_convert_uuid_to_eir_service
@@ -2765,8 +3011,10 @@ UINT8 BTM_GetEirUuidList( UINT8 *p_eir, UINT8 uuid_size, UINT8 *p_num_uuid,
     UINT16  *p_uuid16 = (UINT16 *)p_uuid_list;
     UINT32  *p_uuid32 = (UINT32 *)p_uuid_list;
     char    buff[LEN_UUID_128 * 2 + 1];
+    UINT8   eir_index[BTM_EIR_INDEX_SIZE];
 
-    p_uuid_data = btm_eir_get_uuid_list( p_eir, uuid_size, p_num_uuid, &type );
+    btm_eir_index( p_eir, eir_index );
+    p_uuid_data = btm_eir_get_uuid_list( p_eir, eir_index, uuid_size, p_num_uuid, &type );
     if ( p_uuid_data == NULL ) {
         return 0x00;
     }
@@ -2810,6 +3058,7 @@ UINT8 BTM_GetEirUuidList( UINT8 *p_eir, UINT8 uuid_size, UINT8 *p_num_uuid,
 ** Description      This function searches UUID list in EIR.
 **
 ** Parameters       p_eir - address of EIR
+**                  p_index - offsets built by btm_eir_index
 **                  uuid_size - size of UUID to find
 **                  p_num_uuid - number of UUIDs found
 **                  p_uuid_list_type - EIR data type
@@ -2818,7 +3067,7 @@ UINT8 BTM_GetEirUuidList( UINT8 *p_eir, UINT8 uuid_size, UINT8 *p_num_uuid,
 **                  beginning of UUID list in EIR - otherwise
 **
 *******************************************************************************/
-static UINT8 *btm_eir_get_uuid_list( UINT8 *p_eir, UINT8 uuid_size,
+static UINT8 *btm_eir_get_uuid_list( UINT8 *p_eir, const UINT8 *p_index, UINT8 uuid_size,
                                      UINT8 *p_num_uuid, UINT8 *p_uuid_list_type )
 {
     UINT8   *p_uuid_data;
@@ -2844,9 +3093,9 @@ static UINT8 *btm_eir_get_uuid_list( UINT8 *p_eir, UINT8 uuid_size,
         break;
     }
 
-    p_uuid_data = BTM_CheckEirData( p_eir, complete_type, &uuid_len );
+    p_uuid_data = btm_eir_index_data( p_eir, p_index, complete_type, &uuid_len );
     if (p_uuid_data == NULL) {
-        p_uuid_data = BTM_CheckEirData( p_eir, more_type, &uuid_len );
+        p_uuid_data = btm_eir_index_data( p_eir, p_index, more_type, &uuid_len );
         *p_uuid_list_type = more_type;
     } else {
         *p_uuid_list_type = complete_type;
@@ -2932,8 +3181,10 @@ void btm_set_eir_uuid( UINT8 *p_eir, tBTM_INQ_RESULTS *p_results )
     UINT16  uuid16;
     UINT8   yy;
     UINT8   type = BTM_EIR_MORE_16BITS_UUID_TYPE;
+    UINT8   eir_index[BTM_EIR_INDEX_SIZE];
 
-    p_uuid_data = btm_eir_get_uuid_list( p_eir, LEN_UUID_16, &num_uuid, &type );
+    btm_eir_index( p_eir, eir_index );
+    p_uuid_data = btm_eir_get_uuid_list( p_eir, eir_index, LEN_UUID_16, &num_uuid, &type );
 
     if (type == BTM_EIR_COMPLETE_16BITS_UUID_TYPE) {
         p_results->eir_complete_list = TRUE;
@@ -2950,7 +3201,7 @@ void btm_set_eir_uuid( UINT8 *p_eir, tBTM_INQ_RESULTS *p_results )
         }
     }
 
-    p_uuid_data = btm_eir_get_uuid_list( p_eir, LEN_UUID_32, &num_uuid, &type );
+    p_uuid_data = btm_eir_get_uuid_list( p_eir, eir_index, LEN_UUID_32, &num_uuid, &type );
     if ( p_uuid_data ) {
         for ( yy = 0; yy < num_uuid; yy++ ) {
             uuid16 = btm_convert_uuid_to_uuid16( p_uuid_data, LEN_UUID_32 );
@@ -2961,7 +3212,7 @@ void btm_set_eir_uuid( UINT8 *p_eir, tBTM_INQ_RESULTS *p_results )
         }
     }
 
-    p_uuid_data = btm_eir_get_uuid_list( p_eir, LEN_UUID_128, &num_uuid, &type );
+    p_uuid_data = btm_eir_get_uuid_list( p_eir, eir_index, LEN_UUID_128, &num_uuid, &type );
     if ( p_uuid_data ) {
         for ( yy = 0; yy < num_uuid; yy++ ) {
             uuid16 = btm_convert_uuid_to_uuid16( p_uuid_data, LEN_UUID_128 );
@@ -299,8 +299,17 @@ typedef struct {
     UINT8           *resolve_q_action;
     UINT8           q_next;
     UINT8           q_pending;
+    UINT8           q_size;
 } tBTM_BLE_RESOLVE_Q;
 
+/* controller resolving list entry as last written by the host */
+typedef struct {
+    BD_ADDR         pseudo_addr;
+    BD_ADDR         static_addr;
+    tBLE_ADDR_TYPE  static_addr_type;
+    UINT8           resolving_list_index;
+} tBTM_BLE_RL_ENTRY;
+
 typedef struct {
     BOOLEAN     in_use;
     BOOLEAN     to_add;
@@ -369,6 +378,9 @@ typedef struct {
     tBTM_BLE_RL_STATE suspended_rl_state; /* Suspended resolving list state */
     UINT8 *irk_list_mask; /* IRK list availability mask, up to max entry bits */
     tBTM_BLE_RL_STATE rl_state; /* Resolving list state */
+    tBTM_BLE_RL_ENTRY *rl_entries; /* controller resolving list mirror */
+    UINT8 rl_entry_num;
+    TIMER_LIST_ENT rl_sync_timer_ent; /* coalesces resolving list updates */
 #endif
 
     tBTM_BLE_WL_OP wl_op_q[BTM_BLE_MAX_BG_CONN_DEV_NUM];
@@ -498,6 +510,7 @@ void btm_ble_enable_resolving_list_for_platform (UINT8 rl_mask);
 void btm_ble_resolving_list_init(UINT8 max_irk_list_sz);
 void btm_ble_resolving_list_cleanup(void);
 void btm_ble_add_default_entry_to_resolving_list(void);
+void btm_ble_resolving_list_sync(void);
 void btm_ble_set_privacy_mode_complete(UINT8 *p, UINT16 evt_len);
 #endif
 
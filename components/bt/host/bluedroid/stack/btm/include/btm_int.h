@@ -284,12 +284,23 @@ BOOLEAN              secure_connections_only;    /* Rejects service level 0 conn
 #define BTM_MIN_INQ_TX_POWER    -70
 #define BTM_MAX_INQ_TX_POWER    20
 
+/* Buckets of the inquiry database address index */
+#if (BTM_INQ_DB_SIZE > 16)
+#define BTM_INQ_DB_HASH_SIZE    64
+#else
+#define BTM_INQ_DB_HASH_SIZE    16
+#endif
+
+/* Buckets of the per inquiry address filter, kept at the end of p_bd_db */
+#define BTM_INQ_BD_HASH_SIZE    128
+
 typedef struct {
 UINT32          inq_count;          /* Used for determining if a response has already been      */
 /* received for the current inquiry operation. (We do not   */
 /* want to flood the caller with multiple responses from    */
 /* the same device.                                         */
 BD_ADDR         bd_addr;
+UINT16          hash_next;          /* next entry + 1 in the same bucket, 0 if none */
 } tINQ_BDADDR;
 
 typedef struct {
@@ -301,6 +312,9 @@ UINT32          inq_count;          /* "timestamps" the entry with a particular
 /* the same device.                                         */
 tBTM_INQ_INFO   inq_info;
 BOOLEAN         in_use;
+UINT16          hash_next;          /* next entry + 1 in the same address bucket, 0 if none */
+UINT16          lru_prev;           /* entry + 1 used less recently, 0 if oldest */
+UINT16          lru_next;           /* entry + 1 used more recently, 0 if newest */
 
 #if (BLE_INCLUDED == TRUE)
 BOOLEAN         scan_rsp;
@@ -351,9 +365,15 @@ typedef struct {
     /* have responded to the same inquiry */
     TIMER_LIST_ENT   inq_timer_ent;
     tINQ_BDADDR     *p_bd_db;               /* Pointer to memory that holds bdaddrs */
+    UINT16          *p_bd_hash;             /* Address buckets of p_bd_db, in the same block */
     UINT16           num_bd_entries;        /* Number of entries in database */
     UINT16           max_bd_entries;        /* Maximum number of entries that can be stored */
     tINQ_DB_ENT      inq_db[BTM_INQ_DB_SIZE];
+    UINT16           inq_db_hash[BTM_INQ_DB_HASH_SIZE]; /* entry + 1 heading each address bucket */
+    UINT16           inq_db_lru_head;       /* entry + 1 used least recently, 0 if empty */
+    UINT16           inq_db_lru_tail;       /* entry + 1 used most recently, 0 if empty */
+    UINT16           inq_db_free;           /* released entry + 1, chained by hash_next */
+    UINT16           inq_db_used;           /* entries above this have never been used */
     tBTM_INQ_PARMS   inqparms;              /* Contains the parameters for the current inquiry */
     tBTM_INQUIRY_CMPL inq_cmpl_info;        /* Status and number of responses from the last inquiry */
 
@@ -1042,6 +1062,7 @@ void         btm_event_filter_complete (UINT8 *p);
 void         btm_inq_stop_on_ssp(void);
 void         btm_inq_clear_ssp(void);
 tINQ_DB_ENT *btm_inq_db_find (BD_ADDR p_bda);
+void         btm_inq_db_free (tINQ_DB_ENT *p_ent);
 BOOLEAN      btm_inq_find_bdaddr (BD_ADDR p_bda);
 
 BOOLEAN btm_lookup_eir(BD_ADDR_PTR p_rem_addr);
@@ -1150,7 +1171,7 @@ void btm_ble_remove_from_white_list_complete(UINT8 *p, UINT16 evt_len);
 void btm_ble_clear_white_list_complete(UINT8 *p, UINT16 evt_len);
 BOOLEAN btm_ble_addr_resolvable(BD_ADDR rpa, tBTM_SEC_DEV_REC *p_dev_rec);
 tBTM_STATUS btm_ble_read_resolving_list_entry(tBTM_SEC_DEV_REC *p_dev_rec);
-BOOLEAN btm_ble_resolving_list_load_dev(tBTM_SEC_DEV_REC *p_dev_rec);
+BOOLEAN btm_ble_resolving_list_load_dev(tBTM_SEC_DEV_REC *p_dev_rec, BOOLEAN batch);
 void btm_ble_resolving_list_remove_dev(tBTM_SEC_DEV_REC *p_dev_rec);
 #endif  /* BLE_INCLUDED */
 
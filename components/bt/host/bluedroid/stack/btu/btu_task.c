@@ -368,6 +368,7 @@ static void btu_general_alarm_process(void *param)
     case BTU_TTYPE_BLE_GAP_FAST_ADV:
     case BTU_TTYPE_BLE_SCAN:
     case BTU_TTYPE_BLE_OBSERVE:
+    case BTU_TTYPE_BLE_RL_SYNC:
         btm_ble_timeout(p_tle);
         break;
 
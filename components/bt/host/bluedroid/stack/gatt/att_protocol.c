@@ -364,11 +364,15 @@ tGATT_STATUS attp_send_msg_to_l2cap(tGATT_TCB *p_tcb, BT_HDR *p_toL2CAP)
     if (l2cap_ret == L2CAP_DW_FAILED) {
         GATT_TRACE_DEBUG("ATT   failed to pass msg:0x%0x to L2CAP",
                          *((UINT8 *)(p_toL2CAP + 1) + p_toL2CAP->offset));
+        BT_STATS_INC(gatt_stats_tx_fail);
         return GATT_INTERNAL_ERROR;
     } else if (l2cap_ret == L2CAP_DW_CONGESTED) {
         GATT_TRACE_DEBUG("ATT congested, message accepted");
+        BT_STATS_INC(gatt_stats_tx_pdu);
+        BT_STATS_INC(gatt_stats_tx_congested);
         return GATT_CONGESTED;
     }
+    BT_STATS_INC(gatt_stats_tx_pdu);
     return GATT_SUCCESS;
 }
 
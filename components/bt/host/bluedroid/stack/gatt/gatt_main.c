@@ -81,6 +81,19 @@ tGATT_CB  gatt_cb;
 tGATT_CB  *gatt_cb_ptr;
 #endif
 
+#if (BT_STATS_INCLUDED == TRUE)
+static BT_STATS_COUNTER_DEFINE(gatt_stats_rx_pdu, "gatt.rx_pdu");
+static BT_STATS_COUNTER_DEFINE(gatt_stats_rx_invalid, "gatt.rx_invalid");
+BT_STATS_COUNTER_DEFINE(gatt_stats_tx_pdu, "gatt.tx_pdu");
+BT_STATS_COUNTER_DEFINE(gatt_stats_tx_congested, "gatt.tx_congested");
+BT_STATS_COUNTER_DEFINE(gatt_stats_tx_fail, "gatt.tx_fail");
+
+static bt_stats_hdr_t *const gatt_stats[] = {
+    &gatt_stats_rx_pdu.hdr, &gatt_stats_rx_invalid.hdr, &gatt_stats_tx_pdu.hdr,
+    &gatt_stats_tx_congested.hdr, &gatt_stats_tx_fail.hdr,
+};
+#endif
+
 tGATT_DEFAULT gatt_default;
 
 /*******************************************************************************
@@ -103,6 +116,10 @@ void gatt_init (void)
     memset (&gatt_cb, 0, sizeof(tGATT_CB));
     memset (&fixed_reg, 0, sizeof(tL2CAP_FIXED_CHNL_REG));
 
+#if (BT_STATS_INCLUDED == TRUE)
+    bt_stats_register_group(gatt_stats, sizeof(gatt_stats) / sizeof(gatt_stats[0]));
+#endif
+
     gatt_cb.auto_disc = TRUE;
     gatt_cb.p_clcb_list = list_new(osi_free_func);
     gatt_cb.p_tcb_list  = list_new(osi_free_func);
@@ -229,11 +246,12 @@ BOOLEAN gatt_connect (BD_ADDR rem_bda, tBLE_ADDR_TYPE bd_addr_type, tGATT_TCB *p
     }
 
     if (transport == BT_TRANSPORT_LE) {
-        p_tcb->att_lcid = L2CAP_ATT_CID;
+        gatt_set_tcb_lcid(p_tcb, L2CAP_ATT_CID);
         gatt_ret = L2CA_ConnectFixedChnl (L2CAP_ATT_CID, rem_bda, bd_addr_type, is_aux);
 #if (CLASSIC_BT_GATT_INCLUDED == TRUE)
     } else {
-        if ((p_tcb->att_lcid = L2CA_ConnectReq(BT_PSM_ATT, rem_bda)) != 0) {
+        gatt_set_tcb_lcid(p_tcb, L2CA_ConnectReq(BT_PSM_ATT, rem_bda));
+        if (p_tcb->att_lcid != 0) {
             gatt_ret = TRUE;
         }
 #endif  ///CLASSIC_BT_GATT_INCLUDED == TRUE
@@ -489,7 +507,7 @@ static void gatt_le_connect_cback (UINT16 chan, BD_ADDR bd_addr, BOOLEAN connect
 
         else {
             if ((p_tcb = gatt_allocate_tcb_by_bdaddr(bd_addr, BT_TRANSPORT_LE)) != NULL) {
-                p_tcb->att_lcid = L2CAP_ATT_CID;
+                gatt_set_tcb_lcid(p_tcb, L2CAP_ATT_CID);
 
                 gatt_set_ch_state(p_tcb, GATT_CH_OPEN);
 
@@ -624,7 +642,7 @@ static void gatt_l2cif_connect_ind_cback (BD_ADDR  bd_addr, UINT16 lcid, UINT16
             /* no tcb available, reject L2CAP connection */
             result = L2CAP_CONN_NO_RESOURCES;
         } else {
-            p_tcb->att_lcid = lcid;
+            gatt_set_tcb_lcid(p_tcb, lcid);
         }
 
     } else { /* existing connection , reject it */
@@ -980,6 +998,8 @@ void gatt_data_process (tGATT_TCB *p_tcb, BT_HDR *p_buf)
 #endif ///(GATTS_INCLUDED == TRUE) || (GATTC_INCLUDED == TRUE)
 
 
+    BT_STATS_INC(gatt_stats_rx_pdu);
+
     if (p_buf->len > 0) {
 #if (GATTS_INCLUDED == TRUE) || (GATTC_INCLUDED == TRUE)
         msg_len = p_buf->len - 1;
@@ -1007,6 +1027,7 @@ void gatt_data_process (tGATT_TCB *p_tcb, BT_HDR *p_buf)
                 }
             }
         } else {
+            BT_STATS_INC(gatt_stats_rx_invalid);
             if (op_code & GATT_COMMAND_FLAG) {
                 GATT_TRACE_ERROR ("ATT - Rcvd L2CAP data, unknown cmd: 0x%x\n", op_code);
             } else {
@@ -1016,6 +1037,7 @@ void gatt_data_process (tGATT_TCB *p_tcb, BT_HDR *p_buf)
         }
     } else {
         GATT_TRACE_ERROR ("invalid data length, ignore\n");
+        BT_STATS_INC(gatt_stats_rx_invalid);
     }
 
     osi_free (p_buf);
@@ -921,6 +921,46 @@ BOOLEAN gatt_check_connection_state_by_tcb(tGATT_TCB *p_tcb)
     return connected;
 }
 
+/*******************************************************************************
+**
+** Function         gatt_tcb_hash
+**
+** Description      Bucket of the TCB address index for the given peer. The low
+**                  address bytes differ the most between peers.
+**
+** Returns          bucket index
+**
+*******************************************************************************/
+static UINT8 gatt_tcb_hash(BD_ADDR bda, tBT_TRANSPORT transport)
+{
+    return (bda[3] ^ bda[4] ^ bda[5] ^ transport) & (GATT_TCB_HASH_SIZE - 1);
+}
+
+/*******************************************************************************
+**
+** Function         gatt_tcb_unlink
+**
+** Description      Remove a TCB from the connection registry.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void gatt_tcb_unlink(tGATT_TCB *p_tcb)
+{
+    UINT8 *p_idx = &gatt_cb.tcb_hash[gatt_tcb_hash(p_tcb->peer_bda, p_tcb->transport)];
+
+    while (*p_idx && *p_idx != p_tcb->tcb_idx + 1) {
+        p_idx = &gatt_cb.tcb_by_idx[*p_idx - 1]->hash_next;
+    }
+    if (*p_idx) {
+        *p_idx = p_tcb->hash_next;
+    }
+    p_tcb->hash_next = 0;
+
+    gatt_set_tcb_lcid(p_tcb, 0);
+    gatt_cb.tcb_by_idx[p_tcb->tcb_idx] = NULL;
+}
+
 /*******************************************************************************
 **
 ** Function         gatt_find_i_tcb_by_addr
@@ -932,16 +972,16 @@ BOOLEAN gatt_check_connection_state_by_tcb(tGATT_TCB *p_tcb)
 *******************************************************************************/
 UINT8 gatt_find_i_tcb_by_addr(BD_ADDR bda, tBT_TRANSPORT transport)
 {
-    UINT8 i = 0;
-    list_node_t *p_node = NULL;
+    UINT8 i = gatt_cb.tcb_hash[gatt_tcb_hash(bda, transport)];
     tGATT_TCB   *p_tcb  = NULL;
-    for(p_node = list_begin(gatt_cb.p_tcb_list); p_node; p_node = list_next(p_node)) {
-	p_tcb = list_node(p_node);
+
+    while (i) {
+        p_tcb = gatt_cb.tcb_by_idx[i - 1];
         if (!memcmp(p_tcb->peer_bda, bda, BD_ADDR_LEN) &&
                 p_tcb->transport == transport) {
-	    i = p_tcb->tcb_idx;
-            return i;
+            return p_tcb->tcb_idx;
         }
+        i = p_tcb->hash_next;
     }
     return GATT_INDEX_INVALID;
 }
@@ -958,14 +998,12 @@ UINT8 gatt_find_i_tcb_by_addr(BD_ADDR bda, tBT_TRANSPORT transport)
 tGATT_TCB *gatt_get_tcb_by_idx(UINT8 tcb_idx)
 {
     tGATT_TCB   *p_tcb  = NULL;
-    list_node_t *p_node = NULL;
-    for(p_node = list_begin(gatt_cb.p_tcb_list); p_node; p_node = list_next(p_node)) {
-	p_tcb = list_node(p_node);
-        if ( (tcb_idx < GATT_MAX_PHY_CHANNEL) && p_tcb->in_use && p_tcb->tcb_idx == tcb_idx ) {
-            break;
-        } else {
-	    p_tcb = NULL;
-	}
+
+    if (tcb_idx < GATT_MAX_PHY_CHANNEL) {
+        p_tcb = gatt_cb.tcb_by_idx[tcb_idx];
+        if (p_tcb && !p_tcb->in_use) {
+            p_tcb = NULL;
+        }
     }
 
     return p_tcb;
@@ -1050,6 +1088,10 @@ tGATT_TCB *gatt_tcb_alloc(UINT8 tcb_idx)
 void gatt_tcb_free( tGATT_TCB *p_tcb)
 {
     UINT8 tcb_idx = p_tcb->tcb_idx;
+
+    if (gatt_cb.tcb_by_idx[tcb_idx] == p_tcb) {
+        gatt_tcb_unlink(p_tcb);
+    }
     if (list_remove(gatt_cb.p_tcb_list, p_tcb)) {
         gatt_tcb_id &= ~(1 << tcb_idx);
     }
@@ -1068,6 +1110,7 @@ tGATT_TCB *gatt_allocate_tcb_by_bdaddr(BD_ADDR bda, tBT_TRANSPORT transport)
     UINT8 i = 0;
     BOOLEAN allocated = FALSE;
     tGATT_TCB    *p_tcb = NULL;
+    UINT8        *p_head;
 
     /* search for existing tcb with matching bda    */
     i = gatt_find_i_tcb_by_addr(bda, transport);
@@ -1077,7 +1120,7 @@ tGATT_TCB *gatt_allocate_tcb_by_bdaddr(BD_ADDR bda, tBT_TRANSPORT transport)
         allocated = TRUE;
     }
     if (i != GATT_INDEX_INVALID) {
-        p_tcb = gatt_tcb_alloc(i);
+        p_tcb = allocated ? gatt_tcb_alloc(i) : gatt_cb.tcb_by_idx[i];
 	if (!p_tcb) {
 	    return NULL;
 	}
@@ -1088,8 +1131,13 @@ tGATT_TCB *gatt_allocate_tcb_by_bdaddr(BD_ADDR bda, tBT_TRANSPORT transport)
             p_tcb->in_use = TRUE;
             p_tcb->tcb_idx = i;
             p_tcb->transport = transport;
+            memcpy(p_tcb->peer_bda, bda, BD_ADDR_LEN);
+
+            p_head = &gatt_cb.tcb_hash[gatt_tcb_hash(bda, transport)];
+            p_tcb->hash_next = *p_head;
+            *p_head = i + 1;
+            gatt_cb.tcb_by_idx[i] = p_tcb;
         }
-        memcpy(p_tcb->peer_bda, bda, BD_ADDR_LEN);
 #if GATTS_ROBUST_CACHING_ENABLED
         gatt_sr_init_cl_status(p_tcb);
 #endif /* GATTS_ROBUST_CACHING_ENABLED */
@@ -1725,17 +1773,13 @@ BOOLEAN gatt_is_clcb_allocated (UINT16 conn_id)
 
 tGATT_CLCB *gatt_clcb_find_by_conn_id(UINT16 conn_id)
 {
-    list_node_t *p_node     = NULL;
-    tGATT_CLCB  *p_clcb     = NULL;
-    tGATT_CLCB  *p_clcb_ret = NULL;
-    for(p_node = list_begin(gatt_cb.p_clcb_list); p_node; p_node = list_next(p_node)) {
-        p_clcb = list_node(p_node);
-	if (p_clcb->conn_id == conn_id) {
-	    p_clcb_ret = p_clcb;
-	    break;
-	}
+    UINT8       tcb_idx = GATT_GET_TCB_IDX(conn_id);
+    tGATT_IF    gatt_if = GATT_GET_GATT_IF(conn_id);
+
+    if (tcb_idx >= GATT_MAX_PHY_CHANNEL || gatt_if == 0 || gatt_if > GATT_MAX_APPS) {
+        return NULL;
     }
-    return p_clcb_ret;
+    return gatt_cb.clcb_by_conn[tcb_idx][gatt_if - 1];
 }
 
 /*******************************************************************************
@@ -1750,17 +1794,8 @@ tGATT_CLCB *gatt_clcb_find_by_conn_id(UINT16 conn_id)
 
 tGATT_CLCB *gatt_clcb_find_by_idx(UINT16 clcb_idx)
 {
-    list_node_t *p_node     = NULL;
-    tGATT_CLCB  *p_clcb     = NULL;
-    tGATT_CLCB  *p_clcb_ret = NULL;
-    for(p_node = list_begin(gatt_cb.p_clcb_list); p_node; p_node = list_next(p_node)) {
-        p_clcb = list_node(p_node);
-	if (p_clcb->clcb_idx == clcb_idx) {
-	    p_clcb_ret = p_clcb;
-	    break;
-	}
-    }
-    return p_clcb_ret;
+    /* clcb_idx is the conn_id the clcb was allocated for */
+    return gatt_clcb_find_by_conn_id(clcb_idx);
 }
 
 /*******************************************************************************
@@ -1791,6 +1826,10 @@ tGATT_CLCB *gatt_clcb_alloc (UINT16 conn_id)
            p_clcb->clcb_idx    = conn_id;
            p_clcb->p_reg       = p_reg;
            p_clcb->p_tcb       = p_tcb;
+           if (tcb_idx < GATT_MAX_PHY_CHANNEL && gatt_if && gatt_if <= GATT_MAX_APPS &&
+                   gatt_cb.clcb_by_conn[tcb_idx][gatt_if - 1] == NULL) {
+               gatt_cb.clcb_by_conn[tcb_idx][gatt_if - 1] = p_clcb;
+           }
 	}
     }
     return p_clcb;
@@ -1808,9 +1847,27 @@ tGATT_CLCB *gatt_clcb_alloc (UINT16 conn_id)
 void gatt_clcb_dealloc (tGATT_CLCB *p_clcb)
 {
     if (p_clcb && p_clcb->in_use) {
+        UINT16      conn_id = p_clcb->conn_id;
+        UINT8       tcb_idx = GATT_GET_TCB_IDX(conn_id);
+        tGATT_IF    gatt_if = GATT_GET_GATT_IF(conn_id);
+        list_node_t *p_node;
+
         btu_free_timer(&p_clcb->rsp_timer_ent);
         memset(p_clcb, 0, sizeof(tGATT_CLCB));
         list_remove(gatt_cb.p_clcb_list, p_clcb);
+
+        if (tcb_idx < GATT_MAX_PHY_CHANNEL && gatt_if && gatt_if <= GATT_MAX_APPS &&
+                gatt_cb.clcb_by_conn[tcb_idx][gatt_if - 1] == p_clcb) {
+            gatt_cb.clcb_by_conn[tcb_idx][gatt_if - 1] = NULL;
+            /* hand the slot to another clcb of the same connection, if any */
+            for (p_node = list_begin(gatt_cb.p_clcb_list); p_node; p_node = list_next(p_node)) {
+                tGATT_CLCB *p_other = list_node(p_node);
+                if (p_other->conn_id == conn_id) {
+                    gatt_cb.clcb_by_conn[tcb_idx][gatt_if - 1] = p_other;
+                    break;
+                }
+            }
+        }
 	p_clcb = NULL;
     }
 }
@@ -1830,16 +1887,44 @@ void gatt_clcb_dealloc (tGATT_CLCB *p_clcb)
 tGATT_TCB *gatt_find_tcb_by_cid (UINT16 lcid)
 {
     tGATT_TCB   *p_tcb  = NULL;
-    list_node_t *p_node = NULL;
-    for(p_node = list_begin(gatt_cb.p_tcb_list); p_node; p_node = list_next(p_node)) {
-	p_tcb = list_node(p_node);
-        if (p_tcb->in_use && p_tcb->att_lcid == lcid) {
-            break;
+    UINT8       i;
+
+    if (lcid >= L2CAP_BASE_APPL_CID && lcid < L2CAP_BASE_APPL_CID + MAX_L2CAP_CHANNELS &&
+            (i = gatt_cb.tcb_by_lcid[lcid - L2CAP_BASE_APPL_CID]) != 0) {
+        p_tcb = gatt_cb.tcb_by_idx[i - 1];
+        if (p_tcb && (!p_tcb->in_use || p_tcb->att_lcid != lcid)) {
+            p_tcb = NULL;
         }
     }
     return p_tcb;
 }
 
+/*******************************************************************************
+**
+** Function         gatt_set_tcb_lcid
+**
+** Description      Set the ATT channel of a TCB and index it by channel ID.
+**                  Only dynamic (BR/EDR) channels are indexed, every LE link
+**                  uses the fixed ATT channel.
+**
+** Returns          void
+**
+*******************************************************************************/
+void gatt_set_tcb_lcid(tGATT_TCB *p_tcb, UINT16 lcid)
+{
+    UINT16 old_lcid = p_tcb->att_lcid;
+
+    if (old_lcid >= L2CAP_BASE_APPL_CID && old_lcid < L2CAP_BASE_APPL_CID + MAX_L2CAP_CHANNELS &&
+            gatt_cb.tcb_by_lcid[old_lcid - L2CAP_BASE_APPL_CID] == p_tcb->tcb_idx + 1) {
+        gatt_cb.tcb_by_lcid[old_lcid - L2CAP_BASE_APPL_CID] = 0;
+    }
+
+    p_tcb->att_lcid = lcid;
+    if (lcid >= L2CAP_BASE_APPL_CID && lcid < L2CAP_BASE_APPL_CID + MAX_L2CAP_CHANNELS) {
+        gatt_cb.tcb_by_lcid[lcid - L2CAP_BASE_APPL_CID] = p_tcb->tcb_idx + 1;
+    }
+}
+
 /*******************************************************************************
 **
 ** Function         gatt_num_apps_hold_link
@@ -25,6 +25,7 @@
 #include "stack/btm_ble_api.h"
 #include "stack/btu.h"
 #include "osi/fixed_queue.h"
+#include "bt_stats/bt_stats.h"
 
 #include <string.h>
 
@@ -67,6 +68,13 @@ typedef UINT8 tGATT_SEC_ACTION;
 
 #define GATT_INDEX_INVALID      0xff
 
+/* number of buckets of the TCB address index, a power of two */
+#if (GATT_MAX_PHY_CHANNEL > 8)
+#define GATT_TCB_HASH_SIZE      16
+#else
+#define GATT_TCB_HASH_SIZE      8
+#endif
+
 #define GATT_PENDING_REQ_NONE   0
 
 
@@ -414,6 +422,7 @@ typedef struct {
 
     BOOLEAN         in_use;
     UINT8           tcb_idx;
+    UINT8           hash_next;          /* tcb_idx + 1 of the next TCB in the same address bucket */
     tGATT_PREPARE_WRITE_RECORD prepare_write_record;    /* prepare write packets record */
 } tGATT_TCB;
 
@@ -509,6 +518,11 @@ typedef struct {
 
 typedef struct {
     list_t              *p_tcb_list;
+    /* connection registry, kept in step with p_tcb_list and p_clcb_list */
+    tGATT_TCB           *tcb_by_idx[GATT_MAX_PHY_CHANNEL];
+    UINT8               tcb_hash[GATT_TCB_HASH_SIZE];       /* tcb_idx + 1 of the first TCB by (BD_ADDR, transport) */
+    UINT8               tcb_by_lcid[MAX_L2CAP_CHANNELS];    /* tcb_idx + 1 by dynamic ATT channel, BR/EDR only */
+    tGATT_CLCB          *clcb_by_conn[GATT_MAX_PHY_CHANNEL][GATT_MAX_APPS];
     fixed_queue_t       *sign_op_queue;
 
     tGATT_SR_REG        sr_reg[GATT_MAX_SR_PROFILES];
@@ -580,6 +594,13 @@ extern tGATT_CB *gatt_cb_ptr;
 #define gatt_cb (*gatt_cb_ptr)
 #endif
 
+#if (BT_STATS_INCLUDED == TRUE)
+/* GATT statistics, registered by gatt_init() */
+extern bt_stats_counter_t gatt_stats_tx_pdu;
+extern bt_stats_counter_t gatt_stats_tx_congested;
+extern bt_stats_counter_t gatt_stats_tx_fail;
+#endif
+
 #if GATT_CONFORMANCE_TESTING == TRUE
 extern void gatt_set_err_rsp(BOOLEAN enable, UINT8 req_op_code, UINT8 err_status);
 #endif
@@ -711,6 +732,7 @@ extern BOOLEAN gatt_find_specific_app_in_hold_link(tGATT_TCB *p_tcb, tGATT_IF p_
 extern UINT8 gatt_num_apps_hold_link(tGATT_TCB *p_tcb);
 extern UINT8 gatt_num_clcb_by_bd_addr(BD_ADDR bda);
 extern tGATT_TCB *gatt_find_tcb_by_cid(UINT16 lcid);
+extern void gatt_set_tcb_lcid(tGATT_TCB *p_tcb, UINT16 lcid);
 extern tGATT_TCB *gatt_allocate_tcb_by_bdaddr(BD_ADDR bda, tBT_TRANSPORT transport);
 extern tGATT_TCB *gatt_get_tcb_by_idx(UINT8 tcb_idx);
 extern tGATT_TCB *gatt_find_tcb_by_addr(BD_ADDR bda, tBT_TRANSPORT transport);
@@ -43,6 +43,9 @@ typedef struct {
     void *context;
     void *complete_future;
     hci_cmd_free_cb command_free_cb;
+#if (BT_STATS_INCLUDED == TRUE)
+    uint32_t sent_time; // used for command latency statistics
+#endif
     BT_HDR command;
 } hci_cmd_metadata_t;
 
@@ -30,6 +30,7 @@
 #include "stack/l2cdefs.h"
 #include "osi/list.h"
 #include "osi/fixed_queue.h"
+#include "bt_stats/bt_stats.h"
 
 #define L2CAP_MIN_MTU   48      /* Minimum acceptable MTU is 48 bytes */
 
@@ -579,6 +580,11 @@ extern tL2C_CB *l2c_cb_ptr;
 #define l2cb (*l2c_cb_ptr)
 #endif
 
+#if (BT_STATS_INCLUDED == TRUE)
+/* L2CAP statistics, registered by l2c_init() */
+extern bt_stats_counter_t l2c_stats_tx_pdu;
+#endif
+
 
 /* Functions provided by l2c_main.c
 ************************************
@@ -1233,6 +1233,7 @@ static BOOLEAN l2c_link_send_to_lower (tL2C_LCB *p_lcb, BT_HDR *p_buf)
     UINT16      xmit_window, acl_data_size;
     const controller_t *controller = controller_get_interface();
     L2CAP_TRACE_DEBUG("%s",__func__);
+    BT_STATS_INC(l2c_stats_tx_pdu);
     if ((p_buf->len <= controller->get_acl_packet_size_classic()
 #if (BLE_INCLUDED == TRUE)
             && (p_lcb->transport == BT_TRANSPORT_BR_EDR)) ||
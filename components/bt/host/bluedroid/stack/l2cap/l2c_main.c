@@ -52,6 +52,16 @@ tL2C_CB l2cb;
 tL2C_CB *l2c_cb_ptr;
 #endif
 
+#if (BT_STATS_INCLUDED == TRUE)
+static BT_STATS_COUNTER_DEFINE(l2c_stats_rx_pdu, "l2cap.rx_pdu");
+static BT_STATS_COUNTER_DEFINE(l2c_stats_rx_drop, "l2cap.rx_drop");
+BT_STATS_COUNTER_DEFINE(l2c_stats_tx_pdu, "l2cap.tx_pdu");
+
+static bt_stats_hdr_t *const l2c_stats[] = {
+    &l2c_stats_rx_pdu.hdr, &l2c_stats_rx_drop.hdr, &l2c_stats_tx_pdu.hdr,
+};
+#endif
+
 #if BT_CLASSIC_BQB_INCLUDED
 static BOOLEAN s_l2cap_bqb_bad_cmd_len_rej_flag = FALSE;
 #endif /* BT_CLASSIC_BQB_INCLUDED */
@@ -152,6 +162,8 @@ void l2c_rcv_acl_data (BT_HDR *p_msg)
 #endif
     UINT16      credit;
 
+    BT_STATS_INC(l2c_stats_rx_pdu);
+
     /* Extract the handle */
     STREAM_TO_UINT16 (handle, p);
     pkt_type = HCID_GET_EVENT (handle);
@@ -190,11 +202,13 @@ void l2c_rcv_acl_data (BT_HDR *p_msg)
                                    " opcode:%d cur count:%d", handle, p_msg->layer_specific, rcv_cid,
                                    cmd_code, list_length(l2cb.rcv_pending_q));
             }
+            BT_STATS_INC(l2c_stats_rx_drop);
             osi_free (p_msg);
             return;
         }
     } else {
         L2CAP_TRACE_WARNING ("L2CAP - expected pkt start or complete, got: %d", pkt_type);
+        BT_STATS_INC(l2c_stats_rx_drop);
         osi_free (p_msg);
         return;
     }
@@ -862,6 +876,10 @@ void l2c_init (void)
     /* the psm is increased by 2 before being used */
     l2cb.dyn_psm = 0xFFF;
 
+#if (BT_STATS_INCLUDED == TRUE)
+    bt_stats_register_group(l2c_stats, sizeof(l2c_stats) / sizeof(l2c_stats[0]));
+#endif
+
     l2cb.p_ccb_pool = list_new(osi_free_func);
     if (l2cb.p_ccb_pool == NULL) {
         L2CAP_TRACE_ERROR("%s unable to allocate memory for L2CAP channel control block", __func__);
@@ -23,6 +23,7 @@
 #include "soc/soc_caps.h"
 #include "bt_common.h"
 #include "hci_log/bt_hci_log.h"
+#include "bt_stats/bt_stats.h"
 
 #define NIMBLE_VHCI_TIMEOUT_MS  2000
 #define BLE_HCI_EVENT_HDR_LEN               (2)
@@ -46,12 +47,31 @@ static void *ble_hci_rx_acl_hs_arg;
 
 
 static SemaphoreHandle_t vhci_send_sem;
+/* Given whenever an ACL buffer is returned to the transport pool */
+static SemaphoreHandle_t vhci_acl_avail_sem;
 const static char *TAG = "NimBLE";
 
 int os_msys_buf_alloc(void);
 void os_msys_buf_free(void);
 extern uint8_t ble_hs_enabled_state;
 
+#if (BT_STATS_INCLUDED == TRUE)
+static BT_STATS_COUNTER_DEFINE(nimble_hci_stats_cmd_tx, "nimble_hci.cmd_tx");
+static BT_STATS_COUNTER_DEFINE(nimble_hci_stats_acl_tx, "nimble_hci.acl_tx");
+static BT_STATS_COUNTER_DEFINE(nimble_hci_stats_tx_timeout, "nimble_hci.tx_timeout");
+static BT_STATS_COUNTER_DEFINE(nimble_hci_stats_evt_rx, "nimble_hci.evt_rx");
+static BT_STATS_COUNTER_DEFINE(nimble_hci_stats_acl_rx, "nimble_hci.acl_rx");
+static BT_STATS_COUNTER_DEFINE(nimble_hci_stats_rx_drop, "nimble_hci.rx_drop");
+/* Time the controller is held up waiting for a free ACL buffer, 256 us to 16 ms */
+static BT_STATS_HIST_DEFINE(nimble_hci_stats_acl_rx_wait, "nimble_hci.acl_rx_wait_us", 8);
+
+static bt_stats_hdr_t *const nimble_hci_stats[] = {
+    &nimble_hci_stats_cmd_tx.hdr, &nimble_hci_stats_acl_tx.hdr, &nimble_hci_stats_tx_timeout.hdr,
+    &nimble_hci_stats_evt_rx.hdr, &nimble_hci_stats_acl_rx.hdr, &nimble_hci_stats_rx_drop.hdr,
+    &nimble_hci_stats_acl_rx_wait.hdr,
+};
+#endif // (BT_STATS_INCLUDED == TRUE)
+
 void ble_hci_trans_cfg_hs(ble_hci_trans_rx_cmd_fn *cmd_cb,
                           void *cmd_arg,
                           ble_hci_trans_rx_acl_fn *acl_cb,
@@ -85,8 +105,10 @@ int ble_hci_trans_hs_cmd_tx(uint8_t *cmd)
 
     if (xSemaphoreTake(vhci_send_sem, NIMBLE_VHCI_TIMEOUT_MS / portTICK_PERIOD_MS) == pdTRUE) {
         esp_vhci_host_send_packet_wrapper(cmd, len);
+        BT_STATS_INC(nimble_hci_stats_cmd_tx);
     } else {
         rc = BLE_HS_ETIMEOUT_HCI;
+        BT_STATS_INC(nimble_hci_stats_tx_timeout);
     }
 
     ble_transport_free(cmd);
@@ -103,27 +125,39 @@ int ble_hci_trans_ll_evt_tx(uint8_t *hci_ev)
 
 int ble_hci_trans_hs_acl_tx(struct os_mbuf *om)
 {
-    uint16_t len = 0;
-    uint8_t data[MYNEWT_VAL(BLE_TRANSPORT_ACL_SIZE) + 1], rc = 0;
+    uint16_t len;
+    uint8_t buf[MYNEWT_VAL(BLE_TRANSPORT_ACL_SIZE) + 1], rc = 0;
+    uint8_t *data;
+
     /* If this packet is zero length, just free it */
     if (OS_MBUF_PKTLEN(om) == 0) {
         os_mbuf_free_chain(om);
         return 0;
     }
-    data[0] = BLE_HCI_UART_H4_ACL;
-    len++;
 
     if (!esp_vhci_host_check_send_available()) {
         ESP_LOGD(TAG, "Controller not ready to receive packets");
     }
 
-    os_mbuf_copydata(om, 0, OS_MBUF_PKTLEN(om), &data[1]);
-    len += OS_MBUF_PKTLEN(om);
+    len = OS_MBUF_PKTLEN(om) + 1;
+
+    /* A single mbuf with room for the H4 indicator in front of the ACL
+     * header is sent in place; only chains are gathered into a flat buffer.
+     */
+    if (SLIST_NEXT(om, om_next) == NULL && OS_MBUF_LEADINGSPACE(om) > 0) {
+        data = om->om_data - 1;
+    } else {
+        data = buf;
+        os_mbuf_copydata(om, 0, OS_MBUF_PKTLEN(om), &data[1]);
+    }
+    data[0] = BLE_HCI_UART_H4_ACL;
 
     if (xSemaphoreTake(vhci_send_sem, NIMBLE_VHCI_TIMEOUT_MS / portTICK_PERIOD_MS) == pdTRUE) {
         esp_vhci_host_send_packet_wrapper(data, len);
+        BT_STATS_INC(nimble_hci_stats_acl_tx);
     } else {
         rc = BLE_HS_ETIMEOUT_HCI;
+        BT_STATS_INC(nimble_hci_stats_tx_timeout);
     }
 
     os_mbuf_free_chain(om);
@@ -150,28 +184,64 @@ int ble_hci_trans_reset(void)
 }
 
 
+/*
+ * @brief: Transport callback, used to wake up a receiver waiting for an ACL
+ *         buffer to be freed by the host
+ */
+static void ble_hci_acl_avail(void)
+{
+    BaseType_t woken = pdFALSE;
+
+    if (!vhci_acl_avail_sem) {
+        return;
+    }
+
+    if (xPortInIsrContext()) {
+        xSemaphoreGiveFromISR(vhci_acl_avail_sem, &woken);
+        if (woken == pdTRUE) {
+            portYIELD_FROM_ISR();
+        }
+    } else {
+        xSemaphoreGive(vhci_acl_avail_sem);
+    }
+}
+
 static void ble_hci_rx_acl(uint8_t *data, uint16_t len)
 {
     struct os_mbuf *m = NULL;
     int rc;
     int sr;
     if (len < BLE_HCI_DATA_HDR_SZ || len > MYNEWT_VAL(BLE_TRANSPORT_ACL_SIZE)) {
+        BT_STATS_INC(nimble_hci_stats_rx_drop);
         return;
     }
+    BT_STATS_INC(nimble_hci_stats_acl_rx);
 
-    do {
-        m = ble_transport_alloc_acl_from_ll();
-
-        if (!m) {
-            ESP_LOGD(TAG,"Failed to allocate buffer, retrying ");
-	    /* Give some time to free buffer and try again */
-	    vTaskDelay(1);
-	}
-    }while(!m);
+    m = ble_transport_alloc_acl_from_ll();
+    if (m == NULL) {
+#if (BT_STATS_INCLUDED == TRUE)
+        uint32_t wait_start = BT_STATS_TIMESTAMP();
+#endif
+        /* Block until the host returns a buffer to the pool instead of polling */
+        do {
+            if (xSemaphoreTake(vhci_acl_avail_sem, NIMBLE_VHCI_TIMEOUT_MS / portTICK_PERIOD_MS) != pdTRUE) {
+                ESP_LOGW(TAG, "No free ACL buffer, still waiting");
+            }
+        } while ((m = ble_transport_alloc_acl_from_ll()) == NULL);
+        BT_STATS_HIST_SINCE(nimble_hci_stats_acl_rx_wait, wait_start);
+    }
 
-    if ((rc = os_mbuf_append(m, data, len)) != 0) {
+    /* Pool buffers are sized for a full ACL packet; copy straight into the
+     * data area rather than going through os_mbuf_append().
+     */
+    if (OS_MBUF_TRAILINGSPACE(m) >= len) {
+        memcpy(m->om_data, data, len);
+        m->om_len = len;
+        OS_MBUF_PKTHDR(m)->omp_len = len;
+    } else if ((rc = os_mbuf_append(m, data, len)) != 0) {
         ESP_LOGE(TAG, "%s failed to os_mbuf_append; rc = %d", __func__, rc);
         os_mbuf_free_chain(m);
+        BT_STATS_INC(nimble_hci_stats_rx_drop);
         return;
     }
     OS_ENTER_CRITICAL(sr);
@@ -232,6 +302,8 @@ static int host_rcv_pkt(uint8_t *data, uint16_t len)
         int totlen;
         int rc;
 
+        BT_STATS_INC(nimble_hci_stats_evt_rx);
+
         totlen = BLE_HCI_EVENT_HDR_LEN + data[2];
         assert(totlen <= UINT8_MAX + BLE_HCI_EVENT_HDR_LEN);
 
@@ -252,6 +324,7 @@ static int host_rcv_pkt(uint8_t *data, uint16_t len)
             evbuf = ble_transport_alloc_evt(1);
             /* Skip advertising report if we're out of memory */
             if (!evbuf) {
+                BT_STATS_INC(nimble_hci_stats_rx_drop);
                 return 0;
             }
         } else {
@@ -298,6 +371,10 @@ esp_err_t esp_nimble_hci_init(void)
 
     ble_transport_init();
 
+#if (BT_STATS_INCLUDED == TRUE)
+    bt_stats_register_group(nimble_hci_stats, sizeof(nimble_hci_stats) / sizeof(nimble_hci_stats[0]));
+#endif
+
     vhci_send_sem = xSemaphoreCreateBinary();
     if (vhci_send_sem == NULL) {
         ret = ESP_ERR_NO_MEM;
@@ -306,12 +383,24 @@ esp_err_t esp_nimble_hci_init(void)
 
     xSemaphoreGive(vhci_send_sem);
 
+    vhci_acl_avail_sem = xSemaphoreCreateBinary();
+    if (vhci_acl_avail_sem == NULL) {
+        ret = ESP_ERR_NO_MEM;
+        goto err;
+    }
+
+    ble_transport_register_acl_avail_cb(ble_hci_acl_avail);
+
 #if MYNEWT_VAL(BLE_QUEUE_CONG_CHECK)
     ble_adv_list_init();
 #endif
 
     return ret;
 err:
+    if (vhci_send_sem) {
+        vSemaphoreDelete(vhci_send_sem);
+        vhci_send_sem = NULL;
+    }
     ble_buf_free();
     return ret;
 
@@ -327,6 +416,12 @@ esp_err_t esp_nimble_hci_deinit(void)
         vSemaphoreDelete(vhci_send_sem);
         vhci_send_sem = NULL;
     }
+
+    ble_transport_register_acl_avail_cb(NULL);
+    if (vhci_acl_avail_sem) {
+        vSemaphoreDelete(vhci_acl_avail_sem);
+        vhci_acl_avail_sem = NULL;
+    }
     ble_transport_deinit();
 
     esp_vhci_host_register_callback(&dummy_vhci_host_cb);
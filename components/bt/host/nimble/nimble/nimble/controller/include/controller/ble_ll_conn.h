@@ -248,6 +248,15 @@ struct ble_ll_conn_sm
     uint8_t data_chan_index;
     uint8_t last_unmapped_chan;
     uint8_t chan_map_used;
+#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LE_CSA2) && \
+    (MYNEWT_VAL(BLE_LL_CONN_CSA2_PRECALC_EVENTS) > 0)
+    /* Channels precalculated for events starting at csa2_precalc_cntr */
+    uint16_t csa2_precalc_cntr;
+    uint8_t csa2_precalc_num;
+    uint8_t csa2_precalc[MYNEWT_VAL(BLE_LL_CONN_CSA2_PRECALC_EVENTS)];
+    /* Refills precalculated channels outside of connection event */
+    struct ble_npl_event csa2_precalc_ev;
+#endif
 
     /* Ack/Flow Control */
     uint8_t tx_seqnum;          /* note: can be 1 bit */
@@ -26,35 +26,86 @@ extern "C" {
 
 #if MYNEWT_VAL(BLE_LL_ISO)
 
+/* Max number of new PDUs per event, Core 5.3, Vol 4, Part E, 7.8.104 */
+#define BLE_LL_ISOAL_MUX_MAX_BN     (7)
+
+struct ble_ll_isoal_mux_stats {
+    /* SDUs received from host */
+    uint32_t sdu_rx;
+    /* SDUs transmitted */
+    uint32_t sdu_tx;
+    /* SDUs dropped without being transmitted (e.g. BIG terminated) */
+    uint32_t sdu_flushed;
+    /* SDUs dropped because host sends data faster than we can transmit */
+    uint32_t sdu_overrun;
+    /* Latency from SDU timestamp to transmission, in usecs */
+    uint32_t latency_max;
+    uint32_t latency_cnt;
+    uint64_t latency_sum;
+};
+
+/* Position in SDU queue at which PDU starts */
+struct ble_ll_isoal_sdu_pos {
+    uint8_t sdu_idx;
+    uint16_t sdu_offset;
+};
+
 struct ble_ll_isoal_mux {
     /* Max PDU length */
     uint8_t max_pdu;
     /* Number of expected SDUs per ISO interval */
     uint8_t sdu_per_interval;
-    /* Number of expected PDUs per SDU */
+    /* Number of expected PDUs per SDU (unframed only) */
     uint8_t pdu_per_sdu;
     /* Number of SDUs required to fill complete BIG/CIG event (i.e. with pt) */
     uint8_t sdu_per_event;
     /* Number of SDUs available for current event */
     uint8_t sdu_in_event;
+    /* Number of new PDUs in each event */
+    uint8_t bn;
+    uint8_t framed : 1;
 
     STAILQ_HEAD(, os_mbuf_pkthdr) sdu_q;
+    uint16_t sdu_q_len;
 
     struct os_mbuf *frag;
+    uint32_t frag_timestamp;
+
+    /* Last accessed SDU and its segment, used to avoid walking from start */
+    struct {
+        struct os_mbuf_pkthdr *pkthdr;
+        struct os_mbuf *om;
+        uint16_t om_offset;
+        uint8_t sdu_idx;
+    } cur;
+
+    /* Framed PDUs layout for current event, calculated at event start */
+    uint16_t framed_sdu_offset;
+    struct ble_ll_isoal_sdu_pos framed_map[BLE_LL_ISOAL_MUX_MAX_BN];
+    struct ble_ll_isoal_sdu_pos framed_map_end;
+
+    /* Packets freed due to overrun, reported as completed on event done */
+    uint16_t pkt_dropped;
 
     uint32_t sdu_counter;
 
     uint32_t event_tx_timestamp;
     uint32_t last_tx_timestamp;
     uint16_t last_tx_packet_seq_num;
+
+    struct ble_ll_isoal_mux_stats stats;
 };
 
 void
 ble_ll_isoal_mux_init(struct ble_ll_isoal_mux *mux, uint8_t max_pdu,
                       uint32_t iso_interval_us, uint32_t sdu_interval_us,
-                      uint8_t bn, uint8_t pte);
+                      uint8_t bn, uint8_t pte, uint8_t framed);
 void ble_ll_isoal_mux_free(struct ble_ll_isoal_mux *mux);
 
+void ble_ll_isoal_mux_tx_pkt_in(struct ble_ll_isoal_mux *mux,
+                                struct os_mbuf *om, uint8_t pb,
+                                uint32_t timestamp);
+
 int ble_ll_isoal_mux_event_start(struct ble_ll_isoal_mux *mux,
                                  uint32_t timestamp);
 int ble_ll_isoal_mux_event_done(struct ble_ll_isoal_mux *mux);
@@ -62,6 +113,12 @@ int ble_ll_isoal_mux_event_done(struct ble_ll_isoal_mux *mux);
 int
 ble_ll_isoal_mux_unframed_get(struct ble_ll_isoal_mux *mux, uint8_t idx,
                               uint8_t *llid, void *dptr);
+int
+ble_ll_isoal_mux_framed_get(struct ble_ll_isoal_mux *mux, uint8_t idx,
+                            uint8_t *llid, void *dptr);
+
+void ble_ll_isoal_mux_stats_get(struct ble_ll_isoal_mux *mux,
+                                struct ble_ll_isoal_mux_stats *stats);
 
 /* HCI command handlers */
 int ble_ll_isoal_hci_setup_iso_data_path(const uint8_t *cmdbuf, uint8_t cmdlen,
@@ -71,6 +128,13 @@ int ble_ll_isoal_hci_remove_iso_data_path(const uint8_t *cmdbuf, uint8_t cmdlen,
 int ble_ll_isoal_hci_read_tx_sync(const uint8_t *cmdbuf, uint8_t cmdlen,
                                   uint8_t *rspbuf, uint8_t *rsplen);
 
+/*
+ * Strips HCI ISO Data packet headers. Returns 0 if packet length matches the
+ * headers. Timestamp is 0 if packet does not carry one.
+ */
+int ble_ll_isoal_tx_hdr_parse(struct os_mbuf *om, uint16_t *conn_handle,
+                              uint8_t *pb_flag, uint32_t *timestamp);
+
 void ble_ll_isoal_init(void);
 void ble_ll_isoal_reset(void);
 int ble_ll_isoal_data_in(struct os_mbuf *om);
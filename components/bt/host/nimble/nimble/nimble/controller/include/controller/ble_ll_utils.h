@@ -38,6 +38,10 @@ uint8_t ble_ll_utils_chan_map_used_get(const uint8_t *chan_map);
 
 uint8_t ble_ll_utils_dci_csa2(uint16_t counter, uint16_t chan_id,
                               uint8_t num_used_chans, const uint8_t *chan_map);
+/* Calculate channels for num consecutive events starting at counter */
+void ble_ll_utils_dci_csa2_batch(uint16_t counter, uint16_t chan_id,
+                                 uint8_t num_used_chans, const uint8_t *chan_map,
+                                 uint8_t *chans, uint8_t num);
 uint16_t ble_ll_utils_dci_iso_event(uint16_t counter, uint16_t chan_id,
                                     uint16_t *prn_sub_lu, uint8_t chan_map_used,
                                     const uint8_t *chan_map, uint16_t *remap_idx);
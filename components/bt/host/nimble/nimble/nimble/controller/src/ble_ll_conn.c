@@ -786,6 +786,37 @@ ble_ll_conn_calc_dci_csa1(struct ble_ll_conn_sm *conn)
     return ble_ll_utils_chan_map_remap(conn->chan_map, remap_index);
 }
 
+#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LE_CSA2) && \
+    (MYNEWT_VAL(BLE_LL_CONN_CSA2_PRECALC_EVENTS) > 0)
+/**
+ * Calculates data channels for connection events starting at the upcoming
+ * one.
+ * Runs from LL task so the cost is not added to scheduling of connection
+ * event.
+ *
+ * @param ev Pointer to event; argument is connection state machine
+ */
+static void
+ble_ll_conn_csa2_precalc(struct ble_npl_event *ev)
+{
+    struct ble_ll_conn_sm *connsm;
+
+    connsm = (struct ble_ll_conn_sm *)ble_npl_event_get_arg(ev);
+
+    if ((connsm->conn_state == BLE_LL_CONN_STATE_IDLE) ||
+        !connsm->flags.csa2) {
+        return;
+    }
+
+    ble_ll_utils_dci_csa2_batch(connsm->event_cntr, connsm->channel_id,
+                                connsm->chan_map_used, connsm->chan_map,
+                                connsm->csa2_precalc,
+                                MYNEWT_VAL(BLE_LL_CONN_CSA2_PRECALC_EVENTS));
+    connsm->csa2_precalc_cntr = connsm->event_cntr;
+    connsm->csa2_precalc_num = MYNEWT_VAL(BLE_LL_CONN_CSA2_PRECALC_EVENTS);
+}
+#endif
+
 /**
  * Determine data channel index to be used for the upcoming/current
  * connection event
@@ -799,9 +830,31 @@ uint8_t
 ble_ll_conn_calc_dci(struct ble_ll_conn_sm *conn, uint16_t latency)
 {
     uint8_t index;
+#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LE_CSA2) && \
+    (MYNEWT_VAL(BLE_LL_CONN_CSA2_PRECALC_EVENTS) > 0)
+    uint16_t delta;
+#endif
 
 #if MYNEWT_VAL(BLE_LL_CFG_FEAT_LE_CSA2)
     if (conn->flags.csa2) {
+#if MYNEWT_VAL(BLE_LL_CONN_CSA2_PRECALC_EVENTS) > 0
+        delta = conn->event_cntr - conn->csa2_precalc_cntr;
+        if (delta < conn->csa2_precalc_num) {
+            /* Refill before we run out of precalculated channels */
+            if (conn->csa2_precalc_num - delta <=
+                MYNEWT_VAL(BLE_LL_CONN_CSA2_PRECALC_EVENTS) / 2) {
+                ble_ll_event_add(&conn->csa2_precalc_ev);
+            }
+
+            return conn->csa2_precalc[delta];
+        }
+
+        /*
+         * Do not refill here as this is called when next connection event is
+         * scheduled; calculate single channel and refill from LL task.
+         */
+        ble_ll_event_add(&conn->csa2_precalc_ev);
+#endif
         return ble_ll_utils_dci_csa2(conn->event_cntr, conn->channel_id,
                                      conn->chan_map_used, conn->chan_map);
     }
@@ -1948,6 +2001,9 @@ ble_ll_conn_set_csa(struct ble_ll_conn_sm *connsm, bool chsel)
         connsm->flags.csa2 = 1;
         connsm->channel_id = ((connsm->access_addr & 0xffff0000) >> 16) ^
                               (connsm->access_addr & 0x0000ffff);
+#if MYNEWT_VAL(BLE_LL_CONN_CSA2_PRECALC_EVENTS) > 0
+        connsm->csa2_precalc_num = 0;
+#endif
 
         /* calculate the next data channel */
         connsm->data_chan_index = ble_ll_conn_calc_dci(connsm, 0);
@@ -2032,6 +2088,13 @@ ble_ll_conn_sm_new(struct ble_ll_conn_sm *connsm)
     /* Connection end event */
     ble_npl_event_init(&connsm->conn_ev_end, ble_ll_conn_event_end, connsm);
 
+#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LE_CSA2) && \
+    (MYNEWT_VAL(BLE_LL_CONN_CSA2_PRECALC_EVENTS) > 0)
+    ble_npl_event_init(&connsm->csa2_precalc_ev, ble_ll_conn_csa2_precalc,
+                       connsm);
+    connsm->csa2_precalc_num = 0;
+#endif
+
     /* Initialize transmit queue and ack/flow control elements */
     STAILQ_INIT(&connsm->conn_txq);
     connsm->cur_tx_pdu = NULL;
@@ -2231,6 +2294,10 @@ ble_ll_conn_end(struct ble_ll_conn_sm *connsm, uint8_t ble_err)
 
     /* Make sure events off queue */
     ble_ll_event_remove(&connsm->conn_ev_end);
+#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LE_CSA2) && \
+    (MYNEWT_VAL(BLE_LL_CONN_CSA2_PRECALC_EVENTS) > 0)
+    ble_ll_event_remove(&connsm->csa2_precalc_ev);
+#endif
 
     /* Connection state machine is now idle */
     connsm->conn_state = BLE_LL_CONN_STATE_IDLE;
@@ -2624,6 +2691,10 @@ ble_ll_conn_next_event(struct ble_ll_conn_sm *connsm)
         connsm->chan_map_used =
             ble_ll_utils_chan_map_used_get(connsm->req_chanmap);
         memcpy(connsm->chan_map, connsm->req_chanmap, BLE_LL_CHAN_MAP_LEN);
+#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LE_CSA2) && \
+    (MYNEWT_VAL(BLE_LL_CONN_CSA2_PRECALC_EVENTS) > 0)
+        connsm->csa2_precalc_num = 0;
+#endif
 
         connsm->flags.chanmap_update_sched = 0;
 
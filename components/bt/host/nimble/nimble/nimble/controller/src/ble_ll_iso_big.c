@@ -45,6 +45,8 @@
 
 #define BIG_HANDLE_INVALID      (0xff)
 
+#define BIG_NSE_MAX             (31)
+
 #define BIG_CONTROL_ACTIVE_CHAN_MAP     1
 #define BIG_CONTROL_ACTIVE_TERM         2
 
@@ -60,10 +62,10 @@ struct ble_ll_iso_bis {
     uint16_t chan_id;
     uint8_t iv[8];
 
-    struct {
-        uint16_t prn_sub_lu;
-        uint16_t remap_idx;
+    /* Channels for each subevent of current event */
+    uint8_t chans[BIG_NSE_MAX];
 
+    struct {
         uint8_t subevent_num;
         uint8_t n;
         uint8_t g;
@@ -122,6 +124,7 @@ struct ble_ll_iso_big {
     uint32_t sdu_interval;
 
     uint32_t ctrl_aa;
+    uint8_t ctrl_chan;
     uint16_t crc_init;
     uint8_t chan_map[BLE_LL_CHAN_MAP_LEN];
     uint8_t chan_map_used;
@@ -304,7 +307,7 @@ ble_ll_iso_big_biginfo_copy(struct ble_ll_iso_big *big, uint8_t *dptr,
     *dptr++ = (counter >> 8) & 0xff;
     *dptr++ = (counter >> 16) & 0xff;
     *dptr++ = (counter >> 24) & 0xff;
-    *dptr++ = (counter >> 32) & 0xff;
+    *dptr++ = ((counter >> 32) & 0x7f) | (big->framed << 7);
 
     if (big->encrypted) {
         memcpy(dptr, big->giv, 8);
@@ -382,6 +385,39 @@ ble_ll_iso_big_chan_map_update_complete(struct ble_ll_iso_big *big)
     big->chan_map_used = ble_ll_utils_chan_map_used_get(big->chan_map);
 }
 
+/* Calculate channels for all subevents of current event in advance so this is
+ * not done in PHY callbacks.
+ */
+static void
+ble_ll_iso_big_chans_calc(struct ble_ll_iso_big *big)
+{
+    struct ble_ll_iso_bis *bis;
+    uint16_t prn_sub_lu;
+    uint16_t remap_idx;
+    uint16_t chan_id;
+    uint8_t idx;
+
+    STAILQ_FOREACH(bis, &big->bis_q, bis_q_next) {
+        bis->chans[0] = ble_ll_utils_dci_iso_event(big->big_counter,
+                                                   bis->chan_id, &prn_sub_lu,
+                                                   big->chan_map_used,
+                                                   big->chan_map, &remap_idx);
+        for (idx = 1; idx < big->nse; idx++) {
+            bis->chans[idx] = ble_ll_utils_dci_iso_subevent(bis->chan_id,
+                                                            &prn_sub_lu,
+                                                            big->chan_map_used,
+                                                            big->chan_map,
+                                                            &remap_idx);
+        }
+    }
+
+    chan_id = big->ctrl_aa ^ (big->ctrl_aa >> 16);
+    big->ctrl_chan = ble_ll_utils_dci_iso_event(big->big_counter, chan_id,
+                                                &prn_sub_lu,
+                                                big->chan_map_used,
+                                                big->chan_map, &remap_idx);
+}
+
 static void
 ble_ll_iso_big_update_event_start(struct ble_ll_iso_big *big)
 {
@@ -484,8 +520,6 @@ ble_ll_iso_big_event_done(struct ble_ll_iso_big *big)
             }
         }
 
-        /* XXX precalculate some data here? */
-
         ble_ll_tmr_add(&big->sch.start_time, &big->sch.remainder,
                        big->iso_interval * 1250);
         big->sch.end_time = big->sch.start_time +
@@ -502,6 +536,8 @@ ble_ll_iso_big_event_done(struct ble_ll_iso_big *big)
         assert(rc == 0);
     } while (rc < 0);
 
+    ble_ll_iso_big_chans_calc(big);
+
     ble_ll_iso_big_update_event_start(big);
 }
 
@@ -578,21 +614,10 @@ ble_ll_iso_big_control_txend_cb(void *arg)
 static int
 ble_ll_iso_big_control_tx(struct ble_ll_iso_big *big)
 {
-    uint16_t chan_idx;
-    uint16_t chan_id;
-    uint16_t foo, bar;
     int rc;
 
-    chan_id = big->ctrl_aa ^ (big->ctrl_aa >> 16);
-
-    chan_idx = ble_ll_utils_dci_iso_event(big->big_counter, chan_id,
-                                          &foo,
-                                          big->chan_map_used,
-                                          big->chan_map,
-                                          &bar);
-
     ble_phy_set_txend_cb(ble_ll_iso_big_control_txend_cb, big);
-    ble_phy_setchan(chan_idx, big->ctrl_aa, big->crc_init << 8);
+    ble_phy_setchan(big->ctrl_chan, big->ctrl_aa, big->crc_init << 8);
 
     rc = ble_phy_tx(ble_ll_iso_big_control_pdu_cb, big, BLE_PHY_TRANSITION_NONE);
 
@@ -625,7 +650,11 @@ ble_ll_iso_big_subevent_pdu_cb(uint8_t *dptr, void *arg, uint8_t *hdr_byte)
     }
 
 #if 1
-    pdu_len = ble_ll_isoal_mux_unframed_get(&bis->mux, idx, &llid, dptr);
+    if (big->framed) {
+        pdu_len = ble_ll_isoal_mux_framed_get(&bis->mux, idx, &llid, dptr);
+    } else {
+        pdu_len = ble_ll_isoal_mux_unframed_get(&bis->mux, idx, &llid, dptr);
+    }
 #else
     llid = 0;
     pdu_len = big->max_pdu;
@@ -655,27 +684,13 @@ static int
 ble_ll_iso_big_subevent_tx(struct ble_ll_iso_big *big)
 {
     struct ble_ll_iso_bis *bis;
-    uint16_t chan_idx;
     int to_tx;
     int rc;
 
     bis = big->tx.bis;
 
-    if (bis->tx.subevent_num == 1) {
-        chan_idx = ble_ll_utils_dci_iso_event(big->big_counter, bis->chan_id,
-                                              &bis->tx.prn_sub_lu,
-                                              big->chan_map_used,
-                                              big->chan_map,
-                                              &bis->tx.remap_idx);
-    } else {
-        chan_idx = ble_ll_utils_dci_iso_subevent(bis->chan_id,
-                                                 &bis->tx.prn_sub_lu,
-                                                 big->chan_map_used,
-                                                 big->chan_map,
-                                                 &bis->tx.remap_idx);
-    }
-
-    ble_phy_setchan(chan_idx, bis->aa, bis->crc_init);
+    ble_phy_setchan(bis->chans[bis->tx.subevent_num - 1], bis->aa,
+                    bis->crc_init);
 
     to_tx = (big->tx.subevents_rem > 1) || big->cstf;
 
@@ -760,8 +775,6 @@ ble_ll_iso_big_event_sched_cb(struct ble_ll_sched_item *sch)
     ble_phy_mode_set(phy_mode, phy_mode);
 #endif
 
-    BLE_LL_ASSERT(!big->framed);
-
     /* XXX calculate this in advance at the end of previous event? */
     big->tx.subevents_rem = big->num_bis * big->nse;
     STAILQ_FOREACH(bis, &big->bis_q, bis_q_next) {
@@ -942,10 +955,8 @@ ble_ll_iso_big_create(uint8_t big_handle, uint8_t adv_handle, uint8_t num_bis,
         bis->num = big->num_bis;
         bis->crc_init = (big->crc_init << 8) | (big->num_bis);
 
-        BLE_LL_ASSERT(!big->framed);
-
         ble_ll_isoal_mux_init(&bis->mux, bp->max_pdu, bp->iso_interval * 1250,
-                              bp->sdu_interval, bp->bn, pte);
+                              bp->sdu_interval, bp->bn, pte, bp->framed);
     }
 
     big_pool_free--;
@@ -1040,6 +1051,8 @@ ble_ll_iso_big_create(uint8_t big_handle, uint8_t adv_handle, uint8_t num_bis,
                         ble_ll_tmr_u2t_up(big->sync_delay) + 1;
     big->sch.start_time -= g_ble_ll_sched_offset_ticks;
 
+    ble_ll_iso_big_chans_calc(big);
+
     rc = ble_ll_sched_iso_big(&big->sch, 1);
     if (rc < 0) {
         ble_ll_iso_big_free(big);
@@ -1203,7 +1216,12 @@ ble_ll_iso_big_hci_create(const uint8_t *cmdbuf, uint8_t len)
     bp.irc = 1;
     bp.pto = 0;
     bp.iso_interval = bp.sdu_interval / 1250;
-    bp.max_pdu = bp.max_sdu;
+    if (bp.framed) {
+        /* Leave room for segmentation header and time offset */
+        bp.max_pdu = MIN(bp.max_sdu + 5, 251);
+    } else {
+        bp.max_pdu = bp.max_sdu;
+    }
 
     rc = ble_ll_iso_big_create(cmd->big_handle, cmd->adv_handle, cmd->num_bis,
                                &bp);
@@ -22,6 +22,7 @@
 #include <nimble/hci_common.h>
 #include <controller/ble_ll.h>
 #include <controller/ble_ll_isoal.h>
+#include <controller/ble_ll_utils.h>
 #include <controller/ble_ll_iso_big.h>
 
 #if MYNEWT_VAL(BLE_LL_ISO)
@@ -31,48 +32,82 @@ STAILQ_HEAD(ble_ll_iso_tx_q, os_mbuf_pkthdr);
 static struct ble_npl_event ll_isoal_tx_pkt_in;
 static struct ble_ll_iso_tx_q ll_isoal_tx_q;
 
+/* Framed PDU segmentation header and Time_Offset field */
+#define BLE_LL_ISOAL_SEG_HDR_LEN        (2)
+#define BLE_LL_ISOAL_SEG_TIME_OFFSET_LEN (3)
+#define BLE_LL_ISOAL_SEG_HDR_SC         (0x01)
+#define BLE_LL_ISOAL_SEG_HDR_CMPLT      (0x02)
+
+/* LLID for BIS PDUs */
+#define BLE_LL_ISOAL_LLID_UNFRAMED_END  (0)
+#define BLE_LL_ISOAL_LLID_UNFRAMED_CONT (1)
+#define BLE_LL_ISOAL_LLID_FRAMED        (2)
+
 void
 ble_ll_isoal_mux_init(struct ble_ll_isoal_mux *mux, uint8_t max_pdu,
                       uint32_t iso_interval_us, uint32_t sdu_interval_us,
-                      uint8_t bn, uint8_t pte)
+                      uint8_t bn, uint8_t pte, uint8_t framed)
 {
     memset(mux, 0, sizeof(*mux));
 
     mux->max_pdu = max_pdu;
-    /* Core 5.3, Vol 6, Part G, 2.1 */
-    mux->sdu_per_interval = iso_interval_us / sdu_interval_us;
-    mux->pdu_per_sdu = bn / mux->sdu_per_interval;
+    mux->bn = bn;
+    mux->framed = framed;
+
+    if (framed) {
+        /*
+         * Framed PDUs carry as many SDUs as fit into BN PDUs, so number of
+         * SDUs per interval is only used to limit queue.
+         */
+        mux->sdu_per_interval = MAX(1, iso_interval_us / sdu_interval_us);
+        mux->pdu_per_sdu = 0;
+    } else {
+        /* Core 5.3, Vol 6, Part G, 2.1 */
+        mux->sdu_per_interval = iso_interval_us / sdu_interval_us;
+        mux->pdu_per_sdu = bn / mux->sdu_per_interval;
+    }
 
     mux->sdu_per_event = (1 + pte) * mux->sdu_per_interval;
 
     STAILQ_INIT(&mux->sdu_q);
 }
 
+static int
+ble_ll_isoal_mux_sdu_free(struct os_mbuf *om)
+{
+    struct os_mbuf *om_next;
+    int pkt_freed = 0;
+
+    /* Each HCI ISO fragment is a separate packet for flow control */
+    while (om) {
+        om_next = SLIST_NEXT(om, om_next);
+        os_mbuf_free(om);
+        pkt_freed++;
+        om = om_next;
+    }
+
+    return pkt_freed;
+}
+
 void
 ble_ll_isoal_mux_free(struct ble_ll_isoal_mux *mux)
 {
     struct os_mbuf_pkthdr *pkthdr;
-    struct os_mbuf *om;
-    struct os_mbuf *om_next;
 
     pkthdr = STAILQ_FIRST(&mux->sdu_q);
     while (pkthdr) {
-        om = OS_MBUF_PKTHDR_TO_MBUF(pkthdr);
-
-        while (om) {
-            om_next = SLIST_NEXT(om, om_next);
-            os_mbuf_free(om);
-            om = om_next;
-        }
+        ble_ll_isoal_mux_sdu_free(OS_MBUF_PKTHDR_TO_MBUF(pkthdr));
+        mux->stats.sdu_flushed++;
 
         STAILQ_REMOVE_HEAD(&mux->sdu_q, omp_next);
         pkthdr = STAILQ_FIRST(&mux->sdu_q);
     }
 
     STAILQ_INIT(&mux->sdu_q);
+    mux->sdu_q_len = 0;
 }
 
-static void
+void
 ble_ll_isoal_mux_tx_pkt_in(struct ble_ll_isoal_mux *mux, struct os_mbuf *om,
                            uint8_t pb, uint32_t timestamp)
 {
@@ -86,6 +121,7 @@ ble_ll_isoal_mux_tx_pkt_in(struct ble_ll_isoal_mux *mux, struct os_mbuf *om,
     case BLE_HCI_ISO_PB_FIRST:
         BLE_LL_ASSERT(!mux->frag);
         mux->frag = om;
+        mux->frag_timestamp = timestamp;
         om = NULL;
         break;
     case BLE_HCI_ISO_PB_CONTINUATION:
@@ -100,6 +136,7 @@ ble_ll_isoal_mux_tx_pkt_in(struct ble_ll_isoal_mux *mux, struct os_mbuf *om,
         BLE_LL_ASSERT(mux->frag);
         os_mbuf_concat(mux->frag, om);
         om = mux->frag;
+        timestamp = mux->frag_timestamp;
         mux->frag = NULL;
         break;
     default:
@@ -113,19 +150,97 @@ ble_ll_isoal_mux_tx_pkt_in(struct ble_ll_isoal_mux *mux, struct os_mbuf *om,
 
     blehdr = BLE_MBUF_HDR_PTR(om);
     blehdr->txiso.packet_seq_num = ++mux->sdu_counter;
+    blehdr->txiso.timestamp = timestamp;
+
+    mux->stats.sdu_rx++;
 
     OS_ENTER_CRITICAL(sr);
     pkthdr = OS_MBUF_PKTHDR(om);
     STAILQ_INSERT_TAIL(&mux->sdu_q, pkthdr, omp_next);
+    mux->sdu_q_len++;
+
+    /*
+     * Host sends SDUs faster than we can transmit them, drop oldest one so
+     * latency does not grow indefinitely.
+     */
+    if (mux->sdu_q_len > MYNEWT_VAL(BLE_LL_ISOAL_MUX_MAX_QUEUED_SDU) &&
+        mux->sdu_q_len > mux->sdu_per_event && !mux->sdu_in_event) {
+        pkthdr = STAILQ_FIRST(&mux->sdu_q);
+        STAILQ_REMOVE_HEAD(&mux->sdu_q, omp_next);
+        mux->sdu_q_len--;
+        mux->framed_sdu_offset = 0;
+        mux->pkt_dropped +=
+            ble_ll_isoal_mux_sdu_free(OS_MBUF_PKTHDR_TO_MBUF(pkthdr));
+        mux->stats.sdu_overrun++;
+    }
     OS_EXIT_CRITICAL(sr);
 }
 
+/* Calculate layout of framed PDUs for current event */
+static void
+ble_ll_isoal_mux_framed_map(struct ble_ll_isoal_mux *mux)
+{
+    struct os_mbuf_pkthdr *pkthdr;
+    uint16_t sdu_offset;
+    uint16_t sdu_len;
+    uint8_t sdu_idx;
+    uint8_t rem;
+    uint8_t hdr_len;
+    uint8_t seg_len;
+    uint8_t pdu_idx;
+
+    pkthdr = STAILQ_FIRST(&mux->sdu_q);
+    sdu_idx = 0;
+    sdu_offset = mux->framed_sdu_offset;
+
+    for (pdu_idx = 0; pdu_idx < mux->bn; pdu_idx++) {
+        mux->framed_map[pdu_idx].sdu_idx = sdu_idx;
+        mux->framed_map[pdu_idx].sdu_offset = sdu_offset;
+
+        rem = mux->max_pdu;
+        while (pkthdr) {
+            hdr_len = BLE_LL_ISOAL_SEG_HDR_LEN +
+                      (sdu_offset ? 0 : BLE_LL_ISOAL_SEG_TIME_OFFSET_LEN);
+            if (rem <= hdr_len) {
+                break;
+            }
+            rem -= hdr_len;
+
+            sdu_len = pkthdr->omp_len - sdu_offset;
+            seg_len = MIN(rem, sdu_len);
+            rem -= seg_len;
+
+            if (seg_len == sdu_len) {
+                pkthdr = STAILQ_NEXT(pkthdr, omp_next);
+                sdu_idx++;
+                sdu_offset = 0;
+            } else {
+                sdu_offset += seg_len;
+            }
+        }
+    }
+
+    /* Position after last PDU is where next event will continue */
+    mux->framed_map_end.sdu_idx = sdu_idx;
+    mux->framed_map_end.sdu_offset = sdu_offset;
+
+    mux->sdu_in_event = sdu_idx + !!sdu_offset;
+}
+
 int
 ble_ll_isoal_mux_event_start(struct ble_ll_isoal_mux *mux, uint32_t timestamp)
 {
     struct os_mbuf_pkthdr *pkthdr;
     uint8_t num_sdu;
 
+    mux->event_tx_timestamp = timestamp;
+    mux->cur.pkthdr = NULL;
+
+    if (mux->framed) {
+        ble_ll_isoal_mux_framed_map(mux);
+        return mux->sdu_in_event;
+    }
+
     num_sdu = mux->sdu_per_event;
 
     pkthdr = STAILQ_FIRST(&mux->sdu_q);
@@ -134,22 +249,45 @@ ble_ll_isoal_mux_event_start(struct ble_ll_isoal_mux *mux, uint32_t timestamp)
     }
 
     mux->sdu_in_event = mux->sdu_per_event - num_sdu;
-    mux->event_tx_timestamp = timestamp;
 
     return mux->sdu_in_event;
 }
 
+static void
+ble_ll_isoal_mux_latency_update(struct ble_ll_isoal_mux *mux,
+                                struct ble_mbuf_hdr *blehdr)
+{
+    uint32_t latency;
+
+    if (!blehdr->txiso.timestamp) {
+        return;
+    }
+
+    latency = mux->event_tx_timestamp - blehdr->txiso.timestamp;
+    if ((int32_t)latency < 0) {
+        return;
+    }
+
+    mux->stats.latency_sum += latency;
+    mux->stats.latency_cnt++;
+    mux->stats.latency_max = MAX(mux->stats.latency_max, latency);
+}
+
 int
 ble_ll_isoal_mux_event_done(struct ble_ll_isoal_mux *mux)
 {
     struct os_mbuf_pkthdr *pkthdr;
     struct ble_mbuf_hdr *blehdr;
     struct os_mbuf *om;
-    struct os_mbuf *om_next;
     uint8_t num_sdu;
-    int pkt_freed = 0;
+    int pkt_freed;
+    os_sr_t sr;
 
-    num_sdu = min(mux->sdu_in_event, mux->sdu_per_interval);
+    if (mux->framed) {
+        num_sdu = mux->framed_map_end.sdu_idx;
+    } else {
+        num_sdu = min(mux->sdu_in_event, mux->sdu_per_interval);
+    }
 
     pkthdr = STAILQ_FIRST(&mux->sdu_q);
     if (pkthdr) {
@@ -159,31 +297,112 @@ ble_ll_isoal_mux_event_done(struct ble_ll_isoal_mux *mux)
         mux->last_tx_packet_seq_num = blehdr->txiso.packet_seq_num;
     }
 
+    OS_ENTER_CRITICAL(sr);
+    pkt_freed = mux->pkt_dropped;
+    mux->pkt_dropped = 0;
+
     while (pkthdr && num_sdu--) {
         om = OS_MBUF_PKTHDR_TO_MBUF(pkthdr);
 
-        while (om) {
-            om_next = SLIST_NEXT(om, om_next);
-            os_mbuf_free(om);
-            pkt_freed++;
-            om = om_next;
-        }
+        ble_ll_isoal_mux_latency_update(mux, BLE_MBUF_HDR_PTR(om));
+        mux->stats.sdu_tx++;
 
         STAILQ_REMOVE_HEAD(&mux->sdu_q, omp_next);
+        mux->sdu_q_len--;
         pkthdr = STAILQ_FIRST(&mux->sdu_q);
+
+        pkt_freed += ble_ll_isoal_mux_sdu_free(om);
+    }
+
+    if (mux->framed) {
+        mux->framed_sdu_offset = mux->framed_map_end.sdu_offset;
     }
 
     mux->sdu_in_event = 0;
+    mux->cur.pkthdr = NULL;
+    OS_EXIT_CRITICAL(sr);
 
     return pkt_freed;
 }
 
+/* Get n-th SDU in event, continues from last accessed SDU if possible */
+static struct os_mbuf_pkthdr *
+ble_ll_isoal_mux_sdu_get(struct ble_ll_isoal_mux *mux, uint8_t sdu_idx)
+{
+    struct os_mbuf_pkthdr *pkthdr;
+    uint8_t idx;
+
+    if (mux->cur.pkthdr && (mux->cur.sdu_idx <= sdu_idx)) {
+        pkthdr = mux->cur.pkthdr;
+        idx = mux->cur.sdu_idx;
+    } else {
+        pkthdr = STAILQ_FIRST(&mux->sdu_q);
+        idx = 0;
+    }
+
+    while (pkthdr && (idx < sdu_idx)) {
+        pkthdr = STAILQ_NEXT(pkthdr, omp_next);
+        idx++;
+    }
+
+    if (pkthdr && (mux->cur.pkthdr != pkthdr)) {
+        mux->cur.pkthdr = pkthdr;
+        mux->cur.sdu_idx = idx;
+        mux->cur.om = OS_MBUF_PKTHDR_TO_MBUF(pkthdr);
+        mux->cur.om_offset = 0;
+    }
+
+    return pkthdr;
+}
+
+/*
+ * Copy SDU data directly from mbuf segments. Segment which contains offset is
+ * looked up starting from last used one so consecutive PDUs of the same SDU
+ * do not walk the chain from beginning.
+ */
+static void
+ble_ll_isoal_mux_sdu_copy(struct ble_ll_isoal_mux *mux, uint16_t offset,
+                          uint16_t len, uint8_t *dptr)
+{
+    struct os_mbuf *om;
+    uint16_t om_offset;
+    uint16_t chunk;
+
+    if (offset >= mux->cur.om_offset) {
+        om = mux->cur.om;
+        om_offset = mux->cur.om_offset;
+    } else {
+        om = OS_MBUF_PKTHDR_TO_MBUF(mux->cur.pkthdr);
+        om_offset = 0;
+    }
+
+    while (om && (offset >= om_offset + om->om_len)) {
+        om_offset += om->om_len;
+        om = SLIST_NEXT(om, om_next);
+    }
+
+    mux->cur.om = om;
+    mux->cur.om_offset = om_offset;
+
+    while (om && len) {
+        chunk = MIN(len, om->om_len - (offset - om_offset));
+        memcpy(dptr, om->om_data + (offset - om_offset), chunk);
+        dptr += chunk;
+        offset += chunk;
+        len -= chunk;
+
+        om_offset += om->om_len;
+        om = SLIST_NEXT(om, om_next);
+    }
+
+    BLE_LL_ASSERT(len == 0);
+}
+
 int
 ble_ll_isoal_mux_unframed_get(struct ble_ll_isoal_mux *mux, uint8_t idx,
                               uint8_t *llid, void *dptr)
 {
     struct os_mbuf_pkthdr *pkthdr;
-    struct os_mbuf *om;
     uint8_t sdu_idx;
     uint8_t pdu_idx;
     uint16_t sdu_offset;
@@ -194,52 +413,171 @@ ble_ll_isoal_mux_unframed_get(struct ble_ll_isoal_mux *mux, uint8_t idx,
     pdu_idx = idx - sdu_idx * mux->pdu_per_sdu;
 
     if (sdu_idx >= mux->sdu_in_event) {
-        *llid = 1;
+        *llid = BLE_LL_ISOAL_LLID_UNFRAMED_CONT;
         return 0;
     }
 
-    pkthdr = STAILQ_FIRST(&mux->sdu_q);
-    while (pkthdr && sdu_idx--) {
-        pkthdr = STAILQ_NEXT(pkthdr, omp_next);
-    }
-
+    pkthdr = ble_ll_isoal_mux_sdu_get(mux, sdu_idx);
     if (!pkthdr) {
-        *llid = 1;
+        *llid = BLE_LL_ISOAL_LLID_UNFRAMED_CONT;
         return 0;
     }
 
-    om = OS_MBUF_PKTHDR_TO_MBUF(pkthdr);
     sdu_offset = pdu_idx * mux->max_pdu;
-    rem_len = OS_MBUF_PKTLEN(om) - sdu_offset;
+    rem_len = pkthdr->omp_len - sdu_offset;
 
-    if ((int32_t)rem_len <= 0) {
-        *llid = 1;
+    if ((int16_t)rem_len <= 0) {
+        *llid = BLE_LL_ISOAL_LLID_UNFRAMED_CONT;
         pdu_len = 0;
     } else {
         *llid = (pdu_idx < mux->pdu_per_sdu - 1);
         pdu_len = min(mux->max_pdu, rem_len);
+        ble_ll_isoal_mux_sdu_copy(mux, sdu_offset, pdu_len, dptr);
     }
 
-    os_mbuf_copydata(om, sdu_offset, pdu_len, dptr);
-
     return pdu_len;
 }
 
-static void
-ble_ll_isoal_tx_pkt_in(struct ble_npl_event *ev)
+int
+ble_ll_isoal_mux_framed_get(struct ble_ll_isoal_mux *mux, uint8_t idx,
+                            uint8_t *llid, void *dptr)
 {
-    struct os_mbuf *om;
+    const struct ble_ll_isoal_sdu_pos *end;
     struct os_mbuf_pkthdr *pkthdr;
+    struct ble_mbuf_hdr *blehdr;
+    uint8_t *buf = dptr;
+    uint32_t time_offset;
+    uint16_t sdu_offset;
+    uint16_t sdu_len;
+    uint8_t sdu_idx;
+    uint8_t hdr_len;
+    uint8_t seg_len;
+    uint8_t rem;
+
+    *llid = BLE_LL_ISOAL_LLID_FRAMED;
+
+    /* Pre-transmissions are not supported for framed PDUs */
+    if (idx >= mux->bn) {
+        return 0;
+    }
+
+    sdu_idx = mux->framed_map[idx].sdu_idx;
+    sdu_offset = mux->framed_map[idx].sdu_offset;
+
+    /* SDUs queued after event started are not included in this event */
+    if (idx + 1 < mux->bn) {
+        end = &mux->framed_map[idx + 1];
+    } else {
+        end = &mux->framed_map_end;
+    }
+
+    pkthdr = ble_ll_isoal_mux_sdu_get(mux, sdu_idx);
+    rem = mux->max_pdu;
+
+    while (pkthdr && ((sdu_idx < end->sdu_idx) ||
+                      ((sdu_idx == end->sdu_idx) &&
+                       (sdu_offset < end->sdu_offset)))) {
+        hdr_len = BLE_LL_ISOAL_SEG_HDR_LEN +
+                  (sdu_offset ? 0 : BLE_LL_ISOAL_SEG_TIME_OFFSET_LEN);
+        if (rem <= hdr_len) {
+            break;
+        }
+        rem -= hdr_len;
+
+        sdu_len = pkthdr->omp_len - sdu_offset;
+        seg_len = MIN(rem, sdu_len);
+        rem -= seg_len;
+
+        /* Core 5.3, Vol 6, Part G, 6.1 */
+        buf[0] = (sdu_offset ? BLE_LL_ISOAL_SEG_HDR_SC : 0) |
+                 (seg_len == sdu_len ? BLE_LL_ISOAL_SEG_HDR_CMPLT : 0);
+        buf[1] = hdr_len - BLE_LL_ISOAL_SEG_HDR_LEN + seg_len;
+        buf += BLE_LL_ISOAL_SEG_HDR_LEN;
+
+        if (!sdu_offset) {
+            blehdr = BLE_MBUF_HDR_PTR(OS_MBUF_PKTHDR_TO_MBUF(pkthdr));
+            time_offset = mux->event_tx_timestamp - blehdr->txiso.timestamp;
+            if (!blehdr->txiso.timestamp || ((int32_t)time_offset < 0)) {
+                time_offset = 0;
+            }
+            put_le24(buf, MIN(time_offset, 0xffffff));
+            buf += BLE_LL_ISOAL_SEG_TIME_OFFSET_LEN;
+        }
+
+        ble_ll_isoal_mux_sdu_copy(mux, sdu_offset, seg_len, buf);
+        buf += seg_len;
+
+        if (seg_len == sdu_len) {
+            pkthdr = ble_ll_isoal_mux_sdu_get(mux, ++sdu_idx);
+            sdu_offset = 0;
+        } else {
+            sdu_offset += seg_len;
+        }
+    }
+
+    return buf - (uint8_t *)dptr;
+}
+
+void
+ble_ll_isoal_mux_stats_get(struct ble_ll_isoal_mux *mux,
+                           struct ble_ll_isoal_mux_stats *stats)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    *stats = mux->stats;
+    OS_EXIT_CRITICAL(sr);
+}
+
+int
+ble_ll_isoal_tx_hdr_parse(struct os_mbuf *om, uint16_t *conn_handle,
+                          uint8_t *pb_flag, uint32_t *timestamp)
+{
     struct ble_hci_iso *hci_iso;
-    struct ble_hci_iso_data *hci_iso_data;
-    struct ble_ll_isoal_mux *mux;
     uint16_t data_hdr_len;
     uint16_t handle;
-    uint16_t conn_handle;
     uint16_t length;
-    uint16_t pb_flag;
     uint16_t ts_flag;
-    uint32_t timestamp = 0;
+
+    hci_iso = (void *)om->om_data;
+
+    handle = le16toh(hci_iso->handle);
+    *conn_handle = BLE_HCI_ISO_CONN_HANDLE(handle);
+    *pb_flag = BLE_HCI_ISO_PB_FLAG(handle);
+    ts_flag = BLE_HCI_ISO_TS_FLAG(handle);
+    length = BLE_HCI_ISO_LENGTH(le16toh(hci_iso->length));
+
+    /* Time_Stamp is optional and only applies to the SDU it is sent with */
+    *timestamp = 0;
+
+    data_hdr_len = 0;
+    if ((*pb_flag == BLE_HCI_ISO_PB_FIRST) ||
+        (*pb_flag == BLE_HCI_ISO_PB_COMPLETE)) {
+        if (ts_flag) {
+            *timestamp = get_le32(om->om_data + sizeof(*hci_iso));
+            data_hdr_len += sizeof(uint32_t);
+        }
+
+        data_hdr_len += sizeof(struct ble_hci_iso_data);
+    }
+    os_mbuf_adj(om, sizeof(*hci_iso) + data_hdr_len);
+
+    if (OS_MBUF_PKTLEN(om) != length - data_hdr_len) {
+        return -1;
+    }
+
+    return 0;
+}
+
+static void
+ble_ll_isoal_tx_pkt_in(struct ble_npl_event *ev)
+{
+    struct os_mbuf *om;
+    struct os_mbuf_pkthdr *pkthdr;
+    struct ble_ll_isoal_mux *mux;
+    uint16_t conn_handle;
+    uint32_t timestamp;
+    uint8_t pb_flag;
     os_sr_t sr;
 
     while (STAILQ_FIRST(&ll_isoal_tx_q)) {
@@ -250,28 +588,8 @@ ble_ll_isoal_tx_pkt_in(struct ble_npl_event *ev)
         STAILQ_REMOVE_HEAD(&ll_isoal_tx_q, omp_next);
         OS_EXIT_CRITICAL(sr);
 
-        hci_iso = (void *)om->om_data;
-
-        handle = le16toh(hci_iso->handle);
-        conn_handle = BLE_HCI_ISO_CONN_HANDLE(handle);
-        pb_flag = BLE_HCI_ISO_PB_FLAG(handle);
-        ts_flag = BLE_HCI_ISO_TS_FLAG(handle);
-        length = BLE_HCI_ISO_LENGTH(le16toh(hci_iso->length));
-
-        data_hdr_len = 0;
-        if ((pb_flag == BLE_HCI_ISO_PB_FIRST) ||
-            (pb_flag == BLE_HCI_ISO_PB_COMPLETE)) {
-            if (ts_flag) {
-                timestamp = get_le32(om->om_data + sizeof(*hci_iso));
-                data_hdr_len += sizeof(uint32_t);
-            }
-
-            hci_iso_data = (void *)(om->om_data + sizeof(*hci_iso) + data_hdr_len);
-            data_hdr_len += sizeof(*hci_iso_data);
-        }
-        os_mbuf_adj(om, sizeof(*hci_iso) + data_hdr_len);
-
-        if (OS_MBUF_PKTLEN(om) != length - data_hdr_len) {
+        if (ble_ll_isoal_tx_hdr_parse(om, &conn_handle, &pb_flag,
+                                      &timestamp)) {
             os_mbuf_free_chain(om);
             continue;
         }
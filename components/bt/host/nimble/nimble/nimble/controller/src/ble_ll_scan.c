@@ -118,17 +118,126 @@ struct ble_ll_scan_dup_entry {
     uint8_t addr[6];
     uint8_t flags;      /* use BLE_LL_SCAN_DUP_F_xxx */
 #if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_EXT_ADV)
-    uint16_t adi;
+    uint16_t adi;       /* last seen ADI, SID is also part of type */
 #endif
+    uint16_t slot;      /* index in hash table */
     TAILQ_ENTRY(ble_ll_scan_dup_entry) link;
 };
 
-static os_membuf_t g_scan_dup_mem[ OS_MEMPOOL_SIZE(
-                                   MYNEWT_VAL(BLE_LL_NUM_SCAN_DUP_ADVS),
-                                   sizeof(struct ble_ll_scan_dup_entry)) ];
-static struct os_mempool g_scan_dup_pool;
+/*
+ * Duplicates are looked up via open-addressing (linear probing) hash table
+ * which stores indices of entries (+1, so 0 means empty slot). Entries are
+ * also kept on LRU list so the least recently seen advertiser can be evicted
+ * once all entries are in use. Table is at least twice as big as number of
+ * entries to keep probe sequences short.
+ */
+#define BLE_LL_SCAN_DUP_NUM             MYNEWT_VAL(BLE_LL_NUM_SCAN_DUP_ADVS)
+#if BLE_LL_SCAN_DUP_NUM > 0x7fff
+    #error "Too many duplicate advertisers entries!"
+#endif
+
+#if BLE_LL_SCAN_DUP_NUM <= 8
+#define BLE_LL_SCAN_DUP_HASH_BITS       (4)
+#elif BLE_LL_SCAN_DUP_NUM <= 32
+#define BLE_LL_SCAN_DUP_HASH_BITS       (6)
+#elif BLE_LL_SCAN_DUP_NUM <= 128
+#define BLE_LL_SCAN_DUP_HASH_BITS       (8)
+#elif BLE_LL_SCAN_DUP_NUM <= 512
+#define BLE_LL_SCAN_DUP_HASH_BITS       (10)
+#elif BLE_LL_SCAN_DUP_NUM <= 2048
+#define BLE_LL_SCAN_DUP_HASH_BITS       (12)
+#elif BLE_LL_SCAN_DUP_NUM <= 8192
+#define BLE_LL_SCAN_DUP_HASH_BITS       (14)
+#else
+#define BLE_LL_SCAN_DUP_HASH_BITS       (16)
+#endif
+#define BLE_LL_SCAN_DUP_HASH_SIZE       (1 << BLE_LL_SCAN_DUP_HASH_BITS)
+#define BLE_LL_SCAN_DUP_HASH_MASK       (BLE_LL_SCAN_DUP_HASH_SIZE - 1)
+
+static struct ble_ll_scan_dup_entry g_scan_dup_entries[BLE_LL_SCAN_DUP_NUM];
+static uint16_t g_scan_dup_hash[BLE_LL_SCAN_DUP_HASH_SIZE];
+static uint16_t g_scan_dup_num_used;
 static TAILQ_HEAD(ble_ll_scan_dup_list, ble_ll_scan_dup_entry) g_scan_dup_list;
 
+static void
+ble_ll_scan_dup_clear(void)
+{
+    memset(g_scan_dup_hash, 0, sizeof(g_scan_dup_hash));
+    g_scan_dup_num_used = 0;
+    TAILQ_INIT(&g_scan_dup_list);
+}
+
+static inline uint16_t
+ble_ll_scan_dup_hash(uint8_t type, const uint8_t *addr)
+{
+    uint32_t h;
+
+    h = get_le32(addr) ^ ((uint32_t)get_le16(&addr[4]) << 8) ^
+        ((uint32_t)type << 24);
+    h *= 0x9e3779b1;
+
+    return (h >> (32 - BLE_LL_SCAN_DUP_HASH_BITS)) & BLE_LL_SCAN_DUP_HASH_MASK;
+}
+
+/* Returns matching entry or NULL; *slot is set to match or first free slot */
+static struct ble_ll_scan_dup_entry *
+ble_ll_scan_dup_find(uint8_t type, const uint8_t *addr, uint16_t *slot)
+{
+    struct ble_ll_scan_dup_entry *e;
+    uint16_t i;
+
+    i = ble_ll_scan_dup_hash(type, addr);
+
+    while (g_scan_dup_hash[i]) {
+        e = &g_scan_dup_entries[g_scan_dup_hash[i] - 1];
+        if ((e->type == type) && !memcmp(e->addr, addr, BLE_DEV_ADDR_LEN)) {
+            *slot = i;
+            return e;
+        }
+        i = (i + 1) & BLE_LL_SCAN_DUP_HASH_MASK;
+    }
+
+    *slot = i;
+
+    return NULL;
+}
+
+static void
+ble_ll_scan_dup_hash_remove(struct ble_ll_scan_dup_entry *e)
+{
+    struct ble_ll_scan_dup_entry *m;
+    uint16_t hole;
+    uint16_t home;
+    uint16_t i;
+
+    /*
+     * Backward shift deletion: move following entries of the same probe
+     * sequence into the hole so that no tombstones are needed.
+     */
+    hole = e->slot;
+    i = hole;
+
+    while (1) {
+        i = (i + 1) & BLE_LL_SCAN_DUP_HASH_MASK;
+        if (!g_scan_dup_hash[i]) {
+            break;
+        }
+
+        m = &g_scan_dup_entries[g_scan_dup_hash[i] - 1];
+        home = ble_ll_scan_dup_hash(m->type, m->addr);
+
+        /* Entry can be moved only if its home slot is not in (hole, i] */
+        if (((i - home) & BLE_LL_SCAN_DUP_HASH_MASK) >=
+            ((i - hole) & BLE_LL_SCAN_DUP_HASH_MASK)) {
+            g_scan_dup_hash[hole] = g_scan_dup_hash[i];
+            m->slot = hole;
+            hole = i;
+        }
+    }
+
+    g_scan_dup_hash[hole] = 0;
+}
+
 #if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_EXT_ADV)
 static int
 ble_ll_scan_start(struct ble_ll_scan_sm *scansm);
@@ -958,8 +1067,7 @@ ble_ll_scan_sm_start(struct ble_ll_scan_sm *scansm)
     /* Forget filtered advertisers from previous scan. */
     g_ble_ll_scan_num_rsp_advs = 0;
 
-    os_mempool_clear(&g_scan_dup_pool);
-    TAILQ_INIT(&g_scan_dup_list);
+    ble_ll_scan_dup_clear();
 
     /*
      * First scan window can start when RF is enabled. Add 1 tick since we are
@@ -1764,18 +1872,29 @@ ble_ll_scan_dup_move_to_head(struct ble_ll_scan_dup_entry *e)
     }
 }
 
-static inline struct ble_ll_scan_dup_entry *
-ble_ll_scan_dup_new(void)
+static struct ble_ll_scan_dup_entry *
+ble_ll_scan_dup_new(uint8_t type, const uint8_t *addr, uint16_t slot)
 {
     struct ble_ll_scan_dup_entry *e;
 
-    e = os_memblock_get(&g_scan_dup_pool);
-    if (!e) {
+    if (g_scan_dup_num_used < BLE_LL_SCAN_DUP_NUM) {
+        e = &g_scan_dup_entries[g_scan_dup_num_used++];
+    } else {
         e = TAILQ_LAST(&g_scan_dup_list, ble_ll_scan_dup_list);
         TAILQ_REMOVE(&g_scan_dup_list, e, link);
+        ble_ll_scan_dup_hash_remove(e);
+
+        /* Removal may have shifted entries into our free slot */
+        ble_ll_scan_dup_find(type, addr, &slot);
     }
 
     memset(e, 0, sizeof(*e));
+    e->type = type;
+    memcpy(e->addr, addr, BLE_DEV_ADDR_LEN);
+    e->slot = slot;
+
+    g_scan_dup_hash[slot] = (e - g_scan_dup_entries) + 1;
+    TAILQ_INSERT_HEAD(&g_scan_dup_list, e, link);
 
     return e;
 }
@@ -1784,17 +1903,13 @@ static int
 ble_ll_scan_dup_check_legacy(uint8_t addr_type, uint8_t *addr, uint8_t pdu_type)
 {
     struct ble_ll_scan_dup_entry *e;
+    uint16_t slot;
     uint8_t type;
     int rc;
 
     type = BLE_LL_SCAN_ENTRY_TYPE_LEGACY(addr_type);
 
-    TAILQ_FOREACH(e, &g_scan_dup_list, link) {
-        if ((e->type == type) && !memcmp(e->addr, addr, 6)) {
-            break;
-        }
-    }
-
+    e = ble_ll_scan_dup_find(type, addr, &slot);
     if (e) {
         if (pdu_type == BLE_ADV_PDU_TYPE_ADV_DIRECT_IND) {
             rc = e->flags & BLE_LL_SCAN_DUP_F_DIR_ADV_REPORT_SENT;
@@ -1808,23 +1923,22 @@ ble_ll_scan_dup_check_legacy(uint8_t addr_type, uint8_t *addr, uint8_t pdu_type)
     } else {
         rc = 0;
 
-        e = ble_ll_scan_dup_new();
-        e->flags = 0;
-        e->type = type;
-        memcpy(e->addr, addr, 6);
-
-        TAILQ_INSERT_HEAD(&g_scan_dup_list, e, link);
+        ble_ll_scan_dup_new(type, addr, slot);
     }
 
     return rc;
 }
 
 #if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_EXT_ADV)
+static const uint8_t g_ble_ll_scan_dup_anon_addr[BLE_DEV_ADDR_LEN];
+
 int
 ble_ll_scan_dup_check_ext(uint8_t addr_type, uint8_t *addr, bool has_aux,
                           uint16_t adi)
 {
     struct ble_ll_scan_dup_entry *e;
+    const uint8_t *key;
+    uint16_t slot;
     bool is_anon;
     uint8_t type;
     int rc;
@@ -1834,14 +1948,12 @@ ble_ll_scan_dup_check_ext(uint8_t addr_type, uint8_t *addr, bool has_aux,
 
     type = BLE_LL_SCAN_ENTRY_TYPE_EXT(addr_type, has_aux, is_anon, adi);
 
-    TAILQ_FOREACH(e, &g_scan_dup_list, link) {
-        if ((e->type == type) &&
-            (is_anon || !memcmp(e->addr, addr, BLE_DEV_ADDR_LEN))) {
-            break;
-        }
-    }
+    /* Anonymous entries are keyed by type only, i.e. all-zero address */
+    key = is_anon ? g_ble_ll_scan_dup_anon_addr : addr;
 
+    e = ble_ll_scan_dup_find(type, key, &slot);
     if (e) {
+        /* Same advertising set but new DID means data has changed */
         if (e->adi != adi) {
             rc = 0;
 
@@ -1855,15 +1967,8 @@ ble_ll_scan_dup_check_ext(uint8_t addr_type, uint8_t *addr, bool has_aux,
     } else {
         rc = 0;
 
-        e = ble_ll_scan_dup_new();
-        e->flags = 0;
-        e->type = type;
+        e = ble_ll_scan_dup_new(type, key, slot);
         e->adi = adi;
-        if (!is_anon) {
-            memcpy(e->addr, addr, 6);
-        }
-
-        TAILQ_INSERT_HEAD(&g_scan_dup_list, e, link);
     }
 
     return rc;
@@ -2739,8 +2844,7 @@ ble_ll_scan_reset(void)
     g_ble_ll_scan_num_rsp_advs = 0;
     memset(&g_ble_ll_scan_rsp_advs[0], 0, sizeof(g_ble_ll_scan_rsp_advs));
 
-    os_mempool_clear(&g_scan_dup_pool);
-    TAILQ_INIT(&g_scan_dup_list);
+    ble_ll_scan_dup_clear();
 
     /* Call the common init function again */
     ble_ll_scan_common_init();
@@ -2758,16 +2862,7 @@ ble_ll_scan_reset(void)
 void
 ble_ll_scan_init(void)
 {
-    os_error_t err;
-
-    err = os_mempool_init(&g_scan_dup_pool,
-                          MYNEWT_VAL(BLE_LL_NUM_SCAN_DUP_ADVS),
-                          sizeof(struct ble_ll_scan_dup_entry),
-                          g_scan_dup_mem,
-                          "ble_ll_scan_dup_pool");
-    BLE_LL_ASSERT(err == 0);
-
-    TAILQ_INIT(&g_scan_dup_list);
+    ble_ll_scan_dup_clear();
 
     ble_ll_scan_common_init();
 #if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_EXT_ADV)
@@ -21,6 +21,7 @@
 #include <stdlib.h>
 #include "nimble/ble.h"
 #include "controller/ble_ll.h"
+#include "controller/ble_phy.h"
 #include "controller/ble_ll_tmr.h"
 #include "controller/ble_ll_utils.h"
 
@@ -213,36 +214,29 @@ ble_ll_utils_calc_big_aa(uint32_t seed_aa, uint32_t n)
     return seed_aa ^ dw;
 }
 
-uint8_t
-ble_ll_utils_chan_map_remap(const uint8_t *chan_map, uint8_t remap_index)
+/* Find chan_idx of n-th (counting from 0) used channel in map */
+static uint8_t
+ble_ll_utils_chan_map_select(const uint8_t *chan_map, uint8_t n)
 {
-    uint8_t cntr;
-    uint8_t mask;
     uint8_t usable_chans;
-    uint8_t chan;
-    int i, j;
+    uint8_t cnt;
+    int i;
 
-    /* NOTE: possible to build a map but this would use memory. For now,
-     * we just calculate
-     * Iterate through channel map to find this channel
-     */
-    chan = 0;
-    cntr = 0;
     for (i = 0; i < BLE_LL_CHMAP_LEN; i++) {
         usable_chans = chan_map[i];
-        if (usable_chans != 0) {
-            mask = 0x01;
-            for (j = 0; j < 8; j++) {
-                if (usable_chans & mask) {
-                    if (cntr == remap_index) {
-                        return (chan + j);
-                    }
-                    ++cntr;
-                }
-                mask <<= 1;
+        if (i == BLE_LL_CHMAP_LEN - 1) {
+            usable_chans &= 0x1f;
+        }
+
+        cnt = __builtin_popcount(usable_chans);
+        if (n < cnt) {
+            /* Clear n lowest set bits, then index of lowest one is result */
+            while (n--) {
+                usable_chans &= usable_chans - 1;
             }
+            return i * 8 + __builtin_ctz(usable_chans);
         }
-        chan += 8;
+        n -= cnt;
     }
 
     /* we should never reach here */
@@ -250,6 +244,12 @@ ble_ll_utils_chan_map_remap(const uint8_t *chan_map, uint8_t remap_index)
     return 0;
 }
 
+uint8_t
+ble_ll_utils_chan_map_remap(const uint8_t *chan_map, uint8_t remap_index)
+{
+    return ble_ll_utils_chan_map_select(chan_map, remap_index);
+}
+
 uint8_t
 ble_ll_utils_chan_map_used_get(const uint8_t *chan_map)
 {
@@ -270,19 +270,15 @@ ble_ll_utils_csa2_perm(uint32_t val)
     return val;
 }
 #else
-static uint32_t
+static inline uint32_t
 ble_ll_utils_csa2_perm(uint32_t in)
 {
-    uint32_t out = 0;
-    int i;
-
-    for (i = 0; i < 8; i++) {
-        out |= ((in >> i) & 0x00000001) << (7 - i);
-    }
+    uint32_t out;
 
-    for (i = 8; i < 16; i++) {
-        out |= ((in >> i) & 0x00000001) << (15 + 8 - i);
-    }
+    /* Reverse bits in each of 2 bytes by swapping bits, pairs and nibbles */
+    out = ((in >> 1) & 0x5555) | ((in & 0x5555) << 1);
+    out = ((out >> 2) & 0x3333) | ((out & 0x3333) << 2);
+    out = ((out >> 4) & 0x0f0f) | ((out & 0x0f0f) << 4);
 
     return out;
 }
@@ -326,54 +322,23 @@ ble_ll_utils_csa2_prng(uint16_t counter, uint16_t ch_id)
 }
 
 /* Find remap_idx for given chan_idx */
-static uint16_t
+static inline uint16_t
 ble_ll_utils_csa2_chan2remap(uint16_t chan_idx, const uint8_t *chan_map)
 {
-    uint16_t remap_idx = 0;
-    uint32_t u32 = 0;
-    unsigned idx;
-
-    for (idx = 0; idx < 37; idx++) {
-        if ((idx % 8) == 0) {
-            u32 = chan_map[idx / 8];
-        }
-        if (u32 & 1) {
-            if (idx == chan_idx) {
-                return remap_idx;
-            }
-            remap_idx++;
-        }
-        u32 >>= 1;
-    }
+    uint64_t below;
 
-    BLE_LL_ASSERT(0);
+    /* Number of used channels below chan_idx */
+    below = ((uint64_t)chan_map[4] << 32) | get_le32(chan_map);
+    below &= (1ULL << chan_idx) - 1;
 
-    return 0;
+    return __builtin_popcountll(below);
 }
 
 /* Find chan_idx at given remap_idx */
-static uint16_t
+static inline uint16_t
 ble_ll_utils_csa2_remap2chan(uint16_t remap_idx, const uint8_t *chan_map)
 {
-    uint32_t u32 = 0;
-    unsigned idx;
-
-    for (idx = 0; idx < 37; idx++) {
-        if ((idx % 8) == 0) {
-            u32 = chan_map[idx / 8];
-        }
-        if (u32 & 1) {
-            if (!remap_idx) {
-                return idx;
-            }
-            remap_idx--;
-        }
-        u32 >>= 1;
-    }
-
-    BLE_LL_ASSERT(0);
-
-    return 0;
+    return ble_ll_utils_chan_map_select(chan_map, remap_idx);
 }
 
 static uint16_t
@@ -410,6 +375,36 @@ ble_ll_utils_dci_csa2(uint16_t counter, uint16_t chan_id,
     return chan_idx;
 }
 
+void
+ble_ll_utils_dci_csa2_batch(uint16_t counter, uint16_t chan_id,
+                            uint8_t num_used_chans, const uint8_t *chan_map,
+                            uint8_t *chans, uint8_t num)
+{
+    uint8_t remap_tbl[BLE_PHY_NUM_DATA_CHANS];
+    uint16_t prn_e;
+    uint16_t chan_idx;
+    uint8_t i;
+
+    /*
+     * Remap table is built once for all calculated events so this is
+     * cheaper than calculating each event separately.
+     */
+    for (i = 0; i < num_used_chans; i++) {
+        remap_tbl[i] = ble_ll_utils_chan_map_select(chan_map, i);
+    }
+
+    for (i = 0; i < num; i++) {
+        prn_e = ble_ll_utils_csa2_prng(counter + i, chan_id);
+
+        chan_idx = prn_e % 37;
+        if (!(chan_map[chan_idx / 8] & (1 << (chan_idx % 8)))) {
+            chan_idx = remap_tbl[(num_used_chans * prn_e) / 65536];
+        }
+
+        chans[i] = chan_idx;
+    }
+}
+
 uint16_t
 ble_ll_utils_dci_iso_event(uint16_t counter, uint16_t chan_id,
                            uint16_t *prn_sub_lu, uint8_t chan_map_used,
@@ -30,20 +30,175 @@
 #include "controller/ble_ll_scan.h"
 #include "controller/ble_hw.h"
 
-#if (MYNEWT_VAL(BLE_LL_WHITELIST_SIZE) < BLE_HW_WHITE_LIST_SIZE)
+#if (BLE_USES_HW_WHITELIST == 1) && \
+    (MYNEWT_VAL(BLE_LL_WHITELIST_SIZE) >= BLE_HW_WHITE_LIST_SIZE)
+#define BLE_LL_WHITELIST_SIZE       BLE_HW_WHITE_LIST_SIZE
+#else
 #define BLE_LL_WHITELIST_SIZE       MYNEWT_VAL(BLE_LL_WHITELIST_SIZE)
+#endif
+
+#if BLE_LL_WHITELIST_SIZE > 255
+#error "Whitelist size cannot exceed 255 entries"
+#endif
+
+/*
+ * Whitelist lookup uses cuckoo hash table with 2 slots per bucket. Number of
+ * buckets is at least number of entries so load factor is never above 0.5
+ * and each lookup checks at most 4 slots. In front of table there is a 64-bit
+ * Bloom filter so most of non-whitelisted addresses are rejected without
+ * touching the table, which makes it cheap enough to use in ISR context.
+ */
+#if BLE_LL_WHITELIST_SIZE <= 8
+#define BLE_LL_WHITELIST_BUCKETS    (8)
+#elif BLE_LL_WHITELIST_SIZE <= 16
+#define BLE_LL_WHITELIST_BUCKETS    (16)
+#elif BLE_LL_WHITELIST_SIZE <= 32
+#define BLE_LL_WHITELIST_BUCKETS    (32)
+#elif BLE_LL_WHITELIST_SIZE <= 64
+#define BLE_LL_WHITELIST_BUCKETS    (64)
+#elif BLE_LL_WHITELIST_SIZE <= 128
+#define BLE_LL_WHITELIST_BUCKETS    (128)
 #else
-#define BLE_LL_WHITELIST_SIZE       BLE_HW_WHITE_LIST_SIZE
+#define BLE_LL_WHITELIST_BUCKETS    (256)
 #endif
+#define BLE_LL_WHITELIST_BUCKET_MASK    (BLE_LL_WHITELIST_BUCKETS - 1)
+#define BLE_LL_WHITELIST_BUCKET_SLOTS   (2)
+#define BLE_LL_WHITELIST_MAX_KICKS      (32)
 
 struct ble_ll_whitelist_entry
 {
-    uint8_t wl_valid;
     uint8_t wl_addr_type;
     uint8_t wl_dev_addr[BLE_DEV_ADDR_LEN];
 };
 
+/* Valid entries are always kept at the beginning of array */
 struct ble_ll_whitelist_entry g_ble_ll_whitelist[BLE_LL_WHITELIST_SIZE];
+static uint8_t g_ble_ll_whitelist_num;
+
+/* Index of entry in whitelist plus 1, 0 means empty slot */
+static uint8_t g_ble_ll_whitelist_tbl[BLE_LL_WHITELIST_BUCKETS]
+                                     [BLE_LL_WHITELIST_BUCKET_SLOTS];
+static uint64_t g_ble_ll_whitelist_bloom;
+static uint32_t g_ble_ll_whitelist_seed;
+
+static inline uint32_t
+ble_ll_whitelist_hash(const uint8_t *addr, uint8_t addr_type)
+{
+    uint32_t h;
+
+    h = (get_le32(addr) ^ g_ble_ll_whitelist_seed) * 0x9e3779b1;
+    h ^= get_le16(&addr[4]) | ((uint32_t)addr_type << 16);
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+
+    return h;
+}
+
+static inline uint64_t
+ble_ll_whitelist_bloom_bits(uint32_t h)
+{
+    return (1ULL << ((h >> 20) & 0x3f)) | (1ULL << ((h >> 26) & 0x3f));
+}
+
+static inline uint8_t
+ble_ll_whitelist_bucket(uint32_t h, int alt)
+{
+    return (alt ? (h >> 10) : h) & BLE_LL_WHITELIST_BUCKET_MASK;
+}
+
+static int
+ble_ll_whitelist_tbl_insert(uint8_t idx)
+{
+    struct ble_ll_whitelist_entry *wl;
+    uint8_t victim;
+    uint8_t bucket;
+    uint32_t h;
+    int kick;
+    int i;
+
+    for (kick = 0; kick < BLE_LL_WHITELIST_MAX_KICKS; kick++) {
+        wl = &g_ble_ll_whitelist[idx];
+        h = ble_ll_whitelist_hash(wl->wl_dev_addr, wl->wl_addr_type);
+
+        if (kick == 0) {
+            g_ble_ll_whitelist_bloom |= ble_ll_whitelist_bloom_bits(h);
+        }
+
+        for (i = 0; i < 2 * BLE_LL_WHITELIST_BUCKET_SLOTS; i++) {
+            bucket = ble_ll_whitelist_bucket(h, i / BLE_LL_WHITELIST_BUCKET_SLOTS);
+            if (!g_ble_ll_whitelist_tbl[bucket][i % BLE_LL_WHITELIST_BUCKET_SLOTS]) {
+                g_ble_ll_whitelist_tbl[bucket][i % BLE_LL_WHITELIST_BUCKET_SLOTS] = idx + 1;
+                return 0;
+            }
+        }
+
+        /* No free slot, kick out one of entries and try to move it */
+        bucket = ble_ll_whitelist_bucket(h, kick & 1);
+        i = (kick >> 1) % BLE_LL_WHITELIST_BUCKET_SLOTS;
+        victim = g_ble_ll_whitelist_tbl[bucket][i] - 1;
+        g_ble_ll_whitelist_tbl[bucket][i] = idx + 1;
+        idx = victim;
+    }
+
+    return -1;
+}
+
+static void
+ble_ll_whitelist_tbl_rebuild(void)
+{
+    uint8_t i;
+
+    /*
+     * Either we removed an entry (Bloom filter cannot remove bits) or insert
+     * failed which means we need to use different hash function.
+     */
+    do {
+        memset(g_ble_ll_whitelist_tbl, 0, sizeof(g_ble_ll_whitelist_tbl));
+        g_ble_ll_whitelist_bloom = 0;
+
+        for (i = 0; i < g_ble_ll_whitelist_num; i++) {
+            if (ble_ll_whitelist_tbl_insert(i)) {
+                g_ble_ll_whitelist_seed = g_ble_ll_whitelist_seed * 1103515245 +
+                                          12345;
+                break;
+            }
+        }
+    } while (i < g_ble_ll_whitelist_num);
+}
+
+static uint8_t *
+ble_ll_whitelist_tbl_find(const uint8_t *addr, uint8_t addr_type)
+{
+    struct ble_ll_whitelist_entry *wl;
+    uint64_t bits;
+    uint8_t bucket;
+    uint8_t *slot;
+    uint32_t h;
+    int i;
+
+    h = ble_ll_whitelist_hash(addr, addr_type);
+
+    bits = ble_ll_whitelist_bloom_bits(h);
+    if ((g_ble_ll_whitelist_bloom & bits) != bits) {
+        return NULL;
+    }
+
+    for (i = 0; i < 2 * BLE_LL_WHITELIST_BUCKET_SLOTS; i++) {
+        bucket = ble_ll_whitelist_bucket(h, i / BLE_LL_WHITELIST_BUCKET_SLOTS);
+        slot = &g_ble_ll_whitelist_tbl[bucket][i % BLE_LL_WHITELIST_BUCKET_SLOTS];
+        if (!*slot) {
+            continue;
+        }
+
+        wl = &g_ble_ll_whitelist[*slot - 1];
+        if ((wl->wl_addr_type == addr_type) &&
+            (!memcmp(&wl->wl_dev_addr[0], addr, BLE_DEV_ADDR_LEN))) {
+            return slot;
+        }
+    }
+
+    return NULL;
+}
 
 static int
 ble_ll_whitelist_chg_allowed(void)
@@ -78,20 +233,15 @@ ble_ll_whitelist_chg_allowed(void)
 int
 ble_ll_whitelist_clear(void)
 {
-    int i;
-    struct ble_ll_whitelist_entry *wl;
-
     /* Check proper state */
     if (!ble_ll_whitelist_chg_allowed()) {
         return BLE_ERR_CMD_DISALLOWED;
     }
 
     /* Set the number of entries to 0 */
-    wl = &g_ble_ll_whitelist[0];
-    for (i = 0; i < BLE_LL_WHITELIST_SIZE; ++i) {
-        wl->wl_valid = 0;
-        ++wl;
-    }
+    g_ble_ll_whitelist_num = 0;
+    memset(g_ble_ll_whitelist_tbl, 0, sizeof(g_ble_ll_whitelist_tbl));
+    g_ble_ll_whitelist_bloom = 0;
 
 #if (BLE_USES_HW_WHITELIST == 1)
     ble_hw_whitelist_clear();
@@ -135,19 +285,11 @@ ble_ll_whitelist_read_size(uint8_t *rspbuf, uint8_t *rsplen)
 static int
 ble_ll_whitelist_search(const uint8_t *addr, uint8_t addr_type)
 {
-    int i;
-    struct ble_ll_whitelist_entry *wl;
+    uint8_t *slot;
 
-    wl = &g_ble_ll_whitelist[0];
-    for (i = 0; i < BLE_LL_WHITELIST_SIZE; ++i) {
-        if ((wl->wl_valid) && (wl->wl_addr_type == addr_type) &&
-            (!memcmp(&wl->wl_dev_addr[0], addr, BLE_DEV_ADDR_LEN))) {
-            return i + 1;
-        }
-        ++wl;
-    }
+    slot = ble_ll_whitelist_tbl_find(addr, addr_type);
 
-    return 0;
+    return slot ? *slot : 0;
 }
 
 /**
@@ -195,7 +337,6 @@ ble_ll_whitelist_add(const uint8_t *cmdbuf, uint8_t len)
     const struct ble_hci_le_add_whte_list_cp *cmd = (const void *) cmdbuf;
     struct ble_ll_whitelist_entry *wl;
     int rc;
-    int i;
 
     if (len != sizeof(*cmd)) {
         return BLE_ERR_INV_HCI_CMD_PARMS;
@@ -209,20 +350,16 @@ ble_ll_whitelist_add(const uint8_t *cmdbuf, uint8_t len)
     /* Check if we have any open entries */
     rc = BLE_ERR_SUCCESS;
     if (!ble_ll_whitelist_search(cmd->addr, cmd->addr_type)) {
-        wl = &g_ble_ll_whitelist[0];
-        for (i = 0; i < BLE_LL_WHITELIST_SIZE; ++i) {
-            if (wl->wl_valid == 0) {
-                memcpy(&wl->wl_dev_addr[0], cmd->addr, BLE_DEV_ADDR_LEN);
-                wl->wl_addr_type = cmd->addr_type;
-                wl->wl_valid = 1;
-                break;
-            }
-            ++wl;
-        }
-
-        if (i == BLE_LL_WHITELIST_SIZE) {
+        if (g_ble_ll_whitelist_num == BLE_LL_WHITELIST_SIZE) {
             rc = BLE_ERR_MEM_CAPACITY;
         } else {
+            wl = &g_ble_ll_whitelist[g_ble_ll_whitelist_num];
+            memcpy(&wl->wl_dev_addr[0], cmd->addr, BLE_DEV_ADDR_LEN);
+            wl->wl_addr_type = cmd->addr_type;
+
+            if (ble_ll_whitelist_tbl_insert(g_ble_ll_whitelist_num++)) {
+                ble_ll_whitelist_tbl_rebuild();
+            }
 #if (BLE_USES_HW_WHITELIST == 1)
             rc = ble_hw_whitelist_add(cmd->addr, cmd->addr_type);
 #endif
@@ -243,7 +380,9 @@ int
 ble_ll_whitelist_rmv(const uint8_t *cmdbuf, uint8_t len)
 {
     const struct ble_hci_le_rmv_white_list_cp *cmd = (const void *) cmdbuf;
-    int position;
+    uint8_t *slot;
+    uint8_t last;
+    uint8_t idx;
 
     if (len != sizeof(*cmd)) {
         return BLE_ERR_INV_HCI_CMD_PARMS;
@@ -254,9 +393,19 @@ ble_ll_whitelist_rmv(const uint8_t *cmdbuf, uint8_t len)
         return BLE_ERR_CMD_DISALLOWED;
     }
 
-    position = ble_ll_whitelist_search(cmd->addr, cmd->addr_type);
-    if (position) {
-        g_ble_ll_whitelist[position - 1].wl_valid = 0;
+    slot = ble_ll_whitelist_tbl_find(cmd->addr, cmd->addr_type);
+    if (slot) {
+        idx = *slot - 1;
+        last = g_ble_ll_whitelist_num - 1;
+
+        /* Move last entry into removed one to keep array compact */
+        if (idx != last) {
+            g_ble_ll_whitelist[idx] = g_ble_ll_whitelist[last];
+        }
+        g_ble_ll_whitelist_num--;
+
+        /* Bloom filter bits cannot be cleared so rebuild everything */
+        ble_ll_whitelist_tbl_rebuild();
     }
 
 #if (BLE_USES_HW_WHITELIST == 1)
@@ -274,9 +274,58 @@ TEST_CASE_SELF(ble_ll_csa2_test_3)
     TEST_ASSERT(remap_idx == 1);
 }
 
+TEST_CASE_SELF(ble_ll_csa2_test_4)
+{
+    struct ble_ll_conn_sm conn;
+    uint16_t chan_id;
+    uint8_t chans[3];
+    uint8_t rc;
+    int i;
+
+    chan_id = ((0x8e89bed6 & 0xffff0000) >> 16) ^ (0x8e89bed6 & 0x0000ffff);
+
+    /* based on sample data from CoreSpec 5.0 Vol 6 Part C 3.1 */
+    memset(&conn, 0, sizeof(conn));
+    conn.chan_map[0] = 0xff;
+    conn.chan_map[1] = 0xff;
+    conn.chan_map[2] = 0xff;
+    conn.chan_map[3] = 0xff;
+    conn.chan_map[4] = 0x1f;
+
+    ble_ll_utils_dci_csa2_batch(1, chan_id, 37, conn.chan_map, chans, 3);
+    TEST_ASSERT(chans[0] == 20);
+    TEST_ASSERT(chans[1] == 6);
+    TEST_ASSERT(chans[2] == 21);
+
+    /* based on sample data from CoreSpec 5.0 Vol 6 Part C 3.2 */
+    conn.chan_map[0] = 0x00;
+    conn.chan_map[1] = 0x06;
+    conn.chan_map[2] = 0xe0;
+    conn.chan_map[3] = 0x00;
+    conn.chan_map[4] = 0x1e;
+
+    ble_ll_utils_dci_csa2_batch(6, chan_id, 9, conn.chan_map, chans, 3);
+    TEST_ASSERT(chans[0] == 23);
+    TEST_ASSERT(chans[1] == 9);
+    TEST_ASSERT(chans[2] == 34);
+
+    /* Precalculated channels must match calculation done for each event */
+    conn.flags.csa2 = 1;
+    conn.channel_id = chan_id;
+    conn.chan_map_used = 9;
+
+    for (i = 0; i < 300; i++) {
+        conn.event_cntr = 0xff00 + i * 3;
+        rc = ble_ll_conn_calc_dci(&conn, 0);
+        TEST_ASSERT(rc == ble_ll_utils_dci_csa2(conn.event_cntr, chan_id, 9,
+                                                conn.chan_map));
+    }
+}
+
 TEST_SUITE(ble_ll_csa2_test_suite)
 {
     ble_ll_csa2_test_1();
     ble_ll_csa2_test_2();
     ble_ll_csa2_test_3();
+    ble_ll_csa2_test_4();
 }
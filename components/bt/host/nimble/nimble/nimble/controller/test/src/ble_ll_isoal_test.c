@@ -0,0 +1,304 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <syscfg/syscfg.h>
+#include <os/os_mbuf.h>
+#include <os/endian.h>
+#include <nimble/ble.h>
+#include <nimble/hci_common.h>
+#include <controller/ble_ll_isoal.h>
+#include <testutil/testutil.h>
+
+#if MYNEWT_VAL(BLE_LL_ISO)
+
+#define TSPX_sdu_len        (100)
+
+static struct os_mbuf *
+ble_ll_isoal_test_sdu(uint16_t sdu_num, uint16_t len)
+{
+    struct os_mbuf *om;
+    uint8_t val;
+    uint16_t i;
+    int rc;
+
+    om = os_msys_get_pkthdr(len, sizeof(struct ble_mbuf_hdr));
+    TEST_ASSERT_FATAL(om != NULL);
+
+    for (i = 0; i < len; i++) {
+        val = sdu_num * 7 + i;
+        rc = os_mbuf_append(om, &val, 1);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    return om;
+}
+
+static void
+ble_ll_isoal_test_check(uint16_t sdu_num, const uint8_t *data, uint16_t len)
+{
+    uint16_t i;
+
+    for (i = 0; i < len; i++) {
+        TEST_ASSERT(data[i] == (uint8_t)(sdu_num * 7 + i));
+    }
+}
+
+TEST_CASE_SELF(ble_ll_isoal_test_unframed)
+{
+    struct ble_ll_isoal_mux mux;
+    struct ble_ll_isoal_mux_stats stats;
+    uint8_t sdu[TSPX_sdu_len];
+    uint8_t pdu[40];
+    uint16_t sdu_len;
+    uint8_t llid;
+    int pdu_len;
+    int num;
+    int i;
+
+    /* 1 SDU per interval, 3 PDUs per SDU */
+    ble_ll_isoal_mux_init(&mux, 40, 10000, 10000, 3, 0, 0);
+
+    for (num = 0; num < 10; num++) {
+        ble_ll_isoal_mux_tx_pkt_in(&mux,
+                                   ble_ll_isoal_test_sdu(num, TSPX_sdu_len),
+                                   BLE_HCI_ISO_PB_COMPLETE, 0);
+
+        TEST_ASSERT(ble_ll_isoal_mux_event_start(&mux, 1000 * num) == 1);
+
+        sdu_len = 0;
+        for (i = 0; i < 3; i++) {
+            pdu_len = ble_ll_isoal_mux_unframed_get(&mux, i, &llid, pdu);
+            TEST_ASSERT(llid == (i < 2));
+            memcpy(&sdu[sdu_len], pdu, pdu_len);
+            sdu_len += pdu_len;
+        }
+
+        TEST_ASSERT(sdu_len == TSPX_sdu_len);
+        ble_ll_isoal_test_check(num, sdu, sdu_len);
+
+        TEST_ASSERT(ble_ll_isoal_mux_event_done(&mux) > 0);
+    }
+
+    ble_ll_isoal_mux_stats_get(&mux, &stats);
+    TEST_ASSERT(stats.sdu_rx == 10);
+    TEST_ASSERT(stats.sdu_tx == 10);
+    TEST_ASSERT(stats.sdu_overrun == 0);
+
+    ble_ll_isoal_mux_free(&mux);
+}
+
+TEST_CASE_SELF(ble_ll_isoal_test_framed)
+{
+    struct ble_ll_isoal_mux mux;
+    struct ble_ll_isoal_mux_stats stats;
+    uint8_t sdu[TSPX_sdu_len];
+    uint8_t pdu[40];
+    uint16_t sdu_len;
+    uint16_t rx_num;
+    uint8_t seg_hdr;
+    uint8_t seg_len;
+    uint8_t llid;
+    int pdu_len;
+    int offset;
+    int num;
+    int i;
+
+    /* SDUs are segmented into 2 PDUs per event with max 40 bytes each */
+    ble_ll_isoal_mux_init(&mux, 40, 10000, 10000, 2, 0, 1);
+
+    rx_num = 0;
+    sdu_len = 0;
+
+    for (num = 0; num < 10; num++) {
+        ble_ll_isoal_mux_tx_pkt_in(&mux,
+                                   ble_ll_isoal_test_sdu(num, 30 + num * 5),
+                                   BLE_HCI_ISO_PB_COMPLETE, 0);
+
+        ble_ll_isoal_mux_event_start(&mux, 1000 * num);
+
+        for (i = 0; i < 2; i++) {
+            pdu_len = ble_ll_isoal_mux_framed_get(&mux, i, &llid, pdu);
+            TEST_ASSERT(llid == 2);
+            TEST_ASSERT(pdu_len <= 40);
+
+            /* Reassemble segments, Core 5.3, Vol 6, Part G, 6.1 */
+            offset = 0;
+            while (offset < pdu_len) {
+                seg_hdr = pdu[offset];
+                seg_len = pdu[offset + 1];
+                offset += 2;
+
+                if (!(seg_hdr & 0x01)) {
+                    /* Skip time offset */
+                    offset += 3;
+                    seg_len -= 3;
+                    sdu_len = 0;
+                }
+
+                memcpy(&sdu[sdu_len], &pdu[offset], seg_len);
+                sdu_len += seg_len;
+                offset += seg_len;
+
+                if (seg_hdr & 0x02) {
+                    TEST_ASSERT(sdu_len == 30 + rx_num * 5);
+                    ble_ll_isoal_test_check(rx_num, sdu, sdu_len);
+                    rx_num++;
+                }
+            }
+            TEST_ASSERT(offset == pdu_len);
+        }
+
+        ble_ll_isoal_mux_event_done(&mux);
+    }
+
+    /* Bandwidth is not enough to send all SDUs in 10 events, flush rest */
+    for (num = 0; num < 10; num++) {
+        ble_ll_isoal_mux_event_start(&mux, 1000 * num);
+        for (i = 0; i < 2; i++) {
+            ble_ll_isoal_mux_framed_get(&mux, i, &llid, pdu);
+        }
+        ble_ll_isoal_mux_event_done(&mux);
+    }
+
+    ble_ll_isoal_mux_stats_get(&mux, &stats);
+    TEST_ASSERT(stats.sdu_rx == 10);
+    TEST_ASSERT(stats.sdu_tx == 10);
+
+    ble_ll_isoal_mux_free(&mux);
+}
+
+static struct os_mbuf *
+ble_ll_isoal_test_hci_sdu(uint16_t sdu_num, uint16_t len, uint8_t ts_flag,
+                          uint32_t timestamp)
+{
+    struct ble_hci_iso_data hci_iso_data;
+    struct ble_hci_iso hci_iso;
+    struct os_mbuf *om;
+    uint16_t hci_len;
+    uint8_t ts[4];
+    uint8_t val;
+    uint16_t i;
+    int rc;
+
+    hci_len = sizeof(hci_iso_data) + len + (ts_flag ? sizeof(ts) : 0);
+
+    om = os_msys_get_pkthdr(sizeof(hci_iso) + hci_len,
+                            sizeof(struct ble_mbuf_hdr));
+    TEST_ASSERT_FATAL(om != NULL);
+
+    hci_iso.handle = htole16(BLE_HCI_ISO_HANDLE(0x0100,
+                                                BLE_HCI_ISO_PB_COMPLETE,
+                                                ts_flag));
+    hci_iso.length = htole16(hci_len);
+    rc = os_mbuf_append(om, &hci_iso, sizeof(hci_iso));
+    TEST_ASSERT_FATAL(rc == 0);
+
+    if (ts_flag) {
+        put_le32(ts, timestamp);
+        rc = os_mbuf_append(om, ts, sizeof(ts));
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    hci_iso_data.packet_seq_num = htole16(sdu_num);
+    hci_iso_data.sdu_len = htole16(len);
+    rc = os_mbuf_append(om, &hci_iso_data, sizeof(hci_iso_data));
+    TEST_ASSERT_FATAL(rc == 0);
+
+    for (i = 0; i < len; i++) {
+        val = sdu_num * 7 + i;
+        rc = os_mbuf_append(om, &val, 1);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    return om;
+}
+
+TEST_CASE_SELF(ble_ll_isoal_test_timestamp)
+{
+    struct ble_ll_isoal_mux mux;
+    struct ble_ll_isoal_mux_stats stats;
+    struct os_mbuf *om;
+    uint16_t conn_handle;
+    uint32_t event_ts;
+    uint32_t timestamp;
+    uint8_t pdu[40];
+    uint8_t pb_flag;
+    uint8_t ts_flag;
+    uint8_t llid;
+    int pdu_len;
+    int num;
+    int rc;
+
+    /* 1 SDU per event, each fits in single framed PDU */
+    ble_ll_isoal_mux_init(&mux, 40, 10000, 10000, 1, 0, 1);
+
+    /* Every other SDU is sent without Time_Stamp */
+    for (num = 0; num < 4; num++) {
+        ts_flag = !(num & 1);
+        event_ts = 100000 + num * 10000;
+
+        om = ble_ll_isoal_test_hci_sdu(num, 20, ts_flag, event_ts - 500);
+
+        rc = ble_ll_isoal_tx_hdr_parse(om, &conn_handle, &pb_flag,
+                                       &timestamp);
+        TEST_ASSERT_FATAL(rc == 0);
+        TEST_ASSERT(conn_handle == 0x0100);
+        TEST_ASSERT(pb_flag == BLE_HCI_ISO_PB_COMPLETE);
+        TEST_ASSERT(OS_MBUF_PKTLEN(om) == 20);
+        if (ts_flag) {
+            TEST_ASSERT(timestamp == event_ts - 500);
+        } else {
+            TEST_ASSERT(timestamp == 0);
+        }
+
+        ble_ll_isoal_mux_tx_pkt_in(&mux, om, pb_flag, timestamp);
+
+        TEST_ASSERT(ble_ll_isoal_mux_event_start(&mux, event_ts) == 1);
+
+        pdu_len = ble_ll_isoal_mux_framed_get(&mux, 0, &llid, pdu);
+        TEST_ASSERT(pdu_len == 2 + 3 + 20);
+
+        /* Time_Offset, Core 5.3, Vol 6, Part G, 6.1 */
+        TEST_ASSERT(get_le24(&pdu[2]) == (ts_flag ? 500 : 0));
+        ble_ll_isoal_test_check(num, &pdu[5], 20);
+
+        ble_ll_isoal_mux_event_done(&mux);
+    }
+
+    /* Latency is only measured for SDUs with Time_Stamp */
+    ble_ll_isoal_mux_stats_get(&mux, &stats);
+    TEST_ASSERT(stats.sdu_tx == 4);
+    TEST_ASSERT(stats.latency_cnt == 2);
+    TEST_ASSERT(stats.latency_max == 500);
+
+    ble_ll_isoal_mux_free(&mux);
+}
+
+#endif
+
+TEST_SUITE(ble_ll_isoal_test_suite)
+{
+#if MYNEWT_VAL(BLE_LL_ISO)
+    ble_ll_isoal_test_unframed();
+    ble_ll_isoal_test_framed();
+    ble_ll_isoal_test_timestamp();
+#endif
+}
@@ -0,0 +1,140 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <syscfg/syscfg.h>
+#include <controller/ble_ll_scan.h>
+#include <testutil/testutil.h>
+
+#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_EXT_ADV)
+
+#define BLE_LL_SCAN_DUP_TEST_MAX_ADVS   (5000)
+
+static void
+ble_ll_scan_dup_test_addr(uint16_t idx, uint8_t *addr)
+{
+    memset(addr, 0, BLE_DEV_ADDR_LEN);
+    addr[0] = idx;
+    addr[1] = idx >> 8;
+    addr[5] = 0xc0;
+}
+
+/* Returns number of reports which were not filtered as duplicates */
+static int
+ble_ll_scan_dup_test_rx(uint16_t num_advs, uint16_t adi)
+{
+    uint8_t addr[BLE_DEV_ADDR_LEN];
+    int reported;
+    uint16_t i;
+
+    reported = 0;
+
+    for (i = 0; i < num_advs; i++) {
+        ble_ll_scan_dup_test_addr(i, addr);
+
+        if (!ble_ll_scan_dup_check_ext(1, addr, true, adi)) {
+            ble_ll_scan_dup_update_ext(1, addr, true, adi);
+            reported++;
+        }
+    }
+
+    return reported;
+}
+
+TEST_CASE_SELF(ble_ll_scan_dup_test_did)
+{
+    uint8_t addr[BLE_DEV_ADDR_LEN];
+    int rc;
+
+    ble_ll_scan_reset();
+
+    ble_ll_scan_dup_test_addr(0, addr);
+
+    rc = ble_ll_scan_dup_check_ext(1, addr, true, 0x1001);
+    TEST_ASSERT(rc == 0);
+    ble_ll_scan_dup_update_ext(1, addr, true, 0x1001);
+
+    rc = ble_ll_scan_dup_check_ext(1, addr, true, 0x1001);
+    TEST_ASSERT(rc != 0);
+
+    /* DID changed, data should be reported again */
+    rc = ble_ll_scan_dup_check_ext(1, addr, true, 0x1002);
+    TEST_ASSERT(rc == 0);
+    ble_ll_scan_dup_update_ext(1, addr, true, 0x1002);
+
+    /* Different SID is a different advertising set */
+    rc = ble_ll_scan_dup_check_ext(1, addr, true, 0x2002);
+    TEST_ASSERT(rc == 0);
+    ble_ll_scan_dup_update_ext(1, addr, true, 0x2002);
+
+    rc = ble_ll_scan_dup_check_ext(1, addr, true, 0x1002);
+    TEST_ASSERT(rc != 0);
+
+    /* Anonymous advertising */
+    rc = ble_ll_scan_dup_check_ext(0, NULL, true, 0x1003);
+    TEST_ASSERT(rc == 0);
+    ble_ll_scan_dup_update_ext(0, NULL, true, 0x1003);
+
+    rc = ble_ll_scan_dup_check_ext(0, NULL, true, 0x1003);
+    TEST_ASSERT(rc != 0);
+}
+
+TEST_CASE_SELF(ble_ll_scan_dup_test_lru)
+{
+    uint16_t num_advs;
+    int reported;
+    int round;
+
+    /*
+     * Receive from 10..5000 distinct advertisers several times. As long as
+     * all advertisers fit only first round is reported, otherwise entries
+     * are evicted in LRU order and each round is reported again.
+     */
+    for (num_advs = 10; num_advs <= BLE_LL_SCAN_DUP_TEST_MAX_ADVS;
+         num_advs *= 2) {
+        ble_ll_scan_reset();
+
+        reported = ble_ll_scan_dup_test_rx(num_advs, 0x1001);
+        TEST_ASSERT(reported == num_advs);
+
+        for (round = 0; round < 3; round++) {
+            reported = ble_ll_scan_dup_test_rx(num_advs, 0x1001);
+            if (num_advs <= MYNEWT_VAL(BLE_LL_NUM_SCAN_DUP_ADVS)) {
+                TEST_ASSERT(reported == 0);
+            } else {
+                TEST_ASSERT(reported == num_advs);
+            }
+        }
+
+        /* All remembered advertisers should report new DID */
+        reported = ble_ll_scan_dup_test_rx(num_advs, 0x1002);
+        TEST_ASSERT(reported == num_advs);
+    }
+}
+
+#endif
+
+TEST_SUITE(ble_ll_scan_dup_test_suite)
+{
+#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_EXT_ADV)
+    ble_ll_scan_dup_test_did();
+    ble_ll_scan_dup_test_lru();
+#endif
+}
@@ -25,6 +25,9 @@
 TEST_SUITE_DECL(ble_ll_aa_test_suite);
 TEST_SUITE_DECL(ble_ll_crypto_test_suite);
 TEST_SUITE_DECL(ble_ll_csa2_test_suite);
+TEST_SUITE_DECL(ble_ll_isoal_test_suite);
+TEST_SUITE_DECL(ble_ll_scan_dup_test_suite);
+TEST_SUITE_DECL(ble_ll_whitelist_test_suite);
 
 int
 main(int argc, char **argv)
@@ -32,6 +35,9 @@ main(int argc, char **argv)
     ble_ll_aa_test_suite();
     ble_ll_crypto_test_suite();
     ble_ll_csa2_test_suite();
+    ble_ll_isoal_test_suite();
+    ble_ll_scan_dup_test_suite();
+    ble_ll_whitelist_test_suite();
 
     return tu_any_failed;
 }
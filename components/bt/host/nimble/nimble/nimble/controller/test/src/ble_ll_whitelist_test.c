@@ -0,0 +1,117 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <syscfg/syscfg.h>
+#include <nimble/hci_common.h>
+#include <controller/ble_ll_whitelist.h>
+#include <testutil/testutil.h>
+
+#define BLE_LL_WHITELIST_TEST_SIZE  MYNEWT_VAL(BLE_LL_WHITELIST_SIZE)
+
+static void
+ble_ll_whitelist_test_entry(uint16_t idx, struct ble_hci_le_add_whte_list_cp *cmd)
+{
+    cmd->addr_type = idx & 1;
+    cmd->addr[0] = idx;
+    cmd->addr[1] = idx >> 8;
+    cmd->addr[2] = 0x33;
+    cmd->addr[3] = 0x44;
+    cmd->addr[4] = 0x55;
+    cmd->addr[5] = 0xc0;
+}
+
+static int
+ble_ll_whitelist_test_match(uint16_t idx)
+{
+    struct ble_hci_le_add_whte_list_cp cmd;
+
+    ble_ll_whitelist_test_entry(idx, &cmd);
+
+    return ble_ll_whitelist_match(cmd.addr, cmd.addr_type, 1);
+}
+
+TEST_CASE_SELF(ble_ll_whitelist_test_add_rmv)
+{
+    struct ble_hci_le_add_whte_list_cp cmd;
+    uint16_t i;
+    int rc;
+
+    rc = ble_ll_whitelist_clear();
+    TEST_ASSERT(rc == 0);
+
+    for (i = 0; i < BLE_LL_WHITELIST_TEST_SIZE; i++) {
+        ble_ll_whitelist_test_entry(i, &cmd);
+        rc = ble_ll_whitelist_add((uint8_t *)&cmd, sizeof(cmd));
+        TEST_ASSERT(rc == 0);
+    }
+
+    /* Adding existing entry is not an error */
+    ble_ll_whitelist_test_entry(0, &cmd);
+    rc = ble_ll_whitelist_add((uint8_t *)&cmd, sizeof(cmd));
+    TEST_ASSERT(rc == 0);
+
+    ble_ll_whitelist_test_entry(i, &cmd);
+    rc = ble_ll_whitelist_add((uint8_t *)&cmd, sizeof(cmd));
+    TEST_ASSERT(rc == BLE_ERR_MEM_CAPACITY);
+
+    for (i = 0; i < BLE_LL_WHITELIST_TEST_SIZE; i++) {
+        TEST_ASSERT(ble_ll_whitelist_test_match(i));
+    }
+    for (; i < 4 * BLE_LL_WHITELIST_TEST_SIZE; i++) {
+        TEST_ASSERT(!ble_ll_whitelist_test_match(i));
+    }
+
+    /* Remove every other entry */
+    for (i = 0; i < BLE_LL_WHITELIST_TEST_SIZE; i += 2) {
+        ble_ll_whitelist_test_entry(i, &cmd);
+        rc = ble_ll_whitelist_rmv((uint8_t *)&cmd, sizeof(cmd));
+        TEST_ASSERT(rc == 0);
+    }
+
+    for (i = 0; i < BLE_LL_WHITELIST_TEST_SIZE; i++) {
+        TEST_ASSERT(!ble_ll_whitelist_test_match(i) == !(i & 1));
+    }
+
+    rc = ble_ll_whitelist_clear();
+    TEST_ASSERT(rc == 0);
+
+    for (i = 0; i < BLE_LL_WHITELIST_TEST_SIZE; i++) {
+        TEST_ASSERT(!ble_ll_whitelist_test_match(i));
+    }
+}
+
+TEST_CASE_SELF(ble_ll_whitelist_test_read_size)
+{
+    uint8_t rsp[1];
+    uint8_t rsplen;
+    int rc;
+
+    rc = ble_ll_whitelist_read_size(rsp, &rsplen);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(rsplen == 1);
+    TEST_ASSERT(rsp[0] == BLE_LL_WHITELIST_TEST_SIZE);
+}
+
+TEST_SUITE(ble_ll_whitelist_test_suite)
+{
+    ble_ll_whitelist_test_add_rmv();
+    ble_ll_whitelist_test_read_size();
+}
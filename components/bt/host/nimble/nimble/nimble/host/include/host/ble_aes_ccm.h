@@ -15,6 +15,7 @@
 #include "mbedtls/aes.h"
 #else
 #include "tinycrypt/aes.h"
+#include "tinycrypt/constants.h"
 #endif
 
 #ifdef __cplusplus
@@ -23,6 +24,60 @@ extern "C" {
 
 #if MYNEWT_VAL(ENC_ADV_DATA)
 
+/**
+ * AES-CCM context.  Holds expanded AES key schedule so that it is computed
+ * once per key instead of once per processed block.
+ */
+struct ble_aes_ccm_ctx {
+#if MYNEWT_VAL(BLE_CRYPTO_STACK_MBEDTLS)
+    mbedtls_aes_context aes;
+#else
+    struct tc_aes_key_sched_struct sched;
+#endif
+};
+
+/**
+ * Initializes AES-CCM context with the specified key.
+ *
+ * @param ctx                   The context to initialize.
+ * @param key                   128-bit key.
+ *
+ * @return                      0 on success; nonzero on failure.
+ */
+int ble_aes_ccm_ctx_init(struct ble_aes_ccm_ctx *ctx, const uint8_t key[16]);
+
+/**
+ * Releases resources of AES-CCM context and wipes key schedule.
+ */
+void ble_aes_ccm_ctx_free(struct ble_aes_ccm_ctx *ctx);
+
+/**
+ * Encrypts and authenticates message.  Encrypted message followed by MIC of
+ * mic_size bytes is written to out_msg.  In place operation is allowed.
+ *
+ * @return                      0 on success;
+ *                              BLE_HS_EINVAL on invalid length or MIC size;
+ *                              other nonzero on failure.
+ */
+int ble_aes_ccm_ctx_encrypt(struct ble_aes_ccm_ctx *ctx, const uint8_t nonce[13],
+                            const uint8_t *msg, size_t msg_len,
+                            const uint8_t *aad, size_t aad_len,
+                            uint8_t *out_msg, size_t mic_size);
+
+/**
+ * Decrypts message and verifies its MIC which is expected to directly follow
+ * msg_len bytes of encrypted message.  In place operation is allowed.
+ *
+ * @return                      0 on success;
+ *                              BLE_HS_EAUTHEN if MIC does not match;
+ *                              BLE_HS_EINVAL on invalid length or MIC size;
+ *                              other nonzero on failure.
+ */
+int ble_aes_ccm_ctx_decrypt(struct ble_aes_ccm_ctx *ctx, const uint8_t nonce[13],
+                            const uint8_t *enc_msg, size_t msg_len,
+                            const uint8_t *aad, size_t aad_len,
+                            uint8_t *out_msg, size_t mic_size);
+
 const char *ble_aes_ccm_hex(const void *buf, size_t len);
 int ble_aes_ccm_encrypt_be(const uint8_t *key, const uint8_t *plaintext, uint8_t *enc_data);
 int ble_aes_ccm_decrypt(const uint8_t key[16], uint8_t nonce[13], const uint8_t *enc_data,
@@ -116,11 +116,54 @@ int ble_ead_encrypt(const uint8_t session_key[BLE_EAD_KEY_SIZE],
  * @return                      0 on success;
  *                              BLE_HS_EINVAL if the specified value is not
  *                              within the allowed range.
+ *                              BLE_HS_EAUTHEN if the MIC does not match.
  */
 int ble_ead_decrypt(const uint8_t session_key[BLE_EAD_KEY_SIZE],
                     const uint8_t iv[BLE_EAD_IV_SIZE], const uint8_t *encrypted_payload,
                     size_t encrypted_payload_size, uint8_t *payload);
 
+/** Encrypted Advertising Data report for batched decryption. */
+struct ble_ead_report {
+    /** Received Encrypted Data, as for ble_ead_decrypt(). */
+    const uint8_t *encrypted_payload;
+
+    /** Size of encrypted_payload in bytes. */
+    size_t encrypted_payload_size;
+
+    /**
+     * Buffer for decrypted payload of at least
+     * BLE_EAD_DECRYPTED_PAYLOAD_SIZE(encrypted_payload_size) bytes.
+     */
+    uint8_t *payload;
+
+    /**
+     * Set by ble_ead_decrypt_batch(): 0 if report was decrypted and
+     * authenticated; BLE_HS_EAUTHEN on MIC mismatch; other nonzero on error.
+     */
+    int status;
+};
+
+/**
+ * @brief Decrypt and authenticate multiple Encrypted Advertising Data reports
+ *        which use the same key material.
+ *
+ * Equivalent to calling ble_ead_decrypt() for each report, but the AES key
+ * schedule is set up only once for the whole batch.
+ *
+ * @session_key                 Key of 16 bytes used for the encryption.
+ * @iv                          Initialisation Vector used to generate the `nonce`.
+ * @reports                     Reports to decrypt; status of each is updated.
+ * @num_reports                 Number of reports.
+ *
+ * @return                      0 if reports were processed; status of each
+ *                              report is set accordingly;
+ *                              BLE_HS_EINVAL if key material or reports are
+ *                              missing; other nonzero on failure.
+ */
+int ble_ead_decrypt_batch(const uint8_t session_key[BLE_EAD_KEY_SIZE],
+                          const uint8_t iv[BLE_EAD_IV_SIZE],
+                          struct ble_ead_report *reports, size_t num_reports);
+
 int ble_ead_serialize_data(const struct enc_adv_data *input, uint8_t *output);
 
 #endif /* ENC_ADV_DATA */
@@ -165,6 +165,7 @@ struct hci_conn_update;
 #define BLE_GAP_EVENT_CONN_IQ_REPORT        36
 #define BLE_GAP_EVENT_CTE_REQ_FAILED        37
 #define BLE_GAP_EVENT_LINK_ESTAB            38
+#define BLE_GAP_EVENT_PERIODIC_TRAIN        39
 
 /* DTM events */
 #define BLE_GAP_DTM_TX_START_EVT            0
@@ -975,6 +976,46 @@ struct ble_gap_event {
             const uint8_t *data;
         } periodic_report;
 
+        /**
+         * Represents a periodic advertising train reassembled from all
+         * periodic advertising reports that carried it.  Reported instead of
+         * BLE_GAP_EVENT_PERIODIC_REPORT when BLE_PERIODIC_ADV_REASSEMBLY is
+         * enabled.  Valid for the following event types:
+         *     o BLE_GAP_EVENT_PERIODIC_TRAIN
+         */
+        struct {
+            /** Periodic sync handle */
+            uint16_t sync_handle;
+
+            /** Advertiser transmit power in dBm (127 if unavailable) */
+            int8_t tx_power;
+
+            /**
+             * Received signal strength indication of the last report of the
+             * train in dBm (127 if unavailable)
+             */
+            int8_t rssi;
+
+            /** Advertising data status, can be one of following constants:
+             *  - BLE_HCI_PERIODIC_DATA_STATUS_COMPLETE
+             *  - BLE_HCI_PERIODIC_DATA_STATUS_TRUNCATED (the controller did
+             *    not receive the whole train, or the host ran out of
+             *    memory while reassembling it)
+             */
+            uint8_t data_status;
+
+            /** Length of the reassembled advertising data */
+            uint16_t data_length;
+
+            /**
+             * The reassembled advertising data; NULL if no memory was
+             * available for any of it.  If the application wishes to retain
+             * this mbuf for later use, it must set this pointer to NULL to
+             * prevent the stack from freeing it.
+             */
+            struct os_mbuf *om;
+        } periodic_train;
+
         /**
          * Represents a periodic advertising sync lost of established sync.
          * Sync lost reason can be BLE_HS_ETIMEOUT (sync timeout) or
@@ -1858,6 +1899,15 @@ struct ble_gap_periodic_sync_params {
      created */
     unsigned int filter_duplicates:1;
 #endif
+#if MYNEWT_VAL(BLE_PERIODIC_ADV_REASSEMBLY)
+    /** If reassembled trains identical to the previously reported one
+     * should be dropped by the host.  Unlike filter_duplicates this does not
+     * require controller support, as it compares the payload instead of the
+     * Advertising Data ID.  The host keeps a copy of the last reported train
+     * in msys mbufs for the comparison.
+     */
+    unsigned int filter_unchanged:1;
+#endif
 #if MYNEWT_VAL(BLE_AOA_AOD)
     uint8_t sync_cte_type;
 #endif
@@ -112,6 +112,18 @@ struct ble_sm_io {
 
 int ble_sm_sc_oob_generate_data(struct ble_sm_sc_oob_data *oob_data);
 
+struct ble_npl_eventq;
+
+/**
+ * Designates the specified event queue for Secure Connections crypto work:
+ * refilling the P-256 key pair pool and asynchronous DHKey calculation.  By
+ * default this work is done on the host event queue.  Running the queue from
+ * a low priority task keeps scalar multiplications out of the host task.
+ *
+ * @param evq The event queue to use for SM crypto work.
+ */
+void ble_sm_sc_crypto_evq_set(struct ble_npl_eventq *evq);
+
 #if NIMBLE_BLE_SM
 int ble_sm_inject_io(uint16_t conn_handle, struct ble_sm_io *pkey);
 #else
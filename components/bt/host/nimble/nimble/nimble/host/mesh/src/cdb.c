@@ -23,7 +23,6 @@
  */
 struct key_update {
 	uint16_t key_idx:12,    /* AppKey or NetKey Index */
-		 valid:1,       /* 1 if this entry is valid, 0 if not */
 		 app_key:1,     /* 1 if this is an AppKey, 0 if a NetKey */
 		 clear:1;       /* 1 if key needs clearing, 0 if storing */
 };
@@ -64,9 +63,24 @@ struct net_val {
 	bool  iv_update;
 } __packed;
 
+/* Pending updates are kept sorted (nodes by address, keys by type and
+ * index) so that repeated changes to the same entry are coalesced with a
+ * binary search, and only the used prefix is walked when storing.
+ */
 static struct node_update cdb_node_updates[MYNEWT_VAL(BLE_MESH_CDB_NODE_COUNT)];
+static uint16_t cdb_node_update_cnt;
 static struct key_update cdb_key_updates[MYNEWT_VAL(BLE_MESH_CDB_SUBNET_COUNT) +
 					 MYNEWT_VAL(BLE_MESH_CDB_APP_KEY_COUNT)];
+static uint16_t cdb_key_update_cnt;
+
+/* Indices into bt_mesh_cdb.nodes of all allocated nodes, sorted by primary
+ * element address. Node address ranges never overlap, so the only node that
+ * can contain a given address is the last one starting at or below it.
+ */
+static uint16_t cdb_node_idx[MYNEWT_VAL(BLE_MESH_CDB_NODE_COUNT)];
+static uint16_t cdb_node_cnt;
+/* Slot in bt_mesh_cdb.nodes where the search for a free node starts. */
+static uint16_t cdb_node_free_hint;
 
 struct bt_mesh_cdb bt_mesh_cdb = {
 	.nodes = {
@@ -86,6 +100,52 @@ struct bt_mesh_cdb bt_mesh_cdb = {
 	},
 };
 
+/*
+ * Return the number of allocated nodes whose primary address is lower than or
+ * equal to addr, i.e. the position in cdb_node_idx where a node starting at
+ * addr would be inserted.
+ */
+static uint16_t node_idx_upper(uint16_t addr)
+{
+	uint16_t lo = 0, hi = cdb_node_cnt, mid;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+
+		if (bt_mesh_cdb.nodes[cdb_node_idx[mid]].addr <= addr) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	return lo;
+}
+
+static void node_idx_insert(const struct bt_mesh_cdb_node *node)
+{
+	uint16_t pos = node_idx_upper(node->addr);
+
+	memmove(&cdb_node_idx[pos + 1], &cdb_node_idx[pos],
+		(cdb_node_cnt - pos) * sizeof(cdb_node_idx[0]));
+	cdb_node_idx[pos] = node - bt_mesh_cdb.nodes;
+	cdb_node_cnt++;
+}
+
+static void node_idx_remove(const struct bt_mesh_cdb_node *node)
+{
+	uint16_t pos = node_idx_upper(node->addr);
+
+	if (pos == 0 || cdb_node_idx[pos - 1] != node - bt_mesh_cdb.nodes) {
+		return;
+	}
+
+	pos--;
+	cdb_node_cnt--;
+	memmove(&cdb_node_idx[pos], &cdb_node_idx[pos + 1],
+		(cdb_node_cnt - pos) * sizeof(cdb_node_idx[0]));
+}
+
 /*
  * Check if an address range from addr_start for addr_start + num_elem - 1 is
  * free for use. When a conflict is found, next will be set to the next address
@@ -94,8 +154,9 @@ struct bt_mesh_cdb bt_mesh_cdb = {
 static int addr_is_free(uint16_t addr_start, uint8_t num_elem, uint16_t *next)
 {
 	uint16_t addr_end = addr_start + num_elem - 1;
-	uint16_t other_start, other_end;
-	int i;
+	struct bt_mesh_cdb_node *node;
+	uint16_t other_end;
+	uint16_t pos;
 
 	if (!BT_MESH_ADDR_IS_UNICAST(addr_start) ||
 	    !BT_MESH_ADDR_IS_UNICAST(addr_end) ||
@@ -103,23 +164,20 @@ static int addr_is_free(uint16_t addr_start, uint8_t num_elem, uint16_t *next)
 		return -EINVAL;
 	}
 
-	for (i = 0; i < ARRAY_SIZE(bt_mesh_cdb.nodes); i++) {
-		struct bt_mesh_cdb_node *node = &bt_mesh_cdb.nodes[i];
-
-		if (node->addr == BT_MESH_ADDR_UNASSIGNED) {
-			continue;
-		}
-
-		other_start = node->addr;
-		other_end = other_start + node->num_elem - 1;
+	pos = node_idx_upper(addr_end);
+	if (pos == 0) {
+		return 0;
+	}
 
-		if (!(addr_end < other_start || addr_start > other_end)) {
-			if (next) {
-				*next = other_end + 1;
-			}
+	node = &bt_mesh_cdb.nodes[cdb_node_idx[pos - 1]];
+	other_end = node->addr + node->num_elem - 1;
 
-			return -EAGAIN;
+	if (other_end >= addr_start) {
+		if (next) {
+			*next = other_end + 1;
 		}
+
+		return -EAGAIN;
 	}
 
 	return 0;
@@ -130,30 +188,34 @@ static int addr_is_free(uint16_t addr_start, uint8_t num_elem, uint16_t *next)
  * a free address range cannot be found, BT_MESH_ADDR_UNASSIGNED will be
  * returned. Otherwise the first address in the range is returned.
  *
- * NOTE: This is quite an ineffective algorithm as it might need to look
- *       through the array of nodes N+2 times. A more effective algorithm
- *       could be used if the nodes were stored in a sorted list.
+ * The allocated ranges are walked in address order, so the first gap that
+ * is large enough is found in a single pass.
  */
 static uint16_t find_lowest_free_addr(uint8_t num_elem)
 {
-	uint16_t addr = 1, next = 0;
-	int err, i;
-
-	/*
-	 * It takes a maximum of node count + 2 to find a free address if there
-	 * is any. +1 for our own address and +1 for making sure that the
-	 * address range is valid.
-	 */
-	for (i = 0; i < ARRAY_SIZE(bt_mesh_cdb.nodes) + 2; ++i) {
-		err = addr_is_free(addr, num_elem, &next);
-		if (err == 0) {
-			break;
-		} else if (err != -EAGAIN) {
-			addr = BT_MESH_ADDR_UNASSIGNED;
+	struct bt_mesh_cdb_node *node;
+	uint32_t addr = 1;
+	uint16_t i;
+
+	if (num_elem == 0) {
+		return BT_MESH_ADDR_UNASSIGNED;
+	}
+
+	for (i = 0; i < cdb_node_cnt; i++) {
+		node = &bt_mesh_cdb.nodes[cdb_node_idx[i]];
+
+		if (addr + num_elem - 1 < node->addr) {
 			break;
 		}
 
-		addr = next;
+		if ((uint32_t)node->addr + node->num_elem > addr) {
+			addr = node->addr + node->num_elem;
+		}
+	}
+
+	if (!BT_MESH_ADDR_IS_UNICAST(addr) ||
+	    !BT_MESH_ADDR_IS_UNICAST(addr + num_elem - 1)) {
+		return BT_MESH_ADDR_UNASSIGNED;
 	}
 
 	return addr;
@@ -549,46 +611,51 @@ static void update_cdb_net_settings(void)
 	schedule_cdb_store(BT_MESH_CDB_SUBNET_PENDING);
 }
 
-static struct node_update *cdb_node_update_find(uint16_t addr,
-						struct node_update **free_slot)
+/*
+ * Return the position of the pending update for addr, or the position where
+ * it should be inserted. match is set if an update for addr exists.
+ */
+static uint16_t cdb_node_update_find(uint16_t addr, bool *match)
 {
-	struct node_update *match;
-	int i;
+	uint16_t lo = 0, hi = cdb_node_update_cnt, mid;
 
-	match = NULL;
-	*free_slot = NULL;
+	*match = false;
 
-	for (i = 0; i < ARRAY_SIZE(cdb_node_updates); i++) {
-		struct node_update *update = &cdb_node_updates[i];
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
 
-		if (update->addr == BT_MESH_ADDR_UNASSIGNED) {
-			*free_slot = update;
-			continue;
+		if (cdb_node_updates[mid].addr == addr) {
+			*match = true;
+			return mid;
 		}
 
-		if (update->addr == addr) {
-			match = update;
+		if (cdb_node_updates[mid].addr < addr) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
 		}
 	}
 
-	return match;
+	return lo;
 }
 
 static void update_cdb_node_settings(const struct bt_mesh_cdb_node *node,
 				     bool store)
 {
-	struct node_update *update, *free_slot;
+	struct node_update *update;
+	uint16_t pos;
+	bool match;
 
 	BT_DBG("Node 0x%04x", node->addr);
 
-	update = cdb_node_update_find(node->addr, &free_slot);
-	if (update) {
-		update->clear = !store;
+	pos = cdb_node_update_find(node->addr, &match);
+	if (match) {
+		cdb_node_updates[pos].clear = !store;
 		schedule_cdb_store(BT_MESH_CDB_NODES_PENDING);
 		return;
 	}
 
-	if (!free_slot) {
+	if (cdb_node_update_cnt == ARRAY_SIZE(cdb_node_updates)) {
 		if (store) {
 			store_cdb_node(node);
 		} else {
@@ -597,104 +664,118 @@ static void update_cdb_node_settings(const struct bt_mesh_cdb_node *node,
 		return;
 	}
 
-	free_slot->addr = node->addr;
-	free_slot->clear = !store;
+	memmove(&cdb_node_updates[pos + 1], &cdb_node_updates[pos],
+		(cdb_node_update_cnt - pos) * sizeof(cdb_node_updates[0]));
+	cdb_node_update_cnt++;
+
+	update = &cdb_node_updates[pos];
+	update->addr = node->addr;
+	update->clear = !store;
 
 	schedule_cdb_store(BT_MESH_CDB_NODES_PENDING);
 }
 
-static struct key_update *cdb_key_update_find(bool app_key, uint16_t key_idx,
-					      struct key_update **free_slot)
+static uint16_t key_update_order(bool app_key, uint16_t key_idx)
 {
-	struct key_update *match;
-	int i;
+	return (app_key ? BIT(12) : 0) | key_idx;
+}
 
-	match = NULL;
-	*free_slot = NULL;
+/*
+ * Return the position of the pending update for the given key, or the
+ * position where it should be inserted. match is set if one exists.
+ */
+static uint16_t cdb_key_update_find(bool app_key, uint16_t key_idx,
+				    bool *match)
+{
+	uint16_t lo = 0, hi = cdb_key_update_cnt, mid;
+	uint16_t order = key_update_order(app_key, key_idx);
+	uint16_t cur;
 
-	for (i = 0; i < ARRAY_SIZE(cdb_key_updates); i++) {
-		struct key_update *update = &cdb_key_updates[i];
+	*match = false;
 
-		if (!update->valid) {
-			*free_slot = update;
-			continue;
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		cur = key_update_order(cdb_key_updates[mid].app_key,
+				       cdb_key_updates[mid].key_idx);
+
+		if (cur == order) {
+			*match = true;
+			return mid;
 		}
 
-		if (update->app_key != app_key) {
-			continue;
+		if (cur < order) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
 		}
+	}
+
+	return lo;
+}
 
-		if (update->key_idx == key_idx) {
-			match = update;
+/*
+ * Queue a key update, coalescing it with any pending update for the same
+ * key. Returns -ENOMEM if the update could not be queued and the caller
+ * needs to write it through.
+ */
+static int cdb_key_update_add(bool app_key, uint16_t key_idx, bool store)
+{
+	struct key_update *update;
+	uint16_t pos;
+	bool match;
+
+	pos = cdb_key_update_find(app_key, key_idx, &match);
+	if (!match) {
+		if (cdb_key_update_cnt == ARRAY_SIZE(cdb_key_updates)) {
+			return -ENOMEM;
 		}
+
+		memmove(&cdb_key_updates[pos + 1], &cdb_key_updates[pos],
+			(cdb_key_update_cnt - pos) * sizeof(cdb_key_updates[0]));
+		cdb_key_update_cnt++;
+
+		cdb_key_updates[pos].key_idx = key_idx;
+		cdb_key_updates[pos].app_key = app_key;
 	}
 
-	return match;
+	update = &cdb_key_updates[pos];
+	update->clear = store ? 0U : 1U;
+
+	schedule_cdb_store(BT_MESH_CDB_KEYS_PENDING);
+
+	return 0;
 }
 
 static void update_cdb_subnet_settings(const struct bt_mesh_cdb_subnet *sub,
 				       bool store)
 {
-	struct key_update *update, *free_slot;
-	uint8_t clear = store ? 0U : 1U;
-
 	BT_DBG("NetKeyIndex 0x%03x", sub->net_idx);
 
-	update = cdb_key_update_find(false, sub->net_idx, &free_slot);
-	if (update) {
-		update->clear = clear;
-		schedule_cdb_store(BT_MESH_CDB_KEYS_PENDING);
+	if (!cdb_key_update_add(false, sub->net_idx, store)) {
 		return;
 	}
 
-	if (!free_slot) {
-		if (store) {
-			store_cdb_subnet(sub);
-		} else {
-			clear_cdb_subnet(sub->net_idx);
-		}
-		return;
+	if (store) {
+		store_cdb_subnet(sub);
+	} else {
+		clear_cdb_subnet(sub->net_idx);
 	}
-
-	free_slot->valid = 1U;
-	free_slot->key_idx = sub->net_idx;
-	free_slot->app_key = 0U;
-	free_slot->clear = clear;
-
-	schedule_cdb_store(BT_MESH_CDB_KEYS_PENDING);
 }
 
 static void update_cdb_app_key_settings(const struct bt_mesh_cdb_app_key *key,
 					bool store)
 {
-	struct key_update *update, *free_slot;
-	uint8_t clear = store ? 0U : 1U;
-
 	BT_DBG("AppKeyIndex 0x%03x", key->app_idx);
 
-	update = cdb_key_update_find(true, key->app_idx, &free_slot);
-	if (update) {
-		update->clear = clear;
-		schedule_cdb_store(BT_MESH_CDB_KEYS_PENDING);
+	if (!cdb_key_update_add(true, key->app_idx, store)) {
 		return;
 	}
 
-	if (!free_slot) {
-		if (store) {
-			store_cdb_app_key(key);
-		} else {
-			clear_cdb_app_key(key->app_idx);
-		}
-
-		return;
+	if (store) {
+		store_cdb_app_key(key);
+	} else {
+		clear_cdb_app_key(key->app_idx);
 	}
-
-	free_slot->valid = 1U;
-	free_slot->key_idx = key->app_idx;
-	free_slot->app_key = 1U;
-	free_slot->clear = clear;
-
-	schedule_cdb_store(BT_MESH_CDB_KEYS_PENDING);
 }
 
 int bt_mesh_cdb_create(const uint8_t key[16])
@@ -839,10 +920,14 @@ uint8_t bt_mesh_cdb_subnet_flags(const struct bt_mesh_cdb_subnet *sub)
 struct bt_mesh_cdb_node *bt_mesh_cdb_node_alloc(const uint8_t uuid[16], uint16_t addr,
 						uint8_t num_elem, uint16_t net_idx)
 {
-	int i;
+	uint16_t i, slot;
+
+	if (cdb_node_cnt == ARRAY_SIZE(bt_mesh_cdb.nodes)) {
+		return NULL;
+	}
 
 	if (addr == BT_MESH_ADDR_UNASSIGNED) {
-        addr = find_lowest_free_addr(num_elem);
+		addr = find_lowest_free_addr(num_elem);
 		if (addr == BT_MESH_ADDR_UNASSIGNED) {
 			return NULL;
 		}
@@ -853,7 +938,10 @@ struct bt_mesh_cdb_node *bt_mesh_cdb_node_alloc(const uint8_t uuid[16], uint16_t
 	}
 
 	for (i = 0; i < ARRAY_SIZE(bt_mesh_cdb.nodes); i++) {
-		struct bt_mesh_cdb_node *node = &bt_mesh_cdb.nodes[i];
+		struct bt_mesh_cdb_node *node;
+
+		slot = (cdb_node_free_hint + i) % ARRAY_SIZE(bt_mesh_cdb.nodes);
+		node = &bt_mesh_cdb.nodes[slot];
 
 		if (node->addr == BT_MESH_ADDR_UNASSIGNED) {
 			memcpy(node->uuid, uuid, 16);
@@ -861,6 +949,8 @@ struct bt_mesh_cdb_node *bt_mesh_cdb_node_alloc(const uint8_t uuid[16], uint16_t
 			node->num_elem = num_elem;
 			node->net_idx = net_idx;
 			atomic_set(node->flags, 0);
+			node_idx_insert(node);
+			cdb_node_free_hint = slot + 1;
 			return node;
 		}
 	}
@@ -876,21 +966,28 @@ void bt_mesh_cdb_node_del(struct bt_mesh_cdb_node *node, bool store)
 		update_cdb_node_settings(node, false);
 	}
 
+	if (node->addr != BT_MESH_ADDR_UNASSIGNED) {
+		node_idx_remove(node);
+		cdb_node_free_hint = node - bt_mesh_cdb.nodes;
+	}
+
 	node->addr = BT_MESH_ADDR_UNASSIGNED;
 	memset(node->dev_key, 0, sizeof(node->dev_key));
 }
 
 struct bt_mesh_cdb_node *bt_mesh_cdb_node_get(uint16_t addr)
 {
-	int i;
+	struct bt_mesh_cdb_node *node;
+	uint16_t pos;
 
-	for (i = 0; i < ARRAY_SIZE(bt_mesh_cdb.nodes); i++) {
-		struct bt_mesh_cdb_node *node = &bt_mesh_cdb.nodes[i];
+	pos = node_idx_upper(addr);
+	if (pos == 0) {
+		return NULL;
+	}
 
-		if (addr >= node->addr &&
-		    addr <= node->addr + node->num_elem - 1) {
-			return node;
-		}
+	node = &bt_mesh_cdb.nodes[cdb_node_idx[pos - 1]];
+	if (addr <= node->addr + node->num_elem - 1) {
+		return node;
 	}
 
 	return NULL;
@@ -1024,13 +1121,9 @@ static void store_cdb_pending_nodes(void)
 {
 	int i;
 
-	for (i = 0; i < ARRAY_SIZE(cdb_node_updates); ++i) {
+	for (i = 0; i < cdb_node_update_cnt; ++i) {
 		struct node_update *update = &cdb_node_updates[i];
 
-		if (update->addr == BT_MESH_ADDR_UNASSIGNED) {
-			continue;
-		}
-
 		BT_DBG("addr: 0x%04x, clear: %d", update->addr, update->clear);
 
 		if (update->clear) {
@@ -1045,22 +1138,18 @@ static void store_cdb_pending_nodes(void)
 				BT_WARN("Node 0x%04x not found", update->addr);
 			}
 		}
-
-		update->addr = BT_MESH_ADDR_UNASSIGNED;
 	}
+
+	cdb_node_update_cnt = 0;
 }
 
 static void store_cdb_pending_keys(void)
 {
 	int i;
 
-	for (i = 0; i < ARRAY_SIZE(cdb_key_updates); i++) {
+	for (i = 0; i < cdb_key_update_cnt; i++) {
 		struct key_update *update = &cdb_key_updates[i];
 
-		if (!update->valid) {
-			continue;
-		}
-
 		if (update->clear) {
 			if (update->app_key) {
 				clear_cdb_app_key(update->key_idx);
@@ -1090,9 +1179,9 @@ static void store_cdb_pending_keys(void)
 				}
 			}
 		}
-
-		update->valid = 0U;
 	}
+
+	cdb_key_update_cnt = 0;
 }
 
 void bt_mesh_cdb_pending_store(void)
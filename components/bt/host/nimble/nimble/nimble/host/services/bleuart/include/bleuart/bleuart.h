@@ -33,7 +33,63 @@ bleuart_gatt_svr_init(void);
 void
 bleuart_set_conn_handle(uint16_t conn_handle);
 
+struct ble_gap_event;
+
+/**
+ * Called when data has been received on a connection; the data is retrieved
+ * with bleuart_read().
+ */
+typedef void bleuart_rx_fn(uint16_t conn_handle, void *arg);
+
+/**
+ * Queues data for transmission as notifications on the given connection.
+ *
+ * @return                      The number of bytes queued, which is less
+ *                                  than len if the TX buffer is full;
+ *                                  -BLE_HS_ENOTCONN if the connection is
+ *                                  unknown to the service.  Errors are
+ *                                  negative so that they cannot be
+ *                                  mistaken for a byte count.
+ */
+int
+bleuart_write(uint16_t conn_handle, const void *data, uint16_t len);
+
+/**
+ * Reads received data from the given connection.  Freed buffer space is
+ * granted back to the peer when credit based flow control is in use.
+ *
+ * @return                      The number of bytes read;
+ *                                  -BLE_HS_ENOTCONN if the connection is
+ *                                  unknown to the service.
+ */
+int
+bleuart_read(uint16_t conn_handle, void *buf, uint16_t max_len);
+
+/**
+ * Returns the free space in the TX buffer of the given connection.
+ */
+uint16_t
+bleuart_tx_space(uint16_t conn_handle);
+
+/**
+ * Sets the callback invoked when data is received.  If no callback is set,
+ * received data is written to the console.
+ */
+void
+bleuart_set_rx_cb(bleuart_rx_fn *cb, void *arg);
+
+/**
+ * GAP event handler for the service.  The application should pass its
+ * connection events here, in particular BLE_GAP_EVENT_CONNECT,
+ * BLE_GAP_EVENT_DISCONNECT, BLE_GAP_EVENT_MTU and BLE_GAP_EVENT_SUBSCRIBE.
+ *
+ * @return                      Always 0.
+ */
+int
+bleuart_gap_event(struct ble_gap_event *event, void *arg);
+
 extern const ble_uuid128_t gatt_svr_svc_uart_uuid;
+extern const ble_uuid128_t gatt_svr_chr_uart_credit_uuid;
 
 #ifdef __cplusplus
 }
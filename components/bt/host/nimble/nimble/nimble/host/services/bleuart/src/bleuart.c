@@ -29,6 +29,12 @@
 #include "os/endian.h"
 #include "console/console.h"
 #include "esp_nimble_mem.h"
+#ifndef MYNEWT
+#include "nimble/nimble_port.h"
+#endif
+
+/* Delay before retrying a transmission that failed for lack of buffers */
+#define BLEUART_TX_RETRY_MS     10
 
 /* ble uart attr read handle */
 uint16_t g_bleuart_attr_read_handle;
@@ -36,10 +42,57 @@ uint16_t g_bleuart_attr_read_handle;
 /* ble uart attr write handle */
 uint16_t g_bleuart_attr_write_handle;
 
+/* ble uart attr credit handle */
+uint16_t g_bleuart_attr_credit_handle;
+
 /* Pointer to a console buffer */
 char *console_buf;
 
-uint16_t g_console_conn_handle;
+uint16_t g_console_conn_handle = BLE_HS_CONN_HANDLE_NONE;
+
+/* Byte ring buffer used for the per-connection TX and RX streams */
+struct bleuart_ring {
+    uint8_t *buf;
+    uint16_t size;
+    uint16_t head;
+    uint16_t len;
+};
+
+struct bleuart_conn {
+    uint16_t conn_handle;
+    uint16_t mtu;
+
+    struct bleuart_ring tx;
+    struct bleuart_ring rx;
+
+    /* Bytes the peer allows us to send; only used with credit_fc. */
+    uint16_t tx_credits;
+
+    /* Bytes the peer is allowed to send us; only used with credit_fc. */
+    uint16_t rx_granted;
+
+    /* Set while the peer is subscribed to the credit characteristic. */
+    unsigned credit_fc:1;
+};
+
+static struct bleuart_conn bleuart_conns[MYNEWT_VAL(BLEUART_MAX_CONNS)];
+static uint8_t bleuart_tx_bufs[MYNEWT_VAL(BLEUART_MAX_CONNS)]
+                             [MYNEWT_VAL(BLEUART_TX_BUF_SIZE)];
+static uint8_t bleuart_rx_bufs[MYNEWT_VAL(BLEUART_MAX_CONNS)]
+                             [MYNEWT_VAL(BLEUART_RX_BUF_SIZE)];
+
+static bleuart_rx_fn *bleuart_rx_cb;
+static void *bleuart_rx_cb_arg;
+
+static struct ble_npl_event bleuart_tx_ev;
+static struct ble_npl_callout bleuart_tx_timer;
+
+/* Protects bleuart_conns and the rings.  The application fills and drains
+ * the rings from its own task while the host task sends and receives.  NPL
+ * mutexes are recursive, so the rx callback may call bleuart_read().
+ */
+static struct ble_npl_mutex bleuart_mutex;
+
 /**
  * The vendor specific "bleuart" service consists of one write no-rsp characteristic
  * and one notification only read charateristic
@@ -47,6 +100,11 @@ uint16_t g_console_conn_handle;
  *       over a non-encrypted connection
  *     o "read": a single-byte characteristic that can always be read only via
  *       notifications
+ *
+ * An optional third characteristic carries credit based flow control.  Once
+ * the peer subscribes to it, each side may only send as many bytes as the
+ * other side granted; grants are exchanged as 16-bit little endian byte
+ * counts (notified by us, written by the peer).
  */
 
 /* {6E400001-B5A3-F393-E0A9-E50E24DCCA9E} */
@@ -65,6 +123,11 @@ const ble_uuid128_t gatt_svr_chr_uart_read_uuid =
     BLE_UUID128_INIT(0x9e, 0xca, 0xdc, 0x24, 0x0e, 0xe5, 0xa9, 0xe0,
                      0x93, 0xf3, 0xa3, 0xb5, 0x03, 0x00, 0x40, 0x6e);
 
+/* {6E400004-B5A3-F393-E0A9-E50E24DCCA9E} */
+const ble_uuid128_t gatt_svr_chr_uart_credit_uuid =
+    BLE_UUID128_INIT(0x9e, 0xca, 0xdc, 0x24, 0x0e, 0xe5, 0xa9, 0xe0,
+                     0x93, 0xf3, 0xa3, 0xb5, 0x04, 0x00, 0x40, 0x6e);
+
 static int
 gatt_svr_chr_access_uart_write(uint16_t conn_handle, uint16_t attr_handle,
                               struct ble_gatt_access_ctxt *ctxt, void *arg);
@@ -85,6 +148,12 @@ static const struct ble_gatt_svc_def gatt_svr_svcs[] = {
             .access_cb = gatt_svr_chr_access_uart_write,
             .flags = BLE_GATT_CHR_F_WRITE | BLE_GATT_CHR_F_WRITE_NO_RSP,
             .val_handle = &g_bleuart_attr_write_handle,
+        }, {
+            /* Characteristic: Credits */
+            .uuid = &gatt_svr_chr_uart_credit_uuid.u,
+            .access_cb = gatt_svr_chr_access_uart_write,
+            .flags = BLE_GATT_CHR_F_NOTIFY | BLE_GATT_CHR_F_WRITE_NO_RSP,
+            .val_handle = &g_bleuart_attr_credit_handle,
         }, {
             0, /* No more characteristics in this service */
         } },
@@ -95,19 +164,354 @@ static const struct ble_gatt_svc_def gatt_svr_svcs[] = {
     },
 };
 
+static uint16_t
+bleuart_ring_free(const struct bleuart_ring *ring)
+{
+    return ring->size - ring->len;
+}
+
+static uint16_t
+bleuart_ring_put(struct bleuart_ring *ring, const uint8_t *data, uint16_t len)
+{
+    uint16_t pos;
+    uint16_t n;
+
+    if (len > bleuart_ring_free(ring)) {
+        len = bleuart_ring_free(ring);
+    }
+
+    pos = (ring->head + ring->len) % ring->size;
+    n = min(len, ring->size - pos);
+    memcpy(ring->buf + pos, data, n);
+    memcpy(ring->buf, data + n, len - n);
+    ring->len += len;
+
+    return len;
+}
+
+/**
+ * Returns the number of contiguous bytes at the head of the ring, pointing
+ * *data at them.
+ */
+static uint16_t
+bleuart_ring_peek(const struct bleuart_ring *ring, const uint8_t **data)
+{
+    *data = ring->buf + ring->head;
+    return min(ring->len, ring->size - ring->head);
+}
+
+static void
+bleuart_ring_consume(struct bleuart_ring *ring, uint16_t len)
+{
+    ring->head = (ring->head + len) % ring->size;
+    ring->len -= len;
+    if (ring->len == 0) {
+        ring->head = 0;
+    }
+}
+
+static void
+bleuart_lock(void)
+{
+    ble_npl_mutex_pend(&bleuart_mutex, BLE_NPL_TIME_FOREVER);
+}
+
+static void
+bleuart_unlock(void)
+{
+    ble_npl_mutex_release(&bleuart_mutex);
+}
+
+static struct bleuart_conn *
+bleuart_conn_find(uint16_t conn_handle)
+{
+    int i;
+
+    if (conn_handle == BLE_HS_CONN_HANDLE_NONE) {
+        return NULL;
+    }
+
+    for (i = 0; i < MYNEWT_VAL(BLEUART_MAX_CONNS); i++) {
+        if (bleuart_conns[i].conn_handle == conn_handle) {
+            return &bleuart_conns[i];
+        }
+    }
+
+    return NULL;
+}
+
+static struct bleuart_conn *
+bleuart_conn_add(uint16_t conn_handle)
+{
+    struct bleuart_conn *conn;
+    int i;
+
+    conn = bleuart_conn_find(conn_handle);
+    if (conn != NULL) {
+        return conn;
+    }
+
+    for (i = 0; i < MYNEWT_VAL(BLEUART_MAX_CONNS); i++) {
+        conn = &bleuart_conns[i];
+        if (conn->conn_handle == BLE_HS_CONN_HANDLE_NONE) {
+            memset(conn, 0, sizeof *conn);
+            conn->conn_handle = conn_handle;
+            conn->mtu = ble_att_mtu(conn_handle);
+            if (conn->mtu == 0) {
+                conn->mtu = BLE_ATT_MTU_DFLT;
+            }
+            conn->tx.buf = bleuart_tx_bufs[i];
+            conn->tx.size = MYNEWT_VAL(BLEUART_TX_BUF_SIZE);
+            conn->rx.buf = bleuart_rx_bufs[i];
+            conn->rx.size = MYNEWT_VAL(BLEUART_RX_BUF_SIZE);
+            return conn;
+        }
+    }
+
+    return NULL;
+}
+
+static struct ble_npl_eventq *
+bleuart_evq_get(void)
+{
+#ifdef MYNEWT
+    return (struct ble_npl_eventq *)os_eventq_dflt_get();
+#else
+    return nimble_port_get_dflt_eventq();
+#endif
+}
+
+static void
+bleuart_tx_sched(void)
+{
+    ble_npl_eventq_put(bleuart_evq_get(), &bleuart_tx_ev);
+}
+
+static void
+bleuart_tx_retry(void)
+{
+    if (!ble_npl_callout_is_active(&bleuart_tx_timer)) {
+        ble_npl_callout_reset(&bleuart_tx_timer,
+                              ble_npl_time_ms_to_ticks32(BLEUART_TX_RETRY_MS));
+    }
+}
+
+/**
+ * Grants the peer whatever RX buffer space is not yet covered by earlier
+ * grants.  Small grants are held back until at least half of the buffer is
+ * free, so that the peer sends full sized writes.
+ */
+static void
+bleuart_rx_grant(struct bleuart_conn *conn)
+{
+    struct os_mbuf *om;
+    uint16_t grant;
+    uint8_t buf[2];
+    int rc;
+
+    if (!conn->credit_fc) {
+        return;
+    }
+
+    grant = bleuart_ring_free(&conn->rx) - conn->rx_granted;
+    if (grant == 0 ||
+        (conn->rx_granted != 0 && grant < conn->rx.size / 2)) {
+        return;
+    }
+
+    put_le16(buf, grant);
+    om = ble_hs_mbuf_from_flat(buf, sizeof buf);
+    if (om == NULL) {
+        bleuart_tx_retry();
+        return;
+    }
+
+    rc = ble_gatts_notify_custom(conn->conn_handle,
+                                 g_bleuart_attr_credit_handle, om);
+    if (rc != 0) {
+        bleuart_tx_retry();
+        return;
+    }
+
+    conn->rx_granted += grant;
+}
+
+/**
+ * Sends queued TX data as MTU sized notifications.  The host hands each
+ * notification to its connection queue before returning, so the only back
+ * pressure is the mbuf pool; when it runs dry the pump retries on a timer.
+ * At most BLEUART_TX_WINDOW notifications are sent per pass so that other
+ * work on the event queue, such as completed packet events, is not starved.
+ */
+static void
+bleuart_tx_pump(struct bleuart_conn *conn)
+{
+    const uint8_t *data;
+    struct os_mbuf *om;
+    uint16_t chunk;
+    uint16_t n;
+    int sent;
+    int rc;
+
+    for (sent = 0; sent < MYNEWT_VAL(BLEUART_TX_WINDOW); sent++) {
+        if (conn->tx.len == 0) {
+            return;
+        }
+
+        chunk = min(conn->tx.len, conn->mtu - 3);
+        if (conn->credit_fc) {
+            chunk = min(chunk, conn->tx_credits);
+            if (chunk == 0) {
+                return;
+            }
+        }
+
+        om = ble_hs_mbuf_att_pkt();
+        if (om == NULL) {
+            bleuart_tx_retry();
+            return;
+        }
+
+        /* The chunk may wrap around the end of the ring. */
+        n = min(chunk, bleuart_ring_peek(&conn->tx, &data));
+        rc = os_mbuf_append(om, data, n);
+        if (rc == 0 && n < chunk) {
+            rc = os_mbuf_append(om, conn->tx.buf, chunk - n);
+        }
+        if (rc != 0) {
+            os_mbuf_free_chain(om);
+            bleuart_tx_retry();
+            return;
+        }
+
+        rc = ble_gatts_notify_custom(conn->conn_handle,
+                                     g_bleuart_attr_read_handle, om);
+        if (rc != 0) {
+            /* Keep the data and try again later. */
+            bleuart_tx_retry();
+            return;
+        }
+
+        bleuart_ring_consume(&conn->tx, chunk);
+        if (conn->credit_fc) {
+            conn->tx_credits -= chunk;
+        }
+    }
+
+    /* Burst limit reached; yield before sending more. */
+    if (conn->tx.len > 0) {
+        bleuart_tx_sched();
+    }
+}
+
+static void
+bleuart_tx_ev_fn(struct ble_npl_event *ev)
+{
+    struct bleuart_conn *conn;
+    int i;
+
+    bleuart_lock();
+    for (i = 0; i < MYNEWT_VAL(BLEUART_MAX_CONNS); i++) {
+        conn = &bleuart_conns[i];
+        if (conn->conn_handle != BLE_HS_CONN_HANDLE_NONE) {
+            bleuart_rx_grant(conn);
+            bleuart_tx_pump(conn);
+        }
+    }
+    bleuart_unlock();
+}
+
+/**
+ * Default RX sink: writes received data to the console.
+ */
+static void
+bleuart_rx_console(uint16_t conn_handle, void *arg)
+{
+    char buf[32];
+    int len;
+
+    while ((len = bleuart_read(conn_handle, buf, sizeof buf)) > 0) {
+        console_write(buf, len);
+    }
+    console_write("\n", 1);
+}
+
+static int
+bleuart_rx_credit(struct bleuart_conn *conn, struct os_mbuf *om)
+{
+    uint8_t buf[2];
+    uint32_t credits;
+
+    if (OS_MBUF_PKTLEN(om) != sizeof buf) {
+        return BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
+    }
+
+    os_mbuf_copydata(om, 0, sizeof buf, buf);
+    credits = conn->tx_credits + get_le16(buf);
+    conn->tx_credits = min(credits, UINT16_MAX);
+
+    if (conn->tx.len > 0) {
+        bleuart_tx_sched();
+    }
+
+    return 0;
+}
+
+static int
+bleuart_rx_data(struct bleuart_conn *conn, struct os_mbuf *om)
+{
+    uint8_t buf[32];
+    uint16_t len;
+    uint16_t off;
+    uint16_t n;
+
+    len = OS_MBUF_PKTLEN(om);
+    if (len > bleuart_ring_free(&conn->rx)) {
+        return BLE_ATT_ERR_INSUFFICIENT_RES;
+    }
+
+    for (off = 0; off < len; off += n) {
+        n = min(len - off, sizeof buf);
+        os_mbuf_copydata(om, off, n, buf);
+        bleuart_ring_put(&conn->rx, buf, n);
+    }
+
+    if (conn->credit_fc) {
+        conn->rx_granted -= min(conn->rx_granted, len);
+    }
+
+    return 0;
+}
+
 static int
 gatt_svr_chr_access_uart_write(uint16_t conn_handle, uint16_t attr_handle,
                                struct ble_gatt_access_ctxt *ctxt, void *arg)
 {
-    struct os_mbuf *om = ctxt->om;
+    struct bleuart_conn *conn;
+    int rc;
+
     switch (ctxt->op) {
         case BLE_GATT_ACCESS_OP_WRITE_CHR:
-              while(om) {
-                  console_write((char *)om->om_data, om->om_len);
-                  om = SLIST_NEXT(om, om_next);
-              }
-              console_write("\n", 1);
-              return 0;
+            bleuart_lock();
+            conn = bleuart_conn_add(conn_handle);
+            if (conn == NULL) {
+                rc = BLE_ATT_ERR_INSUFFICIENT_RES;
+            } else if (attr_handle == g_bleuart_attr_credit_handle) {
+                rc = bleuart_rx_credit(conn, ctxt->om);
+            } else {
+                rc = bleuart_rx_data(conn, ctxt->om);
+            }
+            bleuart_unlock();
+
+            /* Hand data to the application without holding the lock. */
+            if (rc == 0 && attr_handle != g_bleuart_attr_credit_handle) {
+                if (bleuart_rx_cb != NULL) {
+                    bleuart_rx_cb(conn_handle, bleuart_rx_cb_arg);
+                } else {
+                    bleuart_rx_console(conn_handle, NULL);
+                }
+            }
+            return rc;
         default:
             assert(0);
             return BLE_ATT_ERR_UNLIKELY;
@@ -139,37 +543,157 @@ err:
     return rc;
 }
 
+int
+bleuart_write(uint16_t conn_handle, const void *data, uint16_t len)
+{
+    struct bleuart_conn *conn;
+
+    bleuart_lock();
+    conn = bleuart_conn_find(conn_handle);
+    if (conn == NULL) {
+        bleuart_unlock();
+        return -BLE_HS_ENOTCONN;
+    }
+
+    len = bleuart_ring_put(&conn->tx, data, len);
+    bleuart_unlock();
+
+    if (len > 0) {
+        bleuart_tx_sched();
+    }
+
+    return len;
+}
+
+int
+bleuart_read(uint16_t conn_handle, void *buf, uint16_t max_len)
+{
+    struct bleuart_conn *conn;
+    const uint8_t *data;
+    uint16_t off;
+    uint16_t n;
+    int grant;
+
+    bleuart_lock();
+    conn = bleuart_conn_find(conn_handle);
+    if (conn == NULL) {
+        bleuart_unlock();
+        return -BLE_HS_ENOTCONN;
+    }
+
+    for (off = 0; off < max_len && conn->rx.len > 0; off += n) {
+        n = min(max_len - off, bleuart_ring_peek(&conn->rx, &data));
+        memcpy((uint8_t *)buf + off, data, n);
+        bleuart_ring_consume(&conn->rx, n);
+    }
+    grant = off > 0 && conn->credit_fc;
+    bleuart_unlock();
+
+    /* Freed space is granted to the peer from the host task. */
+    if (grant) {
+        bleuart_tx_sched();
+    }
+
+    return off;
+}
+
+uint16_t
+bleuart_tx_space(uint16_t conn_handle)
+{
+    struct bleuart_conn *conn;
+    uint16_t space;
+
+    bleuart_lock();
+    conn = bleuart_conn_find(conn_handle);
+    if (conn == NULL) {
+        space = 0;
+    } else {
+        space = bleuart_ring_free(&conn->tx);
+    }
+    bleuart_unlock();
+
+    return space;
+}
+
+void
+bleuart_set_rx_cb(bleuart_rx_fn *cb, void *arg)
+{
+    bleuart_rx_cb = cb;
+    bleuart_rx_cb_arg = arg;
+}
+
+int
+bleuart_gap_event(struct ble_gap_event *event, void *arg)
+{
+    struct bleuart_conn *conn;
+
+    bleuart_lock();
+
+    switch (event->type) {
+    case BLE_GAP_EVENT_CONNECT:
+        if (event->connect.status == 0) {
+            bleuart_conn_add(event->connect.conn_handle);
+        }
+        break;
+
+    case BLE_GAP_EVENT_DISCONNECT:
+        conn = bleuart_conn_find(event->disconnect.conn.conn_handle);
+        if (conn != NULL) {
+            conn->conn_handle = BLE_HS_CONN_HANDLE_NONE;
+        }
+        if (g_console_conn_handle == event->disconnect.conn.conn_handle) {
+            g_console_conn_handle = BLE_HS_CONN_HANDLE_NONE;
+        }
+        break;
+
+    case BLE_GAP_EVENT_MTU:
+        conn = bleuart_conn_find(event->mtu.conn_handle);
+        if (conn != NULL) {
+            conn->mtu = event->mtu.value;
+        }
+        break;
+
+    case BLE_GAP_EVENT_SUBSCRIBE:
+        if (event->subscribe.attr_handle != g_bleuart_attr_credit_handle) {
+            break;
+        }
+        conn = bleuart_conn_add(event->subscribe.conn_handle);
+        if (conn != NULL) {
+            conn->credit_fc = event->subscribe.cur_notify;
+            conn->tx_credits = 0;
+            conn->rx_granted = 0;
+            bleuart_tx_sched();
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    bleuart_unlock();
+
+    return 0;
+}
+
 /**
- * Reads console and sends data over BLE
+ * Reads console input as it becomes available and queues it for
+ * transmission.  Input is not held back until a full line is entered; if the
+ * TX buffer is full the excess is dropped.
  */
 static void
 bleuart_uart_read(void)
 {
-    int rc;
-    int off;
     int full_line;
-    struct os_mbuf *om;
+    int rc;
 
-    off = 0;
     while (1) {
-        rc = console_read(console_buf + off,
-                          MYNEWT_VAL(BLEUART_MAX_INPUT) - off, &full_line);
-        if (rc <= 0 && !full_line) {
-            continue;
-        }
-        off += rc;
-        if (!full_line) {
-            continue;
+        rc = console_read(console_buf, MYNEWT_VAL(BLEUART_MAX_INPUT),
+                          &full_line);
+        if (rc <= 0) {
+            break;
         }
 
-        om = ble_hs_mbuf_from_flat(console_buf, off);
-        if (!om) {
-            return;
-        }
-        ble_gatts_notify_custom(g_console_conn_handle,
-                                g_bleuart_attr_read_handle, om);
-        off = 0;
-        break;
+        bleuart_write(g_console_conn_handle, console_buf, rc);
     }
 }
 
@@ -180,7 +704,10 @@ bleuart_uart_read(void)
  */
 void
 bleuart_set_conn_handle(uint16_t conn_handle) {
+    bleuart_lock();
     g_console_conn_handle = conn_handle;
+    bleuart_conn_add(conn_handle);
+    bleuart_unlock();
 }
 
 /**
@@ -192,10 +719,22 @@ void
 bleuart_init(void)
 {
     int rc;
+    int i;
 
     /* Ensure this function only gets called by sysinit. */
     SYSINIT_ASSERT_ACTIVE();
 
+    for (i = 0; i < MYNEWT_VAL(BLEUART_MAX_CONNS); i++) {
+        bleuart_conns[i].conn_handle = BLE_HS_CONN_HANDLE_NONE;
+    }
+
+    rc = ble_npl_mutex_init(&bleuart_mutex);
+    SYSINIT_PANIC_ASSERT(rc == 0);
+
+    ble_npl_event_init(&bleuart_tx_ev, bleuart_tx_ev_fn, NULL);
+    ble_npl_callout_init(&bleuart_tx_timer, bleuart_evq_get(),
+                         bleuart_tx_ev_fn, NULL);
+
     rc = console_init(bleuart_uart_read);
     SYSINIT_PANIC_ASSERT(rc == 0);
 
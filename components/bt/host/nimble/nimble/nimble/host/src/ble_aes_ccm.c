@@ -6,6 +6,8 @@
 
 #include <inttypes.h>
 #include <stddef.h>
+#include <string.h>
+#include <stdbool.h>
 #include "host/ble_aes_ccm.h"
 #include "../src/ble_hs_conn_priv.h"
 
@@ -109,154 +111,230 @@ static inline void xor16(uint8_t *dst, const uint8_t *a, const uint8_t *b)
     dst[15] = a[15] ^ b[15];
 }
 
-/* pmsg is assumed to have the nonce already present in bytes 1-13 */
-static int ble_aes_ccm_calculate_X0(const uint8_t key[16], const uint8_t *aad, uint8_t aad_len,
-                                    size_t mic_size, uint8_t msg_len, uint8_t b[16],
-                                    uint8_t X0[16])
+int
+ble_aes_ccm_ctx_init(struct ble_aes_ccm_ctx *ctx, const uint8_t key[16])
 {
-    int i, j, err;
+#if MYNEWT_VAL(BLE_CRYPTO_STACK_MBEDTLS)
+    mbedtls_aes_init(&ctx->aes);
 
-    /* X_0 = e(AppKey, flags || nonce || length) */
-    b[0] = (((mic_size - 2) / 2) << 3) | ((!!aad_len) << 6) | 0x01;
+    if (mbedtls_aes_setkey_enc(&ctx->aes, key, 128) != 0) {
+        mbedtls_aes_free(&ctx->aes);
+        return BLE_HS_EUNKNOWN;
+    }
+#else
+    if (tc_aes128_set_encrypt_key(&ctx->sched, key) == TC_CRYPTO_FAIL) {
+        return BLE_HS_EUNKNOWN;
+    }
+#endif
+
+    return 0;
+}
+
+void
+ble_aes_ccm_ctx_free(struct ble_aes_ccm_ctx *ctx)
+{
+#if MYNEWT_VAL(BLE_CRYPTO_STACK_MBEDTLS)
+    mbedtls_aes_free(&ctx->aes);
+#else
+    memset(&ctx->sched, 0, sizeof ctx->sched);
+#endif
+}
+
+static int
+ble_aes_ccm_ctx_block(struct ble_aes_ccm_ctx *ctx, const uint8_t in[16],
+                      uint8_t out[16])
+{
+#if MYNEWT_VAL(BLE_CRYPTO_STACK_MBEDTLS)
+    if (mbedtls_aes_crypt_ecb(&ctx->aes, MBEDTLS_AES_ENCRYPT, in, out) != 0) {
+        return BLE_HS_EUNKNOWN;
+    }
+#else
+    if (tc_aes_encrypt(out, in, &ctx->sched) == TC_CRYPTO_FAIL) {
+        return BLE_HS_EUNKNOWN;
+    }
+#endif
 
+    return 0;
+}
+
+/* X_0 = e(key, flags || nonce || length), followed by CBC-MAC over AAD */
+static int
+ble_aes_ccm_mac_start(struct ble_aes_ccm_ctx *ctx, const uint8_t nonce[13],
+                      const uint8_t *aad, size_t aad_len, size_t mic_size,
+                      size_t msg_len, uint8_t X[16])
+{
+    uint8_t b[16];
+    size_t i;
+    size_t j;
+    int err;
+
+    b[0] = (((mic_size - 2) / 2) << 3) | ((!!aad_len) << 6) | 0x01;
+    memcpy(b + 1, nonce, 13);
     sys_put_be16(msg_len, b + 14);
 
-    err = ble_aes_ccm_encrypt_be(key, b, X0);
+    err = ble_aes_ccm_ctx_block(ctx, b, X);
     if (err) {
         return err;
     }
 
-    /* If AAD is being used to authenticate, include it here */
-    if (aad_len) {
-        sys_put_be16(aad_len, b);
+    if (!aad_len) {
+        return 0;
+    }
 
-        for (i = 0; i < sizeof(uint16_t); i++) {
-            b[i] = X0[i] ^ b[i];
-        }
+    /* First AAD block is prefixed with 2 bytes of AAD length */
+    sys_put_be16(aad_len, b);
+    i = 2;
+    j = 0;
 
-        j = 0;
-        aad_len += sizeof(uint16_t);
-        while (aad_len > 16) {
-            do {
-                b[i] = X0[i] ^ aad[j];
-                i++, j++;
-            } while (i < 16);
+    while (j < aad_len) {
+        b[i++] = aad[j++];
 
-            aad_len -= 16;
-            i = 0;
+        if (i == 16 || j == aad_len) {
+            /* Zero padding of last AAD block */
+            memset(b + i, 0, 16 - i);
+            xor16(b, b, X);
 
-            err = ble_aes_ccm_encrypt_be(key, b, X0);
+            err = ble_aes_ccm_ctx_block(ctx, b, X);
             if (err) {
                 return err;
             }
-        }
-
-        for (; i < aad_len; i++, j++) {
-            b[i] = X0[i] ^ aad[j];
-        }
-
-        for (i = aad_len; i < 16; i++) {
-            b[i] = X0[i];
-        }
 
-        err = ble_aes_ccm_encrypt_be(key, b, X0);
-        if (err) {
-            return err;
+            i = 0;
         }
     }
 
     return 0;
 }
 
-static int ble_aes_ccm_auth(const uint8_t key[16], uint8_t nonce[13],
-                            const uint8_t *cleartext_msg, size_t msg_len, const uint8_t *aad,
-                            size_t aad_len, uint8_t *mic, size_t mic_size)
+/**
+ * Single pass over the message: for each block CTR keystream is generated and
+ * CBC-MAC is updated with the cleartext block, so message is read only once
+ * and may be processed in place.
+ */
+static int
+ble_aes_ccm_ctx_process(struct ble_aes_ccm_ctx *ctx, const uint8_t nonce[13],
+                        const uint8_t *in_msg, size_t msg_len,
+                        const uint8_t *aad, size_t aad_len,
+                        uint8_t *out_msg, uint8_t *mic, size_t mic_size,
+                        bool decrypt)
 {
-    uint8_t b[16], Xn[16], s0[16];
-    uint16_t blk_cnt, last_blk;
-    int err, j, i;
-
-    last_blk = msg_len % 16;
-    blk_cnt = (msg_len + 15) / 16;
-    if (!last_blk) {
-        last_blk = 16U;
-    }
-
-    b[0] = 0x01;
-    memcpy(b + 1, nonce, 13);
+    uint8_t a_i[16];
+    uint8_t s_i[16];
+    uint8_t X[16];
+    uint8_t b[16];
+    const uint8_t *clear;
+    size_t blk_len;
+    size_t off;
+    size_t i;
+    uint16_t ctr;
+    int err;
 
-    /* S[0] = e(AppKey, 0x01 || nonce || 0x0000) */
-    sys_put_be16(0x0000, &b[14]);
+    if (aad_len >= 0xff00 || mic_size > 16 || mic_size < 4 || mic_size & 1 ||
+        msg_len > 0xffff) {
+        return BLE_HS_EINVAL;
+    }
 
-    err = ble_aes_ccm_encrypt_be(key, b, s0);
+    err = ble_aes_ccm_mac_start(ctx, nonce, aad, aad_len, mic_size, msg_len, X);
     if (err) {
         return err;
     }
 
-    ble_aes_ccm_calculate_X0(key, aad, aad_len, mic_size, msg_len, b, Xn);
+    a_i[0] = 0x01;
+    memcpy(&a_i[1], nonce, 13);
+
+    for (off = 0, ctr = 1; off < msg_len; off += blk_len, ctr++) {
+        blk_len = min(msg_len - off, 16);
+
+        /* S_i = e(key, 0x01 || nonce || i) */
+        sys_put_be16(ctr, &a_i[14]);
+        err = ble_aes_ccm_ctx_block(ctx, a_i, s_i);
+        if (err) {
+            return err;
+        }
 
-    for (j = 0; j < blk_cnt; j++) {
-        /* X_1 = e(AppKey, X_0 ^ Payload[0-15]) */
-        if (j + 1 == blk_cnt) {
-            for (i = 0; i < last_blk; i++) {
-                b[i] = Xn[i] ^ cleartext_msg[(j * 16) + i];
+        if (decrypt) {
+            /* Decrypt first; MAC is calculated over cleartext */
+            for (i = 0; i < blk_len; i++) {
+                out_msg[off + i] = in_msg[off + i] ^ s_i[i];
             }
+            clear = &out_msg[off];
+        } else {
+            clear = &in_msg[off];
+        }
 
-            memcpy(&b[i], &Xn[i], 16 - i);
+        if (blk_len == 16) {
+            xor16(b, X, clear);
         } else {
-            xor16(b, Xn, &cleartext_msg[j * 16]);
+            for (i = 0; i < blk_len; i++) {
+                b[i] = X[i] ^ clear[i];
+            }
+            memcpy(&b[i], &X[i], 16 - i);
         }
 
-        err = ble_aes_ccm_encrypt_be(key, b, Xn);
+        err = ble_aes_ccm_ctx_block(ctx, b, X);
         if (err) {
             return err;
         }
+
+        if (!decrypt) {
+            for (i = 0; i < blk_len; i++) {
+                out_msg[off + i] = in_msg[off + i] ^ s_i[i];
+            }
+        }
+    }
+
+    /* S_0 = e(key, 0x01 || nonce || 0x0000); MIC = S_0 ^ X_n */
+    sys_put_be16(0x0000, &a_i[14]);
+    err = ble_aes_ccm_ctx_block(ctx, a_i, s_i);
+    if (err) {
+        return err;
     }
 
-    /* MIC = C_mic ^ X_1 */
     for (i = 0; i < mic_size; i++) {
-        mic[i] = s0[i] ^ Xn[i];
+        mic[i] = s_i[i] ^ X[i];
     }
 
     return 0;
 }
 
-static int ble_aes_ccm_crypt(const uint8_t key[16], const uint8_t nonce[13],
-                             const uint8_t *in_msg, uint8_t *out_msg, size_t msg_len)
+int
+ble_aes_ccm_ctx_encrypt(struct ble_aes_ccm_ctx *ctx, const uint8_t nonce[13],
+                        const uint8_t *msg, size_t msg_len,
+                        const uint8_t *aad, size_t aad_len,
+                        uint8_t *out_msg, size_t mic_size)
 {
-    uint8_t a_i[16], s_i[16];
-    uint16_t last_blk, blk_cnt;
-    size_t i, j;
+    return ble_aes_ccm_ctx_process(ctx, nonce, msg, msg_len, aad, aad_len,
+                                   out_msg, out_msg + msg_len, mic_size,
+                                   false);
+}
+
+int
+ble_aes_ccm_ctx_decrypt(struct ble_aes_ccm_ctx *ctx, const uint8_t nonce[13],
+                        const uint8_t *enc_msg, size_t msg_len,
+                        const uint8_t *aad, size_t aad_len,
+                        uint8_t *out_msg, size_t mic_size)
+{
+    uint8_t mic[16];
+    uint8_t diff;
+    size_t i;
     int err;
 
-    last_blk = msg_len % 16;
-    blk_cnt = (msg_len + 15) / 16;
-    if (!last_blk) {
-        last_blk = 16U;
+    err = ble_aes_ccm_ctx_process(ctx, nonce, enc_msg, msg_len, aad, aad_len,
+                                  out_msg, mic, mic_size, true);
+    if (err) {
+        return err;
     }
 
-    a_i[0] = 0x01;
-    memcpy(&a_i[1], nonce, 13);
-
-    for (j = 0; j < blk_cnt; j++) {
-        /* S_1 = e(AppKey, 0x01 || nonce || 0x0001) */
-        sys_put_be16(j + 1, &a_i[14]);
-
-        err = ble_aes_ccm_encrypt_be(key, a_i, s_i);
-        if (err) {
-            return err;
-        }
+    /* Constant time MIC comparison */
+    diff = 0;
+    for (i = 0; i < mic_size; i++) {
+        diff |= mic[i] ^ enc_msg[msg_len + i];
+    }
 
-        /* Encrypted = Payload[0-15] ^ C_1 */
-        if (j < blk_cnt - 1) {
-            xor16(&out_msg[j * 16], s_i, &in_msg[j * 16]);
-        } else {
-            for (i = 0; i < last_blk; i++) {
-                out_msg[(j * 16) + i] =
-                    in_msg[(j * 16) + i] ^ s_i[i];
-            }
-        }
+    if (diff) {
+        return BLE_HS_EAUTHEN;
     }
+
     return 0;
 }
 
@@ -264,40 +342,40 @@ int ble_aes_ccm_decrypt(const uint8_t key[16], uint8_t nonce[13], const uint8_t
                         size_t msg_len, const uint8_t *aad, size_t aad_len,
                         uint8_t *out_msg, size_t mic_size)
 {
-    uint8_t mic[16];
+    struct ble_aes_ccm_ctx ctx;
+    int err;
 
-    if (aad_len >= 0xff00 || mic_size > sizeof(mic)) {
-        return BLE_HS_EINVAL;
+    err = ble_aes_ccm_ctx_init(&ctx, key);
+    if (err) {
+        return err;
     }
 
-    ble_aes_ccm_crypt(key, nonce, enc_msg, out_msg, msg_len);
-
-    ble_aes_ccm_auth(key, nonce, out_msg, msg_len, aad, aad_len, mic, mic_size);
+    err = ble_aes_ccm_ctx_decrypt(&ctx, nonce, enc_msg, msg_len, aad, aad_len,
+                                  out_msg, mic_size);
 
-    /*if (memcmp(mic, enc_msg + msg_len, mic_size)) {
-        printf("\n%s return here", __func__);
-        return -EBADMSG;
-    }*/
+    ble_aes_ccm_ctx_free(&ctx);
 
-    return 0;
+    return err;
 }
 
 int ble_aes_ccm_encrypt(const uint8_t key[16], uint8_t nonce[13], const uint8_t *msg,
                         size_t msg_len, const uint8_t *aad, size_t aad_len,
                         uint8_t *out_msg, size_t mic_size)
 {
-    uint8_t *mic = out_msg + msg_len;
+    struct ble_aes_ccm_ctx ctx;
+    int err;
 
-    /* Unsupported AAD size */
-    if (aad_len >= 0xff00 || mic_size > 16) {
-        return BLE_HS_EINVAL;
+    err = ble_aes_ccm_ctx_init(&ctx, key);
+    if (err) {
+        return err;
     }
 
-    ble_aes_ccm_auth(key, nonce, out_msg, msg_len, aad, aad_len, mic, mic_size);
+    err = ble_aes_ccm_ctx_encrypt(&ctx, nonce, msg, msg_len, aad, aad_len,
+                                  out_msg, mic_size);
 
-    ble_aes_ccm_crypt(key, nonce, msg, out_msg, msg_len);
+    ble_aes_ccm_ctx_free(&ctx);
 
-    return 0;
+    return err;
 }
 
 #endif /* ENC_ADV_DATA */
@@ -190,6 +190,7 @@ ble_att_svr_find_by_uuid(struct ble_att_svr_entry *start_at,
                          const ble_uuid_t *uuid,
                          uint16_t end_handle);
 uint16_t ble_att_svr_prev_handle(void);
+void ble_att_svr_index_build(void);
 int ble_att_svr_rx_mtu(uint16_t conn_handle, struct os_mbuf **rxom);
 struct ble_att_svr_entry *ble_att_svr_find_by_handle(uint16_t handle_id);
 int32_t ble_att_svr_ticks_until_tmo(const struct ble_att_svr_conn *svr,
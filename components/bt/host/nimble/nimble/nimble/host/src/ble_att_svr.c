@@ -63,6 +63,163 @@ static os_membuf_t ble_att_svr_prep_entry_mem[
 
 static struct os_mempool ble_att_svr_prep_entry_pool;
 
+#if MYNEWT_VAL(BLE_ATT_SVR_UUID_INDEX)
+/**
+ * Sorted views of the visible attribute list.  The UUID index is ordered by
+ * (UUID key, handle) and the handle index by handle, so lookups reduce to a
+ * binary search.  Any change to the attribute list invalidates the index;
+ * lookups walk the list until ble_att_svr_index_build() is called again.
+ */
+struct ble_att_svr_idx_ent {
+    uint32_t key;
+    struct ble_att_svr_entry *entry;
+};
+
+static struct ble_att_svr_idx_ent *ble_att_svr_uuid_idx;
+static struct ble_att_svr_entry **ble_att_svr_handle_idx;
+static int ble_att_svr_idx_cap;
+static int ble_att_svr_idx_cnt;
+static uint8_t ble_att_svr_idx_valid;
+
+static void
+ble_att_svr_index_invalidate(void)
+{
+    ble_att_svr_idx_valid = 0;
+}
+
+static void
+ble_att_svr_index_free(void)
+{
+    nimble_platform_mem_free(ble_att_svr_uuid_idx);
+    nimble_platform_mem_free(ble_att_svr_handle_idx);
+    ble_att_svr_uuid_idx = NULL;
+    ble_att_svr_handle_idx = NULL;
+    ble_att_svr_idx_cap = 0;
+    ble_att_svr_idx_cnt = 0;
+    ble_att_svr_idx_valid = 0;
+}
+
+static int
+ble_att_svr_idx_ent_cmp(const void *a, const void *b)
+{
+    const struct ble_att_svr_idx_ent *ea = a;
+    const struct ble_att_svr_idx_ent *eb = b;
+
+    if (ea->key != eb->key) {
+        return ea->key < eb->key ? -1 : 1;
+    }
+
+    return (int)ea->entry->ha_handle_id - (int)eb->entry->ha_handle_id;
+}
+
+/**
+ * Returns the position of the first indexed attribute whose handle is
+ * greater than or equal to the specified one.
+ */
+static int
+ble_att_svr_index_handle_pos(uint16_t handle_id)
+{
+    int lo;
+    int hi;
+    int mid;
+
+    lo = 0;
+    hi = ble_att_svr_idx_cnt;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (ble_att_svr_handle_idx[mid]->ha_handle_id < handle_id) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+/**
+ * Returns the position of the first UUID index slot that is not ordered
+ * before (key, handle_id).
+ */
+static int
+ble_att_svr_index_uuid_pos(uint32_t key, uint32_t handle_id)
+{
+    const struct ble_att_svr_idx_ent *ent;
+    int lo;
+    int hi;
+    int mid;
+
+    lo = 0;
+    hi = ble_att_svr_idx_cnt;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        ent = ble_att_svr_uuid_idx + mid;
+        if (ent->key < key ||
+            (ent->key == key && ent->entry->ha_handle_id < handle_id)) {
+
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+#else
+#define ble_att_svr_index_invalidate()
+#endif
+
+/**
+ * Rebuilds the attribute lookup index from the current list of visible
+ * attributes.  If memory for the index cannot be allocated, lookups keep
+ * walking the attribute list.
+ */
+void
+ble_att_svr_index_build(void)
+{
+#if MYNEWT_VAL(BLE_ATT_SVR_UUID_INDEX)
+    struct ble_att_svr_entry *entry;
+    int cnt;
+    int i;
+
+    ble_att_svr_idx_valid = 0;
+
+    cnt = 0;
+    STAILQ_FOREACH(entry, &ble_att_svr_list, ha_next) {
+        cnt++;
+    }
+
+    if (cnt > ble_att_svr_idx_cap) {
+        ble_att_svr_index_free();
+
+        ble_att_svr_uuid_idx =
+            nimble_platform_mem_malloc(cnt * sizeof *ble_att_svr_uuid_idx);
+        ble_att_svr_handle_idx =
+            nimble_platform_mem_malloc(cnt * sizeof *ble_att_svr_handle_idx);
+        if (ble_att_svr_uuid_idx == NULL || ble_att_svr_handle_idx == NULL) {
+            ble_att_svr_index_free();
+            return;
+        }
+        ble_att_svr_idx_cap = cnt;
+    }
+
+    /* The attribute list is kept sorted by handle. */
+    i = 0;
+    STAILQ_FOREACH(entry, &ble_att_svr_list, ha_next) {
+        ble_att_svr_handle_idx[i] = entry;
+        ble_att_svr_uuid_idx[i].key = ble_uuid_hash(entry->ha_uuid);
+        ble_att_svr_uuid_idx[i].entry = entry;
+        i++;
+    }
+
+    qsort(ble_att_svr_uuid_idx, cnt, sizeof *ble_att_svr_uuid_idx,
+          ble_att_svr_idx_ent_cmp);
+
+    ble_att_svr_idx_cnt = cnt;
+    ble_att_svr_idx_valid = 1;
+#endif
+}
+
 static struct ble_att_svr_entry *
 ble_att_svr_entry_alloc(void)
 {
@@ -141,6 +298,7 @@ ble_att_svr_register(const ble_uuid_t *uuid, uint8_t flags,
     entry->ha_cb_arg = cb_arg;
 
     STAILQ_INSERT_TAIL(&ble_att_svr_list, entry, ha_next);
+    ble_att_svr_index_invalidate();
 
     if (handle_id != NULL) {
         *handle_id = entry->ha_handle_id;
@@ -163,6 +321,7 @@ int ble_att_svr_deregister(uint16_t start_handle, uint16_t end_group_handle) {
     struct ble_att_svr_entry *entry;
     for (idx = start_handle; idx <= end_group_handle; idx++) {
         entry = ble_att_svr_find_by_handle(idx);
+        ble_att_svr_index_invalidate();
         STAILQ_REMOVE(&ble_att_svr_list, entry, ble_att_svr_entry, ha_next);
         ble_att_svr_entry_free(entry);
     }
@@ -194,6 +353,19 @@ struct ble_att_svr_entry *
 ble_att_svr_find_by_handle(uint16_t handle_id)
 {
     struct ble_att_svr_entry *entry;
+#if MYNEWT_VAL(BLE_ATT_SVR_UUID_INDEX)
+    int pos;
+
+    if (ble_att_svr_idx_valid) {
+        pos = ble_att_svr_index_handle_pos(handle_id);
+        if (pos < ble_att_svr_idx_cnt &&
+            ble_att_svr_handle_idx[pos]->ha_handle_id == handle_id) {
+
+            return ble_att_svr_handle_idx[pos];
+        }
+        return NULL;
+    }
+#endif
 
     for (entry = STAILQ_FIRST(&ble_att_svr_list);
          entry != NULL;
@@ -207,6 +379,34 @@ ble_att_svr_find_by_handle(uint16_t handle_id)
     return NULL;
 }
 
+/**
+ * Finds the first visible attribute whose handle is greater than or equal to
+ * the specified one.
+ */
+static struct ble_att_svr_entry *
+ble_att_svr_find_first(uint16_t start_handle)
+{
+    struct ble_att_svr_entry *entry;
+#if MYNEWT_VAL(BLE_ATT_SVR_UUID_INDEX)
+    int pos;
+
+    if (ble_att_svr_idx_valid) {
+        pos = ble_att_svr_index_handle_pos(start_handle);
+        if (pos < ble_att_svr_idx_cnt) {
+            return ble_att_svr_handle_idx[pos];
+        }
+        return NULL;
+    }
+#endif
+
+    for (entry = STAILQ_FIRST(&ble_att_svr_list);
+         entry != NULL && entry->ha_handle_id < start_handle;
+         entry = STAILQ_NEXT(entry, ha_next)) {
+    }
+
+    return entry;
+}
+
 /**
  * Find a host attribute by UUID.
  *
@@ -227,6 +427,30 @@ ble_att_svr_find_by_uuid(struct ble_att_svr_entry *prev, const ble_uuid_t *uuid,
                          uint16_t end_handle)
 {
     struct ble_att_svr_entry *entry;
+#if MYNEWT_VAL(BLE_ATT_SVR_UUID_INDEX)
+    uint32_t key;
+    int pos;
+
+    if (ble_att_svr_idx_valid && uuid != NULL) {
+        key = ble_uuid_hash(uuid);
+        pos = ble_att_svr_index_uuid_pos(key, prev == NULL ?
+                                         0 : prev->ha_handle_id + 1);
+        for (; pos < ble_att_svr_idx_cnt; pos++) {
+            if (ble_att_svr_uuid_idx[pos].key != key) {
+                break;
+            }
+
+            entry = ble_att_svr_uuid_idx[pos].entry;
+            if (entry->ha_handle_id > end_handle) {
+                break;
+            }
+            if (ble_uuid_cmp(entry->ha_uuid, uuid) == 0) {
+                return entry;
+            }
+        }
+        return NULL;
+    }
+#endif
 
     if (prev == NULL) {
         entry = STAILQ_FIRST(&ble_att_svr_list);
@@ -855,7 +1079,10 @@ ble_att_svr_fill_info(uint16_t start_handle, uint16_t end_handle,
     num_entries = 0;
     rc = 0;
 
-    STAILQ_FOREACH(ha, &ble_att_svr_list, ha_next) {
+    for (ha = ble_att_svr_find_first(start_handle);
+         ha != NULL;
+         ha = STAILQ_NEXT(ha, ha_next)) {
+
         if (ha->ha_handle_id > end_handle) {
             rc = 0;
             goto done;
@@ -1140,10 +1367,10 @@ ble_att_svr_fill_type_value(uint16_t conn_handle,
      * matching group.  For each attribute entry, determine if data needs to be
      * written to the response.
      */
-    STAILQ_FOREACH(ha, &ble_att_svr_list, ha_next) {
-        if (ha->ha_handle_id < start_handle) {
-            continue;
-        }
+    for (ha = ble_att_svr_find_first(start_handle);
+         ha != NULL;
+         ha = STAILQ_NEXT(ha, ha_next)) {
+
 
         /* Continue to look for end of group in case group is in progress. */
         if (!first && ha->ha_handle_id > end_handle) {
@@ -2009,10 +2236,10 @@ ble_att_svr_build_read_group_type_rsp(uint16_t conn_handle,
     }
 
     rsp->bagp_length = 0;
-    STAILQ_FOREACH(entry, &ble_att_svr_list, ha_next) {
-        if (entry->ha_handle_id < start_handle) {
-            continue;
-        }
+    for (entry = ble_att_svr_find_first(start_handle);
+         entry != NULL;
+         entry = STAILQ_NEXT(entry, ha_next)) {
+
         if (entry->ha_handle_id > end_handle) {
             /* The full input range has been searched. */
             rc = 0;
@@ -3062,6 +3289,8 @@ ble_att_svr_move_entries(struct ble_att_svr_entry_list *src,
     struct ble_att_svr_entry *remove;
     struct ble_att_svr_entry *insert;
 
+    ble_att_svr_index_invalidate();
+
     /* Find first matching element to move */
     remove = NULL;
     entry = STAILQ_FIRST(src);
@@ -3130,6 +3359,8 @@ ble_att_svr_reset(void)
 {
     struct ble_att_svr_entry *entry;
 
+    ble_att_svr_index_invalidate();
+
     while ((entry = STAILQ_FIRST(&ble_att_svr_list)) != NULL) {
         STAILQ_REMOVE_HEAD(&ble_att_svr_list, ha_next);
         ble_att_svr_entry_free(entry);
@@ -3190,6 +3421,9 @@ void
 ble_att_svr_stop(void)
 {
     ble_att_svr_free_start_mem();
+#if MYNEWT_VAL(BLE_ATT_SVR_UUID_INDEX)
+    ble_att_svr_index_free();
+#endif
 }
 
 int
@@ -116,9 +116,9 @@ int ble_ead_encrypt(const uint8_t session_key[BLE_EAD_KEY_SIZE], const uint8_t i
     return ead_encrypt(session_key, iv, NULL, payload, payload_size, encrypted_payload);
 }
 
-static int ead_decrypt(const uint8_t session_key[BLE_EAD_KEY_SIZE], const uint8_t iv[BLE_EAD_IV_SIZE],
-                       const uint8_t *encrypted_payload, size_t encrypted_payload_size,
-                       uint8_t *payload)
+static int ead_decrypt_ctx(struct ble_aes_ccm_ctx *ctx, const uint8_t iv[BLE_EAD_IV_SIZE],
+                           const uint8_t *encrypted_payload, size_t encrypted_payload_size,
+                           uint8_t *payload)
 {
     int err;
     uint8_t nonce[BLE_EAD_NONCE_SIZE];
@@ -133,17 +133,36 @@ static int ead_decrypt(const uint8_t session_key[BLE_EAD_KEY_SIZE], const uint8_
         return -1;
     }
 
-    err = ble_aes_ccm_decrypt(session_key, nonce, encrypted_ad_data, payload_size, ble_ead_aad,
-                              BLE_EAD_AAD_SIZE, payload, BLE_EAD_MIC_SIZE);
+    err = ble_aes_ccm_ctx_decrypt(ctx, nonce, encrypted_ad_data, payload_size, ble_ead_aad,
+                                  BLE_EAD_AAD_SIZE, payload, BLE_EAD_MIC_SIZE);
 
     if (err != 0) {
         BLE_HS_LOG(DEBUG, "Failed to decrypt the data (ble_ccm_decrypt err %d)", err);
-        return -1;
+        return err == BLE_HS_EAUTHEN ? BLE_HS_EAUTHEN : -1;
     }
 
     return 0;
 }
 
+static int ead_decrypt(const uint8_t session_key[BLE_EAD_KEY_SIZE], const uint8_t iv[BLE_EAD_IV_SIZE],
+                       const uint8_t *encrypted_payload, size_t encrypted_payload_size,
+                       uint8_t *payload)
+{
+    struct ble_aes_ccm_ctx ctx;
+    int err;
+
+    err = ble_aes_ccm_ctx_init(&ctx, session_key);
+    if (err != 0) {
+        return -1;
+    }
+
+    err = ead_decrypt_ctx(&ctx, iv, encrypted_payload, encrypted_payload_size, payload);
+
+    ble_aes_ccm_ctx_free(&ctx);
+
+    return err;
+}
+
 int ble_ead_decrypt(const uint8_t session_key[BLE_EAD_KEY_SIZE], const uint8_t iv[BLE_EAD_IV_SIZE],
                     const uint8_t *encrypted_payload, size_t encrypted_payload_size,
                     uint8_t *payload)
@@ -178,6 +197,44 @@ int ble_ead_decrypt(const uint8_t session_key[BLE_EAD_KEY_SIZE], const uint8_t i
     return ead_decrypt(session_key, iv, encrypted_payload, encrypted_payload_size, payload);
 }
 
+int ble_ead_decrypt_batch(const uint8_t session_key[BLE_EAD_KEY_SIZE],
+                          const uint8_t iv[BLE_EAD_IV_SIZE],
+                          struct ble_ead_report *reports, size_t num_reports)
+{
+    struct ble_aes_ccm_ctx ctx;
+    struct ble_ead_report *report;
+    size_t i;
+    int err;
+
+    if (session_key == NULL || iv == NULL || (reports == NULL && num_reports)) {
+        return BLE_HS_EINVAL;
+    }
+
+    /* Key schedule is expanded once for the whole batch */
+    err = ble_aes_ccm_ctx_init(&ctx, session_key);
+    if (err != 0) {
+        return err;
+    }
+
+    for (i = 0; i < num_reports; i++) {
+        report = &reports[i];
+
+        if (report->encrypted_payload == NULL || report->payload == NULL ||
+            report->encrypted_payload_size < BLE_EAD_RANDOMIZER_SIZE + BLE_EAD_MIC_SIZE) {
+            report->status = BLE_HS_EINVAL;
+            continue;
+        }
+
+        report->status = ead_decrypt_ctx(&ctx, iv, report->encrypted_payload,
+                                         report->encrypted_payload_size,
+                                         report->payload);
+    }
+
+    ble_aes_ccm_ctx_free(&ctx);
+
+    return 0;
+}
+
 int ble_ead_serialize_data(const struct enc_adv_data *input, uint8_t *output)
 {
     if ( input == NULL) {
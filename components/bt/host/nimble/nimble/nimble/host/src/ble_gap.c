@@ -1960,12 +1960,22 @@ ble_gap_rx_periodic_adv_rpt(const struct ble_hci_ev_le_subev_periodic_adv_rpt *e
     struct ble_gap_event event;
     ble_gap_event_fn *cb = NULL;
     void *cb_arg = NULL;
+#if MYNEWT_VAL(BLE_PERIODIC_ADV_REASSEMBLY)
+    struct os_mbuf *om = NULL;
+    uint8_t data_status;
+    int rc = BLE_HS_ENOENT;
+#endif
 
     ble_hs_lock();
     psync = ble_hs_periodic_sync_find_by_handle(le16toh(ev->sync_handle));
     if (psync) {
         cb = psync->cb;
         cb_arg = psync->cb_arg;
+#if MYNEWT_VAL(BLE_PERIODIC_ADV_REASSEMBLY)
+        if (cb) {
+            rc = ble_hs_periodic_sync_rx_rpt(psync, ev, &om, &data_status);
+        }
+#endif
     }
     ble_hs_unlock();
 
@@ -1975,6 +1985,24 @@ ble_gap_rx_periodic_adv_rpt(const struct ble_hci_ev_le_subev_periodic_adv_rpt *e
 
     memset(&event, 0, sizeof event);
 
+#if MYNEWT_VAL(BLE_PERIODIC_ADV_REASSEMBLY)
+    if (rc != 0) {
+        /* More reports to come, or an unchanged train. */
+        return;
+    }
+
+    event.type = BLE_GAP_EVENT_PERIODIC_TRAIN;
+    event.periodic_train.sync_handle = le16toh(ev->sync_handle);
+    event.periodic_train.tx_power = ev->tx_power;
+    event.periodic_train.rssi = ev->rssi;
+    event.periodic_train.data_status = data_status;
+    event.periodic_train.data_length = om ? OS_MBUF_PKTLEN(om) : 0;
+    event.periodic_train.om = om;
+
+    cb(&event, cb_arg);
+
+    os_mbuf_free_chain(event.periodic_train.om);
+#else
     event.type = BLE_GAP_EVENT_PERIODIC_REPORT;
     event.periodic_report.sync_handle = psync->sync_handle;
     event.periodic_report.tx_power = ev->tx_power;
@@ -1987,6 +2015,7 @@ ble_gap_rx_periodic_adv_rpt(const struct ble_hci_ev_le_subev_periodic_adv_rpt *e
      * like ACL data, not general event
      */
      cb(&event, cb_arg);
+#endif
 }
 
 void
@@ -4767,6 +4796,9 @@ ble_gap_periodic_adv_sync_create(const ble_addr_t *addr, uint8_t adv_sid,
         ble_gap_sync.cb = cb;
         ble_gap_sync.cb_arg = cb_arg;
         ble_gap_sync.psync = psync;
+#if MYNEWT_VAL(BLE_PERIODIC_ADV_REASSEMBLY)
+        psync->rpt_filter_unchanged = params->filter_unchanged;
+#endif
     } else {
         ble_hs_periodic_sync_free(psync);
     }
@@ -4893,6 +4925,11 @@ ble_gap_periodic_adv_sync_reporting(uint16_t sync_handle, bool enable)
 #endif
 
     rc = ble_hs_hci_cmd_tx(opcode, &cmd, sizeof(cmd), NULL, 0);
+#if MYNEWT_VAL(BLE_PERIODIC_ADV_REASSEMBLY)
+    if (rc == 0) {
+        ble_hs_periodic_sync_rpt_reset(psync);
+    }
+#endif
 
     ble_hs_unlock();
 
@@ -5106,6 +5143,9 @@ ble_gap_periodic_adv_sync_receive(uint16_t conn_handle,
         } else {
             conn->psync->cb = cb;
             conn->psync->cb_arg = cb_arg;
+#if MYNEWT_VAL(BLE_PERIODIC_ADV_REASSEMBLY)
+            conn->psync->rpt_filter_unchanged = params->filter_unchanged;
+#endif
             ble_npl_event_init(&conn->psync->lost_ev, ble_gap_npl_sync_lost,
                                conn->psync);
         }
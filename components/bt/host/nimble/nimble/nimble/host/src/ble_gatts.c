@@ -1765,6 +1765,8 @@ done:
     if (rc != 0) {
         ble_gatts_free_mem();
         ble_gatts_free_svc_defs();
+    } else {
+        ble_att_svr_index_build();
     }
 
     ble_hs_unlock();
@@ -2571,7 +2573,7 @@ ble_gatts_find_svc_chr_attr(const ble_uuid_t *svc_uuid,
 {
     struct ble_gatts_svc_entry *svc_entry;
     struct ble_att_svr_entry *att_svc;
-    struct ble_att_svr_entry *next;
+    struct ble_att_svr_entry *decl;
     struct ble_att_svr_entry *cur;
 
 #if MYNEWT_VAL(BLE_DYNAMIC_SERVICE)
@@ -2588,34 +2590,28 @@ ble_gatts_find_svc_chr_attr(const ble_uuid_t *svc_uuid,
         return BLE_HS_EUNKNOWN;
     }
 
-    cur = STAILQ_NEXT(att_svc, ha_next);
-    while (1) {
-        if (cur == NULL) {
-            /* Reached end of attribute list without a match. */
-            return BLE_HS_ENOENT;
-        }
-        next = STAILQ_NEXT(cur, ha_next);
-
-        if (cur->ha_handle_id == svc_entry->end_group_handle) {
-            /* Reached end of service without a match. */
-            return BLE_HS_ENOENT;
-        }
-
-        if (ble_uuid_u16(cur->ha_uuid) == BLE_ATT_UUID_CHARACTERISTIC &&
-            next != NULL &&
-            ble_uuid_cmp(next->ha_uuid, chr_uuid) == 0) {
+    /* A characteristic value attribute immediately follows its declaration;
+     * other attributes within the service may share the characteristic UUID
+     * (e.g., descriptors), so check the preceding attribute of each match.
+     */
+    cur = att_svc;
+    while ((cur = ble_att_svr_find_by_uuid(cur, chr_uuid,
+                                           svc_entry->end_group_handle)) != NULL) {
+        decl = ble_att_svr_find_by_handle(cur->ha_handle_id - 1);
+        if (decl != NULL &&
+            ble_uuid_u16(decl->ha_uuid) == BLE_ATT_UUID_CHARACTERISTIC) {
 
             if (out_svc_entry != NULL) {
                 *out_svc_entry = svc_entry;
             }
             if (out_att_chr != NULL) {
-                *out_att_chr = next;
+                *out_att_chr = cur;
             }
             return 0;
         }
-
-        cur = next;
     }
+
+    return BLE_HS_ENOENT;
 }
 
 int
@@ -2663,10 +2659,11 @@ int
 ble_gatts_find_dsc(const ble_uuid_t *svc_uuid, const ble_uuid_t *chr_uuid,
                    const ble_uuid_t *dsc_uuid, uint16_t *out_handle)
 {
+    ble_uuid16_t uuid_chr = BLE_UUID16_INIT(BLE_ATT_UUID_CHARACTERISTIC);
     struct ble_gatts_svc_entry *svc_entry;
     struct ble_att_svr_entry *att_chr;
     struct ble_att_svr_entry *cur;
-    uint16_t uuid16;
+    uint16_t end_handle;
     int rc;
 
     rc = ble_gatts_find_svc_chr_attr(svc_uuid, chr_uuid, &svc_entry,
@@ -2675,32 +2672,26 @@ ble_gatts_find_dsc(const ble_uuid_t *svc_uuid, const ble_uuid_t *chr_uuid,
         return rc;
     }
 
-    cur = STAILQ_NEXT(att_chr, ha_next);
-    while (1) {
-        if (cur == NULL) {
-            /* Reached end of attribute list without a match. */
-            return BLE_HS_ENOENT;
-        }
-
-        if (cur->ha_handle_id > svc_entry->end_group_handle) {
-            /* Reached end of service without a match. */
-            return BLE_HS_ENOENT;
-        }
+    /* The characteristic ends at the next characteristic declaration or at
+     * the end of the service.
+     */
+    cur = ble_att_svr_find_by_uuid(att_chr, &uuid_chr.u,
+                                   svc_entry->end_group_handle);
+    if (cur != NULL) {
+        end_handle = cur->ha_handle_id - 1;
+    } else {
+        end_handle = svc_entry->end_group_handle;
+    }
 
-        uuid16 = ble_uuid_u16(cur->ha_uuid);
-        if (uuid16 == BLE_ATT_UUID_CHARACTERISTIC) {
-            /* Reached end of characteristic without a match. */
-            return BLE_HS_ENOENT;
-        }
+    cur = ble_att_svr_find_by_uuid(att_chr, dsc_uuid, end_handle);
+    if (cur == NULL) {
+        return BLE_HS_ENOENT;
+    }
 
-        if (ble_uuid_cmp(cur->ha_uuid, dsc_uuid) == 0) {
-            if (out_handle != NULL) {
-                *out_handle = cur->ha_handle_id;
-                return 0;
-            }
-        }
-        cur = STAILQ_NEXT(cur, ha_next);
+    if (out_handle != NULL) {
+        *out_handle = cur->ha_handle_id;
     }
+    return 0;
 }
 
 #if MYNEWT_VAL(BLE_DYNAMIC_SERVICE)
@@ -2806,6 +2797,7 @@ int ble_gatts_add_dynamic_svcs(const struct ble_gatt_svc_def *svcs) {
 #endif
     }
     ble_gatts_free_svc_defs();
+    ble_att_svr_index_build();
      /* Fill the cache. */
     cfg = ble_gatts_get_last_cfg(&ble_gatts_clt_cfgs);
     ha = ble_att_svr_find_by_handle(cfg->chr_val_handle - 1);
@@ -2925,6 +2917,7 @@ int ble_gatts_delete_svc(const ble_uuid_t *uuid) {
     end_handle = entry->end_group_handle;
     /* deregister service now */
     rc = ble_gatts_deregister_svc(uuid);
+    ble_att_svr_index_build();
 
 done:
     if (rc == 0) {
@@ -2995,6 +2988,7 @@ ble_gatts_svc_set_visibility(uint16_t handle, int visible)
             } else {
                 ble_att_svr_hide_range(entry->handle, entry->end_group_handle);
             }
+            ble_att_svr_index_build();
             return 0;
         }
     }
@@ -369,6 +369,10 @@ ble_hs_sync(void)
                        rc);
         }
 
+#if NIMBLE_BLE_CONNECT
+        ble_sm_sc_sync();
+#endif
+
         if (ble_hs_cfg.sync_cb != NULL) {
             ble_hs_cfg.sync_cb();
         }
@@ -903,6 +907,8 @@ ble_hs_deinit(void)
     ble_npl_event_deinit(&ble_hs_ev_reset);
 
 #if NIMBLE_BLE_CONNECT
+    ble_sm_sc_deinit();
+
     ble_npl_event_deinit(&ble_hs_ev_tx_notifications);
 
     ble_gatts_stop();
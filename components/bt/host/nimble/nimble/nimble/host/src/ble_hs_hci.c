@@ -46,17 +46,20 @@ static uint8_t ble_hs_hci_version;
 
 static struct ble_hs_hci_sup_cmd ble_hs_hci_sup_cmd;
 
+/* The extra byte is the H4 packet indicator reserved by
+ * ble_hs_hci_frag_alloc().
+ */
 #if CONFIG_BT_NIMBLE_LEGACY_VHCI_ENABLE
 #define BLE_HS_HCI_FRAG_DATABUF_SIZE    \
     (BLE_ACL_MAX_PKT_SIZE +             \
-     BLE_HCI_DATA_HDR_SZ +              \
+     BLE_HCI_DATA_HDR_SZ + 1 +          \
      sizeof (struct os_mbuf_pkthdr) +   \
      sizeof (struct ble_mbuf_hdr) +     \
      sizeof (struct os_mbuf))
 #else
 #define BLE_HS_HCI_FRAG_DATABUF_SIZE    \
      (BLE_ACL_MAX_PKT_SIZE +            \
-      BLE_HCI_DATA_HDR_SZ +             \
+      BLE_HCI_DATA_HDR_SZ + 1 +         \
       BLE_HS_CTRL_DATA_HDR_SZ +         \
       sizeof (struct os_mbuf_pkthdr) +  \
       sizeof (struct ble_mbuf_hdr) +    \
@@ -493,10 +496,13 @@ ble_hs_hci_frag_alloc(uint16_t frag_size, void *arg)
     om = os_mbuf_get_pkthdr(&ble_hs_hci_frag_mbuf_pool, 0);
 #endif
     if (om != NULL) {
+        /* Leave room for the H4 packet indicator, as ble_hs_mbuf_acl_pkt()
+         * does, so that the fragment can be sent without being copied.
+         */
 #if CONFIG_BT_NIMBLE_LEGACY_VHCI_ENABLE
-        om->om_data += BLE_HCI_DATA_HDR_SZ;
+        om->om_data += BLE_HCI_DATA_HDR_SZ + 1;
 #else
-        om->om_data += BLE_HCI_DATA_HDR_SZ + BLE_HS_CTRL_DATA_HDR_SZ;
+        om->om_data += BLE_HCI_DATA_HDR_SZ + BLE_HS_CTRL_DATA_HDR_SZ + 1;
 #endif
         return om;
     }
@@ -25,7 +25,18 @@
 #include "ble_hs_priv.h"
 
 #if MYNEWT_VAL(BLE_PERIODIC_ADV)
-static SLIST_HEAD(, ble_hs_periodic_sync) g_ble_hs_periodic_sync_handles;
+/* Controllers usually hand out sync handles sequentially, so bucketing by
+ * handle modulo the sync count gives a direct lookup for every report.
+ */
+#define BLE_HS_PERIODIC_SYNC_NUM_BUCKETS                                \
+    (MYNEWT_VAL(BLE_MAX_PERIODIC_SYNCS) > 0 ?                           \
+     MYNEWT_VAL(BLE_MAX_PERIODIC_SYNCS) : 1)
+
+SLIST_HEAD(ble_hs_periodic_sync_list, ble_hs_periodic_sync);
+
+static struct ble_hs_periodic_sync_list g_ble_hs_periodic_sync_handles;
+static struct ble_hs_periodic_sync_list
+    ble_hs_periodic_sync_buckets[BLE_HS_PERIODIC_SYNC_NUM_BUCKETS];
 static struct os_mempool ble_hs_periodic_sync_pool;
 
 static os_membuf_t ble_hs_psync_elem_mem[
@@ -33,6 +44,13 @@ static os_membuf_t ble_hs_psync_elem_mem[
                     sizeof (struct ble_hs_periodic_sync))
 ];
 
+static struct ble_hs_periodic_sync_list *
+ble_hs_periodic_sync_bucket(uint16_t sync_handle)
+{
+    return &ble_hs_periodic_sync_buckets[sync_handle %
+                                         BLE_HS_PERIODIC_SYNC_NUM_BUCKETS];
+}
+
 struct ble_hs_periodic_sync *
 ble_hs_periodic_sync_alloc(void)
 {
@@ -58,6 +76,11 @@ ble_hs_periodic_sync_free(struct ble_hs_periodic_sync *psync)
     if((psync->lost_ev).event != NULL)
         ble_npl_event_deinit(&psync->lost_ev);
 
+#if MYNEWT_VAL(BLE_PERIODIC_ADV_REASSEMBLY)
+    os_mbuf_free_chain(psync->rpt_om);
+    os_mbuf_free_chain(psync->rpt_last_om);
+#endif
+
 #if MYNEWT_VAL(BLE_HS_DEBUG)
     memset(psync, 0xff, sizeof *psync);
 #endif
@@ -74,6 +97,8 @@ ble_hs_periodic_sync_insert(struct ble_hs_periodic_sync *psync)
                        ble_hs_periodic_sync_find_by_handle(psync->sync_handle) == NULL);
 
     SLIST_INSERT_HEAD(&g_ble_hs_periodic_sync_handles, psync, next);
+    SLIST_INSERT_HEAD(ble_hs_periodic_sync_bucket(psync->sync_handle), psync,
+                      bucket_next);
 }
 
 void
@@ -83,6 +108,8 @@ ble_hs_periodic_sync_remove(struct ble_hs_periodic_sync *psync)
 
     SLIST_REMOVE(&g_ble_hs_periodic_sync_handles, psync, ble_hs_periodic_sync,
                  next);
+    SLIST_REMOVE(ble_hs_periodic_sync_bucket(psync->sync_handle), psync,
+                 ble_hs_periodic_sync, bucket_next);
 }
 
 struct ble_hs_periodic_sync *
@@ -92,7 +119,8 @@ ble_hs_periodic_sync_find_by_handle(uint16_t sync_handle)
 
     BLE_HS_DBG_ASSERT(ble_hs_locked_by_cur_task());
 
-    SLIST_FOREACH(psync, &g_ble_hs_periodic_sync_handles, next) {
+    SLIST_FOREACH(psync, ble_hs_periodic_sync_bucket(sync_handle),
+                  bucket_next) {
         if (psync->sync_handle == sync_handle) {
             return psync;
         }
@@ -137,10 +165,111 @@ ble_hs_periodic_sync_first(void)
     return psync;
 }
 
+#if MYNEWT_VAL(BLE_PERIODIC_ADV_REASSEMBLY)
+/**
+ * Adds a periodic advertising report to the train being reassembled for the
+ * specified sync.
+ *
+ * @param psync                 The sync the report was received on.
+ * @param ev                    The received report.
+ * @param out_om                On success, the reassembled train.  The caller
+ *                                  takes ownership.  NULL if no memory was
+ *                                  available for any part of the train.
+ * @param out_status            On success, BLE_HCI_PERIODIC_DATA_STATUS_COMPLETE
+ *                                  or BLE_HCI_PERIODIC_DATA_STATUS_TRUNCATED.
+ *
+ * @return                      0 if a train is ready for delivery;
+ *                              BLE_HS_EAGAIN if more reports are expected;
+ *                              BLE_HS_EALREADY if the train is identical to
+ *                                  the previously delivered one and the sync
+ *                                  filters unchanged trains.
+ */
+int
+ble_hs_periodic_sync_rx_rpt(struct ble_hs_periodic_sync *psync,
+                            const struct ble_hci_ev_le_subev_periodic_adv_rpt *ev,
+                            struct os_mbuf **out_om, uint8_t *out_status)
+{
+    struct os_mbuf *om;
+    uint16_t len;
+
+    BLE_HS_DBG_ASSERT(ble_hs_locked_by_cur_task());
+
+    /* Once part of a train is lost, the remaining reports are only consumed
+     * until the controller signals the end of the train.
+     */
+    if (!psync->rpt_truncated) {
+        if (psync->rpt_om == NULL) {
+            psync->rpt_om = os_msys_get_pkthdr(0, 0);
+        }
+
+        if (psync->rpt_om == NULL ||
+            OS_MBUF_PKTLEN(psync->rpt_om) + ev->data_len >
+            BLE_HS_PERIODIC_SYNC_TRAIN_MAX_LEN ||
+            os_mbuf_append(psync->rpt_om, ev->data, ev->data_len) != 0) {
+
+            psync->rpt_truncated = 1;
+        }
+    }
+
+    if (ev->data_status == BLE_HCI_PERIODIC_DATA_STATUS_INCOMPLETE) {
+        return BLE_HS_EAGAIN;
+    }
+
+    om = psync->rpt_om;
+    psync->rpt_om = NULL;
+
+    if (psync->rpt_truncated ||
+        ev->data_status != BLE_HCI_PERIODIC_DATA_STATUS_COMPLETE) {
+
+        *out_status = BLE_HCI_PERIODIC_DATA_STATUS_TRUNCATED;
+    } else {
+        *out_status = BLE_HCI_PERIODIC_DATA_STATUS_COMPLETE;
+    }
+    psync->rpt_truncated = 0;
+
+    if (psync->rpt_filter_unchanged &&
+        *out_status == BLE_HCI_PERIODIC_DATA_STATUS_COMPLETE) {
+
+        len = OS_MBUF_PKTLEN(om);
+        if (psync->rpt_last_om != NULL &&
+            OS_MBUF_PKTLEN(psync->rpt_last_om) == len &&
+            os_mbuf_cmpm(om, 0, psync->rpt_last_om, 0, len) == 0) {
+
+            os_mbuf_free_chain(om);
+            return BLE_HS_EALREADY;
+        }
+
+        /* Without a copy the next train is simply delivered. */
+        os_mbuf_free_chain(psync->rpt_last_om);
+        psync->rpt_last_om = os_mbuf_dup(om);
+    }
+
+    *out_om = om;
+    return 0;
+}
+
+/**
+ * Discards any partially reassembled train and forgets the last delivered
+ * one, e.g., when reporting is re-enabled for the sync.
+ */
+void
+ble_hs_periodic_sync_rpt_reset(struct ble_hs_periodic_sync *psync)
+{
+    BLE_HS_DBG_ASSERT(ble_hs_locked_by_cur_task());
+
+    os_mbuf_free_chain(psync->rpt_om);
+    psync->rpt_om = NULL;
+    psync->rpt_truncated = 0;
+    os_mbuf_free_chain(psync->rpt_last_om);
+    psync->rpt_last_om = NULL;
+}
+#endif
+
 int
 ble_hs_periodic_sync_init(void)
 {
     int rc;
+    int i;
 
     rc = os_mempool_init(&ble_hs_periodic_sync_pool,
                          MYNEWT_VAL(BLE_MAX_PERIODIC_SYNCS),
@@ -151,6 +280,9 @@ ble_hs_periodic_sync_init(void)
     }
 
     SLIST_INIT(&g_ble_hs_periodic_sync_handles);
+    for (i = 0; i < BLE_HS_PERIODIC_SYNC_NUM_BUCKETS; i++) {
+        SLIST_INIT(&ble_hs_periodic_sync_buckets[i]);
+    }
 
     return 0;
 }
@@ -26,8 +26,15 @@
 extern "C" {
 #endif
 
+struct os_mbuf;
+struct ble_hci_ev_le_subev_periodic_adv_rpt;
+
+/** Upper bound of a reassembled periodic advertising train. */
+#define BLE_HS_PERIODIC_SYNC_TRAIN_MAX_LEN  1650
+
 struct ble_hs_periodic_sync {
     SLIST_ENTRY(ble_hs_periodic_sync) next;
+    SLIST_ENTRY(ble_hs_periodic_sync) bucket_next;
     uint16_t   sync_handle;
     ble_addr_t advertiser_addr;
     uint8_t    adv_sid;
@@ -36,6 +43,19 @@ struct ble_hs_periodic_sync {
     void *cb_arg;
 
     struct ble_npl_event lost_ev;
+
+#if MYNEWT_VAL(BLE_PERIODIC_ADV_REASSEMBLY)
+    /** Train being reassembled; NULL between trains. */
+    struct os_mbuf *rpt_om;
+
+    /** Copy of the last delivered train, when unchanged trains are
+     *  filtered.
+     */
+    struct os_mbuf *rpt_last_om;
+
+    uint8_t rpt_truncated:1;
+    uint8_t rpt_filter_unchanged:1;
+#endif
 };
 
 struct ble_hs_periodic_sync *ble_hs_periodic_sync_alloc(void);
@@ -46,6 +66,12 @@ struct ble_hs_periodic_sync *ble_hs_periodic_sync_find_by_handle(uint16_t sync_h
 struct ble_hs_periodic_sync *ble_hs_periodic_sync_find(const ble_addr_t *addr,
                                                        uint8_t sid);
 struct ble_hs_periodic_sync *ble_hs_periodic_sync_first(void);
+#if MYNEWT_VAL(BLE_PERIODIC_ADV_REASSEMBLY)
+int ble_hs_periodic_sync_rx_rpt(struct ble_hs_periodic_sync *psync,
+                                const struct ble_hci_ev_le_subev_periodic_adv_rpt *ev,
+                                struct os_mbuf **out_om, uint8_t *out_status);
+void ble_hs_periodic_sync_rpt_reset(struct ble_hs_periodic_sync *psync);
+#endif
 int ble_hs_periodic_sync_init(void);
 
 #ifdef __cplusplus
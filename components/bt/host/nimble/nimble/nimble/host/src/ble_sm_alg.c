@@ -56,11 +56,7 @@
 
 #endif
 
-#if MYNEWT_VAL(BLE_CRYPTO_STACK_MBEDTLS)
-#if MYNEWT_VAL(BLE_SM_SC)
-static mbedtls_ecp_keypair keypair;
-#endif
-#else
+#if !MYNEWT_VAL(BLE_CRYPTO_STACK_MBEDTLS)
 #if MYNEWT_VAL(BLE_SM_SC) && MYNEWT_VAL(TRNG)
 static struct trng_dev *g_trng;
 #endif
@@ -529,6 +525,10 @@ ble_sm_alg_gen_dhkey(const uint8_t *peer_pub_key_x, const uint8_t *peer_pub_key_
     swap_buf(priv, our_priv_key, 32);
 
 #if MYNEWT_VAL(BLE_CRYPTO_STACK_MBEDTLS)
+    /* Keep all contexts local so that key generation and DHKey calculation
+     * may run concurrently from different tasks.
+     */
+    mbedtls_ecp_group grp = {0};
     struct mbedtls_ecp_point pt = {0}, Q = {0};
     mbedtls_mpi z = {0}, d = {0};
     mbedtls_ctr_drbg_context ctr_drbg = {0};
@@ -540,6 +540,7 @@ ble_sm_alg_gen_dhkey(const uint8_t *peer_pub_key_x, const uint8_t *peer_pub_key_
     memcpy(&pub[1], pk, 64);
 
     /* Initialize the required structures here */
+    mbedtls_ecp_group_init(&grp);
     mbedtls_ecp_point_init(&pt);
     mbedtls_ecp_point_init(&Q);
     mbedtls_ctr_drbg_init(&ctr_drbg);
@@ -548,15 +549,15 @@ ble_sm_alg_gen_dhkey(const uint8_t *peer_pub_key_x, const uint8_t *peer_pub_key_
     mbedtls_mpi_init(&z);
 
     /* Below 3 steps are to validate public key on curve secp256r1 */
-    if (mbedtls_ecp_group_load(&keypair.MBEDTLS_PRIVATE(grp), MBEDTLS_ECP_DP_SECP256R1) != 0) {
+    if (mbedtls_ecp_group_load(&grp, MBEDTLS_ECP_DP_SECP256R1) != 0) {
         goto exit;
     }
 
-    if (mbedtls_ecp_point_read_binary(&keypair.MBEDTLS_PRIVATE(grp), &pt, pub, 65) != 0) {
+    if (mbedtls_ecp_point_read_binary(&grp, &pt, pub, 65) != 0) {
         goto exit;
     }
 
-    if (mbedtls_ecp_check_pubkey(&keypair.MBEDTLS_PRIVATE(grp), &pt) != 0) {
+    if (mbedtls_ecp_check_pubkey(&grp, &pt) != 0) {
         goto exit;
     }
 
@@ -567,7 +568,7 @@ ble_sm_alg_gen_dhkey(const uint8_t *peer_pub_key_x, const uint8_t *peer_pub_key_
     }
 
     /* Prepare point Q from pub key */
-    if (mbedtls_ecp_point_read_binary(&keypair.MBEDTLS_PRIVATE(grp), &Q, pub, 65) != 0) {
+    if (mbedtls_ecp_point_read_binary(&grp, &Q, pub, 65) != 0) {
         goto exit;
     }
 
@@ -575,7 +576,7 @@ ble_sm_alg_gen_dhkey(const uint8_t *peer_pub_key_x, const uint8_t *peer_pub_key_
         goto exit;
     }
 
-    rc = mbedtls_ecdh_compute_shared(&keypair.MBEDTLS_PRIVATE(grp), &z, &Q, &d,
+    rc = mbedtls_ecdh_compute_shared(&grp, &z, &Q, &d,
                                      mbedtls_ctr_drbg_random, &ctr_drbg);
     if (rc != 0) {
         goto exit;
@@ -587,6 +588,7 @@ ble_sm_alg_gen_dhkey(const uint8_t *peer_pub_key_x, const uint8_t *peer_pub_key_
     }
 
 exit:
+    mbedtls_ecp_group_free(&grp);
     mbedtls_ecp_point_free(&pt);
     mbedtls_mpi_free(&z);
     mbedtls_mpi_free(&d);
@@ -637,16 +639,13 @@ static int
 mbedtls_gen_keypair(uint8_t *public_key, uint8_t *private_key)
 {
     int rc = BLE_HS_EUNKNOWN;
+    mbedtls_ecp_keypair keypair;
     mbedtls_entropy_context entropy = {0};
     mbedtls_ctr_drbg_context ctr_drbg = {0};
 
 
     mbedtls_entropy_init(&entropy);
     mbedtls_ctr_drbg_init(&ctr_drbg);
-
-    /* Free the previously allocate keypair */
-    mbedtls_ecp_keypair_free(&keypair);
-
     mbedtls_ecp_keypair_init(&keypair);
 
     if (( rc = mbedtls_ctr_drbg_seed(&ctr_drbg, mbedtls_entropy_func, &entropy,
@@ -676,18 +675,13 @@ mbedtls_gen_keypair(uint8_t *public_key, uint8_t *private_key)
 exit:
     mbedtls_ctr_drbg_free( &ctr_drbg );
     mbedtls_entropy_free( &entropy );
+    mbedtls_ecp_keypair_free(&keypair);
     if (rc != 0) {
-        mbedtls_ecp_keypair_free(&keypair);
         return BLE_HS_EUNKNOWN;
     }
 
     return 0;
 }
-
-void mbedtls_free_keypair(void)
-{
-    mbedtls_ecp_keypair_free(&keypair);
-}
 #endif
 
 /**
@@ -219,6 +219,8 @@ struct ble_sm_dhkey_check {
 #define BLE_SM_PROC_F_AUTHENTICATED         0x08
 #define BLE_SM_PROC_F_SC                    0x10
 #define BLE_SM_PROC_F_BONDING               0x20
+#define BLE_SM_PROC_F_SC_KEYS               0x40
+#define BLE_SM_PROC_F_DHKEY_WAIT            0x80
 
 #define BLE_SM_KE_F_ENC_INFO                0x01
 #define BLE_SM_KE_F_MASTER_ID               0x02
@@ -271,8 +273,13 @@ struct ble_sm_proc {
     uint8_t passkey_bits_exchanged;
     uint8_t ri;
     struct ble_sm_public_key pub_key_peer;
+    uint8_t pub_key_our[64];
+    uint8_t priv_key_our[32];
     uint8_t mackey[16];
     uint8_t dhkey[32];
+#if MYNEWT_VAL(BLE_SM_SC_ASYNC_DHKEY)
+    uint16_t dhkey_job_id;
+#endif
     const struct ble_sm_sc_oob_data *oob_data_local;
     const struct ble_sm_sc_oob_data *oob_data_remote;
 #endif
@@ -297,6 +304,8 @@ void ble_sm_dbg_set_next_master_id_rand(uint64_t next_master_id_rand);
 void ble_sm_dbg_set_next_ltk(uint8_t *next_ltk);
 void ble_sm_dbg_set_next_csrk(uint8_t *next_csrk);
 void ble_sm_dbg_set_sc_keys(uint8_t *pubkey, uint8_t *privkey);
+int ble_sm_dbg_sc_key_pool_cnt(void);
+void ble_sm_dbg_sc_key_pool_drain(void);
 #endif
 
 int ble_sm_num_procs(void);
@@ -364,7 +373,9 @@ bool ble_sm_sc_oob_data_check(struct ble_sm_proc *proc,
                               bool oob_data_local_present,
                               bool oob_data_remote_present);
 void ble_sm_sc_oob_confirm(struct ble_sm_proc *proc, struct ble_sm_result *res);
+void ble_sm_sc_sync(void);
 void ble_sm_sc_init(void);
+void ble_sm_sc_deinit(void);
 #else
 #define ble_sm_sc_io_action(proc, action) (BLE_HS_ENOTSUP)
 #define ble_sm_sc_confirm_exec(proc, res)
@@ -374,7 +385,9 @@ void ble_sm_sc_init(void);
 #define ble_sm_sc_public_key_rx(conn_handle, op, om, res)
 #define ble_sm_sc_dhkey_check_exec(proc, res, arg)
 #define ble_sm_sc_dhkey_check_rx(conn_handle, op, om, res)
+#define ble_sm_sc_sync()
 #define ble_sm_sc_init()
+#define ble_sm_sc_deinit()
 
 #endif
 
@@ -30,8 +30,13 @@
 #define BLE_SM_SC_PASSKEY_BYTES     4
 #define BLE_SM_SC_PASSKEY_BITS      20
 
-static uint8_t ble_sm_sc_pub_key[64];
-static uint8_t ble_sm_sc_priv_key[32];
+struct ble_sm_sc_key {
+    uint8_t pub[64];
+    uint8_t priv[32];
+};
+
+/** Local key pair assigned to new pairing procedures. */
+static struct ble_sm_sc_key ble_sm_sc_key;
 
 /**
  * Whether our public-private key pair has been generated.  We generate it on
@@ -39,6 +44,64 @@ static uint8_t ble_sm_sc_priv_key[32];
  */
 static uint8_t ble_sm_sc_keys_generated;
 
+/** Number of pairing procedures which used current local key pair. */
+static uint16_t ble_sm_sc_key_uses;
+
+/**
+ * Key pair used for OOB pairing.  Local OOB data commits to our public key so
+ * this key pair is kept until new OOB data is generated.
+ */
+static struct ble_sm_sc_key ble_sm_sc_oob_key;
+static uint8_t ble_sm_sc_oob_key_valid;
+
+/** Event queue for key pair generation and DHKey calculation. */
+static struct ble_npl_eventq *ble_sm_sc_crypto_evq;
+
+#if MYNEWT_VAL(BLE_SM_SC_KEY_POOL_SIZE) > 0
+static struct ble_sm_sc_key
+ble_sm_sc_key_pool[MYNEWT_VAL(BLE_SM_SC_KEY_POOL_SIZE)];
+static uint8_t ble_sm_sc_key_pool_cnt;
+static struct ble_npl_event ble_sm_sc_key_pool_ev;
+#endif
+
+/**
+ * Generates local key pair for procedures which wait for it, so that it is
+ * never generated in place with host lock held.
+ */
+static struct ble_npl_event ble_sm_sc_keygen_ev;
+/** Resumes procedures waiting for local key pair; runs on host event queue. */
+static struct ble_npl_event ble_sm_sc_key_ready_ev;
+/** Status of the last key pair generation run by ble_sm_sc_keygen_ev. */
+static int ble_sm_sc_keygen_status;
+
+/** Connections whose pairing procedure waits for local key pair. */
+static uint16_t ble_sm_sc_key_wait_conns[MYNEWT_VAL(BLE_SM_MAX_PROCS)];
+static uint8_t ble_sm_sc_key_wait_cnt;
+
+#if MYNEWT_VAL(BLE_SM_SC_ASYNC_DHKEY)
+struct ble_sm_sc_dhkey_job {
+    /* Runs calculation on the crypto event queue. */
+    struct ble_npl_event exec_ev;
+    /* Delivers the result on the host event queue. */
+    struct ble_npl_event done_ev;
+
+    /* Non-zero if job is in use; matches ble_sm_proc::dhkey_job_id. */
+    uint16_t id;
+    uint16_t conn_handle;
+    int status;
+    uint8_t peer_pub[64];
+    uint8_t priv[32];
+    uint8_t dhkey[32];
+};
+
+static struct ble_sm_sc_dhkey_job
+ble_sm_sc_dhkey_jobs[MYNEWT_VAL(BLE_SM_MAX_PROCS)];
+static uint16_t ble_sm_sc_dhkey_job_next_id;
+#endif
+
+/** Whether SM crypto events have been initialized. */
+static uint8_t ble_sm_sc_events_initialized;
+
 /**
  * Create some shortened names for the passkey actions so that the table is
  * easier to read.
@@ -95,6 +158,27 @@ ble_sm_dbg_set_sc_keys(uint8_t *pubkey, uint8_t *privkey)
     ble_sm_dbg_sc_keys_set = 1;
 }
 
+int
+ble_sm_dbg_sc_key_pool_cnt(void)
+{
+#if MYNEWT_VAL(BLE_SM_SC_KEY_POOL_SIZE) > 0
+    return ble_sm_sc_key_pool_cnt;
+#else
+    return 0;
+#endif
+}
+
+void
+ble_sm_dbg_sc_key_pool_drain(void)
+{
+#if MYNEWT_VAL(BLE_SM_SC_KEY_POOL_SIZE) > 0
+    ble_hs_lock();
+    memset(ble_sm_sc_key_pool, 0, sizeof ble_sm_sc_key_pool);
+    ble_sm_sc_key_pool_cnt = 0;
+    ble_hs_unlock();
+#endif
+}
+
 #endif
 
 int
@@ -172,30 +256,514 @@ ble_sm_gen_pub_priv(uint8_t *pub, uint8_t *priv)
     return 0;
 }
 
+static struct ble_npl_eventq *
+ble_sm_sc_crypto_evq_get(void)
+{
+    if (ble_sm_sc_crypto_evq != NULL) {
+        return ble_sm_sc_crypto_evq;
+    }
+
+    return ble_hs_evq_get();
+}
+
+void
+ble_sm_sc_crypto_evq_set(struct ble_npl_eventq *evq)
+{
+    ble_sm_sc_crypto_evq = evq;
+}
+
+#if MYNEWT_VAL(BLE_SM_SC_KEY_POOL_SIZE) > 0
+static void
+ble_sm_sc_key_pool_refill(void)
+{
+    if (ble_sm_sc_key_pool_cnt < MYNEWT_VAL(BLE_SM_SC_KEY_POOL_SIZE)) {
+        ble_npl_eventq_put(ble_sm_sc_crypto_evq_get(),
+                           &ble_sm_sc_key_pool_ev);
+    }
+}
+
+/**
+ * Generates a single key pair and adds it to the pool.  Runs on the crypto
+ * event queue; the event is re-posted until the pool is full so that other
+ * events on that queue are not blocked for more than one key generation.
+ */
+static void
+ble_sm_sc_key_pool_event_fn(struct ble_npl_event *ev)
+{
+    struct ble_sm_sc_key key;
+    int rc;
+
+    rc = ble_sm_alg_gen_key_pair(key.pub, key.priv);
+    if (rc != 0) {
+        return;
+    }
+
+    ble_hs_lock();
+    if (ble_sm_sc_key_pool_cnt < MYNEWT_VAL(BLE_SM_SC_KEY_POOL_SIZE)) {
+        ble_sm_sc_key_pool[ble_sm_sc_key_pool_cnt++] = key;
+    }
+    ble_sm_sc_key_pool_refill();
+    ble_hs_unlock();
+
+    memset(&key, 0, sizeof key);
+}
+
+static int
+ble_sm_sc_key_pool_get(struct ble_sm_sc_key *key)
+{
+    BLE_HS_DBG_ASSERT(ble_hs_locked_by_cur_task());
+
+    ble_sm_sc_key_pool_refill();
+
+    if (ble_sm_sc_key_pool_cnt == 0) {
+        return BLE_HS_ENOENT;
+    }
+
+    ble_sm_sc_key_pool_cnt--;
+    *key = ble_sm_sc_key_pool[ble_sm_sc_key_pool_cnt];
+    memset(&ble_sm_sc_key_pool[ble_sm_sc_key_pool_cnt], 0, sizeof *key);
+
+    return 0;
+}
+#endif
+
+/**
+ * Provides a fresh local key pair; taken from the pool if possible and
+ * generated in place otherwise.
+ */
+static int
+ble_sm_sc_key_new(struct ble_sm_sc_key *key)
+{
+#if MYNEWT_VAL(BLE_SM_SC_KEY_POOL_SIZE) > 0
+#if MYNEWT_VAL(BLE_HS_DEBUG)
+    if (!ble_sm_dbg_sc_keys_set && ble_sm_sc_key_pool_get(key) == 0) {
+        return 0;
+    }
+#else
+    if (ble_sm_sc_key_pool_get(key) == 0) {
+        return 0;
+    }
+#endif
+#endif
+
+    return ble_sm_gen_pub_priv(key->pub, key->priv);
+}
+
+/**
+ * Whether local key pair has to be replaced before it is used again.
+ */
+static int
+ble_sm_sc_key_expired(void)
+{
+    return !ble_sm_sc_keys_generated ||
+           (MYNEWT_VAL(BLE_SM_SC_KEY_MAX_REUSE) > 0 &&
+            ble_sm_sc_key_uses >= MYNEWT_VAL(BLE_SM_SC_KEY_MAX_REUSE));
+}
+
 static int
 ble_sm_sc_ensure_keys_generated(void)
 {
     int rc;
 
-    if (!ble_sm_sc_keys_generated) {
-        rc = ble_sm_gen_pub_priv(ble_sm_sc_pub_key, ble_sm_sc_priv_key);
+    BLE_HS_DBG_ASSERT(ble_hs_locked_by_cur_task());
+
+    if (ble_sm_sc_key_expired()) {
+        rc = ble_sm_sc_key_new(&ble_sm_sc_key);
         if (rc != 0) {
             return rc;
         }
 
         ble_sm_sc_keys_generated = 1;
+        ble_sm_sc_key_uses = 0;
     }
 
     BLE_HS_LOG(DEBUG, "our pubkey=");
-    ble_hs_log_flat_buf(&ble_sm_sc_pub_key, 64);
+    ble_hs_log_flat_buf(&ble_sm_sc_key.pub, 64);
     BLE_HS_LOG(DEBUG, "\n");
     BLE_HS_LOG(DEBUG, "our privkey=");
-    ble_hs_log_flat_buf(&ble_sm_sc_priv_key, 32);
+    ble_hs_log_flat_buf(&ble_sm_sc_key.priv, 32);
     BLE_HS_LOG(DEBUG, "\n");
 
     return 0;
 }
 
+/**
+ * Generates a new local key pair in advance if it would otherwise be
+ * generated in place with host lock held, i.e. if current key pair has to be
+ * replaced and no key pair is available in the pool.  Must be called without
+ * host lock held.
+ */
+static int
+ble_sm_sc_keys_prepare(void)
+{
+    struct ble_sm_sc_key key;
+    int gen;
+    int rc;
+
+    BLE_HS_DBG_ASSERT(!ble_hs_locked_by_cur_task());
+
+    ble_hs_lock();
+    gen = ble_sm_sc_key_expired();
+#if MYNEWT_VAL(BLE_SM_SC_KEY_POOL_SIZE) > 0
+    if (ble_sm_sc_key_pool_cnt > 0) {
+        gen = 0;
+    }
+#endif
+    ble_hs_unlock();
+
+    if (!gen) {
+        return 0;
+    }
+
+    rc = ble_sm_gen_pub_priv(key.pub, key.priv);
+    if (rc != 0) {
+        return rc;
+    }
+
+    ble_hs_lock();
+    /* Key pair may have been replaced meanwhile. */
+    if (ble_sm_sc_key_expired()) {
+        ble_sm_sc_key = key;
+        ble_sm_sc_keys_generated = 1;
+        ble_sm_sc_key_uses = 0;
+    }
+    ble_hs_unlock();
+
+    memset(&key, 0, sizeof key);
+
+    return 0;
+}
+
+/**
+ * Whether local key pair can be assigned to the procedure without generating
+ * it in place.
+ */
+static int
+ble_sm_sc_key_available(const struct ble_sm_proc *proc)
+{
+    if (proc->flags & BLE_SM_PROC_F_SC_KEYS) {
+        return 1;
+    }
+
+    if (proc->pair_alg == BLE_SM_PAIR_ALG_OOB && ble_sm_sc_oob_key_valid) {
+        return 1;
+    }
+
+    if (!ble_sm_sc_key_expired()) {
+        return 1;
+    }
+
+#if MYNEWT_VAL(BLE_SM_SC_KEY_POOL_SIZE) > 0
+    if (ble_sm_sc_key_pool_cnt > 0) {
+        return 1;
+    }
+#endif
+
+    return 0;
+}
+
+/**
+ * Whether pairing procedure on the connection waits for local key pair, i.e.
+ * we initiated it and have not sent our public key yet.
+ */
+static int
+ble_sm_sc_key_waits(uint16_t conn_handle)
+{
+    struct ble_sm_proc *proc;
+
+    BLE_HS_DBG_ASSERT(ble_hs_locked_by_cur_task());
+
+    proc = ble_sm_proc_find(conn_handle, BLE_SM_PROC_STATE_PUBLIC_KEY, 1,
+                            NULL);
+
+    return proc != NULL && !(proc->flags & BLE_SM_PROC_F_SC_KEYS);
+}
+
+/**
+ * Makes the procedure wait for local key pair; it is generated on the crypto
+ * event queue and the procedure is resumed from ble_sm_sc_key_ready_ev.
+ */
+static void
+ble_sm_sc_key_wait(struct ble_sm_proc *proc)
+{
+    int i;
+
+    BLE_HS_DBG_ASSERT(ble_hs_locked_by_cur_task());
+
+    /* Drop connections whose procedure has gone meanwhile. */
+    i = 0;
+    while (i < ble_sm_sc_key_wait_cnt) {
+        if (ble_sm_sc_key_wait_conns[i] != proc->conn_handle &&
+            !ble_sm_sc_key_waits(ble_sm_sc_key_wait_conns[i])) {
+
+            ble_sm_sc_key_wait_cnt--;
+            ble_sm_sc_key_wait_conns[i] =
+                ble_sm_sc_key_wait_conns[ble_sm_sc_key_wait_cnt];
+        } else {
+            i++;
+        }
+    }
+
+    for (i = 0; i < ble_sm_sc_key_wait_cnt; i++) {
+        if (ble_sm_sc_key_wait_conns[i] == proc->conn_handle) {
+            break;
+        }
+    }
+
+    if (i == ble_sm_sc_key_wait_cnt) {
+        BLE_HS_DBG_ASSERT(i < MYNEWT_VAL(BLE_SM_MAX_PROCS));
+        ble_sm_sc_key_wait_conns[ble_sm_sc_key_wait_cnt++] = proc->conn_handle;
+    }
+
+    ble_npl_eventq_put(ble_sm_sc_crypto_evq_get(), &ble_sm_sc_keygen_ev);
+}
+
+/**
+ * Generates local key pair for waiting procedures.  Runs on the crypto event
+ * queue, without host lock held.
+ */
+static void
+ble_sm_sc_keygen_event_fn(struct ble_npl_event *ev)
+{
+    struct ble_sm_sc_key key;
+    int rc;
+
+    rc = ble_sm_gen_pub_priv(key.pub, key.priv);
+
+    ble_hs_lock();
+    ble_sm_sc_keygen_status = rc;
+    /* Key pair may have been replaced meanwhile. */
+    if (rc == 0 && ble_sm_sc_key_expired()) {
+        ble_sm_sc_key = key;
+        ble_sm_sc_keys_generated = 1;
+        ble_sm_sc_key_uses = 0;
+    }
+    ble_npl_eventq_put(ble_hs_evq_get(), &ble_sm_sc_key_ready_ev);
+    ble_hs_unlock();
+
+    memset(&key, 0, sizeof key);
+}
+
+/**
+ * Resumes procedures which wait for local key pair.  Runs on the host event
+ * queue.
+ */
+static void
+ble_sm_sc_key_ready_event_fn(struct ble_npl_event *ev)
+{
+    uint16_t conns[MYNEWT_VAL(BLE_SM_MAX_PROCS)];
+    struct ble_sm_result res;
+    int status;
+    int waits;
+    int cnt;
+    int i;
+
+    ble_hs_lock();
+    cnt = ble_sm_sc_key_wait_cnt;
+    memcpy(conns, ble_sm_sc_key_wait_conns, cnt * sizeof conns[0]);
+    ble_sm_sc_key_wait_cnt = 0;
+    status = ble_sm_sc_keygen_status;
+    ble_hs_unlock();
+
+    for (i = 0; i < cnt; i++) {
+        ble_hs_lock();
+        waits = ble_sm_sc_key_waits(conns[i]);
+        ble_hs_unlock();
+
+        if (!waits) {
+            continue;
+        }
+
+        memset(&res, 0, sizeof res);
+        if (status != 0) {
+            res.app_status = status;
+            res.sm_err = BLE_SM_ERR_UNSPECIFIED;
+            res.enc_cb = 1;
+        } else {
+            /* Sends our public key; waits again if the key pair has been used
+             * up by other procedures meanwhile.
+             */
+            res.execute = 1;
+        }
+
+        ble_sm_process_result(conns[i], &res, true);
+    }
+}
+
+/**
+ * Assigns local key pair to the procedure.  Each procedure keeps its own copy
+ * since the shared key pair may be replaced before the procedure completes.
+ */
+static int
+ble_sm_sc_proc_keys(struct ble_sm_proc *proc)
+{
+    const struct ble_sm_sc_key *key;
+    int rc;
+
+    if (proc->flags & BLE_SM_PROC_F_SC_KEYS) {
+        return 0;
+    }
+
+    if (proc->pair_alg == BLE_SM_PAIR_ALG_OOB && ble_sm_sc_oob_key_valid) {
+        key = &ble_sm_sc_oob_key;
+    } else {
+        rc = ble_sm_sc_ensure_keys_generated();
+        if (rc != 0) {
+            return rc;
+        }
+
+        ble_sm_sc_key_uses++;
+        key = &ble_sm_sc_key;
+    }
+
+    memcpy(proc->pub_key_our, key->pub, sizeof proc->pub_key_our);
+    memcpy(proc->priv_key_our, key->priv, sizeof proc->priv_key_our);
+    proc->flags |= BLE_SM_PROC_F_SC_KEYS;
+
+    return 0;
+}
+
+static void ble_sm_sc_random_rx_dhkey(struct ble_sm_proc *proc,
+                                      struct ble_sm_result *res);
+
+#if MYNEWT_VAL(BLE_SM_SC_ASYNC_DHKEY)
+/**
+ * Frees the job.  Events are initialized once and are kept intact.
+ */
+static void
+ble_sm_sc_dhkey_job_clear(struct ble_sm_sc_dhkey_job *job)
+{
+    job->id = 0;
+    job->conn_handle = 0;
+    job->status = 0;
+    memset(job->peer_pub, 0, sizeof job->peer_pub);
+    memset(job->priv, 0, sizeof job->priv);
+    memset(job->dhkey, 0, sizeof job->dhkey);
+}
+
+/**
+ * Delivers result of DHKey calculation to the procedure.  Runs on the host
+ * event queue.
+ */
+static void
+ble_sm_sc_dhkey_job_done(struct ble_npl_event *ev)
+{
+    struct ble_sm_sc_dhkey_job *job;
+    struct ble_sm_result res;
+    struct ble_sm_proc *proc;
+    uint16_t conn_handle;
+
+    job = ble_npl_event_get_arg(ev);
+    memset(&res, 0, sizeof res);
+
+    ble_hs_lock();
+
+    conn_handle = job->conn_handle;
+    proc = ble_sm_proc_find(conn_handle, BLE_SM_PROC_STATE_NONE, -1, NULL);
+    if (proc != NULL && proc->dhkey_job_id == job->id) {
+        proc->dhkey_job_id = 0;
+
+        if (job->status != 0) {
+            res.app_status = BLE_HS_SM_US_ERR(BLE_SM_ERR_DHKEY);
+            res.sm_err = BLE_SM_ERR_DHKEY;
+            res.enc_cb = 1;
+        } else {
+            memcpy(proc->dhkey, job->dhkey, sizeof proc->dhkey);
+
+            if (proc->flags & BLE_SM_PROC_F_DHKEY_WAIT) {
+                proc->flags &= ~BLE_SM_PROC_F_DHKEY_WAIT;
+                ble_sm_sc_random_rx_dhkey(proc, &res);
+            } else {
+                /* Nothing waits for DHKey yet. */
+                proc = NULL;
+            }
+        }
+    } else {
+        /* Procedure is gone; result is stale. */
+        proc = NULL;
+    }
+
+    ble_sm_sc_dhkey_job_clear(job);
+
+    ble_hs_unlock();
+
+    if (proc != NULL) {
+        ble_sm_process_result(conn_handle, &res, true);
+    }
+}
+
+/**
+ * Calculates DHKey.  Runs on the crypto event queue, without host lock held.
+ */
+static void
+ble_sm_sc_dhkey_job_exec(struct ble_npl_event *ev)
+{
+    struct ble_sm_sc_dhkey_job *job;
+
+    job = ble_npl_event_get_arg(ev);
+
+    job->status = ble_sm_alg_gen_dhkey(job->peer_pub, job->peer_pub + 32,
+                                       job->priv, job->dhkey);
+    memset(job->priv, 0, sizeof job->priv);
+
+    ble_npl_eventq_put(ble_hs_evq_get(), &job->done_ev);
+}
+
+static struct ble_sm_sc_dhkey_job *
+ble_sm_sc_dhkey_job_alloc(void)
+{
+    struct ble_sm_sc_dhkey_job *job;
+    int i;
+
+    for (i = 0; i < MYNEWT_VAL(BLE_SM_MAX_PROCS); i++) {
+        job = &ble_sm_sc_dhkey_jobs[i];
+        if (job->id == 0) {
+            if (++ble_sm_sc_dhkey_job_next_id == 0) {
+                ble_sm_sc_dhkey_job_next_id = 1;
+            }
+            job->id = ble_sm_sc_dhkey_job_next_id;
+            return job;
+        }
+    }
+
+    return NULL;
+}
+#endif
+
+/**
+ * Starts DHKey calculation for the procedure.  If asynchronous calculation is
+ * enabled, the result is delivered to the procedure later; otherwise DHKey is
+ * available in the procedure on successful return.
+ */
+static int
+ble_sm_sc_gen_dhkey(struct ble_sm_proc *proc)
+{
+    int rc;
+
+#if MYNEWT_VAL(BLE_SM_SC_ASYNC_DHKEY)
+    struct ble_sm_sc_dhkey_job *job;
+
+    job = ble_sm_sc_dhkey_job_alloc();
+    if (job != NULL) {
+        job->conn_handle = proc->conn_handle;
+        memcpy(job->peer_pub, &proc->pub_key_peer, sizeof job->peer_pub);
+        memcpy(job->priv, proc->priv_key_our, sizeof job->priv);
+        memset(proc->priv_key_our, 0, sizeof proc->priv_key_our);
+        proc->dhkey_job_id = job->id;
+
+        ble_npl_eventq_put(ble_sm_sc_crypto_evq_get(), &job->exec_ev);
+        return 0;
+    }
+#endif
+
+    /* No free job; calculate DHKey in place. */
+    rc = ble_sm_alg_gen_dhkey(proc->pub_key_peer.x, proc->pub_key_peer.y,
+                              proc->priv_key_our, proc->dhkey);
+    memset(proc->priv_key_our, 0, sizeof proc->priv_key_our);
+
+    return rc;
+}
+
 /* Initiator does not send a confirm when pairing algorithm is any of:
  *     o just works
  *     o numeric comparison
@@ -321,7 +889,7 @@ ble_sm_sc_confirm_exec(struct ble_sm_proc *proc, struct ble_sm_result *res)
         return;
     }
 
-    rc = ble_sm_alg_f4(ble_sm_sc_pub_key, proc->pub_key_peer.x,
+    rc = ble_sm_alg_f4(proc->pub_key_our, proc->pub_key_peer.x,
                        ble_sm_our_pair_rand(proc), proc->ri, cmd->value);
     if (rc != 0) {
         os_mbuf_free_chain(txom);
@@ -351,11 +919,11 @@ ble_sm_sc_gen_numcmp(struct ble_sm_proc *proc, struct ble_sm_result *res)
     uint8_t *pkb;
 
     if (proc->flags & BLE_SM_PROC_F_INITIATOR) {
-        pka = ble_sm_sc_pub_key;
+        pka = proc->pub_key_our;
         pkb = proc->pub_key_peer.x;
     } else {
         pka = proc->pub_key_peer.x;
-        pkb = ble_sm_sc_pub_key;
+        pkb = proc->pub_key_our;
     }
     res->app_status = ble_sm_alg_g2(pka, pkb, proc->randm, proc->rands,
                                     &res->passkey_params.numcmp);
@@ -441,11 +1009,6 @@ void
 ble_sm_sc_random_rx(struct ble_sm_proc *proc, struct ble_sm_result *res)
 {
     uint8_t confirm_val[16];
-    uint8_t ia[6];
-    uint8_t ra[6];
-    uint8_t ioact;
-    uint8_t iat;
-    uint8_t rat;
     int rc;
 
     if (proc->pair_alg != BLE_SM_PAIR_ALG_OOB && (
@@ -456,7 +1019,7 @@ ble_sm_sc_random_rx(struct ble_sm_proc *proc, struct ble_sm_result *res)
         ble_hs_log_flat_buf(proc->tk, 16);
         BLE_HS_LOG(DEBUG, "\n");
 
-        rc = ble_sm_alg_f4(proc->pub_key_peer.x, ble_sm_sc_pub_key,
+        rc = ble_sm_alg_f4(proc->pub_key_peer.x, proc->pub_key_our,
                            ble_sm_peer_pair_rand(proc), proc->ri,
                            confirm_val);
         if (rc != 0) {
@@ -475,6 +1038,30 @@ ble_sm_sc_random_rx(struct ble_sm_proc *proc, struct ble_sm_result *res)
         }
     }
 
+#if MYNEWT_VAL(BLE_SM_SC_ASYNC_DHKEY)
+    if (proc->dhkey_job_id != 0) {
+        /* DHKey is not calculated yet; continue once it is. */
+        proc->flags |= BLE_SM_PROC_F_DHKEY_WAIT;
+        return;
+    }
+#endif
+
+    ble_sm_sc_random_rx_dhkey(proc, res);
+}
+
+/**
+ * Second part of random value processing which requires DHKey.
+ */
+static void
+ble_sm_sc_random_rx_dhkey(struct ble_sm_proc *proc, struct ble_sm_result *res)
+{
+    uint8_t ia[6];
+    uint8_t ra[6];
+    uint8_t ioact;
+    uint8_t iat;
+    uint8_t rat;
+    int rc;
+
     /* Calculate the mac key and ltk. */
     ble_sm_ia_ra(proc, &iat, ia, &rat, ra);
     rc = ble_sm_alg_f5(proc->dhkey, proc->randm, proc->rands,
@@ -540,7 +1127,13 @@ ble_sm_sc_public_key_exec(struct ble_sm_proc *proc, struct ble_sm_result *res,
     uint8_t ioact;
     int rc;
 
-    res->app_status = ble_sm_sc_ensure_keys_generated();
+    if (!ble_sm_sc_key_available(proc)) {
+        /* Host lock is held; public key is sent once key pair is generated. */
+        ble_sm_sc_key_wait(proc);
+        return;
+    }
+
+    res->app_status = ble_sm_sc_proc_keys(proc);
     if (res->app_status != 0) {
         res->enc_cb = 1;
         res->sm_err = BLE_SM_ERR_UNSPECIFIED;
@@ -555,8 +1148,8 @@ ble_sm_sc_public_key_exec(struct ble_sm_proc *proc, struct ble_sm_result *res,
         return;
     }
 
-    memcpy(cmd->x, ble_sm_sc_pub_key + 0, 32);
-    memcpy(cmd->y, ble_sm_sc_pub_key + 32, 32);
+    memcpy(cmd->x, proc->pub_key_our + 0, 32);
+    memcpy(cmd->y, proc->pub_key_our + 32, 32);
 
     res->app_status = ble_sm_tx(proc->conn_handle, txom);
     if (res->app_status != 0) {
@@ -604,7 +1197,8 @@ ble_sm_sc_public_key_rx(uint16_t conn_handle, struct os_mbuf **om,
         return;
     }
 
-    res->app_status = ble_sm_sc_ensure_keys_generated();
+    /* Keep P-256 key generation out of the host lock. */
+    res->app_status = ble_sm_sc_keys_prepare();
     if (res->app_status != 0) {
         res->enc_cb = 1;
         res->sm_err = BLE_SM_ERR_UNSPECIFIED;
@@ -612,13 +1206,6 @@ ble_sm_sc_public_key_rx(uint16_t conn_handle, struct os_mbuf **om,
     }
 
     cmd = (struct ble_sm_public_key *)(*om)->om_data;
-    /* Check if the X component of peer public key is same as X
-     * component of our generated public key. Return fail if they match. */
-    if (memcmp(cmd->x, ble_sm_sc_pub_key, 32) == 0) {
-        res->enc_cb = 1;
-        res->sm_err = BLE_SM_ERR_AUTHREQ;
-        return;
-    }
 
     ble_hs_lock();
     proc = ble_sm_proc_find(conn_handle, BLE_SM_PROC_STATE_PUBLIC_KEY, -1,
@@ -631,12 +1218,17 @@ ble_sm_sc_public_key_rx(uint16_t conn_handle, struct os_mbuf **om,
         res->app_status = BLE_HS_ENOENT;
         res->sm_err = BLE_SM_ERR_UNSPECIFIED;
         res->out_of_order = 1;
+    } else if ((res->app_status = ble_sm_sc_proc_keys(proc)) != 0) {
+        res->enc_cb = 1;
+        res->sm_err = BLE_SM_ERR_UNSPECIFIED;
+    } else if (memcmp(cmd->x, proc->pub_key_our, 32) == 0) {
+        /* Check if the X component of peer public key is same as X
+         * component of our generated public key. Return fail if they match. */
+        res->enc_cb = 1;
+        res->sm_err = BLE_SM_ERR_AUTHREQ;
     } else {
         memcpy(&proc->pub_key_peer, cmd, sizeof(*cmd));
-        rc = ble_sm_alg_gen_dhkey(proc->pub_key_peer.x,
-                                  proc->pub_key_peer.y,
-                                  ble_sm_sc_priv_key,
-                                  proc->dhkey);
+        rc = ble_sm_sc_gen_dhkey(proc);
         if (rc != 0) {
             res->app_status = BLE_HS_SM_US_ERR(BLE_SM_ERR_DHKEY);
             res->sm_err = BLE_SM_ERR_DHKEY;
@@ -898,7 +1490,19 @@ ble_sm_sc_oob_generate_data(struct ble_sm_sc_oob_data *oob_data)
     return BLE_HS_ENOTSUP;
 #endif
 
+    rc = ble_sm_sc_keys_prepare();
+    if (rc) {
+        return rc;
+    }
+
+    ble_hs_lock();
     rc = ble_sm_sc_ensure_keys_generated();
+    if (rc == 0) {
+        ble_sm_sc_oob_key = ble_sm_sc_key;
+        ble_sm_sc_oob_key_valid = 1;
+    }
+    ble_hs_unlock();
+
     if (rc) {
         return rc;
     }
@@ -908,8 +1512,8 @@ ble_sm_sc_oob_generate_data(struct ble_sm_sc_oob_data *oob_data)
         return rc;
     }
 
-    rc = ble_sm_alg_f4(ble_sm_sc_pub_key, ble_sm_sc_pub_key, oob_data->r, 0,
-                       oob_data->c);
+    rc = ble_sm_alg_f4(ble_sm_sc_oob_key.pub, ble_sm_sc_oob_key.pub,
+                       oob_data->r, 0, oob_data->c);
     if (rc) {
         return rc;
     }
@@ -917,11 +1521,97 @@ ble_sm_sc_oob_generate_data(struct ble_sm_sc_oob_data *oob_data)
     return 0;
 }
 
+/**
+ * Called when host is synced with controller; starts filling the key pool.
+ */
+void
+ble_sm_sc_sync(void)
+{
+#if MYNEWT_VAL(BLE_SM_SC_KEY_POOL_SIZE) > 0
+    ble_hs_lock();
+    ble_sm_sc_key_pool_refill();
+    ble_hs_unlock();
+#endif
+}
+
 void
 ble_sm_sc_init(void)
 {
+#if MYNEWT_VAL(BLE_SM_SC_ASYNC_DHKEY)
+    struct ble_sm_sc_dhkey_job *job;
+    int i;
+#endif
+
     ble_sm_alg_ecc_init();
     ble_sm_sc_keys_generated = 0;
+    ble_sm_sc_key_uses = 0;
+    ble_sm_sc_oob_key_valid = 0;
+    ble_sm_sc_key_wait_cnt = 0;
+
+    /* Events may still be queued if host is reinitialized; they are
+     * initialized only once so that a queued event is never overwritten.
+     */
+    if (!ble_sm_sc_events_initialized) {
+        ble_npl_event_init(&ble_sm_sc_keygen_ev,
+                           ble_sm_sc_keygen_event_fn, NULL);
+        ble_npl_event_init(&ble_sm_sc_key_ready_ev,
+                           ble_sm_sc_key_ready_event_fn, NULL);
+
+#if MYNEWT_VAL(BLE_SM_SC_KEY_POOL_SIZE) > 0
+        ble_npl_event_init(&ble_sm_sc_key_pool_ev,
+                           ble_sm_sc_key_pool_event_fn, NULL);
+#endif
+
+#if MYNEWT_VAL(BLE_SM_SC_ASYNC_DHKEY)
+        for (i = 0; i < MYNEWT_VAL(BLE_SM_MAX_PROCS); i++) {
+            job = &ble_sm_sc_dhkey_jobs[i];
+            ble_npl_event_init(&job->exec_ev, ble_sm_sc_dhkey_job_exec, job);
+            ble_npl_event_init(&job->done_ev, ble_sm_sc_dhkey_job_done, job);
+        }
+#endif
+
+        ble_sm_sc_events_initialized = 1;
+    }
+
+#if MYNEWT_VAL(BLE_SM_SC_ASYNC_DHKEY)
+    /* Jobs which are still queued free themselves once they complete. */
+    for (i = 0; i < MYNEWT_VAL(BLE_SM_MAX_PROCS); i++) {
+        job = &ble_sm_sc_dhkey_jobs[i];
+        if (!ble_npl_event_is_queued(&job->exec_ev) &&
+            !ble_npl_event_is_queued(&job->done_ev)) {
+            ble_sm_sc_dhkey_job_clear(job);
+        }
+    }
+#endif
+}
+
+void
+ble_sm_sc_deinit(void)
+{
+#if MYNEWT_VAL(BLE_SM_SC_ASYNC_DHKEY)
+    int i;
+#endif
+
+    if (!ble_sm_sc_events_initialized) {
+        return;
+    }
+
+    ble_npl_event_deinit(&ble_sm_sc_keygen_ev);
+    ble_npl_event_deinit(&ble_sm_sc_key_ready_ev);
+
+#if MYNEWT_VAL(BLE_SM_SC_KEY_POOL_SIZE) > 0
+    ble_npl_event_deinit(&ble_sm_sc_key_pool_ev);
+#endif
+
+#if MYNEWT_VAL(BLE_SM_SC_ASYNC_DHKEY)
+    for (i = 0; i < MYNEWT_VAL(BLE_SM_MAX_PROCS); i++) {
+        ble_npl_event_deinit(&ble_sm_sc_dhkey_jobs[i].exec_ev);
+        ble_npl_event_deinit(&ble_sm_sc_dhkey_jobs[i].done_ev);
+        ble_sm_sc_dhkey_job_clear(&ble_sm_sc_dhkey_jobs[i]);
+    }
+#endif
+
+    ble_sm_sc_events_initialized = 0;
 }
 
 #endif  /* MYNEWT_VAL(BLE_SM_SC) */
@@ -407,3 +407,40 @@ ble_uuid_length(const ble_uuid_t *uuid)
 
     return uuid->type >> 3;
 }
+
+uint32_t
+ble_uuid_hash(const ble_uuid_t *uuid)
+{
+    const uint8_t *val;
+    uint32_t hash;
+    int i;
+
+    VERIFY_UUID(uuid);
+
+    switch (uuid->type) {
+    case BLE_UUID_TYPE_16:
+        return BLE_UUID16(uuid)->value;
+    case BLE_UUID_TYPE_32:
+        return BLE_UUID32(uuid)->value;
+    case BLE_UUID_TYPE_128:
+        val = BLE_UUID128(uuid)->value;
+
+        /* UUIDs derived from the Bluetooth Base UUID fold to the same key as
+         * their 16- or 32-bit short form.
+         */
+        if (memcmp(val, ble_uuid_base, 12) == 0) {
+            return get_le32(val + 12);
+        }
+
+        /* FNV-1a */
+        hash = 2166136261UL;
+        for (i = 0; i < 16; i++) {
+            hash ^= val[i];
+            hash *= 16777619UL;
+        }
+        return hash;
+    default:
+        BLE_HS_DBG_ASSERT(0);
+        return 0;
+    }
+}
@@ -38,6 +38,13 @@ int ble_uuid_to_mbuf(const ble_uuid_t *uuid, struct os_mbuf *om);
 int ble_uuid_flat(const ble_uuid_t *uuid, void *dst);
 int ble_uuid_length(const ble_uuid_t *uuid);
 
+/**
+ * Computes a 32-bit lookup key for the specified UUID.  16- and 32-bit UUIDs
+ * and their 128-bit Base UUID forms produce identical keys; distinct UUIDs
+ * may collide, so callers must confirm a match with ble_uuid_cmp().
+ */
+uint32_t ble_uuid_hash(const ble_uuid_t *uuid);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,330 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "sysinit/sysinit.h"
+#include "syscfg/syscfg.h"
+#include "testutil/testutil.h"
+#include "nimble/hci_common.h"
+#include "nimble/transport.h"
+#include "host/ble_hs.h"
+#include "ble_hs_priv.h"
+
+#define BLE_HS_PERIODIC_SYNC_TEST_HANDLE    0x0003
+#define BLE_HS_PERIODIC_SYNC_TEST_FRAG_LEN  200
+
+static int ble_hs_periodic_sync_test_num_trains;
+static uint8_t ble_hs_periodic_sync_test_status;
+static uint16_t ble_hs_periodic_sync_test_len;
+static uint8_t ble_hs_periodic_sync_test_data[BLE_HS_PERIODIC_SYNC_TRAIN_MAX_LEN];
+
+static int ble_hs_periodic_sync_test_mbufs;
+
+/* The controller side of the transport; nothing is sent in these tests. */
+int
+ble_transport_to_ll_acl_impl(struct os_mbuf *om)
+{
+    os_mbuf_free_chain(om);
+    return 0;
+}
+
+int
+ble_transport_to_ll_cmd_impl(void *buf)
+{
+    ble_transport_free(buf);
+    return 0;
+}
+
+void
+ble_transport_ll_init(void)
+{
+    /* nothing here */
+}
+
+static void
+ble_hs_periodic_sync_test_init(void)
+{
+    sysinit();
+    ble_hs_periodic_sync_test_num_trains = 0;
+    ble_hs_periodic_sync_test_mbufs = os_msys_num_free();
+}
+
+static void
+ble_hs_periodic_sync_test_assert_mbufs_freed(void)
+{
+    TEST_ASSERT(os_msys_num_free() == ble_hs_periodic_sync_test_mbufs);
+}
+
+static int
+ble_hs_periodic_sync_test_cb(struct ble_gap_event *event, void *arg)
+{
+    int rc;
+
+    TEST_ASSERT_FATAL(event->type == BLE_GAP_EVENT_PERIODIC_TRAIN);
+    TEST_ASSERT(event->periodic_train.sync_handle ==
+                BLE_HS_PERIODIC_SYNC_TEST_HANDLE);
+
+    ble_hs_periodic_sync_test_num_trains++;
+    ble_hs_periodic_sync_test_status = event->periodic_train.data_status;
+    ble_hs_periodic_sync_test_len = event->periodic_train.data_length;
+
+    if (event->periodic_train.om != NULL) {
+        TEST_ASSERT_FATAL(OS_MBUF_PKTLEN(event->periodic_train.om) ==
+                          event->periodic_train.data_length);
+        rc = os_mbuf_copydata(event->periodic_train.om, 0,
+                              event->periodic_train.data_length,
+                              ble_hs_periodic_sync_test_data);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    return 0;
+}
+
+static void
+ble_hs_periodic_sync_test_rx_rpt(uint16_t sync_handle, uint8_t data_status,
+                                 const uint8_t *data, uint8_t data_len)
+{
+    struct ble_hci_ev_le_subev_periodic_adv_rpt *ev;
+    struct ble_hci_ev *hci_ev;
+    int rc;
+
+    hci_ev = ble_transport_alloc_evt(0);
+    TEST_ASSERT_FATAL(hci_ev != NULL);
+
+    hci_ev->opcode = BLE_HCI_EVCODE_LE_META;
+    hci_ev->length = sizeof(*ev) + data_len;
+
+    ev = (void *)hci_ev->data;
+    ev->subev_code = BLE_HCI_LE_SUBEV_PERIODIC_ADV_RPT;
+    ev->sync_handle = htole16(sync_handle);
+    ev->tx_power = 127;
+    ev->rssi = -40;
+    ev->cte_type = 0xff;
+    ev->data_status = data_status;
+    ev->data_len = data_len;
+    memcpy(ev->data, data, data_len);
+
+    rc = ble_hs_hci_evt_process(hci_ev);
+    TEST_ASSERT_FATAL(rc == 0);
+}
+
+/**
+ * Sends a train split into fragments of at most
+ * BLE_HS_PERIODIC_SYNC_TEST_FRAG_LEN bytes.  The last fragment carries
+ * last_status.
+ */
+static void
+ble_hs_periodic_sync_test_rx_train(const uint8_t *data, int len,
+                                   uint8_t last_status)
+{
+    int frag_len;
+    int off;
+
+    off = 0;
+    do {
+        frag_len = min(len - off, BLE_HS_PERIODIC_SYNC_TEST_FRAG_LEN);
+        ble_hs_periodic_sync_test_rx_rpt(
+            BLE_HS_PERIODIC_SYNC_TEST_HANDLE,
+            off + frag_len < len ? BLE_HCI_PERIODIC_DATA_STATUS_INCOMPLETE :
+                                   last_status,
+            data + off, frag_len);
+        off += frag_len;
+    } while (off < len);
+}
+
+static struct ble_hs_periodic_sync *
+ble_hs_periodic_sync_test_add(int filter_unchanged)
+{
+    struct ble_hs_periodic_sync *psync;
+
+    ble_hs_lock();
+
+    psync = ble_hs_periodic_sync_alloc();
+    TEST_ASSERT_FATAL(psync != NULL);
+
+    psync->sync_handle = BLE_HS_PERIODIC_SYNC_TEST_HANDLE;
+    psync->cb = ble_hs_periodic_sync_test_cb;
+    psync->rpt_filter_unchanged = filter_unchanged;
+    ble_hs_periodic_sync_insert(psync);
+
+    ble_hs_unlock();
+
+    return psync;
+}
+
+static void
+ble_hs_periodic_sync_test_remove(struct ble_hs_periodic_sync *psync)
+{
+    ble_hs_lock();
+    ble_hs_periodic_sync_remove(psync);
+    ble_hs_unlock();
+
+    ble_hs_periodic_sync_free(psync);
+}
+
+TEST_CASE_SELF(ble_hs_periodic_sync_test_reassembly)
+{
+    struct ble_hs_periodic_sync *psync;
+    uint8_t data[BLE_HS_PERIODIC_SYNC_TRAIN_MAX_LEN];
+    int i;
+
+    ble_hs_periodic_sync_test_init();
+
+    for (i = 0; i < sizeof data; i++) {
+        data[i] = i * 7;
+    }
+
+    psync = ble_hs_periodic_sync_test_add(0);
+
+    /*** Single-fragment train. */
+    ble_hs_periodic_sync_test_rx_train(data, 31,
+                                       BLE_HCI_PERIODIC_DATA_STATUS_COMPLETE);
+    TEST_ASSERT(ble_hs_periodic_sync_test_num_trains == 1);
+    TEST_ASSERT(ble_hs_periodic_sync_test_status ==
+                BLE_HCI_PERIODIC_DATA_STATUS_COMPLETE);
+    TEST_ASSERT(ble_hs_periodic_sync_test_len == 31);
+    TEST_ASSERT(memcmp(ble_hs_periodic_sync_test_data, data, 31) == 0);
+
+    /*** Maximum-length train; delivered only after the last fragment. */
+    ble_hs_periodic_sync_test_rx_rpt(BLE_HS_PERIODIC_SYNC_TEST_HANDLE,
+                                     BLE_HCI_PERIODIC_DATA_STATUS_INCOMPLETE,
+                                     data, BLE_HS_PERIODIC_SYNC_TEST_FRAG_LEN);
+    TEST_ASSERT(ble_hs_periodic_sync_test_num_trains == 1);
+    ble_hs_periodic_sync_test_rx_train(
+        data + BLE_HS_PERIODIC_SYNC_TEST_FRAG_LEN,
+        sizeof data - BLE_HS_PERIODIC_SYNC_TEST_FRAG_LEN,
+        BLE_HCI_PERIODIC_DATA_STATUS_COMPLETE);
+    TEST_ASSERT(ble_hs_periodic_sync_test_num_trains == 2);
+    TEST_ASSERT(ble_hs_periodic_sync_test_status ==
+                BLE_HCI_PERIODIC_DATA_STATUS_COMPLETE);
+    TEST_ASSERT(ble_hs_periodic_sync_test_len == sizeof data);
+    TEST_ASSERT(memcmp(ble_hs_periodic_sync_test_data, data,
+                       sizeof data) == 0);
+
+    /*** Train truncated by the controller. */
+    ble_hs_periodic_sync_test_rx_train(data, 450,
+                                       BLE_HCI_PERIODIC_DATA_STATUS_TRUNCATED);
+    TEST_ASSERT(ble_hs_periodic_sync_test_num_trains == 3);
+    TEST_ASSERT(ble_hs_periodic_sync_test_status ==
+                BLE_HCI_PERIODIC_DATA_STATUS_TRUNCATED);
+    TEST_ASSERT(ble_hs_periodic_sync_test_len == 450);
+
+    /*** Train exceeding the maximum length is truncated by the host. */
+    ble_hs_periodic_sync_test_rx_train(data, sizeof data,
+                                       BLE_HCI_PERIODIC_DATA_STATUS_INCOMPLETE);
+    ble_hs_periodic_sync_test_rx_train(data, 10,
+                                       BLE_HCI_PERIODIC_DATA_STATUS_COMPLETE);
+    TEST_ASSERT(ble_hs_periodic_sync_test_num_trains == 4);
+    TEST_ASSERT(ble_hs_periodic_sync_test_status ==
+                BLE_HCI_PERIODIC_DATA_STATUS_TRUNCATED);
+    TEST_ASSERT(ble_hs_periodic_sync_test_len == sizeof data);
+
+    /*** Reports for an unknown sync are ignored. */
+    ble_hs_periodic_sync_test_rx_rpt(BLE_HS_PERIODIC_SYNC_TEST_HANDLE + 1,
+                                     BLE_HCI_PERIODIC_DATA_STATUS_COMPLETE,
+                                     data, 10);
+    TEST_ASSERT(ble_hs_periodic_sync_test_num_trains == 4);
+
+    /*** Freeing a sync releases a partially reassembled train. */
+    ble_hs_periodic_sync_test_rx_rpt(BLE_HS_PERIODIC_SYNC_TEST_HANDLE,
+                                     BLE_HCI_PERIODIC_DATA_STATUS_INCOMPLETE,
+                                     data, BLE_HS_PERIODIC_SYNC_TEST_FRAG_LEN);
+    ble_hs_periodic_sync_test_remove(psync);
+
+    ble_hs_periodic_sync_test_assert_mbufs_freed();
+}
+
+TEST_CASE_SELF(ble_hs_periodic_sync_test_filter_unchanged)
+{
+    struct ble_hs_periodic_sync *psync;
+    uint8_t data[600];
+    int i;
+
+    ble_hs_periodic_sync_test_init();
+
+    for (i = 0; i < sizeof data; i++) {
+        data[i] = i;
+    }
+
+    psync = ble_hs_periodic_sync_test_add(1);
+
+    ble_hs_periodic_sync_test_rx_train(data, sizeof data,
+                                       BLE_HCI_PERIODIC_DATA_STATUS_COMPLETE);
+    TEST_ASSERT(ble_hs_periodic_sync_test_num_trains == 1);
+
+    /*** Identical train is dropped. */
+    ble_hs_periodic_sync_test_rx_train(data, sizeof data,
+                                       BLE_HCI_PERIODIC_DATA_STATUS_COMPLETE);
+    TEST_ASSERT(ble_hs_periodic_sync_test_num_trains == 1);
+
+    /*** Changed payload is reported. */
+    data[sizeof data - 1] ^= 0xff;
+    ble_hs_periodic_sync_test_rx_train(data, sizeof data,
+                                       BLE_HCI_PERIODIC_DATA_STATUS_COMPLETE);
+    TEST_ASSERT(ble_hs_periodic_sync_test_num_trains == 2);
+    TEST_ASSERT(memcmp(ble_hs_periodic_sync_test_data, data,
+                       sizeof data) == 0);
+
+    /*** Trains are compared against the last reported one only. */
+    data[sizeof data - 1] ^= 0xff;
+    ble_hs_periodic_sync_test_rx_train(data, sizeof data,
+                                       BLE_HCI_PERIODIC_DATA_STATUS_COMPLETE);
+    TEST_ASSERT(ble_hs_periodic_sync_test_num_trains == 3);
+
+    /*** A change in the first fragment is reported. */
+    data[0] ^= 0xff;
+    ble_hs_periodic_sync_test_rx_train(data, sizeof data,
+                                       BLE_HCI_PERIODIC_DATA_STATUS_COMPLETE);
+    TEST_ASSERT(ble_hs_periodic_sync_test_num_trains == 4);
+
+    /*** Truncated trains are always reported. */
+    ble_hs_periodic_sync_test_rx_train(data, 100,
+                                       BLE_HCI_PERIODIC_DATA_STATUS_TRUNCATED);
+    ble_hs_periodic_sync_test_rx_train(data, 100,
+                                       BLE_HCI_PERIODIC_DATA_STATUS_TRUNCATED);
+    TEST_ASSERT(ble_hs_periodic_sync_test_num_trains == 6);
+
+    /*** Shorter train with the same prefix is reported. */
+    ble_hs_periodic_sync_test_rx_train(data, sizeof data - 1,
+                                       BLE_HCI_PERIODIC_DATA_STATUS_COMPLETE);
+    TEST_ASSERT(ble_hs_periodic_sync_test_num_trains == 7);
+
+    ble_hs_periodic_sync_test_remove(psync);
+
+    ble_hs_periodic_sync_test_assert_mbufs_freed();
+}
+
+TEST_SUITE(ble_hs_periodic_sync_test_suite)
+{
+    ble_hs_periodic_sync_test_reassembly();
+    ble_hs_periodic_sync_test_filter_unchanged();
+}
+
+#if MYNEWT_VAL(SELFTEST)
+
+int
+main(int argc, char **argv)
+{
+    ble_hs_periodic_sync_test_suite();
+
+    return tu_any_failed;
+}
+
+#endif
@@ -0,0 +1,226 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "testutil/testutil.h"
+#include "ble_hs_test.h"
+#include "host/ble_aes_ccm.h"
+#include "host/ble_ead.h"
+#include "ble_hs_test_util.h"
+
+#define BLE_EAD_TEST_NUM_REPORTS    200
+#define BLE_EAD_TEST_MAX_PAYLOAD    (BLE_EAD_ENCRYPTED_PAYLOAD_SIZE(31))
+
+/* RFC 3610, Packet Vector #1 */
+static const uint8_t ble_aes_ccm_test_key[16] = {
+    0xc0, 0xc1, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7,
+    0xc8, 0xc9, 0xca, 0xcb, 0xcc, 0xcd, 0xce, 0xcf
+};
+
+static const uint8_t ble_aes_ccm_test_nonce[13] = {
+    0x00, 0x00, 0x00, 0x03, 0x02, 0x01, 0x00, 0xa0,
+    0xa1, 0xa2, 0xa3, 0xa4, 0xa5
+};
+
+static const uint8_t ble_aes_ccm_test_enc[31] = {
+    /* Encrypted message */
+    0x58, 0x8c, 0x97, 0x9a, 0x61, 0xc6, 0x63, 0xd2,
+    0xf0, 0x66, 0xd0, 0xc2, 0xc0, 0xf9, 0x89, 0x80,
+    0x6d, 0x5f, 0x6b, 0x61, 0xda, 0xc3, 0x84,
+    /* MIC */
+    0x17, 0xe8, 0xd1, 0x2c, 0xfd, 0xf9, 0x26, 0xe0
+};
+
+static const uint8_t ble_ead_test_key[BLE_EAD_KEY_SIZE] = {
+    0x57, 0x83, 0xd5, 0x21, 0x56, 0xad, 0x6f, 0x0e,
+    0x63, 0x88, 0x27, 0x4e, 0xc6, 0x70, 0x2e, 0xe0
+};
+
+static const uint8_t ble_ead_test_iv[BLE_EAD_IV_SIZE] = {
+    0x9e, 0x7a, 0x00, 0xef, 0xb1, 0x7a, 0xe7, 0x46
+};
+
+static uint8_t ble_ead_test_enc[BLE_EAD_TEST_NUM_REPORTS]
+                              [BLE_EAD_TEST_MAX_PAYLOAD];
+static uint8_t ble_ead_test_dec[BLE_EAD_TEST_NUM_REPORTS][31];
+static struct ble_ead_report ble_ead_test_reports[BLE_EAD_TEST_NUM_REPORTS];
+
+static void
+ble_ead_test_payload(int idx, uint8_t *payload, size_t len)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        payload[i] = idx * 7 + i;
+    }
+}
+
+/**
+ * Builds Encrypted Data the same way ble_ead_encrypt() does, but with
+ * Randomizer derived from report index instead of controller random.
+ */
+static void
+ble_ead_test_build(struct ble_aes_ccm_ctx *ctx, int idx, size_t payload_len,
+                   uint8_t *enc)
+{
+    static const uint8_t aad[] = { 0xea };
+    uint8_t nonce[BLE_EAD_NONCE_SIZE];
+    uint8_t payload[31];
+    int rc;
+
+    ble_ead_test_payload(idx, payload, payload_len);
+
+    put_le32(nonce, idx);
+    nonce[4] = 1 << BLE_EAD_RANDOMIZER_DIRECTION_BIT;
+    memcpy(nonce + BLE_EAD_RANDOMIZER_SIZE, ble_ead_test_iv, BLE_EAD_IV_SIZE);
+
+    memcpy(enc, nonce, BLE_EAD_RANDOMIZER_SIZE);
+    rc = ble_aes_ccm_ctx_encrypt(ctx, nonce, payload, payload_len, aad,
+                                 sizeof aad, enc + BLE_EAD_RANDOMIZER_SIZE,
+                                 BLE_EAD_MIC_SIZE);
+    TEST_ASSERT_FATAL(rc == 0);
+}
+
+TEST_CASE_SELF(ble_aes_ccm_test_kat)
+{
+    struct ble_aes_ccm_ctx ctx;
+    uint8_t nonce[13];
+    uint8_t msg[31];
+    uint8_t buf[31];
+    int rc;
+    int i;
+
+    /* 8 bytes of AAD followed by 23 bytes of message */
+    for (i = 0; i < 31; i++) {
+        msg[i] = i;
+    }
+    memcpy(nonce, ble_aes_ccm_test_nonce, sizeof nonce);
+
+    rc = ble_aes_ccm_encrypt(ble_aes_ccm_test_key, nonce, msg + 8, 23, msg, 8,
+                             buf, 8);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(memcmp(buf, ble_aes_ccm_test_enc, 31) == 0);
+
+    rc = ble_aes_ccm_decrypt(ble_aes_ccm_test_key, nonce, ble_aes_ccm_test_enc,
+                             23, msg, 8, buf, 8);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(memcmp(buf, msg + 8, 23) == 0);
+
+    /* Same with context, in place */
+    rc = ble_aes_ccm_ctx_init(&ctx, ble_aes_ccm_test_key);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    memcpy(buf, msg + 8, 23);
+    rc = ble_aes_ccm_ctx_encrypt(&ctx, nonce, buf, 23, msg, 8, buf, 8);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(memcmp(buf, ble_aes_ccm_test_enc, 31) == 0);
+
+    rc = ble_aes_ccm_ctx_decrypt(&ctx, nonce, buf, 23, msg, 8, buf, 8);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(memcmp(buf, msg + 8, 23) == 0);
+
+    /* Corrupted MIC and corrupted message are both rejected */
+    memcpy(buf, ble_aes_ccm_test_enc, sizeof buf);
+    buf[30] ^= 0x01;
+    rc = ble_aes_ccm_ctx_decrypt(&ctx, nonce, buf, 23, msg, 8, buf, 8);
+    TEST_ASSERT(rc == BLE_HS_EAUTHEN);
+
+    memcpy(buf, ble_aes_ccm_test_enc, sizeof buf);
+    buf[0] ^= 0x80;
+    rc = ble_aes_ccm_ctx_decrypt(&ctx, nonce, buf, 23, msg, 8, buf, 8);
+    TEST_ASSERT(rc == BLE_HS_EAUTHEN);
+
+    /* Invalid MIC size */
+    rc = ble_aes_ccm_ctx_encrypt(&ctx, nonce, msg, 8, NULL, 0, buf, 5);
+    TEST_ASSERT(rc == BLE_HS_EINVAL);
+
+    ble_aes_ccm_ctx_free(&ctx);
+}
+
+TEST_CASE_SELF(ble_ead_test_batch)
+{
+    struct ble_aes_ccm_ctx ctx;
+    struct ble_ead_report *report;
+    uint8_t payload[31];
+    uint8_t dec[31];
+    size_t len;
+    int rc;
+    int i;
+
+    rc = ble_aes_ccm_ctx_init(&ctx, ble_ead_test_key);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    for (i = 0; i < BLE_EAD_TEST_NUM_REPORTS; i++) {
+        len = i % 32;
+        ble_ead_test_build(&ctx, i, len, ble_ead_test_enc[i]);
+
+        report = &ble_ead_test_reports[i];
+        report->encrypted_payload = ble_ead_test_enc[i];
+        report->encrypted_payload_size = BLE_EAD_ENCRYPTED_PAYLOAD_SIZE(len);
+        report->payload = ble_ead_test_dec[i];
+        report->status = -1;
+    }
+
+    ble_aes_ccm_ctx_free(&ctx);
+
+    /* Corrupt a few reports */
+    ble_ead_test_enc[3][BLE_EAD_RANDOMIZER_SIZE] ^= 0x01;
+    ble_ead_test_enc[100][0] ^= 0x01;
+    ble_ead_test_reports[150].encrypted_payload_size = BLE_EAD_MIC_SIZE;
+
+    rc = ble_ead_decrypt_batch(ble_ead_test_key, ble_ead_test_iv,
+                               ble_ead_test_reports, BLE_EAD_TEST_NUM_REPORTS);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    for (i = 0; i < BLE_EAD_TEST_NUM_REPORTS; i++) {
+        report = &ble_ead_test_reports[i];
+        len = i % 32;
+
+        if (i == 3 || i == 100) {
+            TEST_ASSERT(report->status == BLE_HS_EAUTHEN);
+            continue;
+        }
+
+        if (i == 150) {
+            TEST_ASSERT(report->status == BLE_HS_EINVAL);
+            continue;
+        }
+
+        TEST_ASSERT(report->status == 0);
+        ble_ead_test_payload(i, payload, len);
+        TEST_ASSERT(memcmp(report->payload, payload, len) == 0);
+
+        /* Batched result must match single report decryption */
+        rc = ble_ead_decrypt(ble_ead_test_key, ble_ead_test_iv,
+                             report->encrypted_payload,
+                             report->encrypted_payload_size, dec);
+        TEST_ASSERT(rc == 0);
+        TEST_ASSERT(memcmp(dec, payload, len) == 0);
+    }
+
+    rc = ble_ead_decrypt_batch(NULL, ble_ead_test_iv, ble_ead_test_reports, 1);
+    TEST_ASSERT(rc == BLE_HS_EINVAL);
+}
+
+TEST_SUITE(ble_ead_test_suite)
+{
+    ble_aes_ccm_test_kat();
+    ble_ead_test_batch();
+}
@@ -707,6 +707,124 @@ TEST_CASE_SELF(ble_gatts_reg_test_dsc_cb)
     ble_hs_test_util_assert_mbufs_freed(NULL);
 }
 
+#define BLE_GATTS_REG_TEST_LARGE_NUM_SVCS   32
+#define BLE_GATTS_REG_TEST_LARGE_NUM_CHRS   8
+
+TEST_CASE_SELF(ble_gatts_reg_test_large_db)
+{
+    static ble_uuid128_t
+        svc_uuids[BLE_GATTS_REG_TEST_LARGE_NUM_SVCS];
+    static struct ble_gatt_dsc_def
+        dscs[BLE_GATTS_REG_TEST_LARGE_NUM_SVCS]
+            [BLE_GATTS_REG_TEST_LARGE_NUM_CHRS][2];
+    static struct ble_gatt_chr_def
+        chrs[BLE_GATTS_REG_TEST_LARGE_NUM_SVCS]
+            [BLE_GATTS_REG_TEST_LARGE_NUM_CHRS + 1];
+    static struct ble_gatt_svc_def
+        svcs[BLE_GATTS_REG_TEST_LARGE_NUM_SVCS + 1];
+    static uint16_t
+        val_handles[BLE_GATTS_REG_TEST_LARGE_NUM_SVCS]
+                   [BLE_GATTS_REG_TEST_LARGE_NUM_CHRS];
+    static ble_uuid128_t chr_uuids[BLE_GATTS_REG_TEST_LARGE_NUM_CHRS];
+    static const ble_uuid16_t dsc_uuid = BLE_UUID16_INIT(0x3000);
+    ble_uuid128_t wrong_uuid;
+    uint16_t chr_def_handle;
+    uint16_t chr_val_handle;
+    uint16_t svc_handle;
+    uint16_t dsc_handle;
+    int rc;
+    int s;
+    int c;
+
+    ble_gatts_reg_test_init();
+
+    /* Every service contains the same set of characteristic and descriptor
+     * UUIDs, so each lookup has to be resolved within the right service.
+     */
+    for (c = 0; c < BLE_GATTS_REG_TEST_LARGE_NUM_CHRS; c++) {
+        chr_uuids[c] = (ble_uuid128_t)BLE_UUID128_INIT(
+            c, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+            0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff);
+    }
+
+    memset(svcs, 0, sizeof svcs);
+    for (s = 0; s < BLE_GATTS_REG_TEST_LARGE_NUM_SVCS; s++) {
+        svc_uuids[s] = (ble_uuid128_t)BLE_UUID128_INIT(
+            s, 0xa5, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+            0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff);
+
+        memset(chrs[s], 0, sizeof chrs[s]);
+        for (c = 0; c < BLE_GATTS_REG_TEST_LARGE_NUM_CHRS; c++) {
+            memset(dscs[s][c], 0, sizeof dscs[s][c]);
+            dscs[s][c][0].uuid = &dsc_uuid.u;
+            dscs[s][c][0].att_flags = BLE_ATT_F_READ;
+            dscs[s][c][0].access_cb = ble_gatts_reg_test_misc_dummy_access;
+
+            chrs[s][c].uuid = &chr_uuids[c].u;
+            chrs[s][c].access_cb = ble_gatts_reg_test_misc_dummy_access;
+            chrs[s][c].flags = BLE_GATT_CHR_F_READ;
+            chrs[s][c].val_handle = &val_handles[s][c];
+            chrs[s][c].descriptors = dscs[s][c];
+        }
+
+        svcs[s].type = BLE_GATT_SVC_TYPE_PRIMARY;
+        svcs[s].uuid = &svc_uuids[s].u;
+        svcs[s].characteristics = chrs[s];
+    }
+
+    rc = ble_gatts_count_cfg(svcs);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    ble_hs_test_util_reg_svcs(svcs, NULL, NULL);
+
+    for (s = 0; s < BLE_GATTS_REG_TEST_LARGE_NUM_SVCS; s++) {
+        rc = ble_gatts_find_svc(&svc_uuids[s].u, &svc_handle);
+        TEST_ASSERT_FATAL(rc == 0);
+        TEST_ASSERT(svc_handle == val_handles[s][0] - 2);
+
+        for (c = 0; c < BLE_GATTS_REG_TEST_LARGE_NUM_CHRS; c++) {
+            rc = ble_gatts_find_chr(&svc_uuids[s].u, &chr_uuids[c].u,
+                                    &chr_def_handle, &chr_val_handle);
+            TEST_ASSERT_FATAL(rc == 0);
+            TEST_ASSERT(chr_def_handle == val_handles[s][c] - 1);
+            TEST_ASSERT(chr_val_handle == val_handles[s][c]);
+
+            rc = ble_gatts_find_dsc(&svc_uuids[s].u, &chr_uuids[c].u,
+                                    &dsc_uuid.u, &dsc_handle);
+            TEST_ASSERT_FATAL(rc == 0);
+            TEST_ASSERT(dsc_handle == val_handles[s][c] + 1);
+        }
+    }
+
+    /* Unknown characteristic. */
+    wrong_uuid = chr_uuids[0];
+    wrong_uuid.value[0] = BLE_GATTS_REG_TEST_LARGE_NUM_CHRS;
+    rc = ble_gatts_find_chr(&svc_uuids[0].u, &wrong_uuid.u, NULL, NULL);
+    TEST_ASSERT(rc == BLE_HS_ENOENT);
+
+    /* Hidden services must not be found through the rebuilt index. */
+    rc = ble_gatts_find_svc(&svc_uuids[5].u, &svc_handle);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = ble_gatts_svc_set_visibility(svc_handle, 0);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = ble_gatts_find_chr(&svc_uuids[5].u, &chr_uuids[3].u, NULL, NULL);
+    TEST_ASSERT(rc != 0);
+    rc = ble_gatts_find_chr(&svc_uuids[6].u, &chr_uuids[3].u, NULL,
+                            &chr_val_handle);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(chr_val_handle == val_handles[6][3]);
+
+    rc = ble_gatts_svc_set_visibility(svc_handle, 1);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = ble_gatts_find_chr(&svc_uuids[5].u, &chr_uuids[3].u, NULL,
+                            &chr_val_handle);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(chr_val_handle == val_handles[5][3]);
+
+    ble_hs_test_util_assert_mbufs_freed(NULL);
+}
+
 TEST_SUITE(ble_gatts_reg_suite)
 {
     ble_gatts_reg_test_svc_return();
@@ -716,4 +834,6 @@ TEST_SUITE(ble_gatts_reg_suite)
     ble_gatts_reg_test_svc_cb();
     ble_gatts_reg_test_chr_cb();
     ble_gatts_reg_test_dsc_cb();
+
+    ble_gatts_reg_test_large_db();
 }
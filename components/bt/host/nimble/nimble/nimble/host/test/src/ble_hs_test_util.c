@@ -1993,9 +1993,50 @@ ble_hs_test_util_reg_svcs(const struct ble_gatt_svc_def *svcs,
 }
 
 
+#if MYNEWT_VAL(BLE_SM_SC)
+static struct ble_npl_eventq ble_hs_test_util_sm_evq;
+static int ble_hs_test_util_sm_evq_initialized;
+#endif
+
+/**
+ * Runs SM crypto work (key pair generation and DHKey calculation) which is
+ * queued on the test SM crypto queue.
+ */
+void
+ble_hs_test_util_sm_crypto_run(void)
+{
+#if MYNEWT_VAL(BLE_SM_SC)
+    struct ble_npl_eventq *hs_evq;
+    struct ble_npl_event *ev;
+
+    /* DHKey results are delivered on the host queue.  Redirect them to the
+     * SM crypto queue for the duration of the run so that unrelated host
+     * events are not executed.
+     */
+    hs_evq = ble_hs_evq_get();
+    ble_hs_evq_set(&ble_hs_test_util_sm_evq);
+
+    while (!ble_npl_eventq_is_empty(&ble_hs_test_util_sm_evq)) {
+        ev = ble_npl_eventq_get(&ble_hs_test_util_sm_evq, 0);
+        ble_npl_event_run(ev);
+    }
+
+    ble_hs_evq_set(hs_evq);
+#endif
+}
+
 void
 ble_hs_test_util_init_no_sysinit_no_start(void)
 {
+#if MYNEWT_VAL(BLE_SM_SC)
+    /* The queue is never reinitialized since events may be queued on it. */
+    if (!ble_hs_test_util_sm_evq_initialized) {
+        ble_npl_eventq_init(&ble_hs_test_util_sm_evq);
+        ble_hs_test_util_sm_evq_initialized = 1;
+    }
+    ble_sm_sc_crypto_evq_set(&ble_hs_test_util_sm_evq);
+#endif
+
     STAILQ_INIT(&ble_hs_test_util_prev_tx_queue);
     ble_hs_test_util_prev_tx_cur = NULL;
 
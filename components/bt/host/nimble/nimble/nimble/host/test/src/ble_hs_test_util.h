@@ -299,6 +299,7 @@ void ble_hs_test_util_reg_svcs(const struct ble_gatt_svc_def *svcs,
 void ble_hs_test_util_init_no_start(void);
 void ble_hs_test_util_init_no_sysinit_no_start(void);
 void ble_hs_test_util_init(void);
+void ble_hs_test_util_sm_crypto_run(void);
 
 #ifdef __cplusplus
 }
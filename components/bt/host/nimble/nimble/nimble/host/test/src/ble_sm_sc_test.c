@@ -5510,6 +5510,52 @@ TEST_CASE_SELF(ble_sm_sc_us_pk_iio2_rio0_b1_iat2_rat2_ik7_rk3)
     ble_hs_test_util_assert_mbufs_freed(NULL);
 }
 
+#if MYNEWT_VAL(BLE_SM_SC_KEY_POOL_SIZE) > 0
+/**
+ * Local key pairs are taken from the pool, which is refilled from the SM
+ * crypto queue.
+ */
+TEST_CASE_SELF(ble_sm_sc_key_pool)
+{
+    struct ble_sm_sc_oob_data oob_data;
+    uint8_t rand[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    uint16_t opcode;
+    int rc;
+
+    ble_sm_test_util_init();
+
+    /* Pool was filled after sync. */
+    TEST_ASSERT(ble_sm_dbg_sc_key_pool_cnt() ==
+                MYNEWT_VAL(BLE_SM_SC_KEY_POOL_SIZE));
+
+    /* OOB data commits to a key pair taken from the pool. */
+    opcode = ble_hs_hci_util_opcode_join(BLE_HCI_OGF_LE, BLE_HCI_OCF_LE_RAND);
+    ble_hs_test_util_hci_ack_set_params(opcode, 0, rand, sizeof rand);
+    ble_hs_test_util_hci_ack_append_params(opcode, 0, rand, sizeof rand);
+
+    rc = ble_sm_sc_oob_generate_data(&oob_data);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(ble_sm_dbg_sc_key_pool_cnt() ==
+                MYNEWT_VAL(BLE_SM_SC_KEY_POOL_SIZE) - 1);
+
+    /* Key pair is reused; nothing else is taken from the pool. */
+    ble_hs_test_util_hci_ack_set_params(opcode, 0, rand, sizeof rand);
+    ble_hs_test_util_hci_ack_append_params(opcode, 0, rand, sizeof rand);
+
+    rc = ble_sm_sc_oob_generate_data(&oob_data);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(ble_sm_dbg_sc_key_pool_cnt() ==
+                MYNEWT_VAL(BLE_SM_SC_KEY_POOL_SIZE) - 1);
+
+    /* Refill was scheduled when the key pair was taken. */
+    ble_hs_test_util_sm_crypto_run();
+    TEST_ASSERT(ble_sm_dbg_sc_key_pool_cnt() ==
+                MYNEWT_VAL(BLE_SM_SC_KEY_POOL_SIZE));
+
+    ble_hs_test_util_assert_mbufs_freed(NULL);
+}
+#endif
+
 TEST_SUITE(ble_sm_sc_test_suite)
 {
     /*** No privacy. */
@@ -5526,6 +5572,10 @@ TEST_SUITE(ble_sm_sc_test_suite)
     ble_sm_sc_us_pk_iio0_rio4_b1_iat0_rat0_ik7_rk5();
     ble_sm_sc_us_nc_iio1_rio4_b1_iat0_rat0_ik7_rk5();
 
+#if MYNEWT_VAL(BLE_SM_SC_KEY_POOL_SIZE) > 0
+    ble_sm_sc_key_pool();
+#endif
+
     /*** Privacy (id = public). */
     // FIXME: needs to be fixed due to fix for address type used
 #if 0
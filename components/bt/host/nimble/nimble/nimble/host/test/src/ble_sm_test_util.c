@@ -41,6 +41,13 @@ int ble_sm_test_gap_status;
 struct ble_gap_sec_state ble_sm_test_sec_state;
 static struct ble_gap_passkey_params ble_sm_test_ioact;
 
+/** Whether DHKey calculation is left queued until peer's random is received. */
+static int ble_sm_test_util_dhkey_defer;
+/** Whether DHKey calculation is queued and not run yet. */
+static int ble_sm_test_util_dhkey_pending;
+/** Whether key pool is empty when we send our public key. */
+static int ble_sm_test_util_keygen_defer;
+
 static struct {
     /** Handle reported in previous repeat pairing event. */
     struct ble_gap_repeat_pairing rp;
@@ -405,6 +412,10 @@ ble_sm_test_util_init(void)
 {
     ble_hs_test_util_init();
 
+    /* Complete SM crypto work left over by previous tests. */
+    ble_hs_test_util_sm_crypto_run();
+    ble_sm_test_util_dhkey_pending = 0;
+
     ble_sm_test_gap_event_type = -1;
     ble_sm_test_gap_status = -1;
     memset(&ble_sm_test_repeat_pairing, 0, sizeof ble_sm_test_repeat_pairing);
@@ -784,6 +795,14 @@ ble_sm_test_util_rx_random(uint16_t conn_handle,
     rc = ble_hs_test_util_l2cap_rx_first_frag(conn_handle, BLE_L2CAP_CID_SM,
                                               &hci_hdr, om);
     TEST_ASSERT_FATAL(rc == exp_status);
+
+    if (exp_status == 0 && ble_sm_test_util_dhkey_pending) {
+        /* Pairing waits for DHKey; nothing is sent until it is calculated. */
+        TEST_ASSERT(ble_hs_test_util_prev_tx_dequeue() == NULL);
+
+        ble_sm_test_util_dhkey_pending = 0;
+        ble_hs_test_util_sm_crypto_run();
+    }
 }
 
 void
@@ -842,6 +861,12 @@ ble_sm_test_util_rx_public_key(uint16_t conn_handle,
     rc = ble_hs_test_util_l2cap_rx_first_frag(conn_handle, BLE_L2CAP_CID_SM,
                                               &hci_hdr, om);
     TEST_ASSERT_FATAL(rc == 0);
+
+    if (ble_sm_test_util_dhkey_defer) {
+        ble_sm_test_util_dhkey_pending = 1;
+    } else {
+        ble_hs_test_util_sm_crypto_run();
+    }
 }
 
 static void
@@ -2465,6 +2490,10 @@ ble_sm_test_util_us_sc_good_once_no_init(
         TEST_ASSERT_FATAL(rc == 0);
     }
 
+    if (ble_sm_test_util_keygen_defer) {
+        ble_sm_dbg_sc_key_pool_drain();
+    }
+
     /* Ensure we sent the expected pair request. */
     ble_sm_test_util_verify_tx_pair_req(our_entity->pair_cmd);
     TEST_ASSERT(!conn->bhc_sec_state.encrypted);
@@ -2477,6 +2506,14 @@ ble_sm_test_util_us_sc_good_once_no_init(
     TEST_ASSERT(ble_sm_num_procs() == 1);
     ble_sm_test_util_io_inject_bad(2, params->passkey_info.passkey.action);
 
+    if (ble_sm_test_util_keygen_defer) {
+        /* Key pair is generated on SM crypto queue; nothing is sent until
+         * it is ready.
+         */
+        TEST_ASSERT(ble_hs_test_util_prev_tx_dequeue() == NULL);
+        ble_hs_test_util_sm_crypto_run();
+    }
+
     /* Ensure we sent the expected public key. */
     ble_sm_test_util_verify_tx_public_key(our_entity->public_key);
     TEST_ASSERT(!conn->bhc_sec_state.encrypted);
@@ -2677,6 +2714,28 @@ ble_sm_test_util_us_sc_good(struct ble_sm_test_params *params)
     params->sec_req.authreq = params->pair_rsp.authreq;
     ble_sm_test_util_us_sc_good_once(params);
 
+#if MYNEWT_VAL(BLE_SM_SC_ASYNC_DHKEY)
+    /* We initiate pairing; DHKey is calculated after peer's random value is
+     * received.
+     */
+    params->passkey_info.io_before_rx = 0;
+    params->sec_req.authreq = 0;
+    ble_sm_test_util_dhkey_defer = 1;
+    ble_sm_test_util_us_sc_good_once(params);
+    ble_sm_test_util_dhkey_defer = 0;
+#endif
+
+#if MYNEWT_VAL(BLE_SM_SC_KEY_POOL_SIZE) > 0
+    /* We initiate pairing with key pool empty; our public key is sent once
+     * key pair is generated on SM crypto queue.
+     */
+    params->passkey_info.io_before_rx = 0;
+    params->sec_req.authreq = 0;
+    ble_sm_test_util_keygen_defer = 1;
+    ble_sm_test_util_us_sc_good_once(params);
+    ble_sm_test_util_keygen_defer = 0;
+#endif
+
     /* Verify link can be restored via the encryption procedure. */
     ble_sm_test_util_bonding_all(params, 1);
 
@@ -2903,6 +2962,17 @@ ble_sm_test_util_peer_sc_good(struct ble_sm_test_params *params)
     params->sec_req.authreq = params->pair_req.authreq;
     ble_sm_test_util_peer_sc_good_once(params);
 
+#if MYNEWT_VAL(BLE_SM_SC_ASYNC_DHKEY)
+    /* Peer initiates pairing; DHKey is calculated after peer's random value
+     * is received.
+     */
+    params->passkey_info.io_before_rx = 0;
+    params->sec_req.authreq = 0;
+    ble_sm_test_util_dhkey_defer = 1;
+    ble_sm_test_util_peer_sc_good_once(params);
+    ble_sm_test_util_dhkey_defer = 0;
+#endif
+
     /* Verify link can be restored via the encryption procedure. */
     ble_sm_test_util_bonding_all(params, 0);
 
@@ -120,6 +120,8 @@ struct ble_mbuf_hdr_txinfo
 
 struct ble_mbuf_hdr_txiso {
     uint16_t packet_seq_num;
+    /* SDU timestamp provided by host, 0 if not available */
+    uint32_t timestamp;
 };
 
 struct ble_mbuf_hdr
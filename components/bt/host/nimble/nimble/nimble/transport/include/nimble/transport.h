@@ -204,6 +204,10 @@ void ble_transport_free(void *buf);
 /* Register put callback on acl_from_ll mbufs (for ll-hs flow control) */
 int ble_transport_register_put_acl_from_ll_cb(os_mempool_put_fn *cb);
 
+/* Register callback invoked after an acl mbuf has been returned to the pool */
+typedef void ble_transport_acl_avail_fn(void);
+int ble_transport_register_acl_avail_cb(ble_transport_acl_avail_fn *cb);
+
 
 int ble_transport_to_ll_cmd(void *buf);
 int ble_transport_to_ll_acl(struct os_mbuf *om);
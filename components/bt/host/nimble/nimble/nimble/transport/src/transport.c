@@ -97,6 +97,7 @@ static struct os_mbuf_pool mpool_iso;
 #endif
 
 static os_mempool_put_fn *transport_put_acl_from_ll_cb;
+static ble_transport_acl_avail_fn *transport_acl_avail_cb;
 
 void *
 ble_transport_alloc_cmd(void)
@@ -308,6 +309,10 @@ ble_transport_acl_put(struct os_mempool_ext *mpe, void *data, void *arg)
     }
 #endif
 
+    if (!err && transport_acl_avail_cb) {
+        transport_acl_avail_cb();
+    }
+
     return err;
 }
 #endif
@@ -440,6 +445,14 @@ ble_transport_register_put_acl_from_ll_cb(os_mempool_put_fn (*cb))
     return 0;
 }
 
+int
+ble_transport_register_acl_avail_cb(ble_transport_acl_avail_fn *cb)
+{
+    transport_acl_avail_cb = cb;
+
+    return 0;
+}
+
 #if BLE_TRANSPORT_IPC
 uint8_t
 ble_transport_ipc_buf_evt_type_get(void *buf)
@@ -222,6 +222,11 @@
 #else
 #define MYNEWT_VAL_BLE_PERIODIC_ADV_ENH (CONFIG_BT_NIMBLE_PERIODIC_ADV_ENH)
 #endif
+#ifndef CONFIG_BT_NIMBLE_PERIODIC_ADV_REASSEMBLY
+#define MYNEWT_VAL_BLE_PERIODIC_ADV_REASSEMBLY (0)
+#else
+#define MYNEWT_VAL_BLE_PERIODIC_ADV_REASSEMBLY (CONFIG_BT_NIMBLE_PERIODIC_ADV_REASSEMBLY)
+#endif
 
 /*** @apache-mynewt-nimble/nimble/controller */
 /*** @apache-mynewt-nimble/nimble/controller */
@@ -551,6 +556,14 @@
 #define MYNEWT_VAL_BLE_ATT_SVR_QUEUED_WRITE_TMO (30000)
 #endif
 
+#ifndef MYNEWT_VAL_BLE_ATT_SVR_UUID_INDEX
+#ifdef CONFIG_BT_NIMBLE_ATT_SVR_UUID_INDEX
+#define MYNEWT_VAL_BLE_ATT_SVR_UUID_INDEX CONFIG_BT_NIMBLE_ATT_SVR_UUID_INDEX
+#else
+#define MYNEWT_VAL_BLE_ATT_SVR_UUID_INDEX (0)
+#endif
+#endif
+
 #ifndef MYNEWT_VAL_BLE_ATT_SVR_READ
 #define MYNEWT_VAL_BLE_ATT_SVR_READ (1)
 #endif
@@ -703,6 +716,30 @@
 #define MYNEWT_VAL_BLE_SM_SC_DEBUG_KEYS CONFIG_BT_NIMBLE_SM_SC_DEBUG_KEYS
 #endif
 
+#ifndef MYNEWT_VAL_BLE_SM_SC_KEY_POOL_SIZE
+#ifdef CONFIG_BT_NIMBLE_SM_SC_KEY_POOL_SIZE
+#define MYNEWT_VAL_BLE_SM_SC_KEY_POOL_SIZE CONFIG_BT_NIMBLE_SM_SC_KEY_POOL_SIZE
+#else
+#define MYNEWT_VAL_BLE_SM_SC_KEY_POOL_SIZE (0)
+#endif
+#endif
+
+#ifndef MYNEWT_VAL_BLE_SM_SC_KEY_MAX_REUSE
+#ifdef CONFIG_BT_NIMBLE_SM_SC_KEY_MAX_REUSE
+#define MYNEWT_VAL_BLE_SM_SC_KEY_MAX_REUSE CONFIG_BT_NIMBLE_SM_SC_KEY_MAX_REUSE
+#else
+#define MYNEWT_VAL_BLE_SM_SC_KEY_MAX_REUSE (0)
+#endif
+#endif
+
+#ifndef MYNEWT_VAL_BLE_SM_SC_ASYNC_DHKEY
+#ifdef CONFIG_BT_NIMBLE_SM_SC_ASYNC_DHKEY
+#define MYNEWT_VAL_BLE_SM_SC_ASYNC_DHKEY (1)
+#else
+#define MYNEWT_VAL_BLE_SM_SC_ASYNC_DHKEY (0)
+#endif
+#endif
+
 #ifndef MYNEWT_VAL_BLE_HS_AUTO_START
 #define MYNEWT_VAL_BLE_HS_AUTO_START (1)
 #endif
@@ -4,19 +4,45 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <string.h>
 #include "esp_attr.h"
 #include "esp_heap_caps.h"
 #include "sdkconfig.h"
+#include "osi/slab.h"
+
+#if CONFIG_BT_OSI_SLAB_ENABLED
+// The slab arena is internal, DMA capable RAM, so it can serve any request
+// which asks for internal memory
+#define BT_OSI_MEM_SLAB_MALLOC(size)                \
+    do {                                            \
+        void *p = osi_slab_alloc(size);             \
+        if (p) {                                    \
+            return p;                               \
+        }                                           \
+    } while (0)
+#define BT_OSI_MEM_SLAB_CALLOC(n, size)             \
+    do {                                            \
+        void *p = ((n) && (size) <= OSI_SLAB_MAX_SIZE / (n)) ? osi_slab_alloc((n) * (size)) : NULL; \
+        if (p) {                                    \
+            return memset(p, 0, (n) * (size));      \
+        }                                           \
+    } while (0)
+#else
+#define BT_OSI_MEM_SLAB_MALLOC(size)
+#define BT_OSI_MEM_SLAB_CALLOC(n, size)
+#endif
 
 IRAM_ATTR void *bt_osi_mem_malloc(size_t size)
 {
 #ifdef CONFIG_BT_NIMBLE_MEM_ALLOC_MODE_INTERNAL
+    BT_OSI_MEM_SLAB_MALLOC(size);
     return heap_caps_malloc(size, MALLOC_CAP_INTERNAL|MALLOC_CAP_8BIT);
 #elif CONFIG_BT_NIMBLE_MEM_ALLOC_MODE_EXTERNAL
     return heap_caps_malloc(size, MALLOC_CAP_SPIRAM|MALLOC_CAP_8BIT);
 #elif CONFIG_BT_NIMBLE_MEM_ALLOC_MODE_IRAM_8BIT
     return heap_caps_malloc_prefer(size, 2, MALLOC_CAP_INTERNAL|MALLOC_CAP_IRAM_8BIT, MALLOC_CAP_INTERNAL|MALLOC_CAP_8BIT);
 #else
+    BT_OSI_MEM_SLAB_MALLOC(size);
     return malloc(size);
 #endif
 }
@@ -24,27 +50,36 @@ IRAM_ATTR void *bt_osi_mem_malloc(size_t size)
 IRAM_ATTR void *bt_osi_mem_calloc(size_t n, size_t size)
 {
 #ifdef CONFIG_BT_NIMBLE_MEM_ALLOC_MODE_INTERNAL
+    BT_OSI_MEM_SLAB_CALLOC(n, size);
     return heap_caps_calloc(n, size, MALLOC_CAP_INTERNAL|MALLOC_CAP_8BIT);
 #elif CONFIG_BT_NIMBLE_MEM_ALLOC_MODE_EXTERNAL
     return heap_caps_calloc(n, size, MALLOC_CAP_SPIRAM|MALLOC_CAP_8BIT);
 #elif CONFIG_BT_NIMBLE_MEM_ALLOC_MODE_IRAM_8BIT
     return heap_caps_calloc_prefer(n, size, 2, MALLOC_CAP_INTERNAL|MALLOC_CAP_IRAM_8BIT, MALLOC_CAP_INTERNAL|MALLOC_CAP_8BIT);
 #else
+    BT_OSI_MEM_SLAB_CALLOC(n, size);
     return calloc(n, size);
 #endif
 }
 
 IRAM_ATTR void *bt_osi_mem_malloc_internal(size_t size)
 {
+    BT_OSI_MEM_SLAB_MALLOC(size);
     return heap_caps_malloc(size, MALLOC_CAP_INTERNAL|MALLOC_CAP_8BIT|MALLOC_CAP_DMA);
 }
 
 IRAM_ATTR void *bt_osi_mem_calloc_internal(size_t n, size_t size)
 {
+    BT_OSI_MEM_SLAB_CALLOC(n, size);
     return heap_caps_calloc(n, size, MALLOC_CAP_INTERNAL|MALLOC_CAP_8BIT|MALLOC_CAP_DMA);
 }
 
 IRAM_ATTR void bt_osi_mem_free(void *ptr)
 {
+#if CONFIG_BT_OSI_SLAB_ENABLED
+    if (osi_slab_free(ptr)) {
+        return;
+    }
+#endif
     heap_caps_free(ptr);
 }
@@ -27,6 +27,7 @@ typedef struct hci_driver_util_tx_entry {
     hci_driver_data_type_t data_type;   ///< Type of the HCI TX data.
     uint8_t *data;                         ///< Pointer to the TX data.
     uint32_t length;                    ///< Length of the TX data.
+    uint32_t segs;                      ///< Number of contiguous segments, including the type byte.
     STAILQ_ENTRY(hci_driver_util_tx_entry) next; ///< Next element in the linked list.
 } hci_driver_util_tx_entry_t;
 
@@ -35,6 +36,9 @@ STAILQ_HEAD(hci_driver_util_tx_list, hci_driver_util_tx_entry);
 
 typedef struct {
     struct hci_driver_util_tx_list tx_head;
+    struct hci_driver_util_tx_list tx_batch_head; /*!< Entries handed out by the last batch */
+    struct hci_driver_util_tx_entry *split_tx_entry; /*!< Entry too large for one batch */
+    uint32_t split_tx_seg;                           /*!< Segments of it already handed out */
     struct hci_driver_util_tx_entry *cur_tx_entry;
     uint32_t cur_tx_off;
     struct os_mempool *tx_entry_pool;
@@ -93,6 +97,7 @@ void
 hci_driver_util_tx_list_enqueue(hci_driver_data_type_t type, uint8_t *data, uint32_t len)
 {
     os_sr_t sr;
+    struct os_mbuf *om;
     hci_driver_util_tx_entry_t *tx_entry;
 
     tx_entry = os_memblock_get(s_hci_driver_util_env.tx_entry_pool);
@@ -100,6 +105,15 @@ hci_driver_util_tx_list_enqueue(hci_driver_data_type_t type, uint8_t *data, uint
     tx_entry->data_type = type;
     tx_entry->data = data;
     tx_entry->length = len;
+    tx_entry->segs = 2;
+    if (type == HCI_DRIVER_TYPE_ACL) {
+        tx_entry->segs = 1;
+        for (om = (struct os_mbuf *)data; om; om = SLIST_NEXT(om, om_next)) {
+            if (om->om_len) {
+                tx_entry->segs++;
+            }
+        }
+    }
     /* If the txbuf is command status event or command complete event, we should send firstly.
      * The tx list maybe used in the controller task and hci task. Therefore, enter critical area.
      */
@@ -185,6 +199,112 @@ hci_driver_util_tx_list_dequeue(uint32_t max_tx_len, void **tx_data, bool *last_
     return tx_len;
 }
 
+static void
+hci_driver_util_tx_entry_free(hci_driver_util_tx_entry_t *tx_entry)
+{
+    if (tx_entry->data_type == HCI_DRIVER_TYPE_ACL) {
+        os_mbuf_free_chain((struct os_mbuf *)tx_entry->data);
+    } else if (tx_entry->data_type == HCI_DRIVER_TYPE_EVT) {
+        r_ble_hci_trans_buf_free(tx_entry->data);
+    } else {
+        assert(0);
+    }
+}
+
+/* Hands out up to |count| segments of |tx_entry|, starting with segment |first|. Returns the
+ * number handed out.
+ */
+static uint32_t
+hci_driver_util_tx_entry_segs(hci_driver_util_tx_entry_t *tx_entry, uint32_t first, uint32_t count,
+                              hci_driver_util_tx_seg_fn *seg_cb, void *arg)
+{
+    struct os_mbuf *om;
+    uint32_t seg;
+    uint32_t done;
+
+    done = 0;
+    if (first == 0 && count > 0) {
+        seg_cb((uint8_t *)&tx_entry->data_type, 1, arg);
+        done++;
+    }
+    if (tx_entry->data_type == HCI_DRIVER_TYPE_ACL) {
+        seg = 1;
+        for (om = (struct os_mbuf *)tx_entry->data; om && done < count; om = SLIST_NEXT(om, om_next)) {
+            if (!om->om_len) {
+                continue;
+            }
+            if (seg >= first) {
+                seg_cb(om->om_data, om->om_len, arg);
+                done++;
+            }
+            seg++;
+        }
+    } else if (first <= 1 && done < count) {
+        seg_cb(tx_entry->data, tx_entry->length, arg);
+        done++;
+    }
+
+    return done;
+}
+
+uint32_t
+hci_driver_util_tx_list_batch(uint32_t max_segs, hci_driver_util_tx_seg_fn *seg_cb, void *arg)
+{
+    os_sr_t sr;
+    uint32_t pkts;
+    uint32_t segs;
+    hci_driver_util_tx_entry_t *tx_entry;
+
+    /* The previous batch has been sent completely, release its buffers. */
+    while ((tx_entry = STAILQ_FIRST(&s_hci_driver_util_env.tx_batch_head)) != NULL) {
+        STAILQ_REMOVE_HEAD(&s_hci_driver_util_env.tx_batch_head, next);
+        hci_driver_util_tx_entry_free(tx_entry);
+        os_memblock_put(s_hci_driver_util_env.tx_entry_pool, (void *)tx_entry);
+    }
+
+    pkts = 0;
+    tx_entry = s_hci_driver_util_env.split_tx_entry;
+    while (max_segs > 0) {
+        if (!tx_entry) {
+            /* Take whole packets from the head of the list while their segments fit. The head
+             * is re-read under the critical section since command complete/status events may
+             * be inserted in front at any time. A packet with more segments than an empty batch
+             * can hold is sent over several batches, which then carry no complete packet.
+             */
+            OS_ENTER_CRITICAL(sr);
+            tx_entry = STAILQ_FIRST(&s_hci_driver_util_env.tx_head);
+            if (tx_entry && (tx_entry->segs <= max_segs || pkts == 0)) {
+                STAILQ_REMOVE_HEAD(&s_hci_driver_util_env.tx_head, next);
+            } else {
+                tx_entry = NULL;
+            }
+            OS_EXIT_CRITICAL(sr);
+
+            if (!tx_entry) {
+                break;
+            }
+            s_hci_driver_util_env.split_tx_entry = tx_entry;
+            s_hci_driver_util_env.split_tx_seg = 0;
+        }
+
+        segs = hci_driver_util_tx_entry_segs(tx_entry, s_hci_driver_util_env.split_tx_seg, max_segs,
+                                             seg_cb, arg);
+        max_segs -= segs;
+        s_hci_driver_util_env.split_tx_seg += segs;
+        if (s_hci_driver_util_env.split_tx_seg < tx_entry->segs) {
+            break;
+        }
+
+        /* Released with the batch of the packet's last segment */
+        STAILQ_INSERT_TAIL(&s_hci_driver_util_env.tx_batch_head, tx_entry, next);
+        s_hci_driver_util_env.split_tx_entry = NULL;
+        tx_entry = NULL;
+        pkts++;
+    }
+
+    return pkts;
+}
+
 int
 hci_driver_util_init(void)
 {
@@ -195,6 +315,7 @@ hci_driver_util_init(void)
     }
 
     STAILQ_INIT(&s_hci_driver_util_env.tx_head);
+    STAILQ_INIT(&s_hci_driver_util_env.tx_batch_head);
 
     return 0;
 }
@@ -208,14 +329,14 @@ hci_driver_util_deinit(void)
     /* Free all of controller buffers which haven't been sent yet.  The whole mempool will be freed.
      * Therefore, it's unnecessary to put the tx_entry into mempool.
      */
-    tx_entry = STAILQ_FIRST(&s_hci_driver_util_env.tx_head);
+    if (s_hci_driver_util_env.split_tx_entry) {
+        hci_driver_util_tx_entry_free(s_hci_driver_util_env.split_tx_entry);
+    }
+    STAILQ_CONCAT(&s_hci_driver_util_env.tx_batch_head, &s_hci_driver_util_env.tx_head);
+    tx_entry = STAILQ_FIRST(&s_hci_driver_util_env.tx_batch_head);
     while (tx_entry) {
         next_entry = STAILQ_NEXT(tx_entry, next);
-        if (tx_entry->data_type == HCI_DRIVER_TYPE_ACL) {
-            os_mbuf_free_chain((struct os_mbuf *)tx_entry->data);
-        } else if (tx_entry->data_type == HCI_DRIVER_TYPE_EVT) {
-            r_ble_hci_trans_buf_free(tx_entry->data);
-        }
+        hci_driver_util_tx_entry_free(tx_entry);
         tx_entry = next_entry;
     }
 
@@ -101,6 +101,12 @@ struct uart_env_tag {
     struct uart_txrxchannel rx;
 };
 
+/* Descriptor chain being built for a TX batch */
+struct uart_tx_chain {
+    uhci_lldesc_t *head;
+    uhci_lldesc_t *tail;
+};
+
 typedef struct hci_message {
     void *ptr;                   ///< Pointer to the message data.
     uint32_t length;             ///< Length of the message data.
@@ -378,45 +384,44 @@ int IRAM_ATTR hci_driver_uart_dma_rx_start(uint8_t *rx_data, uint32_t length)
     return 0;
 }
 
-int hci_driver_uart_dma_tx_start(esp_bt_hci_tl_callback_t callback, void *arg)
+static void hci_driver_uart_dma_tx_seg(const uint8_t *data, uint32_t len, void *arg)
 {
-    void *data;
-    bool last_frame;
-    bool head_is_setted;
-    uint32_t tx_len;
+    struct uart_tx_chain *chain = arg;
     uhci_lldesc_t *lldesc_data;
-    uhci_lldesc_t *lldesc_head;
-    uhci_lldesc_t *lldesc_tail;
 
-    lldesc_head = NULL;
-    lldesc_tail = NULL;
-    head_is_setted = false;
-    last_frame = false;
-    while (true) {
-        tx_len = hci_driver_util_tx_list_dequeue(0xffffff, &data, &last_frame);
-        if (!tx_len) {
-            break;
-        }
+    lldesc_data = os_memblock_get(&s_hci_driver_uart_dma_env.lldesc_mem_pool);
+    /* The batch is limited to the free descriptors, It should not be empty */
+    assert(lldesc_data);
+    memset(lldesc_data, 0, sizeof(uhci_lldesc_t));
+    lldesc_data->length = len;
+    lldesc_data->buf = data;
+    lldesc_data->eof = 0;
+    if (!chain->head) {
+        chain->head = lldesc_data;
+    } else {
+        chain->tail->qe.stqe_next = lldesc_data;
+    }
 
-        lldesc_data = os_memblock_get(&s_hci_driver_uart_dma_env.lldesc_mem_pool);
-        /* According to the current processing logic， It should not be empty */
-        assert(lldesc_data);
-        memset(lldesc_data, 0, sizeof(uhci_lldesc_t));
-        lldesc_data->length = tx_len;
-        lldesc_data->buf = data;
-        lldesc_data->eof = 0;
-        if (!head_is_setted) {
-            lldesc_head = lldesc_data;
-            head_is_setted = true;
-        } else {
-            lldesc_tail->qe.stqe_next = lldesc_data;
-        }
+    chain->tail = lldesc_data;
+}
 
-        lldesc_tail = lldesc_data;
-        if (last_frame) {
-            break;
-        }
-    }
+int hci_driver_uart_dma_tx_start(esp_bt_hci_tl_callback_t callback, void *arg)
+{
+    struct uart_tx_chain chain;
+    uint16_t max_segs;
+    uhci_lldesc_t *lldesc_head;
+    uhci_lldesc_t *lldesc_tail;
+
+    /* Build one descriptor chain spanning as many queued packets as the free descriptors allow,
+     * keeping one back for restarting RX.
+     */
+    max_segs = s_hci_driver_uart_dma_env.lldesc_mem_pool.mp_num_free;
+    max_segs = max_segs > 1 ? max_segs - 1 : 0;
+    chain.head = NULL;
+    chain.tail = NULL;
+    hci_driver_util_tx_list_batch(max_segs, hci_driver_uart_dma_tx_seg, &chain);
+    lldesc_head = chain.head;
+    lldesc_tail = chain.tail;
 
     if (lldesc_head) {
         lldesc_tail->eof = 1;
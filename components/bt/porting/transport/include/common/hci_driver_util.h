@@ -15,4 +15,23 @@ void hci_driver_util_tx_list_enqueue(hci_driver_data_type_t type, uint8_t *data,
 
 uint32_t hci_driver_util_tx_list_dequeue(uint32_t max_tx_len, void **tx_data, bool *last_frame);
 
+/**
+ * @brief Called once for each contiguous segment of a TX batch, in transmission order.
+ */
+typedef void (hci_driver_util_tx_seg_fn)(const uint8_t *data, uint32_t len, void *arg);
+
+/**
+ * @brief Hand out as many whole queued packets as fit into max_segs segments.
+ *
+ * A packet with more than max_segs segments is handed out over several calls, so a batch may
+ * end in the middle of a packet or hold no complete packet at all.
+ *
+ * The buffers of the packets completed by the previous call are released first, so this must
+ * only be called once the previous batch has been transmitted completely. It must not be mixed
+ * with hci_driver_util_tx_list_dequeue().
+ *
+ * @return The number of packets whose last segment is in the batch.
+ */
+uint32_t hci_driver_util_tx_list_batch(uint32_t max_segs, hci_driver_util_tx_seg_fn *seg_cb, void *arg);
+
 #endif // _H_HCI_DRIVER_UTIL_
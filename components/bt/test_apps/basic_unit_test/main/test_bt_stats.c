@@ -0,0 +1,197 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+
+/*
+ Tests for the BT statistics registry
+*/
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "unity.h"
+#include "sdkconfig.h"
+#include "bt_stats/bt_stats.h"
+
+#if CONFIG_BT_STATS_EN
+
+#define TEST_STATS_UPDATES      100000
+#define TEST_STATS_TASKS        (portNUM_PROCESSORS + 1)
+#define TEST_STATS_PERF_UPDATES 1000000
+
+static BT_STATS_COUNTER_DEFINE(test_counter, "test.counter");
+static BT_STATS_GAUGE_DEFINE(test_gauge, "test.gauge");
+static BT_STATS_HIST_DEFINE(test_hist, "test.hist", 4);
+
+static bt_stats_hdr_t *const test_stats[] = {
+    &test_counter.hdr, &test_gauge.hdr, &test_hist.hdr,
+};
+
+static void test_stats_task(void *arg)
+{
+    SemaphoreHandle_t done = (SemaphoreHandle_t)arg;
+
+    for (int i = 0; i < TEST_STATS_UPDATES; i++) {
+        BT_STATS_INC(test_counter);
+        BT_STATS_GAUGE_ADD(test_gauge, (i & 1) ? -1 : 1);
+        BT_STATS_HIST_RECORD(test_hist, i & 63);
+    }
+
+    xSemaphoreGive(done);
+    vTaskDelete(NULL);
+}
+
+static uint64_t test_read_varint(const uint8_t *buf, size_t *pos)
+{
+    uint64_t value = 0;
+    int shift = 0;
+
+    while (buf[*pos] & 0x80) {
+        value |= (uint64_t)(buf[(*pos)++] & 0x7f) << shift;
+        shift += 7;
+    }
+    return value | ((uint64_t)buf[(*pos)++] << shift);
+}
+
+TEST_CASE("bt_stats_concurrent_updates", "[bt_common]")
+{
+    SemaphoreHandle_t done = xSemaphoreCreateCounting(TEST_STATS_TASKS, 0);
+    uint32_t buckets_before[BT_STATS_HIST_BUCKETS];
+    uint32_t buckets[BT_STATS_HIST_BUCKETS];
+    uint64_t count = bt_stats_counter_read(&test_counter);
+    int64_t level = bt_stats_gauge_read(&test_gauge);
+
+    TEST_ASSERT_NOT_NULL(done);
+    bt_stats_hist_read(&test_hist, buckets_before, NULL);
+
+    /* One task pinned to each core, and one more contending on the core it lands on */
+    for (int i = 0; i < TEST_STATS_TASKS; i++) {
+        TEST_ASSERT_EQUAL(pdPASS, xTaskCreatePinnedToCore(test_stats_task, "stats", 2048, done, 5, NULL,
+                                                          i < portNUM_PROCESSORS ? i : tskNO_AFFINITY));
+    }
+    for (int i = 0; i < TEST_STATS_TASKS; i++) {
+        TEST_ASSERT_EQUAL(pdTRUE, xSemaphoreTake(done, pdMS_TO_TICKS(10000)));
+    }
+    /* Let the idle tasks free the deleted tasks before the leak check */
+    vTaskDelay(pdMS_TO_TICKS(10));
+    vSemaphoreDelete(done);
+
+    TEST_ASSERT_EQUAL_UINT64(count + (uint64_t)TEST_STATS_TASKS * TEST_STATS_UPDATES,
+                             bt_stats_counter_read(&test_counter));
+    TEST_ASSERT_EQUAL_INT64(level, bt_stats_gauge_read(&test_gauge));
+
+    /* Values 0-15, 16-31 and 32-63 land in the first three buckets */
+    bt_stats_hist_read(&test_hist, buckets, NULL);
+    TEST_ASSERT_EQUAL_UINT32(TEST_STATS_TASKS * TEST_STATS_UPDATES / 4, buckets[0] - buckets_before[0]);
+    TEST_ASSERT_EQUAL_UINT32(TEST_STATS_TASKS * TEST_STATS_UPDATES / 4, buckets[1] - buckets_before[1]);
+    TEST_ASSERT_EQUAL_UINT32(TEST_STATS_TASKS * TEST_STATS_UPDATES / 2, buckets[2] - buckets_before[2]);
+}
+
+TEST_CASE("bt_stats_export", "[bt_common]")
+{
+    bool found = false;
+    size_t pos = 0;
+    size_t size;
+    size_t len;
+    uint8_t *buf;
+    uint64_t count;
+
+    bt_stats_register_group(test_stats, sizeof(test_stats) / sizeof(test_stats[0]));
+    /* Registering again has no effect */
+    bt_stats_register(&test_counter.hdr);
+    BT_STATS_ADD(test_counter, 3);
+
+    TEST_ASSERT_GREATER_THAN(4, bt_stats_export(NULL, 0, 0));
+
+    /* Leave room for the timestamp and values growing between the two calls */
+    size = bt_stats_export(NULL, 0, BT_STATS_EXPORT_NAMES) + 32;
+    buf = malloc(size);
+    TEST_ASSERT_NOT_NULL(buf);
+    len = bt_stats_export(buf, size, BT_STATS_EXPORT_NAMES);
+    TEST_ASSERT_LESS_OR_EQUAL(size, len);
+
+    TEST_ASSERT_EQUAL(BT_STATS_EXPORT_VERSION, buf[pos++]);
+    TEST_ASSERT_EQUAL(BT_STATS_EXPORT_NAMES, buf[pos++]);
+    test_read_varint(buf, &pos);
+    count = test_read_varint(buf, &pos);
+    TEST_ASSERT_GREATER_OR_EQUAL(3, count);
+
+    while (count--) {
+        uint16_t id = test_read_varint(buf, &pos);
+        uint8_t type = buf[pos++];
+        uint8_t name_len = buf[pos++];
+        const char *name = (const char *)&buf[pos];
+
+        pos += name_len;
+        if (type == BT_STATS_TYPE_COUNTER) {
+            uint64_t value = test_read_varint(buf, &pos);
+            if (name_len == strlen("test.counter") && !memcmp(name, "test.counter", name_len)) {
+                TEST_ASSERT_EQUAL(test_counter.hdr.id, id);
+                TEST_ASSERT_EQUAL_UINT64(bt_stats_counter_read(&test_counter), value);
+                found = true;
+            }
+        } else if (type == BT_STATS_TYPE_GAUGE) {
+            test_read_varint(buf, &pos);
+        } else {
+            TEST_ASSERT_EQUAL(BT_STATS_TYPE_HIST, type);
+            pos++;
+            for (int i = 0; i <= BT_STATS_HIST_BUCKETS; i++) {
+                test_read_varint(buf, &pos);
+            }
+        }
+    }
+    TEST_ASSERT_EQUAL(len, pos);
+    TEST_ASSERT_TRUE(found);
+
+    free(buf);
+}
+
+/*
+ * Times each kind of update from one task, with a shared atomic increment
+ * for comparison. Prints the time per update; the loop itself is counted.
+ */
+TEST_CASE("bt_stats_update_cost", "[bt_common][perf]")
+{
+    static atomic_uint shared;
+    int64_t elapsed[4];
+    int64_t start;
+
+    start = esp_timer_get_time();
+    for (int i = 0; i < TEST_STATS_PERF_UPDATES; i++) {
+        BT_STATS_INC(test_counter);
+    }
+    elapsed[0] = esp_timer_get_time() - start;
+
+    start = esp_timer_get_time();
+    for (int i = 0; i < TEST_STATS_PERF_UPDATES; i++) {
+        BT_STATS_GAUGE_ADD(test_gauge, (i & 1) ? -1 : 1);
+    }
+    elapsed[1] = esp_timer_get_time() - start;
+
+    start = esp_timer_get_time();
+    for (int i = 0; i < TEST_STATS_PERF_UPDATES; i++) {
+        BT_STATS_HIST_RECORD(test_hist, i & 0xfff);
+    }
+    elapsed[2] = esp_timer_get_time() - start;
+
+    start = esp_timer_get_time();
+    for (int i = 0; i < TEST_STATS_PERF_UPDATES; i++) {
+        atomic_fetch_add_explicit(&shared, 1, memory_order_relaxed);
+    }
+    elapsed[3] = esp_timer_get_time() - start;
+
+    TEST_ASSERT_EQUAL_UINT32(TEST_STATS_PERF_UPDATES, atomic_load(&shared));
+    printf("counter add: %lld ns, gauge add: %lld ns, histogram record: %lld ns, atomic add: %lld ns\n",
+           elapsed[0] * 1000 / TEST_STATS_PERF_UPDATES, elapsed[1] * 1000 / TEST_STATS_PERF_UPDATES,
+           elapsed[2] * 1000 / TEST_STATS_PERF_UPDATES, elapsed[3] * 1000 / TEST_STATS_PERF_UPDATES);
+}
+
+#endif /* CONFIG_BT_STATS_EN */
@@ -0,0 +1,229 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+
+/*
+ Tests for the OSI slab allocator
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "unity.h"
+#include "sdkconfig.h"
+#include "osi/slab.h"
+
+#if CONFIG_BT_OSI_SLAB_ENABLED
+
+#define TEST_SLAB_CAPS          (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)
+#define TEST_SLAB_SLOTS         8
+#define TEST_SLAB_SIZES         52
+#define TEST_SLAB_SIZE(i)       (1 + (i) * 5)
+#define TEST_SLAB_ROUNDS        2048
+#define TEST_SLAB_KEEP_EVERY    32
+#define TEST_SLAB_KEEP_NUM      (TEST_SLAB_ROUNDS / TEST_SLAB_KEEP_EVERY)
+
+typedef struct {
+    uint8_t slot;
+    uint16_t size;              /* 0 frees the slot */
+} test_slab_op_t;
+
+typedef struct {
+    const char *name;
+    void *(*malloc)(size_t size);
+    void (*free)(void *ptr);
+} test_slab_allocator_t;
+
+/*
+ * Allocations made for one received notification: the HCI ACL buffer and its
+ * queue node, the BTC message with its argument, the callback list node, the
+ * alarm and the response. Traces recorded with HEAP_MEMORY_DEBUG can be
+ * replayed in the same format to profile other workloads.
+ */
+static const test_slab_op_t test_slab_trace[] = {
+    { 0, 72 }, { 1, 16 }, { 2, 40 }, { 3, 60 }, { 1, 0 }, { 4, 16 }, { 0, 0 },
+    { 5, 24 }, { 2, 0 }, { 3, 0 }, { 4, 0 }, { 6, 140 }, { 5, 0 }, { 6, 0 },
+};
+
+static void *test_slab_malloc(size_t size)
+{
+    void *p = osi_slab_alloc(size);
+    return p ? p : heap_caps_malloc(size, TEST_SLAB_CAPS);
+}
+
+static void test_slab_free(void *ptr)
+{
+    if (!osi_slab_free(ptr)) {
+        heap_caps_free(ptr);
+    }
+}
+
+static void *test_heap_malloc(size_t size)
+{
+    return heap_caps_malloc(size, TEST_SLAB_CAPS);
+}
+
+static const test_slab_allocator_t test_slab_allocators[] = {
+    { "heap", test_heap_malloc, heap_caps_free },
+    { "slab", test_slab_malloc, test_slab_free },
+};
+
+TEST_CASE("osi_slab_alloc_free", "[bt_common]")
+{
+    osi_slab_stats_t stats;
+    void *ptr[TEST_SLAB_SIZES];
+    uint32_t allocs = 0;
+    void *heap_ptr;
+
+    osi_slab_get_stats(&stats);
+    for (int c = 0; c < OSI_SLAB_CLASS_NUM; c++) {
+        allocs -= stats.classes[c].allocs;
+    }
+
+    TEST_ASSERT_NULL(osi_slab_alloc(0));
+    TEST_ASSERT_NULL(osi_slab_alloc(OSI_SLAB_MAX_SIZE + 1));
+
+    /* Sizes 1, 6, ... 256, held together so that overlapping objects show up */
+    for (int i = 0; i < TEST_SLAB_SIZES; i++) {
+        ptr[i] = osi_slab_alloc(TEST_SLAB_SIZE(i));
+        TEST_ASSERT_NOT_NULL(ptr[i]);
+        TEST_ASSERT_EQUAL(0, (uintptr_t)ptr[i] % 16);
+        memset(ptr[i], i, TEST_SLAB_SIZE(i));
+    }
+    for (int i = 0; i < TEST_SLAB_SIZES; i++) {
+        for (int j = 0; j < TEST_SLAB_SIZE(i); j++) {
+            TEST_ASSERT_EQUAL_UINT8(i, ((uint8_t *)ptr[i])[j]);
+        }
+    }
+
+    osi_slab_get_stats(&stats);
+    for (int c = 0; c < OSI_SLAB_CLASS_NUM; c++) {
+        allocs += stats.classes[c].allocs;
+    }
+    TEST_ASSERT_EQUAL(TEST_SLAB_SIZES, allocs);
+    for (int i = 0; i < TEST_SLAB_SIZES; i++) {
+        TEST_ASSERT_TRUE(osi_slab_free(ptr[i]));
+    }
+
+    heap_ptr = heap_caps_malloc(16, TEST_SLAB_CAPS);
+    TEST_ASSERT_NOT_NULL(heap_ptr);
+    TEST_ASSERT_FALSE(osi_slab_free(heap_ptr));
+    heap_caps_free(heap_ptr);
+
+    osi_slab_get_stats(&stats);
+    for (int c = 0; c < OSI_SLAB_CLASS_NUM; c++) {
+        TEST_ASSERT_EQUAL(0, stats.classes[c].in_use);
+    }
+    osi_slab_show();
+    osi_slab_deinit();
+}
+
+TEST_CASE("osi_slab_exhausted", "[bt_common]")
+{
+    const int max = CONFIG_BT_OSI_SLAB_ARENA_SIZE * 1024 / OSI_SLAB_MAX_SIZE;
+    static void *ptr[CONFIG_BT_OSI_SLAB_ARENA_SIZE * 1024 / OSI_SLAB_MAX_SIZE + 1];
+    osi_slab_stats_t stats;
+    int count = 0;
+
+    /* Start from an empty arena */
+    osi_slab_deinit();
+    while (count <= max && (ptr[count] = osi_slab_alloc(OSI_SLAB_MAX_SIZE)) != NULL) {
+        count++;
+    }
+    TEST_ASSERT_EQUAL(max, count);
+
+    osi_slab_get_stats(&stats);
+    TEST_ASSERT_EQUAL(0, stats.free_pages);
+    TEST_ASSERT_EQUAL(stats.arena_pages, stats.peak_pages);
+    TEST_ASSERT_GREATER_OR_EQUAL(1, stats.classes[OSI_SLAB_CLASS_NUM - 1].fallbacks);
+
+    /* Other classes still fall back once the arena is full */
+    TEST_ASSERT_NULL(osi_slab_alloc(16));
+
+    while (count--) {
+        TEST_ASSERT_TRUE(osi_slab_free(ptr[count]));
+    }
+    osi_slab_deinit();
+
+    osi_slab_get_stats(&stats);
+    TEST_ASSERT_EQUAL(0, stats.arena_pages);
+}
+
+TEST_CASE("osi_slab_free_unused_page", "[bt_common]")
+{
+    osi_slab_stats_t stats;
+    uint8_t *ptr;
+
+    /* The first object of a new arena is carved from the first page, the
+     * next page is still free */
+    osi_slab_deinit();
+    ptr = osi_slab_alloc(16);
+    TEST_ASSERT_NOT_NULL(ptr);
+    osi_slab_get_stats(&stats);
+    TEST_ASSERT_GREATER_THAN(1, stats.arena_pages);
+
+    /* Taken by the slab so that it never reaches the heap, and dropped */
+    TEST_ASSERT_TRUE(osi_slab_free(ptr + OSI_SLAB_PAGE_SIZE));
+    osi_slab_get_stats(&stats);
+    TEST_ASSERT_EQUAL(1, stats.classes[0].in_use);
+
+    TEST_ASSERT_TRUE(osi_slab_free(ptr));
+    osi_slab_deinit();
+}
+
+/*
+ * Replays the trace with the heap alone and with the slab in front of it,
+ * keeping one long lived object every few rounds as connections and
+ * services do. Prints the time per operation and the largest free block
+ * of the internal heap while the long lived objects are still held.
+ */
+TEST_CASE("osi_slab_trace_replay", "[bt_common]")
+{
+    static void *keep[TEST_SLAB_KEEP_NUM];
+
+    for (size_t a = 0; a < sizeof(test_slab_allocators) / sizeof(test_slab_allocators[0]); a++) {
+        const test_slab_allocator_t *alloc = &test_slab_allocators[a];
+        void *slot[TEST_SLAB_SLOTS] = { NULL };
+        int64_t start = esp_timer_get_time();
+        int64_t elapsed;
+        int ops = 0;
+
+        for (int r = 0; r < TEST_SLAB_ROUNDS; r++) {
+            for (size_t i = 0; i < sizeof(test_slab_trace) / sizeof(test_slab_trace[0]); i++) {
+                const test_slab_op_t *op = &test_slab_trace[i];
+                if (op->size) {
+                    slot[op->slot] = alloc->malloc(op->size);
+                    TEST_ASSERT_NOT_NULL(slot[op->slot]);
+                } else {
+                    alloc->free(slot[op->slot]);
+                    slot[op->slot] = NULL;
+                }
+            }
+            ops += sizeof(test_slab_trace) / sizeof(test_slab_trace[0]);
+
+            if (r % TEST_SLAB_KEEP_EVERY == 0) {
+                keep[r / TEST_SLAB_KEEP_EVERY] = alloc->malloc(32 + (r % 3) * 48);
+                TEST_ASSERT_NOT_NULL(keep[r / TEST_SLAB_KEEP_EVERY]);
+                ops++;
+            }
+        }
+        elapsed = esp_timer_get_time() - start;
+
+        printf("%s: %d ops, %lld ns/op, largest free block %u\n", alloc->name, ops, elapsed * 1000 / ops,
+               (unsigned)heap_caps_get_largest_free_block(TEST_SLAB_CAPS));
+
+        for (int i = 0; i < TEST_SLAB_KEEP_NUM; i++) {
+            alloc->free(keep[i]);
+        }
+    }
+
+    osi_slab_show();
+    osi_slab_deinit();
+}
+
+#endif /* CONFIG_BT_OSI_SLAB_ENABLED */
@@ -0,0 +1,402 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+
+/*
+ * Host loopback harness for the bleuart service.
+ *
+ * The service is built together with a simulated peer that echoes every
+ * notification back as a write and exchanges credits with the service.  The
+ * application side keeps the TX ring full and checks that the echoed stream
+ * comes back intact.  Host calls are replaced by stubs; notifications are
+ * delivered synchronously, as ble_gatts_notify_custom() does.  The run fails
+ * if data is corrupted, a notification exceeds the MTU, the peer would have
+ * to buffer more than it granted, or mbufs leak.
+ *
+ * After the run the connection is dropped, and bleuart_read() and
+ * bleuart_write() must then return a negative error.
+ *
+ * This measures the CPU cost of the service on the build host, not air
+ * throughput.  bleuart.c is included directly.  glibc's sys/queue.h lacks
+ * STAILQ_LAST, which only the unused msys code needs.  Build from
+ * components/bt/host/nimble/nimble:
+ *
+ *   H=../../../test_apps/host
+ *   U=nimble/host/services/bleuart
+ *   gcc -O2 -w -I$H/mesh_cdb/stub -include esp_err.h \
+ *       -D'STAILQ_LAST(h, t, f)=NULL' \
+ *       -Inimble/include -Inimble/host/include -I$U/include -I$U/src \
+ *       -Inimble/transport/include -Iporting/npl/linux/include \
+ *       -Iporting/nimble/include -Iporting/examples/linux/include \
+ *       $H/bleuart/bleuart_loopback.c porting/nimble/src/os_mbuf.c \
+ *       porting/nimble/src/os_mempool.c porting/nimble/src/endian.c \
+ *       -o bleuart_loopback
+ *   ./bleuart_loopback 16
+ *
+ * The argument is the number of MiB to echo.  The esp_err.h and
+ * esp_nimble_mem.h stand-ins are shared with mesh_cdb.
+ */
+
+#include <stdio.h>
+#include <time.h>
+
+#ifndef MYNEWT_VAL_BLEUART_MAX_INPUT
+#define MYNEWT_VAL_BLEUART_MAX_INPUT        (120)
+#endif
+#ifndef MYNEWT_VAL_BLEUART_MAX_CONNS
+#define MYNEWT_VAL_BLEUART_MAX_CONNS        (1)
+#endif
+#ifndef MYNEWT_VAL_BLEUART_TX_BUF_SIZE
+#define MYNEWT_VAL_BLEUART_TX_BUF_SIZE      (1024)
+#endif
+#ifndef MYNEWT_VAL_BLEUART_RX_BUF_SIZE
+#define MYNEWT_VAL_BLEUART_RX_BUF_SIZE      (512)
+#endif
+#ifndef MYNEWT_VAL_BLEUART_TX_WINDOW
+#define MYNEWT_VAL_BLEUART_TX_WINDOW        (4)
+#endif
+
+void console_write(const char *str, int cnt) {}
+int console_read(char *str, int cnt, int *newline) { return 0; }
+int console_init(void *rx_cb) { return 0; }
+
+#include "bleuart.c"
+
+#define LOOPBACK_CONN_HANDLE    1
+#define LOOPBACK_MTU            247
+#define LOOPBACK_PEER_BUF_SIZE  3000
+#define LOOPBACK_PEER_GRANT     1024
+#define LOOPBACK_MBUF_CNT       16
+#define LOOPBACK_MBUF_BLK_SIZE  \
+    (LOOPBACK_MTU + sizeof(struct os_mbuf) + sizeof(struct os_mbuf_pkthdr))
+
+static struct os_mbuf_pool loopback_mbuf_pool;
+static struct os_mempool loopback_mempool;
+static os_membuf_t loopback_mem[
+    OS_MEMPOOL_SIZE(LOOPBACK_MBUF_CNT, LOOPBACK_MBUF_BLK_SIZE)];
+
+/* Single threaded event loop standing in for the default event queue. */
+static struct ble_npl_event *loopback_evq[8];
+static int loopback_evq_len;
+static int loopback_timer_active;
+static ble_npl_event_fn *loopback_timer_fn;
+
+/* Peer state. */
+static uint8_t loopback_peer_buf[LOOPBACK_PEER_BUF_SIZE];
+static int loopback_peer_len;
+static uint32_t loopback_peer_credits;
+
+static uint64_t loopback_tx_seq;
+static uint64_t loopback_rx_seq;
+static uint64_t loopback_notifs;
+static int loopback_errs;
+
+void
+ble_npl_eventq_put(struct ble_npl_eventq *evq, struct ble_npl_event *ev)
+{
+    int i;
+
+    for (i = 0; i < loopback_evq_len; i++) {
+        if (loopback_evq[i] == ev) {
+            return;
+        }
+    }
+    assert(loopback_evq_len < sizeof loopback_evq / sizeof loopback_evq[0]);
+    loopback_evq[loopback_evq_len++] = ev;
+}
+
+struct ble_npl_eventq *
+nimble_port_get_dflt_eventq(void)
+{
+    return NULL;
+}
+
+void
+ble_npl_event_init(struct ble_npl_event *ev, ble_npl_event_fn *fn, void *arg)
+{
+    ev->ev_cb = fn;
+}
+
+int
+ble_npl_callout_init(struct ble_npl_callout *co, struct ble_npl_eventq *evq,
+                     ble_npl_event_fn *fn, void *arg)
+{
+    loopback_timer_fn = fn;
+    return 0;
+}
+
+bool
+ble_npl_callout_is_active(struct ble_npl_callout *co)
+{
+    return loopback_timer_active;
+}
+
+ble_npl_error_t
+ble_npl_callout_reset(struct ble_npl_callout *co, ble_npl_time_t ticks)
+{
+    loopback_timer_active = 1;
+    return BLE_NPL_OK;
+}
+
+uint32_t
+ble_npl_time_ms_to_ticks32(uint32_t ms)
+{
+    return ms;
+}
+
+ble_npl_error_t
+ble_npl_mutex_init(struct ble_npl_mutex *mu)
+{
+    return BLE_NPL_OK;
+}
+
+ble_npl_error_t
+ble_npl_mutex_pend(struct ble_npl_mutex *mu, ble_npl_time_t timeout)
+{
+    return BLE_NPL_OK;
+}
+
+ble_npl_error_t
+ble_npl_mutex_release(struct ble_npl_mutex *mu)
+{
+    return BLE_NPL_OK;
+}
+
+uint32_t
+ble_npl_hw_enter_critical(void)
+{
+    return 0;
+}
+
+void
+ble_npl_hw_exit_critical(uint32_t ctx)
+{
+}
+
+uint16_t
+ble_att_mtu(uint16_t conn_handle)
+{
+    return LOOPBACK_MTU;
+}
+
+struct os_mbuf *
+ble_hs_mbuf_att_pkt(void)
+{
+    return os_mbuf_get_pkthdr(&loopback_mbuf_pool, 0);
+}
+
+struct os_mbuf *
+ble_hs_mbuf_from_flat(const void *buf, uint16_t len)
+{
+    struct os_mbuf *om;
+
+    om = ble_hs_mbuf_att_pkt();
+    if (om != NULL && os_mbuf_append(om, buf, len) != 0) {
+        os_mbuf_free_chain(om);
+        om = NULL;
+    }
+
+    return om;
+}
+
+int
+ble_gatts_count_cfg(const struct ble_gatt_svc_def *defs)
+{
+    return 0;
+}
+
+int
+ble_gatts_add_svcs(const struct ble_gatt_svc_def *svcs)
+{
+    return 0;
+}
+
+int
+ble_gatts_notify_custom(uint16_t conn_handle, uint16_t attr_handle,
+                        struct os_mbuf *om)
+{
+    uint16_t len;
+    uint8_t buf[2];
+
+    len = OS_MBUF_PKTLEN(om);
+    if (attr_handle == g_bleuart_attr_credit_handle) {
+        os_mbuf_copydata(om, 0, sizeof buf, buf);
+        loopback_peer_credits += get_le16(buf);
+    } else {
+        if (len > LOOPBACK_MTU - 3 ||
+            loopback_peer_len + len > LOOPBACK_PEER_BUF_SIZE) {
+            loopback_errs++;
+        } else {
+            os_mbuf_copydata(om, 0, len,
+                             loopback_peer_buf + loopback_peer_len);
+            loopback_peer_len += len;
+        }
+        loopback_notifs++;
+    }
+    os_mbuf_free_chain(om);
+
+    return 0;
+}
+
+static void
+loopback_peer_write(uint16_t attr_handle, const void *data, int len)
+{
+    struct ble_gatt_access_ctxt ctxt = {
+        .op = BLE_GATT_ACCESS_OP_WRITE_CHR,
+    };
+
+    ctxt.om = ble_hs_mbuf_from_flat(data, len);
+    assert(ctxt.om != NULL);
+    if (gatt_svr_chr_access_uart_write(LOOPBACK_CONN_HANDLE, attr_handle,
+                                       &ctxt, NULL) != 0) {
+        loopback_errs++;
+    }
+    os_mbuf_free_chain(ctxt.om);
+}
+
+static void
+loopback_app_rx(uint16_t conn_handle, void *arg)
+{
+    uint8_t buf[300];
+    int len;
+    int i;
+
+    while ((len = bleuart_read(conn_handle, buf, sizeof buf)) > 0) {
+        for (i = 0; i < len; i++) {
+            if (buf[i] != (uint8_t)(loopback_rx_seq++ * 7)) {
+                loopback_errs++;
+            }
+        }
+    }
+}
+
+static void
+loopback_gap_event(uint8_t type, uint16_t attr_handle)
+{
+    struct ble_gap_event event;
+
+    memset(&event, 0, sizeof event);
+    event.type = type;
+    if (type == BLE_GAP_EVENT_CONNECT) {
+        event.connect.conn_handle = LOOPBACK_CONN_HANDLE;
+    } else if (type == BLE_GAP_EVENT_DISCONNECT) {
+        event.disconnect.conn.conn_handle = LOOPBACK_CONN_HANDLE;
+    } else {
+        event.subscribe.conn_handle = LOOPBACK_CONN_HANDLE;
+        event.subscribe.attr_handle = attr_handle;
+        event.subscribe.cur_notify = 1;
+    }
+    bleuart_gap_event(&event, NULL);
+}
+
+static void
+loopback_run_event(void)
+{
+    struct ble_npl_event *ev;
+
+    if (loopback_evq_len > 0) {
+        ev = loopback_evq[0];
+        memmove(loopback_evq, loopback_evq + 1,
+                --loopback_evq_len * sizeof loopback_evq[0]);
+        ev->ev_cb(ev);
+    } else if (loopback_timer_active) {
+        loopback_timer_active = 0;
+        loopback_timer_fn(NULL);
+    }
+}
+
+int
+main(int argc, char **argv)
+{
+    struct timespec start;
+    struct timespec end;
+    uint64_t total;
+    uint8_t chunk[100];
+    uint8_t grant[2];
+    double ms;
+    int len;
+    int i;
+
+    total = (uint64_t)(argc > 1 ? atoi(argv[1]) : 16) << 20;
+
+    os_mempool_init(&loopback_mempool, LOOPBACK_MBUF_CNT,
+                    LOOPBACK_MBUF_BLK_SIZE, loopback_mem, "loopback");
+    os_mbuf_pool_init(&loopback_mbuf_pool, &loopback_mempool,
+                      LOOPBACK_MBUF_BLK_SIZE, LOOPBACK_MBUF_CNT);
+
+    for (i = 0; i < MYNEWT_VAL(BLEUART_MAX_CONNS); i++) {
+        bleuart_conns[i].conn_handle = BLE_HS_CONN_HANDLE_NONE;
+    }
+    ble_npl_mutex_init(&bleuart_mutex);
+    ble_npl_event_init(&bleuart_tx_ev, bleuart_tx_ev_fn, NULL);
+    ble_npl_callout_init(&bleuart_tx_timer, NULL, bleuart_tx_ev_fn, NULL);
+
+    g_bleuart_attr_read_handle = 3;
+    g_bleuart_attr_write_handle = 5;
+    g_bleuart_attr_credit_handle = 7;
+    bleuart_set_rx_cb(loopback_app_rx, NULL);
+
+    loopback_gap_event(BLE_GAP_EVENT_CONNECT, 0);
+    loopback_gap_event(BLE_GAP_EVENT_SUBSCRIBE, g_bleuart_attr_credit_handle);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    while (loopback_rx_seq < total && loopback_errs == 0) {
+        /* The application keeps the TX ring full. */
+        while (loopback_tx_seq < total &&
+               bleuart_tx_space(LOOPBACK_CONN_HANDLE) > 0) {
+            for (i = 0; i < sizeof chunk; i++) {
+                chunk[i] = (uint8_t)((loopback_tx_seq + i) * 7);
+            }
+            len = bleuart_write(LOOPBACK_CONN_HANDLE, chunk, sizeof chunk);
+            loopback_tx_seq += len;
+        }
+
+        /* The peer grants credits while it has room to buffer the data. */
+        if (LOOPBACK_PEER_BUF_SIZE - loopback_peer_len -
+            (int)bleuart_conns[0].tx_credits >= LOOPBACK_PEER_GRANT) {
+            put_le16(grant, LOOPBACK_PEER_GRANT);
+            loopback_peer_write(g_bleuart_attr_credit_handle, grant,
+                                sizeof grant);
+        }
+
+        /* The peer echoes as much as the service granted. */
+        if (loopback_peer_len > 0 && loopback_peer_credits > 0) {
+            len = min(loopback_peer_len, LOOPBACK_MTU - 3);
+            len = min(len, loopback_peer_credits);
+            loopback_peer_write(g_bleuart_attr_write_handle,
+                                loopback_peer_buf, len);
+            loopback_peer_credits -= len;
+            memmove(loopback_peer_buf, loopback_peer_buf + len,
+                    loopback_peer_len - len);
+            loopback_peer_len -= len;
+        }
+
+        loopback_run_event();
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    if (loopback_mempool.mp_num_free != LOOPBACK_MBUF_CNT) {
+        loopback_errs++;
+    }
+
+    loopback_gap_event(BLE_GAP_EVENT_DISCONNECT, 0);
+    if (bleuart_read(LOOPBACK_CONN_HANDLE, chunk, sizeof chunk) >= 0 ||
+        bleuart_write(LOOPBACK_CONN_HANDLE, chunk, sizeof chunk) >= 0) {
+        loopback_errs++;
+    }
+
+    ms = (end.tv_sec - start.tv_sec) * 1e3 +
+         (end.tv_nsec - start.tv_nsec) / 1e6;
+    printf("bytes=%llu notifications=%llu (avg %.1f bytes) "
+           "time=%.1f ms (%.1f MB/s) errors=%d\n",
+           (unsigned long long)loopback_rx_seq,
+           (unsigned long long)loopback_notifs,
+           loopback_notifs ? (double)loopback_rx_seq / loopback_notifs : 0.0,
+           ms, ms > 0 ? loopback_rx_seq / ms / 1e3 : 0.0, loopback_errs);
+
+    return loopback_errs != 0;
+}
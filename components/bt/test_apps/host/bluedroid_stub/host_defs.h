@@ -0,0 +1,65 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+
+/*
+ * Force-included (-include host_defs.h) before every Bluedroid source built
+ * on the host: the ESP-IDF, log and FreeRTOS definitions Bluedroid headers
+ * use without including them.
+ */
+#pragma once
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/* esp_err.h, esp_log.h */
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_INVALID_ARG 0x102
+#define ESP_ERR_INVALID_STATE 0x103
+#define ESP_LOGE(...)
+#define ESP_LOGW(...)
+#define ESP_LOGI(...)
+#define ESP_LOGD(...)
+#define ESP_LOGV(...)
+#define ESP_EARLY_LOGE(...)
+#define ESP_EARLY_LOGW(...)
+#define ESP_EARLY_LOGI(...)
+#define ESP_EARLY_LOGD(...)
+#define ESP_EARLY_LOGV(...)
+#define esp_log_write(...)
+typedef enum {
+    ESP_LOG_NONE, ESP_LOG_ERROR, ESP_LOG_WARN, ESP_LOG_INFO, ESP_LOG_DEBUG, ESP_LOG_VERBOSE,
+} esp_log_level_t;
+#define LOG_LOCAL_LEVEL ESP_LOG_NONE
+
+/* FreeRTOS */
+#define portNUM_PROCESSORS 2
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+typedef void *TaskHandle_t;
+typedef void *QueueHandle_t;
+typedef void *SemaphoreHandle_t;
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+typedef void *TimerHandle_t;
+#define IRAM_ATTR
+#define portMAX_DELAY 0xffffffff
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define pdMS_TO_TICKS(x) (x)
+#define portTICK_PERIOD_MS 1
+
+/* esp_heap_caps.h */
+#define MALLOC_CAP_DEFAULT 0
+#define MALLOC_CAP_INTERNAL 0
+#define MALLOC_CAP_8BIT 0
+#define MALLOC_CAP_SPIRAM 0
@@ -0,0 +1,27 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+
+#pragma once
+
+#define CONFIG_BT_ENABLED 1
+#define CONFIG_BT_BLUEDROID_ENABLED 1
+#define CONFIG_BT_BLE_ENABLED 1
+#define CONFIG_BT_GATTS_ENABLE 1
+#define CONFIG_BT_GATTC_ENABLE 1
+#define CONFIG_BT_BLE_42_FEATURES_SUPPORTED 1
+#ifndef CONFIG_BT_GATT_MAX_SR_ATTRIBUTES
+#define CONFIG_BT_GATT_MAX_SR_ATTRIBUTES 100
+#endif
+#define CONFIG_BT_GATT_MAX_SR_PROFILES 8
+#ifndef CONFIG_BT_ACL_CONNECTIONS
+#define CONFIG_BT_ACL_CONNECTIONS 4
+#endif
+#define CONFIG_BT_BTC_TASK_STACK_SIZE 3072
+#define CONFIG_BT_BTU_TASK_STACK_SIZE 4096
+#define CONFIG_BT_BLUEDROID_PINNED_TO_CORE 0
+#define CONFIG_FREERTOS_HZ 100
+#define CONFIG_BT_SMP_ENABLE 1
+#define CONFIG_BT_LOG_GATT_TRACE_LEVEL 2
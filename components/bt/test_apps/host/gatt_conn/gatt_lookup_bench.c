@@ -0,0 +1,201 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+
+/*
+ * Host benchmark for the GATT connection lookups of the Bluedroid stack
+ * (stack/gatt/gatt_utils.c).
+ *
+ * Up to GATT_MAX_PHY_CHANNEL peers with random addresses are connected
+ * through gatt_allocate_tcb_by_bdaddr(), each with a dynamic ATT channel
+ * and one client link control block.  Every operation then makes the
+ * lookups a request goes through: gatt_clcb_find_by_conn_id(),
+ * gatt_get_tcb_by_idx(), gatt_find_tcb_by_cid() and
+ * gatt_find_tcb_by_addr(), for a random connection.  The time per
+ * operation is printed for each number of connections.
+ *
+ * Connections are then dropped and added again in random order, and every
+ * lookup is checked against the peers that are connected.
+ *
+ * gatt_utils.c is included directly.  Build from components/bt:
+ *
+ *   H=test_apps/host
+ *   S=host/bluedroid/stack
+ *   gcc -O2 -std=gnu11 -w -ffunction-sections -Wl,--gc-sections \
+ *       -DCONFIG_BT_ACL_CONNECTIONS=9 \
+ *       -I$H/bluedroid_stub -include host_defs.h -I$S/gatt \
+ *       -Icommon/include -Icommon/osi/include -Icommon/api/include/api \
+ *       -Icommon/btc/include -Icommon/bt_stats/include \
+ *       -Ihost/bluedroid/common/include -I$S/include -I$S/gatt/include \
+ *       -I$S/btm/include -I$S/l2cap/include -Ihost/bluedroid/bta/include \
+ *       -Ihost/bluedroid/btc/include -Ihost/bluedroid/device/include \
+ *       -Ihost/bluedroid/hci/include -Ihost/bluedroid/api/include/api \
+ *       -I../log/include \
+ *       $H/gatt_conn/gatt_lookup_bench.c common/osi/list.c -o gatt_lookup_bench
+ *   ./gatt_lookup_bench
+ *
+ * Section GC drops the parts of gatt_utils.c that are not reached, and the
+ * stack functions they call.  For a baseline, build with
+ * -DGATT_TEST_BASELINE against the parent tree, where the ATT channel is
+ * set directly.
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <time.h>
+#include "gatt_utils.c"
+
+#define GATT_TEST_OPS           5000000
+#define GATT_TEST_CHURN         100000
+#define GATT_TEST_IF            3
+#define GATT_TEST_LCID(i)       (L2CAP_BASE_APPL_CID + (i))
+
+#if GATT_DYNAMIC_MEMORY == FALSE
+tGATT_CB gatt_cb;
+#endif
+
+typedef struct {
+    BD_ADDR bda;
+    tGATT_TCB *p_tcb;
+    tGATT_CLCB *p_clcb;
+    UINT16 conn_id;
+} gatt_test_conn_t;
+
+static gatt_test_conn_t gatt_test_conns[GATT_MAX_PHY_CHANNEL];
+
+/* Rest of the stack */
+void *osi_malloc_func(size_t size) { return malloc(size); }
+void *osi_calloc_func(size_t size) { return calloc(1, size); }
+void osi_free_func(void *ptr) { free(ptr); }
+fixed_queue_t *fixed_queue_new(size_t capacity) { return NULL; }
+void fixed_queue_free(fixed_queue_t *queue, fixed_queue_free_cb free_cb) {}
+void btu_free_timer(TIMER_LIST_ENT *p_tle) {}
+
+static void
+gatt_test_set_lcid(tGATT_TCB *p_tcb, UINT16 lcid)
+{
+#ifdef GATT_TEST_BASELINE
+    p_tcb->att_lcid = lcid;
+#else
+    gatt_set_tcb_lcid(p_tcb, lcid);
+#endif
+}
+
+static void
+gatt_test_connect(int i)
+{
+    gatt_test_conn_t *conn = &gatt_test_conns[i];
+
+    for (int k = 0; k < BD_ADDR_LEN; k++) {
+        conn->bda[k] = rand();
+    }
+    conn->p_tcb = gatt_allocate_tcb_by_bdaddr(conn->bda, BT_TRANSPORT_BR_EDR);
+    assert(conn->p_tcb);
+    gatt_test_set_lcid(conn->p_tcb, GATT_TEST_LCID(conn->p_tcb->tcb_idx));
+    conn->conn_id = GATT_CREATE_CONN_ID(conn->p_tcb->tcb_idx, GATT_TEST_IF);
+    conn->p_clcb = gatt_clcb_alloc(conn->conn_id);
+    assert(conn->p_clcb);
+}
+
+static void
+gatt_test_disconnect(int i)
+{
+    gatt_test_conn_t *conn = &gatt_test_conns[i];
+
+    gatt_clcb_dealloc(conn->p_clcb);
+    gatt_tcb_free(conn->p_tcb);
+    conn->p_tcb = NULL;
+}
+
+static void
+gatt_test_check(int n)
+{
+    for (int i = 0; i < n; i++) {
+        gatt_test_conn_t *conn = &gatt_test_conns[i];
+
+        if (!conn->p_tcb) {
+            assert(gatt_find_tcb_by_addr(conn->bda, BT_TRANSPORT_BR_EDR) == NULL);
+            continue;
+        }
+        assert(gatt_clcb_find_by_conn_id(conn->conn_id) == conn->p_clcb);
+        assert(gatt_get_tcb_by_idx(conn->p_tcb->tcb_idx) == conn->p_tcb);
+        assert(gatt_find_tcb_by_cid(conn->p_tcb->att_lcid) == conn->p_tcb);
+        assert(gatt_find_tcb_by_addr(conn->bda, BT_TRANSPORT_BR_EDR) == conn->p_tcb);
+        assert(gatt_find_tcb_by_addr(conn->bda, BT_TRANSPORT_LE) == NULL);
+    }
+}
+
+static void
+gatt_test_bench(int n)
+{
+    struct timespec start;
+    struct timespec end;
+    uintptr_t sink = 0;
+    double ns;
+
+    for (int i = 0; i < n; i++) {
+        gatt_test_connect(i);
+    }
+    gatt_test_check(n);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int op = 0; op < GATT_TEST_OPS; op++) {
+        gatt_test_conn_t *conn = &gatt_test_conns[op % n];
+        tGATT_CLCB *p_clcb = gatt_clcb_find_by_conn_id(conn->conn_id);
+        tGATT_TCB *p_tcb = gatt_get_tcb_by_idx(GATT_GET_TCB_IDX(p_clcb->conn_id));
+
+        sink += (uintptr_t)gatt_find_tcb_by_cid(p_tcb->att_lcid);
+        sink += (uintptr_t)gatt_find_tcb_by_addr(conn->bda, BT_TRANSPORT_BR_EDR);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    assert(sink);
+    ns = ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / GATT_TEST_OPS;
+    printf("%d connections: %.1f ns/operation\n", n, ns);
+
+    for (int i = 0; i < n; i++) {
+        gatt_test_disconnect(i);
+    }
+}
+
+static void
+gatt_test_churn(void)
+{
+    const int n = GATT_MAX_PHY_CHANNEL;
+
+    for (int i = 0; i < n; i++) {
+        gatt_test_connect(i);
+    }
+    for (int op = 0; op < GATT_TEST_CHURN; op++) {
+        int i = rand() % n;
+
+        if (gatt_test_conns[i].p_tcb) {
+            gatt_test_disconnect(i);
+        } else {
+            gatt_test_connect(i);
+        }
+        gatt_test_check(n);
+    }
+    for (int i = 0; i < n; i++) {
+        if (gatt_test_conns[i].p_tcb) {
+            gatt_test_disconnect(i);
+        }
+    }
+    printf("connect/disconnect churn ok\n");
+}
+
+int
+main(void)
+{
+    gatt_cb.p_clcb_list = list_new(osi_free_func);
+    gatt_cb.p_tcb_list = list_new(osi_free_func);
+    srand(1);
+
+    for (int n = 1; n <= GATT_MAX_PHY_CHANNEL; n += 2) {
+        gatt_test_bench(n);
+    }
+    gatt_test_churn();
+    return 0;
+}
@@ -0,0 +1,337 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+
+/*
+ * Host harness for the batching of GATTC notifications on their way to the
+ * BTC task (btc/profile/std/gatt/btc_gattc.c).
+ *
+ * Events are fed to the BTA callback of btc_gattc.c and the messages it
+ * posts are queued until they are handed to btc_gattc_cb_handler(), which
+ * delivers them to the application callback.  Every event carries a
+ * sequence number, and the application must see them in the order they
+ * were reported, whichever way notifications were batched.
+ *
+ * - 40 notifications in a row are delivered by three messages of 16, 16
+ *   and 8.
+ * - Another GATTC event closes the open batch: notifications reported
+ *   after it go into a new message, delivered after the event.
+ * - A batch that the BTC task has started delivering is not appended to.
+ * - A random mix of notifications, indications, other events and
+ *   deliveries is checked against a model of the batching rules, message
+ *   by message.
+ * - The BTU and BTC sides then run on two threads, and only the order and
+ *   the cap of 16 per message are checked.
+ *
+ * Every indication must be confirmed exactly once.
+ *
+ * btc_gattc.c is included directly to reach its BTA callback.  Build from
+ * components/bt:
+ *
+ *   H=test_apps/host
+ *   D=host/bluedroid
+ *   S=$D/stack
+ *   gcc -O2 -std=gnu11 -w -pthread -ffunction-sections -fdata-sections \
+ *       -Wl,--gc-sections \
+ *       -I$H/bluedroid_stub -include host_defs.h -I$D/btc/profile/std/gatt \
+ *       -Icommon/include -Icommon/osi/include -Icommon/api/include/api \
+ *       -Icommon/btc/include -Icommon/bt_stats/include \
+ *       -I$D/common/include -I$S/include -I$S/gatt/include \
+ *       -I$S/btm/include -I$S/l2cap/include -I$D/bta/include \
+ *       -I$D/btc/include -I$D/btc/profile/std/include \
+ *       -I$D/device/include -I$D/hci/include -I$D/api/include/api \
+ *       -I../log/include \
+ *       $H/gattc_notif/notif_batch_test.c -o notif_batch_test
+ *   ./notif_batch_test
+ *
+ * -fdata-sections lets section GC drop the request handler of btc_gattc.c,
+ * whose jump table would otherwise keep the whole BTA GATTC API.
+ */
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include "btc_gattc.c"
+
+#define BATCH_TEST_CONN_ID      0x0103
+#define BATCH_TEST_MAX_MSGS     4096
+#define BATCH_TEST_RANDOM_OPS   200000
+#define BATCH_TEST_THREAD_EVTS  1000000
+
+/* Messages posted to the BTC task, in order */
+static pthread_mutex_t batch_test_q_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t batch_test_q_cond = PTHREAD_COND_INITIALIZER;
+static btc_msg_t *batch_test_q[BATCH_TEST_MAX_MSGS];
+static unsigned batch_test_q_head;
+static unsigned batch_test_q_tail;
+
+/* What the application has seen */
+static uint32_t batch_test_next_seq;
+static uint32_t batch_test_seen;
+static int batch_test_msg_notifs;
+static int batch_test_confirms;
+static int batch_test_indications;
+
+static pthread_mutex_t batch_test_global_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Rest of the stack */
+void *osi_malloc_func(size_t size) { return malloc(size); }
+void *osi_calloc_func(size_t size) { return calloc(1, size); }
+void osi_free_func(void *ptr) { free(ptr); }
+void osi_mutex_global_lock(void) { pthread_mutex_lock(&batch_test_global_lock); }
+void osi_mutex_global_unlock(void) { pthread_mutex_unlock(&batch_test_global_lock); }
+void BTA_GATTC_SendIndConfirm(UINT16 conn_id, UINT16 handle) { batch_test_confirms++; }
+void bta_gattc_clcb_dealloc_by_conn_id(UINT16 conn_id) {}
+void bta_to_btc_gatt_id(esp_gatt_id_t *p_dest, tBTA_GATT_ID *p_src) {}
+uint16_t set_read_value(uint8_t *gattc_if, esp_ble_gattc_cb_param_t *p_dest, tBTA_GATTC_READ *p_src) { return 0; }
+bool btc_storage_update_active_device(bt_bdaddr_t *remote_bd_addr) { return false; }
+
+static void
+batch_test_app_cb(esp_gattc_cb_event_t event, esp_gatt_if_t gattc_if, esp_ble_gattc_cb_param_t *param)
+{
+    uint32_t seq;
+
+    if (event == ESP_GATTC_NOTIFY_EVT) {
+        assert(param->notify.value_len == sizeof(seq));
+        memcpy(&seq, param->notify.value, sizeof(seq));
+        assert(param->notify.handle == (UINT16) seq);
+        batch_test_msg_notifs++;
+    } else {
+        assert(event == ESP_GATTC_WRITE_DESCR_EVT);
+        seq = param->write.handle;
+    }
+    assert(gattc_if == BTC_GATT_GET_GATT_IF(BATCH_TEST_CONN_ID));
+    assert((UINT16) seq == (UINT16) batch_test_seen);
+    batch_test_seen++;
+}
+
+void *
+btc_profile_cb_get(btc_pid_t profile_id)
+{
+    return batch_test_app_cb;
+}
+
+bt_status_t
+btc_transfer_context(btc_msg_t *msg, void *arg, int arg_len, btc_arg_deep_copy_t copy_func,
+                     btc_arg_deep_free_t free_func)
+{
+    btc_msg_t *lmsg = osi_malloc(sizeof(btc_msg_t) + arg_len);
+
+    assert(lmsg);
+    memcpy(lmsg, msg, sizeof(btc_msg_t));
+    memcpy(lmsg->arg, arg, arg_len);
+    if (copy_func) {
+        copy_func(lmsg, lmsg->arg, arg);
+    }
+    pthread_mutex_lock(&batch_test_q_lock);
+    assert(batch_test_q_tail - batch_test_q_head < BATCH_TEST_MAX_MSGS);
+    batch_test_q[batch_test_q_tail++ % BATCH_TEST_MAX_MSGS] = lmsg;
+    pthread_cond_signal(&batch_test_q_cond);
+    pthread_mutex_unlock(&batch_test_q_lock);
+    return BT_STATUS_SUCCESS;
+}
+
+static unsigned
+batch_test_pending(void)
+{
+    unsigned n;
+
+    pthread_mutex_lock(&batch_test_q_lock);
+    n = batch_test_q_tail - batch_test_q_head;
+    pthread_mutex_unlock(&batch_test_q_lock);
+    return n;
+}
+
+/* The BTC task: deliver the oldest message, returning the notifications it carried */
+static int
+batch_test_deliver(void)
+{
+    btc_msg_t *msg;
+
+    pthread_mutex_lock(&batch_test_q_lock);
+    while (batch_test_q_head == batch_test_q_tail) {
+        pthread_cond_wait(&batch_test_q_cond, &batch_test_q_lock);
+    }
+    msg = batch_test_q[batch_test_q_head++ % BATCH_TEST_MAX_MSGS];
+    pthread_mutex_unlock(&batch_test_q_lock);
+
+    batch_test_msg_notifs = 0;
+    btc_gattc_cb_handler(msg);
+    if (msg->act == BTA_GATTC_NOTIF_EVT) {
+        assert(batch_test_msg_notifs >= 1 && batch_test_msg_notifs <= BTC_GATTC_NOTIF_BATCH_MAX);
+    } else {
+        assert(batch_test_msg_notifs == 0);
+    }
+    osi_free(msg);
+    return batch_test_msg_notifs;
+}
+
+/* The BTU side: report a notification, or an indication */
+static void
+batch_test_notify(BOOLEAN is_notify)
+{
+    uint32_t seq = batch_test_next_seq++;
+    tBTA_GATTC data;
+
+    memset(&data, 0, sizeof(data));
+    data.notify.conn_id = BATCH_TEST_CONN_ID;
+    data.notify.handle = (UINT16) seq;
+    data.notify.len = sizeof(seq);
+    data.notify.value = (UINT8 *) &seq;
+    data.notify.is_notify = is_notify;
+    batch_test_indications += !is_notify;
+    btc_gattc_cback(BTA_GATTC_NOTIF_EVT, &data);
+    /* The value is only valid during the callback */
+    seq = 0xdeadbeef;
+}
+
+/* The BTU side: report an event other than a notification */
+static void
+batch_test_event(void)
+{
+    tBTA_GATTC data;
+
+    memset(&data, 0, sizeof(data));
+    data.write.conn_id = BATCH_TEST_CONN_ID;
+    data.write.status = BTA_GATT_OK;
+    data.write.handle = (UINT16) batch_test_next_seq++;
+    btc_gattc_cback(BTA_GATTC_WRITE_DESCR_EVT, &data);
+}
+
+static void
+batch_test_notify_n(int n)
+{
+    for (int i = 0; i < n; i++) {
+        batch_test_notify(TRUE);
+    }
+}
+
+static void
+batch_test_fixed(void)
+{
+    /* A run of notifications is capped at 16 per message */
+    batch_test_notify_n(40);
+    assert(batch_test_pending() == 3);
+    assert(batch_test_deliver() == 16);
+    assert(batch_test_deliver() == 16);
+    assert(batch_test_deliver() == 8);
+
+    /* Another event closes the batch, and is delivered between the two */
+    batch_test_notify_n(5);
+    batch_test_event();
+    batch_test_notify_n(5);
+    assert(batch_test_pending() == 3);
+    assert(batch_test_deliver() == 5);
+    assert(batch_test_deliver() == 0);
+    assert(batch_test_deliver() == 5);
+
+    /* A batch being delivered is not appended to */
+    batch_test_notify_n(3);
+    assert(batch_test_deliver() == 3);
+    batch_test_notify_n(3);
+    assert(batch_test_pending() == 1);
+    assert(batch_test_deliver() == 3);
+
+    assert(batch_test_seen == batch_test_next_seq);
+    printf("fixed    events %u\n", (unsigned) batch_test_seen);
+}
+
+/* Random single threaded mix, checked against a model of the batching rules */
+static void
+batch_test_random(void)
+{
+    static int model[BATCH_TEST_MAX_MSGS];
+    unsigned head = 0;
+    unsigned tail = 0;
+    int open = -1;
+    int msgs = 0;
+
+    srand(122);
+    for (int op = 0; op < BATCH_TEST_RANDOM_OPS; op++) {
+        int r = rand() % 100;
+
+        if (r < 60 && tail - head < BATCH_TEST_MAX_MSGS) {
+            batch_test_notify(r % 10 != 0);
+            if (open >= 0) {
+                if (++model[open % BATCH_TEST_MAX_MSGS] == BTC_GATTC_NOTIF_BATCH_MAX) {
+                    open = -1;
+                }
+            } else {
+                open = tail;
+                model[tail++ % BATCH_TEST_MAX_MSGS] = 1;
+            }
+        } else if (r < 65 && tail - head < BATCH_TEST_MAX_MSGS) {
+            batch_test_event();
+            open = -1;
+            model[tail++ % BATCH_TEST_MAX_MSGS] = 0;
+        } else if (head != tail) {
+            assert(batch_test_deliver() == model[head % BATCH_TEST_MAX_MSGS]);
+            if (open == (int) head) {
+                open = -1;
+            }
+            head++;
+            msgs++;
+        }
+        assert(batch_test_pending() == tail - head);
+    }
+    while (head != tail) {
+        assert(batch_test_deliver() == model[head++ % BATCH_TEST_MAX_MSGS]);
+        msgs++;
+    }
+    assert(batch_test_seen == batch_test_next_seq);
+    printf("random   events %u messages %d\n", (unsigned) batch_test_seen, msgs);
+}
+
+static void *
+batch_test_btc_thread(void *arg)
+{
+    uint32_t end = *(uint32_t *) arg;
+    int msgs = 0;
+
+    while (batch_test_seen != end) {
+        batch_test_deliver();
+        msgs++;
+    }
+    return (void *)(intptr_t) msgs;
+}
+
+/* BTU and BTC on two threads, so batches are appended to while being delivered */
+static void
+batch_test_threads(void)
+{
+    uint32_t start = batch_test_next_seq;
+    uint32_t end = start + BATCH_TEST_THREAD_EVTS;
+    pthread_t btc;
+    void *msgs;
+
+    pthread_create(&btc, NULL, batch_test_btc_thread, &end);
+    while (batch_test_next_seq != end) {
+        int r = rand() % 100;
+
+        if (r < 2) {
+            batch_test_event();
+        } else {
+            batch_test_notify(r % 10 != 0);
+        }
+        /* Keep within the queue */
+        while (batch_test_pending() > BATCH_TEST_MAX_MSGS / 2) {
+            sched_yield();
+        }
+    }
+    pthread_join(btc, &msgs);
+    assert(batch_test_seen == end);
+    printf("threads  events %u messages %d\n", (unsigned)(end - start), (int)(intptr_t) msgs);
+}
+
+int
+main(void)
+{
+    batch_test_fixed();
+    batch_test_random();
+    batch_test_threads();
+    assert(batch_test_confirms == batch_test_indications);
+    printf("indications confirmed %d\nok\n", batch_test_confirms);
+    return 0;
+}
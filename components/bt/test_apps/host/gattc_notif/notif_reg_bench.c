@@ -0,0 +1,214 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+
+/*
+ * Host benchmark for the Bluedroid GATTC notification registry
+ * (bta/gatt/bta_gattc_utils.c).
+ *
+ * A client registers for notifications of random handles on a few servers
+ * through BTA_GATTC_RegisterForNotifications(), then looks up incoming
+ * notifications the way bta_gattc_process_notify() does, with
+ * bta_gattc_check_notif_registry().  Half of the lookups are for handles
+ * that are not registered.  The time per lookup is printed for 4, 16 and
+ * BTA_GATTC_NOTIF_REG_MAX registrations.
+ *
+ * A randomized run of registrations, deregistrations and clears by
+ * address is then checked against a plain list of what should be
+ * registered.
+ *
+ * bta_gattc_api.c and bta_gattc_utils.c are included directly.  Build from
+ * components/bt:
+ *
+ *   H=test_apps/host
+ *   B=host/bluedroid/bta
+ *   S=host/bluedroid/stack
+ *   gcc -O2 -std=gnu11 -w -ffunction-sections -Wl,--gc-sections \
+ *       -DCONFIG_BT_GATTC_NOTIF_REG_MAX=64 \
+ *       -I$H/bluedroid_stub -include host_defs.h -I$B/gatt \
+ *       -Icommon/include -Icommon/osi/include -Icommon/api/include/api \
+ *       -Icommon/btc/include -Icommon/bt_stats/include \
+ *       -Ihost/bluedroid/common/include -I$S/include -I$S/gatt/include \
+ *       -I$S/btm/include -I$S/l2cap/include \
+ *       -I$B/include -I$B/gatt/include -Ihost/bluedroid/btc/include \
+ *       -Ihost/bluedroid/device/include -Ihost/bluedroid/hci/include \
+ *       -Ihost/bluedroid/api/include/api -I../log/include \
+ *       $H/gattc_notif/notif_reg_bench.c -o notif_reg_bench
+ *   ./notif_reg_bench
+ *
+ * Section GC drops the parts of both files that are not reached, and the
+ * stack functions they call.  Build the same way against the parent tree
+ * for a baseline.
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <time.h>
+#include "bta_gattc_api.c"
+#include "bta_gattc_utils.c"
+
+#define NOTIF_TEST_IF           3
+#define NOTIF_TEST_SERVERS      4
+#define NOTIF_TEST_LOOKUPS      2000000
+#define NOTIF_TEST_OPS          200000
+
+#if BTA_DYNAMIC_MEMORY == FALSE
+tBTA_GATTC_CB bta_gattc_cb;
+#endif
+
+typedef struct {
+    BD_ADDR bda;
+    UINT16 handle;
+} notif_test_reg_t;
+
+static notif_test_reg_t notif_test_regs[BTA_GATTC_NOTIF_REG_MAX];
+static int notif_test_count;
+
+/* Rest of the stack */
+void *osi_malloc_func(size_t size) { return malloc(size); }
+void *osi_calloc_func(size_t size) { return calloc(1, size); }
+void osi_free_func(void *ptr) { free(ptr); }
+
+static void
+notif_test_server(int i, BD_ADDR bda)
+{
+    bda[0] = 0xc0;
+    bda[1] = 0x11;
+    bda[2] = 0x22;
+    bda[3] = 0x33;
+    bda[4] = 0x44;
+    bda[5] = i;
+}
+
+static int
+notif_test_find(BD_ADDR bda, UINT16 handle)
+{
+    for (int i = 0; i < notif_test_count; i++) {
+        if (notif_test_regs[i].handle == handle && !bdcmp(notif_test_regs[i].bda, bda)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static BOOLEAN
+notif_test_lookup(tBTA_GATTC_RCB *p_clreg, BD_ADDR bda, UINT16 handle)
+{
+    tBTA_GATTC_SERV srcb;
+    tBTA_GATTC_NOTIFY notify;
+
+    bdcpy(srcb.server_bda, bda);
+    notify.handle = handle;
+    return bta_gattc_check_notif_registry(p_clreg, &srcb, &notify);
+}
+
+static void
+notif_test_reset(tBTA_GATTC_RCB *p_clreg)
+{
+    memset(p_clreg, 0, sizeof(*p_clreg));
+    p_clreg->in_use = TRUE;
+    p_clreg->client_if = NOTIF_TEST_IF;
+    notif_test_count = 0;
+}
+
+static void
+notif_test_register(BD_ADDR bda, UINT16 handle)
+{
+    assert(BTA_GATTC_RegisterForNotifications(NOTIF_TEST_IF, bda, handle) == BTA_GATT_OK);
+    if (notif_test_find(bda, handle) < 0) {
+        bdcpy(notif_test_regs[notif_test_count].bda, bda);
+        notif_test_regs[notif_test_count].handle = handle;
+        notif_test_count++;
+    }
+}
+
+static void
+notif_test_bench(tBTA_GATTC_RCB *p_clreg, int regs)
+{
+    struct timespec start;
+    struct timespec end;
+    unsigned long hits = 0;
+    BD_ADDR bda;
+    double ns;
+
+    notif_test_reset(p_clreg);
+    while (notif_test_count < regs) {
+        notif_test_server(rand() % NOTIF_TEST_SERVERS, bda);
+        notif_test_register(bda, 1 + rand() % 0x100);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < NOTIF_TEST_LOOKUPS; i++) {
+        notif_test_reg_t *reg = &notif_test_regs[i % regs];
+        /* Every other lookup is for an unregistered handle */
+        hits += notif_test_lookup(p_clreg, reg->bda, reg->handle + (i & 1) * 0x1000);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    assert(hits == NOTIF_TEST_LOOKUPS / 2);
+    ns = ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / NOTIF_TEST_LOOKUPS;
+    printf("%2d registrations: %.1f ns/lookup\n", regs, ns);
+}
+
+static void
+notif_test_random(tBTA_GATTC_RCB *p_clreg)
+{
+    BD_ADDR bda;
+    UINT16 handle;
+    int i;
+
+    notif_test_reset(p_clreg);
+    for (int op = 0; op < NOTIF_TEST_OPS; op++) {
+        notif_test_server(rand() % NOTIF_TEST_SERVERS, bda);
+        handle = 1 + rand() % 40;
+        switch (rand() % 16) {
+        case 0:
+            /* The server went away */
+            bta_gattc_clear_notif_registration_by_bda(p_clreg, bda);
+            for (i = 0; i < notif_test_count;) {
+                if (!bdcmp(notif_test_regs[i].bda, bda)) {
+                    notif_test_regs[i] = notif_test_regs[--notif_test_count];
+                } else {
+                    i++;
+                }
+            }
+            break;
+        case 1 ... 7:
+            if ((i = notif_test_find(bda, handle)) >= 0) {
+                assert(BTA_GATTC_DeregisterForNotifications(NOTIF_TEST_IF, bda, handle) == BTA_GATT_OK);
+                notif_test_regs[i] = notif_test_regs[--notif_test_count];
+            } else {
+                assert(BTA_GATTC_DeregisterForNotifications(NOTIF_TEST_IF, bda, handle) == BTA_GATT_ERROR);
+            }
+            break;
+        default:
+            if (notif_test_count < BTA_GATTC_NOTIF_REG_MAX || notif_test_find(bda, handle) >= 0) {
+                notif_test_register(bda, handle);
+            } else {
+                assert(BTA_GATTC_RegisterForNotifications(NOTIF_TEST_IF, bda, handle) ==
+                       BTA_GATT_NO_RESOURCES);
+            }
+            break;
+        }
+
+        notif_test_server(rand() % NOTIF_TEST_SERVERS, bda);
+        handle = 1 + rand() % 40;
+        assert(notif_test_lookup(p_clreg, bda, handle) == (notif_test_find(bda, handle) >= 0));
+    }
+    printf("randomized registry ok\n");
+}
+
+int
+main(void)
+{
+    tBTA_GATTC_RCB *p_clreg = &bta_gattc_cb.cl_rcb[0];
+
+    srand(1);
+    notif_test_bench(p_clreg, 4);
+    notif_test_bench(p_clreg, 16);
+    notif_test_bench(p_clreg, BTA_GATTC_NOTIF_REG_MAX);
+    notif_test_random(p_clreg);
+    return 0;
+}
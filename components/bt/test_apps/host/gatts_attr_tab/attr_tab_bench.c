@@ -0,0 +1,560 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+
+/*
+ * Host benchmark for Bluedroid GATT server attribute table creation
+ * (btc/profile/std/gatt/btc_gatts.c, bta/gatt/bta_gatts_act.c).
+ *
+ * The BTC and BTU tasks are stood in for by two threads with a message
+ * queue each, so requests and events cross threads as they do on target.
+ * A service of one characteristic declaration, value and client
+ * configuration descriptor per three entries is created with
+ * esp_ble_gatts_create_attr_tab() and deleted again, for tables of 10 to
+ * 301 entries.  The time from the call to ESP_GATTS_CREAT_ATTR_TAB_EVT is
+ * printed per table size.
+ *
+ * Every table is also built one attribute at a time with
+ * esp_ble_gatts_create_service(), esp_ble_gatts_add_char() and
+ * esp_ble_gatts_add_char_descr(), waiting for each event.  The handles
+ * reported for the table must match that path entry by entry, relative to
+ * the service handle, and every value must read back the same.  A hash of
+ * the relative handles is printed, which must not change between versions
+ * of these files.
+ *
+ * Build from components/bt:
+ *
+ *   H=test_apps/host
+ *   D=host/bluedroid
+ *   S=$D/stack
+ *   gcc -O2 -std=gnu11 -w -pthread -ffunction-sections -Wl,--gc-sections \
+ *       -DCONFIG_BT_GATT_MAX_SR_ATTRIBUTES=301 \
+ *       -I$H/bluedroid_stub -include host_defs.h \
+ *       -Icommon/include -Icommon/osi/include -Icommon/api/include/api \
+ *       -Icommon/btc/include -Icommon/bt_stats/include \
+ *       -I$D/common/include -I$S/include -I$S/gatt/include \
+ *       -I$S/btm/include -I$S/l2cap/include -I$D/bta/include \
+ *       -I$D/bta/gatt/include -I$D/btc/include \
+ *       -I$D/btc/profile/std/include -I$D/device/include \
+ *       -I$D/hci/include -I$D/api/include/api -I../log/include \
+ *       $H/gatts_attr_tab/attr_tab_bench.c $D/api/esp_gatts_api.c \
+ *       $D/btc/profile/std/gatt/btc_gatts.c \
+ *       $D/btc/profile/std/gatt/btc_gatt_util.c \
+ *       $D/bta/gatt/bta_gatts_act.c $D/bta/gatt/bta_gatts_api.c \
+ *       $D/bta/gatt/bta_gatts_main.c $D/bta/gatt/bta_gatts_utils.c \
+ *       $S/gatt/gatt_api.c $S/gatt/gatt_db.c $S/gatt/gatt_utils.c \
+ *       common/osi/list.c common/osi/fixed_queue.c common/osi/future.c \
+ *       -o attr_tab_bench
+ *   ./attr_tab_bench
+ *
+ * Section GC drops what the creation paths do not reach.  Build the same
+ * way against the parent tree for a baseline.
+ */
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bt_common.h"
+#include "osi/allocator.h"
+#include "osi/future.h"
+#include "osi/mutex.h"
+#include "osi/semaphore.h"
+#include "btc/btc_task.h"
+#include "btc/btc_manage.h"
+#include "bta/bta_sys.h"
+#include "bta/bta_gatts_co.h"
+#include "esp_bt_main.h"
+#include "esp_gatts_api.h"
+#include "gatt_int.h"
+#include "l2c_int.h"
+
+#define ATTR_TEST_APP_ID        0x55
+#define ATTR_TEST_MAX_ENTRIES   301
+#define ATTR_TEST_VAL_LEN       20
+
+#if GATT_DYNAMIC_MEMORY == FALSE
+tGATT_CB gatt_cb;
+#endif
+
+/* One message queue per thread */
+typedef struct attr_test_msg {
+    struct attr_test_msg *next;
+    void *data;
+} attr_test_msg_t;
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    attr_test_msg_t *head;
+    attr_test_msg_t *tail;
+} attr_test_queue_t;
+
+static attr_test_queue_t attr_test_btc_q = {
+    PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER,
+};
+static attr_test_queue_t attr_test_btu_q = {
+    PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER,
+};
+
+/* Last event delivered to the application */
+static pthread_mutex_t attr_test_evt_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t attr_test_evt_cond = PTHREAD_COND_INITIALIZER;
+static esp_gatts_cb_event_t attr_test_evt;
+static esp_ble_gatts_cb_param_t attr_test_param;
+static uint16_t attr_test_tab_handles[ATTR_TEST_MAX_ENTRIES];
+static int attr_test_evt_ready;
+
+static esp_gatts_cb_t attr_test_gatts_cb;
+static esp_gatt_if_t attr_test_if;
+
+static esp_gatts_attr_db_t attr_test_db[ATTR_TEST_MAX_ENTRIES];
+static uint16_t attr_test_ref_handles[ATTR_TEST_MAX_ENTRIES];
+static uint8_t attr_test_vals[ATTR_TEST_MAX_ENTRIES][ATTR_TEST_VAL_LEN];
+
+static const uint16_t attr_test_pri_uuid = ESP_GATT_UUID_PRI_SERVICE;
+static const uint16_t attr_test_char_uuid = ESP_GATT_UUID_CHAR_DECLARE;
+static const uint16_t attr_test_cccd_uuid = ESP_GATT_UUID_CHAR_CLIENT_CONFIG;
+static const uint16_t attr_test_svc_uuid = 0x18ff;
+static const uint8_t attr_test_prop = ESP_GATT_CHAR_PROP_BIT_READ | ESP_GATT_CHAR_PROP_BIT_NOTIFY;
+static uint16_t attr_test_val_uuids[ATTR_TEST_MAX_ENTRIES];
+
+static void
+attr_test_put(attr_test_queue_t *q, void *data)
+{
+    attr_test_msg_t *m = malloc(sizeof(*m));
+
+    assert(m);
+    m->next = NULL;
+    m->data = data;
+    pthread_mutex_lock(&q->lock);
+    if (q->tail) {
+        q->tail->next = m;
+    } else {
+        q->head = m;
+    }
+    q->tail = m;
+    pthread_cond_signal(&q->cond);
+    pthread_mutex_unlock(&q->lock);
+}
+
+static void *
+attr_test_get(attr_test_queue_t *q)
+{
+    attr_test_msg_t *m;
+    void *data;
+
+    pthread_mutex_lock(&q->lock);
+    while (!q->head) {
+        pthread_cond_wait(&q->cond, &q->lock);
+    }
+    m = q->head;
+    q->head = m->next;
+    if (!q->head) {
+        q->tail = NULL;
+    }
+    pthread_mutex_unlock(&q->lock);
+    data = m->data;
+    free(m);
+    return data;
+}
+
+static void *
+attr_test_btc_thread(void *arg)
+{
+    while (1) {
+        btc_msg_t *msg = attr_test_get(&attr_test_btc_q);
+
+        if (msg->sig == BTC_SIG_API_CALL) {
+            btc_gatts_call_handler(msg);
+        } else {
+            btc_gatts_cb_handler(msg);
+        }
+        osi_free(msg);
+    }
+    return NULL;
+}
+
+static void *
+attr_test_btu_thread(void *arg)
+{
+    while (1) {
+        BT_HDR *p_msg = attr_test_get(&attr_test_btu_q);
+
+        if (bta_gatts_hdl_event(p_msg)) {
+            osi_free(p_msg);
+        }
+    }
+    return NULL;
+}
+
+/* Rest of the stack */
+void *osi_malloc_func(size_t size) { return malloc(size); }
+void *osi_calloc_func(size_t size) { return calloc(1, size); }
+void osi_free_func(void *ptr) { free(ptr); }
+esp_bluedroid_status_t esp_bluedroid_get_status(void) { return ESP_BLUEDROID_STATUS_ENABLED; }
+void *btc_profile_cb_get(btc_pid_t profile_id) { return attr_test_gatts_cb; }
+void bta_sys_register(UINT8 id, const tBTA_SYS_REG *p_reg) {}
+void bta_sys_deregister(UINT8 id) {}
+BOOLEAN bta_sys_is_register(UINT8 id) { return TRUE; }
+void bta_sys_sendmsg(void *p_msg) { attr_test_put(&attr_test_btu_q, p_msg); }
+void bta_sys_busy(UINT8 id, UINT8 app_id, BD_ADDR peer_addr) {}
+void bta_sys_idle(UINT8 id, UINT8 app_id, BD_ADDR peer_addr) {}
+void bta_sys_conn_open(UINT8 id, UINT8 app_id, BD_ADDR peer_addr) {}
+void bta_sys_conn_close(UINT8 id, UINT8 app_id, BD_ADDR peer_addr) {}
+void bta_gatts_co_update_handle_range(BOOLEAN is_add, tBTA_GATTS_HNDL_RANGE *p_hndl_range) {}
+BOOLEAN bta_gatts_co_srv_chg(tBTA_GATTS_SRV_CHG_CMD cmd, tBTA_GATTS_SRV_CHG_REQ *p_req,
+                             tBTA_GATTS_SRV_CHG_RSP *p_rsp) { return FALSE; }
+BOOLEAN bta_gatts_co_load_handle_range(UINT8 index, tBTA_GATTS_HNDL_RANGE *p_handle) { return FALSE; }
+bool btc_storage_update_active_device(bt_bdaddr_t *remote_bd_addr) { return false; }
+void BTM_BleUpdateAdvFilterPolicy(tBTM_BLE_AFP adv_policy) {}
+BOOLEAN BTM_BleUpdateAdvWhitelist(BOOLEAN add_remove, BD_ADDR emote_bda, tBLE_ADDR_TYPE addr_type,
+                                  tBTM_UPDATE_WHITELIST_CBACK *update_wl_cb) { return FALSE; }
+BOOLEAN BTM_BleUpdateBgConnDev(BOOLEAN add_remove, BD_ADDR remote_bda) { return FALSE; }
+UINT16 BTM_ReadConnectability(UINT16 *p_window, UINT16 *p_interval) { return 0; }
+tBTM_STATUS btm_ble_set_connectability(UINT16 combined_mode) { return BTM_SUCCESS; }
+tL2C_LCB *l2cu_find_lcb_by_bd_addr(BD_ADDR p_bd_addr, tBT_TRANSPORT transport) { return NULL; }
+void l2ble_update_att_acl_pkt_num(UINT8 type, tl2c_buff_param_t *param) {}
+void btu_start_timer(TIMER_LIST_ENT *p_tle, UINT16 type, UINT32 timeout) {}
+void btu_stop_timer(TIMER_LIST_ENT *p_tle) {}
+void btu_free_timer(TIMER_LIST_ENT *p_tle) {}
+BT_HDR *attp_build_sr_msg(tGATT_TCB *p_tcb, UINT8 op_code, tGATT_SR_MSG *p_msg) { return NULL; }
+tGATT_STATUS attp_send_sr_msg(tGATT_TCB *p_tcb, BT_HDR *p_msg) { return GATT_ERROR; }
+BOOLEAN gatt_act_connect(tGATT_REG *p_reg, BD_ADDR bd_addr, tBLE_ADDR_TYPE bd_addr_type,
+                         tBT_TRANSPORT transport, BOOLEAN is_aux) { return FALSE; }
+BOOLEAN gatt_disconnect(tGATT_TCB *p_tcb) { return FALSE; }
+tGATT_CH_STATE gatt_get_ch_state(tGATT_TCB *p_tcb) { return GATT_CH_CLOSE; }
+void gatt_update_app_use_link_flag(tGATT_IF gatt_if, tGATT_TCB *p_tcb, BOOLEAN is_add,
+                                   BOOLEAN check_acl_link) {}
+void gatt_init_srv_chg(void) {}
+void gatt_proc_srv_chg(void) {}
+tGATT_STATUS gatt_send_srv_chg_ind(BD_ADDR peer_bda) { return GATT_SUCCESS; }
+tGATT_STATUS gatt_sr_process_app_rsp(tGATT_TCB *p_tcb, tGATT_IF gatt_if, UINT32 trans_id, UINT8 op_code,
+                                     tGATT_STATUS status, tGATTS_RSP *p_msg) { return GATT_ERROR; }
+tGATT_STATUS gatt_proc_read(UINT16 conn_id, tGATTS_REQ_TYPE type, tGATT_READ_REQ *p_data,
+                            tGATTS_RSP *p_rsp) { return GATT_NOT_FOUND; }
+tGATT_STATUS gap_proc_read(tGATTS_REQ_TYPE type, tGATT_READ_REQ *p_data, tGATTS_RSP *p_rsp) { return GATT_NOT_FOUND; }
+void gatts_show_local_database(void) {}
+
+int
+btc_profile_cb_set(btc_pid_t profile_id, void *cb)
+{
+    attr_test_gatts_cb = cb;
+    return 0;
+}
+
+bt_status_t
+btc_transfer_context(btc_msg_t *msg, void *arg, int arg_len, btc_arg_deep_copy_t copy_func,
+                     btc_arg_deep_free_t free_func)
+{
+    btc_msg_t *lmsg = osi_malloc(sizeof(btc_msg_t) + arg_len);
+
+    assert(lmsg);
+    memcpy(lmsg, msg, sizeof(btc_msg_t));
+    if (arg) {
+        memset(lmsg->arg, 0, arg_len);
+        memcpy(lmsg->arg, arg, arg_len);
+        if (copy_func) {
+            copy_func(lmsg, lmsg->arg, arg);
+        }
+    }
+    attr_test_put(&attr_test_btc_q, lmsg);
+    return BT_STATUS_SUCCESS;
+}
+
+/* fixed_queue.c, and the futures the parent tree waits on, run on pthreads */
+int
+osi_mutex_new(osi_mutex_t *mutex)
+{
+    pthread_mutex_t *m = malloc(sizeof(*m));
+
+    pthread_mutex_init(m, NULL);
+    *mutex = m;
+    return 0;
+}
+
+int
+osi_mutex_lock(osi_mutex_t *mutex, uint32_t timeout)
+{
+    return pthread_mutex_lock(*mutex);
+}
+
+void
+osi_mutex_unlock(osi_mutex_t *mutex)
+{
+    pthread_mutex_unlock(*mutex);
+}
+
+void
+osi_mutex_free(osi_mutex_t *mutex)
+{
+    free(*mutex);
+    *mutex = NULL;
+}
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int count;
+} attr_test_sem_t;
+
+int
+osi_sem_new(osi_sem_t *sem, uint32_t max_count, uint32_t init_count)
+{
+    attr_test_sem_t *s = calloc(1, sizeof(*s));
+
+    pthread_mutex_init(&s->lock, NULL);
+    pthread_cond_init(&s->cond, NULL);
+    s->count = init_count;
+    *sem = (osi_sem_t) s;
+    return 0;
+}
+
+void
+osi_sem_free(osi_sem_t *sem)
+{
+    free(*sem);
+    *sem = NULL;
+}
+
+int
+osi_sem_take(osi_sem_t *sem, uint32_t timeout)
+{
+    attr_test_sem_t *s = (attr_test_sem_t *) *sem;
+
+    pthread_mutex_lock(&s->lock);
+    while (s->count == 0) {
+        pthread_cond_wait(&s->cond, &s->lock);
+    }
+    s->count--;
+    pthread_mutex_unlock(&s->lock);
+    return 0;
+}
+
+void
+osi_sem_give(osi_sem_t *sem)
+{
+    attr_test_sem_t *s = (attr_test_sem_t *) *sem;
+
+    pthread_mutex_lock(&s->lock);
+    s->count++;
+    pthread_cond_signal(&s->cond);
+    pthread_mutex_unlock(&s->lock);
+}
+
+static void
+attr_test_gatts_event(esp_gatts_cb_event_t event, esp_gatt_if_t gatts_if,
+                      esp_ble_gatts_cb_param_t *param)
+{
+    pthread_mutex_lock(&attr_test_evt_lock);
+    assert(!attr_test_evt_ready);
+    attr_test_evt = event;
+    attr_test_param = *param;
+    if (event == ESP_GATTS_REG_EVT) {
+        attr_test_if = gatts_if;
+    }
+    if (event == ESP_GATTS_CREAT_ATTR_TAB_EVT && param->add_attr_tab.handles) {
+        assert(param->add_attr_tab.num_handle <= ATTR_TEST_MAX_ENTRIES);
+        memcpy(attr_test_tab_handles, param->add_attr_tab.handles,
+               param->add_attr_tab.num_handle * sizeof(uint16_t));
+    }
+    attr_test_evt_ready = 1;
+    pthread_cond_signal(&attr_test_evt_cond);
+    pthread_mutex_unlock(&attr_test_evt_lock);
+}
+
+static esp_ble_gatts_cb_param_t *
+attr_test_wait(esp_gatts_cb_event_t event)
+{
+    pthread_mutex_lock(&attr_test_evt_lock);
+    while (!attr_test_evt_ready) {
+        pthread_cond_wait(&attr_test_evt_cond, &attr_test_evt_lock);
+    }
+    attr_test_evt_ready = 0;
+    pthread_mutex_unlock(&attr_test_evt_lock);
+    assert(attr_test_evt == event);
+    return &attr_test_param;
+}
+
+static void
+attr_test_build(int entries)
+{
+    assert(entries % 3 == 1);
+    memset(attr_test_db, 0, sizeof(attr_test_db));
+    attr_test_db[0] = (esp_gatts_attr_db_t) {
+        { ESP_GATT_AUTO_RSP },
+        { ESP_UUID_LEN_16, (uint8_t *) &attr_test_pri_uuid, ESP_GATT_PERM_READ,
+          sizeof(attr_test_svc_uuid), sizeof(attr_test_svc_uuid), (uint8_t *) &attr_test_svc_uuid },
+    };
+    for (int i = 1; i + 2 < entries; i += 3) {
+        attr_test_val_uuids[i + 1] = 0x2a00 + i;
+        for (int k = 0; k < ATTR_TEST_VAL_LEN; k++) {
+            attr_test_vals[i + 1][k] = i + k;
+        }
+        attr_test_vals[i + 2][0] = i & 1;
+        attr_test_vals[i + 2][1] = 0;
+        attr_test_db[i] = (esp_gatts_attr_db_t) {
+            { ESP_GATT_AUTO_RSP },
+            { ESP_UUID_LEN_16, (uint8_t *) &attr_test_char_uuid, ESP_GATT_PERM_READ,
+              1, 1, (uint8_t *) &attr_test_prop },
+        };
+        attr_test_db[i + 1] = (esp_gatts_attr_db_t) {
+            { (i % 2) ? ESP_GATT_AUTO_RSP : ESP_GATT_RSP_BY_APP },
+            { ESP_UUID_LEN_16, (uint8_t *) &attr_test_val_uuids[i + 1], ESP_GATT_PERM_READ,
+              ATTR_TEST_VAL_LEN, ATTR_TEST_VAL_LEN - (i % 5), attr_test_vals[i + 1] },
+        };
+        attr_test_db[i + 2] = (esp_gatts_attr_db_t) {
+            { ESP_GATT_AUTO_RSP },
+            { ESP_UUID_LEN_16, (uint8_t *) &attr_test_cccd_uuid,
+              ESP_GATT_PERM_READ | ESP_GATT_PERM_WRITE, 2, 2, attr_test_vals[i + 2] },
+        };
+    }
+}
+
+/* The same service, one attribute per request */
+static void
+attr_test_build_ref(int entries)
+{
+    esp_gatt_srvc_id_t srvc_id = { 0 };
+    esp_ble_gatts_cb_param_t *param;
+    uint16_t svc;
+
+    srvc_id.is_primary = true;
+    srvc_id.id.uuid.len = ESP_UUID_LEN_16;
+    srvc_id.id.uuid.uuid.uuid16 = attr_test_svc_uuid;
+    assert(esp_ble_gatts_create_service(attr_test_if, &srvc_id, entries) == ESP_OK);
+    param = attr_test_wait(ESP_GATTS_CREATE_EVT);
+    assert(param->create.status == ESP_GATT_OK);
+    svc = attr_test_ref_handles[0] = param->create.service_handle;
+
+    for (int i = 1; i + 2 < entries; i += 3) {
+        esp_attr_desc_t *val = &attr_test_db[i + 1].att_desc;
+        esp_attr_desc_t *cccd = &attr_test_db[i + 2].att_desc;
+        esp_bt_uuid_t uuid = { .len = ESP_UUID_LEN_16 };
+        esp_attr_value_t attr_val = { val->max_length, val->length, val->value };
+        esp_attr_value_t cccd_val = { cccd->max_length, cccd->length, cccd->value };
+
+        uuid.uuid.uuid16 = attr_test_val_uuids[i + 1];
+        assert(esp_ble_gatts_add_char(svc, &uuid, val->perm, attr_test_prop, &attr_val,
+                                      &attr_test_db[i + 1].attr_control) == ESP_OK);
+        param = attr_test_wait(ESP_GATTS_ADD_CHAR_EVT);
+        assert(param->add_char.status == ESP_GATT_OK);
+        attr_test_ref_handles[i] = param->add_char.attr_handle - 1;
+        attr_test_ref_handles[i + 1] = param->add_char.attr_handle;
+
+        uuid.uuid.uuid16 = attr_test_cccd_uuid;
+        assert(esp_ble_gatts_add_char_descr(svc, &uuid, cccd->perm, &cccd_val,
+                                            &attr_test_db[i + 2].attr_control) == ESP_OK);
+        param = attr_test_wait(ESP_GATTS_ADD_CHAR_DESCR_EVT);
+        assert(param->add_char_descr.status == ESP_GATT_OK);
+        attr_test_ref_handles[i + 2] = param->add_char_descr.attr_handle;
+    }
+}
+
+static void
+attr_test_delete(uint16_t svc)
+{
+    assert(esp_ble_gatts_delete_service(svc) == ESP_OK);
+    assert(attr_test_wait(ESP_GATTS_DELETE_EVT)->del.status == ESP_GATT_OK);
+}
+
+static void
+attr_test_read(uint16_t handle, uint16_t *len, uint8_t *buf)
+{
+    const uint8_t *value;
+
+    *len = 0;
+    if (esp_ble_gatts_get_attr_value(handle, len, &value) == ESP_GATT_OK && *len) {
+        memcpy(buf, value, *len);
+    }
+}
+
+/* Create the table once and check it against the per-attribute path */
+static unsigned long
+attr_test_check(int entries, unsigned long hash)
+{
+    uint8_t ref_val[ATTR_TEST_MAX_ENTRIES][ATTR_TEST_VAL_LEN];
+    uint16_t ref_len[ATTR_TEST_MAX_ENTRIES];
+    uint8_t val[ATTR_TEST_VAL_LEN];
+    uint16_t len;
+    esp_ble_gatts_cb_param_t *param;
+
+    attr_test_build_ref(entries);
+    for (int i = 1; i < entries; i++) {
+        if (attr_test_db[i].att_desc.uuid_p != &attr_test_char_uuid) {
+            attr_test_read(attr_test_ref_handles[i], &ref_len[i], ref_val[i]);
+        }
+    }
+    attr_test_delete(attr_test_ref_handles[0]);
+
+    assert(esp_ble_gatts_create_attr_tab(attr_test_db, attr_test_if, entries, 0) == ESP_OK);
+    param = attr_test_wait(ESP_GATTS_CREAT_ATTR_TAB_EVT);
+    assert(param->add_attr_tab.status == ESP_GATT_OK);
+    assert(param->add_attr_tab.num_handle == entries);
+    for (int i = 0; i < entries; i++) {
+        uint16_t off = attr_test_tab_handles[i] - attr_test_tab_handles[0];
+
+        assert(off == attr_test_ref_handles[i] - attr_test_ref_handles[0]);
+        hash = hash * 31 + off;
+        if (i > 0 && attr_test_db[i].att_desc.uuid_p != &attr_test_char_uuid) {
+            attr_test_read(attr_test_tab_handles[i], &len, val);
+            assert(len == ref_len[i] && !memcmp(val, ref_val[i], len));
+        }
+    }
+    attr_test_delete(attr_test_tab_handles[0]);
+    return hash;
+}
+
+static double
+attr_test_bench(int entries, int rounds)
+{
+    struct timespec start;
+    struct timespec end;
+    double ns = 0;
+
+    for (int r = 0; r < rounds; r++) {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        assert(esp_ble_gatts_create_attr_tab(attr_test_db, attr_test_if, entries, 0) == ESP_OK);
+        assert(attr_test_wait(ESP_GATTS_CREAT_ATTR_TAB_EVT)->add_attr_tab.status == ESP_GATT_OK);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        ns += (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+        attr_test_delete(attr_test_tab_handles[0]);
+    }
+    return ns / rounds;
+}
+
+int
+main(void)
+{
+    static const int sizes[] = { 10, 31, 100, 301 };
+    unsigned long hash = 0;
+    pthread_t btc;
+    pthread_t btu;
+
+    /* What gatt_init() sets up for the server, without L2CAP and the built-in services */
+    gatt_cb.p_clcb_list = list_new(osi_free_func);
+    gatt_cb.p_tcb_list = list_new(osi_free_func);
+    gatt_cb.srv_chg_clt_q = fixed_queue_new(QUEUE_SIZE_MAX);
+    gatt_cb.pending_new_srv_start_q = fixed_queue_new(QUEUE_SIZE_MAX);
+    gatt_cb.hdl_cfg.gatt_start_hdl = GATT_GATT_START_HANDLE;
+    gatt_cb.hdl_cfg.gap_start_hdl = GATT_GAP_START_HANDLE;
+    gatt_cb.hdl_cfg.app_start_hdl = GATT_APP_START_HANDLE;
+    pthread_create(&btc, NULL, attr_test_btc_thread, NULL);
+    pthread_create(&btu, NULL, attr_test_btu_thread, NULL);
+
+    assert(esp_ble_gatts_register_callback(attr_test_gatts_event) == ESP_OK);
+    assert(esp_ble_gatts_app_register(ATTR_TEST_APP_ID) == ESP_OK);
+    assert(attr_test_wait(ESP_GATTS_REG_EVT)->reg.status == ESP_GATT_OK);
+
+    for (int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        attr_test_build(sizes[s]);
+        hash = attr_test_check(sizes[s], hash);
+        printf("%3d entries: %.1f us/table\n", sizes[s],
+               attr_test_bench(sizes[s], 300000 / sizes[s]) / 1e3);
+    }
+    printf("handles match the per-attribute path, hash %016lx\n", hash);
+    return 0;
+}
@@ -0,0 +1,11 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+
+/* Host stand-in for esp_log.h */
+#pragma once
+
+#define ESP_LOGE(tag, ...) do {} while (0)
+#define ESP_LOGD(tag, ...) do {} while (0)
@@ -0,0 +1,274 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+
+/*
+ * Host harness for the TX batching of the UART DMA HCI driver
+ * (porting/transport/driver/common/hci_driver_util.c).
+ *
+ * A producer queues a random mix of LE meta events and ACL packets held in
+ * chains of 64-byte mbufs, and a simulated DMA engine takes batches with
+ * hci_driver_util_tx_list_batch() the way hci_driver_uart_dma_tx_start()
+ * does: one descriptor is held by RX and one more is kept back, the rest
+ * bound the number of segments.  Every batch is "sent" by copying its
+ * segments to a wire buffer, which must match the queued packets byte for
+ * byte.  With few descriptors, ACL packets have more segments than a batch
+ * can hold and are sent over several batches.
+ *
+ * The number of DMA starts is printed next to the number of packets, which
+ * is what the driver started before packets were batched.  Command complete
+ * and status priority, the segment limit and freeing on deinit, including a
+ * packet split over batches, are checked as well.
+ *
+ * Build from components/bt:
+ *
+ *   H=test_apps/host/hci_uart_dma
+ *   T=porting/transport
+ *   N=host/nimble/nimble
+ *   gcc -O2 -D_GNU_SOURCE -I$H/stub -I$T/include \
+ *       -I$N/porting/nimble/include -I$N/porting/npl/linux/include \
+ *       -I$N/porting/examples/linux/include -I$N/nimble/include \
+ *       -include stdbool.h -include stdlib.h -include assert.h \
+ *       -D'STAILQ_LAST(h, t, f)=NULL' \
+ *       -DCONFIG_BT_LE_ACL_BUF_COUNT=40 \
+ *       -DCONFIG_BT_LE_HCI_EVT_HI_BUF_COUNT=20 \
+ *       -DCONFIG_BT_LE_HCI_EVT_LO_BUF_COUNT=20 \
+ *       $H/tx_batch_test.c $T/driver/common/hci_driver_util.c \
+ *       $N/porting/nimble/src/os_mbuf.c $N/porting/nimble/src/os_mempool.c \
+ *       -lpthread -o tx_batch_test
+ *   ./tx_batch_test 20
+ *
+ * The argument is the size of the descriptor pool
+ * (CONFIG_BT_LE_HCI_LLDESCS_POOL_NUM), at least 3.  glibc's sys/queue.h
+ * lacks STAILQ_LAST, which only the unused msys code needs.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include "os/os.h"
+#include "os/os_mbuf.h"
+#include "os/os_mempool.h"
+#include "nimble/nimble_npl.h"
+#include "esp_hci_driver.h"
+#include "common/hci_driver_util.h"
+
+#define TX_TEST_MBUFS           64
+#define TX_TEST_MBUF_DATA       64
+#define TX_TEST_MBUF_SIZE       (TX_TEST_MBUF_DATA + sizeof(struct os_mbuf) + \
+                                 sizeof(struct os_mbuf_pkthdr))
+#define TX_TEST_MAX_DESCS       64
+#define TX_TEST_BYTES           (1 << 21)
+
+static os_membuf_t tx_test_mbuf_mem[OS_MEMPOOL_SIZE(TX_TEST_MBUFS, TX_TEST_MBUF_SIZE)];
+static struct os_mempool tx_test_mbuf_mempool;
+static struct os_mbuf_pool tx_test_mbuf_pool;
+static pthread_mutex_t tx_test_crit = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+
+/* Descriptors of the chain being built, and the free ones */
+static struct {
+    const uint8_t *buf;
+    uint32_t len;
+} tx_test_chain[TX_TEST_MAX_DESCS];
+static int tx_test_nchain;
+static int tx_test_desc_free;
+
+static int tx_test_evt_live;
+static uint8_t tx_test_wire[TX_TEST_BYTES + 1024];
+static size_t tx_test_wire_len;
+static uint8_t tx_test_expect[TX_TEST_BYTES + 1024];
+static size_t tx_test_expect_len;
+
+/* Rest of the stack */
+uint32_t ble_npl_hw_enter_critical(void)
+{
+    pthread_mutex_lock(&tx_test_crit);
+    return 0;
+}
+
+void ble_npl_hw_exit_critical(uint32_t ctx)
+{
+    pthread_mutex_unlock(&tx_test_crit);
+}
+
+void ble_npl_event_init(struct ble_npl_event *ev, ble_npl_event_fn *fn, void *arg) {}
+void ble_npl_eventq_put(struct ble_npl_eventq *evq, struct ble_npl_event *ev) {}
+
+void
+r_ble_hci_trans_buf_free(uint8_t *buf)
+{
+    tx_test_evt_live--;
+    free(buf);
+}
+
+static void
+tx_test_seg(const uint8_t *data, uint32_t len, void *arg)
+{
+    assert(tx_test_desc_free > 0);
+    tx_test_desc_free--;
+    tx_test_chain[tx_test_nchain].buf = data;
+    tx_test_chain[tx_test_nchain].len = len;
+    tx_test_nchain++;
+}
+
+/* Starts one DMA transfer if there is anything to send, and completes it.
+ * Returns the number of packets completed, or -1 if nothing was sent */
+static int
+tx_test_dma(int max_segs)
+{
+    uint32_t pkts;
+
+    tx_test_nchain = 0;
+    pkts = hci_driver_util_tx_list_batch(max_segs, tx_test_seg, NULL);
+    if (!tx_test_nchain) {
+        assert(pkts == 0);
+        return -1;
+    }
+    for (int i = 0; i < tx_test_nchain; i++) {
+        memcpy(tx_test_wire + tx_test_wire_len, tx_test_chain[i].buf, tx_test_chain[i].len);
+        tx_test_wire_len += tx_test_chain[i].len;
+    }
+    tx_test_desc_free += tx_test_nchain;
+    return pkts;
+}
+
+static uint8_t *
+tx_test_evt(const char *data, int len)
+{
+    uint8_t *evt = malloc(len);
+
+    memcpy(evt, data, len);
+    tx_test_evt_live++;
+    return evt;
+}
+
+static void
+tx_test_enqueue_acl(int len, uint8_t *seq)
+{
+    uint8_t buf[256];
+    struct os_mbuf *om;
+
+    om = os_mbuf_get_pkthdr(&tx_test_mbuf_pool, 0);
+    if (!om) {
+        return;
+    }
+    for (int i = 0; i < len; i++) {
+        buf[i] = (*seq)++;
+    }
+    if (os_mbuf_append(om, buf, len)) {
+        os_mbuf_free_chain(om);
+        return;
+    }
+    hci_driver_util_tx_list_enqueue(HCI_DRIVER_TYPE_ACL, (uint8_t *)om, OS_MBUF_PKTLEN(om));
+    tx_test_expect[tx_test_expect_len++] = HCI_DRIVER_TYPE_ACL;
+    memcpy(tx_test_expect + tx_test_expect_len, buf, len);
+    tx_test_expect_len += len;
+}
+
+static void
+tx_test_enqueue_evt(int len, uint8_t *seq)
+{
+    uint8_t *evt = malloc(len);
+
+    tx_test_evt_live++;
+    evt[0] = 0x3e;
+    evt[1] = len - 2;
+    for (int i = 2; i < len; i++) {
+        evt[i] = (*seq)++;
+    }
+    /* Not a command complete or status, so queued in order */
+    hci_driver_util_tx_list_enqueue(HCI_DRIVER_TYPE_EVT, evt, len);
+    tx_test_expect[tx_test_expect_len++] = HCI_DRIVER_TYPE_EVT;
+    memcpy(tx_test_expect + tx_test_expect_len, evt, len);
+    tx_test_expect_len += len;
+}
+
+int
+main(int argc, char **argv)
+{
+    int descs = argc > 1 ? atoi(argv[1]) : 20;
+    int max_segs = descs - 2;
+    long starts = 0;
+    long queued = 0;
+    long pkts = 0;
+    uint8_t seq = 0;
+    int ret;
+
+    assert(descs >= 3 && descs <= TX_TEST_MAX_DESCS);
+    os_mempool_init(&tx_test_mbuf_mempool, TX_TEST_MBUFS, TX_TEST_MBUF_SIZE, tx_test_mbuf_mem,
+                    "tx_test_mbuf");
+    os_mbuf_pool_init(&tx_test_mbuf_pool, &tx_test_mbuf_mempool, TX_TEST_MBUF_SIZE,
+                      TX_TEST_MBUFS);
+    hci_driver_util_init();
+    srand(1);
+
+    /* One descriptor is held by RX, and the driver keeps one more back */
+    tx_test_desc_free = descs - 1;
+    while (tx_test_expect_len < TX_TEST_BYTES) {
+        /* Bounded by the TX entries, as the controller is by its buffers */
+        for (int n = rand() % 4; n > 0 && queued < 32; n--, queued++) {
+            if (rand() % 3 == 0) {
+                tx_test_enqueue_evt(3 + rand() % 60, &seq);
+            } else {
+                tx_test_enqueue_acl(4 + rand() % 180, &seq);
+            }
+        }
+        if ((ret = tx_test_dma(max_segs)) >= 0) {
+            starts++;
+            pkts += ret;
+            queued -= ret;
+        }
+    }
+    while ((ret = tx_test_dma(max_segs)) >= 0) {
+        starts++;
+        pkts += ret;
+    }
+    assert(tx_test_wire_len == tx_test_expect_len);
+    assert(!memcmp(tx_test_wire, tx_test_expect, tx_test_wire_len));
+    assert(tx_test_evt_live == 0 && tx_test_mbuf_mempool.mp_num_free == TX_TEST_MBUFS);
+    printf("%d descriptors: %ld packets, %zu bytes, %ld DMA starts\n",
+           descs, pkts, tx_test_wire_len, starts);
+
+    /* The budgets below are given explicitly */
+    tx_test_desc_free = TX_TEST_MAX_DESCS;
+
+    /* A command complete queued behind an event leads the next batch */
+    tx_test_wire_len = 0;
+    hci_driver_util_tx_list_enqueue(HCI_DRIVER_TYPE_EVT, tx_test_evt("\x3e\x02\xaa\xbb", 4), 4);
+    hci_driver_util_tx_list_enqueue(HCI_DRIVER_TYPE_EVT, tx_test_evt("\x0e\x03\x01\x02\x03", 5), 5);
+    assert(tx_test_dma(4) == 2);
+    assert(tx_test_chain[1].buf[0] == 0x0e && tx_test_chain[3].buf[0] == 0x3e);
+
+    /* Whole packets only while the batch holds one, an event takes two
+     * segments */
+    hci_driver_util_tx_list_enqueue(HCI_DRIVER_TYPE_EVT, tx_test_evt("\x3e\x02\xaa\xbb", 4), 4);
+    hci_driver_util_tx_list_enqueue(HCI_DRIVER_TYPE_EVT, tx_test_evt("\x3e\x02\xcc\xdd", 4), 4);
+    assert(tx_test_dma(3) == 1 && tx_test_nchain == 2);
+    assert(tx_test_dma(3) == 1 && tx_test_nchain == 2);
+
+    /* A packet larger than a batch is split, the batches before the last
+     * one complete no packet */
+    tx_test_wire_len = 0;
+    tx_test_expect_len = 0;
+    tx_test_enqueue_acl(200, &seq);
+    assert(tx_test_dma(1) == 0 && tx_test_nchain == 1);
+    assert(tx_test_dma(2) == 0 && tx_test_nchain == 2);
+    assert(tx_test_dma(8) == 1 && tx_test_nchain == 1);
+    assert(tx_test_wire_len == tx_test_expect_len);
+    assert(!memcmp(tx_test_wire, tx_test_expect, tx_test_wire_len));
+    assert(tx_test_dma(8) == -1);
+
+    /* Buffers still queued, sent, or in the middle of a split packet are
+     * freed on deinit */
+    hci_driver_util_tx_list_enqueue(HCI_DRIVER_TYPE_EVT, tx_test_evt("\x3e\x02\xaa\xbb", 4), 4);
+    tx_test_enqueue_acl(200, &seq);
+    tx_test_enqueue_evt(10, &seq);
+    assert(tx_test_dma(3) == 1);
+    assert(tx_test_dma(2) == 0);
+    hci_driver_util_deinit();
+    assert(tx_test_evt_live == 0 && tx_test_mbuf_mempool.mp_num_free == TX_TEST_MBUFS);
+    printf("priority, limit, split and deinit ok\n");
+    return 0;
+}
@@ -0,0 +1,209 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+
+/*
+ * Host replay benchmark for Bluedroid inquiry result handling
+ * (stack/btm/btm_inq.c).
+ *
+ * Extended Inquiry Result events from a number of devices are replayed
+ * through btm_process_inq_results().  Every device answers about four times
+ * per inquiry, in random order, with an EIR holding flags, a name, 16-bit
+ * and 128-bit UUID lists, TX power and manufacturer data.  After each
+ * inquiry the application reads every device back with BTM_InqDbRead().
+ *
+ * The time per result is printed along with the number of result callbacks
+ * and a hash of their content, which must not change between versions of
+ * btm_inq.c for the same arguments and BTM_INQ_DB_SIZE.
+ *
+ * btm_inq.c is included directly to reach its static functions.  Build from
+ * components/bt:
+ *
+ *   H=test_apps/host
+ *   S=host/bluedroid/stack
+ *   gcc -O2 -std=gnu11 -w -ffunction-sections -Wl,--gc-sections \
+ *       -DBTM_INQ_DB_SIZE=64 \
+ *       -I$H/bluedroid_stub -include host_defs.h -I$S/btm \
+ *       -Icommon/include -Icommon/osi/include -Icommon/api/include/api \
+ *       -Icommon/btc/include -Icommon/bt_stats/include \
+ *       -Ihost/bluedroid/common/include -I$S/include -I$S/btm/include \
+ *       -Ihost/bluedroid/bta/include -Ihost/bluedroid/btc/include \
+ *       -Ihost/bluedroid/device/include -Ihost/bluedroid/hci/include \
+ *       -Ihost/bluedroid/api/include/api -I../log/include \
+ *       $H/inquiry/inq_replay_bench.c -o inq_replay_bench
+ *   ./inq_replay_bench 300 200
+ *
+ * The arguments are the number of devices and of inquiries.  Section GC
+ * drops the parts of btm_inq.c that are not reached, and the HCI and BTU
+ * functions they call.  Build the same way against the parent tree for a
+ * baseline.
+ */
+
+#include <stdlib.h>
+#include <time.h>
+#include "btm_inq.c"
+
+tBTM_CB btm_cb;
+
+static controller_t inq_test_controller;
+static unsigned long inq_test_cb_count;
+static unsigned long inq_test_cb_hash;
+
+/* Rest of the stack */
+static BOOLEAN
+inq_test_true(void)
+{
+    return TRUE;
+}
+
+const controller_t *
+controller_get_interface(void)
+{
+    return &inq_test_controller;
+}
+
+BOOLEAN btsnd_hcic_inq_cancel(void) { return TRUE; }
+BOOLEAN btsnd_hcic_inquiry(const LAP inq_lap, UINT8 duration, UINT8 response_cnt) { return TRUE; }
+void btm_acl_update_busy_level(tBTM_BLI_EVENT event) {}
+void btm_ble_stop_inquiry(void) {}
+void btm_clear_all_pending_le_entry(void) {}
+tBTM_STATUS BTM_BleObserve(BOOLEAN start, UINT32 duration, tBTM_INQ_RESULTS_CB *p_results_cb,
+                           tBTM_CMPL_CB *p_cmpl_cb) { return BTM_SUCCESS; }
+void *osi_malloc_func(size_t size) { return malloc(size); }
+void *osi_calloc_func(size_t size) { return calloc(1, size); }
+void osi_free_func(void *ptr) { free(ptr); }
+
+UINT32
+osi_time_get_os_boottime_ms(void)
+{
+    static UINT32 ms;
+
+    return ++ms;
+}
+
+static void
+inq_test_results_cb(tBTM_INQ_RESULTS *p_inq_results, UINT8 *p_eir)
+{
+    int i;
+
+    inq_test_cb_count++;
+    for (i = 0; i < BD_ADDR_LEN; i++) {
+        inq_test_cb_hash = inq_test_cb_hash * 31 + p_inq_results->remote_bd_addr[i];
+    }
+    for (i = 0; i < BTM_EIR_SERVICE_ARRAY_SIZE; i++) {
+        inq_test_cb_hash = inq_test_cb_hash * 31 + p_inq_results->eir_uuid[i];
+    }
+    inq_test_cb_hash = inq_test_cb_hash * 31 + p_inq_results->eir_complete_list +
+                       (UINT8)p_inq_results->rssi;
+}
+
+/* One Extended Inquiry Result event: num_resp, bda, page scan repetition
+ * mode, reserved, class of device, clock offset, RSSI and EIR */
+static UINT8 inq_test_evt[1 + BD_ADDR_LEN + 1 + 1 + DEV_CLASS_LEN + 2 + 1 +
+                          HCI_EXT_INQ_RESPONSE_LEN];
+
+static void
+inq_test_build(unsigned dev, int rssi)
+{
+    static const UINT16 uuid16[] = { 0x110a, 0x110c, 0x111f, 0x1132 };
+    static const UINT8 uuid128[LEN_UUID_128] = {
+        0xfb, 0x34, 0x9b, 0x5f, 0x80, 0x00, 0x00, 0x80,
+        0x00, 0x10, 0x00, 0x00, 0x1e, 0x11, 0x00, 0x00,
+    };
+    UINT8 *p = inq_test_evt;
+    int i;
+
+    memset(inq_test_evt, 0, sizeof(inq_test_evt));
+    *p++ = 1;
+    *p++ = dev;
+    *p++ = dev >> 8;
+    *p++ = 0x5a;
+    *p++ = 0x11;
+    *p++ = 0x22;
+    *p++ = 0x33;
+    *p++ = 1;                   /* page scan repetition mode */
+    *p++ = 0;
+    *p++ = 0x0c;                /* class of device */
+    *p++ = 0x02;
+    *p++ = 0x5a;
+    *p++ = 0x34;                /* clock offset */
+    *p++ = 0x12;
+    *p++ = (UINT8)rssi;
+
+    *p++ = 2;
+    *p++ = BTM_EIR_FLAGS_TYPE;
+    *p++ = 0x06;
+    *p++ = 1 + 13;
+    *p++ = BTM_EIR_COMPLETE_LOCAL_NAME_TYPE;
+    memcpy(p, "Phone of user", 13);
+    p += 13;
+    /* half of the devices send a partial list */
+    *p++ = 1 + 2 * 4;
+    *p++ = (dev & 1) ? BTM_EIR_COMPLETE_16BITS_UUID_TYPE : BTM_EIR_MORE_16BITS_UUID_TYPE;
+    for (i = 0; i < 4; i++) {
+        UINT16_TO_STREAM(p, uuid16[i]);
+    }
+    *p++ = 1 + LEN_UUID_128;
+    *p++ = BTM_EIR_COMPLETE_128BITS_UUID_TYPE;
+    memcpy(p, uuid128, LEN_UUID_128);
+    p += LEN_UUID_128;
+    *p++ = 2;
+    *p++ = BTM_EIR_TX_POWER_LEVEL_TYPE;
+    *p++ = 4;
+    *p++ = 1 + 20;
+    *p++ = BTM_EIR_MANUFACTURER_SPECIFIC_TYPE;
+    memset(p, dev, 20);
+}
+
+int
+main(int argc, char **argv)
+{
+    tBTM_INQUIRY_VAR_ST *p_inq = &btm_cb.btm_inq_vars;
+    unsigned devices = argc > 1 ? atoi(argv[1]) : 300;
+    unsigned rounds = argc > 2 ? atoi(argv[2]) : 200;
+    unsigned long events = 0;
+    struct timespec start;
+    struct timespec end;
+    unsigned r;
+    unsigned k;
+    double ns;
+
+    inq_test_controller.supports_rssi_with_inquiry_results = inq_test_true;
+    srand(1);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (r = 0; r < rounds; r++) {
+        p_inq->inq_active = BTM_GENERAL_INQUIRY_ACTIVE;
+        p_inq->inqparms.max_resps = 0;
+        p_inq->inqparms.mode = BTM_GENERAL_INQUIRY;
+        p_inq->inqparms.report_dup = TRUE;
+        p_inq->p_inq_results_cb = inq_test_results_cb;
+        p_inq->inq_cmpl_info.num_resp = 0;
+        btm_initiate_inquiry(p_inq);
+        p_inq->inqparms.max_resps = 0;
+
+        for (k = 0; k < devices * 4; k++) {
+            inq_test_build(rand() % devices, -40 - rand() % 50);
+            btm_process_inq_results(inq_test_evt, BTM_INQ_RESULT_EXTENDED);
+            events++;
+        }
+
+        p_inq->inqparms.mode = 0;
+        btm_process_inq_complete(HCI_SUCCESS, BTM_GENERAL_INQUIRY);
+
+        for (k = 0; k < devices; k++) {
+            BD_ADDR bda = { k, k >> 8, 0x5a, 0x11, 0x22, 0x33 };
+            if (BTM_InqDbRead(bda)) {
+                inq_test_cb_hash += k;
+            }
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    ns = ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / events;
+    printf("db %d devices %u: %.0f ns/result, callbacks %lu, hash %016lx\n",
+           BTM_INQ_DB_SIZE, devices, ns, inq_test_cb_count, inq_test_cb_hash);
+    return 0;
+}
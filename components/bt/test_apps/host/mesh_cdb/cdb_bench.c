@@ -0,0 +1,102 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+
+/*
+ * Host benchmark for the NimBLE mesh configuration database
+ * (nimble/host/mesh/src/cdb.c).
+ *
+ * A provisioner allocates nodes of one to three elements at the lowest
+ * free address.  Every seventh allocation deletes a random earlier node,
+ * so that later allocations have to find the gaps.  Every node is then
+ * queued for storing and the pending updates are flushed.
+ *
+ * The time for the whole run is printed along with a hash of the final
+ * address layout, which must not change between versions of cdb.c for the
+ * same number of nodes.
+ *
+ * Build from components/bt/host/nimble/nimble:
+ *
+ *   H=../../../test_apps/host/mesh_cdb
+ *   M=nimble/host/mesh
+ *   gcc -O2 -w -I$H/stub -include esp_err.h \
+ *       -Iporting/examples/linux_blemesh/include \
+ *       -Inimble/include -Inimble/host/include -I$M/include -I$M/src \
+ *       -Inimble/host/src -Iporting/npl/linux/include \
+ *       -Iporting/nimble/include -Inimble/transport/include \
+ *       -Iext/tinycrypt/include \
+ *       -DMYNEWT_VAL_BLE_MESH_CDB=1 -DMYNEWT_VAL_BLE_MESH_SETTINGS=0 \
+ *       -DMYNEWT_VAL_BLE_MESH_CDB_NODE_COUNT=10000 \
+ *       -DMYNEWT_VAL_BLE_MESH_CDB_SUBNET_COUNT=4 \
+ *       -DMYNEWT_VAL_BLE_MESH_CDB_APP_KEY_COUNT=4 -DCONFIG_BT_SETTINGS=1 \
+ *       $H/cdb_bench.c $M/src/cdb.c -o cdb_bench
+ *   ./cdb_bench 9000
+ *
+ * The argument is the number of nodes allocated, at most the node count
+ * above.  Settings are compiled in so that the pending update queues are
+ * exercised, but nothing is written.  Build the same way against the
+ * parent tree for a baseline.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "mesh/mesh.h"
+#include "mesh/cdb.h"
+#include "settings.h"
+
+#define CDB_BENCH_MAX_NODES     MYNEWT_VAL_BLE_MESH_CDB_NODE_COUNT
+#define CDB_BENCH_DEL_EVERY     7
+
+/* Rest of the stack */
+void bt_mesh_settings_store_schedule(enum bt_mesh_settings_flag flag) {}
+
+int
+main(int argc, char **argv)
+{
+    static uint16_t addrs[CDB_BENCH_MAX_NODES];
+    unsigned nodes = argc > 1 ? atoi(argv[1]) : 9000;
+    uint8_t uuid[16] = { 0 };
+    struct bt_mesh_cdb_node *node;
+    struct timespec start;
+    struct timespec end;
+    unsigned long hash = 0;
+    unsigned i;
+
+    if (nodes > CDB_BENCH_MAX_NODES) {
+        nodes = CDB_BENCH_MAX_NODES;
+    }
+    srand(1);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < nodes; i++) {
+        node = bt_mesh_cdb_node_alloc(uuid, 0, 1 + rand() % 3, 0);
+        if (!node) {
+            printf("allocation %u failed\n", i);
+            return 1;
+        }
+        addrs[i] = node->addr;
+        if (i % CDB_BENCH_DEL_EVERY == CDB_BENCH_DEL_EVERY / 2) {
+            node = bt_mesh_cdb_node_get(addrs[rand() % (i + 1)]);
+            if (node) {
+                bt_mesh_cdb_node_del(node, true);
+            }
+        }
+    }
+    for (i = 0; i < nodes; i++) {
+        node = bt_mesh_cdb_node_get(addrs[i]);
+        bt_mesh_cdb_node_store(node ? node : &bt_mesh_cdb.nodes[0]);
+    }
+    bt_mesh_cdb_pending_store();
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    for (i = 1; i < 0x8000; i++) {
+        node = bt_mesh_cdb_node_get(i);
+        hash = hash * 31 + (node ? node->addr * 7 + node->num_elem : 0);
+    }
+    printf("%u nodes: %.3f ms, layout hash %016lx\n", nodes,
+           (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) / 1e6, hash);
+    return 0;
+}
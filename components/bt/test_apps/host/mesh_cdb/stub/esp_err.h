@@ -0,0 +1,13 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+
+/* Host stand-in for esp_err.h */
+#pragma once
+
+typedef int esp_err_t;
+
+#define ESP_OK      0
+#define ESP_FAIL    -1
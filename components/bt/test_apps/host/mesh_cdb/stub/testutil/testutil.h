@@ -0,0 +1,18 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+
+/* Host stand-in for the Mynewt test utilities */
+#pragma once
+
+#include <assert.h>
+
+#define TEST_ASSERT(x)              assert(x)
+#define TEST_ASSERT_FATAL(x, ...)   assert(x)
+#define TEST_CASE_SELF(n)           void n(void)
+#define TEST_CASE_DECL(n)           void n(void);
+#define TEST_SUITE(n)               void n(void)
+#define TEST_SUITE_DECL(n)          void n(void);
+#define TEST_CASE_TASK(n)           void n(void)
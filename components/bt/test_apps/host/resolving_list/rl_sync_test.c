@@ -0,0 +1,403 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+
+/*
+ * Host harness for the Bluedroid resolving list sync
+ * (stack/btm/btm_ble_privacy.c).
+ *
+ * btm_ble_privacy.c is built against a fake controller with eight resolving
+ * list slots, which counts the add and remove commands it is sent and the
+ * times scanning, initiating and advertising are suspended and resumed.
+ *
+ * - Ten bonds are restored at start up: eight are written in one suspend
+ *   window, the last two are reported as not fitting.
+ * - Three devices are unpaired before the sync runs. One of them is paired
+ *   again and the record of another is freed.
+ * - A device paired at run time is written at once, without the sync delay.
+ * - A device whose add command fails is left out of the list and of the
+ *   host copy of it, and is retried by the next sync.
+ * - So is a device whose add the controller completes with an error, and
+ *   with the vendor specific commands its IRK index is given back.
+ *
+ * Build from components/bt:
+ *
+ *   H=test_apps/host
+ *   S=host/bluedroid/stack
+ *   gcc -g -std=gnu11 -w -fsanitize=address,undefined \
+ *       -DCONFIG_BT_BLE_RPA_SUPPORTED=1 \
+ *       -I$H/bluedroid_stub -include host_defs.h \
+ *       -Icommon/include -Icommon/osi/include -Icommon/api/include/api \
+ *       -Icommon/btc/include -Icommon/bt_stats/include \
+ *       -Ihost/bluedroid/common/include -I$S/include -I$S/btm/include \
+ *       -Ihost/bluedroid/bta/include -Ihost/bluedroid/btc/include \
+ *       -Ihost/bluedroid/device/include -Ihost/bluedroid/hci/include \
+ *       -Ihost/bluedroid/api/include/api -I../log/include \
+ *       $H/resolving_list/rl_sync_test.c $S/btm/btm_ble_privacy.c \
+ *       common/osi/list.c -o rl_sync_test
+ *   ./rl_sync_test && ./rl_sync_test vsc
+ *
+ * "vsc" runs against a controller that only has the vendor specific IRK
+ * commands.  Without -DCONFIG_BT_BLE_RPA_SUPPORTED=1 only "vsc" applies.
+ *
+ * For a baseline, build with -DRL_TEST_BASELINE against the parent tree,
+ * where devices are written as they are loaded: only the command and
+ * suspend counts are printed.
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include "common/bt_target.h"
+#include "stack/bt_types.h"
+#include "stack/hcimsgs.h"
+#include "stack/btu.h"
+#include "btm_int.h"
+#include "device/controller.h"
+#include "osi/list.h"
+
+#define RL_TEST_SLOTS       8
+#define RL_TEST_BONDS       10
+
+#ifdef RL_TEST_BASELINE
+#define RL_TEST_LOAD(p_dev_rec, batch)  btm_ble_resolving_list_load_dev(p_dev_rec)
+#else
+#define RL_TEST_LOAD(p_dev_rec, batch)  btm_ble_resolving_list_load_dev(p_dev_rec, batch)
+#endif
+
+tBTM_CB btm_cb;
+
+static int rl_test_adds;
+static int rl_test_removes;
+static int rl_test_timers;
+static int rl_test_suspends;
+static int rl_test_resumes;
+static int rl_test_fail_id = -1;
+static UINT8 rl_test_max_size = RL_TEST_SLOTS;
+static BOOLEAN rl_test_privacy_12 = TRUE;
+static controller_t rl_test_controller;
+
+/* Fake controller */
+static UINT8
+rl_test_get_max_size(void)
+{
+    return rl_test_max_size;
+}
+
+static void
+rl_test_set_max_size(UINT8 size)
+{
+    rl_test_max_size = size;
+}
+
+static BOOLEAN
+rl_test_supports_privacy(void)
+{
+    return rl_test_privacy_12;
+}
+
+const controller_t *
+controller_get_interface(void)
+{
+    return &rl_test_controller;
+}
+
+BOOLEAN
+btsnd_hcic_ble_add_device_resolving_list(UINT8 addr_type, BD_ADDR bda,
+                                         UINT8 *irk_peer, UINT8 *irk_local)
+{
+    if (bda[5] == rl_test_fail_id) {
+        return FALSE;
+    }
+    rl_test_adds++;
+    return TRUE;
+}
+
+BOOLEAN
+btsnd_hcic_ble_rm_device_resolving_list(UINT8 addr_type, BD_ADDR bda)
+{
+    rl_test_removes++;
+    return TRUE;
+}
+
+BOOLEAN
+btsnd_hcic_ble_clear_resolving_list(void)
+{
+    return TRUE;
+}
+
+BOOLEAN
+btsnd_hcic_ble_read_resolvable_addr_peer(UINT8 addr_type, BD_ADDR bda)
+{
+    return TRUE;
+}
+
+tBTM_STATUS
+BTM_VendorSpecificCommand(UINT16 opcode, UINT8 param_len, UINT8 *p_param,
+                          tBTM_VSC_CMPL_CB *p_cb)
+{
+    /* sub-opcode, then the IRK for an add, then address type and address */
+    if (p_param[0] == 0x02) {
+        if (p_param[1 + BT_OCTET16_LEN + 1] == rl_test_fail_id) {
+            return BTM_NO_RESOURCES;
+        }
+        rl_test_adds++;
+    } else if (p_param[0] == 0x03) {
+        rl_test_removes++;
+    }
+    return BTM_CMD_STARTED;
+}
+
+/* Rest of the stack */
+void
+btu_start_timer_oneshot(TIMER_LIST_ENT *p_tle, UINT16 type, UINT32 timeout)
+{
+    p_tle->in_use = TRUE;
+    rl_test_timers++;
+}
+
+void
+btu_stop_timer_oneshot(TIMER_LIST_ENT *p_tle)
+{
+    p_tle->in_use = FALSE;
+}
+
+tBTM_SEC_DEV_REC *
+btm_find_dev(BD_ADDR bd_addr)
+{
+    list_node_t *p_node;
+
+    for (p_node = list_begin(btm_cb.p_sec_dev_rec_list); p_node;
+         p_node = list_next(p_node)) {
+        tBTM_SEC_DEV_REC *p_dev_rec = list_node(p_node);
+        if (!memcmp(p_dev_rec->bd_addr, bd_addr, BD_ADDR_LEN)) {
+            return p_dev_rec;
+        }
+    }
+    return NULL;
+}
+
+tBTM_BLE_CONN_ST btm_ble_get_conn_st(void) { return BLE_CONN_IDLE; }
+tBTM_STATUS btm_ble_stop_adv(void) { return BTM_SUCCESS; }
+tBTM_STATUS btm_ble_start_adv(void) { return BTM_SUCCESS; }
+void btm_ble_stop_scan(void) {}
+tBTM_STATUS btm_ble_start_scan(void) { return BTM_SUCCESS; }
+void btm_ble_refresh_peer_resolvable_private_addr(BD_ADDR pseudo_bda,
+                                                  BD_ADDR rpa, UINT8 rra_type) {}
+
+BOOLEAN
+btm_ble_suspend_bg_conn(void)
+{
+    rl_test_suspends++;
+    return TRUE;
+}
+
+BOOLEAN
+btm_ble_resume_bg_conn(void)
+{
+    rl_test_resumes++;
+    return TRUE;
+}
+
+void *osi_malloc_func(size_t size) { return malloc(size); }
+void *osi_calloc_func(size_t size) { return calloc(1, size); }
+void osi_free_func(void *ptr) { free(ptr); }
+
+static tBTM_SEC_DEV_REC *
+rl_test_dev(int id, BOOLEAN bonded)
+{
+    tBTM_SEC_DEV_REC *p_dev_rec = calloc(1, sizeof(*p_dev_rec));
+
+    p_dev_rec->bd_addr[5] = id;
+    memcpy(p_dev_rec->ble.static_addr, p_dev_rec->bd_addr, BD_ADDR_LEN);
+    p_dev_rec->sec_flags = BTM_SEC_IN_USE;
+    if (bonded) {
+        p_dev_rec->ble.key_type = BTM_LE_KEY_PID;
+    }
+    list_append(btm_cb.p_sec_dev_rec_list, p_dev_rec);
+    return p_dev_rec;
+}
+
+static BOOLEAN
+rl_test_in_list(tBTM_SEC_DEV_REC *p_dev_rec)
+{
+    return (p_dev_rec->ble.in_controller_list & BTM_RESOLVING_LIST_BIT) != 0;
+}
+
+static BOOLEAN
+rl_test_irk_index_used(UINT8 index)
+{
+    return (btm_cb.ble_ctr_cb.irk_list_mask[index / 8] >> (index % 8)) & 1;
+}
+
+/* Complete the oldest pending add, for the device given */
+static void
+rl_test_complete_add(UINT8 status, tBTM_SEC_DEV_REC *p_dev_rec)
+{
+    /* status, then with the vendor specific command its sub-opcode and the room left */
+    UINT8 evt[3] = { status, 0x02, RL_TEST_SLOTS };
+    UINT8 index = p_dev_rec->ble.resolving_list_index;
+
+    assert(rl_test_privacy_12 || rl_test_irk_index_used(index));
+    btm_ble_add_resolving_list_entry_complete(evt, rl_test_privacy_12 ? 1 : sizeof(evt));
+    if (!rl_test_privacy_12 && status != HCI_SUCCESS) {
+        assert(!rl_test_irk_index_used(index) && p_dev_rec->ble.resolving_list_index == 0);
+    }
+}
+
+static void
+rl_test_print(const char *step)
+{
+    printf("%-8s add %d remove %d suspend %d resume %d\n", step, rl_test_adds,
+           rl_test_removes, rl_test_suspends, rl_test_resumes);
+}
+
+int
+main(int argc, char **argv)
+{
+    tBTM_SEC_DEV_REC *d[RL_TEST_BONDS + 3];
+    UINT8 clear_evt[3] = { HCI_SUCCESS, 0x01 };
+    BD_ADDR bda;
+    int i;
+    int j;
+
+    rl_test_controller.get_ble_resolving_list_max_size = rl_test_get_max_size;
+    rl_test_controller.set_ble_resolving_list_max_size = rl_test_set_max_size;
+    rl_test_controller.supports_ble_privacy = rl_test_supports_privacy;
+    rl_test_privacy_12 = argc > 1 ? FALSE : TRUE;
+
+    btm_cb.p_sec_dev_rec_list = list_new(NULL);
+    btm_ble_resolving_list_init(RL_TEST_SLOTS);
+    /* The controller reports the list cleared, which frees every IRK index */
+    clear_evt[2] = RL_TEST_SLOTS;
+    btm_ble_clear_resolving_list_complete(clear_evt, rl_test_privacy_12 ? 1 : sizeof(clear_evt));
+    btm_cb.ble_ctr_cb.resolving_list_avail_size = RL_TEST_SLOTS;
+    btm_cb.ble_ctr_cb.rl_state = BTM_BLE_RL_SCAN;
+
+    /* Bonds restored at start up */
+    for (i = 0; i < RL_TEST_BONDS; i++) {
+        d[i] = rl_test_dev(i, TRUE);
+        BOOLEAN fits = RL_TEST_LOAD(d[i], TRUE);
+#ifndef RL_TEST_BASELINE
+        assert(fits == (i < RL_TEST_SLOTS));
+#else
+        (void)fits;
+#endif
+    }
+    d[RL_TEST_BONDS] = rl_test_dev(RL_TEST_BONDS, FALSE);
+    assert(!RL_TEST_LOAD(d[RL_TEST_BONDS], TRUE));
+#ifdef RL_TEST_BASELINE
+    rl_test_print("boot");
+    printf("rl_state %d\n", btm_cb.ble_ctr_cb.rl_state);
+    rl_test_adds = rl_test_removes = 0;
+    for (i = 1; i <= 3; i++) {
+        d[i]->ble.key_type = 0;
+        btm_ble_resolving_list_remove_dev(d[i]);
+    }
+    d[2]->ble.key_type = BTM_LE_KEY_PID;
+    RL_TEST_LOAD(d[2], TRUE);
+    rl_test_print("churn");
+    return 0;
+#else
+    assert(rl_test_adds == 0 && rl_test_timers == RL_TEST_SLOTS);
+    btm_ble_resolving_list_sync();
+    rl_test_print("boot");
+    assert(rl_test_adds == RL_TEST_SLOTS && rl_test_removes == 0);
+    assert(rl_test_suspends == 1 && rl_test_resumes == 1);
+    assert(btm_cb.ble_ctr_cb.rl_entry_num == RL_TEST_SLOTS);
+    assert(btm_cb.ble_ctr_cb.rl_state == BTM_BLE_RL_SCAN);
+
+    /* Nothing left to do */
+    btm_ble_resolving_list_sync();
+    assert(rl_test_adds == RL_TEST_SLOTS && rl_test_suspends == 1);
+
+    /* Command completions drain the pending queue in order */
+    for (i = 0; i < RL_TEST_SLOTS; i++) {
+        assert(btm_ble_deq_resolving_pending(bda) && bda[5] == i);
+    }
+    assert(!btm_ble_deq_resolving_pending(bda));
+
+    /* Unpair three, pair one of them again and free another */
+    for (i = 1; i <= 3; i++) {
+        d[i]->ble.key_type = 0;
+        btm_ble_resolving_list_remove_dev(d[i]);
+    }
+    d[2]->ble.key_type = BTM_LE_KEY_PID;
+    assert(RL_TEST_LOAD(d[2], TRUE));
+    list_remove(btm_cb.p_sec_dev_rec_list, d[3]);
+    free(d[3]);
+    rl_test_adds = rl_test_removes = 0;
+    btm_ble_resolving_list_sync();
+    rl_test_print("churn");
+    assert(rl_test_removes == 3 && rl_test_adds == 3 && rl_test_suspends == 2);
+    assert(btm_cb.ble_ctr_cb.rl_entry_num == RL_TEST_SLOTS);
+    assert(!rl_test_in_list(d[1]) && rl_test_in_list(d[2]));
+    assert(rl_test_privacy_12 || d[1]->ble.resolving_list_index == 0);
+    assert(rl_test_in_list(d[8]) && rl_test_in_list(d[9]));
+    for (i = 0; i < RL_TEST_SLOTS; i++) {
+        for (j = i + 1; j < RL_TEST_SLOTS; j++) {
+            assert(memcmp(btm_cb.ble_ctr_cb.rl_entries[i].pseudo_addr,
+                          btm_cb.ble_ctr_cb.rl_entries[j].pseudo_addr, BD_ADDR_LEN));
+        }
+    }
+    for (i = 0; i < 6; i++) {
+        assert(btm_ble_deq_resolving_pending(bda));
+    }
+
+    /* Paired at run time: written at once */
+    d[8]->ble.key_type = 0;
+    btm_ble_resolving_list_remove_dev(d[8]);
+    btm_ble_resolving_list_sync();
+    d[1]->ble.key_type = BTM_LE_KEY_PID;
+    rl_test_adds = rl_test_removes = rl_test_timers = 0;
+    assert(RL_TEST_LOAD(d[1], FALSE));
+    rl_test_print("pair");
+    assert(rl_test_adds == 1 && rl_test_timers == 0 && rl_test_in_list(d[1]));
+    for (i = 0; i < 2; i++) {
+        assert(btm_ble_deq_resolving_pending(bda));
+    }
+
+    /* A failed add leaves no trace and is retried */
+    d[9]->ble.key_type = 0;
+    btm_ble_resolving_list_remove_dev(d[9]);
+    btm_ble_resolving_list_sync();
+    assert(btm_ble_deq_resolving_pending(bda));
+    d[RL_TEST_BONDS + 1] = rl_test_dev(RL_TEST_BONDS + 1, TRUE);
+    rl_test_fail_id = RL_TEST_BONDS + 1;
+    rl_test_adds = 0;
+    assert(RL_TEST_LOAD(d[RL_TEST_BONDS + 1], FALSE));
+    assert(rl_test_adds == 0 && !rl_test_in_list(d[RL_TEST_BONDS + 1]));
+    assert(btm_cb.ble_ctr_cb.rl_entry_num == RL_TEST_SLOTS - 1);
+    assert(!btm_ble_deq_resolving_pending(bda));
+    rl_test_fail_id = -1;
+    btm_ble_resolving_list_sync();
+    assert(rl_test_adds == 1 && rl_test_in_list(d[RL_TEST_BONDS + 1]));
+    assert(btm_cb.ble_ctr_cb.rl_entry_num == RL_TEST_SLOTS);
+
+    /* An add completed with an error is rolled back, and retried */
+    rl_test_complete_add(HCI_ERR_ILLEGAL_PARAMETER_FMT, d[RL_TEST_BONDS + 1]);
+    assert(!rl_test_in_list(d[RL_TEST_BONDS + 1]));
+    assert(btm_cb.ble_ctr_cb.rl_entry_num == RL_TEST_SLOTS - 1);
+    assert(!btm_ble_deq_resolving_pending(bda));
+    rl_test_adds = 0;
+    btm_ble_resolving_list_sync();
+    assert(rl_test_adds == 1 && rl_test_in_list(d[RL_TEST_BONDS + 1]));
+    assert(btm_cb.ble_ctr_cb.rl_entry_num == RL_TEST_SLOTS);
+    rl_test_complete_add(HCI_SUCCESS, d[RL_TEST_BONDS + 1]);
+    assert(rl_test_in_list(d[RL_TEST_BONDS + 1]));
+    assert(btm_cb.ble_ctr_cb.rl_entry_num == RL_TEST_SLOTS);
+
+    if (!rl_test_privacy_12) {
+        int bits = 0;
+        for (i = 0; i < RL_TEST_SLOTS; i++) {
+            bits += rl_test_irk_index_used(i);
+        }
+        printf("irk index bits %d\n", bits);
+    }
+
+    btm_ble_resolving_list_cleanup();
+    printf("ok\n");
+    return 0;
+#endif
+}
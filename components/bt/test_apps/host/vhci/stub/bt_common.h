@@ -0,0 +1,16 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+
+/* Host stand-in for bt_common.h */
+#pragma once
+
+#define TRUE                    1
+#define FALSE                   0
+#define BT_HCI_LOG_INCLUDED     FALSE
+
+#define ESP_LOGD(...)
+#define ESP_LOGW(...)
+#define ESP_LOGE(...)
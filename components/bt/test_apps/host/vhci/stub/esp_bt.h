@@ -0,0 +1,20 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+
+/* Host stand-in for the VHCI part of esp_bt.h; implemented by the harness */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct {
+    void (*notify_host_send_available)(void);
+    int (*notify_host_recv)(uint8_t *data, uint16_t len);
+} esp_vhci_host_callback_t;
+
+bool esp_vhci_host_check_send_available(void);
+void esp_vhci_host_send_packet(uint8_t *data, uint16_t len);
+int esp_vhci_host_register_callback(const esp_vhci_host_callback_t *callback);
@@ -0,0 +1,14 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+
+/* Host stand-in for esp_nimble_mem.h */
+#pragma once
+
+#include <stdlib.h>
+
+#define nimble_platform_mem_malloc  malloc
+#define nimble_platform_mem_calloc  calloc
+#define nimble_platform_mem_free    free
@@ -0,0 +1,93 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+
+/* Host stand-in for the FreeRTOS semaphore and delay API, built on POSIX */
+#pragma once
+
+#include <errno.h>
+#include <semaphore.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef int BaseType_t;
+typedef sem_t *SemaphoreHandle_t;
+
+#define pdTRUE                  1
+#define pdFALSE                 0
+#define portTICK_PERIOD_MS      10
+#define portMAX_DELAY           0xffffffff
+#define portYIELD_FROM_ISR()
+
+/* Counted by the harness. */
+extern int vhci_test_task_delays;
+
+static inline SemaphoreHandle_t
+xSemaphoreCreateBinary(void)
+{
+    sem_t *sem = malloc(sizeof *sem);
+
+    sem_init(sem, 0, 0);
+    return sem;
+}
+
+static inline void
+vSemaphoreDelete(SemaphoreHandle_t sem)
+{
+    sem_destroy(sem);
+    free(sem);
+}
+
+static inline BaseType_t
+xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    int val;
+
+    /* Binary semaphore: never count above one. */
+    sem_getvalue(sem, &val);
+    if (val == 0) {
+        sem_post(sem);
+    }
+    return pdTRUE;
+}
+
+static inline BaseType_t
+xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t *woken)
+{
+    return xSemaphoreGive(sem);
+}
+
+static inline BaseType_t
+xSemaphoreTake(SemaphoreHandle_t sem, unsigned ticks)
+{
+    struct timespec ts;
+    unsigned long long ns;
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ns = ts.tv_nsec + (unsigned long long)ticks * portTICK_PERIOD_MS * 1000000ULL;
+    ts.tv_sec += ns / 1000000000ULL;
+    ts.tv_nsec = ns % 1000000000ULL;
+
+    while (sem_timedwait(sem, &ts) != 0) {
+        if (errno != EINTR) {
+            return pdFALSE;
+        }
+    }
+    return pdTRUE;
+}
+
+static inline int
+xPortInIsrContext(void)
+{
+    return 0;
+}
+
+static inline void
+vTaskDelay(unsigned ticks)
+{
+    vhci_test_task_delays++;
+    usleep(ticks * portTICK_PERIOD_MS * 1000);
+}
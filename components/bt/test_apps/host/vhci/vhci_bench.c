@@ -0,0 +1,307 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+
+/*
+ * Host harness for the NimBLE VHCI glue (esp-hci/src/esp_nimble_hci.c).
+ *
+ * esp_nimble_hci.c and the NimBLE transport are built against a fake VHCI
+ * controller and POSIX stand-ins for FreeRTOS (see stub/).
+ *
+ * TX: 20000 ACL packets laid out like ble_hs_mbuf_l2cap_pkt() output are
+ * sent; one in ten is an mbuf chain.  The fake controller checks every
+ * payload and counts packets passed in place (pointing into the mbuf)
+ * versus gathered into a flat buffer.
+ *
+ * RX: the fake controller delivers 2000 ACL packets as fast as it can to a
+ * transport pool of four buffers, while a host thread frees each buffer
+ * after the number of microseconds given on the command line.  Receivers
+ * waiting for a free buffer show up as throughput and as delay polls.
+ *
+ * Build from components/bt/host/nimble:
+ *
+ *   H=../../test_apps/host/vhci
+ *   gcc -O2 -D_GNU_SOURCE -I$H/stub -Iesp-hci/include \
+ *       -Inimble/nimble/include -Inimble/nimble/host/include \
+ *       -Inimble/nimble/transport/include -Inimble/porting/npl/linux/include \
+ *       -Inimble/porting/nimble/include \
+ *       -Inimble/porting/examples/linux/include \
+ *       -I../../common/bt_stats/include \
+ *       -include bt_common.h -include esp_err.h \
+ *       -DCONFIG_BT_NIMBLE_ENABLED=1 -DCONFIG_BT_CONTROLLER_ENABLED=1 \
+ *       -DCONFIG_BT_NIMBLE_LEGACY_VHCI_ENABLE=1 \
+ *       -DSOC_ESP_NIMBLE_CONTROLLER=0 \
+ *       -DMYNEWT_VAL_BLE_TRANSPORT_ACL_FROM_LL_COUNT=4 \
+ *       -DMYNEWT_VAL_BLE_TRANSPORT_ACL_FROM_HS_COUNT=0 \
+ *       -DMYNEWT_VAL_BLE_HS_FLOW_CTRL=0 -DMYNEWT_VAL_BLE_QUEUE_CONG_CHECK=0 \
+ *       -D'STAILQ_LAST(h, t, f)=NULL' \
+ *       $H/vhci_bench.c esp-hci/src/esp_nimble_hci.c \
+ *       nimble/nimble/transport/src/transport.c \
+ *       nimble/porting/nimble/src/os_mbuf.c \
+ *       nimble/porting/nimble/src/os_mempool.c \
+ *       nimble/porting/nimble/src/endian.c -lpthread -o vhci_bench
+ *   ./vhci_bench 300
+ *
+ * glibc's sys/queue.h lacks STAILQ_LAST, which only the unused msys code
+ * needs.  Build the same way against the parent tree for a baseline.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "os/os.h"
+#include "nimble/transport.h"
+#include "nimble/hci_common.h"
+#include "esp_bt.h"
+#include "esp_nimble_hci.h"
+#include "freertos/semphr.h"
+
+#define VHCI_TEST_TX_PKTS       20000
+#define VHCI_TEST_RX_PKTS       2000
+#define VHCI_TEST_RX_LEN        252
+#define VHCI_TEST_RXQ_SIZE      64
+#define VHCI_TEST_POOL_CNT      8
+#define VHCI_TEST_POOL_BLK      300
+
+int vhci_test_task_delays;
+
+/* Symbols normally provided by the rest of the host. */
+uint8_t ble_hs_enabled_state = 1;
+int os_msys_buf_alloc(void) { return 0; }
+void os_msys_buf_free(void) {}
+void ble_hs_sched_reset(int reason) {}
+void ble_npl_event_init(struct ble_npl_event *ev, ble_npl_event_fn *fn,
+                        void *arg) {}
+void ble_npl_eventq_put(struct ble_npl_eventq *evq,
+                        struct ble_npl_event *ev) {}
+
+int ble_hci_trans_hs_acl_tx(struct os_mbuf *om);
+int esp_nimble_hci_init(void);
+
+static pthread_mutex_t vhci_test_crit = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+
+uint32_t
+ble_npl_hw_enter_critical(void)
+{
+    pthread_mutex_lock(&vhci_test_crit);
+    return 0;
+}
+
+void
+ble_npl_hw_exit_critical(uint32_t ctx)
+{
+    pthread_mutex_unlock(&vhci_test_crit);
+}
+
+/* Fake controller */
+static const esp_vhci_host_callback_t *vhci_test_cb;
+static struct os_mbuf *vhci_test_tx_om;
+static const uint8_t *vhci_test_tx_expect;
+static int vhci_test_tx_expect_len;
+static long vhci_test_tx_inplace;
+static long vhci_test_tx_copied;
+static long vhci_test_tx_bad;
+
+bool
+esp_vhci_host_check_send_available(void)
+{
+    return true;
+}
+
+int
+esp_vhci_host_register_callback(const esp_vhci_host_callback_t *callback)
+{
+    vhci_test_cb = callback;
+    return 0;
+}
+
+void
+esp_vhci_host_send_packet(uint8_t *data, uint16_t len)
+{
+    struct os_mbuf *om;
+    int inplace;
+
+    inplace = 0;
+    for (om = vhci_test_tx_om; om != NULL; om = SLIST_NEXT(om, om_next)) {
+        if (data >= om->om_databuf &&
+            data < om->om_databuf + om->om_omp->omp_databuf_len) {
+            inplace = 1;
+        }
+    }
+    if (inplace) {
+        vhci_test_tx_inplace++;
+    } else {
+        vhci_test_tx_copied++;
+    }
+
+    if (len != vhci_test_tx_expect_len + 1 ||
+        data[0] != BLE_HCI_UART_H4_ACL ||
+        memcmp(data + 1, vhci_test_tx_expect, vhci_test_tx_expect_len) != 0) {
+        vhci_test_tx_bad++;
+    }
+
+    vhci_test_cb->notify_host_send_available();
+}
+
+/* Host side consumer of received ACL data */
+static struct os_mbuf *vhci_test_rxq[VHCI_TEST_RXQ_SIZE];
+static int vhci_test_rxq_head;
+static int vhci_test_rxq_tail;
+static pthread_mutex_t vhci_test_rxq_lock = PTHREAD_MUTEX_INITIALIZER;
+static volatile int vhci_test_rx_stop;
+static int vhci_test_rx_consume_us;
+static long vhci_test_rx_pkts;
+static long vhci_test_rx_bad;
+
+int
+ble_transport_to_hs_acl_impl(struct os_mbuf *om)
+{
+    pthread_mutex_lock(&vhci_test_rxq_lock);
+    vhci_test_rxq[vhci_test_rxq_tail++ % VHCI_TEST_RXQ_SIZE] = om;
+    pthread_mutex_unlock(&vhci_test_rxq_lock);
+    return 0;
+}
+
+int
+ble_transport_to_hs_evt_impl(void *buf)
+{
+    ble_transport_free(buf);
+    return 0;
+}
+
+static void *
+vhci_test_rx_task(void *arg)
+{
+    struct os_mbuf *om;
+
+    while (!vhci_test_rx_stop || vhci_test_rxq_head != vhci_test_rxq_tail) {
+        om = NULL;
+        pthread_mutex_lock(&vhci_test_rxq_lock);
+        if (vhci_test_rxq_head != vhci_test_rxq_tail) {
+            om = vhci_test_rxq[vhci_test_rxq_head++ % VHCI_TEST_RXQ_SIZE];
+        }
+        pthread_mutex_unlock(&vhci_test_rxq_lock);
+
+        if (om == NULL) {
+            usleep(50);
+            continue;
+        }
+
+        usleep(vhci_test_rx_consume_us);
+        if (OS_MBUF_PKTLEN(om) != VHCI_TEST_RX_LEN - 1 ||
+            om->om_data[4] != (uint8_t)vhci_test_rx_pkts) {
+            vhci_test_rx_bad++;
+        }
+        vhci_test_rx_pkts++;
+        os_mbuf_free_chain(om);
+    }
+
+    return NULL;
+}
+
+static double
+vhci_test_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static struct os_mbuf_pool vhci_test_mbuf_pool;
+static struct os_mempool vhci_test_mempool;
+static os_membuf_t vhci_test_mem[
+    OS_MEMPOOL_SIZE(VHCI_TEST_POOL_CNT, VHCI_TEST_POOL_BLK)];
+
+static void
+vhci_test_tx(void)
+{
+    struct os_mbuf *om;
+    struct os_mbuf *frag;
+    uint8_t pkt[260];
+    double start;
+    int i;
+
+    start = vhci_test_now();
+    for (i = 0; i < VHCI_TEST_TX_PKTS; i++) {
+        /* Leave headroom for ACL + L2CAP + H4 + controller headers, as
+         * ble_hs_mbuf_l2cap_pkt() does.
+         */
+        om = os_mbuf_get_pkthdr(&vhci_test_mbuf_pool, 0);
+        om->om_data += BLE_HCI_DATA_HDR_SZ + 4 + 1 + 4;
+        memset(pkt, i, sizeof pkt);
+        os_mbuf_append(om, pkt, 232);
+
+        if (i % 10 == 0) {
+            frag = os_mbuf_get(&vhci_test_mbuf_pool, 0);
+            os_mbuf_append(frag, pkt, 8);
+            os_mbuf_concat(om, frag);
+        }
+
+        /* L2CAP and ACL headers */
+        om = os_mbuf_prepend(om, 8);
+        memset(om->om_data, 0xa5, 8);
+
+        os_mbuf_copydata(om, 0, OS_MBUF_PKTLEN(om), pkt);
+        vhci_test_tx_expect = pkt;
+        vhci_test_tx_expect_len = OS_MBUF_PKTLEN(om);
+        vhci_test_tx_om = om;
+        ble_hci_trans_hs_acl_tx(om);
+    }
+
+    printf("TX: %d pkts in %.1f ms, in place %ld, gathered %ld, bad %ld, "
+           "pool free %d/%d\n", VHCI_TEST_TX_PKTS,
+           (vhci_test_now() - start) * 1e3, vhci_test_tx_inplace,
+           vhci_test_tx_copied, vhci_test_tx_bad,
+           vhci_test_mempool.mp_num_free, VHCI_TEST_POOL_CNT);
+}
+
+static void
+vhci_test_rx(void)
+{
+    uint8_t buf[VHCI_TEST_RX_LEN];
+    pthread_t thread;
+    double start;
+    double secs;
+    int i;
+
+    pthread_create(&thread, NULL, vhci_test_rx_task, NULL);
+
+    start = vhci_test_now();
+    for (i = 0; i < VHCI_TEST_RX_PKTS; i++) {
+        buf[0] = BLE_HCI_UART_H4_ACL;
+        memset(buf + 1, 0, BLE_HCI_DATA_HDR_SZ);
+        buf[5] = (uint8_t)i;
+        memset(buf + 6, 0x5a, sizeof buf - 6);
+        vhci_test_cb->notify_host_recv(buf, sizeof buf);
+    }
+
+    vhci_test_rx_stop = 1;
+    pthread_join(thread, NULL);
+    secs = vhci_test_now() - start;
+
+    printf("RX: %ld pkts in %.1f ms (%.0f pkt/s), bad %ld, delay polls %d\n",
+           vhci_test_rx_pkts, secs * 1e3, vhci_test_rx_pkts / secs,
+           vhci_test_rx_bad, vhci_test_task_delays);
+}
+
+int
+main(int argc, char **argv)
+{
+    vhci_test_rx_consume_us = argc > 1 ? atoi(argv[1]) : 300;
+
+    esp_nimble_hci_init();
+    os_mempool_init(&vhci_test_mempool, VHCI_TEST_POOL_CNT, VHCI_TEST_POOL_BLK,
+                    vhci_test_mem, "vhci_test");
+    os_mbuf_pool_init(&vhci_test_mbuf_pool, &vhci_test_mempool,
+                      VHCI_TEST_POOL_BLK, VHCI_TEST_POOL_CNT);
+
+    vhci_test_tx();
+    vhci_test_rx();
+
+    return vhci_test_tx_bad != 0 || vhci_test_rx_bad != 0 ||
+           vhci_test_mempool.mp_num_free != VHCI_TEST_POOL_CNT;
+}
@@ -700,6 +700,53 @@ unknown_field_get_packed_size(const ProtobufCMessageUnknownField *field)
 	return get_tag_size(field->tag) + field->len;
 }
 
+/**
+ * Calculate the serialized size of a single field of any label, including the
+ * space needed by the preceding tag(s).
+ *
+ * \param field
+ *      Field descriptor for member.
+ * \param member
+ *      Field to encode.
+ * \param qmember
+ *      Quantifier of the field.
+ * \return
+ *      Number of bytes required.
+ */
+static inline size_t
+field_get_packed_size(const ProtobufCFieldDescriptor *field,
+		      const void *member, const void *qmember)
+{
+	if (field->label == PROTOBUF_C_LABEL_REQUIRED) {
+		return required_field_get_packed_size(field, member);
+	} else if ((field->label == PROTOBUF_C_LABEL_OPTIONAL ||
+		    field->label == PROTOBUF_C_LABEL_NONE) &&
+		   (0 != (field->flags & PROTOBUF_C_FIELD_FLAG_ONEOF))) {
+		return oneof_field_get_packed_size(
+			field,
+			*(const uint32_t *) qmember,
+			member
+		);
+	} else if (field->label == PROTOBUF_C_LABEL_OPTIONAL) {
+		return optional_field_get_packed_size(
+			field,
+			*(protobuf_c_boolean *) qmember,
+			member
+		);
+	} else if (field->label == PROTOBUF_C_LABEL_NONE) {
+		return unlabeled_field_get_packed_size(
+			field,
+			member
+		);
+	} else {
+		return repeated_field_get_packed_size(
+			field,
+			*(const size_t *) qmember,
+			member
+		);
+	}
+}
+
 /**@}*/
 
 /*
@@ -719,40 +766,210 @@ size_t protobuf_c_message_get_packed_size(const ProtobufCMessage *message)
 		const void *qmember =
 			((const char *) message) + field->quantifier_offset;
 
-		if (field->label == PROTOBUF_C_LABEL_REQUIRED) {
-			rv += required_field_get_packed_size(field, member);
-		} else if ((field->label == PROTOBUF_C_LABEL_OPTIONAL ||
-			    field->label == PROTOBUF_C_LABEL_NONE) &&
-			   (0 != (field->flags & PROTOBUF_C_FIELD_FLAG_ONEOF))) {
-			rv += oneof_field_get_packed_size(
-				field,
-				*(const uint32_t *) qmember,
-				member
-			);
-		} else if (field->label == PROTOBUF_C_LABEL_OPTIONAL) {
-			rv += optional_field_get_packed_size(
-				field,
-				*(protobuf_c_boolean *) qmember,
-				member
-			);
-		} else if (field->label == PROTOBUF_C_LABEL_NONE) {
-			rv += unlabeled_field_get_packed_size(
-				field,
-				member
-			);
+		rv += field_get_packed_size(field, member, qmember);
+	}
+	for (i = 0; i < message->n_unknown_fields; i++)
+		rv += unknown_field_get_packed_size(&message->unknown_fields[i]);
+	return rv;
+}
+
+/**
+ * \defgroup sizecache Embedded message size cache
+ *
+ * Sizes of embedded messages, measured once before packing so that the length
+ * delimiters can be written directly.
+ *
+ * \ingroup internal
+ * @{
+ */
+
+/** Number of embedded message sizes kept on the stack while packing. */
+#define PACKED_SIZES_STACK_SLOTS	16
+
+/**
+ * Packed sizes of the embedded messages of a message tree.
+ *
+ * The sizing pass reserves a slot for each embedded message before descending
+ * into it (pre-order) and fills it in once the size is known (post-order). The
+ * packing passes visit the embedded messages in the same order and consume the
+ * slots sequentially.
+ *
+ * Without slots (`sizes` is NULL), embedded messages are measured as they are
+ * packed instead.
+ */
+typedef struct {
+	size_t *sizes;			/**< Slot array, or NULL. */
+	size_t n_alloced;		/**< Number of slots in `sizes`. */
+	size_t n;			/**< Next slot to reserve or consume. */
+	protobuf_c_boolean failed;	/**< Slot array could not grow. */
+	unsigned depth;			/**< Enclosing levels packed in place. */
+	size_t stack_sizes[PACKED_SIZES_STACK_SLOTS];
+} PackedSizes;
+
+static void
+packed_sizes_init(PackedSizes *ps)
+{
+	ps->sizes = NULL;
+	ps->n_alloced = 0;
+	ps->n = 0;
+	ps->failed = FALSE;
+	ps->depth = 0;
+}
+
+static void
+packed_sizes_clear(PackedSizes *ps)
+{
+	if (ps->sizes != ps->stack_sizes)
+		do_free(&protobuf_c__allocator, ps->sizes);
+	ps->sizes = NULL;
+}
+
+/**
+ * Reserve the next slot. If the slot array cannot grow, the sizes are still
+ * computed but not recorded, and `failed` makes the caller fall back to
+ * packing without them.
+ */
+static size_t
+packed_sizes_reserve(PackedSizes *ps)
+{
+	if (ps->n == ps->n_alloced && !ps->failed) {
+		size_t *new_sizes = do_alloc(&protobuf_c__allocator,
+			ps->n_alloced * 2 * sizeof(size_t));
+
+		if (new_sizes == NULL) {
+			ps->failed = TRUE;
 		} else {
-			rv += repeated_field_get_packed_size(
-				field,
-				*(const size_t *) qmember,
-				member
-			);
+			memcpy(new_sizes, ps->sizes, ps->n * sizeof(size_t));
+			if (ps->sizes != ps->stack_sizes)
+				do_free(&protobuf_c__allocator, ps->sizes);
+			ps->sizes = new_sizes;
+			ps->n_alloced *= 2;
 		}
 	}
+	return ps->n++;
+}
+
+static inline void
+packed_sizes_set(PackedSizes *ps, size_t slot, size_t size)
+{
+	if (slot < ps->n_alloced)
+		ps->sizes[slot] = size;
+}
+
+static inline size_t
+packed_sizes_next(PackedSizes *ps)
+{
+	assert(ps->n < ps->n_alloced);
+	return ps->sizes[ps->n++];
+}
+
+static size_t
+message_record_packed_sizes(const ProtobufCMessage *message, PackedSizes *ps);
+
+/**
+ * Calculate the serialized size of one embedded message field value, including
+ * the tag, recording the size of the message in `ps`.
+ */
+static size_t
+sub_message_record_packed_sizes(const ProtobufCFieldDescriptor *field,
+				const ProtobufCMessage *msg, PackedSizes *ps)
+{
+	size_t slot;
+	size_t rv;
+
+	if (msg == NULL)
+		return get_tag_size(field->id) + 1;
+	slot = packed_sizes_reserve(ps);
+	rv = message_record_packed_sizes(msg, ps);
+	packed_sizes_set(ps, slot, rv);
+	return get_tag_size(field->id) + uint32_size(rv) + rv;
+}
+
+/**
+ * Calculate the serialized size of the message like
+ * protobuf_c_message_get_packed_size(), recording the sizes of all embedded
+ * messages that will be packed, in the order they are packed.
+ */
+static size_t
+message_record_packed_sizes(const ProtobufCMessage *message, PackedSizes *ps)
+{
+	unsigned i;
+	size_t j;
+	size_t rv = 0;
+
+	for (i = 0; i < message->descriptor->n_fields; i++) {
+		const ProtobufCFieldDescriptor *field =
+			message->descriptor->fields + i;
+		const void *member =
+			((const char *) message) + field->offset;
+		const void *qmember =
+			((const char *) message) + field->quantifier_offset;
+		const ProtobufCMessage *msg;
+
+		if (field->type != PROTOBUF_C_TYPE_MESSAGE) {
+			rv += field_get_packed_size(field, member, qmember);
+			continue;
+		}
+		if (field->label == PROTOBUF_C_LABEL_REPEATED) {
+			ProtobufCMessage * const *arr =
+				*(ProtobufCMessage * const * const *) member;
+
+			for (j = 0; j < *(const size_t *) qmember; j++)
+				rv += sub_message_record_packed_sizes(field, arr[j], ps);
+			continue;
+		}
+		msg = *(ProtobufCMessage * const *) member;
+		if (field->label != PROTOBUF_C_LABEL_REQUIRED) {
+			/* Same conditions as the optional, oneof and unlabeled packers. */
+			if (msg == NULL || msg == field->default_value)
+				continue;
+			if (0 != (field->flags & PROTOBUF_C_FIELD_FLAG_ONEOF) &&
+			    *(const uint32_t *) qmember != field->id)
+				continue;
+		}
+		rv += sub_message_record_packed_sizes(field, msg, ps);
+	}
 	for (i = 0; i < message->n_unknown_fields; i++)
 		rv += unknown_field_get_packed_size(&message->unknown_fields[i]);
 	return rv;
 }
 
+/**
+ * Run the sizing pass for a message about to be packed, filling the slots of
+ * `ps`. The slots are left out if the message type has no embedded messages or
+ * they could not be allocated.
+ *
+ * \return
+ *      Packed size of the message if the slots were filled.
+ */
+static size_t
+packed_sizes_prepare(PackedSizes *ps, const ProtobufCMessage *message)
+{
+	const ProtobufCMessageDescriptor *desc = message->descriptor;
+	unsigned i;
+	size_t rv;
+
+	for (i = 0; i < desc->n_fields; i++)
+		if (desc->fields[i].type == PROTOBUF_C_TYPE_MESSAGE)
+			break;
+	if (i == desc->n_fields)
+		return 0;
+
+	ps->sizes = ps->stack_sizes;
+	ps->n_alloced = PACKED_SIZES_STACK_SLOTS;
+	ps->n = 0;
+	ps->failed = FALSE;
+	rv = message_record_packed_sizes(message, ps);
+	if (ps->failed) {
+		packed_sizes_clear(ps);
+		return 0;
+	}
+	ps->n = 0;
+	return rv;
+}
+
+/**@}*/
+
 /**
  * \defgroup pack protobuf_c_message_pack() implementation
  *
@@ -1025,6 +1242,41 @@ binary_data_pack(const ProtobufCBinaryData *bd, uint8_t *out)
 	return rv + len;
 }
 
+/**
+ * Nesting levels packed in place before the rest of a subtree is measured up
+ * front. Packing in place costs a shift of the sub-message whenever its length
+ * delimiter needs more than one byte, and these shifts add up once per level.
+ */
+#define PACK_IN_PLACE_MAX_DEPTH		16
+
+static size_t
+message_pack(const ProtobufCMessage *message, uint8_t *out, PackedSizes *ps);
+
+/**
+ * Pack a deeply nested sub-message with a sizing pass over its subtree, so
+ * each length delimiter is written directly. The slots of `ps` are unused
+ * while packing in place and are borrowed for the subtree.
+ *
+ * \return
+ *      Number of bytes written to `out`, or 0 if the subtree has no embedded
+ *      messages or the slots could not be allocated.
+ */
+static size_t
+prefixed_message_pack_subtree(const ProtobufCMessage *message, uint8_t *out,
+			      PackedSizes *ps)
+{
+	size_t sublen;
+	size_t rv;
+
+	sublen = packed_sizes_prepare(ps, message);
+	if (ps->sizes == NULL)
+		return 0;
+	rv = uint32_pack(sublen, out);
+	message_pack(message, out + rv, ps);
+	packed_sizes_clear(ps);
+	return rv + sublen;
+}
+
 /**
  * Pack a ProtobufCMessage and return the number of bytes written. The output
  * includes a length delimiter.
@@ -1033,22 +1285,41 @@ binary_data_pack(const ProtobufCBinaryData *bd, uint8_t *out)
  *      ProtobufCMessage object to pack.
  * \param[out] out
  *      Packed message.
+ * \param ps
+ *      Embedded message sizes.
  * \return
  *      Number of bytes written to `out`.
  */
 static inline size_t
-prefixed_message_pack(const ProtobufCMessage *message, uint8_t *out)
+prefixed_message_pack(const ProtobufCMessage *message, uint8_t *out,
+		      PackedSizes *ps)
 {
+	uint32_t rv_packed_size;
+	size_t rv;
+
 	if (message == NULL) {
 		out[0] = 0;
 		return 1;
-	} else {
-		size_t rv = protobuf_c_message_pack(message, out + 1);
-		uint32_t rv_packed_size = uint32_size(rv);
-		if (rv_packed_size != 1)
-			memmove(out + rv_packed_size, out + 1, rv);
-		return uint32_pack(rv, out) + rv;
+	} else if (ps->sizes != NULL) {
+		size_t sublen = packed_sizes_next(ps);
+
+		rv = uint32_pack(sublen, out);
+		return rv + message_pack(message, out + rv, ps);
+	}
+
+	if (ps->depth >= PACK_IN_PLACE_MAX_DEPTH) {
+		rv = prefixed_message_pack_subtree(message, out, ps);
+		if (rv != 0)
+			return rv;
 	}
+
+	ps->depth++;
+	rv = message_pack(message, out + 1, ps);
+	ps->depth--;
+	rv_packed_size = uint32_size(rv);
+	if (rv_packed_size != 1)
+		memmove(out + rv_packed_size, out + 1, rv);
+	return uint32_pack(rv, out) + rv;
 }
 
 /**
@@ -1083,12 +1354,14 @@ tag_pack(uint32_t id, uint8_t *out)
  *      The field member.
  * \param[out] out
  *      Packed value.
+ * \param ps
+ *      Embedded message sizes.
  * \return
  *      Number of bytes written to `out`.
  */
 static size_t
 required_field_pack(const ProtobufCFieldDescriptor *field,
-		    const void *member, uint8_t *out)
+		    const void *member, uint8_t *out, PackedSizes *ps)
 {
 	size_t rv = tag_pack(field->id, out);
 
@@ -1131,7 +1404,7 @@ required_field_pack(const ProtobufCFieldDescriptor *field,
 		return rv + binary_data_pack((const ProtobufCBinaryData *) member, out + rv);
 	case PROTOBUF_C_TYPE_MESSAGE:
 		out[0] |= PROTOBUF_C_WIRE_TYPE_LENGTH_PREFIXED;
-		return rv + prefixed_message_pack(*(ProtobufCMessage * const *) member, out + rv);
+		return rv + prefixed_message_pack(*(ProtobufCMessage * const *) member, out + rv, ps);
 	}
 	PROTOBUF_C__ASSERT_NOT_REACHED();
 	return 0;
@@ -1149,13 +1422,15 @@ required_field_pack(const ProtobufCFieldDescriptor *field,
  *      The field member.
  * \param[out] out
  *      Packed value.
+ * \param ps
+ *      Embedded message sizes.
  * \return
  *      Number of bytes written to `out`.
  */
 static size_t
 oneof_field_pack(const ProtobufCFieldDescriptor *field,
 		 uint32_t oneof_case,
-		 const void *member, uint8_t *out)
+		 const void *member, uint8_t *out, PackedSizes *ps)
 {
 	if (oneof_case != field->id) {
 		return 0;
@@ -1167,7 +1442,7 @@ oneof_field_pack(const ProtobufCFieldDescriptor *field,
 		if (ptr == NULL || ptr == field->default_value)
 			return 0;
 	}
-	return required_field_pack(field, member, out);
+	return required_field_pack(field, member, out, ps);
 }
 
 /**
@@ -1181,13 +1456,15 @@ oneof_field_pack(const ProtobufCFieldDescriptor *field,
  *      The field member.
  * \param[out] out
  *      Packed value.
+ * \param ps
+ *      Embedded message sizes.
  * \return
  *      Number of bytes written to `out`.
  */
 static size_t
 optional_field_pack(const ProtobufCFieldDescriptor *field,
 		    const protobuf_c_boolean has,
-		    const void *member, uint8_t *out)
+		    const void *member, uint8_t *out, PackedSizes *ps)
 {
 	if (field->type == PROTOBUF_C_TYPE_MESSAGE ||
 	    field->type == PROTOBUF_C_TYPE_STRING)
@@ -1199,7 +1476,7 @@ optional_field_pack(const ProtobufCFieldDescriptor *field,
 		if (!has)
 			return 0;
 	}
-	return required_field_pack(field, member, out);
+	return required_field_pack(field, member, out, ps);
 }
 
 /**
@@ -1211,16 +1488,18 @@ optional_field_pack(const ProtobufCFieldDescriptor *field,
  *      The field member.
  * \param[out] out
  *      Packed value.
+ * \param ps
+ *      Embedded message sizes.
  * \return
  *      Number of bytes written to `out`.
  */
 static size_t
 unlabeled_field_pack(const ProtobufCFieldDescriptor *field,
-		     const void *member, uint8_t *out)
+		     const void *member, uint8_t *out, PackedSizes *ps)
 {
 	if (field_is_zeroish(field, member))
 		return 0;
-	return required_field_pack(field, member, out);
+	return required_field_pack(field, member, out, ps);
 }
 
 /**
@@ -1349,12 +1628,15 @@ get_type_min_size(ProtobufCType type)
  *      Pointer to the elements for this repeated field.
  * \param[out] out
  *      Serialised representation of the repeated field.
+ * \param ps
+ *      Embedded message sizes.
  * \return
  *      Number of bytes serialised to `out`.
  */
 static size_t
 repeated_field_pack(const ProtobufCFieldDescriptor *field,
-		    size_t count, const void *member, uint8_t *out)
+		    size_t count, const void *member, uint8_t *out,
+		    PackedSizes *ps)
 {
 	void *array = *(void * const *) member;
 	unsigned i;
@@ -1450,7 +1732,7 @@ repeated_field_pack(const ProtobufCFieldDescriptor *field,
 		unsigned siz = sizeof_elt_in_repeated_array(field->type);
 
 		for (i = 0; i < count; i++) {
-			rv += required_field_pack(field, array, out + rv);
+			rv += required_field_pack(field, array, out + rv, ps);
 			array = (char *)array + siz;
 		}
 		return rv;
@@ -1468,8 +1750,12 @@ unknown_field_pack(const ProtobufCMessageUnknownField *field, uint8_t *out)
 
 /**@}*/
 
-size_t
-protobuf_c_message_pack(const ProtobufCMessage *message, uint8_t *out)
+/**
+ * Pack a message, taking the sizes of its embedded messages from `ps` if it has
+ * slots.
+ */
+static size_t
+message_pack(const ProtobufCMessage *message, uint8_t *out, PackedSizes *ps)
 {
 	unsigned i;
 	size_t rv = 0;
@@ -1493,7 +1779,7 @@ protobuf_c_message_pack(const ProtobufCMessage *message, uint8_t *out)
 			((const char *) message) + field->quantifier_offset;
 
 		if (field->label == PROTOBUF_C_LABEL_REQUIRED) {
-			rv += required_field_pack(field, member, out + rv);
+			rv += required_field_pack(field, member, out + rv, ps);
 		} else if ((field->label == PROTOBUF_C_LABEL_OPTIONAL ||
 			    field->label == PROTOBUF_C_LABEL_NONE) &&
 			   (0 != (field->flags & PROTOBUF_C_FIELD_FLAG_ONEOF))) {
@@ -1501,20 +1787,22 @@ protobuf_c_message_pack(const ProtobufCMessage *message, uint8_t *out)
 				field,
 				*(const uint32_t *) qmember,
 				member,
-				out + rv
+				out + rv,
+				ps
 			);
 		} else if (field->label == PROTOBUF_C_LABEL_OPTIONAL) {
 			rv += optional_field_pack(
 				field,
 				*(const protobuf_c_boolean *) qmember,
 				member,
-				out + rv
+				out + rv,
+				ps
 			);
 		} else if (field->label == PROTOBUF_C_LABEL_NONE) {
-			rv += unlabeled_field_pack(field, member, out + rv);
+			rv += unlabeled_field_pack(field, member, out + rv, ps);
 		} else {
 			rv += repeated_field_pack(field, *(const size_t *) qmember,
-				member, out + rv);
+				member, out + rv, ps);
 		}
 	}
 	for (i = 0; i < message->n_unknown_fields; i++)
@@ -1522,6 +1810,20 @@ protobuf_c_message_pack(const ProtobufCMessage *message, uint8_t *out)
 	return rv;
 }
 
+size_t
+protobuf_c_message_pack(const ProtobufCMessage *message, uint8_t *out)
+{
+	PackedSizes sizes;
+
+	/*
+	 * Start out packing in place, which needs no sizing pass for the
+	 * common shallow messages.
+	 */
+	ASSERT_IS_MESSAGE(message);
+	packed_sizes_init(&sizes);
+	return message_pack(message, out, &sizes);
+}
+
 /**
  * \defgroup packbuf protobuf_c_message_pack_to_buffer() implementation
  *
@@ -1531,6 +1833,10 @@ protobuf_c_message_pack(const ProtobufCMessage *message, uint8_t *out)
  * @{
  */
 
+static size_t
+message_pack_to_buffer(const ProtobufCMessage *message,
+		       ProtobufCBuffer *buffer, PackedSizes *ps);
+
 /**
  * Pack a required field to a virtual buffer.
  *
@@ -1540,12 +1846,15 @@ protobuf_c_message_pack(const ProtobufCMessage *message, uint8_t *out)
  *      The element to be packed.
  * \param[out] buffer
  *      Virtual buffer to append data to.
+ * \param ps
+ *      Embedded message sizes.
  * \return
  *      Number of bytes packed.
  */
 static size_t
 required_field_pack_to_buffer(const ProtobufCFieldDescriptor *field,
-			      const void *member, ProtobufCBuffer *buffer)
+			      const void *member, ProtobufCBuffer *buffer,
+			      PackedSizes *ps)
 {
 	size_t rv;
 	uint8_t scratch[MAX_UINT64_ENCODED_SIZE * 2];
@@ -1628,10 +1937,11 @@ required_field_pack_to_buffer(const ProtobufCFieldDescriptor *field,
 			rv += uint32_pack(0, scratch + rv);
 			buffer->append(buffer, rv, scratch);
 		} else {
-			size_t sublen = protobuf_c_message_get_packed_size(msg);
+			size_t sublen = ps->sizes ? packed_sizes_next(ps) :
+				protobuf_c_message_get_packed_size(msg);
 			rv += uint32_pack(sublen, scratch + rv);
 			buffer->append(buffer, rv, scratch);
-			protobuf_c_message_pack_to_buffer(msg, buffer);
+			message_pack_to_buffer(msg, buffer, ps);
 			rv += sublen;
 		}
 		break;
@@ -1653,13 +1963,16 @@ required_field_pack_to_buffer(const ProtobufCFieldDescriptor *field,
  *      The element to be packed.
  * \param[out] buffer
  *      Virtual buffer to append data to.
+ * \param ps
+ *      Embedded message sizes.
  * \return
  *      Number of bytes serialised to `buffer`.
  */
 static size_t
 oneof_field_pack_to_buffer(const ProtobufCFieldDescriptor *field,
 			   uint32_t oneof_case,
-			   const void *member, ProtobufCBuffer *buffer)
+			   const void *member, ProtobufCBuffer *buffer,
+			   PackedSizes *ps)
 {
 	if (oneof_case != field->id) {
 		return 0;
@@ -1671,7 +1984,7 @@ oneof_field_pack_to_buffer(const ProtobufCFieldDescriptor *field,
 		if (ptr == NULL || ptr == field->default_value)
 			return 0;
 	}
-	return required_field_pack_to_buffer(field, member, buffer);
+	return required_field_pack_to_buffer(field, member, buffer, ps);
 }
 
 /**
@@ -1685,13 +1998,16 @@ oneof_field_pack_to_buffer(const ProtobufCFieldDescriptor *field,
  *      The element to be packed.
  * \param[out] buffer
  *      Virtual buffer to append data to.
+ * \param ps
+ *      Embedded message sizes.
  * \return
  *      Number of bytes serialised to `buffer`.
  */
 static size_t
 optional_field_pack_to_buffer(const ProtobufCFieldDescriptor *field,
 			      const protobuf_c_boolean has,
-			      const void *member, ProtobufCBuffer *buffer)
+			      const void *member, ProtobufCBuffer *buffer,
+			      PackedSizes *ps)
 {
 	if (field->type == PROTOBUF_C_TYPE_MESSAGE ||
 	    field->type == PROTOBUF_C_TYPE_STRING)
@@ -1703,7 +2019,7 @@ optional_field_pack_to_buffer(const ProtobufCFieldDescriptor *field,
 		if (!has)
 			return 0;
 	}
-	return required_field_pack_to_buffer(field, member, buffer);
+	return required_field_pack_to_buffer(field, member, buffer, ps);
 }
 
 /**
@@ -1715,16 +2031,19 @@ optional_field_pack_to_buffer(const ProtobufCFieldDescriptor *field,
  *      The element to be packed.
  * \param[out] buffer
  *      Virtual buffer to append data to.
+ * \param ps
+ *      Embedded message sizes.
  * \return
  *      Number of bytes serialised to `buffer`.
  */
 static size_t
 unlabeled_field_pack_to_buffer(const ProtobufCFieldDescriptor *field,
-			       const void *member, ProtobufCBuffer *buffer)
+			       const void *member, ProtobufCBuffer *buffer,
+			       PackedSizes *ps)
 {
 	if (field_is_zeroish(field, member))
 		return 0;
-	return required_field_pack_to_buffer(field, member, buffer);
+	return required_field_pack_to_buffer(field, member, buffer, ps);
 }
 
 /**
@@ -1906,7 +2225,7 @@ no_packing_needed:
 static size_t
 repeated_field_pack_to_buffer(const ProtobufCFieldDescriptor *field,
 			      unsigned count, const void *member,
-			      ProtobufCBuffer *buffer)
+			      ProtobufCBuffer *buffer, PackedSizes *ps)
 {
 	char *array = *(char * const *) member;
 
@@ -1932,7 +2251,7 @@ repeated_field_pack_to_buffer(const ProtobufCFieldDescriptor *field,
 
 		siz = sizeof_elt_in_repeated_array(field->type);
 		for (i = 0; i < count; i++) {
-			rv += required_field_pack_to_buffer(field, array, buffer);
+			rv += required_field_pack_to_buffer(field, array, buffer, ps);
 			array += siz;
 		}
 		return rv;
@@ -1954,9 +2273,13 @@ unknown_field_pack_to_buffer(const ProtobufCMessageUnknownField *field,
 
 /**@}*/
 
-size_t
-protobuf_c_message_pack_to_buffer(const ProtobufCMessage *message,
-				  ProtobufCBuffer *buffer)
+/**
+ * Pack a message to a buffer, taking the sizes of its embedded messages from
+ * `ps` if given.
+ */
+static size_t
+message_pack_to_buffer(const ProtobufCMessage *message,
+		       ProtobufCBuffer *buffer, PackedSizes *ps)
 {
 	unsigned i;
 	size_t rv = 0;
@@ -1971,7 +2294,7 @@ protobuf_c_message_pack_to_buffer(const ProtobufCMessage *message,
 			((const char *) message) + field->quantifier_offset;
 
 		if (field->label == PROTOBUF_C_LABEL_REQUIRED) {
-			rv += required_field_pack_to_buffer(field, member, buffer);
+			rv += required_field_pack_to_buffer(field, member, buffer, ps);
 		} else if ((field->label == PROTOBUF_C_LABEL_OPTIONAL ||
 			    field->label == PROTOBUF_C_LABEL_NONE) &&
 			   (0 != (field->flags & PROTOBUF_C_FIELD_FLAG_ONEOF))) {
@@ -1979,27 +2302,31 @@ protobuf_c_message_pack_to_buffer(const ProtobufCMessage *message,
 				field,
 				*(const uint32_t *) qmember,
 				member,
-				buffer
+				buffer,
+				ps
 			);
 		} else if (field->label == PROTOBUF_C_LABEL_OPTIONAL) {
 			rv += optional_field_pack_to_buffer(
 				field,
 				*(const protobuf_c_boolean *) qmember,
 				member,
-				buffer
+				buffer,
+				ps
 			);
 		} else if (field->label == PROTOBUF_C_LABEL_NONE) {
 			rv += unlabeled_field_pack_to_buffer(
 				field,
 				member,
-				buffer
+				buffer,
+				ps
 			);
 		} else {
 			rv += repeated_field_pack_to_buffer(
 				field,
 				*(const size_t *) qmember,
 				member,
-				buffer
+				buffer,
+				ps
 			);
 		}
 	}
@@ -2009,6 +2336,21 @@ protobuf_c_message_pack_to_buffer(const ProtobufCMessage *message,
 	return rv;
 }
 
+size_t
+protobuf_c_message_pack_to_buffer(const ProtobufCMessage *message,
+				  ProtobufCBuffer *buffer)
+{
+	PackedSizes sizes;
+	size_t rv;
+
+	ASSERT_IS_MESSAGE(message);
+	packed_sizes_init(&sizes);
+	packed_sizes_prepare(&sizes, message);
+	rv = message_pack_to_buffer(message, buffer, &sizes);
+	packed_sizes_clear(&sizes);
+	return rv;
+}
+
 /**
  * \defgroup unpack unpacking implementation
  *
@@ -3409,6 +3751,494 @@ protobuf_c_message_free_unpacked(ProtobufCMessage *message,
 	do_free(allocator, message);
 }
 
+/**
+ * \defgroup stream incremental unpacking implementation
+ *
+ * The incremental unpacker is a push parser: it consumes a chunk at a time and
+ * keeps an explicit stack of the embedded messages and packed fields it is
+ * inside of, instead of recursing over a contiguous buffer. Tags, length
+ * prefixes and values are decoded in place when a chunk holds them whole and
+ * are otherwise collected in `pending` until complete.
+ *
+ * \ingroup internal
+ * @{
+ */
+
+/** What the next bytes of the stream hold. */
+enum {
+	STREAM_STATE_TAG,	/**< Tag and wire type, or a packed element. */
+	STREAM_STATE_VALUE,	/**< Varint, 32-bit or 64-bit value. */
+	STREAM_STATE_LENGTH,	/**< Length prefix. */
+	STREAM_STATE_DATA,	/**< Payload of a string, bytes or unknown field. */
+	STREAM_STATE_ERROR,	/**< Unpacking failed. */
+};
+
+static inline protobuf_c_boolean
+stream_frame_is_packed(const ProtobufCStreamUnpacker *unpacker)
+{
+	const ProtobufCFieldDescriptor *field =
+		unpacker->frames[unpacker->depth - 1].field;
+
+	return field != NULL && field->type != PROTOBUF_C_TYPE_MESSAGE;
+}
+
+static void
+stream_event_init(const ProtobufCStreamUnpacker *unpacker,
+		  ProtobufCStreamEventType type,
+		  ProtobufCStreamEvent *event)
+{
+	unsigned depth = unpacker->depth - 1;
+
+	if (stream_frame_is_packed(unpacker))
+		depth--;
+	event->type = type;
+	event->depth = depth;
+	event->descriptor = unpacker->frames[unpacker->depth - 1].descriptor;
+	event->field = unpacker->field;
+	event->tag = unpacker->tag;
+	event->wire_type = unpacker->wire_type;
+	event->value = NULL;
+	event->len = 0;
+	event->offset = 0;
+	event->data_len = 0;
+	event->data = NULL;
+}
+
+/**
+ * Collect the tag, length prefix or value starting at `data`.
+ *
+ * \param unpacker
+ *      The unpacker.
+ * \param avail
+ *      Bytes available at `data`, at least 1.
+ * \param data
+ *      Next bytes of the stream.
+ * \param[out] used
+ *      Number of bytes consumed from `data`.
+ * \param[out] out
+ *      The complete item, or NULL if more bytes are needed.
+ * \param[out] out_len
+ *      Length of the complete item.
+ * \return
+ *      FALSE if a varint is too long.
+ */
+static protobuf_c_boolean
+stream_collect(ProtobufCStreamUnpacker *unpacker,
+	       size_t avail, const uint8_t *data, size_t *used,
+	       const uint8_t **out, unsigned *out_len)
+{
+	protobuf_c_boolean varint =
+		unpacker->wire_type == PROTOBUF_C_WIRE_TYPE_VARINT ||
+		unpacker->state != STREAM_STATE_VALUE;
+	unsigned need;
+	unsigned i;
+
+	if (unpacker->state == STREAM_STATE_VALUE)
+		need = unpacker->wire_type == PROTOBUF_C_WIRE_TYPE_64BIT ? 8 :
+		       unpacker->wire_type == PROTOBUF_C_WIRE_TYPE_32BIT ? 4 :
+		       10;
+	else
+		need = 5;
+
+	*out = NULL;
+	if (unpacker->n_pending == 0) {
+		/* Fast path: the whole item is in this chunk. */
+		if (!varint) {
+			if (avail >= need) {
+				*out = data;
+				*out_len = need;
+				*used = need;
+				return TRUE;
+			}
+		} else {
+			unsigned max = avail < need ? avail : need;
+
+			for (i = 0; i < max; i++) {
+				if ((data[i] & 0x80) == 0) {
+					*out = data;
+					*out_len = i + 1;
+					*used = i + 1;
+					return TRUE;
+				}
+			}
+			if (avail >= need)
+				return FALSE;
+		}
+	}
+
+	for (i = 0; i < avail && unpacker->n_pending < need; i++) {
+		uint8_t b = data[i];
+
+		unpacker->pending[unpacker->n_pending++] = b;
+		if (varint && (b & 0x80) == 0) {
+			i++;
+			break;
+		}
+	}
+	*used = i;
+	if (varint) {
+		if ((unpacker->pending[unpacker->n_pending - 1] & 0x80) != 0) {
+			if (unpacker->n_pending == need)
+				return FALSE;
+			return TRUE;
+		}
+	} else if (unpacker->n_pending < need) {
+		return TRUE;
+	}
+	*out = unpacker->pending;
+	*out_len = unpacker->n_pending;
+	unpacker->n_pending = 0;
+	return TRUE;
+}
+
+static protobuf_c_boolean
+stream_push(ProtobufCStreamUnpacker *unpacker,
+	    const ProtobufCMessageDescriptor *descriptor,
+	    size_t end)
+{
+	if (unpacker->depth == PROTOBUF_C_STREAM_MAX_DEPTH) {
+		PROTOBUF_C_UNPACK_ERROR("nesting deeper than %u at offset %lu",
+					PROTOBUF_C_STREAM_MAX_DEPTH,
+					(unsigned long) unpacker->offset);
+		return FALSE;
+	}
+	unpacker->frames[unpacker->depth].descriptor = descriptor;
+	unpacker->frames[unpacker->depth].field = unpacker->field;
+	unpacker->frames[unpacker->depth].end = end;
+	unpacker->depth++;
+	/* The cached field belongs to the enclosing message. */
+	unpacker->field = NULL;
+	return TRUE;
+}
+
+static protobuf_c_boolean
+stream_pop(ProtobufCStreamUnpacker *unpacker)
+{
+	const ProtobufCFieldDescriptor *field =
+		unpacker->frames[unpacker->depth - 1].field;
+	ProtobufCStreamEvent event;
+
+	if (unpacker->state != STREAM_STATE_TAG || unpacker->n_pending != 0) {
+		PROTOBUF_C_UNPACK_ERROR("field truncated by end of %s at offset %lu",
+					field->name,
+					(unsigned long) unpacker->offset);
+		return FALSE;
+	}
+	unpacker->depth--;
+	if (field->type != PROTOBUF_C_TYPE_MESSAGE)
+		return TRUE;
+	unpacker->field = field;
+	unpacker->tag = field->id;
+	unpacker->wire_type = PROTOBUF_C_WIRE_TYPE_LENGTH_PREFIXED;
+	stream_event_init(unpacker, PROTOBUF_C_STREAM_EVENT_MESSAGE_END, &event);
+	return unpacker->callback(&event, unpacker->user_data);
+}
+
+static protobuf_c_boolean
+stream_begin_data(ProtobufCStreamUnpacker *unpacker, size_t len)
+{
+	ProtobufCStreamEvent event;
+
+	unpacker->data_len = len;
+	unpacker->data_offset = 0;
+	if (len != 0) {
+		unpacker->state = STREAM_STATE_DATA;
+		return TRUE;
+	}
+	/* Report empty payloads too, so that empty strings are seen. */
+	unpacker->state = STREAM_STATE_TAG;
+	stream_event_init(unpacker, PROTOBUF_C_STREAM_EVENT_DATA, &event);
+	event.data = (const uint8_t *) "";
+	return unpacker->callback(&event, unpacker->user_data);
+}
+
+static protobuf_c_boolean
+stream_got_tag(ProtobufCStreamUnpacker *unpacker,
+	       unsigned len, const uint8_t *data)
+{
+	const ProtobufCMessageDescriptor *desc =
+		unpacker->frames[unpacker->depth - 1].descriptor;
+	int field_index;
+
+	if (parse_tag_and_wiretype(len, data, &unpacker->tag,
+				   &unpacker->wire_type) == 0)
+	{
+		PROTOBUF_C_UNPACK_ERROR("error parsing tag/wiretype at offset %lu",
+					(unsigned long) unpacker->offset);
+		return FALSE;
+	}
+	if (unpacker->field == NULL || unpacker->field->id != unpacker->tag) {
+		field_index = int_range_lookup(desc->n_field_ranges,
+					       desc->field_ranges,
+					       unpacker->tag);
+		unpacker->field = field_index < 0 ?
+			NULL : desc->fields + field_index;
+	}
+
+	switch (unpacker->wire_type) {
+	case PROTOBUF_C_WIRE_TYPE_VARINT:
+	case PROTOBUF_C_WIRE_TYPE_64BIT:
+	case PROTOBUF_C_WIRE_TYPE_32BIT:
+		unpacker->state = STREAM_STATE_VALUE;
+		return TRUE;
+	case PROTOBUF_C_WIRE_TYPE_LENGTH_PREFIXED:
+		unpacker->state = STREAM_STATE_LENGTH;
+		return TRUE;
+	}
+	PROTOBUF_C_UNPACK_ERROR("unsupported tag %u at offset %lu",
+				unpacker->wire_type,
+				(unsigned long) unpacker->offset);
+	return FALSE;
+}
+
+static protobuf_c_boolean
+stream_got_value(ProtobufCStreamUnpacker *unpacker,
+		 unsigned len, const uint8_t *data)
+{
+	ProtobufCStreamEvent event;
+	ScannedMember scanned_member;
+	union {
+		uint32_t u32;
+		uint64_t u64;
+		protobuf_c_boolean b;
+		float f;
+		double d;
+	} value;
+
+	unpacker->state = STREAM_STATE_TAG;
+	if (unpacker->field == NULL) {
+		stream_event_init(unpacker, PROTOBUF_C_STREAM_EVENT_DATA, &event);
+		event.len = len;
+		event.data_len = len;
+		event.data = data;
+		return unpacker->callback(&event, unpacker->user_data);
+	}
+
+	scanned_member.tag = unpacker->tag;
+	scanned_member.wire_type = unpacker->wire_type;
+	scanned_member.length_prefix_len = 0;
+	scanned_member.field = unpacker->field;
+	scanned_member.len = len;
+	scanned_member.data = data;
+	/* Scalar types never allocate, and others fail the wire type check. */
+	if (!parse_required_member(&scanned_member, &value, NULL, FALSE)) {
+		PROTOBUF_C_UNPACK_ERROR("bad wire type %u for field %s at offset %lu",
+					unpacker->wire_type, unpacker->field->name,
+					(unsigned long) unpacker->offset);
+		return FALSE;
+	}
+	stream_event_init(unpacker, PROTOBUF_C_STREAM_EVENT_VALUE, &event);
+	event.value = &value;
+	return unpacker->callback(&event, unpacker->user_data);
+}
+
+static protobuf_c_boolean
+stream_got_length(ProtobufCStreamUnpacker *unpacker,
+		  unsigned len, const uint8_t *data)
+{
+	const ProtobufCFieldDescriptor *field = unpacker->field;
+	size_t room = unpacker->frames[unpacker->depth - 1].end -
+		unpacker->offset;
+	uint64_t val = 0;
+	ProtobufCStreamEvent event;
+	unsigned i;
+
+	for (i = 0; i < len; i++)
+		val |= ((uint64_t) data[i] & 0x7f) << (7 * i);
+
+	if (val > INT_MAX || val > room) {
+		PROTOBUF_C_UNPACK_ERROR("length prefix of %lu at offset %lu exceeds "
+					"the enclosing message",
+					(unsigned long) val,
+					(unsigned long) unpacker->offset);
+		return FALSE;
+	}
+	if (field == NULL)
+		return stream_begin_data(unpacker, val);
+
+	switch (field->type) {
+	case PROTOBUF_C_TYPE_MESSAGE:
+		unpacker->state = STREAM_STATE_TAG;
+		stream_event_init(unpacker, PROTOBUF_C_STREAM_EVENT_MESSAGE_BEGIN,
+				  &event);
+		event.len = val;
+		if (!stream_push(unpacker, field->descriptor,
+				 unpacker->offset + val))
+			return FALSE;
+		return unpacker->callback(&event, unpacker->user_data);
+	case PROTOBUF_C_TYPE_STRING:
+	case PROTOBUF_C_TYPE_BYTES:
+		return stream_begin_data(unpacker, val);
+	default:
+		if (field->label != PROTOBUF_C_LABEL_REPEATED) {
+			PROTOBUF_C_UNPACK_ERROR("bad wire type %u for field %s at offset %lu",
+						unpacker->wire_type, field->name,
+						(unsigned long) unpacker->offset);
+			return FALSE;
+		}
+		unpacker->state = STREAM_STATE_TAG;
+		return stream_push(unpacker,
+				   unpacker->frames[unpacker->depth - 1].descriptor,
+				   unpacker->offset + val);
+	}
+}
+
+/** Set up the next element of the packed field on top of the stack. */
+static void
+stream_next_packed(ProtobufCStreamUnpacker *unpacker)
+{
+	const ProtobufCFieldDescriptor *field =
+		unpacker->frames[unpacker->depth - 1].field;
+
+	unpacker->field = field;
+	unpacker->tag = field->id;
+	switch (field->type) {
+	case PROTOBUF_C_TYPE_SFIXED32:
+	case PROTOBUF_C_TYPE_FIXED32:
+	case PROTOBUF_C_TYPE_FLOAT:
+		unpacker->wire_type = PROTOBUF_C_WIRE_TYPE_32BIT;
+		break;
+	case PROTOBUF_C_TYPE_SFIXED64:
+	case PROTOBUF_C_TYPE_FIXED64:
+	case PROTOBUF_C_TYPE_DOUBLE:
+		unpacker->wire_type = PROTOBUF_C_WIRE_TYPE_64BIT;
+		break;
+	default:
+		unpacker->wire_type = PROTOBUF_C_WIRE_TYPE_VARINT;
+		break;
+	}
+	unpacker->state = STREAM_STATE_VALUE;
+}
+
+/**@}*/
+
+void
+protobuf_c_stream_unpacker_init(ProtobufCStreamUnpacker *unpacker,
+				const ProtobufCMessageDescriptor *descriptor,
+				ProtobufCStreamCallback callback,
+				void *user_data)
+{
+	ASSERT_IS_MESSAGE_DESCRIPTOR(descriptor);
+
+	unpacker->callback = callback;
+	unpacker->user_data = user_data;
+	unpacker->offset = 0;
+	unpacker->state = STREAM_STATE_TAG;
+	unpacker->wire_type = 0;
+	unpacker->n_pending = 0;
+	unpacker->depth = 1;
+	unpacker->tag = 0;
+	unpacker->field = NULL;
+	unpacker->data_len = 0;
+	unpacker->data_offset = 0;
+	unpacker->frames[0].descriptor = descriptor;
+	unpacker->frames[0].field = NULL;
+	unpacker->frames[0].end = SIZE_MAX;
+}
+
+protobuf_c_boolean
+protobuf_c_stream_unpacker_feed(ProtobufCStreamUnpacker *unpacker,
+				size_t len, const uint8_t *data)
+{
+	if (unpacker->state == STREAM_STATE_ERROR)
+		return FALSE;
+
+	for (;;) {
+		size_t avail = unpacker->frames[unpacker->depth - 1].end -
+			unpacker->offset;
+		const uint8_t *item;
+		unsigned item_len;
+		size_t used;
+		protobuf_c_boolean ok;
+
+		if (avail == 0) {
+			if (!stream_pop(unpacker))
+				goto error;
+			continue;
+		}
+		if (len == 0)
+			break;
+		if (avail > len)
+			avail = len;
+
+		if (unpacker->state == STREAM_STATE_DATA) {
+			ProtobufCStreamEvent event;
+
+			used = unpacker->data_len - unpacker->data_offset;
+			if (used > avail)
+				used = avail;
+			stream_event_init(unpacker, PROTOBUF_C_STREAM_EVENT_DATA,
+					  &event);
+			event.len = unpacker->data_len;
+			event.offset = unpacker->data_offset;
+			event.data_len = used;
+			event.data = data;
+			unpacker->data_offset += used;
+			unpacker->offset += used;
+			data += used;
+			len -= used;
+			if (unpacker->data_offset == unpacker->data_len)
+				unpacker->state = STREAM_STATE_TAG;
+			if (!unpacker->callback(&event, unpacker->user_data))
+				goto error;
+			continue;
+		}
+
+		if (unpacker->state == STREAM_STATE_TAG &&
+		    stream_frame_is_packed(unpacker))
+			stream_next_packed(unpacker);
+
+		if (!stream_collect(unpacker, avail, data, &used,
+				    &item, &item_len))
+		{
+			PROTOBUF_C_UNPACK_ERROR("unterminated varint at offset %lu",
+						(unsigned long) unpacker->offset);
+			goto error;
+		}
+		unpacker->offset += used;
+		data += used;
+		len -= used;
+		if (item == NULL)
+			continue;
+
+		switch (unpacker->state) {
+		case STREAM_STATE_TAG:
+			ok = stream_got_tag(unpacker, item_len, item);
+			break;
+		case STREAM_STATE_VALUE:
+			ok = stream_got_value(unpacker, item_len, item);
+			break;
+		default:
+			ok = stream_got_length(unpacker, item_len, item);
+			break;
+		}
+		if (!ok)
+			goto error;
+	}
+	return TRUE;
+
+error:
+	unpacker->state = STREAM_STATE_ERROR;
+	return FALSE;
+}
+
+protobuf_c_boolean
+protobuf_c_stream_unpacker_finish(ProtobufCStreamUnpacker *unpacker)
+{
+	if (unpacker->state == STREAM_STATE_ERROR)
+		return FALSE;
+	if (unpacker->depth != 1 ||
+	    unpacker->state != STREAM_STATE_TAG ||
+	    unpacker->n_pending != 0)
+	{
+		PROTOBUF_C_UNPACK_ERROR("message truncated at offset %lu",
+					(unsigned long) unpacker->offset);
+		unpacker->state = STREAM_STATE_ERROR;
+		return FALSE;
+	}
+	return TRUE;
+}
+
 void
 protobuf_c_message_init(const ProtobufCMessageDescriptor * descriptor,
 			void *message)
@@ -343,6 +343,20 @@ typedef enum {
 	PROTOBUF_C_WIRE_TYPE_32BIT = 5,
 } ProtobufCWireType;
 
+/**
+ * Kinds of events reported by a `ProtobufCStreamUnpacker`.
+ */
+typedef enum {
+	/** A length-prefixed embedded message field starts. */
+	PROTOBUF_C_STREAM_EVENT_MESSAGE_BEGIN,
+	/** The embedded message of the matching `MESSAGE_BEGIN` ends. */
+	PROTOBUF_C_STREAM_EVENT_MESSAGE_END,
+	/** A scalar field, or one element of a packed repeated field. */
+	PROTOBUF_C_STREAM_EVENT_VALUE,
+	/** A chunk of a string, bytes or unknown field. */
+	PROTOBUF_C_STREAM_EVENT_DATA,
+} ProtobufCStreamEventType;
+
 struct ProtobufCAllocator;
 struct ProtobufCBinaryData;
 struct ProtobufCBuffer;
@@ -358,6 +372,8 @@ struct ProtobufCMessageUnknownField;
 struct ProtobufCMethodDescriptor;
 struct ProtobufCService;
 struct ProtobufCServiceDescriptor;
+struct ProtobufCStreamEvent;
+struct ProtobufCStreamUnpacker;
 
 typedef struct ProtobufCAllocator ProtobufCAllocator;
 typedef struct ProtobufCBinaryData ProtobufCBinaryData;
@@ -374,6 +390,8 @@ typedef struct ProtobufCMessageUnknownField ProtobufCMessageUnknownField;
 typedef struct ProtobufCMethodDescriptor ProtobufCMethodDescriptor;
 typedef struct ProtobufCService ProtobufCService;
 typedef struct ProtobufCServiceDescriptor ProtobufCServiceDescriptor;
+typedef struct ProtobufCStreamEvent ProtobufCStreamEvent;
+typedef struct ProtobufCStreamUnpacker ProtobufCStreamUnpacker;
 
 /** Boolean type. */
 typedef int protobuf_c_boolean;
@@ -381,6 +399,8 @@ typedef int protobuf_c_boolean;
 typedef void (*ProtobufCClosure)(const ProtobufCMessage *, void *closure_data);
 typedef void (*ProtobufCMessageInit)(ProtobufCMessage *);
 typedef void (*ProtobufCServiceDestroy)(ProtobufCService *);
+typedef protobuf_c_boolean (*ProtobufCStreamCallback)(
+	const ProtobufCStreamEvent *event, void *user_data);
 
 /**
  * Structure for defining a custom memory allocator.
@@ -769,6 +789,96 @@ struct ProtobufCServiceDescriptor {
 	const unsigned			*method_indices_by_name;
 };
 
+/**
+ * An event reported by a `ProtobufCStreamUnpacker`.
+ *
+ * Events are reported in wire order. Pointers in the event are only valid for
+ * the duration of the callback.
+ */
+struct ProtobufCStreamEvent {
+	/** What happened. */
+	ProtobufCStreamEventType	type;
+	/** Nesting depth of `descriptor`; 0 for the top-level message. */
+	unsigned			depth;
+	/** Descriptor of the message that contains `field`. */
+	const ProtobufCMessageDescriptor	*descriptor;
+	/** The field, or NULL if `tag` is unknown to `descriptor`. */
+	const ProtobufCFieldDescriptor	*field;
+	/** Field tag. */
+	uint32_t			tag;
+	/** Wire type of the value; for packed elements, of the element. */
+	ProtobufCWireType		wire_type;
+	/**
+	 * For `VALUE`: the decoded value, stored as in the corresponding
+	 * member of the generated message structure (e.g. `int32_t` for
+	 * `PROTOBUF_C_TYPE_SINT32`, `protobuf_c_boolean` for
+	 * `PROTOBUF_C_TYPE_BOOL`).
+	 */
+	const void			*value;
+	/** For `MESSAGE_BEGIN` and `DATA`: total length of the payload. */
+	size_t				len;
+	/** For `DATA`: offset of this chunk within the payload. */
+	size_t				offset;
+	/** For `DATA`: number of bytes in this chunk. */
+	size_t				data_len;
+	/**
+	 * For `DATA`: the bytes of this chunk. Unknown varint and fixed-width
+	 * fields are reported as a single chunk holding their raw encoding.
+	 */
+	const uint8_t			*data;
+};
+
+#ifndef PROTOBUF_C_STREAM_MAX_DEPTH
+/**
+ * Number of nested embedded messages and packed fields, including the
+ * top-level message, that a `ProtobufCStreamUnpacker` can track.
+ */
+#define PROTOBUF_C_STREAM_MAX_DEPTH	32
+#endif
+
+/**
+ * Incremental unpacker state.
+ *
+ * The members are private; use protobuf_c_stream_unpacker_init(),
+ * protobuf_c_stream_unpacker_feed() and protobuf_c_stream_unpacker_finish().
+ * The object does not allocate memory and may live on the stack.
+ */
+struct ProtobufCStreamUnpacker {
+	/** Event callback. */
+	ProtobufCStreamCallback		callback;
+	/** Opaque pointer passed to `callback`. */
+	void				*user_data;
+	/** Number of bytes consumed so far. */
+	size_t				offset;
+	/** What the next bytes are expected to hold. */
+	uint8_t				state;
+	/** Wire type of the field being read. */
+	uint8_t				wire_type;
+	/** Number of bytes collected in `pending`. */
+	uint8_t				n_pending;
+	/** Number of frames in use. */
+	uint8_t				depth;
+	/** Tag of the field being read. */
+	uint32_t			tag;
+	/** Descriptor of the field being read, if known. */
+	const ProtobufCFieldDescriptor	*field;
+	/** Length of the length-prefixed payload being read. */
+	size_t				data_len;
+	/** Bytes of that payload already reported. */
+	size_t				data_offset;
+	/** Tag, length or value bytes split across calls. */
+	uint8_t				pending[10];
+	/** Open messages and packed fields, outermost first. */
+	struct {
+		/** Message the fields of this frame belong to. */
+		const ProtobufCMessageDescriptor	*descriptor;
+		/** Field that opened the frame; NULL at the top level. */
+		const ProtobufCFieldDescriptor	*field;
+		/** Stream offset at which the frame ends. */
+		size_t					end;
+	} frames[PROTOBUF_C_STREAM_MAX_DEPTH];
+};
+
 /**
  * Get the version of the protobuf-c library. Note that this is the version of
  * the library linked against, not the version of the headers compiled against.
@@ -980,6 +1090,72 @@ protobuf_c_message_free_unpacked(
 	ProtobufCMessage *message,
 	ProtobufCAllocator *allocator);
 
+/**
+ * Initialise an incremental unpacker.
+ *
+ * Unlike protobuf_c_message_unpack(), an incremental unpacker does not need
+ * the serialised message in one contiguous buffer: it can be fed chunks of any
+ * size as they arrive and reports the fields it decodes through `callback`.
+ * Only the field currently being decoded is tracked, so memory use does not
+ * depend on the size of the message.
+ *
+ * The unpacker checks the wire format and the wire types of known fields.
+ * Required fields and repeated occurrences of singular fields are left to the
+ * callback.
+ *
+ * \param[out] unpacker
+ *      The unpacker to initialise.
+ * \param descriptor
+ *      Descriptor of the top-level message.
+ * \param callback
+ *      Function called for every event. Returning FALSE stops unpacking.
+ * \param user_data
+ *      Opaque pointer passed to `callback`.
+ */
+PROTOBUF_C__API
+void
+protobuf_c_stream_unpacker_init(
+	ProtobufCStreamUnpacker *unpacker,
+	const ProtobufCMessageDescriptor *descriptor,
+	ProtobufCStreamCallback callback,
+	void *user_data);
+
+/**
+ * Feed the next chunk of a serialised message to an incremental unpacker.
+ *
+ * \param unpacker
+ *      The unpacker.
+ * \param len
+ *      Length in bytes of the chunk. May be 0.
+ * \param data
+ *      The chunk.
+ * \retval TRUE
+ *      The chunk was consumed.
+ * \retval FALSE
+ *      The data is malformed or the callback failed. Further calls fail too.
+ */
+PROTOBUF_C__API
+protobuf_c_boolean
+protobuf_c_stream_unpacker_feed(
+	ProtobufCStreamUnpacker *unpacker,
+	size_t len,
+	const uint8_t *data);
+
+/**
+ * Signal the end of the serialised message to an incremental unpacker.
+ *
+ * \param unpacker
+ *      The unpacker.
+ * \retval TRUE
+ *      The data fed so far is a complete message.
+ * \retval FALSE
+ *      The data ended inside a field or embedded message, or an earlier call
+ *      failed.
+ */
+PROTOBUF_C__API
+protobuf_c_boolean
+protobuf_c_stream_unpacker_finish(ProtobufCStreamUnpacker *unpacker);
+
 /**
  * Check the validity of a message object.
  *
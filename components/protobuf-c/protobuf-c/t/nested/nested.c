@@ -0,0 +1,295 @@
+/*
+ * Packing of deeply nested and wide message trees. The output of
+ * protobuf_c_message_pack() and protobuf_c_message_pack_to_buffer() is
+ * checked against a straightforward bottom-up reference encoder.
+ *
+ * Run with "--bench" to print packing times.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "t/nested/nested.pb-c.h"
+
+#define DEEP_DEPTH	2000
+#define WIDE_WIDTH	20000
+
+typedef struct {
+	uint8_t *data;
+	size_t len;
+	size_t alloced;
+} RefBuf;
+
+static void
+ref_put(RefBuf *b, const void *data, size_t len)
+{
+	if (len == 0)
+		return;
+	if (b->len + len > b->alloced) {
+		b->alloced = (b->len + len) * 2;
+		b->data = realloc(b->data, b->alloced);
+		assert(b->data != NULL);
+	}
+	memcpy(b->data + b->len, data, len);
+	b->len += len;
+}
+
+static void
+ref_varint(RefBuf *b, uint64_t v)
+{
+	uint8_t c;
+
+	do {
+		c = v & 0x7f;
+		v >>= 7;
+		if (v)
+			c |= 0x80;
+		ref_put(b, &c, 1);
+	} while (v);
+}
+
+static void ref_node(RefBuf *b, const Nested__Node *node);
+
+static void
+ref_sub(RefBuf *b, unsigned id, const Nested__Node *node)
+{
+	RefBuf sub = { NULL, 0, 0 };
+
+	ref_node(&sub, node);
+	ref_varint(b, (id << 3) | 2);
+	ref_varint(b, sub.len);
+	ref_put(b, sub.data, sub.len);
+	free(sub.data);
+}
+
+static void
+ref_node(RefBuf *b, const Nested__Node *node)
+{
+	size_t i;
+
+	if (node->has_value) {
+		ref_varint(b, 1 << 3);
+		ref_varint(b, (uint64_t) (int64_t) node->value);
+	}
+	if (node->child)
+		ref_sub(b, 2, node->child);
+	for (i = 0; i < node->n_children; i++)
+		ref_sub(b, 3, node->children[i]);
+	if (node->has_payload) {
+		ref_varint(b, (4 << 3) | 2);
+		ref_varint(b, node->payload.len);
+		ref_put(b, node->payload.data, node->payload.len);
+	}
+}
+
+static Nested__Node *
+node_new(int32_t value)
+{
+	Nested__Node *node = malloc(sizeof(*node));
+
+	assert(node != NULL);
+	nested__node__init(node);
+	node->has_value = 1;
+	node->value = value;
+	return node;
+}
+
+static void
+node_free(Nested__Node *node)
+{
+	Nested__Node *child;
+	size_t i;
+
+	while (node != NULL) {
+		for (i = 0; i < node->n_children; i++)
+			node_free(node->children[i]);
+		free(node->children);
+		child = node->child;
+		free(node);
+		node = child;
+	}
+}
+
+/* A chain of DEEP_DEPTH nodes, so length prefixes grow to three bytes. */
+static Nested__Node *
+build_deep(void)
+{
+	Nested__Node *root = node_new(0);
+	Nested__Node *node = root;
+	int i;
+
+	for (i = 1; i < DEEP_DEPTH; i++) {
+		node->child = node_new(-i);
+		node = node->child;
+	}
+	return root;
+}
+
+/* One node with WIDE_WIDTH children carrying payloads of varying length. */
+static Nested__Node *
+build_wide(void)
+{
+	static uint8_t payload[300];
+	Nested__Node *root = node_new(1);
+	size_t i;
+
+	memset(payload, 0xa5, sizeof(payload));
+	root->n_children = WIDE_WIDTH;
+	root->children = malloc(WIDE_WIDTH * sizeof(Nested__Node *));
+	assert(root->children != NULL);
+	for (i = 0; i < WIDE_WIDTH; i++) {
+		root->children[i] = node_new(i);
+		root->children[i]->has_payload = 1;
+		root->children[i]->payload.len = i % sizeof(payload);
+		root->children[i]->payload.data = payload;
+	}
+	return root;
+}
+
+/* A mix of the two: small fan-out at every level, some empty children. */
+static Nested__Node *
+build_mixed(unsigned depth)
+{
+	Nested__Node *node = node_new(depth * 1000);
+	size_t i;
+
+	if (depth == 0)
+		return node;
+	node->n_children = depth % 4;
+	node->children = calloc(node->n_children + 1, sizeof(Nested__Node *));
+	assert(node->children != NULL);
+	for (i = 0; i < node->n_children; i++)
+		node->children[i] = build_mixed(depth - 1 - i);
+	node->child = build_mixed(depth - 1);
+	node->child->has_value = 0;
+	return node;
+}
+
+static void
+check_pack(const Nested__Node *node)
+{
+	RefBuf ref = { NULL, 0, 0 };
+	uint8_t small[16];
+	ProtobufCBufferSimple simple = PROTOBUF_C_BUFFER_SIMPLE_INIT(small);
+	Nested__Node *unpacked;
+	uint8_t *out;
+	size_t len;
+
+	ref_node(&ref, node);
+
+	len = nested__node__get_packed_size(node);
+	assert(len == ref.len);
+
+	out = malloc(len + 1);
+	assert(out != NULL);
+	assert(nested__node__pack(node, out) == len);
+	assert(memcmp(out, ref.data, len) == 0);
+
+	assert(nested__node__pack_to_buffer(node, &simple.base) == len);
+	assert(simple.len == len);
+	assert(memcmp(simple.data, ref.data, len) == 0);
+	PROTOBUF_C_BUFFER_SIMPLE_CLEAR(&simple);
+
+	unpacked = nested__node__unpack(NULL, len, out);
+	assert(unpacked != NULL);
+	memset(out, 0, len);
+	assert(nested__node__pack(unpacked, out) == len);
+	assert(memcmp(out, ref.data, len) == 0);
+	nested__node__free_unpacked(unpacked, NULL);
+
+	free(out);
+	free(ref.data);
+}
+
+static void
+check_small(void)
+{
+	static const uint8_t expected[] = {
+		0x08, 0x01,			/* value = 1 */
+		0x12, 0x04,			/* child, 4 bytes */
+			0x1a, 0x02,		/* children[0], 2 bytes */
+				0x08, 0x03,	/* value = 3 */
+		0x1a, 0x00,			/* children[0], empty */
+	};
+	Nested__Node root = NESTED__NODE__INIT;
+	Nested__Node child = NESTED__NODE__INIT;
+	Nested__Node grandchild = NESTED__NODE__INIT;
+	Nested__Node empty = NESTED__NODE__INIT;
+	Nested__Node *child_children[] = { &grandchild };
+	Nested__Node *root_children[] = { &empty };
+	uint8_t out[sizeof(expected)];
+
+	root.has_value = 1;
+	root.value = 1;
+	root.child = &child;
+	root.n_children = 1;
+	root.children = root_children;
+	child.n_children = 1;
+	child.children = child_children;
+	grandchild.has_value = 1;
+	grandchild.value = 3;
+
+	assert(nested__node__get_packed_size(&root) == sizeof(expected));
+	assert(nested__node__pack(&root, out) == sizeof(expected));
+	assert(memcmp(out, expected, sizeof(expected)) == 0);
+	check_pack(&root);
+}
+
+static void
+bench(const char *name, const Nested__Node *node, unsigned iterations)
+{
+	size_t len = nested__node__get_packed_size(node);
+	uint8_t *out = malloc(len);
+	uint8_t scratch[256];
+	ProtobufCBufferSimple simple = PROTOBUF_C_BUFFER_SIMPLE_INIT(scratch);
+	clock_t start;
+	double pack_us;
+	unsigned i;
+
+	assert(out != NULL);
+	start = clock();
+	for (i = 0; i < iterations; i++) {
+		len = nested__node__get_packed_size(node);
+		nested__node__pack(node, out);
+	}
+	pack_us = (double) (clock() - start) * 1e6 / CLOCKS_PER_SEC / iterations;
+
+	/* The buffer keeps its allocation, as a reused output buffer would. */
+	start = clock();
+	for (i = 0; i < iterations; i++) {
+		simple.len = 0;
+		nested__node__pack_to_buffer(node, &simple.base);
+	}
+	assert(simple.len == len);
+	printf("%-6s %8zu bytes  %10.1f us/pack  %10.1f us/pack_to_buffer\n",
+	       name, len, pack_us,
+	       (double) (clock() - start) * 1e6 / CLOCKS_PER_SEC / iterations);
+	PROTOBUF_C_BUFFER_SIMPLE_CLEAR(&simple);
+	free(out);
+}
+
+int main(int argc, char **argv)
+{
+	Nested__Node *deep = build_deep();
+	Nested__Node *wide = build_wide();
+	Nested__Node *mixed = build_mixed(12);
+
+	check_small();
+	check_pack(deep);
+	check_pack(wide);
+	check_pack(mixed);
+
+	if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+		bench("deep", deep, 100);
+		bench("wide", wide, 100);
+		bench("mixed", mixed, 100);
+	}
+
+	node_free(deep);
+	node_free(wide);
+	node_free(mixed);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,665 @@
+/*
+ * Incremental unpacking with protobuf_c_stream_unpacker_feed(). Every corpus
+ * message is split at every byte boundary; the events are used to rebuild the
+ * message, which must pack back to the original bytes. Prefixes must be
+ * rejected exactly when protobuf_c_message_unpack() rejects them.
+ *
+ * Run with "--bench" to compare peak memory and latency with
+ * protobuf_c_message_unpack().
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "t/stream/stream.pb-c.h"
+
+#define BENCH_CHILDREN	200
+#define BENCH_CHUNK	256
+
+typedef struct {
+	uint8_t *data;
+	size_t len;
+	size_t alloced;
+} Log;
+
+static void
+log_put(Log *log, const void *data, size_t len)
+{
+	if (len == 0)
+		return;
+	if (log->len + len > log->alloced) {
+		log->alloced = (log->len + len) * 2;
+		log->data = realloc(log->data, log->alloced);
+		assert(log->data != NULL);
+	}
+	memcpy(log->data + log->len, data, len);
+	log->len += len;
+}
+
+static void
+log_field(Log *log, uint32_t tag, uint8_t wire_type)
+{
+	log_put(log, &tag, sizeof(tag));
+	log_put(log, &wire_type, sizeof(wire_type));
+}
+
+/* Rebuilds a message from stream events. */
+typedef struct {
+	ProtobufCMessage *stack[PROTOBUF_C_STREAM_MAX_DEPTH];
+	unsigned open;
+	unsigned n_events;
+	unsigned abort_at;
+	Log unknown;
+} Builder;
+
+static size_t
+elt_size(ProtobufCType type)
+{
+	switch (type) {
+	case PROTOBUF_C_TYPE_SINT64:
+	case PROTOBUF_C_TYPE_INT64:
+	case PROTOBUF_C_TYPE_UINT64:
+	case PROTOBUF_C_TYPE_SFIXED64:
+	case PROTOBUF_C_TYPE_FIXED64:
+	case PROTOBUF_C_TYPE_DOUBLE:
+		return 8;
+	case PROTOBUF_C_TYPE_BOOL:
+		return sizeof(protobuf_c_boolean);
+	case PROTOBUF_C_TYPE_STRING:
+	case PROTOBUF_C_TYPE_MESSAGE:
+		return sizeof(void *);
+	case PROTOBUF_C_TYPE_BYTES:
+		return sizeof(ProtobufCBinaryData);
+	default:
+		return 4;
+	}
+}
+
+static void *
+member_slot(ProtobufCMessage *message, const ProtobufCFieldDescriptor *field)
+{
+	uint8_t *member = (uint8_t *) message + field->offset;
+	size_t *n;
+	uint8_t *array;
+
+	if (field->label != PROTOBUF_C_LABEL_REPEATED) {
+		if (field->quantifier_offset != 0)
+			*(protobuf_c_boolean *) ((uint8_t *) message +
+				field->quantifier_offset) = 1;
+		return member;
+	}
+	n = (size_t *) ((uint8_t *) message + field->quantifier_offset);
+	array = realloc(*(void **) member, (*n + 1) * elt_size(field->type));
+	assert(array != NULL);
+	*(void **) member = array;
+	return array + (*n)++ * elt_size(field->type);
+}
+
+static protobuf_c_boolean
+build_event(const ProtobufCStreamEvent *event, void *user_data)
+{
+	Builder *b = user_data;
+	ProtobufCMessage *message = b->stack[event->depth];
+	const ProtobufCFieldDescriptor *field = event->field;
+
+	if (++b->n_events == b->abort_at)
+		return 0;
+	assert(message->descriptor == event->descriptor);
+
+	switch (event->type) {
+	case PROTOBUF_C_STREAM_EVENT_MESSAGE_BEGIN: {
+		const ProtobufCMessageDescriptor *desc = field->descriptor;
+		ProtobufCMessage *sub = malloc(desc->sizeof_message);
+
+		assert(b->open == event->depth);
+		assert(sub != NULL);
+		protobuf_c_message_init(desc, sub);
+		*(ProtobufCMessage **) member_slot(message, field) = sub;
+		b->stack[++b->open] = sub;
+		break;
+	}
+	case PROTOBUF_C_STREAM_EVENT_MESSAGE_END:
+		assert(b->open == event->depth + 1);
+		b->open--;
+		break;
+	case PROTOBUF_C_STREAM_EVENT_VALUE:
+		assert(b->open == event->depth);
+		memcpy(member_slot(message, field), event->value,
+		       elt_size(field->type));
+		break;
+	case PROTOBUF_C_STREAM_EVENT_DATA:
+		assert(b->open == event->depth);
+		assert(event->offset + event->data_len <= event->len);
+		if (field == NULL) {
+			if (event->offset == 0)
+				log_field(&b->unknown, event->tag,
+					  event->wire_type);
+			log_put(&b->unknown, event->data, event->data_len);
+		} else if (field->type == PROTOBUF_C_TYPE_STRING) {
+			char **str = (char **) ((uint8_t *) message +
+						field->offset);
+			if (event->offset == 0) {
+				*str = malloc(event->len + 1);
+				assert(*str != NULL);
+				(*str)[event->len] = 0;
+			}
+			memcpy(*str + event->offset, event->data,
+			       event->data_len);
+		} else {
+			ProtobufCBinaryData *bd;
+
+			if (event->offset == 0) {
+				bd = member_slot(message, field);
+				bd->len = event->len;
+				bd->data = event->len ? malloc(event->len) : NULL;
+			} else {
+				bd = (ProtobufCBinaryData *) ((uint8_t *) message +
+							      field->offset);
+			}
+			if (event->data_len != 0)
+				memcpy(bd->data + event->offset, event->data,
+				       event->data_len);
+		}
+		break;
+	}
+	return 1;
+}
+
+static ProtobufCMessage *
+builder_start(Builder *b, ProtobufCStreamUnpacker *unpacker,
+	      const ProtobufCMessageDescriptor *desc)
+{
+	memset(b, 0, sizeof(*b));
+	b->stack[0] = malloc(desc->sizeof_message);
+	assert(b->stack[0] != NULL);
+	protobuf_c_message_init(desc, b->stack[0]);
+	protobuf_c_stream_unpacker_init(unpacker, desc, build_event, b);
+	return b->stack[0];
+}
+
+/* Feed `data` in pieces ending at each of the `n_cuts` offsets in `cuts`. */
+static protobuf_c_boolean
+stream_cuts(ProtobufCStreamUnpacker *unpacker, const uint8_t *data, size_t len,
+	    const size_t *cuts, unsigned n_cuts)
+{
+	size_t at = 0;
+	unsigned i;
+
+	for (i = 0; i <= n_cuts; i++) {
+		size_t end = i < n_cuts ? cuts[i] : len;
+
+		if (!protobuf_c_stream_unpacker_feed(unpacker, end - at,
+						     data + at))
+			return 0;
+		at = end;
+	}
+	return protobuf_c_stream_unpacker_finish(unpacker);
+}
+
+static void
+check_rebuilt(const uint8_t *data, size_t len,
+	      const size_t *cuts, unsigned n_cuts)
+{
+	ProtobufCStreamUnpacker unpacker;
+	Builder b;
+	ProtobufCMessage *message;
+	uint8_t *out = malloc(len + 1);
+
+	assert(out != NULL);
+	message = builder_start(&b, &unpacker, &stream__record__descriptor);
+	assert(stream_cuts(&unpacker, data, len, cuts, n_cuts));
+	assert(b.open == 0);
+	assert(protobuf_c_message_get_packed_size(message) == len);
+	assert(protobuf_c_message_pack(message, out) == len);
+	assert(memcmp(out, data, len) == 0);
+	protobuf_c_message_free_unpacked(message, NULL);
+	free(b.unknown.data);
+	free(out);
+}
+
+static protobuf_c_boolean
+stream_valid(const ProtobufCMessageDescriptor *desc,
+	     const uint8_t *data, size_t len, protobuf_c_boolean bytewise)
+{
+	ProtobufCStreamUnpacker unpacker;
+	Builder b;
+	ProtobufCMessage *message = builder_start(&b, &unpacker, desc);
+	protobuf_c_boolean ok = 1;
+	size_t i;
+
+	if (bytewise) {
+		for (i = 0; i < len && ok; i++)
+			ok = protobuf_c_stream_unpacker_feed(&unpacker, 1,
+							     data + i);
+	} else {
+		ok = protobuf_c_stream_unpacker_feed(&unpacker, len, data);
+	}
+	ok = ok && protobuf_c_stream_unpacker_finish(&unpacker);
+	protobuf_c_message_free_unpacked(message, NULL);
+	free(b.unknown.data);
+	return ok;
+}
+
+static void
+check_record(const Stream__Record *record)
+{
+	size_t len = stream__record__get_packed_size(record);
+	uint8_t *data = malloc(len + 1);
+	size_t *cuts = malloc((len + 2) * sizeof(size_t));
+	size_t i, j;
+
+	assert(data != NULL && cuts != NULL);
+	assert(stream__record__pack(record, data) == len);
+
+	/* One chunk, two chunks split everywhere, then one byte at a time. */
+	check_rebuilt(data, len, NULL, 0);
+	for (i = 0; i <= len; i++)
+		check_rebuilt(data, len, &i, 1);
+	if (len <= 64) {
+		for (i = 0; i <= len; i++) {
+			for (j = i; j <= len; j++) {
+				cuts[0] = i;
+				cuts[1] = j;
+				check_rebuilt(data, len, cuts, 2);
+			}
+		}
+	}
+	for (i = 0; i < len; i++)
+		cuts[i] = i + 1;
+	check_rebuilt(data, len, cuts, len);
+
+	/* Truncated input. */
+	for (i = 0; i < len; i++) {
+		Stream__Record *m = stream__record__unpack(NULL, i, data);
+
+		assert(stream_valid(&stream__record__descriptor,
+				    data, i, 0) == (m != NULL));
+		stream__record__free_unpacked(m, NULL);
+	}
+
+	free(cuts);
+	free(data);
+}
+
+static void
+check_unknown(const Stream__Record *record)
+{
+	size_t len = stream__record__get_packed_size(record);
+	uint8_t *data = malloc(len);
+	Stream__Skinny *skinny;
+	Log expected = { NULL, 0, 0 };
+	size_t i;
+
+	assert(data != NULL);
+	stream__record__pack(record, data);
+	skinny = stream__skinny__unpack(NULL, len, data);
+	assert(skinny != NULL);
+	for (i = 0; i < skinny->base.n_unknown_fields; i++) {
+		const ProtobufCMessageUnknownField *uf =
+			skinny->base.unknown_fields + i;
+		size_t skip = 0;
+
+		/* Unknown length-prefixed fields keep their prefix. */
+		if (uf->wire_type == PROTOBUF_C_WIRE_TYPE_LENGTH_PREFIXED)
+			while (uf->data[skip++] & 0x80)
+				;
+		log_field(&expected, uf->tag, uf->wire_type);
+		log_put(&expected, uf->data + skip, uf->len - skip);
+	}
+
+	for (i = 0; i <= len; i++) {
+		ProtobufCStreamUnpacker unpacker;
+		Builder b;
+		Stream__Skinny *rebuilt = (Stream__Skinny *)
+			builder_start(&b, &unpacker,
+				      &stream__skinny__descriptor);
+
+		assert(stream_cuts(&unpacker, data, len, &i, 1));
+		assert(b.unknown.len == expected.len);
+		assert(memcmp(b.unknown.data, expected.data, expected.len) == 0);
+		assert(rebuilt->has_i32 == skinny->has_i32);
+		assert(rebuilt->i32 == skinny->i32);
+		stream__skinny__free_unpacked(rebuilt, NULL);
+		free(b.unknown.data);
+	}
+
+	stream__skinny__free_unpacked(skinny, NULL);
+	free(expected.data);
+	free(data);
+}
+
+static Stream__Record *
+build_chain(unsigned depth)
+{
+	Stream__Record *r = malloc(sizeof(*r));
+
+	assert(r != NULL);
+	stream__record__init(r);
+	r->has_i32 = 1;
+	r->i32 = depth;
+	if (depth > 0)
+		r->child = build_chain(depth - 1);
+	return r;
+}
+
+static void
+free_chain(Stream__Record *r)
+{
+	while (r != NULL) {
+		Stream__Record *child = r->child;
+
+		free(r);
+		r = child;
+	}
+}
+
+static void
+check_depth(void)
+{
+	/* The top-level message takes one frame. */
+	Stream__Record *fits = build_chain(PROTOBUF_C_STREAM_MAX_DEPTH - 1);
+	Stream__Record *too_deep = build_chain(PROTOBUF_C_STREAM_MAX_DEPTH);
+	size_t len = stream__record__get_packed_size(too_deep);
+	uint8_t *data = malloc(len);
+
+	assert(data != NULL);
+	len = stream__record__pack(fits, data);
+	assert(stream_valid(&stream__record__descriptor, data, len, 0));
+	assert(stream_valid(&stream__record__descriptor, data, len, 1));
+	len = stream__record__pack(too_deep, data);
+	assert(!stream_valid(&stream__record__descriptor, data, len, 0));
+	assert(!stream_valid(&stream__record__descriptor, data, len, 1));
+	free(data);
+	free_chain(fits);
+	free_chain(too_deep);
+}
+
+static void
+check_errors(void)
+{
+	static const struct {
+		const char *what;
+		size_t len;
+		uint8_t data[16];
+	} bad[] = {
+		{ "tag 0", 2, { 0x00, 0x01 } },
+		{ "group wire type", 2, { 0x0b, 0x01 } },
+		{ "overlong varint", 12, { 0x08, 0xff, 0xff, 0xff, 0xff, 0xff,
+					   0xff, 0xff, 0xff, 0xff, 0xff, 0x01 } },
+		{ "unterminated varint", 3, { 0x08, 0xff, 0xff } },
+		{ "int32 as length-prefixed", 3, { 0x0a, 0x01, 0x00 } },
+		{ "string as varint", 2, { 0x38, 0x01 } },
+		{ "fixed32 as varint", 2, { 0x18, 0x01 } },
+		{ "truncated fixed64", 5, { 0x21, 0x00, 0x00, 0x00, 0x00 } },
+		{ "truncated string", 4, { 0x3a, 0x05, 'a', 'b' } },
+		{ "truncated child", 4, { 0x62, 0x05, 0x08, 0x01 } },
+		{ "string past child", 4, { 0x62, 0x02, 0x3a, 0x05 } },
+		{ "value past child", 4, { 0x62, 0x01, 0x08, 0x01 } },
+		{ "tag past child", 4, { 0x62, 0x01, 0x80, 0x01 } },
+		{ "packed past end", 3, { 0x4a, 0x01, 0x80 } },
+		{ "huge length", 6, { 0x3a, 0xff, 0xff, 0xff, 0xff, 0x0f } },
+	};
+	static const uint8_t valid[] = { 0x08, 0x01 };
+	ProtobufCStreamUnpacker unpacker;
+	Builder b;
+	ProtobufCMessage *message;
+	unsigned i;
+
+	for (i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+		Stream__Record *m = stream__record__unpack(NULL, bad[i].len,
+							   bad[i].data);
+
+		if (m != NULL)
+			fprintf(stderr, "unpack accepted: %s\n", bad[i].what);
+		assert(m == NULL);
+		if (stream_valid(&stream__record__descriptor,
+				 bad[i].data, bad[i].len, 0) ||
+		    stream_valid(&stream__record__descriptor,
+				 bad[i].data, bad[i].len, 1))
+		{
+			fprintf(stderr, "stream accepted: %s\n", bad[i].what);
+			assert(0);
+		}
+	}
+
+	/* A failing callback stops unpacking for good. */
+	message = builder_start(&b, &unpacker, &stream__record__descriptor);
+	b.abort_at = 1;
+	assert(!protobuf_c_stream_unpacker_feed(&unpacker, sizeof(valid), valid));
+	assert(!protobuf_c_stream_unpacker_feed(&unpacker, sizeof(valid), valid));
+	assert(!protobuf_c_stream_unpacker_finish(&unpacker));
+	protobuf_c_message_free_unpacked(message, NULL);
+
+	/* Empty input is an empty message; empty chunks are fine. */
+	message = builder_start(&b, &unpacker, &stream__record__descriptor);
+	assert(protobuf_c_stream_unpacker_feed(&unpacker, 0, NULL));
+	assert(protobuf_c_stream_unpacker_feed(&unpacker, 1, valid));
+	assert(protobuf_c_stream_unpacker_feed(&unpacker, 0, NULL));
+	assert(!protobuf_c_stream_unpacker_finish(&unpacker));
+	protobuf_c_message_free_unpacked(message, NULL);
+	message = builder_start(&b, &unpacker, &stream__record__descriptor);
+	assert(protobuf_c_stream_unpacker_finish(&unpacker));
+	assert(b.n_events == 0);
+	protobuf_c_message_free_unpacked(message, NULL);
+}
+
+static void
+check_corpus(void)
+{
+	static int32_t packed_i32[] = { 0, 1, -1, 127, 128, 300, -2147483647 - 1 };
+	static uint64_t packed_f64[] = { 0, 1, UINT64_MAX };
+	static uint32_t plain_u32[] = { 1, 16384, UINT32_MAX };
+	static uint8_t blob[20000];
+	char name[301];
+	Stream__Record empty = STREAM__RECORD__INIT;
+	Stream__Record scalars = STREAM__RECORD__INIT;
+	Stream__Record arrays = STREAM__RECORD__INIT;
+	Stream__Record tree = STREAM__RECORD__INIT;
+	Stream__Record child = STREAM__RECORD__INIT;
+	Stream__Record kids[3] = {
+		STREAM__RECORD__INIT, STREAM__RECORD__INIT, STREAM__RECORD__INIT
+	};
+	Stream__Record *kid_ptrs[3] = { &kids[0], &kids[1], &kids[2] };
+	Stream__Record big = STREAM__RECORD__INIT;
+	unsigned i;
+
+	for (i = 0; i < sizeof(blob); i++)
+		blob[i] = i * 7;
+	memset(name, 'x', sizeof(name) - 1);
+	name[sizeof(name) - 1] = 0;
+
+	scalars.has_i32 = 1;
+	scalars.i32 = -5;
+	scalars.has_s64 = 1;
+	scalars.s64 = -1234567890123LL;
+	scalars.has_f32 = 1;
+	scalars.f32 = 0xdeadbeef;
+	scalars.has_dbl = 1;
+	scalars.dbl = 3.25;
+	scalars.has_flag = 1;
+	scalars.flag = 1;
+	scalars.has_kind = 1;
+	scalars.kind = STREAM__KIND__KIND_BRANCH;
+	scalars.name = "";
+	scalars.has_blob = 1;
+	scalars.has_u64 = 1;
+	scalars.u64 = UINT64_MAX;
+
+	arrays.n_packed_i32 = sizeof(packed_i32) / sizeof(packed_i32[0]);
+	arrays.packed_i32 = packed_i32;
+	arrays.n_packed_f64 = sizeof(packed_f64) / sizeof(packed_f64[0]);
+	arrays.packed_f64 = packed_f64;
+	arrays.n_plain_u32 = sizeof(plain_u32) / sizeof(plain_u32[0]);
+	arrays.plain_u32 = plain_u32;
+
+	child = arrays;
+	child.name = "child";
+	kids[0].name = "a";
+	kids[1] = scalars;
+	kids[2].child = &arrays;
+	kids[2].n_children = 1;
+	kids[2].children = kid_ptrs;
+	tree.has_i32 = 1;
+	tree.i32 = 1;
+	tree.child = &child;
+	tree.n_children = 3;
+	tree.children = kid_ptrs;
+	tree.has_u64 = 1;
+	tree.u64 = 2;
+
+	big.name = name;
+	big.has_blob = 1;
+	big.blob.len = sizeof(blob);
+	big.blob.data = blob;
+	big.child = &scalars;
+
+	check_record(&empty);
+	check_record(&scalars);
+	check_record(&arrays);
+	check_record(&tree);
+	check_record(&big);
+	check_unknown(&tree);
+	check_unknown(&big);
+}
+
+/* Allocator that tracks its peak usage. */
+typedef struct {
+	size_t now;
+	size_t peak;
+} Usage;
+
+static void *
+usage_alloc(void *allocator_data, size_t size)
+{
+	Usage *u = allocator_data;
+	size_t *p = malloc(sizeof(size_t) + size);
+
+	if (p == NULL)
+		return NULL;
+	*p = size;
+	u->now += size;
+	if (u->now > u->peak)
+		u->peak = u->now;
+	return p + 1;
+}
+
+static void
+usage_free(void *allocator_data, void *data)
+{
+	Usage *u = allocator_data;
+	size_t *p = (size_t *) data - 1;
+
+	u->now -= *p;
+	free(p);
+}
+
+static protobuf_c_boolean
+count_event(const ProtobufCStreamEvent *event, void *user_data)
+{
+	(*(unsigned *) user_data)++;
+	return 1;
+}
+
+static double
+elapsed_us(clock_t start, unsigned iterations)
+{
+	return (double) (clock() - start) * 1e6 / CLOCKS_PER_SEC / iterations;
+}
+
+static void
+bench(void)
+{
+	static Stream__Record kids[BENCH_CHILDREN];
+	static Stream__Record *kid_ptrs[BENCH_CHILDREN];
+	static int32_t values[16];
+	static uint8_t blob[128];
+	Stream__Record root = STREAM__RECORD__INIT;
+	Usage usage = { 0, 0 };
+	ProtobufCAllocator allocator = { usage_alloc, usage_free, &usage };
+	ProtobufCStreamUnpacker unpacker;
+	const unsigned iterations = 200;
+	unsigned n_events = 0;
+	uint8_t *data;
+	size_t len, at;
+	clock_t start;
+	double t_unpack, t_first, t_stream;
+	unsigned i;
+
+	for (i = 0; i < 16; i++)
+		values[i] = i * 1000;
+	for (i = 0; i < BENCH_CHILDREN; i++) {
+		stream__record__init(&kids[i]);
+		kids[i].has_i32 = 1;
+		kids[i].i32 = i;
+		kids[i].name = "0123456789abcdef0123456789abcdef";
+		kids[i].has_blob = 1;
+		kids[i].blob.len = sizeof(blob);
+		kids[i].blob.data = blob;
+		kids[i].n_packed_i32 = 16;
+		kids[i].packed_i32 = values;
+		kid_ptrs[i] = &kids[i];
+	}
+	root.n_children = BENCH_CHILDREN;
+	root.children = kid_ptrs;
+	len = stream__record__get_packed_size(&root);
+	data = malloc(len);
+	assert(data != NULL);
+	stream__record__pack(&root, data);
+
+	start = clock();
+	for (i = 0; i < iterations; i++) {
+		Stream__Record *m = stream__record__unpack(&allocator, len, data);
+
+		assert(m != NULL);
+		stream__record__free_unpacked(m, &allocator);
+	}
+	t_unpack = elapsed_us(start, iterations);
+
+	start = clock();
+	for (i = 0; i < iterations; i++) {
+		protobuf_c_stream_unpacker_init(&unpacker,
+			&stream__record__descriptor, count_event, &n_events);
+		assert(protobuf_c_stream_unpacker_feed(&unpacker,
+						       BENCH_CHUNK, data));
+	}
+	t_first = elapsed_us(start, iterations);
+
+	start = clock();
+	for (i = 0; i < iterations; i++) {
+		protobuf_c_stream_unpacker_init(&unpacker,
+			&stream__record__descriptor, count_event, &n_events);
+		for (at = 0; at < len; at += BENCH_CHUNK) {
+			size_t n = len - at < BENCH_CHUNK ? len - at : BENCH_CHUNK;
+
+			assert(protobuf_c_stream_unpacker_feed(&unpacker, n,
+							       data + at));
+		}
+		assert(protobuf_c_stream_unpacker_finish(&unpacker));
+	}
+	t_stream = elapsed_us(start, iterations);
+
+	printf("message %zu bytes, %u-byte chunks\n", len, BENCH_CHUNK);
+	printf("unpack: peak %zu bytes (buffer %zu + heap %zu), "
+	       "first field after %.1f us, done after %.1f us\n",
+	       len + usage.peak, len, usage.peak, t_unpack, t_unpack);
+	printf("stream: peak %zu bytes (chunk %u + unpacker %zu), "
+	       "first field after %.1f us, done after %.1f us\n",
+	       BENCH_CHUNK + sizeof(unpacker), BENCH_CHUNK, sizeof(unpacker),
+	       t_first, t_stream);
+	free(data);
+}
+
+int main(int argc, char **argv)
+{
+	check_corpus();
+	check_depth();
+	check_errors();
+
+	if (argc > 1 && strcmp(argv[1], "--bench") == 0)
+		bench();
+
+	return EXIT_SUCCESS;
+}
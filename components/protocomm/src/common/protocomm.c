@@ -375,8 +375,12 @@ static int protocomm_version_handler(uint32_t session_id,
         return ESP_OK;
     }
 
-    /* Output is a non null terminated string with length specified */
-    *outlen = strlen(pc->ver);
+    /* Output is a non null terminated string with length specified.
+     * The length is recorded once in protocomm_set_version() since
+     * clients tend to poll this endpoint while connecting.  The string
+     * is still copied, as the transport frees the response buffer of
+     * every endpoint once it is sent */
+    *outlen = pc->ver_len;
     *outbuf = malloc(*outlen);
     if (*outbuf == NULL) {
         ESP_LOGE(TAG, "Failed to allocate memory for version response");
@@ -402,6 +406,7 @@ esp_err_t protocomm_set_version(protocomm_t *pc, const char *ep_name, const char
         ESP_LOGE(TAG, "Error allocating version string");
         return ESP_ERR_NO_MEM;
     }
+    pc->ver_len = strlen(pc->ver);
 
     esp_err_t ret = protocomm_add_endpoint_internal(pc, ep_name,
                                                     protocomm_version_handler,
@@ -422,6 +427,7 @@ esp_err_t protocomm_unset_version(protocomm_t *pc, const char *ep_name)
     if (pc->ver) {
         free((char *)pc->ver);
         pc->ver = NULL;
+        pc->ver_len = 0;
     }
 
     return protocomm_remove_endpoint(pc, ep_name);
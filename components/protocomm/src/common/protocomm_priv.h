@@ -71,4 +71,7 @@ struct protocomm {
 
     /* Application specific version string */
     const char* ver;
+
+    /* Length of the version string, excluding the NUL terminator */
+    size_t ver_len;
 };
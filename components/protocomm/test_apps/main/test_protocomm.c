@@ -10,6 +10,8 @@
 #include <esp_err.h>
 #include <esp_log.h>
 #include <esp_system.h>
+#include <esp_timer.h>
+#include <esp_heap_caps.h>
 #include <sys/random.h>
 #include <unistd.h>
 #include <unity.h>
@@ -1115,6 +1117,125 @@ static esp_err_t test_security0 (void)
     return ESP_OK;
 }
 
+#define PERF_ITERATIONS 20
+
+typedef struct {
+    int64_t start_us;
+    int64_t version_us;
+    int64_t handshake_us;
+    int64_t request_us;
+    int64_t stop_us;
+    size_t  session_heap;
+} perf_stats_t;
+
+/* Runs one complete session, from service start to stop, accumulating the
+ * time spent in each stage along with the heap held by the live session */
+static esp_err_t test_perf_session(uint8_t sec_ver, const protocomm_security1_params_t *pop,
+                                   perf_stats_t *stats)
+{
+    session_t *session = calloc(1, sizeof(session_t));
+    if (session == NULL) {
+        ESP_LOGE(TAG, "Error allocating session");
+        return ESP_ERR_NO_MEM;
+    }
+
+    session->id        = 9;
+    session->sec_ver   = sec_ver;
+    session->pop       = pop;
+
+    size_t free_heap = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    int64_t t0 = esp_timer_get_time();
+    if (start_test_service(sec_ver, pop) != ESP_OK) {
+        ESP_LOGE(TAG, "Error starting test");
+        free(session);
+        return ESP_FAIL;
+    }
+    int64_t t1 = esp_timer_get_time();
+    if (test_ver_endpoint(session) != ESP_OK) {
+        ESP_LOGE(TAG, "Error testing version endpoint");
+        goto abort_perf_session;
+    }
+    int64_t t2 = esp_timer_get_time();
+    if (test_new_session(session) != ESP_OK ||
+        test_sec_endpoint(session) != ESP_OK) {
+        ESP_LOGE(TAG, "Error establishing session");
+        goto abort_perf_session;
+    }
+    int64_t t3 = esp_timer_get_time();
+    size_t session_heap = free_heap - heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    if (test_req_endpoint(session) != ESP_OK) {
+        ESP_LOGE(TAG, "Error testing request endpoint");
+        goto abort_perf_session;
+    }
+    int64_t t4 = esp_timer_get_time();
+    test_delete_session(session);
+    stop_test_service();
+    int64_t t5 = esp_timer_get_time();
+    free(session);
+
+    stats->start_us     += t1 - t0;
+    stats->version_us   += t2 - t1;
+    stats->handshake_us += t3 - t2;
+    stats->request_us   += t4 - t3;
+    stats->stop_us      += t5 - t4;
+    if (session_heap > stats->session_heap) {
+        stats->session_heap = session_heap;
+    }
+    return ESP_OK;
+
+abort_perf_session:
+    test_delete_session(session);
+    stop_test_service();
+    free(session);
+    return ESP_FAIL;
+}
+
+static esp_err_t test_perf(uint8_t sec_ver, const protocomm_security1_params_t *pop)
+{
+    perf_stats_t stats = { 0 };
+#ifdef CONFIG_HEAP_TRACING
+    heap_trace_summary_t summary;
+
+    heap_trace_init_standalone(trace_record, NUM_RECORDS);
+    heap_trace_start(HEAP_TRACE_ALL);
+#endif
+
+    /* Keep the per request hexdumps out of the measurement */
+    esp_log_level_set(TAG, ESP_LOG_WARN);
+    esp_err_t ret = ESP_OK;
+    int64_t begin = esp_timer_get_time();
+    for (int i = 0; i < PERF_ITERATIONS && ret == ESP_OK; i++) {
+        ret = test_perf_session(sec_ver, pop, &stats);
+    }
+    int64_t total_us = esp_timer_get_time() - begin;
+    esp_log_level_set(TAG, ESP_LOG_INFO);
+#ifdef CONFIG_HEAP_TRACING
+    /* Stopped before anything else, a failed session must not leave
+     * tracing running for the following test cases */
+    heap_trace_stop();
+#endif
+    if (ret != ESP_OK) {
+        return ESP_FAIL;
+    }
+
+    ESP_LOGI(TAG, "Security %d, %d sessions, average us per stage:", sec_ver, PERF_ITERATIONS);
+    ESP_LOGI(TAG, "  start     : %lld", stats.start_us / PERF_ITERATIONS);
+    ESP_LOGI(TAG, "  version   : %lld", stats.version_us / PERF_ITERATIONS);
+    ESP_LOGI(TAG, "  handshake : %lld", stats.handshake_us / PERF_ITERATIONS);
+    ESP_LOGI(TAG, "  request   : %lld", stats.request_us / PERF_ITERATIONS);
+    ESP_LOGI(TAG, "  stop      : %lld", stats.stop_us / PERF_ITERATIONS);
+    ESP_LOGI(TAG, "Peak heap held by a session : %u bytes", (unsigned) stats.session_heap);
+    ESP_LOGI(TAG, "Sessions per second         : %lld",
+             (int64_t) PERF_ITERATIONS * 1000000 / total_us);
+#ifdef CONFIG_HEAP_TRACING
+    if (heap_trace_summary(&summary) == ESP_OK) {
+        ESP_LOGI(TAG, "Allocations per session     : %u",
+                 (unsigned) (summary.total_allocations / PERF_ITERATIONS));
+    }
+#endif
+    return ESP_OK;
+}
+
 TEST_CASE("leak test", "[PROTOCOMM]")
 {
 #ifdef CONFIG_HEAP_TRACING
@@ -1191,6 +1312,18 @@ TEST_CASE("security 1 weak session test", "[PROTOCOMM]")
     TEST_ASSERT(test_security1_weak_session() == ESP_OK);
 }
 
+TEST_CASE("session throughput", "[PROTOCOMM][perf]")
+{
+    const char *pop_data = "test pop";
+    protocomm_security1_params_t pop = {
+        .data = (const uint8_t *)pop_data,
+        .len  = strlen(pop_data)
+    };
+
+    TEST_ASSERT(test_perf(0, NULL) == ESP_OK);
+    TEST_ASSERT(test_perf(1, &pop) == ESP_OK);
+}
+
 void app_main(void)
 {
     unity_run_menu();
@@ -0,0 +1,458 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <esp_log.h>
+#include <esp_random.h>
+#include <mbedtls/sha512.h>
+
+#include <protocomm_security.h>
+#include <protocomm_security2.h>
+
+#include "session.pb-c.h"
+#include "sec2.pb-c.h"
+#include "sec2_client.h"
+
+static const char *TAG = "sec2_client";
+
+/* RFC 5054 3072-bit group, same as esp_srp.c */
+static const char N_3072_HEX[] =
+    "FFFFFFFFFFFFFFFFC90FDAA22168C234C4C6628B80DC1CD129024E088A67CC74"
+    "020BBEA63B139B22514A08798E3404DDEF9519B3CD3A431B302B0A6DF25F1437"
+    "4FE1356D6D51C245E485B576625E7EC6F44C42E9A637ED6B0BFF5CB6F406B7ED"
+    "EE386BFB5A899FA5AE9F24117C4B1FE649286651ECE45B3DC2007CB8A163BF05"
+    "98DA48361C55D39A69163FA8FD24CF5F83655D23DCA3AD961C62F356208552BB"
+    "9ED529077096966D670C354E4ABC9804F1746C08CA18217C32905E462E36CE3B"
+    "E39E772C180E86039B2783A2EC07A28FB5C55DF06F4C52C9DE2BCBF695581718"
+    "3995497CEA956AE515D2261898FA051015728E5A8AAAC42DAD33170D04507A33"
+    "A85521ABDF1CBA64ECFB850458DBEF0A8AEA71575D060C7DB3970F85A6E1E4C7"
+    "ABF5AE8CDB0933D71E8C94E04A25619DCEE3D2261AD2EE6BF12FFA06D98A0864"
+    "D87602733EC86A64521F2B18177B200CBBE117577A615D6C770988C0BAD946E2"
+    "08E24FA074E5AB3143DB5BFCE0FD108E4B82D120A93AD2CAFFFFFFFFFFFFFFFF";
+#define SRP_G       5
+
+static int client_rng(void *ctx, unsigned char *buf, size_t len)
+{
+    esp_fill_random(buf, len);
+    return 0;
+}
+
+/* H(a | b), either of which may be absent */
+static void hash2(const uint8_t *a, size_t a_len, const uint8_t *b, size_t b_len, uint8_t *out)
+{
+    mbedtls_sha512_context ctx;
+
+    mbedtls_sha512_init(&ctx);
+    mbedtls_sha512_starts(&ctx, 0);
+    mbedtls_sha512_update(&ctx, a, a_len);
+    mbedtls_sha512_update(&ctx, b, b_len);
+    mbedtls_sha512_finish(&ctx, out);
+    mbedtls_sha512_free(&ctx);
+}
+
+/* x = H(salt | H(username ":" password)) */
+static int calculate_x(mbedtls_mpi *x, const char *username, const char *password,
+                       const uint8_t *salt, size_t salt_len)
+{
+    mbedtls_sha512_context ctx;
+    uint8_t digest[SEC2_CLIENT_HASH_LEN];
+
+    mbedtls_sha512_init(&ctx);
+    mbedtls_sha512_starts(&ctx, 0);
+    mbedtls_sha512_update(&ctx, (const uint8_t *) username, strlen(username));
+    mbedtls_sha512_update(&ctx, (const uint8_t *) ":", 1);
+    mbedtls_sha512_update(&ctx, (const uint8_t *) password, strlen(password));
+    mbedtls_sha512_finish(&ctx, digest);
+    mbedtls_sha512_free(&ctx);
+
+    hash2(salt, salt_len, digest, sizeof(digest), digest);
+    return mbedtls_mpi_read_binary(x, digest, sizeof(digest));
+}
+
+static int load_group(mbedtls_mpi *n, mbedtls_mpi *g)
+{
+    int ret = mbedtls_mpi_read_string(n, 16, N_3072_HEX);
+    if (ret == 0) {
+        ret = mbedtls_mpi_lset(g, SRP_G);
+    }
+    return ret;
+}
+
+esp_err_t sec2_client_verifier(const char *username, const char *password,
+                               const uint8_t *salt, size_t salt_len,
+                               uint8_t *verifier, size_t *verifier_len)
+{
+    mbedtls_mpi n, g, x, v;
+    int ret;
+
+    mbedtls_mpi_init(&n);
+    mbedtls_mpi_init(&g);
+    mbedtls_mpi_init(&x);
+    mbedtls_mpi_init(&v);
+
+    ret = load_group(&n, &g);
+    if (ret == 0) {
+        ret = calculate_x(&x, username, password, salt, salt_len);
+    }
+    if (ret == 0) {
+        ret = mbedtls_mpi_exp_mod(&v, &g, &x, &n, NULL);
+    }
+    if (ret == 0) {
+        *verifier_len = mbedtls_mpi_size(&v);
+        ret = mbedtls_mpi_write_binary(&v, verifier, *verifier_len);
+    }
+
+    mbedtls_mpi_free(&n);
+    mbedtls_mpi_free(&g);
+    mbedtls_mpi_free(&x);
+    mbedtls_mpi_free(&v);
+    return ret == 0 ? ESP_OK : ESP_FAIL;
+}
+
+/* Sends one SessionData message to the security endpoint and returns the
+ * unpacked response, which the caller frees */
+static SessionData *exchange(protocomm_t *pc, const char *ep_name, uint32_t session_id,
+                             Sec2Payload *payload)
+{
+    SessionData req;
+    SessionData *resp;
+    uint8_t *outbuf = NULL;
+    ssize_t outlen = 0;
+
+    session_data__init(&req);
+    req.sec_ver = protocomm_security2.ver;
+    req.proto_case = SESSION_DATA__PROTO_SEC2;
+    req.sec2 = payload;
+
+    size_t inlen = session_data__get_packed_size(&req);
+    uint8_t *inbuf = malloc(inlen);
+    if (!inbuf) {
+        ESP_LOGE(TAG, "Failed to allocate inbuf");
+        return NULL;
+    }
+    session_data__pack(&req, inbuf);
+
+    esp_err_t ret = protocomm_req_handle(pc, ep_name, session_id, inbuf, inlen, &outbuf, &outlen);
+    free(inbuf);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "%s handler failed", ep_name);
+        free(outbuf);
+        return NULL;
+    }
+
+    resp = session_data__unpack(NULL, outlen, outbuf);
+    free(outbuf);
+    if (resp && resp->proto_case != SESSION_DATA__PROTO_SEC2) {
+        ESP_LOGE(TAG, "Invalid response type");
+        session_data__free_unpacked(resp, NULL);
+        return NULL;
+    }
+    return resp;
+}
+
+/* Derives the session key from the device public key B and salt, and
+ * writes the client proof M */
+static int calculate_key_and_proof(sec2_client_t *client, const uint8_t *bytes_B, size_t len_B,
+                                   const uint8_t *salt, size_t salt_len, uint8_t *proof)
+{
+    mbedtls_mpi n, g, k, u, x, B, t, e, S;
+    mbedtls_sha512_context ctx;
+    uint8_t pad[SEC2_CLIENT_KEY_LEN];
+    uint8_t digest[SEC2_CLIENT_HASH_LEN];
+    uint8_t hash_g[SEC2_CLIENT_HASH_LEN];
+    uint8_t *bytes_S = NULL;
+    int ret;
+
+    mbedtls_mpi_init(&n);
+    mbedtls_mpi_init(&g);
+    mbedtls_mpi_init(&k);
+    mbedtls_mpi_init(&u);
+    mbedtls_mpi_init(&x);
+    mbedtls_mpi_init(&B);
+    mbedtls_mpi_init(&t);
+    mbedtls_mpi_init(&e);
+    mbedtls_mpi_init(&S);
+
+    ret = load_group(&n, &g);
+    if (ret != 0) {
+        goto exit;
+    }
+
+    /* k = H(N | PAD(g)) */
+    uint8_t bytes_N[SEC2_CLIENT_KEY_LEN];
+    mbedtls_mpi_write_binary(&n, bytes_N, sizeof(bytes_N));
+    mbedtls_mpi_write_binary(&g, pad, sizeof(pad));
+    hash2(bytes_N, sizeof(bytes_N), pad, sizeof(pad), digest);
+    mbedtls_mpi_read_binary(&k, digest, sizeof(digest));
+
+    /* u = H(PAD(A) | PAD(B)) */
+    if (len_B > sizeof(pad)) {
+        ret = -1;
+        goto exit;
+    }
+    memset(pad, 0, sizeof(pad) - len_B);
+    memcpy(pad + sizeof(pad) - len_B, bytes_B, len_B);
+    hash2(client->pubkey, sizeof(client->pubkey), pad, sizeof(pad), digest);
+    mbedtls_mpi_read_binary(&u, digest, sizeof(digest));
+
+    /* S = (B - k * g^x) ^ (a + u * x) */
+    ret = calculate_x(&x, client->username, client->password, salt, salt_len);
+    if (ret == 0) {
+        ret = mbedtls_mpi_read_binary(&B, bytes_B, len_B);
+    }
+    if (ret == 0) {
+        ret = mbedtls_mpi_exp_mod(&t, &g, &x, &n, NULL);
+    }
+    if (ret == 0) {
+        ret = mbedtls_mpi_mul_mpi(&t, &t, &k);
+    }
+    if (ret == 0) {
+        ret = mbedtls_mpi_sub_mpi(&t, &B, &t);
+    }
+    if (ret == 0) {
+        ret = mbedtls_mpi_mod_mpi(&t, &t, &n);
+    }
+    if (ret == 0) {
+        ret = mbedtls_mpi_mul_mpi(&e, &u, &x);
+    }
+    if (ret == 0) {
+        ret = mbedtls_mpi_add_mpi(&e, &e, &client->a);
+    }
+    if (ret == 0) {
+        ret = mbedtls_mpi_exp_mod(&S, &t, &e, &n, NULL);
+    }
+    if (ret != 0) {
+        goto exit;
+    }
+
+    /* K = H(S), S without leading zeroes as the device does */
+    size_t len_S = mbedtls_mpi_size(&S);
+    bytes_S = malloc(len_S);
+    if (!bytes_S) {
+        ret = -1;
+        goto exit;
+    }
+    mbedtls_mpi_write_binary(&S, bytes_S, len_S);
+    hash2(bytes_S, len_S, NULL, 0, client->session_key);
+
+    /* M = H(H(N) ^ H(PAD(g)) | H(I) | salt | A | B | K) */
+    hash2(bytes_N, sizeof(bytes_N), NULL, 0, digest);
+    mbedtls_mpi_write_binary(&g, pad, sizeof(pad));
+    hash2(pad, sizeof(pad), NULL, 0, hash_g);
+    for (int i = 0; i < SEC2_CLIENT_HASH_LEN; i++) {
+        digest[i] ^= hash_g[i];
+    }
+    hash2((const uint8_t *) client->username, strlen(client->username), NULL, 0, hash_g);
+
+    mbedtls_sha512_init(&ctx);
+    mbedtls_sha512_starts(&ctx, 0);
+    mbedtls_sha512_update(&ctx, digest, sizeof(digest));
+    mbedtls_sha512_update(&ctx, hash_g, sizeof(hash_g));
+    mbedtls_sha512_update(&ctx, salt, salt_len);
+    mbedtls_sha512_update(&ctx, client->pubkey, sizeof(client->pubkey));
+    mbedtls_sha512_update(&ctx, bytes_B, len_B);
+    mbedtls_sha512_update(&ctx, client->session_key, sizeof(client->session_key));
+    mbedtls_sha512_finish(&ctx, proof);
+    mbedtls_sha512_free(&ctx);
+
+exit:
+    free(bytes_S);
+    mbedtls_mpi_free(&n);
+    mbedtls_mpi_free(&g);
+    mbedtls_mpi_free(&k);
+    mbedtls_mpi_free(&u);
+    mbedtls_mpi_free(&x);
+    mbedtls_mpi_free(&B);
+    mbedtls_mpi_free(&t);
+    mbedtls_mpi_free(&e);
+    mbedtls_mpi_free(&S);
+    return ret;
+}
+
+esp_err_t sec2_client_handshake(sec2_client_t *client, protocomm_t *pc,
+                                const char *ep_name, uint32_t session_id)
+{
+    mbedtls_mpi n, g, A;
+    Sec2Payload payload;
+    SessionData *resp = NULL;
+    uint8_t proof[SEC2_CLIENT_HASH_LEN];
+    uint8_t expected[SEC2_CLIENT_HASH_LEN];
+    esp_err_t err = ESP_FAIL;
+    int ret;
+
+    client->established = false;
+    mbedtls_mpi_init(&client->a);
+    mbedtls_gcm_init(&client->ctx_gcm);
+    mbedtls_mpi_init(&n);
+    mbedtls_mpi_init(&g);
+    mbedtls_mpi_init(&A);
+
+    /* a = 256 bit random value, A = g^a */
+    ret = load_group(&n, &g);
+    if (ret == 0) {
+        ret = mbedtls_mpi_fill_random(&client->a, 32, client_rng, NULL);
+    }
+    if (ret == 0) {
+        ret = mbedtls_mpi_exp_mod(&A, &g, &client->a, &n, NULL);
+    }
+    if (ret == 0) {
+        ret = mbedtls_mpi_write_binary(&A, client->pubkey, sizeof(client->pubkey));
+    }
+    mbedtls_mpi_free(&n);
+    mbedtls_mpi_free(&g);
+    mbedtls_mpi_free(&A);
+    if (ret != 0) {
+        ESP_LOGE(TAG, "Failed to generate client key pair: %d", ret);
+        return ESP_FAIL;
+    }
+
+    /*********** Transaction0 = SessionCmd0 + SessionResp0 ****************/
+    S2SessionCmd0 cmd0;
+    s2_session_cmd0__init(&cmd0);
+    cmd0.client_username.data = (uint8_t *) client->username;
+    cmd0.client_username.len = strlen(client->username);
+    cmd0.client_pubkey.data = client->pubkey;
+    cmd0.client_pubkey.len = sizeof(client->pubkey);
+
+    sec2_payload__init(&payload);
+    payload.msg = SEC2_MSG_TYPE__S2Session_Command0;
+    payload.payload_case = SEC2_PAYLOAD__PAYLOAD_SC0;
+    payload.sc0 = &cmd0;
+
+    resp = exchange(pc, ep_name, session_id, &payload);
+    if (!resp || resp->sec2->payload_case != SEC2_PAYLOAD__PAYLOAD_SR0 ||
+        resp->sec2->sr0->status != STATUS__Success) {
+        ESP_LOGE(TAG, "Invalid response 0");
+        goto exit;
+    }
+
+    S2SessionResp0 *resp0 = resp->sec2->sr0;
+    ret = calculate_key_and_proof(client, resp0->device_pubkey.data, resp0->device_pubkey.len,
+                                  resp0->device_salt.data, resp0->device_salt.len, proof);
+    if (ret != 0) {
+        ESP_LOGE(TAG, "Failed to derive session key: %d", ret);
+        goto exit;
+    }
+    session_data__free_unpacked(resp, NULL);
+
+    /*********** Transaction1 = SessionCmd1 + SessionResp1 ****************/
+    S2SessionCmd1 cmd1;
+    s2_session_cmd1__init(&cmd1);
+    cmd1.client_proof.data = proof;
+    cmd1.client_proof.len = sizeof(proof);
+
+    sec2_payload__init(&payload);
+    payload.msg = SEC2_MSG_TYPE__S2Session_Command1;
+    payload.payload_case = SEC2_PAYLOAD__PAYLOAD_SC1;
+    payload.sc1 = &cmd1;
+
+    resp = exchange(pc, ep_name, session_id, &payload);
+    if (!resp || resp->sec2->payload_case != SEC2_PAYLOAD__PAYLOAD_SR1 ||
+        resp->sec2->sr1->status != STATUS__Success) {
+        ESP_LOGE(TAG, "Invalid response 1");
+        goto exit;
+    }
+
+    /* The device proves it holds the same key with H(A | M | K) */
+    S2SessionResp1 *resp1 = resp->sec2->sr1;
+    mbedtls_sha512_context ctx;
+    mbedtls_sha512_init(&ctx);
+    mbedtls_sha512_starts(&ctx, 0);
+    mbedtls_sha512_update(&ctx, client->pubkey, sizeof(client->pubkey));
+    mbedtls_sha512_update(&ctx, proof, sizeof(proof));
+    mbedtls_sha512_update(&ctx, client->session_key, sizeof(client->session_key));
+    mbedtls_sha512_finish(&ctx, expected);
+    mbedtls_sha512_free(&ctx);
+
+    if (resp1->device_proof.len != sizeof(expected) ||
+        memcmp(resp1->device_proof.data, expected, sizeof(expected)) != 0) {
+        ESP_LOGE(TAG, "Device proof mismatch");
+        goto exit;
+    }
+    if (resp1->device_nonce.len != sizeof(client->iv)) {
+        ESP_LOGE(TAG, "Invalid device nonce length");
+        goto exit;
+    }
+    memcpy(client->iv, resp1->device_nonce.data, sizeof(client->iv));
+
+    /* AES-256-GCM with the first half of K */
+    ret = mbedtls_gcm_setkey(&client->ctx_gcm, MBEDTLS_CIPHER_ID_AES, client->session_key, 256);
+    if (ret != 0) {
+        ESP_LOGE(TAG, "Failed at mbedtls_gcm_setkey with error code : %d", ret);
+        goto exit;
+    }
+    client->established = true;
+    err = ESP_OK;
+
+exit:
+    if (resp) {
+        session_data__free_unpacked(resp, NULL);
+    }
+    return err;
+}
+
+esp_err_t sec2_client_encrypt(sec2_client_t *client, const uint8_t *inbuf, ssize_t inlen,
+                              uint8_t **outbuf, ssize_t *outlen)
+{
+    if (!client->established) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    *outlen = inlen + SEC2_CLIENT_TAG_LEN;
+    *outbuf = malloc(*outlen);
+    if (!*outbuf) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    int ret = mbedtls_gcm_crypt_and_tag(&client->ctx_gcm, MBEDTLS_GCM_ENCRYPT, inlen,
+                                        client->iv, sizeof(client->iv), NULL, 0, inbuf,
+                                        *outbuf, SEC2_CLIENT_TAG_LEN, *outbuf + inlen);
+    if (ret != 0) {
+        ESP_LOGE(TAG, "Failed at mbedtls_gcm_crypt_and_tag with error code : %d", ret);
+        free(*outbuf);
+        *outbuf = NULL;
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t sec2_client_decrypt(sec2_client_t *client, const uint8_t *inbuf, ssize_t inlen,
+                              uint8_t **outbuf, ssize_t *outlen)
+{
+    if (!client->established) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (inlen < SEC2_CLIENT_TAG_LEN) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    *outlen = inlen - SEC2_CLIENT_TAG_LEN;
+    /* Keep a valid pointer for empty responses */
+    *outbuf = malloc(*outlen + 1);
+    if (!*outbuf) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    int ret = mbedtls_gcm_auth_decrypt(&client->ctx_gcm, *outlen, client->iv, sizeof(client->iv),
+                                       NULL, 0, inbuf + *outlen, SEC2_CLIENT_TAG_LEN,
+                                       inbuf, *outbuf);
+    if (ret != 0) {
+        ESP_LOGE(TAG, "Failed at mbedtls_gcm_auth_decrypt : %d", ret);
+        free(*outbuf);
+        *outbuf = NULL;
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+void sec2_client_free(sec2_client_t *client)
+{
+    mbedtls_mpi_free(&client->a);
+    mbedtls_gcm_free(&client->ctx_gcm);
+    memset(client->session_key, 0, sizeof(client->session_key));
+    client->established = false;
+}
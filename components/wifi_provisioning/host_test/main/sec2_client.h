@@ -0,0 +1,84 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <esp_err.h>
+#include <mbedtls/bignum.h>
+#include <mbedtls/gcm.h>
+#include <protocomm.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SEC2_CLIENT_KEY_LEN     384
+#define SEC2_CLIENT_HASH_LEN    64
+#define SEC2_CLIENT_IV_LEN      16
+#define SEC2_CLIENT_TAG_LEN     16
+
+/**
+ * @brief   Client (phone app) side of a protocomm security 2 session
+ *
+ * SRP6a over the RFC 5054 3072-bit group with SHA-512, followed by
+ * AES-256-GCM with the nonce sent by the device.
+ */
+typedef struct {
+    const char *username;
+    const char *password;
+    mbedtls_mpi a;
+    uint8_t pubkey[SEC2_CLIENT_KEY_LEN];
+    uint8_t session_key[SEC2_CLIENT_HASH_LEN];
+    uint8_t iv[SEC2_CLIENT_IV_LEN];
+    mbedtls_gcm_context ctx_gcm;
+    bool established;
+} sec2_client_t;
+
+/**
+ * @brief   Compute the verifier v = g^x the device stores for a username,
+ *          password and salt, x = H(salt | H(username ":" password))
+ *
+ * @param[out] verifier     Buffer of SEC2_CLIENT_KEY_LEN bytes
+ * @param[out] verifier_len Length of the verifier, without leading zeroes
+ */
+esp_err_t sec2_client_verifier(const char *username, const char *password,
+                               const uint8_t *salt, size_t salt_len,
+                               uint8_t *verifier, size_t *verifier_len);
+
+/**
+ * @brief   Run both handshake messages against the security endpoint
+ *          of a protocomm instance
+ *
+ * sec2_client_free() must be called afterwards, even on failure.
+ */
+esp_err_t sec2_client_handshake(sec2_client_t *client, protocomm_t *pc,
+                                const char *ep_name, uint32_t session_id);
+
+/**
+ * @brief   Encrypt a request, the output holds the ciphertext followed
+ *          by the tag and must be freed by the caller
+ */
+esp_err_t sec2_client_encrypt(sec2_client_t *client, const uint8_t *inbuf, ssize_t inlen,
+                              uint8_t **outbuf, ssize_t *outlen);
+
+/**
+ * @brief   Check and decrypt a response, the output must be freed by
+ *          the caller
+ */
+esp_err_t sec2_client_decrypt(sec2_client_t *client, const uint8_t *inbuf, ssize_t inlen,
+                              uint8_t **outbuf, ssize_t *outlen);
+
+/**
+ * @brief   Release the keys held by a client
+ */
+void sec2_client_free(sec2_client_t *client);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,857 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <malloc.h>
+#include <time.h>
+#include <sys/types.h>
+#include <esp_err.h>
+#include <esp_event.h>
+#include <esp_random.h>
+#include "unity.h"
+#include "unity_fixture.h"
+
+#include <protocomm.h>
+#include <protocomm_security.h>
+#include <protocomm_security0.h>
+#include <protocomm_security2.h>
+#include <wifi_provisioning/wifi_config.h>
+#include <wifi_provisioning/wifi_scan.h>
+#include "wifi_ctrl.h"
+
+#include "session.pb-c.h"
+#include "sec0.pb-c.h"
+#include "wifi_config.pb-c.h"
+#include "wifi_scan.pb-c.h"
+#include "wifi_ctrl.pb-c.h"
+#include "sec2_client.h"
+
+#define TEST_USERNAME       "wifiprov"
+#define TEST_PASSWORD       "abcd1234"
+#define TEST_VER_STR        "{\"prov\":{\"ver\":\"v1.1\",\"cap\":[\"wifi_scan\"]}}"
+#define TEST_SCAN_APS       20
+#define TEST_SCAN_PAGE      4
+#define TEST_DATA_LEN       512
+#define PERF_ITERATIONS     20
+
+typedef struct {
+    uint32_t id;
+    uint8_t sec_ver;
+    sec2_client_t sec2;
+} test_client_t;
+
+static protocomm_t *test_pc;
+static uint8_t test_salt[16];
+static uint8_t test_verifier[SEC2_CLIENT_KEY_LEN];
+static protocomm_security2_params_t test_sec2_params;
+
+/* Stand-ins for the handlers wifi_prov_mgr registers, recording what the
+ * endpoints pass to them */
+static struct {
+    wifi_prov_config_set_data_t config;
+    int set_calls;
+    int apply_calls;
+    bool scan_blocking;
+    uint32_t scan_period_ms;
+    int scan_starts;
+    int resets;
+    int reprovs;
+} test_rec;
+
+static esp_err_t test_get_status(wifi_prov_config_get_data_t *resp_data, wifi_prov_ctx_t **ctx)
+{
+    memset(resp_data, 0, sizeof(*resp_data));
+    resp_data->wifi_state = WIFI_PROV_STA_CONNECTED;
+    strcpy(resp_data->conn_info.ip_addr, "192.168.4.2");
+    memcpy(resp_data->conn_info.bssid, test_rec.config.bssid, sizeof(resp_data->conn_info.bssid));
+    strcpy(resp_data->conn_info.ssid, test_rec.config.ssid);
+    resp_data->conn_info.channel = test_rec.config.channel;
+    resp_data->conn_info.auth_mode = WIFI_AUTH_WPA2_PSK;
+    return ESP_OK;
+}
+
+static esp_err_t test_set_config(const wifi_prov_config_set_data_t *req_data, wifi_prov_ctx_t **ctx)
+{
+    test_rec.config = *req_data;
+    test_rec.set_calls++;
+    return ESP_OK;
+}
+
+static esp_err_t test_apply_config(wifi_prov_ctx_t **ctx)
+{
+    test_rec.apply_calls++;
+    return ESP_OK;
+}
+
+static esp_err_t test_scan_start(bool blocking, bool passive, uint8_t group_channels,
+                                 uint32_t period_ms, wifi_prov_scan_ctx_t **ctx)
+{
+    test_rec.scan_blocking = blocking;
+    test_rec.scan_period_ms = period_ms;
+    test_rec.scan_starts++;
+    return ESP_OK;
+}
+
+static esp_err_t test_scan_status(bool *scan_finished, uint16_t *result_count,
+                                  wifi_prov_scan_ctx_t **ctx)
+{
+    *scan_finished = true;
+    *result_count = TEST_SCAN_APS;
+    return ESP_OK;
+}
+
+static esp_err_t test_scan_result(uint16_t result_index, wifi_prov_scan_result_t *result,
+                                  wifi_prov_scan_ctx_t **ctx)
+{
+    if (result_index >= TEST_SCAN_APS) {
+        return ESP_FAIL;
+    }
+    memset(result, 0, sizeof(*result));
+    snprintf(result->ssid, sizeof(result->ssid), "ap-%02u", result_index);
+    memset(result->bssid, result_index, sizeof(result->bssid));
+    result->channel = 1 + result_index % 13;
+    result->rssi = -40 - result_index;
+    result->auth = WIFI_AUTH_WPA2_PSK;
+    return ESP_OK;
+}
+
+static esp_err_t test_ctrl_reset(void)
+{
+    test_rec.resets++;
+    return ESP_OK;
+}
+
+static esp_err_t test_ctrl_reprov(void)
+{
+    test_rec.reprovs++;
+    return ESP_OK;
+}
+
+static wifi_prov_config_handlers_t test_config_handlers = {
+    .get_status_handler = test_get_status,
+    .set_config_handler = test_set_config,
+    .apply_config_handler = test_apply_config,
+};
+
+static wifi_prov_scan_handlers_t test_scan_handlers = {
+    .scan_start = test_scan_start,
+    .scan_status = test_scan_status,
+    .scan_result = test_scan_result,
+};
+
+static wifi_ctrl_handlers_t test_ctrl_handlers = {
+    .ctrl_reset = test_ctrl_reset,
+    .ctrl_reprov = test_ctrl_reprov,
+};
+
+static esp_err_t test_echo_handler(uint32_t session_id, const uint8_t *inbuf, ssize_t inlen,
+                                   uint8_t **outbuf, ssize_t *outlen, void *priv_data)
+{
+    *outbuf = malloc(inlen);
+    if (!*outbuf) {
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(*outbuf, inbuf, inlen);
+    *outlen = inlen;
+    return ESP_OK;
+}
+
+/* Registers the same endpoints as wifi_prov_mgr_start_provisioning(), with
+ * the recording handlers above */
+static esp_err_t start_service(uint8_t sec_ver)
+{
+    esp_err_t ret;
+
+    test_pc = protocomm_new();
+    if (!test_pc) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (sec_ver == 0) {
+        ret = protocomm_set_security(test_pc, "prov-session", &protocomm_security0, NULL);
+    } else {
+        ret = protocomm_set_security(test_pc, "prov-session", &protocomm_security2, &test_sec2_params);
+    }
+    if (ret == ESP_OK) {
+        ret = protocomm_set_version(test_pc, "proto-ver", TEST_VER_STR);
+    }
+    if (ret == ESP_OK) {
+        ret = protocomm_add_endpoint(test_pc, "prov-config", wifi_prov_config_data_handler,
+                                     &test_config_handlers);
+    }
+    if (ret == ESP_OK) {
+        ret = protocomm_add_endpoint(test_pc, "prov-scan", wifi_prov_scan_handler,
+                                     &test_scan_handlers);
+    }
+    if (ret == ESP_OK) {
+        ret = protocomm_add_endpoint(test_pc, "prov-ctrl", wifi_ctrl_handler,
+                                     &test_ctrl_handlers);
+    }
+    if (ret == ESP_OK) {
+        ret = protocomm_add_endpoint(test_pc, "custom-data", test_echo_handler, NULL);
+    }
+    if (ret != ESP_OK) {
+        protocomm_delete(test_pc);
+        test_pc = NULL;
+    }
+    return ret;
+}
+
+static void stop_service(void)
+{
+    protocomm_delete(test_pc);
+    test_pc = NULL;
+}
+
+static esp_err_t sec0_handshake(test_client_t *client)
+{
+    S0SessionCmd cmd;
+    Sec0Payload payload;
+    SessionData req;
+    uint8_t *outbuf = NULL;
+    ssize_t outlen = 0;
+
+    s0_session_cmd__init(&cmd);
+    sec0_payload__init(&payload);
+    payload.msg = SEC0_MSG_TYPE__S0_Session_Command;
+    payload.payload_case = SEC0_PAYLOAD__PAYLOAD_SC;
+    payload.sc = &cmd;
+    session_data__init(&req);
+    req.sec_ver = protocomm_security0.ver;
+    req.proto_case = SESSION_DATA__PROTO_SEC0;
+    req.sec0 = &payload;
+
+    uint8_t inbuf[16];
+    if (session_data__get_packed_size(&req) > sizeof(inbuf)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    size_t inlen = session_data__pack(&req, inbuf);
+    esp_err_t ret = protocomm_req_handle(test_pc, "prov-session", client->id,
+                                         inbuf, inlen, &outbuf, &outlen);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    SessionData *resp = session_data__unpack(NULL, outlen, outbuf);
+    free(outbuf);
+    if (!resp || resp->proto_case != SESSION_DATA__PROTO_SEC0 ||
+        resp->sec0->payload_case != SEC0_PAYLOAD__PAYLOAD_SR ||
+        resp->sec0->sr->status != STATUS__Success) {
+        ret = ESP_FAIL;
+    }
+    if (resp) {
+        session_data__free_unpacked(resp, NULL);
+    }
+    return ret;
+}
+
+static esp_err_t open_session(test_client_t *client)
+{
+    esp_err_t ret = protocomm_open_session(test_pc, client->id);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (client->sec_ver == 0) {
+        return sec0_handshake(client);
+    }
+    return sec2_client_handshake(&client->sec2, test_pc, "prov-session", client->id);
+}
+
+static void close_session(test_client_t *client)
+{
+    protocomm_close_session(test_pc, client->id);
+    if (client->sec_ver == 2) {
+        sec2_client_free(&client->sec2);
+    }
+}
+
+/* What a transport does with one request, plus the client side of the
+ * session encryption */
+static esp_err_t client_request(test_client_t *client, const char *ep_name,
+                                const uint8_t *inbuf, ssize_t inlen,
+                                uint8_t **outbuf, ssize_t *outlen)
+{
+    uint8_t *enc_in = (uint8_t *) inbuf;
+    ssize_t enc_inlen = inlen;
+    uint8_t *enc_out = NULL;
+    ssize_t enc_outlen = 0;
+    esp_err_t ret;
+
+    if (client->sec_ver == 2) {
+        ret = sec2_client_encrypt(&client->sec2, inbuf, inlen, &enc_in, &enc_inlen);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+
+    ret = protocomm_req_handle(test_pc, ep_name, client->id, enc_in, enc_inlen,
+                               &enc_out, &enc_outlen);
+    if (enc_in != inbuf) {
+        free(enc_in);
+    }
+    if (ret != ESP_OK) {
+        free(enc_out);
+        return ret;
+    }
+
+    if (client->sec_ver == 2) {
+        ret = sec2_client_decrypt(&client->sec2, enc_out, enc_outlen, outbuf, outlen);
+        free(enc_out);
+        return ret;
+    }
+    *outbuf = enc_out;
+    *outlen = enc_outlen;
+    return ESP_OK;
+}
+
+/* Packs a request message, sends it and returns the unpacked response,
+ * which the caller frees with protobuf_c_message_free_unpacked() */
+static void *client_call(test_client_t *client, const char *ep_name,
+                         const ProtobufCMessage *req)
+{
+    size_t inlen = protobuf_c_message_get_packed_size(req);
+    uint8_t *inbuf = malloc(inlen + 1);
+    uint8_t *outbuf = NULL;
+    ssize_t outlen = 0;
+    void *resp = NULL;
+
+    if (!inbuf) {
+        return NULL;
+    }
+    protobuf_c_message_pack(req, inbuf);
+    if (client_request(client, ep_name, inbuf, inlen, &outbuf, &outlen) == ESP_OK) {
+        resp = protobuf_c_message_unpack(req->descriptor, NULL, outlen, outbuf);
+    }
+    free(inbuf);
+    free(outbuf);
+    return resp;
+}
+
+/* Allocations made by the calling thread while counting is on.  glibc lets
+ * the program provide malloc() and friends in front of its own */
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void __libc_free(void *ptr);
+
+static __thread bool test_count_allocs;
+static __thread int test_allocs;
+
+void *malloc(size_t size)
+{
+    test_allocs += test_count_allocs;
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t nmemb, size_t size)
+{
+    test_allocs += test_count_allocs;
+    return __libc_calloc(nmemb, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    test_allocs += test_count_allocs;
+    return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr)
+{
+    __libc_free(ptr);
+}
+
+static esp_err_t check_version(test_client_t *client)
+{
+    uint8_t *outbuf = NULL;
+    ssize_t outlen = 0;
+
+    /* proto-ver is not encrypted, the app reads it before the handshake */
+    esp_err_t ret = protocomm_req_handle(test_pc, "proto-ver", client->id,
+                                         (const uint8_t *) "---", 3, &outbuf, &outlen);
+    if (ret == ESP_OK && (outlen != strlen(TEST_VER_STR) ||
+                          memcmp(outbuf, TEST_VER_STR, outlen) != 0)) {
+        ret = ESP_FAIL;
+    }
+    free(outbuf);
+    return ret;
+}
+
+/* Start, poll and read every page of a scan, as the phone app does */
+static esp_err_t run_scan(test_client_t *client, int *entries)
+{
+    WiFiScanPayload req, *resp;
+    CmdScanStart start;
+    CmdScanStatus status;
+    CmdScanResult result;
+    uint32_t count;
+
+    wi_fi_scan_payload__init(&req);
+    cmd_scan_start__init(&start);
+    start.blocking = true;
+    start.period_ms = 120;
+    req.msg = WI_FI_SCAN_MSG_TYPE__TypeCmdScanStart;
+    req.payload_case = WI_FI_SCAN_PAYLOAD__PAYLOAD_CMD_SCAN_START;
+    req.cmd_scan_start = &start;
+    resp = client_call(client, "prov-scan", &req.base);
+    if (!resp || resp->status != STATUS__Success) {
+        goto fail;
+    }
+    wi_fi_scan_payload__free_unpacked(resp, NULL);
+
+    wi_fi_scan_payload__init(&req);
+    cmd_scan_status__init(&status);
+    req.msg = WI_FI_SCAN_MSG_TYPE__TypeCmdScanStatus;
+    req.payload_case = WI_FI_SCAN_PAYLOAD__PAYLOAD_CMD_SCAN_STATUS;
+    req.cmd_scan_status = &status;
+    resp = client_call(client, "prov-scan", &req.base);
+    if (!resp || resp->payload_case != WI_FI_SCAN_PAYLOAD__PAYLOAD_RESP_SCAN_STATUS ||
+        !resp->resp_scan_status->scan_finished) {
+        goto fail;
+    }
+    count = resp->resp_scan_status->result_count;
+    wi_fi_scan_payload__free_unpacked(resp, NULL);
+
+    *entries = 0;
+    for (uint32_t index = 0; index < count; index += TEST_SCAN_PAGE) {
+        wi_fi_scan_payload__init(&req);
+        cmd_scan_result__init(&result);
+        result.start_index = index;
+        result.count = count - index < TEST_SCAN_PAGE ? count - index : TEST_SCAN_PAGE;
+        req.msg = WI_FI_SCAN_MSG_TYPE__TypeCmdScanResult;
+        req.payload_case = WI_FI_SCAN_PAYLOAD__PAYLOAD_CMD_SCAN_RESULT;
+        req.cmd_scan_result = &result;
+        resp = client_call(client, "prov-scan", &req.base);
+        if (!resp || resp->payload_case != WI_FI_SCAN_PAYLOAD__PAYLOAD_RESP_SCAN_RESULT ||
+            resp->resp_scan_result->n_entries != result.count) {
+            goto fail;
+        }
+        for (size_t i = 0; i < resp->resp_scan_result->n_entries; i++) {
+            WiFiScanResult *entry = resp->resp_scan_result->entries[i];
+            char ssid[8];
+
+            snprintf(ssid, sizeof(ssid), "ap-%02u", (unsigned) (index + i));
+            if (entry->ssid.len != strlen(ssid) || memcmp(entry->ssid.data, ssid, entry->ssid.len) ||
+                entry->bssid.len != 6 || entry->bssid.data[5] != index + i ||
+                entry->rssi != -40 - (int) (index + i)) {
+                goto fail;
+            }
+            (*entries)++;
+        }
+        wi_fi_scan_payload__free_unpacked(resp, NULL);
+    }
+    return ESP_OK;
+
+fail:
+    if (resp) {
+        wi_fi_scan_payload__free_unpacked(resp, NULL);
+    }
+    return ESP_FAIL;
+}
+
+/* Send credentials, apply them and read back the connection status */
+static esp_err_t run_config(test_client_t *client, const char *ssid, const char *passphrase,
+                            const uint8_t *bssid, size_t bssid_len, Status *set_status)
+{
+    WiFiConfigPayload req, *resp;
+    CmdSetConfig set;
+    CmdApplyConfig apply;
+    CmdGetStatus get;
+
+    wi_fi_config_payload__init(&req);
+    cmd_set_config__init(&set);
+    set.ssid.data = (uint8_t *) ssid;
+    set.ssid.len = strlen(ssid);
+    set.passphrase.data = (uint8_t *) passphrase;
+    set.passphrase.len = strlen(passphrase);
+    set.bssid.data = (uint8_t *) bssid;
+    set.bssid.len = bssid_len;
+    set.channel = 6;
+    set.priority = 3;
+    req.msg = WI_FI_CONFIG_MSG_TYPE__TypeCmdSetConfig;
+    req.payload_case = WI_FI_CONFIG_PAYLOAD__PAYLOAD_CMD_SET_CONFIG;
+    req.cmd_set_config = &set;
+    resp = client_call(client, "prov-config", &req.base);
+    if (!resp || resp->payload_case != WI_FI_CONFIG_PAYLOAD__PAYLOAD_RESP_SET_CONFIG) {
+        goto fail;
+    }
+    *set_status = resp->resp_set_config->status;
+    wi_fi_config_payload__free_unpacked(resp, NULL);
+    if (*set_status != STATUS__Success) {
+        return ESP_OK;
+    }
+
+    wi_fi_config_payload__init(&req);
+    cmd_apply_config__init(&apply);
+    req.msg = WI_FI_CONFIG_MSG_TYPE__TypeCmdApplyConfig;
+    req.payload_case = WI_FI_CONFIG_PAYLOAD__PAYLOAD_CMD_APPLY_CONFIG;
+    req.cmd_apply_config = &apply;
+    resp = client_call(client, "prov-config", &req.base);
+    if (!resp || resp->payload_case != WI_FI_CONFIG_PAYLOAD__PAYLOAD_RESP_APPLY_CONFIG ||
+        resp->resp_apply_config->status != STATUS__Success) {
+        goto fail;
+    }
+    wi_fi_config_payload__free_unpacked(resp, NULL);
+
+    wi_fi_config_payload__init(&req);
+    cmd_get_status__init(&get);
+    req.msg = WI_FI_CONFIG_MSG_TYPE__TypeCmdGetStatus;
+    req.payload_case = WI_FI_CONFIG_PAYLOAD__PAYLOAD_CMD_GET_STATUS;
+    req.cmd_get_status = &get;
+    resp = client_call(client, "prov-config", &req.base);
+    if (!resp || resp->payload_case != WI_FI_CONFIG_PAYLOAD__PAYLOAD_RESP_GET_STATUS ||
+        resp->resp_get_status->sta_state != WIFI_STATION_STATE__Connected ||
+        resp->resp_get_status->connected->ssid.len != strlen(ssid) ||
+        memcmp(resp->resp_get_status->connected->ssid.data, ssid, strlen(ssid)) != 0 ||
+        strcmp(resp->resp_get_status->connected->ip4_addr, "192.168.4.2") != 0 ||
+        resp->resp_get_status->connected->channel != 6) {
+        goto fail;
+    }
+    wi_fi_config_payload__free_unpacked(resp, NULL);
+    return ESP_OK;
+
+fail:
+    if (resp) {
+        wi_fi_config_payload__free_unpacked(resp, NULL);
+    }
+    return ESP_FAIL;
+}
+
+static esp_err_t run_ctrl(test_client_t *client, WiFiCtrlMsgType msg)
+{
+    WiFiCtrlPayload req, *resp;
+    CmdCtrlReset reset;
+    CmdCtrlReprov reprov;
+
+    wi_fi_ctrl_payload__init(&req);
+    req.msg = msg;
+    if (msg == WI_FI_CTRL_MSG_TYPE__TypeCmdCtrlReset) {
+        cmd_ctrl_reset__init(&reset);
+        req.payload_case = WI_FI_CTRL_PAYLOAD__PAYLOAD_CMD_CTRL_RESET;
+        req.cmd_ctrl_reset = &reset;
+    } else {
+        cmd_ctrl_reprov__init(&reprov);
+        req.payload_case = WI_FI_CTRL_PAYLOAD__PAYLOAD_CMD_CTRL_REPROV;
+        req.cmd_ctrl_reprov = &reprov;
+    }
+    resp = client_call(client, "prov-ctrl", &req.base);
+    if (!resp) {
+        return ESP_FAIL;
+    }
+    esp_err_t ret = resp->status == STATUS__Success && resp->msg == msg + 1 ? ESP_OK : ESP_FAIL;
+    wi_fi_ctrl_payload__free_unpacked(resp, NULL);
+    return ret;
+}
+
+static esp_err_t run_custom(test_client_t *client)
+{
+    uint8_t data[TEST_DATA_LEN];
+    uint8_t *outbuf = NULL;
+    ssize_t outlen = 0;
+
+    esp_fill_random(data, sizeof(data));
+    esp_err_t ret = client_request(client, "custom-data", data, sizeof(data), &outbuf, &outlen);
+    if (ret == ESP_OK && (outlen != sizeof(data) || memcmp(outbuf, data, outlen) != 0)) {
+        ret = ESP_FAIL;
+    }
+    free(outbuf);
+    return ret;
+}
+
+TEST_GROUP(wifi_prov_host);
+
+TEST_SETUP(wifi_prov_host)
+{
+    memset(&test_rec, 0, sizeof(test_rec));
+}
+
+TEST_TEAR_DOWN(wifi_prov_host)
+{
+    if (test_pc) {
+        stop_service();
+    }
+}
+
+TEST(wifi_prov_host, security0_session)
+{
+    test_client_t client = { .id = 1, .sec_ver = 0 };
+
+    TEST_ASSERT_EQUAL(ESP_OK, start_service(0));
+    TEST_ASSERT_EQUAL(ESP_OK, check_version(&client));
+    TEST_ASSERT_EQUAL(ESP_OK, open_session(&client));
+    TEST_ASSERT_EQUAL(ESP_OK, run_custom(&client));
+    close_session(&client);
+}
+
+TEST(wifi_prov_host, version_endpoint)
+{
+    test_client_t client = { .id = 8, .sec_ver = 0 };
+
+    TEST_ASSERT_EQUAL(ESP_OK, start_service(0));
+    for (int i = 0; i < 3; i++) {
+        uint8_t *outbuf = NULL;
+        ssize_t outlen = 0;
+
+        test_allocs = 0;
+        test_count_allocs = true;
+        esp_err_t ret = protocomm_req_handle(test_pc, "proto-ver", client.id,
+                                             (const uint8_t *) "---", 3, &outbuf, &outlen);
+        test_count_allocs = false;
+
+        TEST_ASSERT_EQUAL(ESP_OK, ret);
+        TEST_ASSERT_EQUAL(strlen(TEST_VER_STR), outlen);
+        TEST_ASSERT_EQUAL_MEMORY(TEST_VER_STR, outbuf, outlen);
+        /* Only the response buffer, which the caller frees */
+        TEST_ASSERT_EQUAL(1, test_allocs);
+        free(outbuf);
+    }
+}
+
+TEST(wifi_prov_host, security2_session)
+{
+    test_client_t client = { .id = 2, .sec_ver = 2 };
+
+    client.sec2.username = TEST_USERNAME;
+    client.sec2.password = TEST_PASSWORD;
+    TEST_ASSERT_EQUAL(ESP_OK, start_service(2));
+    TEST_ASSERT_EQUAL(ESP_OK, check_version(&client));
+    TEST_ASSERT_EQUAL(ESP_OK, open_session(&client));
+    TEST_ASSERT_EQUAL(ESP_OK, run_custom(&client));
+
+    /* A modified request fails the tag check on the device */
+    uint8_t data[32] = { 0 };
+    uint8_t *enc = NULL, *outbuf = NULL;
+    ssize_t enc_len = 0, outlen = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, sec2_client_encrypt(&client.sec2, data, sizeof(data), &enc, &enc_len));
+    enc[3] ^= 1;
+    TEST_ASSERT_NOT_EQUAL(ESP_OK, protocomm_req_handle(test_pc, "custom-data", client.id,
+                                                       enc, enc_len, &outbuf, &outlen));
+    free(enc);
+    free(outbuf);
+    close_session(&client);
+}
+
+TEST(wifi_prov_host, security2_wrong_password)
+{
+    test_client_t client = { .id = 3, .sec_ver = 2 };
+
+    client.sec2.username = TEST_USERNAME;
+    client.sec2.password = "wrong password";
+    TEST_ASSERT_EQUAL(ESP_OK, start_service(2));
+    TEST_ASSERT_NOT_EQUAL(ESP_OK, open_session(&client));
+
+    /* Nor does the device accept requests on the failed session */
+    uint8_t data[32] = { 0 };
+    uint8_t *outbuf = NULL;
+    ssize_t outlen = 0;
+    TEST_ASSERT_NOT_EQUAL(ESP_OK, protocomm_req_handle(test_pc, "custom-data", client.id,
+                                                       data, sizeof(data), &outbuf, &outlen));
+    free(outbuf);
+    close_session(&client);
+}
+
+TEST(wifi_prov_host, config_endpoint)
+{
+    static const uint8_t bssid[6] = { 0x24, 0x0a, 0xc4, 0x01, 0x02, 0x03 };
+    test_client_t client = { .id = 4, .sec_ver = 2 };
+    Status status;
+
+    client.sec2.username = TEST_USERNAME;
+    client.sec2.password = TEST_PASSWORD;
+    TEST_ASSERT_EQUAL(ESP_OK, start_service(2));
+    TEST_ASSERT_EQUAL(ESP_OK, open_session(&client));
+
+    TEST_ASSERT_EQUAL(ESP_OK, run_config(&client, "myssid", "mypassword", bssid, sizeof(bssid), &status));
+    TEST_ASSERT_EQUAL(STATUS__Success, status);
+    TEST_ASSERT_EQUAL(1, test_rec.set_calls);
+    TEST_ASSERT_EQUAL(1, test_rec.apply_calls);
+    TEST_ASSERT_EQUAL_STRING("myssid", test_rec.config.ssid);
+    TEST_ASSERT_EQUAL_STRING("mypassword", test_rec.config.password);
+    TEST_ASSERT_EQUAL_MEMORY(bssid, test_rec.config.bssid, sizeof(bssid));
+    TEST_ASSERT_EQUAL(6, test_rec.config.channel);
+    TEST_ASSERT_EQUAL(3, test_rec.config.priority);
+
+    /* Arguments out of range are refused without calling the handler */
+    TEST_ASSERT_EQUAL(ESP_OK, run_config(&client, "myssid", "mypassword", bssid, 4, &status));
+    TEST_ASSERT_EQUAL(STATUS__InvalidArgument, status);
+    TEST_ASSERT_EQUAL(ESP_OK, run_config(&client, "an SSID that is longer than 32 bytes", "", NULL, 0, &status));
+    TEST_ASSERT_EQUAL(STATUS__InvalidArgument, status);
+    TEST_ASSERT_EQUAL(1, test_rec.set_calls);
+    close_session(&client);
+}
+
+TEST(wifi_prov_host, scan_endpoint)
+{
+    test_client_t client = { .id = 5, .sec_ver = 2 };
+    int entries = 0;
+
+    client.sec2.username = TEST_USERNAME;
+    client.sec2.password = TEST_PASSWORD;
+    TEST_ASSERT_EQUAL(ESP_OK, start_service(2));
+    TEST_ASSERT_EQUAL(ESP_OK, open_session(&client));
+    TEST_ASSERT_EQUAL(ESP_OK, run_scan(&client, &entries));
+    TEST_ASSERT_EQUAL(TEST_SCAN_APS, entries);
+    TEST_ASSERT_EQUAL(1, test_rec.scan_starts);
+    TEST_ASSERT_TRUE(test_rec.scan_blocking);
+    TEST_ASSERT_EQUAL(120, test_rec.scan_period_ms);
+    close_session(&client);
+}
+
+TEST(wifi_prov_host, ctrl_endpoint)
+{
+    test_client_t client = { .id = 6, .sec_ver = 0 };
+
+    TEST_ASSERT_EQUAL(ESP_OK, start_service(0));
+    TEST_ASSERT_EQUAL(ESP_OK, open_session(&client));
+    TEST_ASSERT_EQUAL(ESP_OK, run_ctrl(&client, WI_FI_CTRL_MSG_TYPE__TypeCmdCtrlReset));
+    TEST_ASSERT_EQUAL(ESP_OK, run_ctrl(&client, WI_FI_CTRL_MSG_TYPE__TypeCmdCtrlReprov));
+    TEST_ASSERT_EQUAL(1, test_rec.resets);
+    TEST_ASSERT_EQUAL(1, test_rec.reprovs);
+    close_session(&client);
+}
+
+typedef struct {
+    int64_t start_us;
+    int64_t version_us;
+    int64_t handshake_us;
+    int64_t scan_us;
+    int64_t config_us;
+    int64_t custom_us;
+    int64_t stop_us;
+    size_t  session_heap;
+} perf_stats_t;
+
+static int64_t now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/* Approximate, mallinfo2() also counts the chunks glibc keeps in its
+ * per-thread caches.  Leaks are left to the sanitizers */
+static size_t heap_used(void)
+{
+    return mallinfo2().uordblks;
+}
+
+/* Replays one provisioning session from service start to stop, timing each
+ * stage and tracking the heap held while the session is live */
+static void perf_session(uint8_t sec_ver, perf_stats_t *stats)
+{
+    test_client_t client = { .id = 7, .sec_ver = sec_ver };
+    Status status;
+    int entries;
+
+    client.sec2.username = TEST_USERNAME;
+    client.sec2.password = TEST_PASSWORD;
+
+    size_t heap = heap_used();
+    int64_t t0 = now_us();
+    TEST_ASSERT_EQUAL(ESP_OK, start_service(sec_ver));
+    int64_t t1 = now_us();
+    TEST_ASSERT_EQUAL(ESP_OK, check_version(&client));
+    int64_t t2 = now_us();
+    TEST_ASSERT_EQUAL(ESP_OK, open_session(&client));
+    int64_t t3 = now_us();
+    size_t session_heap = heap_used();
+    session_heap = session_heap > heap ? session_heap - heap : 0;
+    TEST_ASSERT_EQUAL(ESP_OK, run_scan(&client, &entries));
+    int64_t t4 = now_us();
+    TEST_ASSERT_EQUAL(ESP_OK, run_config(&client, "myssid", "mypassword", NULL, 0, &status));
+    TEST_ASSERT_EQUAL(STATUS__Success, status);
+    int64_t t5 = now_us();
+    TEST_ASSERT_EQUAL(ESP_OK, run_custom(&client));
+    int64_t t6 = now_us();
+    close_session(&client);
+    stop_service();
+    int64_t t7 = now_us();
+
+    stats->start_us     += t1 - t0;
+    stats->version_us   += t2 - t1;
+    stats->handshake_us += t3 - t2;
+    stats->scan_us      += t4 - t3;
+    stats->config_us    += t5 - t4;
+    stats->custom_us    += t6 - t5;
+    stats->stop_us      += t7 - t6;
+    if (session_heap > stats->session_heap) {
+        stats->session_heap = session_heap;
+    }
+}
+
+static void perf_run(uint8_t sec_ver)
+{
+    perf_stats_t stats = { 0 };
+
+    /* One session first, so that allocations made once per process are
+     * not counted */
+    perf_session(sec_ver, &stats);
+    memset(&stats, 0, sizeof(stats));
+
+    int64_t begin = now_us();
+    for (int i = 0; i < PERF_ITERATIONS; i++) {
+        perf_session(sec_ver, &stats);
+    }
+    int64_t total_us = now_us() - begin;
+
+    printf("Security %d, %d sessions, average us per stage:\n", sec_ver, PERF_ITERATIONS);
+    printf("  start     : %lld\n", (long long) stats.start_us / PERF_ITERATIONS);
+    printf("  version   : %lld\n", (long long) stats.version_us / PERF_ITERATIONS);
+    printf("  handshake : %lld\n", (long long) stats.handshake_us / PERF_ITERATIONS);
+    printf("  scan      : %lld (%d results, %d per page)\n",
+           (long long) stats.scan_us / PERF_ITERATIONS, TEST_SCAN_APS, TEST_SCAN_PAGE);
+    printf("  config    : %lld\n", (long long) stats.config_us / PERF_ITERATIONS);
+    printf("  custom    : %lld (%d bytes)\n", (long long) stats.custom_us / PERF_ITERATIONS,
+           TEST_DATA_LEN);
+    printf("  stop      : %lld\n", (long long) stats.stop_us / PERF_ITERATIONS);
+    printf("Peak heap held by a session : %zu bytes\n", stats.session_heap);
+    printf("Sessions per second         : %lld\n",
+           (long long) PERF_ITERATIONS * 1000000 / total_us);
+}
+
+TEST(wifi_prov_host, session_throughput)
+{
+    perf_run(0);
+    perf_run(2);
+}
+
+TEST_GROUP_RUNNER(wifi_prov_host)
+{
+    RUN_TEST_CASE(wifi_prov_host, security0_session);
+    RUN_TEST_CASE(wifi_prov_host, version_endpoint);
+    RUN_TEST_CASE(wifi_prov_host, security2_session);
+    RUN_TEST_CASE(wifi_prov_host, security2_wrong_password);
+    RUN_TEST_CASE(wifi_prov_host, config_endpoint);
+    RUN_TEST_CASE(wifi_prov_host, scan_endpoint);
+    RUN_TEST_CASE(wifi_prov_host, ctrl_endpoint);
+    RUN_TEST_CASE(wifi_prov_host, session_throughput);
+}
+
+static void run_all_tests(void)
+{
+    RUN_TEST_GROUP(wifi_prov_host);
+}
+
+void app_main(void)
+{
+    size_t verifier_len = 0;
+
+    /* The security schemes post session events to the default loop */
+    ESP_ERROR_CHECK(esp_event_loop_create_default());
+
+    /* The device only keeps the salt and verifier, as after
+     * esp_srp_gen_salt_verifier() on the provisioning host */
+    esp_fill_random(test_salt, sizeof(test_salt));
+    ESP_ERROR_CHECK(sec2_client_verifier(TEST_USERNAME, TEST_PASSWORD, test_salt, sizeof(test_salt),
+                                         test_verifier, &verifier_len));
+    test_sec2_params.salt = (const char *) test_salt;
+    test_sec2_params.salt_len = sizeof(test_salt);
+    test_sec2_params.verifier = (const char *) test_verifier;
+    test_sec2_params.verifier_len = verifier_len;
+
+    UNITY_MAIN_FUNC(run_all_tests);
+}
@@ -0,0 +1,10 @@
+# SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: CC0-1.0
+import pytest
+from pytest_embedded import Dut
+
+
+@pytest.mark.linux
+@pytest.mark.host_test
+def test_wifi_prov_host(dut: Dut) -> None:
+    dut.expect(r'\d+ Tests 0 Failures 0 Ignored', timeout=120)
@@ -573,6 +573,33 @@ esp_err_t wifi_prov_mgr_configure_sta(wifi_config_t *wifi_cfg);
  */
 esp_err_t wifi_prov_mgr_reset_provisioning(void);
 
+/**
+ * @brief   Connect to the best of the stored networks
+ *
+ * With CONFIG_WIFI_PROV_STA_MULTI_NETWORK enabled, every network received
+ * during provisioning is kept in a store of up to 4 networks, along with the
+ * priority set by the client and its connection history. This scans for the
+ * stored networks and connects to the one in range with the highest priority,
+ * and then the best RSSI adjusted for past successes and failures.
+ *
+ * This is meant to be called by the application after provisioning, when
+ * the station fails to reconnect to its network, instead of provisioning
+ * the device again. Wi-Fi must be started in station mode.
+ *
+ * @note    This does not require the provisioning manager to be initialized
+ *
+ * @param[in] skip_current  Record a failure for the currently configured
+ *                          network and don't select it this time
+ *
+ * @return
+ *  - ESP_OK      : Connecting to the selected network
+ *  - ESP_ERR_NOT_FOUND     : No stored network is in range
+ *  - ESP_ERR_NOT_SUPPORTED : CONFIG_WIFI_PROV_STA_MULTI_NETWORK is disabled
+ *  - ESP_ERR_NO_MEM        : Out of memory
+ *  - ESP_FAIL    : Failed to scan or to configure Wi-Fi
+ */
+esp_err_t wifi_prov_mgr_connect_best_network(bool skip_current);
+
 /**
  * @brief   Reset internal state machine and clear provisioned credentials.
  *
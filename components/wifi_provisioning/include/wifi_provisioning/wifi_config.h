@@ -72,6 +72,7 @@ typedef struct {
     char    password[64];   /*!< Password of the AP */
     char    bssid[6];       /*!< BSSID of the AP */
     uint8_t channel;        /*!< Channel of the AP */
+    uint8_t priority;       /*!< Rank of the network among stored networks, higher is preferred */
 } wifi_prov_config_set_data_t;
 
 /**
@@ -418,7 +418,7 @@ const ProtobufCMessageDescriptor resp_get_status__descriptor =
   (ProtobufCMessageInit) resp_get_status__init,
   NULL,NULL,NULL    /* reserved[123] */
 };
-static const ProtobufCFieldDescriptor cmd_set_config__field_descriptors[4] =
+static const ProtobufCFieldDescriptor cmd_set_config__field_descriptors[5] =
 {
   {
     "ssid",
@@ -468,17 +468,30 @@ static const ProtobufCFieldDescriptor cmd_set_config__field_descriptors[4] =
     0,             /* flags */
     0,NULL,NULL    /* reserved1,reserved2, etc */
   },
+  {
+    "priority",
+    5,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(CmdSetConfig, priority),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
 };
 static const unsigned cmd_set_config__field_indices_by_name[] = {
   2,   /* field[2] = bssid */
   3,   /* field[3] = channel */
   1,   /* field[1] = passphrase */
+  4,   /* field[4] = priority */
   0,   /* field[0] = ssid */
 };
 static const ProtobufCIntRange cmd_set_config__number_ranges[1 + 1] =
 {
   { 1, 0 },
-  { 0, 4 }
+  { 0, 5 }
 };
 const ProtobufCMessageDescriptor cmd_set_config__descriptor =
 {
@@ -488,7 +501,7 @@ const ProtobufCMessageDescriptor cmd_set_config__descriptor =
   "CmdSetConfig",
   "",
   sizeof(CmdSetConfig),
-  4,
+  5,
   cmd_set_config__field_descriptors,
   cmd_set_config__field_indices_by_name,
   1,  cmd_set_config__number_ranges,
@@ -79,10 +79,11 @@ struct  CmdSetConfig
   ProtobufCBinaryData passphrase;
   ProtobufCBinaryData bssid;
   int32_t channel;
+  uint32_t priority;
 };
 #define CMD_SET_CONFIG__INIT \
  { PROTOBUF_C_MESSAGE_INIT (&cmd_set_config__descriptor) \
-    , {0,NULL}, {0,NULL}, {0,NULL}, 0 }
+    , {0,NULL}, {0,NULL}, {0,NULL}, 0, 0 }
 
 
 struct  RespSetConfig
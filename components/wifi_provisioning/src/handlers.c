@@ -118,6 +118,11 @@ static esp_err_t set_config_handler(const wifi_prov_config_set_data_t *req_data,
     wifi_cfg->sta.scan_method = WIFI_FAST_SCAN;
 #endif
 
+    /* Overlap PMK derivation with sending the response and waiting
+     * for the apply request */
+    wifi_prov_mgr_precompute_pmk(&wifi_cfg->sta);
+    wifi_prov_mgr_set_network_priority(req_data->priority);
+
     return ESP_OK;
 }
 
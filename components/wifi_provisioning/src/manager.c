@@ -17,6 +17,7 @@
 #include <esp_err.h>
 #include <esp_wifi.h>
 #include <esp_timer.h>
+#include <nvs.h>
 
 #include <protocomm.h>
 #include <protocomm_security0.h>
@@ -24,11 +25,24 @@
 #include <protocomm_security2.h>
 
 #include "wifi_provisioning_priv.h"
+#include "wifi_prov_pmk.h"
+#include "wifi_prov_netstore.h"
 
 #define WIFI_PROV_MGR_VERSION      "v1.1"
 #define WIFI_PROV_STORAGE_BIT       BIT0
 #define WIFI_PROV_SETTING_BIT       BIT1
 #define MAX_SCAN_RESULTS           CONFIG_WIFI_PROV_SCAN_MAX_ENTRIES
+#define NETSTORE_NVS_NAMESPACE     "wifi_prov"
+#define NETSTORE_NVS_KEY           "networks"
+
+/* Without NVS encryption the network store holds PSKs, derived by the
+ * same background task as the precomputed PMK */
+#if defined(CONFIG_WIFI_PROV_STA_MULTI_NETWORK) && !defined(CONFIG_NVS_ENCRYPTION)
+#define WIFI_PROV_NETSTORE_PSK     1
+#endif
+#if defined(CONFIG_WIFI_PROV_STA_PMK_PRECOMPUTE) || defined(WIFI_PROV_NETSTORE_PSK)
+#define WIFI_PROV_PMK_JOB          1
+#endif
 
 #define ACQUIRE_LOCK(mux)     assert(xSemaphoreTake(mux, portMAX_DELAY) == pdTRUE)
 #define RELEASE_LOCK(mux)     assert(xSemaphoreGive(mux) == pdTRUE)
@@ -114,6 +128,13 @@ struct wifi_prov_mgr_ctx {
     /* Code for Wi-Fi station disconnection (if disconnected) */
     wifi_prov_sta_fail_reason_t wifi_disconnect_reason;
 
+    /* Time (in microseconds since boot) at which credentials were received,
+     * or 0 once the resulting connection has been reported */
+    int64_t cred_recv_time;
+
+    /* Priority given by the client to the received network */
+    uint8_t net_priority;
+
     /* Protocomm handlers for Wi-Fi configuration endpoint */
     wifi_prov_config_handlers_t *wifi_prov_handlers;
 
@@ -154,6 +175,39 @@ static SemaphoreHandle_t prov_ctx_lock = NULL;
 /* Pointer to provisioning context data */
 static struct wifi_prov_mgr_ctx *prov_ctx;
 
+#ifdef WIFI_PROV_PMK_JOB
+/**
+ * @brief  Background derivation of the PMK for received credentials
+ */
+struct wifi_prov_pmk_job {
+    /* Held while a derivation task is running */
+    SemaphoreHandle_t idle;
+
+    /* Credentials the PMK is derived from */
+    uint8_t ssid[32];
+    uint8_t password[64];
+
+    /* Derived PMK, valid if done is set */
+    uint8_t pmk[WIFI_PROV_PMK_LEN];
+    bool done;
+
+#ifdef WIFI_PROV_NETSTORE_PSK
+    /* Network to add to the store with the PSK derived for it, set by
+     * pmk_job_store(). These are protected by prov_ctx_lock */
+    bool store;
+    uint8_t store_ssid[32];
+    uint8_t store_password[64];
+    uint8_t store_bssid[6];
+    bool store_bssid_set;
+    uint8_t store_priority;
+#endif
+};
+
+/* Like prov_ctx_lock, this is allocated on first use and never freed,
+ * so that a derivation task never outlives the memory it writes to */
+static struct wifi_prov_pmk_job *pmk_job;
+#endif
+
 /* This executes registered app_event_callback for a particular event
  *
  * NOTE : By the time this fucntion returns, it is possible that
@@ -305,8 +359,10 @@ static esp_err_t wifi_prov_mgr_start_service(const char *service_name, const cha
     }
 
     /* Set version information / capabilities of provisioning service and application */
+    /* The document is printed without formatting to keep it short, as
+     * clients read it, possibly over several BLE reads, on every poll */
     cJSON *version_json = wifi_prov_get_info_json();
-    char *version_str = cJSON_Print(version_json);
+    char *version_str = cJSON_PrintUnformatted(version_json);
     ret = protocomm_set_version(prov_ctx->pc, "proto-ver", version_str);
     free(version_str);
     cJSON_Delete(version_json);
@@ -780,6 +836,345 @@ esp_err_t wifi_prov_mgr_done(void)
     return ESP_OK;
 }
 
+#ifdef WIFI_PROV_PMK_JOB
+/* Only networks which all scanned APs advertise as WPA/WPA2-Personal
+ * accept a PSK; WPA3-SAE needs the passphrase itself */
+static bool pmk_usable(const wifi_sta_config_t *sta)
+{
+    bool found = false;
+
+    for (int i = 0; i < MAX_SCAN_RESULTS && prov_ctx->ap_list_sorted[i]; i++) {
+        const wifi_ap_record_t *ap = prov_ctx->ap_list_sorted[i];
+        if (strncmp((const char *) ap->ssid, (const char *) sta->ssid, sizeof(sta->ssid))) {
+            continue;
+        }
+        if (ap->authmode != WIFI_AUTH_WPA_PSK &&
+            ap->authmode != WIFI_AUTH_WPA2_PSK &&
+            ap->authmode != WIFI_AUTH_WPA_WPA2_PSK) {
+            return false;
+        }
+        found = true;
+    }
+    return found;
+}
+#endif
+
+#ifdef CONFIG_WIFI_PROV_STA_MULTI_NETWORK
+/* Set while netstore_connect_handler() waits for the outcome of a connection */
+static bool netstore_connect_pending;
+
+static void netstore_free(wifi_prov_netstore_t *store)
+{
+    if (store) {
+        /* Don't leave credentials behind on the heap */
+        memset(store, 0, sizeof(*store));
+        free(store);
+    }
+}
+
+/* Read the known networks from NVS. A missing or unreadable
+ * store is treated as empty. Returns NULL only if out of memory */
+static wifi_prov_netstore_t *netstore_load(void)
+{
+    wifi_prov_netstore_t *store = calloc(1, sizeof(*store));
+    nvs_handle_t handle;
+    size_t len = sizeof(*store);
+
+    if (!store) {
+        ESP_LOGE(TAG, "Failed to allocate memory for network store");
+        return NULL;
+    }
+    wifi_prov_netstore_init(store);
+    if (nvs_open(NETSTORE_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return store;
+    }
+    if (nvs_get_blob(handle, NETSTORE_NVS_KEY, store, &len) != ESP_OK ||
+        !wifi_prov_netstore_check(store, len)) {
+        wifi_prov_netstore_init(store);
+    }
+    nvs_close(handle);
+    return store;
+}
+
+static void netstore_save(const wifi_prov_netstore_t *store)
+{
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(NETSTORE_NVS_NAMESPACE, NVS_READWRITE, &handle);
+
+    if (err == ESP_OK) {
+        err = nvs_set_blob(handle, NETSTORE_NVS_KEY, store, sizeof(*store));
+        if (err == ESP_OK) {
+            err = nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to save network store, 0x%x", err);
+    }
+}
+
+/* Add a network to the store, along with the RSSI the manager last scanned
+ * it at. This must be called with prov_ctx_lock held */
+static void netstore_add(const uint8_t *ssid, const uint8_t *password,
+                         const uint8_t *bssid, uint8_t priority)
+{
+    wifi_prov_netstore_t *store = netstore_load();
+    if (!store) {
+        return;
+    }
+
+    int index = wifi_prov_netstore_add(store, ssid, password, bssid, priority);
+    store->profiles[index].rssi = WIFI_PROV_NETSTORE_RSSI_UNSEEN;
+    for (int i = 0; prov_ctx && i < MAX_SCAN_RESULTS && prov_ctx->ap_list_sorted[i]; i++) {
+        const wifi_ap_record_t *ap = prov_ctx->ap_list_sorted[i];
+        wifi_prov_netstore_scan_result(store, ap->ssid, ap->bssid, ap->rssi);
+    }
+    ESP_LOGD(TAG, "Stored network %d of %d with priority %d",
+             index + 1, store->count, priority);
+    netstore_save(store);
+    netstore_free(store);
+}
+
+#ifdef WIFI_PROV_NETSTORE_PSK
+static void pmk_job_store(const wifi_sta_config_t *sta, uint8_t priority);
+#endif
+
+/* Add the network received from the client. Without NVS encryption no
+ * passphrase is written to flash, only the PSK derived from it, and that
+ * is left to the PMK job so that credentials are applied without waiting
+ * for the derivation. This must be called with prov_ctx_lock held */
+static void netstore_add_received(const wifi_sta_config_t *sta)
+{
+    const uint8_t *bssid = sta->bssid_set ? sta->bssid : NULL;
+#ifdef WIFI_PROV_NETSTORE_PSK
+    size_t passlen = strnlen((const char *) sta->password, sizeof(sta->password));
+
+    /* Open networks and 64 hex digit PSKs are stored as they are */
+    if (passlen != 0 && passlen != sizeof(sta->password)) {
+        if (passlen < 8 || !pmk_usable(sta)) {
+            ESP_LOGW(TAG, "Network needs a passphrase and NVS is not encrypted, not storing it");
+            return;
+        }
+        pmk_job_store(sta, prov_ctx->net_priority);
+        return;
+    }
+#endif
+    netstore_add(sta->ssid, sta->password, bssid, prov_ctx->net_priority);
+}
+
+/* Record the outcome of connecting to the configured network. Credentials
+ * which were rejected by the AP are dropped from the store */
+static void netstore_report_current(bool connected, bool auth_error)
+{
+    wifi_prov_netstore_t *store = netstore_load();
+    wifi_config_t wifi_cfg;
+
+    if (!store) {
+        return;
+    }
+    if (esp_wifi_get_config(WIFI_IF_STA, &wifi_cfg) == ESP_OK) {
+        int index = wifi_prov_netstore_find(store, wifi_cfg.sta.ssid);
+        if (index >= 0) {
+            if (auth_error) {
+                wifi_prov_netstore_remove(store, index);
+            } else {
+                wifi_prov_netstore_report(store, index, connected);
+                /* Keep a PSK which was actually used, e.g. a precomputed PMK */
+                if (connected && strnlen((const char *) wifi_cfg.sta.password,
+                                         sizeof(wifi_cfg.sta.password)) == sizeof(wifi_cfg.sta.password)) {
+                    memcpy(store->profiles[index].password, wifi_cfg.sta.password,
+                           sizeof(store->profiles[index].password));
+                }
+            }
+            netstore_save(store);
+        }
+    }
+    netstore_free(store);
+}
+
+static void netstore_connect_handler(void *arg, esp_event_base_t event_base,
+                                     int32_t event_id, void *event_data);
+
+static void netstore_watch_stop(void)
+{
+    esp_event_handler_unregister(IP_EVENT, IP_EVENT_STA_GOT_IP, netstore_connect_handler);
+    esp_event_handler_unregister(WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, netstore_connect_handler);
+    netstore_connect_pending = false;
+}
+
+/* Report the outcome of the next connection attempt to the store, once */
+static esp_err_t netstore_watch_start(void)
+{
+    esp_err_t err;
+
+    netstore_watch_stop();
+    err = esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP, netstore_connect_handler, NULL);
+    if (err == ESP_OK) {
+        err = esp_event_handler_register(WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED,
+                                         netstore_connect_handler, NULL);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to register network store event handler");
+        netstore_watch_stop();
+        return err;
+    }
+    netstore_connect_pending = true;
+    return ESP_OK;
+}
+
+static void netstore_connect_handler(void *arg, esp_event_base_t event_base,
+                                     int32_t event_id, void *event_data)
+{
+    if (!netstore_connect_pending) {
+        return;
+    }
+    if (event_base == IP_EVENT) {
+        netstore_watch_stop();
+        netstore_report_current(true, false);
+        return;
+    }
+
+    switch (((wifi_event_sta_disconnected_t *) event_data)->reason) {
+    case WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT:
+    case WIFI_REASON_AUTH_FAIL:
+    case WIFI_REASON_HANDSHAKE_TIMEOUT:
+    case WIFI_REASON_MIC_FAILURE:
+        netstore_watch_stop();
+        netstore_report_current(false, true);
+        break;
+    case WIFI_REASON_NO_AP_FOUND:
+        netstore_watch_stop();
+        netstore_report_current(false, false);
+        break;
+    default:
+        /* Whoever started the connection retries it */
+        break;
+    }
+}
+#endif
+
+void wifi_prov_mgr_set_network_priority(uint8_t priority)
+{
+    if (!prov_ctx_lock) {
+        return;
+    }
+
+    ACQUIRE_LOCK(prov_ctx_lock);
+    if (prov_ctx) {
+        prov_ctx->net_priority = priority;
+    }
+    RELEASE_LOCK(prov_ctx_lock);
+}
+
+esp_err_t wifi_prov_mgr_connect_best_network(bool skip_current)
+{
+#ifdef CONFIG_WIFI_PROV_STA_MULTI_NETWORK
+    wifi_config_t wifi_cfg;
+    wifi_ap_record_t *records = NULL;
+    uint16_t count = MAX_SCAN_RESULTS;
+    uint32_t skip = 0;
+    esp_err_t err;
+
+    /* Drop any outcome still expected from an earlier attempt */
+    netstore_watch_stop();
+
+    wifi_prov_netstore_t *store = netstore_load();
+    if (!store) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (!store->count) {
+        netstore_free(store);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    err = esp_wifi_get_config(WIFI_IF_STA, &wifi_cfg);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to get Wi-Fi configuration");
+        goto exit;
+    }
+    if (skip_current) {
+        int current = wifi_prov_netstore_find(store, wifi_cfg.sta.ssid);
+        if (current >= 0) {
+            wifi_prov_netstore_report(store, current, false);
+            skip |= 1U << current;
+        }
+    }
+
+    records = calloc(count, sizeof(wifi_ap_record_t));
+    if (!records) {
+        ESP_LOGE(TAG, "Failed to allocate memory for AP list");
+        err = ESP_ERR_NO_MEM;
+        goto exit;
+    }
+    err = esp_wifi_scan_start(NULL, true);
+    if (err == ESP_OK) {
+        err = esp_wifi_scan_get_ap_records(&count, records);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to scan for stored networks");
+        goto exit;
+    }
+    wifi_prov_netstore_scan_begin(store);
+    for (int i = 0; i < count; i++) {
+        wifi_prov_netstore_scan_result(store, records[i].ssid, records[i].bssid, records[i].rssi);
+    }
+
+    int best = wifi_prov_netstore_select(store, skip);
+    if (best < 0) {
+        ESP_LOGW(TAG, "None of the %d stored networks is in range", store->count);
+        err = ESP_ERR_NOT_FOUND;
+        goto save;
+    }
+
+    const wifi_prov_netstore_profile_t *profile = &store->profiles[best];
+    memcpy(wifi_cfg.sta.ssid, profile->ssid, sizeof(wifi_cfg.sta.ssid));
+    memcpy(wifi_cfg.sta.password, profile->password, sizeof(wifi_cfg.sta.password));
+    memcpy(wifi_cfg.sta.bssid, profile->bssid, sizeof(wifi_cfg.sta.bssid));
+    wifi_cfg.sta.bssid_set = profile->bssid_set;
+    /* Start connecting on the channel of the strongest matching AP */
+    wifi_cfg.sta.channel = 0;
+    int8_t channel_rssi = WIFI_PROV_NETSTORE_RSSI_UNSEEN;
+    for (int i = 0; i < count; i++) {
+        if (wifi_prov_netstore_match(profile, records[i].ssid, records[i].bssid) &&
+            (!wifi_cfg.sta.channel || records[i].rssi > channel_rssi)) {
+            wifi_cfg.sta.channel = records[i].primary;
+            channel_rssi = records[i].rssi;
+        }
+    }
+    ESP_LOGI(TAG, "Connecting to stored network %.*s, RSSI %d",
+             strnlen((const char *) profile->ssid, sizeof(profile->ssid)),
+             (const char *) profile->ssid, profile->rssi);
+
+    err = esp_wifi_set_config(WIFI_IF_STA, &wifi_cfg);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set Wi-Fi configuration");
+        goto save;
+    }
+    err = netstore_watch_start();
+    if (err != ESP_OK) {
+        goto save;
+    }
+    err = esp_wifi_connect();
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to connect Wi-Fi");
+    }
+
+save:
+    /* Keep the failure of the skipped network and the scanned RSSIs */
+    netstore_save(store);
+exit:
+    if (err != ESP_OK) {
+        netstore_watch_stop();
+    }
+    memset(&wifi_cfg, 0, sizeof(wifi_cfg));
+    free(records);
+    netstore_free(store);
+    return err;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
 static esp_err_t update_wifi_scan_results(void)
 {
     if (!prov_ctx->scanning) {
@@ -936,7 +1331,14 @@ static void wifi_prov_mgr_event_handler_internal(
          * host SSID and password */
         prov_ctx->wifi_state = WIFI_PROV_STA_CONNECTING;
     } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
-        ESP_LOGI(TAG, "STA Got IP");
+        if (prov_ctx->cred_recv_time) {
+            ESP_LOGI(TAG, "STA Got IP, %lld ms after credentials were received",
+                     (esp_timer_get_time() - prov_ctx->cred_recv_time) / 1000);
+            /* Later reconnections are not timed */
+            prov_ctx->cred_recv_time = 0;
+        } else {
+            ESP_LOGI(TAG, "STA Got IP");
+        }
         /* Station got IP. That means configuration is successful. */
         prov_ctx->wifi_state = WIFI_PROV_STA_CONNECTED;
         prov_ctx->prov_state = WIFI_PROV_STATE_SUCCESS;
@@ -1183,14 +1585,14 @@ esp_err_t wifi_prov_mgr_get_wifi_disconnect_reason(wifi_prov_sta_fail_reason_t *
 
 static void debug_print_wifi_credentials(wifi_sta_config_t sta, const char* pretext)
 {
-    size_t passlen = strlen((const char*) sta.password);
+    size_t passlen = strnlen((const char*) sta.password, sizeof(sta.password));
     ESP_LOGD(TAG, "%s Wi-Fi SSID     : %.*s", pretext,
              strnlen((const char *) sta.ssid, sizeof(sta.ssid)), (const char *) sta.ssid);
 
     if (passlen) {
         /* Mask password partially if longer than 3, else mask it completely */
         memset(sta.password + (passlen > 3), '*', passlen - 2*(passlen > 3));
-        ESP_LOGD(TAG, "%s Wi-Fi Password : %s", pretext, (const char *) sta.password);
+        ESP_LOGD(TAG, "%s Wi-Fi Password : %.*s", pretext, passlen, (const char *) sta.password);
     }
 }
 
@@ -1220,8 +1622,234 @@ bool wifi_prov_mgr_is_sm_idle(void)
     return (prov_ctx->prov_state == WIFI_PROV_STATE_IDLE);
 }
 
+#ifdef WIFI_PROV_PMK_JOB
+static bool pmk_job_matches(const wifi_sta_config_t *sta)
+{
+    return memcmp(pmk_job->ssid, sta->ssid, sizeof(pmk_job->ssid)) == 0 &&
+           memcmp(pmk_job->password, sta->password, sizeof(pmk_job->password)) == 0;
+}
+
+#ifdef WIFI_PROV_NETSTORE_PSK
+/* Add the network requested by pmk_job_store() with the derived PSK. This
+ * must be called with prov_ctx_lock and pmk_job->idle held */
+static void pmk_job_store_done(void)
+{
+    uint8_t password[64];
+
+    if (pmk_job->done) {
+        wifi_prov_pmk_to_hex(pmk_job->pmk, password);
+        netstore_add(pmk_job->store_ssid, password,
+                     pmk_job->store_bssid_set ? pmk_job->store_bssid : NULL,
+                     pmk_job->store_priority);
+        memset(password, 0, sizeof(password));
+    } else {
+        ESP_LOGW(TAG, "No PSK for network, not storing it");
+    }
+    memset(pmk_job->store_password, 0, sizeof(pmk_job->store_password));
+    pmk_job->store = false;
+#ifndef CONFIG_WIFI_PROV_STA_PMK_PRECOMPUTE
+    /* Nothing else uses the PMK */
+    memset(pmk_job->password, 0, sizeof(pmk_job->password));
+    memset(pmk_job->pmk, 0, sizeof(pmk_job->pmk));
+    pmk_job->done = false;
+#endif
+}
+#endif
+
+static void pmk_job_task(void *arg)
+{
+    while (1) {
+        int64_t start = esp_timer_get_time();
+
+        if (wifi_prov_pmk_derive((const char *) pmk_job->password,
+                                 strnlen((const char *) pmk_job->password, sizeof(pmk_job->password)),
+                                 pmk_job->ssid, strnlen((const char *) pmk_job->ssid, sizeof(pmk_job->ssid)),
+                                 pmk_job->pmk) == ESP_OK) {
+            pmk_job->done = true;
+            ESP_LOGD(TAG, "PMK derived in %lld ms", (esp_timer_get_time() - start) / 1000);
+        } else {
+            ESP_LOGW(TAG, "Failed to derive PMK");
+        }
+#ifdef WIFI_PROV_NETSTORE_PSK
+        /* pmk_job_store() checks for a running task with the lock held, so
+         * a network to store is either seen here or stored by the caller */
+        ACQUIRE_LOCK(prov_ctx_lock);
+        if (pmk_job->store &&
+            (memcmp(pmk_job->ssid, pmk_job->store_ssid, sizeof(pmk_job->ssid)) ||
+             memcmp(pmk_job->password, pmk_job->store_password, sizeof(pmk_job->password)))) {
+            /* Derived for other credentials, start over with the ones to store */
+            memcpy(pmk_job->ssid, pmk_job->store_ssid, sizeof(pmk_job->ssid));
+            memcpy(pmk_job->password, pmk_job->store_password, sizeof(pmk_job->password));
+            pmk_job->done = false;
+            RELEASE_LOCK(prov_ctx_lock);
+            continue;
+        }
+        if (pmk_job->store) {
+            pmk_job_store_done();
+        }
+        xSemaphoreGive(pmk_job->idle);
+        RELEASE_LOCK(prov_ctx_lock);
+#else
+        xSemaphoreGive(pmk_job->idle);
+#endif
+        break;
+    }
+    vTaskDelete(NULL);
+}
+
+/* Allocate the job on first use */
+static bool pmk_job_init(void)
+{
+    if (pmk_job) {
+        return true;
+    }
+    pmk_job = calloc(1, sizeof(*pmk_job));
+    if (!pmk_job) {
+        return false;
+    }
+    pmk_job->idle = xSemaphoreCreateBinary();
+    if (!pmk_job->idle) {
+        free(pmk_job);
+        pmk_job = NULL;
+        return false;
+    }
+    xSemaphoreGive(pmk_job->idle);
+    return true;
+}
+
+/* Start the derivation task for the given credentials. The caller must have
+ * taken pmk_job->idle, which the task gives back when it finishes */
+static bool pmk_job_run(const wifi_sta_config_t *sta)
+{
+    memcpy(pmk_job->ssid, sta->ssid, sizeof(pmk_job->ssid));
+    memcpy(pmk_job->password, sta->password, sizeof(pmk_job->password));
+    pmk_job->done = false;
+    if (xTaskCreate(pmk_job_task, "wifi_prov_pmk", 4096, NULL,
+                    tskIDLE_PRIORITY + 1, NULL) != pdPASS) {
+        ESP_LOGW(TAG, "Failed to start PMK derivation");
+        xSemaphoreGive(pmk_job->idle);
+        return false;
+    }
+    return true;
+}
+
+#ifdef CONFIG_WIFI_PROV_STA_PMK_PRECOMPUTE
+/* Start deriving the PMK for the given credentials, unless that is already
+ * running or done. This must be called with prov_ctx_lock held */
+static void pmk_job_start(const wifi_sta_config_t *sta)
+{
+    size_t passlen = strnlen((const char *) sta->password, sizeof(sta->password));
+
+    /* Open networks and 64 hex digit PSKs have nothing to derive */
+    if (passlen < 8 || passlen > 63 || !pmk_usable(sta)) {
+        return;
+    }
+    if (!pmk_job_init()) {
+        return;
+    }
+
+    if (xSemaphoreTake(pmk_job->idle, 0) != pdTRUE) {
+        /* A running task only changes its inputs with prov_ctx_lock held.
+         * Don't wait for it with the lock held: if it was started for
+         * other credentials, pmk_job_apply() finds a mismatch and the
+         * supplicant derives the PMK for these itself */
+        if (!pmk_job_matches(sta)) {
+            ESP_LOGD(TAG, "PMK derivation busy, not precomputing");
+        }
+        return;
+    }
+    if (pmk_job->done && pmk_job_matches(sta)) {
+        xSemaphoreGive(pmk_job->idle);
+        return;
+    }
+    pmk_job_run(sta);
+}
+#endif
+
+#ifdef WIFI_PROV_NETSTORE_PSK
+/* Add the network to the store with the PSK derived from its passphrase,
+ * once the PMK job has it. The passphrase must be usable as a PSK, see
+ * netstore_add_received(). This must be called with prov_ctx_lock held */
+static void pmk_job_store(const wifi_sta_config_t *sta, uint8_t priority)
+{
+    if (!pmk_job_init()) {
+        ESP_LOGE(TAG, "Failed to allocate memory for PMK derivation, not storing network");
+        return;
+    }
+
+    memcpy(pmk_job->store_ssid, sta->ssid, sizeof(pmk_job->store_ssid));
+    memcpy(pmk_job->store_password, sta->password, sizeof(pmk_job->store_password));
+    memcpy(pmk_job->store_bssid, sta->bssid, sizeof(pmk_job->store_bssid));
+    pmk_job->store_bssid_set = sta->bssid_set;
+    pmk_job->store_priority = priority;
+    pmk_job->store = true;
+
+    if (xSemaphoreTake(pmk_job->idle, 0) != pdTRUE) {
+        /* The running task stores the network when it finishes */
+        return;
+    }
+    if (pmk_job->done && pmk_job_matches(sta)) {
+        pmk_job_store_done();
+        xSemaphoreGive(pmk_job->idle);
+        return;
+    }
+    if (!pmk_job_run(sta)) {
+        memset(pmk_job->store_password, 0, sizeof(pmk_job->store_password));
+        pmk_job->store = false;
+    }
+}
+#endif
+#endif
+
+#ifdef CONFIG_WIFI_PROV_STA_PMK_PRECOMPUTE
+/* Replace the configured passphrase with the precomputed PMK, if it is
+ * ready. As storage is set to flash, the PMK is also used on later boots */
+static void pmk_job_apply(void)
+{
+    wifi_config_t wifi_cfg;
+
+    if (!pmk_job || xSemaphoreTake(pmk_job->idle, 0) != pdTRUE) {
+        /* Still running: let the supplicant derive the PMK itself */
+        return;
+    }
+    if (pmk_job->done &&
+        esp_wifi_get_config(WIFI_IF_STA, &wifi_cfg) == ESP_OK &&
+        pmk_job_matches(&wifi_cfg.sta)) {
+        wifi_prov_pmk_to_hex(pmk_job->pmk, wifi_cfg.sta.password);
+        if (esp_wifi_set_config(WIFI_IF_STA, &wifi_cfg) == ESP_OK) {
+            ESP_LOGD(TAG, "Using precomputed PMK");
+        } else {
+            ESP_LOGW(TAG, "Failed to set precomputed PMK");
+        }
+    }
+    /* Don't keep credentials around once they have been used */
+    memset(pmk_job->password, 0, sizeof(pmk_job->password));
+    memset(pmk_job->pmk, 0, sizeof(pmk_job->pmk));
+    pmk_job->done = false;
+    xSemaphoreGive(pmk_job->idle);
+}
+#endif
+
+void wifi_prov_mgr_precompute_pmk(const wifi_sta_config_t *sta)
+{
+#ifdef CONFIG_WIFI_PROV_STA_PMK_PRECOMPUTE
+    if (!prov_ctx_lock) {
+        return;
+    }
+
+    ACQUIRE_LOCK(prov_ctx_lock);
+    if (prov_ctx && prov_ctx->prov_state < WIFI_PROV_STATE_CRED_RECV) {
+        pmk_job_start(sta);
+    }
+    RELEASE_LOCK(prov_ctx_lock);
+#endif
+}
+
 static void wifi_connect_timer_cb(void *arg)
 {
+#ifdef CONFIG_WIFI_PROV_STA_PMK_PRECOMPUTE
+    pmk_job_apply();
+#endif
     if (esp_wifi_connect() != ESP_OK) {
         ESP_LOGE(TAG, "Failed to connect Wi-Fi");
     }
@@ -1246,6 +1874,17 @@ esp_err_t wifi_prov_mgr_configure_sta(wifi_config_t *wifi_cfg)
         return ESP_FAIL;
     }
     debug_print_wifi_credentials(wifi_cfg->sta, "Received");
+    prov_ctx->cred_recv_time = esp_timer_get_time();
+
+#ifdef CONFIG_WIFI_PROV_STA_PMK_PRECOMPUTE
+    /* No-op if set_config_handler() already started it */
+    pmk_job_start(&wifi_cfg->sta);
+#endif
+#ifdef CONFIG_WIFI_PROV_STA_MULTI_NETWORK
+    netstore_add_received(&wifi_cfg->sta);
+    /* The outcome is reported by netstore_connect_handler() */
+    netstore_watch_start();
+#endif
 
     /* Configure Wi-Fi as both AP and/or Station */
     if (esp_wifi_set_mode(prov_ctx->mgr_config.scheme.wifi_mode) != ESP_OK) {
@@ -1719,6 +2358,16 @@ esp_err_t wifi_prov_mgr_reset_provisioning(void)
         ret = ESP_FAIL;
     }
 
+#ifdef CONFIG_WIFI_PROV_STA_MULTI_NETWORK
+    nvs_handle_t handle;
+    if (nvs_open(NETSTORE_NVS_NAMESPACE, NVS_READWRITE, &handle) == ESP_OK) {
+        if (nvs_erase_key(handle, NETSTORE_NVS_KEY) == ESP_OK) {
+            nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
+#endif
+
     return ret;
 }
 
@@ -13,7 +13,9 @@
 // limitations under the License.
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/param.h>
 #include <esp_err.h>
 #include <esp_log.h>
 
@@ -96,13 +98,15 @@ static esp_err_t cmd_get_status_handler(WiFiConfigPayload *req,
             }
 
             connected->bssid.len  = sizeof(resp_data.conn_info.bssid);
-            connected->bssid.data = (uint8_t *) strndup(resp_data.conn_info.bssid,
-                                                        sizeof(resp_data.conn_info.bssid));
+            /* The BSSID is binary, strndup() would stop at the first zero byte */
+            connected->bssid.data = (uint8_t *) malloc(sizeof(resp_data.conn_info.bssid));
             if (connected->bssid.data == NULL) {
                 free(connected->ip4_addr);
                 free(resp_payload);
                 return ESP_ERR_NO_MEM;
             }
+            memcpy(connected->bssid.data, resp_data.conn_info.bssid,
+                   sizeof(resp_data.conn_info.bssid));
 
             connected->ssid.len   = strlen(resp_data.conn_info.ssid);
             connected->ssid.data  = (uint8_t *) strdup(resp_data.conn_info.ssid);
@@ -177,6 +181,7 @@ static esp_err_t cmd_set_config_handler(WiFiConfigPayload *req,
         memcpy(req_data.bssid, req->cmd_set_config->bssid.data,
                req->cmd_set_config->bssid.len);
         req_data.channel = req->cmd_set_config->channel;
+        req_data.priority = MIN(req->cmd_set_config->priority, UINT8_MAX);
         if (h->set_config_handler(&req_data, &h->ctx) == ESP_OK) {
             resp_payload->status = STATUS__Success;
         } else {
@@ -0,0 +1,193 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include "wifi_prov_netstore.h"
+
+#define SUCCESS_BONUS_DB        2
+#define SUCCESS_BONUS_MAX       8
+#define FAILURE_PENALTY_DB      10
+
+static size_t field_len(const uint8_t *field, size_t size)
+{
+    size_t len = 0;
+
+    while (len < size && field[len]) {
+        len++;
+    }
+    return len;
+}
+
+static bool ssid_equal(const uint8_t stored[32], const uint8_t *ssid)
+{
+    size_t len = field_len(ssid, 32);
+
+    return len == field_len(stored, 32) && memcmp(stored, ssid, len) == 0;
+}
+
+static int profile_score(const wifi_prov_netstore_profile_t *profile)
+{
+    int successes = profile->successes < SUCCESS_BONUS_MAX ?
+                    profile->successes : SUCCESS_BONUS_MAX;
+
+    return profile->rssi + SUCCESS_BONUS_DB * successes -
+           FAILURE_PENALTY_DB * profile->failures;
+}
+
+void wifi_prov_netstore_init(wifi_prov_netstore_t *store)
+{
+    memset(store, 0, sizeof(*store));
+    store->version = WIFI_PROV_NETSTORE_VERSION;
+    store->size = sizeof(*store);
+}
+
+bool wifi_prov_netstore_check(const wifi_prov_netstore_t *store, size_t len)
+{
+    return len == sizeof(*store) &&
+           store->version == WIFI_PROV_NETSTORE_VERSION &&
+           store->size == sizeof(*store) &&
+           store->count <= WIFI_PROV_NETSTORE_MAX;
+}
+
+int wifi_prov_netstore_find(const wifi_prov_netstore_t *store, const uint8_t *ssid)
+{
+    for (int i = 0; i < store->count; i++) {
+        if (ssid_equal(store->profiles[i].ssid, ssid)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int wifi_prov_netstore_add(wifi_prov_netstore_t *store, const uint8_t *ssid,
+                           const uint8_t *password, const uint8_t *bssid,
+                           uint8_t priority)
+{
+    wifi_prov_netstore_profile_t *profile;
+    uint8_t new_password[64] = { 0 };
+    int index = wifi_prov_netstore_find(store, ssid);
+
+    memcpy(new_password, password, field_len(password, sizeof(new_password)));
+
+    if (index < 0) {
+        if (store->count < WIFI_PROV_NETSTORE_MAX) {
+            index = store->count++;
+        } else {
+            /* Replace the profile least worth keeping */
+            index = 0;
+            for (int i = 1; i < store->count; i++) {
+                const wifi_prov_netstore_profile_t *a = &store->profiles[i];
+                const wifi_prov_netstore_profile_t *b = &store->profiles[index];
+                if (a->priority < b->priority ||
+                    (a->priority == b->priority && a->successes < b->successes)) {
+                    index = i;
+                }
+            }
+        }
+        profile = &store->profiles[index];
+        memset(profile, 0, sizeof(*profile));
+        memcpy(profile->ssid, ssid, field_len(ssid, sizeof(profile->ssid)));
+        profile->rssi = WIFI_PROV_NETSTORE_RSSI_UNSEEN;
+    } else {
+        profile = &store->profiles[index];
+        if (memcmp(profile->password, new_password, sizeof(new_password))) {
+            profile->successes = 0;
+            profile->failures = 0;
+        }
+    }
+
+    memcpy(profile->password, new_password, sizeof(profile->password));
+    profile->bssid_set = bssid != NULL;
+    if (bssid) {
+        memcpy(profile->bssid, bssid, sizeof(profile->bssid));
+    } else {
+        memset(profile->bssid, 0, sizeof(profile->bssid));
+    }
+    profile->priority = priority;
+    return index;
+}
+
+void wifi_prov_netstore_remove(wifi_prov_netstore_t *store, int index)
+{
+    if (index < 0 || index >= store->count) {
+        return;
+    }
+    store->count--;
+    memmove(&store->profiles[index], &store->profiles[index + 1],
+            (store->count - index) * sizeof(store->profiles[0]));
+    memset(&store->profiles[store->count], 0, sizeof(store->profiles[0]));
+}
+
+void wifi_prov_netstore_scan_begin(wifi_prov_netstore_t *store)
+{
+    for (int i = 0; i < store->count; i++) {
+        store->profiles[i].rssi = WIFI_PROV_NETSTORE_RSSI_UNSEEN;
+    }
+}
+
+bool wifi_prov_netstore_match(const wifi_prov_netstore_profile_t *profile,
+                              const uint8_t *ssid, const uint8_t bssid[6])
+{
+    return ssid_equal(profile->ssid, ssid) &&
+           (!profile->bssid_set || !memcmp(profile->bssid, bssid, sizeof(profile->bssid)));
+}
+
+void wifi_prov_netstore_scan_result(wifi_prov_netstore_t *store, const uint8_t *ssid,
+                                    const uint8_t bssid[6], int8_t rssi)
+{
+    for (int i = 0; i < store->count; i++) {
+        wifi_prov_netstore_profile_t *profile = &store->profiles[i];
+
+        if (!wifi_prov_netstore_match(profile, ssid, bssid)) {
+            continue;
+        }
+        if (rssi > profile->rssi) {
+            profile->rssi = rssi;
+        }
+        /* There is one profile per SSID */
+        return;
+    }
+}
+
+void wifi_prov_netstore_report(wifi_prov_netstore_t *store, int index, bool connected)
+{
+    if (index < 0 || index >= store->count) {
+        return;
+    }
+
+    wifi_prov_netstore_profile_t *profile = &store->profiles[index];
+    if (connected) {
+        if (profile->successes < UINT8_MAX) {
+            profile->successes++;
+        }
+        profile->failures = 0;
+    } else if (profile->failures < UINT8_MAX) {
+        profile->failures++;
+    }
+}
+
+int wifi_prov_netstore_select(const wifi_prov_netstore_t *store, uint32_t skip)
+{
+    int best = -1;
+    int best_score = 0;
+
+    for (int i = 0; i < store->count; i++) {
+        const wifi_prov_netstore_profile_t *profile = &store->profiles[i];
+
+        if ((skip & (1U << i)) || profile->rssi == WIFI_PROV_NETSTORE_RSSI_UNSEEN) {
+            continue;
+        }
+
+        int score = profile_score(profile);
+        if (best < 0 || profile->priority > store->profiles[best].priority ||
+            (profile->priority == store->profiles[best].priority && score > best_score)) {
+            best = i;
+            best_score = score;
+        }
+    }
+    return best;
+}
@@ -0,0 +1,166 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _PROV_WIFI_NETSTORE_H_
+#define _PROV_WIFI_NETSTORE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Maximum number of networks kept in a store */
+#define WIFI_PROV_NETSTORE_MAX          4
+
+/** Layout version of wifi_prov_netstore_t, bumped on every change */
+#define WIFI_PROV_NETSTORE_VERSION      1
+
+/** RSSI of a network which was not found by the last scan */
+#define WIFI_PROV_NETSTORE_RSSI_UNSEEN  INT8_MIN
+
+/**
+ * @brief   Credentials and connection history of one network
+ */
+typedef struct {
+    uint8_t ssid[32];       /*!< SSID, NUL padded */
+    uint8_t password[64];   /*!< Passphrase or 64 hex digit PSK, NUL padded */
+    uint8_t bssid[6];       /*!< BSSID to connect to, if bssid_set */
+    bool    bssid_set;      /*!< Whether connecting is limited to bssid */
+    uint8_t priority;       /*!< Rank given by the client, higher is preferred */
+    int8_t  rssi;           /*!< Strongest RSSI seen by the last scan */
+    uint8_t successes;      /*!< Successful connections, saturating */
+    uint8_t failures;       /*!< Failed connections since the last success */
+} wifi_prov_netstore_profile_t;
+
+/**
+ * @brief   Set of known networks
+ *
+ * This is stored as is in NVS. The leading version and size let a store
+ * written with another layout be detected and discarded.
+ */
+typedef struct {
+    uint16_t version;       /*!< WIFI_PROV_NETSTORE_VERSION */
+    uint16_t size;          /*!< sizeof(wifi_prov_netstore_t) */
+    uint8_t count;          /*!< Number of valid profiles */
+    wifi_prov_netstore_profile_t profiles[WIFI_PROV_NETSTORE_MAX];
+} wifi_prov_netstore_t;
+
+/**
+ * @brief   Initialize an empty store
+ *
+ * @param[out] store  Store to initialize
+ */
+void wifi_prov_netstore_init(wifi_prov_netstore_t *store);
+
+/**
+ * @brief   Check that a store read back from flash has the current layout
+ *
+ * @param[in] store  Store to check
+ * @param[in] len    Number of bytes read into store
+ *
+ * @return  true if the store can be used as is
+ */
+bool wifi_prov_netstore_check(const wifi_prov_netstore_t *store, size_t len);
+
+/**
+ * @brief   Find the profile for a network
+ *
+ * @param[in] store  Store to search
+ * @param[in] ssid   SSID, NUL padded or NUL terminated
+ *
+ * @return  Index of the profile, or -1 if there is none
+ */
+int wifi_prov_netstore_find(const wifi_prov_netstore_t *store, const uint8_t *ssid);
+
+/**
+ * @brief   Add a network, or update the profile already kept for its SSID
+ *
+ * The connection history is kept if the credentials did not change. If the
+ * store is full, the profile with the lowest priority and then the fewest
+ * successful connections is replaced.
+ *
+ * @param[in] store     Store to add to
+ * @param[in] ssid      SSID, NUL padded or NUL terminated
+ * @param[in] password  Passphrase or PSK, NUL padded or NUL terminated
+ * @param[in] bssid     BSSID to limit connecting to, or NULL
+ * @param[in] priority  Rank of the network, higher is preferred
+ *
+ * @return  Index of the profile
+ */
+int wifi_prov_netstore_add(wifi_prov_netstore_t *store, const uint8_t *ssid,
+                           const uint8_t *password, const uint8_t *bssid,
+                           uint8_t priority);
+
+/**
+ * @brief   Remove a profile
+ *
+ * @param[in] store  Store to remove from
+ * @param[in] index  Index of the profile
+ */
+void wifi_prov_netstore_remove(wifi_prov_netstore_t *store, int index);
+
+/**
+ * @brief   Check whether a scanned AP belongs to a profile
+ *
+ * @param[in] profile  Profile to match
+ * @param[in] ssid     SSID of the AP, NUL terminated
+ * @param[in] bssid    BSSID of the AP, only compared if the profile has one
+ *
+ * @return  true if the AP is one the profile connects to
+ */
+bool wifi_prov_netstore_match(const wifi_prov_netstore_profile_t *profile,
+                              const uint8_t *ssid, const uint8_t bssid[6]);
+
+/**
+ * @brief   Forget the RSSI of all profiles before feeding new scan results
+ *
+ * @param[in] store  Store to update
+ */
+void wifi_prov_netstore_scan_begin(wifi_prov_netstore_t *store);
+
+/**
+ * @brief   Record one scanned AP
+ *
+ * @param[in] store  Store to update
+ * @param[in] ssid   SSID of the AP, NUL terminated
+ * @param[in] bssid  BSSID of the AP
+ * @param[in] rssi   RSSI of the AP
+ */
+void wifi_prov_netstore_scan_result(wifi_prov_netstore_t *store, const uint8_t *ssid,
+                                    const uint8_t bssid[6], int8_t rssi);
+
+/**
+ * @brief   Record the outcome of connecting to a profile
+ *
+ * @param[in] store      Store to update
+ * @param[in] index      Index of the profile
+ * @param[in] connected  Whether the connection succeeded
+ */
+void wifi_prov_netstore_report(wifi_prov_netstore_t *store, int index, bool connected);
+
+/**
+ * @brief   Select the network to connect to
+ *
+ * Only profiles found by the last scan are considered. They are ranked by
+ * priority first, then by RSSI adjusted for the connection history: each
+ * past success adds 2 dB up to 16 dB, and each failure since the last
+ * success takes off 10 dB.
+ *
+ * @param[in] store  Store to select from
+ * @param[in] skip   Bitmask of profile indices not to select
+ *
+ * @return  Index of the selected profile, or -1 if none is in range
+ */
+int wifi_prov_netstore_select(const wifi_prov_netstore_t *store, uint32_t skip);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,33 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <mbedtls/pkcs5.h>
+
+#include "wifi_prov_pmk.h"
+
+#define PMK_ITERATIONS      4096
+
+esp_err_t wifi_prov_pmk_derive(const char *passphrase, size_t passphrase_len,
+                               const uint8_t *ssid, size_t ssid_len,
+                               uint8_t pmk[WIFI_PROV_PMK_LEN])
+{
+    int ret = mbedtls_pkcs5_pbkdf2_hmac_ext(MBEDTLS_MD_SHA1,
+                                            (const unsigned char *) passphrase, passphrase_len,
+                                            ssid, ssid_len, PMK_ITERATIONS,
+                                            WIFI_PROV_PMK_LEN, pmk);
+    return ret == 0 ? ESP_OK : ESP_FAIL;
+}
+
+void wifi_prov_pmk_to_hex(const uint8_t pmk[WIFI_PROV_PMK_LEN],
+                          uint8_t hex[2 * WIFI_PROV_PMK_LEN])
+{
+    static const char digits[] = "0123456789abcdef";
+
+    for (int i = 0; i < WIFI_PROV_PMK_LEN; i++) {
+        hex[2 * i] = digits[pmk[i] >> 4];
+        hex[2 * i + 1] = digits[pmk[i] & 0xf];
+    }
+}
@@ -0,0 +1,56 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _PROV_WIFI_PMK_H_
+#define _PROV_WIFI_PMK_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <esp_err.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Length of a WPA/WPA2-Personal PMK in bytes */
+#define WIFI_PROV_PMK_LEN   32
+
+/**
+ * @brief   Derive the WPA/WPA2-Personal PMK from a passphrase
+ *
+ * Computes PBKDF2-HMAC-SHA1(passphrase, ssid, 4096 iterations, 32 bytes) as
+ * specified by IEEE 802.11, using mbedTLS (and so the SHA hardware where
+ * available).
+ *
+ * @param[in]  passphrase      Passphrase, not NUL terminated
+ * @param[in]  passphrase_len  Length of passphrase (at most 63 bytes)
+ * @param[in]  ssid            SSID of the network
+ * @param[in]  ssid_len        Length of ssid (at most 32 bytes)
+ * @param[out] pmk             Derived PMK
+ *
+ * @return
+ *  - ESP_OK   : PMK derived
+ *  - ESP_FAIL : mbedTLS failure
+ */
+esp_err_t wifi_prov_pmk_derive(const char *passphrase, size_t passphrase_len,
+                               const uint8_t *ssid, size_t ssid_len,
+                               uint8_t pmk[WIFI_PROV_PMK_LEN]);
+
+/**
+ * @brief   Encode a PMK as the 64 hex digit PSK accepted in place of a
+ *          passphrase by the Wi-Fi station configuration
+ *
+ * @param[in]  pmk  PMK to encode
+ * @param[out] hex  Lowercase hex digits, not NUL terminated
+ */
+void wifi_prov_pmk_to_hex(const uint8_t pmk[WIFI_PROV_PMK_LEN],
+                          uint8_t hex[2 * WIFI_PROV_PMK_LEN]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
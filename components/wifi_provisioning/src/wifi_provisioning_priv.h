@@ -28,6 +28,30 @@
  */
 esp_err_t wifi_prov_mgr_done(void);
 
+/**
+ * @brief   Start deriving the PMK for received credentials in the background
+ *
+ * This is called by the set_config_handler() so that the PBKDF2 computation
+ * runs while the response is sent to the client. When the connection is
+ * later started, the passphrase is replaced by the derived PMK, saving the
+ * station from deriving it on this and every later connection. This has no
+ * effect unless CONFIG_WIFI_PROV_STA_PMK_PRECOMPUTE is enabled and the scan
+ * results show the network as WPA/WPA2-Personal only.
+ *
+ * @param[in] sta  Station configuration holding the received credentials
+ */
+void wifi_prov_mgr_precompute_pmk(const wifi_sta_config_t *sta);
+
+/**
+ * @brief   Set the priority to store the next configured network with
+ *
+ * This is called by the set_config_handler() with the rank sent by the
+ * client. It only has an effect with CONFIG_WIFI_PROV_STA_MULTI_NETWORK.
+ *
+ * @param[in] priority  Rank of the network, higher is preferred
+ */
+void wifi_prov_mgr_set_network_priority(uint8_t priority);
+
 /**
  * @brief   Start Wi-Fi AP Scan
  *
@@ -0,0 +1,218 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unity.h>
+
+#include "wifi_prov_netstore.h"
+
+#define SSID(s)     ((const uint8_t *) (s))
+#define PASS(s)     ((const uint8_t *) (s))
+
+static const uint8_t bssid_a[6] = { 1, 2, 3, 4, 5, 6 };
+static const uint8_t bssid_b[6] = { 9, 9, 9, 9, 9, 9 };
+
+TEST_CASE("Network store layout check", "[wifi_prov]")
+{
+    wifi_prov_netstore_t store;
+
+    wifi_prov_netstore_init(&store);
+    TEST_ASSERT_TRUE(wifi_prov_netstore_check(&store, sizeof(store)));
+    TEST_ASSERT_FALSE(wifi_prov_netstore_check(&store, sizeof(store) - 1));
+
+    store.version++;
+    TEST_ASSERT_FALSE(wifi_prov_netstore_check(&store, sizeof(store)));
+    store.version--;
+    store.size--;
+    TEST_ASSERT_FALSE(wifi_prov_netstore_check(&store, sizeof(store)));
+    store.size++;
+    store.count = WIFI_PROV_NETSTORE_MAX + 1;
+    TEST_ASSERT_FALSE(wifi_prov_netstore_check(&store, sizeof(store)));
+}
+
+TEST_CASE("Network store add, find and remove", "[wifi_prov]")
+{
+    wifi_prov_netstore_t store;
+    uint8_t ssid32[32];
+
+    wifi_prov_netstore_init(&store);
+    TEST_ASSERT_EQUAL(0, wifi_prov_netstore_add(&store, SSID("home"), PASS("password1"), NULL, 1));
+    TEST_ASSERT_EQUAL(1, wifi_prov_netstore_add(&store, SSID("office"), PASS("password2"), bssid_a, 1));
+    TEST_ASSERT_EQUAL(0, wifi_prov_netstore_add(&store, SSID("home"), PASS("password1"), NULL, 2));
+    TEST_ASSERT_EQUAL(2, store.count);
+    TEST_ASSERT_EQUAL(2, store.profiles[0].priority);
+
+    /* A new password resets the history */
+    wifi_prov_netstore_report(&store, 0, true);
+    wifi_prov_netstore_add(&store, SSID("home"), PASS("other"), NULL, 1);
+    TEST_ASSERT_EQUAL(0, store.profiles[0].successes);
+    TEST_ASSERT_EQUAL(0, store.profiles[0].failures);
+
+    /* The lowest priority network without successes is evicted */
+    wifi_prov_netstore_add(&store, SSID("a"), PASS("x"), NULL, 5);
+    wifi_prov_netstore_add(&store, SSID("b"), PASS("x"), NULL, 5);
+    wifi_prov_netstore_report(&store, 1, true);
+    TEST_ASSERT_EQUAL(0, wifi_prov_netstore_add(&store, SSID("c"), PASS("x"), NULL, 3));
+    TEST_ASSERT_EQUAL(WIFI_PROV_NETSTORE_MAX, store.count);
+
+    wifi_prov_netstore_remove(&store, 1);
+    TEST_ASSERT_EQUAL(3, store.count);
+    TEST_ASSERT_LESS_THAN(0, wifi_prov_netstore_find(&store, SSID("office")));
+    TEST_ASSERT_EQUAL(2, wifi_prov_netstore_find(&store, SSID("b")));
+
+    /* 32 byte SSIDs are not NUL terminated */
+    memset(ssid32, 'z', sizeof(ssid32));
+    int index = wifi_prov_netstore_add(&store, ssid32, PASS("x"), NULL, 0);
+    TEST_ASSERT_EQUAL(index, wifi_prov_netstore_find(&store, ssid32));
+}
+
+TEST_CASE("Network store selection", "[wifi_prov]")
+{
+    wifi_prov_netstore_t store;
+
+    wifi_prov_netstore_init(&store);
+    wifi_prov_netstore_add(&store, SSID("home"), PASS("password1"), NULL, 2);
+    wifi_prov_netstore_add(&store, SSID("office"), PASS("password2"), bssid_a, 1);
+    TEST_ASSERT_EQUAL(-1, wifi_prov_netstore_select(&store, 0));
+
+    /* A locked BSSID only matches that AP */
+    TEST_ASSERT_FALSE(wifi_prov_netstore_match(&store.profiles[1], SSID("office"), bssid_b));
+    TEST_ASSERT_TRUE(wifi_prov_netstore_match(&store.profiles[1], SSID("office"), bssid_a));
+    TEST_ASSERT_TRUE(wifi_prov_netstore_match(&store.profiles[0], SSID("home"), bssid_b));
+
+    wifi_prov_netstore_scan_begin(&store);
+    wifi_prov_netstore_scan_result(&store, SSID("office"), bssid_b, -40);
+    TEST_ASSERT_EQUAL(-1, wifi_prov_netstore_select(&store, 0));
+    wifi_prov_netstore_scan_result(&store, SSID("office"), bssid_a, -70);
+    TEST_ASSERT_EQUAL(1, wifi_prov_netstore_select(&store, 0));
+
+    /* Priority wins over RSSI, skipped networks are not selected */
+    wifi_prov_netstore_scan_result(&store, SSID("home"), bssid_b, -85);
+    TEST_ASSERT_EQUAL(0, wifi_prov_netstore_select(&store, 0));
+    TEST_ASSERT_EQUAL(1, wifi_prov_netstore_select(&store, 1U << 0));
+
+    /* With equal priority, RSSI and connection history decide */
+    store.profiles[0].priority = 1;
+    TEST_ASSERT_EQUAL(1, wifi_prov_netstore_select(&store, 0));
+    for (int i = 0; i < 8; i++) {
+        wifi_prov_netstore_report(&store, 0, true);
+    }
+    TEST_ASSERT_EQUAL(0, wifi_prov_netstore_select(&store, 0));
+    wifi_prov_netstore_report(&store, 0, false);
+    TEST_ASSERT_EQUAL(1, wifi_prov_netstore_select(&store, 0));
+}
+
+/* Simulated fallback between three stored networks, each of which is out
+ * of range at random and one of which often refuses the connection. The
+ * connection rate and average time of the selector are compared against
+ * staying on the first network and against trying all networks in priority
+ * order without a scan. Times are in tenths of a second */
+#define SIM_NETWORKS        3
+#define SIM_ROUNDS          20000
+#define SIM_T_SCAN          25
+#define SIM_T_OK            30
+#define SIM_T_FAIL          80
+#define SIM_T_NO_AP         25
+#define SIM_T_OK_CHANNEL    8
+#define SIM_T_FAIL_CHANNEL  58
+
+static const char *const sim_ssid[SIM_NETWORKS] = { "home", "office", "hotspot" };
+static const int sim_rssi[SIM_NETWORKS] = { -80, -60, -50 };
+static const int sim_down_permille[SIM_NETWORKS] = { 300, 200, 100 };
+static const int sim_refuse_permille[SIM_NETWORKS] = { 0, 500, 0 };
+static uint32_t sim_seed;
+
+static int sim_rand(int range)
+{
+    sim_seed = sim_seed * 1103515245 + 12345;
+    return (sim_seed >> 16) % range;
+}
+
+static bool sim_connects(const bool up[SIM_NETWORKS], int i)
+{
+    return up[i] && sim_rand(1000) >= sim_refuse_permille[i];
+}
+
+static void sim_run(const char *label, const uint8_t priority[SIM_NETWORKS])
+{
+    wifi_prov_netstore_t store;
+    static const uint8_t bssid[6];
+    long t_ordered = 0, t_ranked = 0;
+    int ok_single = 0, ok_ordered = 0, ok_ranked = 0;
+
+    sim_seed = 12345;
+    wifi_prov_netstore_init(&store);
+    for (int i = 0; i < SIM_NETWORKS; i++) {
+        wifi_prov_netstore_add(&store, SSID(sim_ssid[i]), PASS("passphrase"), NULL, priority[i]);
+    }
+
+    for (int round = 0; round < SIM_ROUNDS; round++) {
+        bool up[SIM_NETWORKS];
+        int8_t rssi[SIM_NETWORKS];
+        uint32_t skip = 0;
+        bool done = false;
+        long t = 0;
+
+        for (int i = 0; i < SIM_NETWORKS; i++) {
+            up[i] = sim_rand(1000) >= sim_down_permille[i];
+            rssi[i] = sim_rssi[i] + sim_rand(11) - 5;
+        }
+        ok_single += up[0];
+
+        for (int i = 0; i < SIM_NETWORKS && !done; i++) {
+            done = sim_connects(up, i);
+            t += done ? SIM_T_OK : (up[i] ? SIM_T_FAIL : SIM_T_NO_AP);
+        }
+        if (done) {
+            ok_ordered++;
+            t_ordered += t;
+        }
+
+        for (t = 0, done = false; !done;) {
+            t += SIM_T_SCAN;
+            wifi_prov_netstore_scan_begin(&store);
+            for (int i = 0; i < SIM_NETWORKS; i++) {
+                if (up[i]) {
+                    wifi_prov_netstore_scan_result(&store, SSID(sim_ssid[i]), bssid, rssi[i]);
+                }
+            }
+            int best = wifi_prov_netstore_select(&store, skip);
+            if (best < 0) {
+                break;
+            }
+            done = sim_connects(up, best);
+            t += done ? SIM_T_OK_CHANNEL : SIM_T_FAIL_CHANNEL;
+            wifi_prov_netstore_report(&store, best, done);
+            skip |= 1U << best;
+        }
+        if (done) {
+            ok_ranked++;
+            t_ranked += t;
+        }
+    }
+
+    printf("%s: connected single %d.%d%%, ordered %d.%d%% in %ld ms, ranked %d.%d%% in %ld ms\n",
+           label, ok_single * 1000 / SIM_ROUNDS / 10, ok_single * 1000 / SIM_ROUNDS % 10,
+           ok_ordered * 1000 / SIM_ROUNDS / 10, ok_ordered * 1000 / SIM_ROUNDS % 10,
+           t_ordered * 100 / ok_ordered,
+           ok_ranked * 1000 / SIM_ROUNDS / 10, ok_ranked * 1000 / SIM_ROUNDS % 10,
+           t_ranked * 100 / ok_ranked);
+    /* Both fallbacks try each network at most once, so they connect
+     * equally often; the selector just gets there sooner */
+    TEST_ASSERT_GREATER_OR_EQUAL(ok_single, ok_ranked);
+    TEST_ASSERT_GREATER_OR_EQUAL(ok_ordered - SIM_ROUNDS / 100, ok_ranked);
+    TEST_ASSERT_LESS_THAN(t_ordered / ok_ordered, t_ranked / ok_ranked);
+}
+
+TEST_CASE("Network store fallback simulation", "[wifi_prov][perf]")
+{
+    static const uint8_t ranked[SIM_NETWORKS] = { 2, 1, 0 };
+    static const uint8_t equal[SIM_NETWORKS] = { 0, 0, 0 };
+
+    sim_run("ranked priority", ranked);
+    sim_run("equal priority", equal);
+}
@@ -0,0 +1,68 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <esp_timer.h>
+#include <unity.h>
+
+#include "wifi_prov_pmk.h"
+
+#define PMK_PERF_ROUNDS     10
+
+typedef struct {
+    const char *passphrase;
+    const char *ssid;
+    const char *psk;
+} pmk_test_vector_t;
+
+/* Test vectors from IEEE 802.11, Annex J.4 */
+static const pmk_test_vector_t pmk_vectors[] = {
+    {
+        "password", "IEEE",
+        "f42c6fc52df0ebef9ebb4b90b38a5f902e83fe1b135a70e23aed762e9710a12e",
+    },
+    {
+        "ThisIsAPassword", "ThisIsASSID",
+        "0dc0d6eb90555ed6419756b9a15ec3e3209b63df707dd508d14581f8982721af",
+    },
+    {
+        "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa", "ZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZ",
+        "becb93866bb8c3832cb777c2f559807c8c59afcb6eae734885001300a981cc62",
+    },
+};
+
+static void derive_psk(const pmk_test_vector_t *v, uint8_t psk[2 * WIFI_PROV_PMK_LEN])
+{
+    uint8_t pmk[WIFI_PROV_PMK_LEN];
+
+    TEST_ASSERT_EQUAL(ESP_OK, wifi_prov_pmk_derive(v->passphrase, strlen(v->passphrase),
+                                                   (const uint8_t *) v->ssid, strlen(v->ssid),
+                                                   pmk));
+    wifi_prov_pmk_to_hex(pmk, psk);
+}
+
+TEST_CASE("PMK derivation test vectors", "[wifi_prov]")
+{
+    uint8_t psk[2 * WIFI_PROV_PMK_LEN];
+
+    for (size_t i = 0; i < sizeof(pmk_vectors) / sizeof(pmk_vectors[0]); i++) {
+        derive_psk(&pmk_vectors[i], psk);
+        TEST_ASSERT_EQUAL_MEMORY(pmk_vectors[i].psk, psk, sizeof(psk));
+    }
+}
+
+TEST_CASE("PMK derivation time", "[wifi_prov][perf]")
+{
+    uint8_t psk[2 * WIFI_PROV_PMK_LEN];
+    int64_t start = esp_timer_get_time();
+
+    for (int i = 0; i < PMK_PERF_ROUNDS; i++) {
+        derive_psk(&pmk_vectors[1], psk);
+    }
+    printf("PMK derivation: %lld us\n", (esp_timer_get_time() - start) / PMK_PERF_ROUNDS);
+    TEST_ASSERT_EQUAL_MEMORY(pmk_vectors[1].psk, psk, sizeof(psk));
+}